@@ -0,0 +1,320 @@
+// glTF vertex and index decoding per file (Sponza and every .glb under
+// Resources/Models by default): the per-vertex push_back loop the loader used
+// before AccessorDecoding, against whole-stream DecodeFloats/DecodeIndices into
+// a presized array, serially and with primitives spread over the pool. The
+// old loop reads tight float streams only; primitives it cannot read are
+// counted and left out of its column, and non-indexed primitives, which the
+// loader rejects, are skipped. Then one million interleaved quantized
+// vertices (normalized 16- and 8-bit components), DecodeFloats against a
+// per-component reference. Best of `repeats`.
+//
+//   AccessorDecodingBenchmark [scene.gltf|scene.glb] [repeats]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "BenchmarkScenes.h"
+#include "SceneResources/AccessorDecoding.h"
+#include "SceneResources/VertexPacking.h"
+#include "Utils/ThreadPool.h"
+
+namespace
+{
+    namespace fs = std::filesystem;
+    using AccessorDecoding::AccessorView;
+    using AccessorDecoding::ComponentType;
+    using VertexPacking::FloatVertex;
+    using Clock = std::chrono::high_resolution_clock;
+
+    double MillisecondsSince(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    struct PrimitiveStreams
+    {
+        AccessorView position;
+        AccessorView normal;
+        AccessorView tangent;
+        AccessorView uv;
+        AccessorView indices;
+        bool hasNormal = false;
+        bool hasTangent = false;
+        bool hasUv = false;
+        bool legacyReadable = false;
+    };
+
+    struct Decoded
+    {
+        std::vector<FloatVertex> vertices;
+        std::vector<uint32_t> indices;
+    };
+
+    bool IsTightFloat(const AccessorView& view, int components)
+    {
+        return view.componentType == ComponentType::Float && view.componentCount == components
+            && (view.stride == 0 || view.stride == components * sizeof(float));
+    }
+
+    std::vector<PrimitiveStreams> CollectStreams(const tinygltf::Model& model)
+    {
+        std::vector<PrimitiveStreams> primitives;
+        for (const tinygltf::Mesh& mesh : model.meshes)
+        {
+            for (const tinygltf::Primitive& primitive : mesh.primitives)
+            {
+                auto find = [&](const char* name) { const auto it = primitive.attributes.find(name); return it != primitive.attributes.end() ? it->second : -1; };
+                PrimitiveStreams streams;
+                if (!BenchmarkScenes::MakeAccessorView(model, find("POSITION"), streams.position)
+                    || !BenchmarkScenes::MakeAccessorView(model, primitive.indices, streams.indices))
+                    continue;
+                const size_t count = streams.position.count;
+                streams.hasNormal = BenchmarkScenes::MakeAccessorView(model, find("NORMAL"), streams.normal) && streams.normal.count == count;
+                streams.hasTangent = BenchmarkScenes::MakeAccessorView(model, find("TANGENT"), streams.tangent) && streams.tangent.count == count;
+                streams.hasUv = BenchmarkScenes::MakeAccessorView(model, find("TEXCOORD_0"), streams.uv) && streams.uv.count == count;
+                streams.legacyReadable = IsTightFloat(streams.position, 3) && (!streams.hasNormal || IsTightFloat(streams.normal, 3))
+                    && (!streams.hasTangent || IsTightFloat(streams.tangent, 4)) && (!streams.hasUv || IsTightFloat(streams.uv, 2))
+                    && streams.indices.componentType != ComponentType::UnsignedByte;
+                primitives.push_back(streams);
+            }
+        }
+        return primitives;
+    }
+
+    // The pre-AccessorDecoding ExtractVertices/ExtractIndices: raw float
+    // pointers indexed as if tightly packed, one push_back per element.
+    void DecodeLegacy(const PrimitiveStreams& streams, Decoded& out)
+    {
+        const auto* positions = reinterpret_cast<const float*>(streams.position.data);
+        const auto* normals = reinterpret_cast<const float*>(streams.normal.data);
+        const auto* tangents = reinterpret_cast<const float*>(streams.tangent.data);
+        const auto* uvs = reinterpret_cast<const float*>(streams.uv.data);
+        out.vertices.clear();
+        for (size_t i = 0; i < streams.position.count; ++i)
+        {
+            FloatVertex vertex{};
+            vertex.position[0] = positions[i * 3 + 0];
+            vertex.position[1] = positions[i * 3 + 1];
+            vertex.position[2] = positions[i * 3 + 2];
+            vertex.normal[1] = 1.0f;
+            if (streams.hasNormal)
+            {
+                vertex.normal[0] = normals[i * 3 + 0];
+                vertex.normal[1] = normals[i * 3 + 1];
+                vertex.normal[2] = normals[i * 3 + 2];
+            }
+            if (streams.hasUv)
+            {
+                vertex.uv[0] = uvs[i * 2 + 0];
+                vertex.uv[1] = uvs[i * 2 + 1];
+            }
+            if (streams.hasTangent)
+                std::memcpy(vertex.tangent, tangents + i * 4, sizeof(vertex.tangent));
+            else
+                vertex.tangent[3] = 1.0f;
+            out.vertices.push_back(vertex);
+        }
+
+        out.indices.clear();
+        const AccessorView& indices = streams.indices;
+        if (indices.componentType == ComponentType::UnsignedShort)
+        {
+            const auto* raw = reinterpret_cast<const uint16_t*>(indices.data);
+            for (size_t i = 0; i < indices.count; ++i)
+                out.indices.push_back(raw[i]);
+        }
+        else
+        {
+            const auto* raw = reinterpret_cast<const uint32_t*>(indices.data);
+            for (size_t i = 0; i < indices.count; ++i)
+                out.indices.push_back(raw[i]);
+        }
+    }
+
+    void DecodeStreams(const PrimitiveStreams& streams, Decoded& out)
+    {
+        out.vertices.assign(streams.position.count, FloatVertex{ { 0, 0, 0 }, { 0, 1, 0 }, { 0, 0, 0, 1 }, { 0, 0 } });
+        FloatVertex* base = out.vertices.data();
+        AccessorDecoding::DecodeFloats(streams.position, base->position, sizeof(FloatVertex), 3);
+        if (streams.hasNormal)
+            AccessorDecoding::DecodeFloats(streams.normal, base->normal, sizeof(FloatVertex), 3);
+        if (streams.hasTangent)
+            AccessorDecoding::DecodeFloats(streams.tangent, base->tangent, sizeof(FloatVertex), 4);
+        if (streams.hasUv)
+            AccessorDecoding::DecodeFloats(streams.uv, base->uv, sizeof(FloatVertex), 2);
+        out.indices.resize(streams.indices.count);
+        AccessorDecoding::DecodeIndices(streams.indices, out.indices.data());
+    }
+
+    template <typename Decode>
+    double BestOf(int repeats, Decode&& decode)
+    {
+        double best = 0.0;
+        for (int i = 0; i < repeats; ++i)
+        {
+            const auto start = Clock::now();
+            decode();
+            const double ms = MillisecondsSince(start);
+            best = i == 0 ? ms : std::min(best, ms);
+        }
+        return best;
+    }
+
+    double Speedup(double before, double after)
+    {
+        return after > 0.0 ? before / after : 0.0;
+    }
+
+    bool RunFile(const fs::path& path, int repeats)
+    {
+        tinygltf::Model model;
+        std::string error;
+        if (!BenchmarkScenes::LoadGltfModel(path, model, error))
+        {
+            std::fprintf(stderr, "%s: %s\n", path.string().c_str(), error.c_str());
+            return false;
+        }
+        const std::vector<PrimitiveStreams> primitives = CollectStreams(model);
+        std::vector<Decoded> decoded(primitives.size());
+        size_t vertices = 0;
+        size_t legacyPrimitives = 0;
+        for (const PrimitiveStreams& streams : primitives)
+        {
+            vertices += streams.position.count;
+            legacyPrimitives += streams.legacyReadable ? 1 : 0;
+        }
+
+        const double legacyMs = BestOf(repeats, [&]
+        {
+            for (size_t i = 0; i < primitives.size(); ++i)
+                if (primitives[i].legacyReadable)
+                    DecodeLegacy(primitives[i], decoded[i]);
+        });
+        const double legacySubsetMs = BestOf(repeats, [&]
+        {
+            for (size_t i = 0; i < primitives.size(); ++i)
+                if (primitives[i].legacyReadable)
+                    DecodeStreams(primitives[i], decoded[i]);
+        });
+        const double streamMs = BestOf(repeats, [&]
+        {
+            for (size_t i = 0; i < primitives.size(); ++i)
+                DecodeStreams(primitives[i], decoded[i]);
+        });
+        const double poolMs = BestOf(repeats, [&]
+        {
+            ThreadPool::Get().ParallelFor(primitives.size(), [&](size_t i) { DecodeStreams(primitives[i], decoded[i]); });
+        });
+
+        std::printf("%s: %zu primitive(s) (%zu readable by the old loop), %zu vertices\n",
+            path.filename().string().c_str(), primitives.size(), legacyPrimitives, vertices);
+        std::printf("  per-vertex %8.3f ms  streams %8.3f ms  (%.2fx on the same primitives)\n", legacyMs, legacySubsetMs, Speedup(legacyMs, legacySubsetMs));
+        std::printf("  all        %8.3f ms serial  %8.3f ms pool  (%.2fx)\n", streamMs, poolMs, Speedup(streamMs, poolMs));
+        return true;
+    }
+
+    // Generic per-component decode, the shape a reader without the VEC4
+    // widening paths takes.
+    template <typename T>
+    void DecodeReference(const AccessorView& view, float* dst, size_t dstStrideBytes, int components)
+    {
+        const size_t stride = AccessorDecoding::EffectiveStride(view);
+        const float scale = view.normalized ? 1.0f / static_cast<float>(std::numeric_limits<T>::max()) : 1.0f;
+        for (size_t i = 0; i < view.count; ++i)
+        {
+            float* element = reinterpret_cast<float*>(reinterpret_cast<uint8_t*>(dst) + i * dstStrideBytes);
+            for (int c = 0; c < components; ++c)
+            {
+                T value;
+                std::memcpy(&value, view.data + i * stride + c * sizeof(T), sizeof(T));
+                element[c] = std::max(static_cast<float>(value) * scale, std::numeric_limits<T>::is_signed ? -1.0f : 0.0f);
+            }
+        }
+    }
+
+    // KHR_mesh_quantization-style layout: i16x4 position, i8x4 normal,
+    // i8x4 tangent, u16x2 UV, all normalized, in one 20-byte stride.
+    void RunQuantized(int repeats)
+    {
+        constexpr size_t COUNT = size_t(1) << 20;
+        constexpr size_t STRIDE = 20;
+        std::vector<uint8_t> bytes(COUNT * STRIDE);
+        std::mt19937 rng(3);
+        for (uint8_t& byte : bytes)
+            byte = static_cast<uint8_t>(rng());
+
+        auto view = [&](size_t offset, ComponentType type, int components)
+        {
+            AccessorView v;
+            v.data = bytes.data() + offset;
+            v.count = COUNT;
+            v.stride = STRIDE;
+            v.componentType = type;
+            v.componentCount = components;
+            v.normalized = true;
+            return v;
+        };
+        const AccessorView position = view(0, ComponentType::Short, 4);
+        const AccessorView normal = view(8, ComponentType::Byte, 4);
+        const AccessorView tangent = view(12, ComponentType::Byte, 4);
+        const AccessorView uv = view(16, ComponentType::UnsignedShort, 2);
+
+        std::vector<FloatVertex> streams(COUNT);
+        std::vector<FloatVertex> reference(COUNT);
+        const double streamMs = BestOf(repeats, [&]
+        {
+            AccessorDecoding::DecodeFloats(position, streams[0].position, sizeof(FloatVertex), 3);
+            AccessorDecoding::DecodeFloats(normal, streams[0].normal, sizeof(FloatVertex), 3);
+            AccessorDecoding::DecodeFloats(tangent, streams[0].tangent, sizeof(FloatVertex), 4);
+            AccessorDecoding::DecodeFloats(uv, streams[0].uv, sizeof(FloatVertex), 2);
+        });
+        const double referenceMs = BestOf(repeats, [&]
+        {
+            DecodeReference<int16_t>(position, reference[0].position, sizeof(FloatVertex), 3);
+            DecodeReference<int8_t>(normal, reference[0].normal, sizeof(FloatVertex), 3);
+            DecodeReference<int8_t>(tangent, reference[0].tangent, sizeof(FloatVertex), 4);
+            DecodeReference<uint16_t>(uv, reference[0].uv, sizeof(FloatVertex), 2);
+        });
+        const bool agree = std::memcmp(streams.data(), reference.data(), COUNT * sizeof(FloatVertex)) == 0;
+        std::printf("quantized: %zu vertices, %zu-byte stride\n", COUNT, STRIDE);
+        std::printf("  per-component %8.3f ms  DecodeFloats %8.3f ms  (%.2fx)%s\n", referenceMs, streamMs, Speedup(referenceMs, streamMs),
+            agree ? "" : "  MISMATCH");
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const int repeats = argc > 2 ? std::max(1, std::atoi(argv[2])) : 5;
+    std::vector<fs::path> files;
+    if (argc > 1)
+    {
+        files.emplace_back(argv[1]);
+    }
+    else
+    {
+        const fs::path models = fs::path(RAYTRACER_RESOURCE_DIR) / "Models";
+        files.push_back(models / "Sponza" / "glTF" / "Sponza.gltf");
+        std::vector<fs::path> found;
+        std::error_code error;
+        for (const fs::directory_entry& entry : fs::recursive_directory_iterator(models, error))
+            if (entry.is_regular_file() && entry.path().extension() == ".glb")
+                found.push_back(entry.path());
+        std::sort(found.begin(), found.end());
+        files.insert(files.end(), found.begin(), found.end());
+    }
+    std::printf("%u thread(s)\n", ThreadPool::Get().GetThreadCount());
+
+    bool failed = false;
+    for (const fs::path& path : files)
+        if (!RunFile(path, repeats))
+            failed |= argc > 1;
+    RunQuantized(repeats);
+    return failed ? 1 : 0;
+}
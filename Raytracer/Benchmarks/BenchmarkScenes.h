@@ -0,0 +1,467 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <rapidjson/document.h>
+#include <tinygltf/tiny_gltf.h>
+
+#include "SceneResources/AccessorDecoding.h"
+#include "SceneResources/SceneBvh.h"
+#include "SceneResources/SceneCacheFormat.h"
+#include "SceneResources/SceneCacheGeometry.h"
+#include "SceneResources/TransformHierarchy.h"
+#include "SceneResources/VertexPacking.h"
+#include "SceneResources/Wo3Mesh.h"
+
+// Placed scene geometry for the benchmarks, in the layout SceneBvhInput takes:
+// a geometry per glTF mesh primitive, .wo3 file or cache primitive record, and
+// an instance per placement with the node transform the engine would give it.
+// Only positions and indices are read; materials and textures are skipped.
+namespace BenchmarkScenes
+{
+    struct Scene
+    {
+        std::string name;
+        std::vector<float> positions; // xyz
+        std::vector<uint32_t> indices;
+        std::vector<BvhGeometry> geometries;
+        std::vector<BvhInstance> instances;
+        size_t skippedFiles = 0; // unreadable .wo3 files, left out as TungstenLoading does
+        std::vector<std::filesystem::path> geometryFiles; // Tungsten: the .wo3 behind each geometry
+
+        [[nodiscard]] SceneBvhInput MakeInput() const
+        {
+            SceneBvhInput input;
+            input.positions = positions.data();
+            input.indices = indices.data();
+            input.geometries = geometries.data();
+            input.geometryCount = geometries.size();
+            input.instances = instances.data();
+            input.instanceCount = instances.size();
+            return input;
+        }
+
+        [[nodiscard]] size_t InstancedTriangleCount() const
+        {
+            size_t triangles = 0;
+            for (const BvhInstance& instance : instances)
+                triangles += geometries[instance.geometry].indexCount / 3;
+            return triangles;
+        }
+
+        // Every instanced triangle in world space, 9 floats each.
+        [[nodiscard]] std::vector<float> WorldTriangles() const
+        {
+            std::vector<float> triangles;
+            triangles.reserve(InstancedTriangleCount() * 9);
+            for (const BvhInstance& instance : instances)
+            {
+                const BvhGeometry& geometry = geometries[instance.geometry];
+                for (uint32_t i = 0; i < geometry.indexCount; ++i)
+                {
+                    const float* p = &positions[(static_cast<size_t>(geometry.vertexOffset) + indices[geometry.indexOffset + i]) * 3];
+                    for (int r = 0; r < 3; ++r)
+                    {
+                        const float* row = instance.objectToWorld[r];
+                        triangles.push_back(row[0] * p[0] + row[1] * p[1] + row[2] * p[2] + row[3]);
+                    }
+                }
+            }
+            return triangles;
+        }
+
+        // World bounds of every instanced triangle, the engine's scene AABB.
+        [[nodiscard]] BvhAabb WorldBounds() const
+        {
+            BvhAabb bounds;
+            for (const BvhInstance& instance : instances)
+            {
+                const BvhGeometry& geometry = geometries[instance.geometry];
+                for (uint32_t i = 0; i < geometry.indexCount; ++i)
+                {
+                    const float* p = &positions[(static_cast<size_t>(geometry.vertexOffset) + indices[geometry.indexOffset + i]) * 3];
+                    float world[3];
+                    for (int r = 0; r < 3; ++r)
+                    {
+                        const float* row = instance.objectToWorld[r];
+                        world[r] = row[0] * p[0] + row[1] * p[1] + row[2] * p[2] + row[3];
+                    }
+                    bounds.Grow(world);
+                }
+            }
+            return bounds;
+        }
+    };
+
+    // BvhInstance::objectToWorld of a TransformHierarchy node (row vectors
+    // there, column vectors here), as SceneCacheGeometry places instances.
+    inline void ObjectToWorld(const TransformHierarchy& hierarchy, uint32_t node, float out[3][4])
+    {
+        const TransformHierarchy::Matrix& world = hierarchy.GetWorld(node);
+        for (int r = 0; r < 3; ++r)
+            for (int c = 0; c < 4; ++c)
+                out[r][c] = world.m[c][r];
+    }
+
+    // XMMatrixDecompose of a glTF node matrix, which ModelLoading applies as
+    // the node's TRS. A mirror goes into a negative x scale; false (the
+    // engine then keeps the identity) when an axis has collapsed.
+    inline bool DecomposeNodeMatrix(const std::vector<double>& matrix, float position[3], float rotation[4], float scale[3])
+    {
+        // Column-major glTF, so rows of the row-vector matrix: the scaled axes, then the translation.
+        float axes[3][3];
+        for (int r = 0; r < 3; ++r)
+        {
+            for (int c = 0; c < 3; ++c)
+                axes[r][c] = static_cast<float>(matrix[static_cast<size_t>(r) * 4 + c]);
+            position[r] = static_cast<float>(matrix[12 + static_cast<size_t>(r)]);
+            scale[r] = std::sqrt(axes[r][0] * axes[r][0] + axes[r][1] * axes[r][1] + axes[r][2] * axes[r][2]);
+            if (!(scale[r] > 1e-6f))
+                return false;
+        }
+        const float determinant =
+            axes[0][0] * (axes[1][1] * axes[2][2] - axes[1][2] * axes[2][1]) -
+            axes[0][1] * (axes[1][0] * axes[2][2] - axes[1][2] * axes[2][0]) +
+            axes[0][2] * (axes[1][0] * axes[2][1] - axes[1][1] * axes[2][0]);
+        if (determinant < 0.0f)
+            scale[0] = -scale[0];
+        float m[3][3];
+        for (int r = 0; r < 3; ++r)
+            for (int c = 0; c < 3; ++c)
+                m[r][c] = axes[r][c] / scale[r];
+
+        // XMQuaternionRotationMatrix: m[0][1] = 2(xy + zw) in this layout.
+        const float trace = m[0][0] + m[1][1] + m[2][2];
+        float q[4];
+        if (trace > 0.0f)
+        {
+            const float t = std::sqrt(trace + 1.0f) * 2.0f;
+            q[0] = (m[1][2] - m[2][1]) / t; q[1] = (m[2][0] - m[0][2]) / t; q[2] = (m[0][1] - m[1][0]) / t; q[3] = 0.25f * t;
+        }
+        else if (m[0][0] >= m[1][1] && m[0][0] >= m[2][2])
+        {
+            const float t = std::sqrt(1.0f + m[0][0] - m[1][1] - m[2][2]) * 2.0f;
+            q[0] = 0.25f * t; q[1] = (m[0][1] + m[1][0]) / t; q[2] = (m[0][2] + m[2][0]) / t; q[3] = (m[1][2] - m[2][1]) / t;
+        }
+        else if (m[1][1] >= m[2][2])
+        {
+            const float t = std::sqrt(1.0f + m[1][1] - m[0][0] - m[2][2]) * 2.0f;
+            q[0] = (m[0][1] + m[1][0]) / t; q[1] = 0.25f * t; q[2] = (m[1][2] + m[2][1]) / t; q[3] = (m[2][0] - m[0][2]) / t;
+        }
+        else
+        {
+            const float t = std::sqrt(1.0f + m[2][2] - m[0][0] - m[1][1]) * 2.0f;
+            q[0] = (m[0][2] + m[2][0]) / t; q[1] = (m[1][2] + m[2][1]) / t; q[2] = 0.25f * t; q[3] = (m[0][1] - m[1][0]) / t;
+        }
+        std::copy(q, q + 4, rotation);
+        return true;
+    }
+
+    // tinygltf load with image decoding skipped; only geometry is needed.
+    inline bool LoadGltfModel(const std::filesystem::path& path, tinygltf::Model& model, std::string& error)
+    {
+        tinygltf::TinyGLTF loader;
+        loader.SetImageLoader([](tinygltf::Image*, const int, std::string*, std::string*, int, int, const unsigned char*, int, void*) { return true; }, nullptr);
+        std::string warning;
+        return path.extension() == ".glb"
+            ? loader.LoadBinaryFromFile(&model, &error, &warning, path.string())
+            : loader.LoadASCIIFromFile(&model, &error, &warning, path.string());
+    }
+
+    // Bounds-checked view of a non-sparse accessor, as ModelLoading builds it.
+    inline bool MakeAccessorView(const tinygltf::Model& model, int accessorIndex, AccessorDecoding::AccessorView& view)
+    {
+        if (accessorIndex < 0 || accessorIndex >= static_cast<int>(model.accessors.size()))
+            return false;
+        const tinygltf::Accessor& accessor = model.accessors[accessorIndex];
+        if (accessor.bufferView < 0 || accessor.sparse.isSparse)
+            return false;
+        const tinygltf::BufferView& bufferView = model.bufferViews[accessor.bufferView];
+        const tinygltf::Buffer& buffer = model.buffers[bufferView.buffer];
+        view.data = buffer.data.data() + bufferView.byteOffset + accessor.byteOffset;
+        view.count = accessor.count;
+        view.stride = bufferView.byteStride;
+        view.componentType = static_cast<AccessorDecoding::ComponentType>(accessor.componentType);
+        view.componentCount = tinygltf::GetNumComponentsInType(static_cast<uint32_t>(accessor.type));
+        view.normalized = accessor.normalized;
+        const size_t start = bufferView.byteOffset + accessor.byteOffset;
+        return view.componentCount > 0 && start <= buffer.data.size() && AccessorDecoding::RequiredBytes(view) <= buffer.data.size() - start;
+    }
+
+    inline bool LoadGltf(const std::filesystem::path& path, Scene& scene, std::string& error)
+    {
+        tinygltf::Model model;
+        if (!LoadGltfModel(path, model, error))
+            return false;
+
+        // Geometry per (mesh, primitive); nodes place all of their mesh's geometries.
+        std::vector<std::vector<uint32_t>> meshGeometries(model.meshes.size());
+        for (size_t m = 0; m < model.meshes.size(); ++m)
+        {
+            for (const tinygltf::Primitive& primitive : model.meshes[m].primitives)
+            {
+                if (primitive.mode != -1 && primitive.mode != TINYGLTF_MODE_TRIANGLES)
+                    continue;
+                const auto position = primitive.attributes.find("POSITION");
+                AccessorDecoding::AccessorView positions;
+                if (position == primitive.attributes.end() || !MakeAccessorView(model, position->second, positions))
+                    continue;
+
+                BvhGeometry geometry;
+                geometry.vertexOffset = static_cast<uint32_t>(scene.positions.size() / 3);
+                geometry.indexOffset = static_cast<uint32_t>(scene.indices.size());
+                scene.positions.resize(scene.positions.size() + positions.count * 3);
+                AccessorDecoding::DecodeFloats(positions, scene.positions.data() + static_cast<size_t>(geometry.vertexOffset) * 3, 3 * sizeof(float), 3);
+
+                AccessorDecoding::AccessorView indices;
+                if (primitive.indices >= 0 && MakeAccessorView(model, primitive.indices, indices))
+                {
+                    scene.indices.resize(scene.indices.size() + indices.count);
+                    AccessorDecoding::DecodeIndices(indices, scene.indices.data() + geometry.indexOffset);
+                }
+                else
+                {
+                    for (uint32_t i = 0; i < positions.count; ++i)
+                        scene.indices.push_back(i);
+                }
+                geometry.indexCount = static_cast<uint32_t>(scene.indices.size() - geometry.indexOffset) / 3 * 3;
+                scene.indices.resize(geometry.indexOffset + geometry.indexCount);
+                meshGeometries[m].push_back(static_cast<uint32_t>(scene.geometries.size()));
+                scene.geometries.push_back(geometry);
+            }
+        }
+
+        // Nodes into a TransformHierarchy depth first from the scene roots, so
+        // parents come first; then one instance per geometry of each node's mesh.
+        TransformHierarchy hierarchy;
+        std::vector<int> hierarchyMeshes;
+        std::vector<std::pair<int, uint32_t>> stack; // glTF node, hierarchy parent
+        const int sceneIndex = model.defaultScene >= 0 ? model.defaultScene : 0;
+        if (sceneIndex < static_cast<int>(model.scenes.size()))
+            for (int root : model.scenes[sceneIndex].nodes)
+                stack.emplace_back(root, TransformHierarchy::NO_PARENT);
+        while (!stack.empty())
+        {
+            const auto [nodeIndex, parent] = stack.back();
+            stack.pop_back();
+            if (nodeIndex < 0 || nodeIndex >= static_cast<int>(model.nodes.size()))
+                continue;
+            const tinygltf::Node& node = model.nodes[nodeIndex];
+
+            float position[3] = { 0.0f, 0.0f, 0.0f };
+            float rotation[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+            float scale[3] = { 1.0f, 1.0f, 1.0f };
+            if (node.matrix.size() == 16)
+            {
+                if (!DecomposeNodeMatrix(node.matrix, position, rotation, scale))
+                {
+                    std::fill(position, position + 3, 0.0f);
+                    std::fill(rotation, rotation + 4, 0.0f);
+                    rotation[3] = 1.0f;
+                    std::fill(scale, scale + 3, 1.0f);
+                }
+            }
+            else
+            {
+                for (size_t i = 0; i < node.translation.size() && i < 3; ++i)
+                    position[i] = static_cast<float>(node.translation[i]);
+                for (size_t i = 0; i < node.rotation.size() && i < 4; ++i)
+                    rotation[i] = static_cast<float>(node.rotation[i]);
+                for (size_t i = 0; i < node.scale.size() && i < 3; ++i)
+                    scale[i] = static_cast<float>(node.scale[i]);
+            }
+            const uint32_t current = hierarchy.Add(parent, position, rotation, scale);
+            hierarchyMeshes.push_back(node.mesh);
+            for (int child : node.children)
+                stack.emplace_back(child, current);
+        }
+        hierarchy.Update();
+
+        for (uint32_t n = 0; n < hierarchy.Size(); ++n)
+        {
+            const int mesh = hierarchyMeshes[n];
+            if (mesh < 0 || mesh >= static_cast<int>(meshGeometries.size()))
+                continue;
+            for (uint32_t geometry : meshGeometries[mesh])
+            {
+                BvhInstance instance;
+                instance.geometry = geometry;
+                ObjectToWorld(hierarchy, n, instance.objectToWorld);
+                scene.instances.push_back(instance);
+            }
+        }
+        scene.name = path.filename().string();
+        return true;
+    }
+
+    // Tungsten scene.json: every "mesh" primitive, each .wo3 loaded once and
+    // placed with its transform as TungstenLoading places it. Analytic
+    // primitives (quads, spheres, cubes) and unreadable meshes are skipped.
+    inline bool LoadTungsten(const std::filesystem::path& directory, Scene& scene, std::string& error)
+    {
+        std::ifstream in(directory / "scene.json", std::ios::binary);
+        std::string json((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        if (json.size() >= 3 && json.compare(0, 3, "\xEF\xBB\xBF") == 0)
+            json.erase(0, 3);
+        rapidjson::Document document;
+        document.Parse(json.c_str());
+        if (document.HasParseError() || !document.IsObject() || !document.HasMember("primitives") || !document["primitives"].IsArray())
+        {
+            error = "cannot parse scene.json";
+            return false;
+        }
+
+        auto readVec3 = [](const rapidjson::Value& value, float out[3])
+        {
+            if (value.IsNumber())
+                out[0] = out[1] = out[2] = value.GetFloat();
+            else if (value.IsArray() && value.Size() == 3)
+                for (rapidjson::SizeType i = 0; i < 3; ++i)
+                    out[i] = value[i].GetFloat();
+        };
+
+        constexpr uint32_t UNREADABLE = UINT32_MAX;
+        std::map<std::string, uint32_t> geometryByFile;
+        TransformHierarchy hierarchy;
+        for (const rapidjson::Value& primitive : document["primitives"].GetArray())
+        {
+            if (!primitive.HasMember("type") || std::string(primitive["type"].GetString()) != "mesh" || !primitive.HasMember("file"))
+                continue;
+
+            const std::string file = primitive["file"].GetString();
+            auto found = geometryByFile.find(file);
+            if (found == geometryByFile.end())
+            {
+                Wo3Mesh::File mesh;
+                if (mesh.Open(directory / file) != Wo3Mesh::Status::Ok)
+                {
+                    geometryByFile.emplace(file, UNREADABLE);
+                    ++scene.skippedFiles;
+                    continue;
+                }
+                BvhGeometry geometry;
+                geometry.vertexOffset = static_cast<uint32_t>(scene.positions.size() / 3);
+                geometry.indexOffset = static_cast<uint32_t>(scene.indices.size());
+                geometry.indexCount = static_cast<uint32_t>(mesh.TriangleCount() * 3);
+                const Wo3Mesh::Vertex* vertices = mesh.Vertices();
+                for (uint64_t i = 0; i < mesh.VertexCount(); ++i)
+                    scene.positions.insert(scene.positions.end(), { vertices[i].px, vertices[i].py, vertices[i].pz });
+                scene.indices.resize(scene.indices.size() + geometry.indexCount);
+                size_t badTriangle = 0;
+                if (!Wo3Mesh::CopyIndices(mesh, scene.indices.data() + geometry.indexOffset, badTriangle))
+                {
+                    scene.positions.resize(static_cast<size_t>(geometry.vertexOffset) * 3);
+                    scene.indices.resize(geometry.indexOffset);
+                    geometryByFile.emplace(file, UNREADABLE);
+                    ++scene.skippedFiles;
+                    continue;
+                }
+                found = geometryByFile.emplace(file, static_cast<uint32_t>(scene.geometries.size())).first;
+                scene.geometries.push_back(geometry);
+                scene.geometryFiles.push_back(directory / file);
+            }
+            if (found->second == UNREADABLE)
+                continue;
+
+            float position[3] = { 0.0f, 0.0f, 0.0f };
+            float degrees[3] = { 0.0f, 0.0f, 0.0f };
+            float scale[3] = { 1.0f, 1.0f, 1.0f };
+            if (primitive.HasMember("transform") && primitive["transform"].IsObject())
+            {
+                const rapidjson::Value& transform = primitive["transform"];
+                if (transform.HasMember("position"))
+                    readVec3(transform["position"], position);
+                if (transform.HasMember("rotation"))
+                    readVec3(transform["rotation"], degrees);
+                if (transform.HasMember("scale"))
+                    readVec3(transform["scale"], scale);
+            }
+
+            // Quaternion::CreateFromYawPitchRoll(y, x, z), as TungstenLoading does.
+            const float toHalfRadians = 3.14159265358979323846f / 360.0f;
+            const float cp = std::cos(degrees[0] * toHalfRadians), sp = std::sin(degrees[0] * toHalfRadians);
+            const float cy = std::cos(degrees[1] * toHalfRadians), sy = std::sin(degrees[1] * toHalfRadians);
+            const float cr = std::cos(degrees[2] * toHalfRadians), sr = std::sin(degrees[2] * toHalfRadians);
+            const float rotation[4] = {
+                cy * sp * cr + sy * cp * sr,
+                sy * cp * cr - cy * sp * sr,
+                cy * cp * sr - sy * sp * cr,
+                cy * cp * cr + sy * sp * sr,
+            };
+
+            BvhInstance instance;
+            instance.geometry = found->second;
+            hierarchy.Add(TransformHierarchy::NO_PARENT, position, rotation, scale);
+            scene.instances.push_back(instance);
+        }
+
+        // Root SceneNodes, one per primitive.
+        hierarchy.Update();
+        for (uint32_t i = 0; i < hierarchy.Size(); ++i)
+            ObjectToWorld(hierarchy, i, scene.instances[i].objectToWorld);
+        scene.name = directory.filename().string();
+        return true;
+    }
+
+    // A baked scene cache (.bsc) written by the engine.
+    inline bool LoadCache(const std::filesystem::path& path, Scene& scene, std::string& error)
+    {
+        SceneCacheFormat::Reader cache;
+        if (!cache.Open(path, sizeof(VertexPacking::FloatVertex)))
+        {
+            error = "not a scene cache with 48-byte vertices";
+            return false;
+        }
+        SceneCacheGeometry geometry;
+        geometry.Load(cache);
+        const auto* vertices = static_cast<const VertexPacking::FloatVertex*>(cache.GetVertexData());
+        scene.positions.resize(static_cast<size_t>(cache.GetVertexCount()) * 3);
+        for (size_t i = 0; i < cache.GetVertexCount(); ++i)
+            std::copy(vertices[i].position, vertices[i].position + 3, &scene.positions[i * 3]);
+        scene.indices.assign(cache.GetIndices().begin(), cache.GetIndices().end());
+        scene.geometries = std::move(geometry.geometries);
+        scene.instances = std::move(geometry.instances);
+        scene.name = cache.GetName();
+        return true;
+    }
+
+    // .gltf/.glb file, .bsc cache or Tungsten scene directory.
+    inline bool Load(const std::filesystem::path& path, Scene& scene, std::string& error)
+    {
+        scene = Scene();
+        const std::string extension = path.extension().string();
+        if (extension == ".gltf" || extension == ".glb")
+            return LoadGltf(path, scene, error);
+        if (extension == ".bsc")
+            return LoadCache(path, scene, error);
+        if (std::filesystem::exists(path / "scene.json"))
+            return LoadTungsten(path, scene, error);
+        error = "not a glTF file, scene cache or Tungsten scene";
+        return false;
+    }
+
+    // Sponza and every Tungsten scene with meshes under the checked-in assets.
+    inline std::vector<std::filesystem::path> DefaultScenes()
+    {
+        namespace fs = std::filesystem;
+        const fs::path models = fs::path(RAYTRACER_RESOURCE_DIR) / "Models";
+        std::vector<fs::path> scenes = { models / "Sponza" / "glTF" / "Sponza.gltf" };
+        std::vector<fs::path> tungsten;
+        std::error_code error;
+        for (const fs::directory_entry& entry : fs::directory_iterator(models / "Tungsten", error))
+            if (entry.is_directory() && fs::is_directory(entry.path() / "models"))
+                tungsten.push_back(entry.path());
+        std::sort(tungsten.begin(), tungsten.end());
+        scenes.insert(scenes.end(), tungsten.begin(), tungsten.end());
+        return scenes;
+    }
+}
@@ -0,0 +1,185 @@
+// SceneBvh build time and ray throughput per scene (Sponza and the Tungsten
+// scenes by default): the geometry level, the instance level and their SAH
+// cost, then closest-hit and occlusion Mrays/s for coherent pinhole rays from
+// the middle of the scene and incoherent rays with random origins and
+// directions inside its bounds. Best of `repeats` for every figure.
+//
+//   BvhBenchmark [scene.gltf|scene.bsc|tungstenDir] [rays] [repeats]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "BenchmarkScenes.h"
+#include "SceneResources/SceneBvh.h"
+#include "Utils/ThreadPool.h"
+
+namespace
+{
+    using Clock = std::chrono::high_resolution_clock;
+
+    double MillisecondsSince(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    // A square pinhole grid from the bounds centre, 90 degrees wide, looking
+    // diagonally across the x/z plane.
+    std::vector<BvhRay> MakeCoherentRays(const BvhAabb& bounds, size_t count)
+    {
+        const uint32_t side = std::max<uint32_t>(1, static_cast<uint32_t>(std::sqrt(static_cast<double>(count))));
+        std::vector<BvhRay> rays(static_cast<size_t>(side) * side);
+        float center[3];
+        for (int a = 0; a < 3; ++a)
+            center[a] = 0.5f * (bounds.min[a] + bounds.max[a]);
+        for (uint32_t y = 0; y < side; ++y)
+        {
+            for (uint32_t x = 0; x < side; ++x)
+            {
+                BvhRay& ray = rays[static_cast<size_t>(y) * side + x];
+                const float u = (static_cast<float>(x) + 0.5f) / static_cast<float>(side) * 2.0f - 1.0f;
+                const float v = (static_cast<float>(y) + 0.5f) / static_cast<float>(side) * 2.0f - 1.0f;
+                const float direction[3] = { 0.7071f + 0.7071f * u, -v, -0.7071f + 0.7071f * u };
+                const float length = std::sqrt(direction[0] * direction[0] + direction[1] * direction[1] + direction[2] * direction[2]);
+                for (int a = 0; a < 3; ++a)
+                {
+                    ray.origin[a] = center[a];
+                    ray.direction[a] = direction[a] / length;
+                }
+            }
+        }
+        return rays;
+    }
+
+    std::vector<BvhRay> MakeIncoherentRays(const BvhAabb& bounds, size_t count, uint32_t seed)
+    {
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+        std::vector<BvhRay> rays(count);
+        for (BvhRay& ray : rays)
+        {
+            for (int a = 0; a < 3; ++a)
+            {
+                ray.origin[a] = bounds.min[a] + (bounds.max[a] - bounds.min[a]) * unit(rng);
+                ray.direction[a] = unit(rng) * 2.0f - 1.0f;
+            }
+        }
+        return rays;
+    }
+
+    struct RayResult
+    {
+        double closestMs = 0.0;
+        double occludedMs = 0.0;
+        size_t hits = 0;
+    };
+
+    RayResult TraceRays(const SceneBvh& bvh, const std::vector<BvhRay>& rays, int repeats)
+    {
+        RayResult result;
+        std::vector<BvhHit> hits(rays.size());
+        std::vector<uint8_t> occluded(rays.size());
+        for (int i = 0; i < repeats; ++i)
+        {
+            const auto start = Clock::now();
+            bvh.IntersectBatch(rays.data(), hits.data(), rays.size());
+            const double closestMs = MillisecondsSince(start);
+
+            const auto occludedStart = Clock::now();
+            ThreadPool::Get().ParallelForRange(rays.size(), 256, [&](size_t begin, size_t end)
+            {
+                for (size_t r = begin; r < end; ++r)
+                    occluded[r] = bvh.Occluded(rays[r]);
+            });
+            const double occludedMs = MillisecondsSince(occludedStart);
+
+            result.closestMs = i == 0 ? closestMs : std::min(result.closestMs, closestMs);
+            result.occludedMs = i == 0 ? occludedMs : std::min(result.occludedMs, occludedMs);
+        }
+        result.hits = static_cast<size_t>(std::count_if(hits.begin(), hits.end(), [](const BvhHit& hit) { return hit.IsHit(); }));
+        size_t mismatches = 0;
+        for (size_t r = 0; r < rays.size(); ++r)
+            mismatches += (occluded[r] != 0) != hits[r].IsHit();
+        if (mismatches != 0)
+            std::fprintf(stderr, "  %zu ray(s) disagree between Intersect and Occluded\n", mismatches);
+        return result;
+    }
+
+    double MillionsPerSecond(size_t rays, double milliseconds)
+    {
+        return milliseconds > 0.0 ? static_cast<double>(rays) / (milliseconds * 1000.0) : 0.0;
+    }
+
+    void Report(const char* label, size_t rays, const RayResult& result)
+    {
+        std::printf("  %-10s closest %7.2f Mrays/s  occluded %7.2f Mrays/s  (%.1f%% hit)\n", label,
+            MillionsPerSecond(rays, result.closestMs), MillionsPerSecond(rays, result.occludedMs),
+            rays ? 100.0 * static_cast<double>(result.hits) / static_cast<double>(rays) : 0.0);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    namespace fs = std::filesystem;
+    const std::vector<fs::path> scenes = argc > 1 ? std::vector<fs::path>{ fs::path(argv[1]) } : BenchmarkScenes::DefaultScenes();
+    const size_t rayCount = argc > 2 ? static_cast<size_t>(std::max(1024, std::atoi(argv[2]))) : size_t(1) << 20;
+    const int repeats = argc > 3 ? std::max(1, std::atoi(argv[3])) : 3;
+    std::printf("%u thread(s), %zu rays per set\n", ThreadPool::Get().GetThreadCount(), rayCount);
+
+    // Default scenes whose assets are not checked out are reported and skipped.
+    bool failed = false;
+    for (const fs::path& path : scenes)
+    {
+        BenchmarkScenes::Scene scene;
+        std::string error;
+        const auto loadStart = Clock::now();
+        if (!BenchmarkScenes::Load(path, scene, error))
+        {
+            std::fprintf(stderr, "%s: %s\n", path.string().c_str(), error.c_str());
+            failed = argc > 1;
+            continue;
+        }
+        const double loadMs = MillisecondsSince(loadStart);
+
+        SceneBvh bvh;
+        SceneBvh::Stats best;
+        for (int i = 0; i < repeats; ++i)
+        {
+            bvh = SceneBvh();
+            bvh.Build(scene.MakeInput());
+            const SceneBvh::Stats& stats = bvh.GetStats();
+            if (i == 0 || stats.geometryMilliseconds + stats.instanceMilliseconds < best.geometryMilliseconds + best.instanceMilliseconds)
+                best = stats;
+        }
+
+        double sahCost = 0.0;
+        size_t maxDepth = 0;
+        for (size_t g = 0; g < best.geometryCount; ++g)
+        {
+            const BvhBuildStats& stats = bvh.GetGeometry(static_cast<uint32_t>(g)).GetStats();
+            sahCost += stats.sahCost * static_cast<double>(stats.primitiveCount);
+            maxDepth = std::max<size_t>(maxDepth, stats.maxDepth);
+        }
+
+        std::printf("%s: %zu geometries, %zu instances, %zu triangles (%zu instanced), loaded in %.1f ms\n",
+            scene.name.c_str(), best.geometryCount, best.instanceCount, best.triangleCount, best.instancedTriangles, loadMs);
+        if (scene.skippedFiles != 0)
+            std::printf("  %zu mesh file(s) missing or unreadable, left out\n", scene.skippedFiles);
+        std::printf("  build      geometry %8.2f ms (%6.2f Mtris/s, %zu nodes, SAH %.1f, depth %zu)  instances %6.2f ms (%zu nodes)\n",
+            best.geometryMilliseconds, MillionsPerSecond(best.triangleCount, best.geometryMilliseconds), best.geometryNodes,
+            best.triangleCount ? sahCost / static_cast<double>(best.triangleCount) : 0.0, maxDepth,
+            best.instanceMilliseconds, best.instanceNodes);
+
+        const BvhAabb bounds = bvh.GetBounds();
+        const std::vector<BvhRay> coherent = MakeCoherentRays(bounds, rayCount);
+        Report("coherent", coherent.size(), TraceRays(bvh, coherent, repeats));
+        const std::vector<BvhRay> incoherent = MakeIncoherentRays(bounds, rayCount, 3);
+        Report("incoherent", incoherent.size(), TraceRays(bvh, incoherent, repeats));
+    }
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,102 @@
+// Descriptor allocation cost per operation: random persistent ranges (1-16
+// descriptors, up to 4096 live) on a 1M-descriptor DescriptorRangeAllocator,
+// 20 transient tables a frame from the DescriptorRing, and bindless plus
+// deferred persistent traffic through the locked DescriptorAllocator facade.
+// Reports ns/op and where the persistent free list settles.
+//
+//   DescriptorAllocatorBenchmark [count] [seed]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "Resources/DescriptorAllocator.h"
+
+namespace
+{
+    using Clock = std::chrono::high_resolution_clock;
+
+    double NanosecondsSince(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const size_t count = argc > 1 ? static_cast<size_t>(std::max(1000, std::atoi(argv[1]))) : 2000000;
+    std::mt19937 rng(argc > 2 ? static_cast<uint32_t>(std::atoi(argv[2])) : 3);
+
+    // Persistent ranges.
+    {
+        DescriptorRangeAllocator allocator(0, 1u << 20);
+        std::vector<std::pair<uint32_t, uint32_t>> live;
+        live.reserve(4096);
+        size_t allocations = 0;
+        size_t frees = 0;
+        const auto start = Clock::now();
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (live.empty() || (live.size() < 4096 && rng() % 2 == 0))
+            {
+                const uint32_t size = 1 + rng() % 16;
+                const uint32_t offset = allocator.Allocate(size);
+                if (offset != DescriptorRangeAllocator::INVALID)
+                {
+                    live.emplace_back(offset, size);
+                    ++allocations;
+                }
+            }
+            else
+            {
+                const size_t index = rng() % live.size();
+                allocator.Free(live[index].first, live[index].second);
+                live[index] = live.back();
+                live.pop_back();
+                ++frees;
+            }
+        }
+        const double ns = NanosecondsSince(start);
+        const DescriptorRangeAllocator::Stats stats = allocator.GetStats();
+        std::printf("persistent: %6.1f ns/op (%zu allocations, %zu frees), %zu free range(s), fragmentation %.3f\n",
+            ns / static_cast<double>(count), allocations, frees, stats.freeRangeCount, stats.Fragmentation());
+    }
+
+    // Transient tables.
+    {
+        DescriptorRing ring(0, 4096, 3);
+        const size_t frames = std::max<size_t>(1, count / 20);
+        size_t failed = 0;
+        const auto start = Clock::now();
+        for (size_t frame = 0; frame < frames; ++frame)
+        {
+            for (uint32_t table = 0; table < 20; ++table)
+                failed += ring.Allocate(1 + table % 8) == DescriptorRing::INVALID;
+            ring.AdvanceFrame();
+        }
+        const double ns = NanosecondsSince(start);
+        std::printf("transient:  %6.1f ns/table, peak in flight %u of %u, %zu failed\n",
+            ns / static_cast<double>(frames * 20), ring.GetPeakInFlight(), ring.GetCapacity(), failed);
+    }
+
+    // Facade: a persistent range and a bindless index per op, retired 3 frames later.
+    {
+        DescriptorAllocator allocator(65536, 4096, 3);
+        allocator.GetBindlessTable("Textures", 4096);
+        const auto start = Clock::now();
+        for (size_t i = 0; i < count; ++i)
+        {
+            allocator.Free(allocator.Allocate(4));
+            allocator.FreeBindless("Textures", allocator.AllocateBindless("Textures"));
+            if (i % 64 == 63)
+                allocator.AdvanceFrame();
+        }
+        const double ns = NanosecondsSince(start);
+        std::printf("facade:     %6.1f ns/op (range + bindless index)\n", ns / static_cast<double>(count));
+    }
+    return 0;
+}
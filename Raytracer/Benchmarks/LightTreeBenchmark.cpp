@@ -0,0 +1,139 @@
+// VXPG bottom light-tree build per stage (encode, sort, hierarchy, merge) on
+// the lit voxels of each scene's CPU voxel bake (Sponza and the Tungsten
+// scenes by default), clustered into 32 spatial regions the way k-means
+// tends to split a scene, then on random voxels of a 1024^3 grid up to 4M
+// leaves. BuildLightTree stops at LIGHT_TREE_MAX_LEAVES like the shader;
+// BuildWideLightTree takes every voxel. Best of `repeats` per stage.
+//
+//   LightTreeBenchmark [scene.gltf|scene.bsc|tungstenDir] [gridDim] [repeats]
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "BenchmarkScenes.h"
+#include "SceneResources/LightTree.h"
+#include "SceneResources/Voxelizer.h"
+#include "Utils/ThreadPool.h"
+
+namespace
+{
+    struct Inputs
+    {
+        std::vector<uint32_t> compactIds;
+        std::vector<int32_t> clusters;
+        std::vector<float> irradiance;
+
+        [[nodiscard]] LightTreeInput View() const
+        {
+            return { compactIds.data(), clusters.data(), irradiance.data(), static_cast<uint32_t>(compactIds.size()) };
+        }
+    };
+
+    // 4 x 4 x 2 boxes over the grid, plus a few unclustered voxels.
+    Inputs MakeInputs(std::vector<uint32_t> ids, uint32_t gridDim, uint32_t seed)
+    {
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<float> irradiance(0.0f, 4.0f);
+        Inputs inputs;
+        inputs.compactIds = std::move(ids);
+        inputs.clusters.resize(inputs.compactIds.size());
+        inputs.irradiance.resize(inputs.compactIds.size());
+        for (size_t i = 0; i < inputs.compactIds.size(); ++i)
+        {
+            const uint32_t id = inputs.compactIds[i];
+            const uint32_t x = id % gridDim * 4 / gridDim;
+            const uint32_t y = id / gridDim % gridDim * 4 / gridDim;
+            const uint32_t z = id / gridDim / gridDim * 2 / gridDim;
+            inputs.clusters[i] = rng() % 64 == 0 ? -1 : static_cast<int32_t>(x + y * 4 + z * 16);
+            inputs.irradiance[i] = irradiance(rng);
+        }
+        return inputs;
+    }
+
+    template <typename Build>
+    LightTreeBuildStats BestOf(int repeats, Build&& build)
+    {
+        LightTreeBuildStats best;
+        for (int i = 0; i < repeats; ++i)
+        {
+            const LightTreeBuildStats stats = build();
+            if (i == 0)
+            {
+                best = stats;
+                continue;
+            }
+            best.encodeMilliseconds = std::min(best.encodeMilliseconds, stats.encodeMilliseconds);
+            best.sortMilliseconds = std::min(best.sortMilliseconds, stats.sortMilliseconds);
+            best.hierarchyMilliseconds = std::min(best.hierarchyMilliseconds, stats.hierarchyMilliseconds);
+            best.mergeMilliseconds = std::min(best.mergeMilliseconds, stats.mergeMilliseconds);
+        }
+        return best;
+    }
+
+    void Report(const char* label, const LightTreeBuildStats& stats)
+    {
+        std::printf("  %-8s %8u leaves  encode %7.2f  sort %7.2f  hierarchy %7.2f  merge %7.2f  total %8.2f ms  (%.1f M leaves/s)\n",
+            label, stats.leafCount, stats.encodeMilliseconds, stats.sortMilliseconds, stats.hierarchyMilliseconds, stats.mergeMilliseconds,
+            stats.TotalMilliseconds(), stats.TotalMilliseconds() > 0.0 ? static_cast<double>(stats.leafCount) / (stats.TotalMilliseconds() * 1000.0) : 0.0);
+    }
+
+    void Run(const Inputs& inputs, const VoxelGridConstants& grid, int repeats)
+    {
+        const LightTreeInput input = inputs.View();
+        Report("compact", BestOf(repeats, [&] { return BuildLightTree(input, grid).stats; }));
+        Report("wide", BestOf(repeats, [&] { return BuildWideLightTree(input, grid).stats; }));
+    }
+}
+
+int main(int argc, char** argv)
+{
+    namespace fs = std::filesystem;
+    const std::vector<fs::path> scenes = argc > 1 ? std::vector<fs::path>{ fs::path(argv[1]) } : BenchmarkScenes::DefaultScenes();
+    const uint32_t gridDim = argc > 2 ? static_cast<uint32_t>(std::atoi(argv[2])) : 128;
+    const int repeats = argc > 3 ? std::max(1, std::atoi(argv[3])) : 5;
+    std::printf("%u thread(s)\n", ThreadPool::Get().GetThreadCount());
+
+    bool failed = false;
+    for (const fs::path& path : scenes)
+    {
+        BenchmarkScenes::Scene scene;
+        std::string error;
+        if (!BenchmarkScenes::Load(path, scene, error))
+        {
+            std::fprintf(stderr, "%s: %s\n", path.string().c_str(), error.c_str());
+            failed = argc > 1;
+            continue;
+        }
+        VoxelBakeSettings settings;
+        settings.gridDim = gridDim;
+        VoxelBake bake = Voxelizer::Bake(scene.MakeInput(), scene.WorldBounds(), settings);
+        if (bake.cells.empty())
+        {
+            std::fprintf(stderr, "%s: nothing voxelized at %u^3\n", scene.name.c_str(), gridDim);
+            failed = true;
+            continue;
+        }
+        std::printf("%s: %zu lit voxels at %u^3\n", scene.name.c_str(), bake.cells.size(), gridDim);
+        Run(MakeInputs(std::move(bake.cells), gridDim, 1), bake.grid, repeats);
+    }
+
+    // Past what a scene bake gives: random voxels of a fine grid.
+    VoxelGridConstants grid{};
+    grid.gridDim = 1024;
+    grid.voxelSize = 1.0f / 1024.0f;
+    std::mt19937 rng(7);
+    for (uint32_t count : { 1u << 15, 1u << 18, 1u << 20, 1u << 22 })
+    {
+        std::vector<uint32_t> ids(count);
+        for (uint32_t& id : ids)
+            id = rng() % (1u << 30);
+        std::printf("random: %u voxels at 1024^3\n", count);
+        Run(MakeInputs(std::move(ids), grid.gridDim, count), grid, repeats);
+    }
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,157 @@
+// Normal and tangent generation on the largest Tungsten meshes: the meshes
+// each scene references (BenchmarkScenes::LoadTungsten), ranked by triangle
+// count across scenes, read with Wo3Mesh and stripped of zero-area triangles
+// as TungstenLoading does. Times ComputeNormals and ComputeTangents against
+// their single-threaded references, best of `repeats`, and checks that the
+// results are bit-identical.
+//
+//   MeshAttributesBenchmark [tungstenDir] [meshes] [repeats]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "BenchmarkScenes.h"
+#include "SceneResources/MeshAttributes.h"
+#include "SceneResources/Wo3Mesh.h"
+#include "Utils/ThreadPool.h"
+
+namespace
+{
+    namespace fs = std::filesystem;
+    using Clock = std::chrono::high_resolution_clock;
+    using VertexPacking::FloatVertex;
+    using Generate = void (*)(FloatVertex*, size_t, const uint32_t*, size_t);
+
+    double MillisecondsSince(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    struct Mesh
+    {
+        std::vector<FloatVertex> vertices;
+        std::vector<uint32_t> indices;
+    };
+
+    bool LoadMesh(const fs::path& path, Mesh& mesh)
+    {
+        Wo3Mesh::File file;
+        if (file.Open(path) != Wo3Mesh::Status::Ok)
+            return false;
+        mesh.vertices.resize(static_cast<size_t>(file.VertexCount()));
+        for (size_t i = 0; i < mesh.vertices.size(); ++i)
+        {
+            const Wo3Mesh::Vertex& s = file.Vertices()[i];
+            mesh.vertices[i] = { { s.px, s.py, s.pz }, { s.nx, s.ny, s.nz }, { 0.0f, 0.0f, 0.0f, 1.0f }, { s.u, s.v } };
+        }
+        std::vector<uint32_t> indices(static_cast<size_t>(file.TriangleCount()) * 3);
+        size_t badTriangle = 0;
+        if (!Wo3Mesh::CopyIndices(file, indices.data(), badTriangle))
+            return false;
+
+        mesh.indices.clear();
+        for (size_t i = 0; i + 2 < indices.size(); i += 3)
+        {
+            const float* p0 = mesh.vertices[indices[i]].position;
+            const float* p1 = mesh.vertices[indices[i + 1]].position;
+            const float* p2 = mesh.vertices[indices[i + 2]].position;
+            const float e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+            const float e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+            const float c[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+            if (c[0] * c[0] + c[1] * c[1] + c[2] * c[2] > 1e-20f)
+                mesh.indices.insert(mesh.indices.end(), { indices[i], indices[i + 1], indices[i + 2] });
+        }
+        return true;
+    }
+
+    // Best of `repeats` on a fresh copy of the mesh each time; `out` keeps the last result.
+    double Time(Generate generate, const Mesh& mesh, int repeats, std::vector<FloatVertex>& out)
+    {
+        double best = 1e30;
+        for (int r = 0; r < repeats; ++r)
+        {
+            out = mesh.vertices;
+            const auto start = Clock::now();
+            generate(out.data(), out.size(), mesh.indices.data(), mesh.indices.size());
+            best = std::min(best, MillisecondsSince(start));
+        }
+        return best;
+    }
+
+    bool Same(const std::vector<FloatVertex>& a, const std::vector<FloatVertex>& b)
+    {
+        return a.size() == b.size() && std::memcmp(a.data(), b.data(), a.size() * sizeof(FloatVertex)) == 0;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::vector<fs::path> scenes;
+    if (argc > 1)
+        scenes.push_back(fs::path(argv[1]));
+    else
+        for (const fs::path& path : BenchmarkScenes::DefaultScenes())
+            if (fs::is_directory(path))
+                scenes.push_back(path);
+    const size_t meshCount = argc > 2 ? static_cast<size_t>(std::max(1, std::atoi(argv[2]))) : 8;
+    const int repeats = argc > 3 ? std::max(1, std::atoi(argv[3])) : 5;
+    std::printf("%u thread(s)\n", ThreadPool::Get().GetThreadCount());
+
+    // (triangles, file) for every mesh some scene references, largest first.
+    std::vector<std::pair<uint32_t, fs::path>> candidates;
+    bool failed = false;
+    for (const fs::path& path : scenes)
+    {
+        BenchmarkScenes::Scene scene;
+        std::string error;
+        if (!BenchmarkScenes::LoadTungsten(path, scene, error))
+        {
+            std::fprintf(stderr, "%s: %s\n", path.string().c_str(), error.c_str());
+            failed = argc > 1;
+            continue;
+        }
+        for (size_t g = 0; g < scene.geometries.size(); ++g)
+            candidates.emplace_back(scene.geometries[g].indexCount / 3, scene.geometryFiles[g]);
+    }
+    std::sort(candidates.begin(), candidates.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+    candidates.resize(std::min(candidates.size(), meshCount));
+
+    for (const auto& candidate : candidates)
+    {
+        const fs::path& path = candidate.second;
+        const std::string name = path.parent_path().parent_path().filename().string() + "/" + path.filename().string();
+        Mesh mesh;
+        if (!LoadMesh(path, mesh) || mesh.indices.empty())
+        {
+            std::fprintf(stderr, "%s: cannot read\n", name.c_str());
+            failed = true;
+            continue;
+        }
+
+        std::vector<FloatVertex> reference;
+        std::vector<FloatVertex> parallel;
+        const double normalsReference = Time(MeshAttributes::ComputeNormalsReference, mesh, repeats, reference);
+        const double normals = Time(MeshAttributes::ComputeNormals, mesh, repeats, parallel);
+        const bool normalsSame = Same(reference, parallel);
+
+        // Tangents from the generated normals, as GenerateAttributes runs them.
+        Mesh withNormals = { reference, mesh.indices };
+        const double tangentsReference = Time(MeshAttributes::ComputeTangentsReference, withNormals, repeats, reference);
+        const double tangents = Time(MeshAttributes::ComputeTangents, withNormals, repeats, parallel);
+        const bool tangentsSame = Same(reference, parallel);
+
+        std::printf("%-28s %8zu tris  normals %8.2f -> %8.2f ms (%.2fx)%s  tangents %8.2f -> %8.2f ms (%.2fx)%s\n",
+            name.c_str(), mesh.indices.size() / 3,
+            normalsReference, normals, normalsReference / normals, normalsSame ? "" : " DIFFERENT",
+            tangentsReference, tangents, tangentsReference / tangents, tangentsSame ? "" : " DIFFERENT");
+        failed |= !normalsSame || !tangentsSame;
+    }
+    return failed ? 1 : 0;
+}
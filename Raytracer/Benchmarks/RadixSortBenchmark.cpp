@@ -0,0 +1,115 @@
+// RadixSort from 1K to `maxCount` light-tree style keys (cluster, Morton
+// code, unique index), doubling by 4: LSD radix with 8- and 11-bit digits
+// against std::sort and the bitonic network BitonicSortPass runs (up to 4M
+// keys). Reports ms and Mkeys/s per sorter, and whether they agree.
+//
+//   RadixSortBenchmark [maxCount] [seed]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "Utils/RadixSort.h"
+#include "Utils/ThreadPool.h"
+
+namespace
+{
+    using Clock = std::chrono::high_resolution_clock;
+
+    constexpr size_t BITONIC_LIMIT = size_t(1) << 22;
+
+    double MillisecondsSince(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    double MillionsPerSecond(size_t count, double milliseconds)
+    {
+        return milliseconds > 0.0 ? static_cast<double>(count) / (milliseconds * 1000.0) : 0.0;
+    }
+
+    uint32_t Pcg(uint32_t& state)
+    {
+        state = state * 747796405u + 2891336453u;
+        const uint32_t word = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+        return (word >> 22u) ^ word;
+    }
+
+    // Times in milliseconds; bitonic is skipped (0) above BITONIC_LIMIT.
+    // `agree` is set when every sorter produced the same order.
+    struct Point
+    {
+        double radix8Milliseconds = 0.0;
+        double radix11Milliseconds = 0.0;
+        double stdSortMilliseconds = 0.0;
+        double bitonicMilliseconds = 0.0;
+        bool agree = false;
+    };
+
+    Point Measure(size_t count, uint32_t seed)
+    {
+        // 5-bit cluster, 30-bit Morton code, 28-bit index: unique, with
+        // constant top bits like the light-tree keys.
+        std::vector<uint64_t> input(count);
+        uint32_t state = seed;
+        for (size_t i = 0; i < count; ++i)
+        {
+            const uint64_t cluster = Pcg(state) & 31u;
+            const uint64_t morton = Pcg(state) & 0x3fffffffu;
+            input[i] = (cluster << 58) | (morton << 28) | (i & 0xfffffffu);
+        }
+
+        Point point;
+        std::vector<uint64_t> reference = input;
+        auto start = Clock::now();
+        std::sort(reference.begin(), reference.end());
+        point.stdSortMilliseconds = MillisecondsSince(start);
+
+        point.agree = true;
+        for (uint32_t digitBits : { 8u, 11u })
+        {
+            std::vector<uint64_t> keys = input;
+            start = Clock::now();
+            RadixSort::Sort(keys.data(), keys.size(), RadixSort::Settings{ digitBits });
+            (digitBits == 8 ? point.radix8Milliseconds : point.radix11Milliseconds) = MillisecondsSince(start);
+            point.agree = point.agree && keys == reference;
+        }
+
+        if (count <= BITONIC_LIMIT)
+        {
+            std::vector<uint64_t> keys = input;
+            start = Clock::now();
+            RadixSort::BitonicSort(keys.data(), keys.size());
+            point.bitonicMilliseconds = MillisecondsSince(start);
+            point.agree = point.agree && keys == reference;
+        }
+        return point;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const size_t maxCount = argc > 1 ? static_cast<size_t>(std::max(1024.0, std::atof(argv[1]))) : size_t(1) << 24;
+    const uint32_t seed = argc > 2 ? static_cast<uint32_t>(std::atoi(argv[2])) : 1;
+    std::printf("%u thread(s)\n", ThreadPool::Get().GetThreadCount());
+    std::printf("%10s  %18s  %18s  %18s  %18s\n", "keys", "radix8", "radix11", "std::sort", "bitonic");
+
+    bool failed = false;
+    for (size_t count = 1024; count <= maxCount; count *= 4)
+    {
+        const Point point = Measure(count, seed);
+        std::printf("%10zu", count);
+        for (double ms : { point.radix8Milliseconds, point.radix11Milliseconds, point.stdSortMilliseconds, point.bitonicMilliseconds })
+        {
+            if (ms > 0.0)
+                std::printf("  %8.2f ms %5.0f M/s", ms, MillionsPerSecond(count, ms));
+            else
+                std::printf("  %18s", "-");
+        }
+        std::printf("%s\n", point.agree ? "" : "  MISMATCH");
+        failed |= !point.agree;
+    }
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,199 @@
+// Scene build stage on synthetic scenes of thousands of primitives: the
+// geometry-id lookup SceneBuilder::Build used to do (std::find over every
+// primitive per instance) against ids assigned at AddModel, instance packing
+// over InstanceOffsets ranges, and the world AABB as the old serial
+// eight-corner loop against SceneBuildPasses::ComputeWorldBounds. Best of
+// `repeats` runs per stage.
+//
+//   SceneBuildBenchmark [maxPrimitives] [repeats]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "SceneResources/SceneBuildPasses.h"
+#include "Utils/ThreadPool.h"
+
+namespace
+{
+    using namespace SceneBuildPasses;
+    using Clock = std::chrono::high_resolution_clock;
+
+    double MillisecondsSince(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    struct Primitive
+    {
+        uint32_t geometryId;
+        Bounds local;
+    };
+
+    // The fields of InstanceInfo the pass writes.
+    struct Instance
+    {
+        uint32_t geometryId;
+        float objectToWorld[3][4];
+    };
+
+    struct SyntheticScene
+    {
+        std::vector<Primitive> primitives;
+        std::vector<const Primitive*> primitiveList; // SceneBuilder::m_primitives
+        std::vector<std::vector<const Primitive*>> objects; // each game object's model meshes
+        std::vector<Matrix> worlds;
+    };
+
+    // Models of 1-4 primitives, each placed by two game objects.
+    SyntheticScene MakeScene(size_t primitiveCount)
+    {
+        std::mt19937 rng(11);
+        std::uniform_real_distribution<float> u(-1.0f, 1.0f);
+        SyntheticScene scene;
+        scene.primitives.resize(primitiveCount);
+        for (size_t i = 0; i < primitiveCount; ++i)
+        {
+            scene.primitives[i].geometryId = static_cast<uint32_t>(i);
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                scene.primitives[i].local.min[axis] = u(rng) - 1.0f;
+                scene.primitives[i].local.max[axis] = u(rng) + 1.0f;
+            }
+            scene.primitiveList.push_back(&scene.primitives[i]);
+        }
+
+        for (size_t first = 0; first < primitiveCount;)
+        {
+            const size_t count = std::min<size_t>(1 + rng() % 4, primitiveCount - first);
+            std::vector<const Primitive*> model(scene.primitiveList.begin() + static_cast<std::ptrdiff_t>(first),
+                scene.primitiveList.begin() + static_cast<std::ptrdiff_t>(first + count));
+            for (int copy = 0; copy < 2; ++copy)
+            {
+                Matrix world{};
+                for (int r = 0; r < 3; ++r)
+                    world.m[r][r] = 0.5f + 0.5f * std::fabs(u(rng));
+                world.m[0][1] = u(rng) * 0.3f;
+                world.m[3][0] = u(rng) * 100.0f;
+                world.m[3][1] = u(rng) * 100.0f;
+                world.m[3][2] = u(rng) * 100.0f;
+                world.m[3][3] = 1.0f;
+                scene.objects.push_back(model);
+                scene.worlds.push_back(world);
+            }
+            first += count;
+        }
+        return scene;
+    }
+
+    void Transpose(const Matrix& world, float out[3][4])
+    {
+        for (int r = 0; r < 3; ++r)
+            for (int c = 0; c < 4; ++c)
+                out[r][c] = world.m[c][r];
+    }
+
+    struct Timings
+    {
+        double findLookup = std::numeric_limits<double>::infinity();
+        double pack = std::numeric_limits<double>::infinity();
+        double cornerBounds = std::numeric_limits<double>::infinity();
+        double worldBounds = std::numeric_limits<double>::infinity();
+    };
+
+    void Run(size_t primitiveCount, int repeats)
+    {
+        const SyntheticScene scene = MakeScene(primitiveCount);
+        Timings best;
+        size_t instanceCount = 0;
+        size_t idMismatches = 0;
+        float boundsError = 0.0f;
+        for (int repeat = 0; repeat < repeats; ++repeat)
+        {
+            // Before: each instance's geometry id was its position in m_primitives.
+            auto start = Clock::now();
+            for (const auto& meshes : scene.objects)
+                for (const Primitive* primitive : meshes)
+                {
+                    const auto found = std::find(scene.primitiveList.begin(), scene.primitiveList.end(), primitive);
+                    idMismatches += static_cast<size_t>(found - scene.primitiveList.begin()) != primitive->geometryId;
+                }
+            best.findLookup = std::min(best.findLookup, MillisecondsSince(start));
+
+            // After: offsets, then one parallel pass with the stored ids.
+            start = Clock::now();
+            std::vector<uint32_t> counts(scene.objects.size());
+            for (size_t i = 0; i < scene.objects.size(); ++i)
+                counts[i] = static_cast<uint32_t>(scene.objects[i].size());
+            const std::vector<size_t> offsets = InstanceOffsets(counts);
+            std::vector<Instance> instances(offsets.back());
+            std::vector<Bounds> localBounds(offsets.back());
+            ThreadPool::Get().ParallelFor(scene.objects.size(), [&](size_t i)
+            {
+                size_t out = offsets[i];
+                for (const Primitive* primitive : scene.objects[i])
+                {
+                    instances[out].geometryId = primitive->geometryId;
+                    Transpose(scene.worlds[i], instances[out].objectToWorld);
+                    localBounds[out++] = primitive->local;
+                }
+            });
+            best.pack = std::min(best.pack, MillisecondsSince(start));
+            instanceCount = instances.size();
+
+            // Before: eight transformed corners per primitive, serially.
+            start = Clock::now();
+            Bounds corners;
+            for (size_t i = 0; i < scene.objects.size(); ++i)
+            {
+                const Matrix& world = scene.worlds[i];
+                for (const Primitive* primitive : scene.objects[i])
+                {
+                    const Bounds& local = primitive->local;
+                    for (int corner = 0; corner < 8; ++corner)
+                    {
+                        const float p[3] = {
+                            corner & 1 ? local.max[0] : local.min[0],
+                            corner & 2 ? local.max[1] : local.min[1],
+                            corner & 4 ? local.max[2] : local.min[2] };
+                        for (int c = 0; c < 3; ++c)
+                        {
+                            const float v = p[0] * world.m[0][c] + p[1] * world.m[1][c] + p[2] * world.m[2][c] + world.m[3][c];
+                            corners.min[c] = std::min(corners.min[c], v);
+                            corners.max[c] = std::max(corners.max[c], v);
+                        }
+                    }
+                }
+            }
+            best.cornerBounds = std::min(best.cornerBounds, MillisecondsSince(start));
+
+            start = Clock::now();
+            const Bounds bounds = ComputeWorldBounds(scene.worlds, offsets, localBounds);
+            best.worldBounds = std::min(best.worldBounds, MillisecondsSince(start));
+            for (int axis = 0; axis < 3; ++axis)
+                boundsError = std::max({ boundsError, std::fabs(bounds.min[axis] - corners.min[axis]), std::fabs(bounds.max[axis] - corners.max[axis]) });
+        }
+
+        std::printf("%7zu primitives, %7zu instances: geometry ids by find %9.3f ms, packing %7.3f ms; world AABB corners %7.3f ms, ComputeWorldBounds %7.3f ms (max diff %.1e)\n",
+            primitiveCount, instanceCount, best.findLookup, best.pack, best.cornerBounds, best.worldBounds,
+            static_cast<double>(boundsError));
+        if (idMismatches != 0)
+            std::fprintf(stderr, "  %zu stored geometry id(s) differ from the lookup\n", idMismatches);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const size_t maxPrimitives = argc > 1 ? static_cast<size_t>(std::max(1000, std::atoi(argv[1]))) : 16000;
+    const int repeats = argc > 2 ? std::max(1, std::atoi(argv[2])) : 5;
+
+    std::printf("%u thread(s)\n", ThreadPool::Get().GetThreadCount());
+    for (size_t primitives = 1000; primitives <= maxPrimitives; primitives *= 4)
+        Run(primitives, repeats);
+    return 0;
+}
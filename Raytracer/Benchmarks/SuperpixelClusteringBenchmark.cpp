@@ -0,0 +1,146 @@
+// SLIC superpixels per scene (Sponza and the Tungsten scenes by default) on a
+// ShadingPoints G-buffer traced with SceneBvh: primary hit positions and
+// octahedral geometric normals of a 16:9, 90 degree view from the scene
+// centre. MeasureIterations from 0 to `maxIterations` for the shader's tile
+// centre update and the SLIC member update: build time, fallback pixels,
+// boundary recall and compactness per iteration count.
+//
+//   SuperpixelClusteringBenchmark [scene.gltf|scene.bsc|tungstenDir] [width] [maxIterations]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "BenchmarkScenes.h"
+#include "SceneResources/SceneBvh.h"
+#include "SceneResources/SuperpixelClustering.h"
+#include "SceneResources/VertexPacking.h"
+#include "Utils/ThreadPool.h"
+
+namespace
+{
+    using Clock = std::chrono::high_resolution_clock;
+
+    double MillisecondsSince(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    // RGBA32F texels: xyz the hit, w the normal's UNORM16x2 octahedral bits;
+    // x = 1e30 where the ray leaves the scene, as the G-buffer clears it.
+    std::vector<float> TraceShadingPoints(const BenchmarkScenes::Scene& scene, const SceneBvh& bvh, uint32_t width, uint32_t height)
+    {
+        const BvhAabb bounds = bvh.GetBounds();
+        std::vector<BvhRay> rays(static_cast<size_t>(width) * height);
+        const float aspect = static_cast<float>(height) / static_cast<float>(width);
+        for (uint32_t y = 0; y < height; ++y)
+        {
+            for (uint32_t x = 0; x < width; ++x)
+            {
+                BvhRay& ray = rays[static_cast<size_t>(y) * width + x];
+                const float u = (static_cast<float>(x) + 0.5f) / static_cast<float>(width) * 2.0f - 1.0f;
+                const float v = (static_cast<float>(y) + 0.5f) / static_cast<float>(height) * 2.0f - 1.0f;
+                const float direction[3] = { 0.7071f + 0.7071f * u, -v * aspect, -0.7071f + 0.7071f * u };
+                const float length = std::sqrt(direction[0] * direction[0] + direction[1] * direction[1] + direction[2] * direction[2]);
+                for (int a = 0; a < 3; ++a)
+                {
+                    ray.origin[a] = 0.5f * (bounds.min[a] + bounds.max[a]);
+                    ray.direction[a] = direction[a] / length;
+                }
+            }
+        }
+        std::vector<BvhHit> hits(rays.size());
+        bvh.IntersectBatch(rays.data(), hits.data(), rays.size());
+
+        std::vector<float> texels(rays.size() * 4, 0.0f);
+        for (size_t i = 0; i < rays.size(); ++i)
+        {
+            float* texel = texels.data() + i * 4;
+            const BvhHit& hit = hits[i];
+            if (!hit.IsHit())
+            {
+                texel[0] = 1e30f;
+                continue;
+            }
+            for (int a = 0; a < 3; ++a)
+                texel[a] = rays[i].origin[a] + rays[i].direction[a] * hit.t;
+
+            const BvhInstance& instance = scene.instances[hit.instance];
+            const BvhGeometry& geometry = scene.geometries[instance.geometry];
+            float corners[3][3];
+            for (int c = 0; c < 3; ++c)
+            {
+                const uint32_t index = scene.indices[geometry.indexOffset + hit.primitive * 3 + static_cast<uint32_t>(c)];
+                const float* p = &scene.positions[(static_cast<size_t>(geometry.vertexOffset) + index) * 3];
+                for (int r = 0; r < 3; ++r)
+                    corners[c][r] = instance.objectToWorld[r][0] * p[0] + instance.objectToWorld[r][1] * p[1] + instance.objectToWorld[r][2] * p[2];
+            }
+            const float e1[3] = { corners[1][0] - corners[0][0], corners[1][1] - corners[0][1], corners[1][2] - corners[0][2] };
+            const float e2[3] = { corners[2][0] - corners[0][0], corners[2][1] - corners[0][1], corners[2][2] - corners[0][2] };
+            float normal[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+            const float length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+            // Facing the camera, as a shading normal would.
+            const float sign = normal[0] * rays[i].direction[0] + normal[1] * rays[i].direction[1] + normal[2] * rays[i].direction[2] > 0.0f ? -1.0f : 1.0f;
+            for (float& n : normal)
+                n = length > 0.0f ? n * sign / length : 0.0f;
+            if (length == 0.0f)
+                normal[1] = 1.0f;
+            const uint32_t packed = VertexPacking::EncodeOctahedron(normal);
+            std::memcpy(&texel[3], &packed, sizeof(packed));
+        }
+        return texels;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    namespace fs = std::filesystem;
+    const std::vector<fs::path> scenes = argc > 1 ? std::vector<fs::path>{ fs::path(argv[1]) } : BenchmarkScenes::DefaultScenes();
+    const uint32_t width = argc > 2 ? static_cast<uint32_t>(std::max(64, std::atoi(argv[2]))) : 1280;
+    const uint32_t height = width * 9 / 16;
+    const uint32_t maxIterations = argc > 3 ? static_cast<uint32_t>(std::max(0, std::atoi(argv[3]))) : 4;
+    std::printf("%u thread(s), %ux%u\n", ThreadPool::Get().GetThreadCount(), width, height);
+
+    bool failed = false;
+    for (const fs::path& path : scenes)
+    {
+        BenchmarkScenes::Scene scene;
+        std::string error;
+        if (!BenchmarkScenes::Load(path, scene, error))
+        {
+            std::fprintf(stderr, "%s: %s\n", path.string().c_str(), error.c_str());
+            failed = argc > 1;
+            continue;
+        }
+        SceneBvh bvh;
+        bvh.Build(scene.MakeInput());
+        const auto traceStart = Clock::now();
+        const std::vector<float> texels = TraceShadingPoints(scene, bvh, width, height);
+        std::printf("%s: G-buffer traced in %.1f ms\n", scene.name.c_str(), MillisecondsSince(traceStart));
+
+        SuperpixelInput input;
+        input.texels = texels.data();
+        input.width = width;
+        input.height = height;
+
+        const struct { const char* name; SuperpixelCenterUpdate update; } updates[] = {
+            { "tile", SuperpixelCenterUpdate::Tile }, { "members", SuperpixelCenterUpdate::Members } };
+        for (const auto& update : updates)
+        {
+            SuperpixelSettings settings;
+            settings.update = update.update;
+            for (const SuperpixelMeasurement& measurement : SuperpixelClustering::MeasureIterations(input, settings, maxIterations))
+            {
+                std::printf("  %-7s %u iteration(s)  %7.2f ms  %6u fallback  recall %.3f  compactness %.3f  (%u segments, %u edge pixels)\n",
+                    update.name, measurement.iterations, measurement.milliseconds, measurement.fallbackPixels,
+                    measurement.quality.boundaryRecall, measurement.quality.compactness, measurement.quality.segments, measurement.quality.edgePixels);
+            }
+        }
+    }
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,160 @@
+// Offline texture preparation throughput and quality: decodes every .png/.jpg
+// in a directory, builds the mip chain and BCn-encodes each level the way
+// TextureProcessing::Encode does, then reports per image and in total the
+// mip and encode rates (source MB/s over RGBA8 texels) and the PSNR of the
+// decoded top level.
+//
+//   TextureProcessingBenchmark [imageDir] [albedo|normal|mr|mask|generic] [box|kaiser] [maxImages]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "SceneResources/TextureDecoding.h"
+#include "SceneResources/TextureProcessing.h"
+
+namespace
+{
+    namespace fs = std::filesystem;
+    using namespace TextureProcessing;
+    using Clock = std::chrono::high_resolution_clock;
+
+    double MillisecondsSince(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    bool ParseUsage(const char* name, TextureUsage& usage)
+    {
+        struct Entry
+        {
+            const char* name;
+            TextureUsage usage;
+        };
+        const Entry entries[] = {
+            { "albedo", TextureUsage::Albedo },
+            { "normal", TextureUsage::Normal },
+            { "mr", TextureUsage::MetallicRoughness },
+            { "mask", TextureUsage::Mask },
+            { "generic", TextureUsage::Generic },
+        };
+        for (const Entry& entry : entries)
+        {
+            if (std::strcmp(name, entry.name) == 0)
+            {
+                usage = entry.usage;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    double MegabytesPerSecond(double bytes, double milliseconds)
+    {
+        return milliseconds > 0.0 ? bytes / (1024.0 * 1024.0) / (milliseconds / 1000.0) : 0.0;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const fs::path root = argc > 1 ? fs::path(argv[1]) : fs::path(RAYTRACER_RESOURCE_DIR) / "Models" / "Sponza" / "glTF";
+    TextureUsage usage = TextureUsage::Albedo;
+    if (argc > 2 && !ParseUsage(argv[2], usage))
+    {
+        std::fprintf(stderr, "TextureProcessingBenchmark: unknown usage '%s'\n", argv[2]);
+        return 1;
+    }
+    const MipFilter filter = argc > 3 && std::strcmp(argv[3], "box") == 0 ? MipFilter::Box : MipFilter::Kaiser;
+    const size_t maxImages = argc > 4 ? static_cast<size_t>(std::max(0, std::atoi(argv[4]))) : 0;
+
+    std::error_code error;
+    if (!fs::is_directory(root, error))
+    {
+        std::fprintf(stderr, "TextureProcessingBenchmark: '%s' is not a directory\n", root.string().c_str());
+        return 1;
+    }
+
+    std::vector<fs::path> files;
+    for (const fs::directory_entry& entry : fs::directory_iterator(root))
+    {
+        const std::string extension = entry.path().extension().string();
+        if (entry.is_regular_file() && (extension == ".png" || extension == ".jpg" || extension == ".jpeg"))
+            files.push_back(entry.path());
+    }
+    std::sort(files.begin(), files.end());
+    if (maxImages != 0 && files.size() > maxImages)
+        files.resize(maxImages);
+
+    double totalBytes = 0.0;
+    double totalMipMs = 0.0;
+    double totalEncodeMs = 0.0;
+    double minPsnr = std::numeric_limits<double>::infinity();
+    double psnrSum = 0.0;
+    size_t finitePsnrs = 0;
+    size_t measured = 0;
+    bool failed = false;
+    for (const fs::path& path : files)
+    {
+        TextureDecoding::Image image;
+        const char* reason = nullptr;
+        if (!TextureDecoding::DecodeFile(path, image, &reason))
+        {
+            std::fprintf(stderr, "%s: %s\n", path.filename().string().c_str(), reason ? reason : "decode failed");
+            failed = true;
+            continue;
+        }
+
+        const auto mipStart = Clock::now();
+        const std::vector<Surface> mips = GenerateMips(image.rgba.data(), image.width, image.height, usage, filter);
+        const double mipMs = MillisecondsSince(mipStart);
+
+        EncodedTexture encoded;
+        encoded.format = ChooseFormat(usage, image.width, image.height);
+        encoded.usage = usage;
+        const auto encodeStart = Clock::now();
+        double bytes = 0.0;
+        for (const Surface& level : mips)
+        {
+            bytes += static_cast<double>(level.data.size());
+            encoded.mips.push_back(EncodeLevel(level, encoded.format, usage));
+        }
+        const double encodeMs = MillisecondsSince(encodeStart);
+
+        std::vector<uint8_t> decoded;
+        DecodeLevel(encoded, 0, decoded);
+        const double psnr = ComputePsnr(mips[0].data.data(), decoded.data(),
+            static_cast<size_t>(image.width) * image.height, SignificantChannels(usage));
+
+        std::printf("%-28s %5dx%-5d fmt %3u  mips %8.2f ms (%7.1f MB/s)  encode %8.2f ms (%7.1f MB/s)  L0 %6.2f dB\n",
+            path.filename().string().c_str(), image.width, image.height, static_cast<unsigned>(encoded.format),
+            mipMs, MegabytesPerSecond(bytes, mipMs), encodeMs, MegabytesPerSecond(bytes, encodeMs), psnr);
+
+        totalBytes += bytes;
+        totalMipMs += mipMs;
+        totalEncodeMs += encodeMs;
+        minPsnr = std::min(minPsnr, psnr);
+        if (std::isfinite(psnr))
+        {
+            psnrSum += psnr;
+            ++finitePsnrs;
+        }
+        ++measured;
+    }
+
+    if (measured == 0)
+    {
+        std::fprintf(stderr, "TextureProcessingBenchmark: no images in '%s'\n", root.string().c_str());
+        return 1;
+    }
+    std::printf("%zu image(s), %.1f MB of RGBA8 levels: mips %.1f MB/s, encode %.1f MB/s, L0 PSNR min %.2f dB, mean %.2f dB\n",
+        measured, totalBytes / (1024.0 * 1024.0), MegabytesPerSecond(totalBytes, totalMipMs),
+        MegabytesPerSecond(totalBytes, totalEncodeMs), minPsnr, finitePsnrs != 0 ? psnrSum / static_cast<double>(finitePsnrs) : minPsnr);
+    return failed ? 1 : 0;
+}
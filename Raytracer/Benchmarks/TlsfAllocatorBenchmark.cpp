@@ -0,0 +1,109 @@
+// TlsfAllocator cost per operation and fragmentation on a 4 GiB range: a
+// burst of `count` small allocations then frees in random order, followed by
+// `count` mixed operations that fill to ~75% and hold there, reporting the
+// fragmentation and failed requests it settles at. Steady-state sizes are
+// buffers and textures (256 B - 4 MiB, 64 KiB aligned), as the heap
+// suballocator sees them.
+//
+//   TlsfAllocatorBenchmark [count] [seed]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "Resources/TlsfAllocator.h"
+
+namespace
+{
+    using Clock = std::chrono::high_resolution_clock;
+
+    double NanosecondsSince(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    }
+
+    uint64_t RandomSize(std::mt19937_64& rng)
+    {
+        // Mostly small buffers, a tail of large textures.
+        return rng() % 8 == 0 ? rng() % (4ull << 20) + 1 : rng() % (256ull << 10) + 256;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const size_t count = argc > 1 ? static_cast<size_t>(std::max(1000, std::atoi(argv[1]))) : 1000000;
+    std::mt19937_64 rng(argc > 2 ? static_cast<uint64_t>(std::atoll(argv[2])) : 42);
+    constexpr uint64_t CAPACITY = 4ull << 30;
+    constexpr uint64_t ALIGNMENT = 64ull << 10;
+
+    // Burst.
+    {
+        TlsfAllocator allocator(CAPACITY);
+        std::vector<uint32_t> blocks;
+        blocks.reserve(count);
+        const auto start = Clock::now();
+        for (size_t i = 0; i < count; ++i)
+        {
+            const TlsfAllocator::Allocation allocation = allocator.Allocate(rng() % 4096 + 1);
+            if (allocation.IsValid())
+                blocks.push_back(allocation.block);
+        }
+        const double allocateNs = NanosecondsSince(start);
+        const TlsfAllocator::Stats full = allocator.GetStats();
+        std::shuffle(blocks.begin(), blocks.end(), rng);
+        const auto freeStart = Clock::now();
+        for (uint32_t block : blocks)
+            allocator.Free(block);
+        const double freeNs = NanosecondsSince(freeStart);
+        std::printf("burst: %zu allocate(s) %.1f ns/op (%zu failed, %.1f%% used), free %.1f ns/op, empty after: %s\n",
+            count, allocateNs / static_cast<double>(count), count - blocks.size(),
+            100.0 * static_cast<double>(full.usedBytes) / static_cast<double>(CAPACITY),
+            freeNs / static_cast<double>(std::max<size_t>(blocks.size(), 1)), allocator.IsEmpty() ? "yes" : "no");
+    }
+
+    // Steady state: allocate until ~75% used, then free or allocate to hold it there.
+    {
+        TlsfAllocator allocator(CAPACITY);
+        std::vector<TlsfAllocator::Allocation> live;
+        uint64_t usedBytes = 0;
+        size_t failures = 0;
+        size_t operations = 0;
+        const auto start = Clock::now();
+        for (size_t i = 0; i < count; ++i)
+        {
+            const bool overTarget = usedBytes > CAPACITY / 4 * 3;
+            if (!live.empty() && (overTarget || rng() % 5 < 2))
+            {
+                const size_t index = rng() % live.size();
+                allocator.Free(live[index].block);
+                usedBytes -= live[index].size;
+                live[index] = live.back();
+                live.pop_back();
+            }
+            else
+            {
+                const TlsfAllocator::Allocation allocation = allocator.Allocate(RandomSize(rng), ALIGNMENT);
+                if (allocation.IsValid())
+                {
+                    live.push_back(allocation);
+                    usedBytes += allocation.size;
+                }
+                else
+                {
+                    ++failures;
+                }
+            }
+            ++operations;
+        }
+        const double totalNs = NanosecondsSince(start);
+        const TlsfAllocator::Stats stats = allocator.GetStats();
+        std::printf("steady: %zu op(s) %.1f ns/op, %zu live, %.1f%% used, %zu free block(s), largest %.1f MiB, fragmentation %.3f, %zu failed\n",
+            operations, totalNs / static_cast<double>(operations), live.size(),
+            100.0 * static_cast<double>(stats.usedBytes) / static_cast<double>(CAPACITY), stats.freeBlockCount,
+            static_cast<double>(stats.largestFreeBlock) / (1024.0 * 1024.0), stats.Fragmentation(), failures);
+        return allocator.Validate() ? 0 : 1;
+    }
+}
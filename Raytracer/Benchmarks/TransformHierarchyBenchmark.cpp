@@ -0,0 +1,192 @@
+// World matrix throughput of TransformHierarchy against the per-node walk to
+// the root that SceneNode did before it (every setter recomputed the node's
+// world by recursing through its ancestors). For deep, wide, random and
+// 4-ary trees it times building all worlds both ways, one edit near the root
+// and an Update with nothing dirty, keeping the best of `repeats` runs.
+//
+//   TransformHierarchyBenchmark [nodes] [repeats]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "SceneResources/TransformHierarchy.h"
+
+namespace
+{
+    using Matrix = TransformHierarchy::Matrix;
+    using Clock = std::chrono::high_resolution_clock;
+    constexpr uint32_t NO_PARENT = TransformHierarchy::NO_PARENT;
+
+    double MillisecondsSince(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    struct Trs
+    {
+        float position[3];
+        float rotation[4];
+        float scale[3];
+    };
+
+    Matrix Local(const Trs& t)
+    {
+        const float x = t.rotation[0], y = t.rotation[1], z = t.rotation[2], w = t.rotation[3];
+        const float* s = t.scale;
+        return Matrix{ {
+            { s[0] * (1 - 2 * (y * y + z * z)), s[0] * 2 * (x * y + w * z), s[0] * 2 * (x * z - w * y), 0 },
+            { s[1] * 2 * (x * y - w * z), s[1] * (1 - 2 * (x * x + z * z)), s[1] * 2 * (y * z + w * x), 0 },
+            { s[2] * 2 * (x * z + w * y), s[2] * 2 * (y * z - w * x), s[2] * (1 - 2 * (x * x + y * y)), 0 },
+            { t.position[0], t.position[1], t.position[2], 1 } } };
+    }
+
+    Matrix Multiply(const Matrix& a, const Matrix& b)
+    {
+        Matrix out{};
+        for (int r = 0; r < 4; ++r)
+            for (int c = 0; c < 4; ++c)
+                for (int k = 0; k < 4; ++k)
+                    out.m[r][c] += a.m[r][k] * b.m[k][c];
+        return out;
+    }
+
+    // The old SceneNode: shared_ptr parents, each setter walks to the root.
+    struct RecursiveNode
+    {
+        std::shared_ptr<RecursiveNode> parent;
+        Trs trs{};
+        Matrix world{};
+
+        Matrix Traverse() const { return parent ? Multiply(Local(trs), parent->Traverse()) : Local(trs); }
+        void SetPosition(const float p[3]) { std::copy(p, p + 3, trs.position); world = Traverse(); }
+        void SetRotation(const float q[4]) { std::copy(q, q + 4, trs.rotation); world = Traverse(); }
+        void SetScale(const float s[3]) { std::copy(s, s + 3, trs.scale); world = Traverse(); }
+    };
+
+    Trs RandomTrs(std::mt19937& rng)
+    {
+        std::uniform_real_distribution<float> u(-1.0f, 1.0f);
+        Trs t;
+        float length = 0.0f;
+        for (int i = 0; i < 4; ++i)
+        {
+            t.rotation[i] = u(rng);
+            length += t.rotation[i] * t.rotation[i];
+        }
+        length = std::sqrt(length);
+        for (int i = 0; i < 4; ++i)
+            t.rotation[i] /= length;
+        for (int i = 0; i < 3; ++i)
+        {
+            t.position[i] = u(rng);
+            t.scale[i] = 0.9f + 0.1f * u(rng);
+        }
+        return t;
+    }
+
+    struct Timings
+    {
+        double recursive = std::numeric_limits<double>::infinity();
+        double flat = std::numeric_limits<double>::infinity();
+        double edit = std::numeric_limits<double>::infinity();
+        double idle = std::numeric_limits<double>::infinity();
+        size_t editRecomputed = 0;
+        float maxError = 0.0f;
+    };
+
+    void Run(const char* name, const std::vector<uint32_t>& parents, int repeats)
+    {
+        std::mt19937 rng(7);
+        std::vector<Trs> trs(parents.size());
+        for (Trs& t : trs)
+            t = RandomTrs(rng);
+
+        Timings best;
+        for (int repeat = 0; repeat < repeats; ++repeat)
+        {
+            auto start = Clock::now();
+            std::vector<std::shared_ptr<RecursiveNode>> nodes(parents.size());
+            for (size_t i = 0; i < parents.size(); ++i)
+            {
+                nodes[i] = std::make_shared<RecursiveNode>();
+                if (parents[i] != NO_PARENT)
+                    nodes[i]->parent = nodes[parents[i]];
+                nodes[i]->SetPosition(trs[i].position);
+                nodes[i]->SetRotation(trs[i].rotation);
+                nodes[i]->SetScale(trs[i].scale);
+            }
+            best.recursive = std::min(best.recursive, MillisecondsSince(start));
+
+            start = Clock::now();
+            TransformHierarchy hierarchy;
+            hierarchy.Reserve(parents.size());
+            for (size_t i = 0; i < parents.size(); ++i)
+                hierarchy.Add(parents[i], trs[i].position, trs[i].rotation, trs[i].scale);
+            hierarchy.Update();
+            best.flat = std::min(best.flat, MillisecondsSince(start));
+
+            for (size_t i = 0; i < parents.size(); ++i)
+                for (int r = 0; r < 4; ++r)
+                    for (int c = 0; c < 4; ++c)
+                    {
+                        const float expected = nodes[i]->world.m[r][c];
+                        const float error = std::fabs(expected - hierarchy.GetWorld(static_cast<uint32_t>(i)).m[r][c]);
+                        best.maxError = std::max(best.maxError, error / std::max(1.0f, std::fabs(expected)));
+                    }
+
+            const float position[3] = { 0.5f, 0.25f, 0.125f };
+            hierarchy.SetPosition(parents.size() > 1 ? 1 : 0, position);
+            start = Clock::now();
+            best.editRecomputed = hierarchy.Update();
+            best.edit = std::min(best.edit, MillisecondsSince(start));
+
+            start = Clock::now();
+            hierarchy.Update();
+            best.idle = std::min(best.idle, MillisecondsSince(start));
+        }
+
+        std::printf("%-6s %7zu nodes  recursive %9.3f ms  flat %7.3f ms (%6.1fx, %6.1f Mnodes/s)  edit node 1: %zu in %.3f ms  idle %.4f ms  max rel err %.1e\n",
+            name, parents.size(), best.recursive, best.flat, best.recursive / best.flat,
+            static_cast<double>(parents.size()) / (best.flat * 1000.0), best.editRecomputed, best.edit, best.idle,
+            static_cast<double>(best.maxError));
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const uint32_t count = argc > 1 ? static_cast<uint32_t>(std::max(2, std::atoi(argv[1]))) : 20000;
+    const int repeats = argc > 2 ? std::max(1, std::atoi(argv[2])) : 5;
+
+    // Recursion is quadratic on a chain; keep the deep case short enough to finish.
+    std::vector<uint32_t> deep(std::min<uint32_t>(count, 2000));
+    deep[0] = NO_PARENT;
+    for (uint32_t i = 1; i < deep.size(); ++i)
+        deep[i] = i - 1;
+
+    std::vector<uint32_t> wide(count, 0);
+    wide[0] = NO_PARENT;
+
+    std::mt19937 rng(3);
+    std::vector<uint32_t> random(count);
+    random[0] = NO_PARENT;
+    for (uint32_t i = 1; i < count; ++i)
+        random[i] = static_cast<uint32_t>(rng() % i);
+
+    std::vector<uint32_t> quad(count);
+    quad[0] = NO_PARENT;
+    for (uint32_t i = 1; i < count; ++i)
+        quad[i] = (i - 1) / 4;
+
+    Run("deep", deep, repeats);
+    Run("wide", wide, repeats);
+    Run("random", random, repeats);
+    Run("4-ary", quad, repeats);
+    return 0;
+}
@@ -0,0 +1,113 @@
+// Sparse brick map against the dense voxel resources per scene (Sponza and
+// the Tungsten scenes by default) at 64^3, 128^3 and 256^3: the CPU bake, the
+// brick map build, memory of both layouts, and MeasureVoxelLookups' ns per
+// random occupancy and bounds lookup (half on occupied voxels). Best of
+// `repeats` for the timings.
+//
+//   VoxelBrickMapBenchmark [scene.gltf|scene.bsc|tungstenDir] [gridDim] [queries] [repeats]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "BenchmarkScenes.h"
+#include "SceneResources/VoxelBrickMap.h"
+#include "SceneResources/Voxelizer.h"
+#include "Utils/ThreadPool.h"
+
+namespace
+{
+    using Clock = std::chrono::high_resolution_clock;
+
+    double MillisecondsSince(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    double Megabytes(size_t bytes)
+    {
+        return static_cast<double>(bytes) / (1024.0 * 1024.0);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    namespace fs = std::filesystem;
+    const std::vector<fs::path> scenes = argc > 1 ? std::vector<fs::path>{ fs::path(argv[1]) } : BenchmarkScenes::DefaultScenes();
+    const std::vector<uint32_t> dims = argc > 2 ? std::vector<uint32_t>{ static_cast<uint32_t>(std::atoi(argv[2])) } : std::vector<uint32_t>{ 64, 128, 256 };
+    const size_t queries = argc > 3 ? static_cast<size_t>(std::max(1000, std::atoi(argv[3]))) : 4000000;
+    const int repeats = argc > 4 ? std::max(1, std::atoi(argv[4])) : 3;
+    std::printf("%u thread(s), %zu lookups per layout\n", ThreadPool::Get().GetThreadCount(), queries);
+
+    bool failed = false;
+    for (const fs::path& path : scenes)
+    {
+        BenchmarkScenes::Scene scene;
+        std::string error;
+        if (!BenchmarkScenes::Load(path, scene, error))
+        {
+            std::fprintf(stderr, "%s: %s\n", path.string().c_str(), error.c_str());
+            failed = argc > 1;
+            continue;
+        }
+        const SceneBvhInput input = scene.MakeInput();
+        const BvhAabb bounds = scene.WorldBounds();
+        std::printf("%s: %zu instanced triangles\n", scene.name.c_str(), scene.InstancedTriangleCount());
+
+        for (uint32_t dim : dims)
+        {
+            VoxelBakeSettings settings;
+            settings.gridDim = dim;
+            VoxelBake bake;
+            double bakeMs = 0.0;
+            for (int i = 0; i < repeats; ++i)
+            {
+                const auto start = Clock::now();
+                bake = Voxelizer::Bake(input, bounds, settings);
+                bakeMs = i == 0 ? MillisecondsSince(start) : std::min(bakeMs, MillisecondsSince(start));
+            }
+            VoxelBrickMap map;
+            if (bake.cells.empty() || !map.Build(bake))
+            {
+                std::fprintf(stderr, "  %u^3: nothing voxelized (grid must be in [%u, %u])\n", dim, Voxelizer::MIN_GRID_DIM, Voxelizer::MAX_GRID_DIM);
+                failed = true;
+                continue;
+            }
+            double buildMs = map.GetMemoryStats().milliseconds;
+            for (int i = 1; i < repeats; ++i)
+            {
+                map.Build(bake);
+                buildMs = std::min(buildMs, map.GetMemoryStats().milliseconds);
+            }
+
+            VoxelLookupBenchmark lookups = MeasureVoxelLookups(bake, map, queries);
+            for (int i = 1; i < repeats; ++i)
+            {
+                const VoxelLookupBenchmark run = MeasureVoxelLookups(bake, map, queries);
+                lookups.denseOccupancyNs = std::min(lookups.denseOccupancyNs, run.denseOccupancyNs);
+                lookups.sparseOccupancyNs = std::min(lookups.sparseOccupancyNs, run.sparseOccupancyNs);
+                lookups.denseBoundsNs = std::min(lookups.denseBoundsNs, run.denseBoundsNs);
+                lookups.sparseBoundsNs = std::min(lookups.sparseBoundsNs, run.sparseBoundsNs);
+            }
+
+            const VoxelBrickMap::MemoryStats& stats = map.GetMemoryStats();
+            std::printf("  %3u^3  bake %8.1f ms  %9zu voxels  bricks %6zu of %6zu  build %6.2f ms\n", dim, bakeMs,
+                stats.occupiedVoxels, stats.allocatedBricks, stats.brickCount, buildMs);
+            std::printf("         sparse %8.2f MB (indirection %.2f, hierarchy %.3f, pool %.2f)  dense %8.2f MB  %.1fx smaller\n",
+                Megabytes(stats.TotalBytes()), Megabytes(stats.indirectionBytes), Megabytes(stats.hierarchyBytes),
+                Megabytes(stats.poolBytes), Megabytes(stats.denseBytes),
+                stats.TotalBytes() ? static_cast<double>(stats.denseBytes) / static_cast<double>(stats.TotalBytes()) : 0.0);
+            std::printf("         occupancy %5.2f ns dense %5.2f ns sparse  bounds %5.2f ns dense %5.2f ns sparse\n",
+                lookups.denseOccupancyNs, lookups.sparseOccupancyNs, lookups.denseBoundsNs, lookups.sparseBoundsNs);
+            if (lookups.mismatches != 0)
+            {
+                std::fprintf(stderr, "  %zu of %zu lookups disagree between the layouts\n", lookups.mismatches, lookups.queries);
+                failed = true;
+            }
+        }
+    }
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,252 @@
+// Fingerprint clustering per scene (Sponza and the Tungsten scenes by
+// default) on the lit voxels of the CPU voxel bake. Fingerprints are built as
+// BuildVoxelFingerprints builds them: one shadow ray from each voxel centre
+// to each of 128 representative points (the first hits of a 16 x 8 pinhole
+// grid from the scene centre), without the facing tests. Reports the
+// HammingDistances kernel against scalar Hamming in ns per distance, then
+// seeding, assignment and update time and mean distance to the centre for
+// every seeding with and without Lloyd refinement. Best of `repeats`. The bake
+// is kept in the temporary directory (Voxelizer::GetBakePath, keyed by a hash
+// of the world-space triangles) and only rebaked when that misses.
+//
+//   VoxelClusteringBenchmark [scene.gltf|scene.bsc|tungstenDir] [gridDim] [lloydIterations] [repeats]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "BenchmarkScenes.h"
+#include "SceneResources/SceneBvh.h"
+#include "SceneResources/VoxelClustering.h"
+#include "SceneResources/Voxelizer.h"
+#include "Utils/ContentHash.h"
+#include "Utils/ThreadPool.h"
+
+namespace
+{
+    using Clock = std::chrono::high_resolution_clock;
+
+    double NanosecondsSince(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    }
+
+    constexpr uint32_t REPRESENTATIVES = 128;
+
+    // SampleScreenRepresentatives: one jittered point per 16 x 8 cell of a
+    // 90 degree view from the bounds centre. Misses stay invisible to all.
+    std::vector<BvhRay> MakeRepresentativeRays(const BvhAabb& bounds, uint32_t seed)
+    {
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+        std::vector<BvhRay> rays(REPRESENTATIVES);
+        for (uint32_t i = 0; i < REPRESENTATIVES; ++i)
+        {
+            const float u = (static_cast<float>(i % 16) + unit(rng)) / 16.0f * 2.0f - 1.0f;
+            const float v = (static_cast<float>(i / 16) + unit(rng)) / 8.0f * 2.0f - 1.0f;
+            const float direction[3] = { 0.7071f + 0.7071f * u, -v * 0.5625f, -0.7071f + 0.7071f * u };
+            const float length = std::sqrt(direction[0] * direction[0] + direction[1] * direction[1] + direction[2] * direction[2]);
+            for (int a = 0; a < 3; ++a)
+            {
+                rays[i].origin[a] = 0.5f * (bounds.min[a] + bounds.max[a]);
+                rays[i].direction[a] = direction[a] / length;
+            }
+        }
+        return rays;
+    }
+
+    // Voxelizer::Read of the bake for this scene and settings, or Bake and
+    // Write on a miss.
+    VoxelBake LoadOrBake(const BenchmarkScenes::Scene& scene, const VoxelBakeSettings& settings)
+    {
+        const std::vector<float> triangles = scene.WorldTriangles();
+        const uint64_t sourceHash = ContentHash::HashBytes(triangles.data(), triangles.size() * sizeof(float));
+        const std::filesystem::path stem = std::filesystem::temp_directory_path() / "VoxelClusteringBenchmark" / (scene.name + ".bsc");
+        const std::filesystem::path path = Voxelizer::GetBakePath(stem, settings);
+
+        VoxelBake bake;
+        if (Voxelizer::Read(path, sourceHash, settings, bake))
+        {
+            std::printf("%s: bake read from %s\n", scene.name.c_str(), path.string().c_str());
+            return bake;
+        }
+        const auto start = Clock::now();
+        bake = Voxelizer::Bake(scene.MakeInput(), scene.WorldBounds(), settings);
+        const double bakeMs = NanosecondsSince(start) / 1e6;
+        const bool written = !bake.cells.empty() && Voxelizer::Write(path, bake, sourceHash);
+        std::printf("%s: baked in %.1f ms%s%s\n", scene.name.c_str(), bakeMs, written ? ", written to " : "", written ? path.string().c_str() : "");
+        return bake;
+    }
+
+    std::vector<VoxelFingerprint> BuildFingerprints(const SceneBvh& bvh, const VoxelBake& bake, uint32_t seed)
+    {
+        const std::vector<BvhRay> cameraRays = MakeRepresentativeRays(bvh.GetBounds(), seed);
+        std::vector<BvhHit> hits(cameraRays.size());
+        bvh.IntersectBatch(cameraRays.data(), hits.data(), cameraRays.size());
+
+        const VoxelGridConstants& grid = bake.grid;
+        std::vector<VoxelFingerprint> fingerprints(bake.cells.size());
+        ThreadPool::Get().ParallelForRange(bake.cells.size(), 64, [&](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; ++i)
+            {
+                const uint32_t id = bake.cells[i];
+                const uint32_t coord[3] = { id % grid.gridDim, id / grid.gridDim % grid.gridDim, id / grid.gridDim / grid.gridDim };
+                float center[3];
+                for (int a = 0; a < 3; ++a)
+                    center[a] = grid.gridMin[a] + (static_cast<float>(coord[a]) + 0.5f) * grid.voxelSize;
+
+                VoxelFingerprint& fingerprint = fingerprints[i];
+                fingerprint = {};
+                for (uint32_t r = 0; r < REPRESENTATIVES; ++r)
+                {
+                    if (!hits[r].IsHit())
+                        continue;
+                    BvhRay ray;
+                    float distance = 0.0f;
+                    for (int a = 0; a < 3; ++a)
+                    {
+                        ray.origin[a] = center[a];
+                        ray.direction[a] = cameraRays[r].origin[a] + cameraRays[r].direction[a] * hits[r].t - center[a];
+                        distance += ray.direction[a] * ray.direction[a];
+                    }
+                    distance = std::sqrt(distance);
+                    if (distance <= grid.voxelSize)
+                        continue;
+                    for (float& d : ray.direction)
+                        d /= distance;
+                    // Out of the voxel's own surface, short of the receiver's.
+                    ray.tMin = grid.voxelSize;
+                    ray.tMax = distance - 0.01f;
+                    if (!bvh.Occluded(ray))
+                        fingerprint.words[r / 32] |= 1u << (r % 32);
+                }
+            }
+        });
+        return fingerprints;
+    }
+
+    void MeasureKernel(const std::vector<VoxelFingerprint>& fingerprints, int repeats)
+    {
+        const uint32_t count = static_cast<uint32_t>(fingerprints.size());
+        std::vector<uint32_t> distances(count);
+        double kernelNs = 0.0;
+        double scalarNs = 0.0;
+        uint64_t checksum[2] = {};
+        for (int i = 0; i < repeats; ++i)
+        {
+            auto start = Clock::now();
+            for (uint32_t probe = 0; probe < 16; ++probe)
+            {
+                VoxelClustering::HammingDistances(fingerprints[probe * count / 16], fingerprints.data(), count, distances.data());
+                checksum[0] += distances[probe];
+            }
+            const double kernel = NanosecondsSince(start);
+
+            start = Clock::now();
+            for (uint32_t probe = 0; probe < 16; ++probe)
+            {
+                const VoxelFingerprint& fingerprint = fingerprints[probe * count / 16];
+                for (uint32_t j = 0; j < count; ++j)
+                    distances[j] = VoxelClustering::Hamming(fingerprint, fingerprints[j]);
+                checksum[1] += distances[probe];
+            }
+            const double scalar = NanosecondsSince(start);
+            kernelNs = i == 0 ? kernel : std::min(kernelNs, kernel);
+            scalarNs = i == 0 ? scalar : std::min(scalarNs, scalar);
+        }
+        std::printf("  hamming    %6.3f ns/distance HammingDistances (%s), %6.3f ns scalar%s\n", kernelNs / (16.0 * count),
+            VoxelClustering::HammingDistancesUseAvx2() ? "AVX2" : "popcount", scalarNs / (16.0 * count),
+            checksum[0] == checksum[1] ? "" : "  MISMATCH");
+    }
+}
+
+int main(int argc, char** argv)
+{
+    namespace fs = std::filesystem;
+    const std::vector<fs::path> scenes = argc > 1 ? std::vector<fs::path>{ fs::path(argv[1]) } : BenchmarkScenes::DefaultScenes();
+    const uint32_t gridDim = argc > 2 ? static_cast<uint32_t>(std::atoi(argv[2])) : 64;
+    const uint32_t lloydIterations = argc > 3 ? static_cast<uint32_t>(std::max(1, std::atoi(argv[3]))) : 10;
+    const int repeats = argc > 4 ? std::max(1, std::atoi(argv[4])) : 3;
+    std::printf("%u thread(s), 32 clusters\n", ThreadPool::Get().GetThreadCount());
+
+    bool failed = false;
+    for (const fs::path& path : scenes)
+    {
+        BenchmarkScenes::Scene scene;
+        std::string error;
+        if (!BenchmarkScenes::Load(path, scene, error))
+        {
+            std::fprintf(stderr, "%s: %s\n", path.string().c_str(), error.c_str());
+            failed = argc > 1;
+            continue;
+        }
+        VoxelBakeSettings bakeSettings;
+        bakeSettings.gridDim = gridDim;
+        const VoxelBake bake = LoadOrBake(scene, bakeSettings);
+        if (bake.cells.empty())
+        {
+            std::fprintf(stderr, "%s: nothing voxelized at %u^3\n", scene.name.c_str(), gridDim);
+            failed = true;
+            continue;
+        }
+        SceneBvh bvh;
+        bvh.Build(scene.MakeInput());
+        const auto fingerprintStart = Clock::now();
+        const std::vector<VoxelFingerprint> fingerprints = BuildFingerprints(bvh, bake, 1);
+        const double fingerprintMs = NanosecondsSince(fingerprintStart) / 1e6;
+
+        std::mt19937 rng(5);
+        std::uniform_real_distribution<float> irradiance(0.0f, 4.0f);
+        std::vector<float> premulIrradiance(bake.cells.size());
+        for (float& value : premulIrradiance)
+            value = irradiance(rng);
+
+        VoxelClusterInput input;
+        input.fingerprints = fingerprints.data();
+        input.premulIrradiance = premulIrradiance.data();
+        input.compactIds = bake.cells.data();
+        input.count = static_cast<uint32_t>(bake.cells.size());
+        input.gridDim = gridDim;
+
+        std::printf("%s: %u lit voxels at %u^3, fingerprints in %.1f ms\n", scene.name.c_str(), input.count, gridDim, fingerprintMs);
+        MeasureKernel(fingerprints, repeats);
+
+        const struct { const char* name; VoxelSeeding seeding; } seedings[] = {
+            { "shader", VoxelSeeding::Shader }, { "exact", VoxelSeeding::Exact }, { "streaming", VoxelSeeding::Streaming } };
+        for (const auto& seeding : seedings)
+        {
+            for (uint32_t iterations : { 0u, lloydIterations })
+            {
+                VoxelClusterSettings settings;
+                settings.seeding = seeding.seeding;
+                settings.lloydIterations = iterations;
+                VoxelClusters best;
+                double bestMs = 0.0;
+                for (int i = 0; i < repeats; ++i)
+                {
+                    VoxelClusters clusters = VoxelClustering::Cluster(input, settings);
+                    const VoxelClusterStats& stats = clusters.stats;
+                    const double ms = stats.seedMilliseconds + stats.assignMilliseconds + stats.updateMilliseconds;
+                    if (i == 0 || ms < bestMs)
+                    {
+                        best = std::move(clusters);
+                        bestMs = ms;
+                    }
+                }
+                const VoxelClusterStats& stats = best.stats;
+                std::printf("  %-9s %2u iteration(s)  seed %7.2f  assign %7.2f  update %7.2f ms  mean distance %7.3f -> %7.3f  %u empty\n",
+                    seeding.name, stats.iterations, stats.seedMilliseconds, stats.assignMilliseconds, stats.updateMilliseconds,
+                    stats.cost.front() / input.count, stats.cost.back() / input.count, stats.emptyClusters);
+            }
+        }
+    }
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,149 @@
+// .wo3 read throughput: maps, validates and converts every
+// Tungsten/*/models/*.wo3 into 48-byte vertices and 32-bit indices, the same
+// work as TungstenLoading's LoadWo3. Reports MB/s and per-file latency per
+// scene; the first pass includes page-cache misses, the best of the rest
+// does not.
+//
+//   Wo3Benchmark [tungstenDir] [passes]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "SceneResources/VertexPacking.h"
+#include "SceneResources/Wo3Mesh.h"
+
+namespace
+{
+    namespace fs = std::filesystem;
+    using Clock = std::chrono::high_resolution_clock;
+
+    double MillisecondsSince(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    struct PassResult
+    {
+        uint64_t bytes = 0;
+        double milliseconds = 0.0;
+        std::vector<double> fileMilliseconds;
+        size_t failures = 0;
+    };
+
+    PassResult ReadAll(const std::vector<fs::path>& files)
+    {
+        PassResult result;
+        std::vector<VertexPacking::FloatVertex> vertices;
+        std::vector<uint32_t> indices;
+        const auto passStart = Clock::now();
+        for (const fs::path& path : files)
+        {
+            const auto start = Clock::now();
+            Wo3Mesh::File file;
+            if (file.Open(path) != Wo3Mesh::Status::Ok)
+            {
+                ++result.failures;
+                continue;
+            }
+
+            const Wo3Mesh::Vertex* source = file.Vertices();
+            vertices.resize(static_cast<size_t>(file.VertexCount()));
+            for (size_t i = 0; i < vertices.size(); ++i)
+            {
+                const Wo3Mesh::Vertex& s = source[i];
+                vertices[i] = { { s.px, s.py, s.pz }, { s.nx, s.ny, s.nz }, { 0.0f, 0.0f, 0.0f, 1.0f }, { s.u, s.v } };
+            }
+            indices.resize(static_cast<size_t>(file.TriangleCount()) * 3);
+            size_t badTriangle = 0;
+            if (!Wo3Mesh::CopyIndices(file, indices.data(), badTriangle))
+                ++result.failures;
+
+            result.bytes += file.Size();
+            result.fileMilliseconds.push_back(MillisecondsSince(start));
+        }
+        result.milliseconds = MillisecondsSince(passStart);
+        return result;
+    }
+
+    double Percentile(std::vector<double> values, double p)
+    {
+        if (values.empty())
+            return 0.0;
+        std::sort(values.begin(), values.end());
+        const size_t index = std::min(values.size() - 1, static_cast<size_t>(p * static_cast<double>(values.size() - 1) + 0.5));
+        return values[index];
+    }
+
+    void Report(const char* label, const PassResult& pass)
+    {
+        const double megabytes = static_cast<double>(pass.bytes) / (1024.0 * 1024.0);
+        const double mbPerSecond = pass.milliseconds > 0.0 ? megabytes / (pass.milliseconds / 1000.0) : 0.0;
+        std::printf("  %-6s %8.2f ms  %8.1f MB/s  per file: median %.3f ms, p95 %.3f ms, max %.3f ms\n",
+            label, pass.milliseconds, mbPerSecond,
+            Percentile(pass.fileMilliseconds, 0.5), Percentile(pass.fileMilliseconds, 0.95), Percentile(pass.fileMilliseconds, 1.0));
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const fs::path root = argc > 1 ? fs::path(argv[1]) : fs::path(RAYTRACER_RESOURCE_DIR) / "Models" / "Tungsten";
+    const int passes = argc > 2 ? std::max(2, std::atoi(argv[2])) : 5;
+
+    std::error_code error;
+    if (!fs::is_directory(root, error))
+    {
+        std::fprintf(stderr, "Wo3Benchmark: '%s' is not a directory\n", root.string().c_str());
+        return 1;
+    }
+
+    std::vector<fs::path> scenes;
+    for (const fs::directory_entry& entry : fs::directory_iterator(root))
+        if (entry.is_directory() && fs::is_directory(entry.path() / "models"))
+            scenes.push_back(entry.path());
+    std::sort(scenes.begin(), scenes.end());
+
+    PassResult total;
+    bool failed = false;
+    for (const fs::path& scene : scenes)
+    {
+        std::vector<fs::path> files;
+        for (const fs::directory_entry& entry : fs::directory_iterator(scene / "models"))
+            if (entry.is_regular_file() && entry.path().extension() == ".wo3")
+                files.push_back(entry.path());
+        if (files.empty())
+            continue;
+        std::sort(files.begin(), files.end());
+
+        const PassResult first = ReadAll(files);
+        PassResult best;
+        for (int i = 1; i < passes; ++i)
+        {
+            PassResult pass = ReadAll(files);
+            if (i == 1 || pass.milliseconds < best.milliseconds)
+                best = std::move(pass);
+        }
+
+        std::printf("%s: %zu file(s), %.2f MB\n", scene.filename().string().c_str(), files.size(),
+            static_cast<double>(first.bytes) / (1024.0 * 1024.0));
+        Report("first", first);
+        Report("best", best);
+        if (first.failures != 0)
+        {
+            std::fprintf(stderr, "  %zu file(s) failed to load\n", first.failures);
+            failed = true;
+        }
+
+        total.bytes += best.bytes;
+        total.milliseconds += best.milliseconds;
+        total.fileMilliseconds.insert(total.fileMilliseconds.end(), best.fileMilliseconds.begin(), best.fileMilliseconds.end());
+    }
+
+    std::printf("all scenes (best passes), %zu file(s):\n", total.fileMilliseconds.size());
+    Report("best", total);
+    return failed ? 1 : 0;
+}
@@ -8,35 +8,14 @@ namespace Constants
 {
         constexpr int NUM_FRAMES = 3;
         constexpr int MAX_TEXTURES = 512;
-        constexpr int MAX_OBJECTS = 64;
+        // Leading scene table of the shader-visible heap (slot 0 unused, camera CBV,
+        // output UAV, TLAS, vertices, indices); the texture table follows it.
         constexpr int NUM_BASE_DESCRIPTORS = 6;
-        constexpr int SKYBOX_DESCRIPTOR_INDEX = NUM_BASE_DESCRIPTORS + MAX_TEXTURES; // 518
-        constexpr int VOXEL_OCCUPANCY_DESCRIPTOR_INDEX = SKYBOX_DESCRIPTOR_INDEX + 1; // 519
-        constexpr int VOXEL_IRRADIANCE_DESCRIPTOR_INDEX = VOXEL_OCCUPANCY_DESCRIPTOR_INDEX + 1; // 520
-        constexpr int VOXEL_VPL_COUNT_DESCRIPTOR_INDEX = VOXEL_IRRADIANCE_DESCRIPTOR_INDEX + 1; // 521
-        // VXPG V2: ShadingPoints G-buffer UAV (primary worldPos + octa normal), written by light injection.
-        constexpr int SHADINGPOINTS_DESCRIPTOR_INDEX = VOXEL_VPL_COUNT_DESCRIPTOR_INDEX + 1; // 522
-        // VXPG V2 Stage B: superpixel index + representative center UAVs (debug views 15/16, raster table u7/u8).
-        constexpr int SUPERPIXEL_INDEX_DESCRIPTOR_INDEX = SHADINGPOINTS_DESCRIPTOR_INDEX + 1; // 523
-        constexpr int SUPERPIXEL_CENTER_DESCRIPTOR_INDEX = SUPERPIXEL_INDEX_DESCRIPTOR_INDEX + 1; // 524
-        // VXPG faithful port (B+): per-voxel representative VPL (pos + octa normal, Texture3D)
-        // and per-pixel VPL hit position (screen, Texture2D), both written by light injection.
-        constexpr int VOXEL_REPRESENTATIVE_DESCRIPTOR_INDEX = SUPERPIXEL_CENTER_DESCRIPTOR_INDEX + 1; // 525
-        constexpr int VPL_POSITION_DESCRIPTOR_INDEX = VOXEL_REPRESENTATIVE_DESCRIPTOR_INDEX + 1; // 526
-        // Shared primary-visibility buffer (ADR 0004), written by VBufferPass,
-        // consumed by light injection + the guided integrator.
-        constexpr int VBUFFER_DESCRIPTOR_INDEX = VPL_POSITION_DESCRIPTOR_INDEX + 1; // 527
-        // VXPG cluster-visibility (cvis): per-superpixel pixel-list + counter (from
-        // the superpixel pass) and the cluster-visibility mask (written by cvis),
-        // read by the cvis check kernel + guided PT debug view 10.
-        constexpr int SPIXEL_GATHERED_DESCRIPTOR_INDEX = VBUFFER_DESCRIPTOR_INDEX + 1; // 528
-        constexpr int SPIXEL_COUNTER_DESCRIPTOR_INDEX = SPIXEL_GATHERED_DESCRIPTOR_INDEX + 1; // 529
-        constexpr int CLUSTER_VISIBILITY_MASK_DESCRIPTOR_INDEX = SPIXEL_COUNTER_DESCRIPTOR_INDEX + 1; // 530
-        // Fuzzy 4-nearest superpixel blend (SIByL u_fuzzyWeight / u_fuzzyIdx):
-        // per-pixel 4 nearest superpixel centers + 1/dist^2 weights, written by
-        // the superpixel pass, consumed by the guided integrator's mixture pdf.
-        constexpr int FUZZY_WEIGHT_DESCRIPTOR_INDEX = CLUSTER_VISIBILITY_MASK_DESCRIPTOR_INDEX + 1; // 531
-        constexpr int FUZZY_INDEX_DESCRIPTOR_INDEX = FUZZY_WEIGHT_DESCRIPTOR_INDEX + 1; // 532
+        // Shader-visible heap: persistent views (named slots, texture table, ImGui)
+        // followed by the per-frame transient ring. Named slots are declared in
+        // DescriptorSlots (DescriptorHeapAllocator.h); nothing here needs editing per pass.
+        constexpr int NUM_PERSISTENT_DESCRIPTORS = 4096;
+        constexpr int NUM_TRANSIENT_DESCRIPTORS = 1024;
         constexpr int STATIC_SAMPLERS_COUNT = 6;
         // Max voxels in the compacted guiding distribution (matches SIByL VXGuider_MAX_CAPACITY)
         constexpr int VOXEL_GUIDING_CAPACITY = 131072;
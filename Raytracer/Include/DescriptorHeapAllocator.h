@@ -1,30 +1,101 @@
 ﻿#pragma once
+#include "Constants.h"
+#include "Resources/DescriptorAllocator.h"
 
 /// DESCRIPTOR HEAP ALLOCATOR
-/// Currently used only for ImGui implementation.
-/// Other descriptor heaps are being preallocated, but this behaviour may change in the future if there is a need.
+/// Owns the shader-visible CBV/SRV/UAV heap every pass binds and hands out its descriptors
+/// (index bookkeeping lives in DescriptorAllocator):
+///  - named slots: a pass and its consumers ask for the same name and get the same index,
+///    so sharing a resource through the heap needs no reserved constant;
+///  - the texture table: stable bindless indices materials pass to shaders (textures[index]);
+///  - transient tables: written and bound within one frame, recycled once it retires;
+///  - single descriptors for ImGui.
+
+/// A named range of the heap. Every slot is declared once in DescriptorSlots, so the pass that
+/// writes its views and the passes that bind them agree on the name, the descriptor count and
+/// the order of the views inside it.
+struct NamedDescriptorSlot
+{
+    const char* name;
+    uint32_t count;
+};
+
+namespace DescriptorSlots
+{
+    // Scene table leading the heap (camera CBV, output UAV, TLAS, vertices, indices).
+    inline constexpr NamedDescriptorSlot SCENE_TABLE{ "Scene Table", Constants::Graphics::NUM_BASE_DESCRIPTORS };
+
+    // Voxel grid UAVs (VoxelizationPass), bound together as one range.
+    inline constexpr NamedDescriptorSlot VOXEL_GRID{ "Voxel Grid", 3 };
+    inline constexpr uint32_t VOXEL_GRID_OCCUPANCY = 0;
+    inline constexpr uint32_t VOXEL_GRID_IRRADIANCE = 1;
+    inline constexpr uint32_t VOXEL_GRID_VPL_COUNT = 2;
+    inline constexpr NamedDescriptorSlot VOXEL_REPRESENTATIVE{ "Voxel Representative", 1 };
+    inline constexpr NamedDescriptorSlot VPL_POSITION{ "VPL Position", 1 };
+    inline constexpr NamedDescriptorSlot SHADING_POINTS{ "Shading Points", 1 };
+
+    // Superpixel UAVs (SuperpixelBuildPass).
+    inline constexpr NamedDescriptorSlot SUPERPIXELS{ "Superpixels", 2 };
+    inline constexpr uint32_t SUPERPIXELS_INDEX = 0;
+    inline constexpr uint32_t SUPERPIXELS_CENTER = 1;
+    inline constexpr NamedDescriptorSlot FUZZY_WEIGHT{ "Fuzzy Weight", 1 };
+    inline constexpr NamedDescriptorSlot FUZZY_INDEX{ "Fuzzy Index", 1 };
+    inline constexpr NamedDescriptorSlot SUPERPIXEL_GATHERED{ "Superpixel Gathered", 1 };
+    inline constexpr NamedDescriptorSlot SUPERPIXEL_COUNTER{ "Superpixel Counter", 1 };
+
+    inline constexpr NamedDescriptorSlot CLUSTER_VISIBILITY_MASK{ "Cluster Visibility Mask", 1 };
+    inline constexpr NamedDescriptorSlot VBUFFER{ "VBuffer", 1 };
+    inline constexpr NamedDescriptorSlot SKYBOX{ "Skybox", 1 };
+}
 
 class DescriptorHeapAllocator
 {
 public:
-    explicit DescriptorHeapAllocator(ID3D12Device* device, ID3D12DescriptorHeap* descriptorHeap);
-    ~DescriptorHeapAllocator();
-    
+    static constexpr const char* TEXTURE_TABLE = "Textures";
+
+    static DescriptorHeapAllocator& Get();
+
     DescriptorHeapAllocator(const DescriptorHeapAllocator&) = delete;
     DescriptorHeapAllocator(DescriptorHeapAllocator&&) = delete;
     DescriptorHeapAllocator& operator=(const DescriptorHeapAllocator&) = delete;
     DescriptorHeapAllocator& operator=(DescriptorHeapAllocator&&) = delete;
 
+    void Initialize(const Microsoft::WRL::ComPtr<ID3D12Device5>& device, uint32_t persistentCount, uint32_t transientCount);
+
+    const Microsoft::WRL::ComPtr<ID3D12DescriptorHeap>& GetHeap() const { return m_heap; }
+    UINT GetIncrementSize() const { return m_handleIncrementSize; }
+    CD3DX12_CPU_DESCRIPTOR_HANDLE GetCpuHandle(uint32_t index) const;
+    CD3DX12_GPU_DESCRIPTOR_HANDLE GetGpuHandle(uint32_t index) const;
+
+    // Heap index of view `element` of `slot`; throws when the heap is full.
+    uint32_t GetNamedIndex(const NamedDescriptorSlot& slot, uint32_t element = 0);
+
+    // Heap index of texture table entry 0 (MAX_TEXTURES entries).
+    uint32_t GetTextureTableIndex();
+    int AllocateTextureIndex();
+    void FreeTextureIndex(int textureIndex);
+
+    // Heap index of `count` contiguous descriptors valid for the current frame only.
+    uint32_t AllocateTransient(uint32_t count);
+
+    // ImGui backend hooks (SrvDescriptorAllocFn / SrvDescriptorFreeFn).
     void Alloc(D3D12_CPU_DESCRIPTOR_HANDLE* outCpuHandle, D3D12_GPU_DESCRIPTOR_HANDLE* outGpuHandle);
     void Free(const D3D12_CPU_DESCRIPTOR_HANDLE& cpuHandle, const D3D12_GPU_DESCRIPTOR_HANDLE& gpuHandle);
+
+    // Once per frame, after the frame has been submitted.
+    void AdvanceFrame();
+
+    // Persistent occupancy, transient peak, named slots and texture table usage.
+    void LogReport() const;
+
 private:
-    ID3D12Device* m_device;
-    ID3D12DescriptorHeap* m_descriptorHeap;
-    
-    D3D12_CPU_DESCRIPTOR_HANDLE m_descriptorStartCpuHandle;
-    D3D12_GPU_DESCRIPTOR_HANDLE m_descriptorStartGpuHandle;
+    DescriptorHeapAllocator() = default;
+
+    Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> m_heap;
+    std::unique_ptr<DescriptorAllocator> m_allocator;
 
-    UINT m_handleIncrementSize;
+    D3D12_CPU_DESCRIPTOR_HANDLE m_descriptorStartCpuHandle = {};
+    D3D12_GPU_DESCRIPTOR_HANDLE m_descriptorStartGpuHandle = {};
 
-    std::vector<UINT> m_freeIndices;
+    UINT m_handleIncrementSize = 0;
 };
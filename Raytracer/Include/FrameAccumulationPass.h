@@ -31,7 +31,6 @@ private:
     Microsoft::WRL::ComPtr<ID3D12RootSignature>        m_rootSignature;
     Microsoft::WRL::ComPtr<ID3D12PipelineState>        m_pso;
     Microsoft::WRL::ComPtr<IDxcBlob>                   m_computeShaderBlob;
-    Microsoft::WRL::ComPtr<ID3D12DescriptorHeap>       m_descriptorHeap;  // For input texture SRV
 
     uint32_t m_frameCount      = 0;
     double   m_accumulatedTime = 0.0;
@@ -86,6 +86,8 @@ struct HeadlessArgs
 
     float       seconds = -1.0f;          // < 0 => use config default
     std::string outDir;                   // empty => use config output dir
+
+    bool vxpgSnapshot = false;            // also write a .vxps per capture (VXPG techniques)
 };
 
 HeadlessArgs   ParseHeadlessArgs(int argc, wchar_t** argv);
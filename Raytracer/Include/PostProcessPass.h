@@ -37,7 +37,6 @@ private:
     Microsoft::WRL::ComPtr<ID3D12RootSignature>        m_rootSignature;
     Microsoft::WRL::ComPtr<ID3D12PipelineState>        m_pso;
     Microsoft::WRL::ComPtr<IDxcBlob>                   m_computeShaderBlob;
-    Microsoft::WRL::ComPtr<ID3D12DescriptorHeap>       m_descriptorHeap;
 
     bool m_initialized = false;
 };
@@ -6,9 +6,11 @@
 #include "InputElements.h"
 #include "RasterDebugMode.h" // VxpgStage
 #include "SceneResources/LightData.h"
+#include "SceneResources/TextureProcessing.h" // TextureUsage
 #include "Keyboard.h"
 #include "SimpleMath.h"
 #include "Resources/StructuredBuffer.h"
+#include "Resources/UploadScheduler.h"
 #include "Utils/Utils.h"
 
 class IndexBuffer;
@@ -21,6 +23,7 @@ struct AccelerationStructureBuffers;
 class Scene;
 class Model;
 class ConstantBuffer;
+class ConstantArena;
 
 namespace DirectX
 {
@@ -43,6 +46,7 @@ class FrameAccumulationPass;
 class PostProcessPass;
 class AccelerationStructures;
 class ScreenshotManager;
+class VxpgSnapshotManager;
 class StatesManager;
 struct ScreenshotMetadata;
 class VoxelizationPass;
@@ -85,17 +89,39 @@ public:
 	                   const std::string& outDir, const std::string& stem);
 	bool ScreenshotIdle() const;
 
+	// Write the next VXPG frame's intermediates to path (.vxps, see VxpgSnapshotManager).
+	void ArmVxpgSnapshot(const std::string& path);
+	bool VxpgSnapshotIdle() const;
+
 	std::pair<std::shared_ptr<VertexBuffer>, std::shared_ptr<IndexBuffer>> Renderer::CreateSceneResources(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices);
-	std::shared_ptr<Texture> CreateTextureFromGLTF(const tinygltf::Image& image);
+	std::pair<std::shared_ptr<VertexBuffer>, std::shared_ptr<IndexBuffer>> CreateSceneResources(const Vertex* vertices, size_t vertexCount, const uint32_t* indices, size_t indexCount);
+	std::shared_ptr<Texture> CreateTextureFromGLTF(const tinygltf::Image& image,
+		TextureProcessing::TextureUsage usage = TextureProcessing::TextureUsage::Generic);
+	// Tightly packed 8-bit rows with 3 or 4 components. Uploaded as mipmapped
+	// BCn chosen by `usage` while texture.compress is on, else as RGBA8.
+	std::shared_ptr<Texture> CreateTexture(const uint8_t* pixels, int width, int height, int components,
+		TextureProcessing::TextureUsage usage = TextureProcessing::TextureUsage::Generic);
+	// Between these, CreateTexture only records its copy; the batch is submitted
+	// once at EndTextureUploads (or early when its staging memory passes
+	// renderer.textureUploadBatchMB) instead of one GPU round trip per texture.
+	void BeginTextureUploads();
+	void EndTextureUploads();
 	std::shared_ptr<GameObject> InstantiateGameObject();
 
 	Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList4> GetCommandList() const { return m_d3d12CommandList; }
 
+	// The data is staged right away and copied in the next upload batch, which
+	// is submitted ahead of the next command list this renderer executes.
 	template <typename T>
 	std::shared_ptr<StructuredBuffer<T>> CreateStructuredBuffer(const std::vector<T> &data); 
+	// Rewrites the whole buffer in place through the same batch; `data` must
+	// have the buffer's element count.
+	template <typename T>
+	void UpdateStructuredBuffer(StructuredBuffer<T>& buffer, const std::vector<T>& data);
 	
 	inline static Microsoft::WRL::ComPtr<ID3D12Device5> g_device;
-	inline static int g_textureIndex = 0;
+	// Per-object and per-material constants; advanced once per rendered frame.
+	inline static std::shared_ptr<ConstantArena> g_constantArena;
 
 	// Headless (benchmark) runs disable the D3D12 debug layer: its per-submit
 	// validation of a fat-root-signature compute Dispatch costs ~100 ms/frame
@@ -133,11 +159,15 @@ private:
 	void SetScissorRect();
 
 	void FlushCommandQueue();
+	void SubmitTextureUploads();
+	// Default-heap buffer of `bufferSize` bytes whose first `dataSize` bytes
+	// are uploaded from `data` (the rest zeroed) through m_uploadScheduler.
+	Microsoft::WRL::ComPtr<ID3D12Resource> CreateUploadedBuffer(const void* data, UINT64 dataSize, UINT64 bufferSize);
 	
 	bool CheckTearingSupport();
 	bool CheckRayTracingSupport() const;
 
-	void CreateTextureSRV(const std::shared_ptr<Texture>& texture);
+	void CreateTextureSRV(const std::shared_ptr<Texture>& texture, UINT componentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING);
 	void CreateVertexSRV();
 	void CreateIndexSRV();
 
@@ -159,6 +189,7 @@ private:
 	std::shared_ptr<FrameAccumulationPass> m_accumulationPass;
 	std::shared_ptr<PostProcessPass> m_postProcessPass;
 	std::shared_ptr<ScreenshotManager> m_screenshotManager;
+	std::shared_ptr<VxpgSnapshotManager> m_vxpgSnapshotManager;
 	std::vector<std::shared_ptr<AccelerationStructures>> m_accelerationStructures;
 
 	DirectX::SimpleMath::Vector3 m_prevCameraPos = {};
@@ -230,6 +261,17 @@ private:
 	std::shared_ptr<Material> m_material;
 	std::vector<std::shared_ptr<Texture>> m_textures = std::vector<std::shared_ptr<Texture>>();
 
+	// Texture upload batch: staging buffers stay alive until their copies ran.
+	bool m_batchingTextureUploads = false;
+	std::vector<Microsoft::WRL::ComPtr<ID3D12Resource>> m_pendingTextureUploads;
+	UINT64 m_pendingTextureUploadBytes = 0;
+	size_t m_batchedTextureCount = 0;
+	size_t m_textureUploadSubmissions = 0;
+
+	// Buffer uploads share one staging ring and go out in one submission per
+	// ExecuteCommandsAndReset / frame instead of a GPU round trip each.
+	std::unique_ptr<UploadScheduler> m_uploadScheduler;
+
 	std::shared_ptr<PassConstants> m_passConstants;
 	std::shared_ptr<StructuredBuffer<float>> m_randomBuffer;
 	Microsoft::WRL::ComPtr<ID3D12Resource> m_skyboxResource;
@@ -253,14 +295,7 @@ std::shared_ptr<StructuredBuffer<T>> Renderer::CreateStructuredBuffer(const std:
 	const auto data_size = sizeof(T) * data.size();
 	auto buffer_size = std::max(data_size, sizeof(T)); // D3D12 disallows 0-byte resources
 
-	Microsoft::WRL::ComPtr<ID3D12Resource> upload_buffer;
-
-	auto cpuData = static_cast<BYTE*>(malloc(buffer_size));
-	memset(cpuData, 0, buffer_size);
-	if (data_size > 0)
-		memcpy(cpuData, data.data(), data_size);
-
-	Microsoft::WRL::ComPtr<ID3D12Resource> default_buffer = RenderingUtils::CreateDefaultBuffer(g_device.Get(), m_d3d12CommandList.Get(), cpuData, buffer_size, upload_buffer);
+	Microsoft::WRL::ComPtr<ID3D12Resource> default_buffer = CreateUploadedBuffer(data.data(), data_size, buffer_size);
 	auto structured_buffer = std::make_shared<StructuredBuffer<T>>(g_device, default_buffer, data.size());
 
 	const std::string type_name = typeid(T).name();
@@ -268,8 +303,12 @@ std::shared_ptr<StructuredBuffer<T>> Renderer::CreateStructuredBuffer(const std:
 	
 	structured_buffer->SetResourceName(resource_name);
 
-	ExecuteCommandsAndReset();
-	AssertFreeClear(&cpuData);
-
 	return structured_buffer;
 }
+
+template <typename T>
+void Renderer::UpdateStructuredBuffer(StructuredBuffer<T>& buffer, const std::vector<T>& data)
+{
+	assert(buffer.GetElementsCount() == data.size() && "UpdateStructuredBuffer cannot resize; create a new buffer instead");
+	m_uploadScheduler->Enqueue(buffer.GetUnderlyingResource().Get(), 0, data.data(), sizeof(T) * data.size());
+}
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Where ConstantArena pages come from. The engine backs them with persistently
+// mapped upload-heap buffers (UploadHeapArenaBacking).
+class ConstantArenaBacking
+{
+public:
+    struct Page
+    {
+        uint8_t* cpu = nullptr;
+        uint64_t gpu = 0;
+    };
+
+    virtual ~ConstantArenaBacking() = default;
+
+    // `bytes` is a multiple of ConstantArena::SLOT_ALIGNMENT; both addresses
+    // must be aligned to it. Pages live until the backing is destroyed.
+    virtual Page AllocatePage(size_t bytes) = 0;
+};
+
+class ConstantArena;
+
+// One object's constant data: `frameCount` consecutive copies of the rounded
+// size. A write goes to the next copy the first time it happens in a frame, so
+// the copies frames still in flight read are never touched. That copy holds
+// an older frame's data, so every write replaces the whole contents; there is
+// no partial update. Move-only; the slot is returned to the arena on
+// destruction.
+class ConstantAllocation
+{
+public:
+    ConstantAllocation() = default;
+    ~ConstantAllocation();
+
+    ConstantAllocation(ConstantAllocation&& other) noexcept;
+    ConstantAllocation& operator=(ConstantAllocation&& other) noexcept;
+    ConstantAllocation(const ConstantAllocation&) = delete;
+    ConstantAllocation& operator=(const ConstantAllocation&) = delete;
+
+    [[nodiscard]] bool IsValid() const { return m_arena != nullptr; }
+    // Bytes passed to ConstantArena::Allocate.
+    [[nodiscard]] size_t GetSize() const { return m_size; }
+
+    // Copy of the latest write, for binding as a root CBV.
+    [[nodiscard]] uint64_t GetGpuAddress() const { return m_gpu + m_version * m_stride; }
+
+    // Replaces the contents; `bytes` must be GetSize().
+    void Write(const void* data, size_t bytes);
+
+private:
+    friend class ConstantArena;
+
+    void Release();
+
+    std::shared_ptr<ConstantArena> m_arena;
+    uint8_t* m_cpu = nullptr;
+    uint64_t m_gpu = 0;
+    uint32_t m_size = 0;
+    uint32_t m_stride = 0; // bytes per copy, SLOT_ALIGNMENT multiple
+    uint32_t m_version = 0;
+    uint64_t m_lastWriteFrame = UINT64_MAX;
+};
+
+// Sub-allocator for small, long-lived constant buffers (per-object world
+// matrices, materials). Pages of `pageSize` bytes are carved into slots
+// aligned to the D3D12 CBV placement alignment; freed slots are kept on a
+// free list per size and reused once the frames that could still read them
+// have retired. Allocate and free are thread-safe; writes to distinct
+// allocations need no lock.
+class ConstantArena : public std::enable_shared_from_this<ConstantArena>
+{
+public:
+    static constexpr size_t SLOT_ALIGNMENT = 256; // D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT
+    static constexpr size_t DEFAULT_PAGE_SIZE = 256 * 1024;
+
+    struct Stats
+    {
+        size_t pageCount = 0;
+        size_t pageBytes = 0;
+        size_t liveAllocations = 0;
+        size_t liveBytes = 0;    // including every frame copy
+        size_t pendingFrees = 0; // freed, waiting for in-flight frames
+    };
+
+    // Must be owned by a shared_ptr: allocations keep the arena alive.
+    ConstantArena(std::unique_ptr<ConstantArenaBacking> backing, uint32_t frameCount, size_t pageSize = DEFAULT_PAGE_SIZE);
+
+    ConstantArena(const ConstantArena&) = delete;
+    ConstantArena& operator=(const ConstantArena&) = delete;
+
+    ConstantAllocation Allocate(size_t bytes);
+
+    // Call once per frame after the GPU has finished the frame `frameCount`
+    // frames back; starts a new write version and recycles retired slots.
+    void AdvanceFrame();
+
+    [[nodiscard]] uint32_t GetFrameCount() const { return m_frameCount; }
+    [[nodiscard]] uint64_t GetCurrentFrame() const { return m_frame.load(std::memory_order_relaxed); }
+    [[nodiscard]] Stats GetStats() const;
+
+private:
+    friend class ConstantAllocation;
+
+    struct Slot
+    {
+        uint8_t* cpu;
+        uint64_t gpu;
+    };
+
+    struct PendingFree
+    {
+        Slot slot;
+        uint32_t units;
+        uint64_t retireFrame;
+    };
+
+    void Free(const Slot& slot, uint32_t stride);
+
+    std::unique_ptr<ConstantArenaBacking> m_backing;
+    const uint32_t m_frameCount;
+    const size_t m_pageSize;
+    std::atomic<uint64_t> m_frame{ 0 };
+
+    mutable std::mutex m_mutex;
+    std::vector<std::vector<Slot>> m_freeSlots; // indexed by size in SLOT_ALIGNMENT units
+    std::vector<PendingFree> m_pendingFrees;
+    ConstantArenaBacking::Page m_currentPage;
+    size_t m_currentPageUsed = 0;
+    size_t m_currentPageSize = 0;
+    size_t m_pageCount = 0;
+    size_t m_pageBytes = 0;
+    size_t m_liveAllocations = 0;
+    size_t m_liveBytes = 0;
+};
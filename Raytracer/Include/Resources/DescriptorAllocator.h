@@ -0,0 +1,191 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Persistent descriptor ranges over [base, base + capacity): best fit, free
+// neighbours coalesce immediately. Descriptor heaps are small (thousands of
+// entries), so ordered sets beat anything cleverer. Not thread-safe.
+class DescriptorRangeAllocator
+{
+public:
+    static constexpr uint32_t INVALID = UINT32_MAX;
+
+    struct Stats
+    {
+        uint32_t capacity = 0;
+        uint32_t used = 0;
+        uint32_t largestFree = 0;
+        size_t allocationCount = 0;
+        size_t freeRangeCount = 0;
+
+        // 0 when all free descriptors are one range, towards 1 as they splinter.
+        [[nodiscard]] double Fragmentation() const
+        {
+            const uint32_t free = capacity - used;
+            return free == 0 ? 0.0 : 1.0 - static_cast<double>(largestFree) / static_cast<double>(free);
+        }
+    };
+
+    DescriptorRangeAllocator(uint32_t base, uint32_t capacity);
+
+    // First descriptor of `count` contiguous ones; INVALID when nothing fits.
+    uint32_t Allocate(uint32_t count);
+    void Free(uint32_t offset, uint32_t count);
+
+    [[nodiscard]] uint32_t GetBase() const { return m_base; }
+    [[nodiscard]] uint32_t GetCapacity() const { return m_capacity; }
+    [[nodiscard]] Stats GetStats() const;
+
+    // False on overlapping or uncoalesced free ranges or a broken size index.
+    [[nodiscard]] bool Validate() const;
+
+private:
+    void InsertFree(uint32_t offset, uint32_t count);
+    void EraseFree(std::map<uint32_t, uint32_t>::iterator it);
+    void ResizeFree(std::map<uint32_t, uint32_t>::iterator it, uint32_t offset, uint32_t count);
+
+    uint32_t m_base;
+    uint32_t m_capacity;
+    uint32_t m_used = 0;
+    size_t m_allocationCount = 0;
+    std::map<uint32_t, uint32_t> m_freeByOffset;          // offset -> count
+    std::set<std::pair<uint32_t, uint32_t>> m_freeBySize; // (count, offset)
+};
+
+// Linear ring over [base, base + capacity) for descriptor tables written and
+// bound within one frame. A table never wraps; the tail of the ring is skipped
+// instead. Space is reclaimed a frame at a time once `frameCount` frames have
+// passed, i.e. once the GPU can no longer be reading it. Not thread-safe.
+class DescriptorRing
+{
+public:
+    static constexpr uint32_t INVALID = UINT32_MAX;
+
+    DescriptorRing(uint32_t base, uint32_t capacity, uint32_t frameCount);
+
+    // INVALID when the in-flight frames already hold the whole ring.
+    uint32_t Allocate(uint32_t count);
+    void AdvanceFrame();
+
+    [[nodiscard]] uint32_t GetCapacity() const { return m_capacity; }
+    [[nodiscard]] uint32_t GetInFlight() const { return static_cast<uint32_t>(m_head - m_tail); }
+    [[nodiscard]] uint32_t GetPeakInFlight() const { return m_peakInFlight; }
+
+private:
+    struct FrameEnd
+    {
+        uint64_t frame;
+        uint64_t head;
+    };
+
+    uint32_t m_base;
+    uint32_t m_capacity;
+    uint32_t m_frameCount;
+    uint64_t m_frame = 0;
+    // Monotonic positions; the ring slot is position % capacity.
+    uint64_t m_head = 0;
+    uint64_t m_tail = 0;
+    uint32_t m_peakInFlight = 0;
+    std::deque<FrameEnd> m_frameEnds;
+};
+
+// Index-space bookkeeping for one shader-visible descriptor heap: persistent
+// ranges at the front, the transient ring at the back. On top of the raw
+// ranges it hands out
+//  - named ranges: stable slots a writer and its readers agree on by name,
+//    so a pass adds a resource without reserving a heap index anywhere;
+//  - bindless tables: a named range whose entries are handed out one at a
+//    time, the index being what shaders use to address the table (textures).
+// Freed persistent descriptors are reused only after `frameCount` frames.
+// Thread-safe. DescriptorHeapAllocator maps the indices onto the D3D12 heap.
+class DescriptorAllocator
+{
+public:
+    static constexpr uint32_t INVALID = UINT32_MAX;
+
+    struct Range
+    {
+        uint32_t offset = INVALID;
+        uint32_t count = 0;
+
+        [[nodiscard]] bool IsValid() const { return offset != INVALID; }
+    };
+
+    struct Stats
+    {
+        DescriptorRangeAllocator::Stats persistent;
+        uint32_t transientCapacity = 0;
+        uint32_t transientInFlight = 0;
+        uint32_t transientPeak = 0;
+        size_t pendingFrees = 0;
+        std::vector<std::pair<std::string, Range>> named;
+        // (name, entries in use, capacity)
+        std::vector<std::tuple<std::string, uint32_t, uint32_t>> bindlessTables;
+    };
+
+    DescriptorAllocator(uint32_t persistentCount, uint32_t transientCount, uint32_t frameCount);
+
+    DescriptorAllocator(const DescriptorAllocator&) = delete;
+    DescriptorAllocator& operator=(const DescriptorAllocator&) = delete;
+
+    // Invalid range when the persistent part is exhausted.
+    Range Allocate(uint32_t count);
+    void Free(const Range& range);
+
+    // The range registered under `name`, allocated by the first caller.
+    // Every caller must ask for the same count.
+    Range GetNamed(const std::string& name, uint32_t count = 1);
+
+    // Creates (first call) or returns the named range backing a bindless table.
+    Range GetBindlessTable(const std::string& name, uint32_t capacity);
+    // Stable index into the table, INVALID when it is full. Released indices
+    // are reused only after `frameCount` frames, like persistent ranges.
+    uint32_t AllocateBindless(const std::string& table);
+    void FreeBindless(const std::string& table, uint32_t index);
+
+    // Valid until the end of the current frame; invalid when the ring is full.
+    Range AllocateTransient(uint32_t count);
+
+    // Call once per frame after submitting it.
+    void AdvanceFrame();
+
+    [[nodiscard]] uint32_t GetCapacity() const { return m_persistent.GetCapacity() + m_transient.GetCapacity(); }
+    [[nodiscard]] Stats GetStats() const;
+
+private:
+    struct BindlessTable
+    {
+        Range range;
+        DescriptorRangeAllocator entries;
+        uint32_t used = 0;
+    };
+
+    struct PendingFree
+    {
+        BindlessTable* table; // null: a persistent range
+        Range range;
+        uint64_t retireFrame;
+    };
+
+    Range GetNamedLocked(const std::string& name, uint32_t count);
+
+    const uint32_t m_frameCount;
+    uint64_t m_frame = 0;
+
+    mutable std::mutex m_mutex;
+    DescriptorRangeAllocator m_persistent;
+    DescriptorRing m_transient;
+    std::vector<PendingFree> m_pendingFrees;
+    std::map<std::string, Range> m_named;
+    std::unordered_map<std::string, BindlessTable> m_bindless;
+};
@@ -0,0 +1,62 @@
+#pragma once
+#include "Resources/HeapSuballocator.h"
+
+// Places DEFAULT-heap buffers and textures into shared ID3D12Heaps instead of
+// one committed resource each. Placement policy is HeapSuballocator (TLSF per
+// heap); this class only picks the heap pool (buffers, textures and render
+// targets stay apart, as resource heap tier 1 requires) and the alignment
+// class (4 KiB small textures, 64 KiB, 4 MiB MSAA), and creates the placed
+// resource. The allocation is returned when the resource's last reference
+// goes away, so callers keep plain ComPtr<ID3D12Resource>s. As with any placed
+// resource, render targets and depth buffers must be cleared or discarded
+// before their first use.
+class GpuMemoryAllocator
+{
+public:
+    static GpuMemoryAllocator& Get();
+
+    void Initialize(const Microsoft::WRL::ComPtr<ID3D12Device5>& device);
+
+    // Drop-in for CreateCommittedResource on a DEFAULT heap. Falls back to a
+    // committed resource before Initialize or when placement fails. Committed
+    // resources start zeroed; so do placed ones unless `zeroed` is false
+    // (contents fully written by an upload), which lets them reuse freed memory.
+    HRESULT CreateResource(
+        const D3D12_RESOURCE_DESC& desc,
+        D3D12_RESOURCE_STATES initialState,
+        const D3D12_CLEAR_VALUE* clearValue,
+        REFIID riid,
+        void** resource,
+        bool zeroed = true);
+
+    // Heap occupancy and fragmentation per pool, then live/peak bytes per tag.
+    void LogReport() const;
+
+    // Tags allocations made on this thread in its scope (nests; innermost wins).
+    class ScopedTag
+    {
+    public:
+        explicit ScopedTag(const char* tag);
+        ~ScopedTag();
+
+        ScopedTag(const ScopedTag&) = delete;
+        ScopedTag& operator=(const ScopedTag&) = delete;
+
+    private:
+        const char* m_previous;
+    };
+
+private:
+    enum Pool
+    {
+        POOL_BUFFERS,
+        POOL_TEXTURES,
+        POOL_RENDER_TARGETS,
+        POOL_COUNT,
+    };
+
+    GpuMemoryAllocator() = default;
+
+    Microsoft::WRL::ComPtr<ID3D12Device5> m_device;
+    std::shared_ptr<HeapSuballocator> m_pools[POOL_COUNT];
+};
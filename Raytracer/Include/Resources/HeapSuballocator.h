@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Resources/TlsfAllocator.h"
+
+// Where HeapSuballocator heaps come from: ID3D12Heaps in the engine
+// (GpuMemoryAllocator), plain bookkeeping in tests.
+class HeapBacking
+{
+public:
+    virtual ~HeapBacking() = default;
+
+    // Creates heap number `heap` of `bytes`; false if the memory is unavailable.
+    virtual bool CreateHeap(uint32_t heap, uint64_t bytes) = 0;
+    virtual void DestroyHeap(uint32_t heap) = 0;
+};
+
+// Places allocations into a growing set of fixed-size heaps, each managed by a
+// TlsfAllocator; first heap with room wins, so long-lived data packs into the
+// oldest heaps. Requests above half a heap get a dedicated heap of their own.
+// Empty heaps are destroyed except for one spare. Every allocation carries a
+// tag (the creating pass) for the memory report. Thread-safe.
+class HeapSuballocator
+{
+public:
+    static constexpr uint32_t INVALID = UINT32_MAX;
+
+    struct Allocation
+    {
+        uint32_t heap = INVALID;
+        uint32_t block = TlsfAllocator::INVALID;
+        uint32_t tag = 0;
+        uint64_t offset = 0;
+        uint64_t size = 0;
+
+        [[nodiscard]] bool IsValid() const { return heap != INVALID; }
+    };
+
+    struct HeapStats
+    {
+        uint32_t heap = INVALID;
+        bool dedicated = false;
+        TlsfAllocator::Stats usage;
+    };
+
+    struct TagStats
+    {
+        std::string tag;
+        size_t allocationCount = 0;
+        uint64_t bytes = 0;
+        uint64_t peakBytes = 0;
+    };
+
+    HeapSuballocator(std::unique_ptr<HeapBacking> backing, uint64_t heapSize);
+    ~HeapSuballocator();
+
+    HeapSuballocator(const HeapSuballocator&) = delete;
+    HeapSuballocator& operator=(const HeapSuballocator&) = delete;
+
+    // `alignment` is a power of two (D3D12: 4 KiB, 64 KiB or 4 MiB). With
+    // `untouched`, only memory never handed out before is used, so the heap's
+    // initial zero fill still holds. Invalid allocation when the backing
+    // cannot create a heap.
+    Allocation Allocate(uint64_t size, uint64_t alignment, const char* tag, bool untouched = false);
+    void Free(const Allocation& allocation);
+
+    [[nodiscard]] uint64_t GetHeapSize() const { return m_heapSize; }
+    [[nodiscard]] HeapBacking& GetBacking() const { return *m_backing; }
+    [[nodiscard]] std::vector<HeapStats> GetHeapStats() const;
+    [[nodiscard]] std::vector<TagStats> GetTagStats() const;
+
+private:
+    struct Heap
+    {
+        std::unique_ptr<TlsfAllocator> allocator; // null: slot free for reuse
+        bool dedicated = false;
+    };
+
+    uint32_t CreateHeap(uint64_t bytes, bool dedicated);
+    void DestroyHeap(uint32_t heap);
+    uint32_t InternTag(const char* tag);
+
+    std::unique_ptr<HeapBacking> m_backing;
+    const uint64_t m_heapSize;
+
+    mutable std::mutex m_mutex;
+    std::vector<Heap> m_heaps;
+    std::vector<TagStats> m_tags;
+    std::unordered_map<std::string, uint32_t> m_tagIndices;
+};
@@ -0,0 +1,36 @@
+#pragma once
+#include "Resources/UploadScheduler.h"
+
+// UploadScheduler batches as command lists on the renderer's direct queue,
+// staged from one persistently mapped upload-heap buffer. Submitting on the
+// same queue orders every batch before the work submitted after it, so no
+// cross-queue synchronisation is needed. Destinations are ID3D12Resource
+// buffers; they are promoted to COPY_DEST implicitly and decay back to COMMON
+// once the batch has run.
+class QueueUploadBackend : public UploadBackend
+{
+public:
+    QueueUploadBackend(const Microsoft::WRL::ComPtr<ID3D12Device5>& device, const Microsoft::WRL::ComPtr<ID3D12CommandQueue>& queue);
+    ~QueueUploadBackend() override;
+
+    uint8_t* AllocateStagingRing(uint64_t bytes) override;
+    uint64_t Submit(const std::vector<UploadCopy>& copies) override;
+    uint64_t GetCompletedFence() override;
+    void WaitForFence(uint64_t value) override;
+
+private:
+    struct Recorder
+    {
+        Microsoft::WRL::ComPtr<ID3D12CommandAllocator> allocator;
+        uint64_t fence = 0; // batch last recorded with it
+    };
+
+    Microsoft::WRL::ComPtr<ID3D12Device5> m_device;
+    Microsoft::WRL::ComPtr<ID3D12CommandQueue> m_queue;
+    Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList> m_commandList;
+    Microsoft::WRL::ComPtr<ID3D12Resource> m_ring;
+    Microsoft::WRL::ComPtr<ID3D12Fence> m_fence;
+    HANDLE m_fenceEvent = nullptr;
+    uint64_t m_fenceValue = 0;
+    std::vector<Recorder> m_recorders;
+};
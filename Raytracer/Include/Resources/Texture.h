@@ -5,6 +5,12 @@ class Texture : public Resource
 {
 public:
     Texture(const Microsoft::WRL::ComPtr<ID3D12Device5>& device, const Microsoft::WRL::ComPtr<ID3D12Resource>& resource);
+    ~Texture();
+
+    Texture(const Texture&) = delete;
+    Texture& operator=(const Texture&) = delete;
+
+    // Stable entry in the shader texture table until the texture is destroyed.
     int GetTextureIndex() const { return m_textureIndex; }
 
 private:
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Two-level segregated fit over an abstract range [0, capacity): O(1)
+// allocate and free, immediate coalescing, good fit. Block headers live in a
+// side table (the range itself is GPU memory and never touched). Offsets and
+// sizes are multiples of GRANULARITY; alignments are powers of two. Not
+// thread-safe.
+class TlsfAllocator
+{
+public:
+    static constexpr uint64_t GRANULARITY = 256;
+    static constexpr uint32_t INVALID = UINT32_MAX;
+
+    struct Allocation
+    {
+        uint32_t block = INVALID; // handle for Free
+        uint64_t offset = 0;
+        uint64_t size = 0;        // rounded to GRANULARITY
+
+        [[nodiscard]] bool IsValid() const { return block != INVALID; }
+    };
+
+    struct Stats
+    {
+        uint64_t capacity = 0;
+        uint64_t usedBytes = 0;
+        uint64_t freeBytes = 0;
+        uint64_t largestFreeBlock = 0;
+        size_t allocationCount = 0;
+        size_t freeBlockCount = 0;
+
+        // 0 when all free memory is one block, towards 1 as it splinters.
+        [[nodiscard]] double Fragmentation() const
+        {
+            return freeBytes == 0 ? 0.0 : 1.0 - static_cast<double>(largestFreeBlock) / static_cast<double>(freeBytes);
+        }
+    };
+
+    explicit TlsfAllocator(uint64_t capacity);
+
+    // Invalid allocation when no free block fits.
+    Allocation Allocate(uint64_t size, uint64_t alignment = GRANULARITY);
+    // Same, restricted to memory no allocation has used yet (above the high
+    // water mark), for callers relying on the backing's initial zero fill.
+    Allocation AllocateUntouched(uint64_t size, uint64_t alignment = GRANULARITY);
+    void Free(uint32_t block);
+
+    [[nodiscard]] bool IsEmpty() const { return m_allocationCount == 0; }
+    [[nodiscard]] uint64_t GetCapacity() const { return m_capacity; }
+    [[nodiscard]] uint64_t GetHighWater() const { return m_highWater; }
+    [[nodiscard]] Stats GetStats() const;
+
+    // Walks the physical block list and free lists; false on any broken
+    // invariant (overlap, uncoalesced neighbours, misfiled free block).
+    [[nodiscard]] bool Validate() const;
+
+private:
+    static constexpr uint32_t SL_BITS = 4;
+    static constexpr uint32_t SL_COUNT = 1u << SL_BITS;
+    static constexpr uint32_t FL_COUNT = 64 - SL_BITS;
+
+    struct Block
+    {
+        uint64_t offset;
+        uint64_t size;
+        uint32_t prevPhysical;
+        uint32_t nextPhysical;
+        uint32_t prevFree;
+        uint32_t nextFree;
+        bool isFree;
+    };
+
+    static void MappingInsert(uint64_t units, uint32_t& fl, uint32_t& sl);
+    static void MappingSearch(uint64_t units, uint32_t& fl, uint32_t& sl);
+
+    uint32_t NewBlock();
+    void ReleaseBlock(uint32_t block);
+    void InsertFree(uint32_t block);
+    void RemoveFree(uint32_t block);
+    uint32_t FindFree(uint64_t size);
+    // Carves [offset, offset + size) out of free `block`, already off its list.
+    Allocation Claim(uint32_t block, uint64_t offset, uint64_t size);
+    // Splits `size` bytes off the front of `block`; the tail becomes a new block
+    // the caller files.
+    void SplitTail(uint32_t block, uint64_t size);
+    // Merges `block` into its physical predecessor; returns the survivor.
+    uint32_t MergeWithPrevious(uint32_t block);
+
+    uint64_t m_capacity;
+    uint64_t m_highWater = 0;
+    uint32_t m_lastBlock = 0; // physically last block
+    std::vector<Block> m_blocks;
+    std::vector<uint32_t> m_unusedBlocks;
+    uint64_t m_flBitmap = 0;
+    uint32_t m_slBitmap[FL_COUNT] = {};
+    uint32_t m_freeHeads[FL_COUNT][SL_COUNT];
+    uint64_t m_usedBytes = 0;
+    size_t m_allocationCount = 0;
+};
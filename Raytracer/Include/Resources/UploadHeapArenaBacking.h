@@ -0,0 +1,17 @@
+#pragma once
+#include "Resources/ConstantArena.h"
+
+// ConstantArena pages as committed upload-heap buffers, mapped for their
+// whole lifetime (upload heaps may stay mapped while the GPU reads them).
+class UploadHeapArenaBacking : public ConstantArenaBacking
+{
+public:
+    explicit UploadHeapArenaBacking(const Microsoft::WRL::ComPtr<ID3D12Device5>& device);
+    ~UploadHeapArenaBacking() override;
+
+    Page AllocatePage(size_t bytes) override;
+
+private:
+    Microsoft::WRL::ComPtr<ID3D12Device5> m_device;
+    std::vector<Microsoft::WRL::ComPtr<ID3D12Resource>> m_pages;
+};
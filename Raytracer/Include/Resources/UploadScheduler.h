@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <vector>
+
+// One buffer copy of a batch: `size` bytes from the staging ring at
+// `stagingOffset` into `destination` (a backend resource) at `destinationOffset`.
+struct UploadCopy
+{
+    void* destination = nullptr;
+    uint64_t destinationOffset = 0;
+    uint64_t stagingOffset = 0;
+    uint64_t size = 0;
+};
+
+// Where UploadScheduler's staging memory comes from and its batches go. The
+// engine records copies on the direct queue (QueueUploadBackend).
+class UploadBackend
+{
+public:
+    virtual ~UploadBackend() = default;
+
+    // Called once. The memory stays valid until the backend is destroyed.
+    virtual uint8_t* AllocateStagingRing(uint64_t bytes) = 0;
+
+    // Records `copies` in order and submits them as one batch. Returns the
+    // fence value that signals its completion; values only increase.
+    virtual uint64_t Submit(const std::vector<UploadCopy>& copies) = 0;
+    virtual uint64_t GetCompletedFence() = 0;
+    virtual void WaitForFence(uint64_t value) = 0;
+};
+
+// Batches CPU -> GPU buffer uploads through one persistent staging ring.
+// Enqueueing copies the data into the ring right away, so callers may free
+// their source; the GPU copies are recorded and submitted together at the
+// next Submit. Ring space is reclaimed per batch once its fence has passed.
+// An upload larger than a quarter of the ring streams through it in chunks,
+// submitting and waiting for earlier batches only when the ring is full.
+// Not thread-safe.
+class UploadScheduler
+{
+public:
+    static constexpr uint64_t STAGING_ALIGNMENT = 256;
+
+    struct Stats
+    {
+        uint64_t ringCapacity = 0;
+        uint64_t ringInUse = 0;    // pending plus in-flight bytes
+        uint64_t ringPeak = 0;
+        size_t pendingCopies = 0;
+        size_t uploads = 0;        // Enqueue calls
+        size_t copies = 0;         // submitted copies after merging
+        size_t submissions = 0;
+        size_t stalls = 0;         // waits for the GPU on a full ring
+        uint64_t bytes = 0;
+    };
+
+    UploadScheduler(std::unique_ptr<UploadBackend> backend, uint64_t ringSize);
+    ~UploadScheduler();
+
+    UploadScheduler(const UploadScheduler&) = delete;
+    UploadScheduler& operator=(const UploadScheduler&) = delete;
+
+    // Stages `size` bytes for `destination` at `destinationOffset`; a null
+    // `data` stages zeros. Copies that continue the previous one in both the
+    // ring and the destination are merged into it.
+    void Enqueue(void* destination, uint64_t destinationOffset, const void* data, uint64_t size);
+
+    // Submits every pending copy as one batch. Returns its fence value, 0 when
+    // nothing was pending.
+    uint64_t Submit();
+
+    // Submits, then blocks until every batch has completed.
+    void WaitIdle();
+
+    [[nodiscard]] Stats GetStats() const;
+
+private:
+    struct Batch
+    {
+        uint64_t fence;
+        uint64_t head; // ring position right after the batch's last copy
+    };
+
+    // Ring offset of `bytes` contiguous staging bytes, making room if needed.
+    uint64_t AllocateStaging(uint64_t bytes);
+    void Reclaim();
+
+    std::unique_ptr<UploadBackend> m_backend;
+    uint8_t* m_ring = nullptr;
+    uint64_t m_capacity;
+    uint64_t m_maxChunk;
+
+    // Monotonic positions; the ring offset is position % capacity.
+    uint64_t m_head = 0;
+    uint64_t m_tail = 0;
+    std::deque<Batch> m_inFlight;
+    std::vector<UploadCopy> m_pending;
+
+    Stats m_stats;
+};
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// glTF accessor decoding, independent of tinygltf and the engine headers so it
+// builds anywhere. A view describes one attribute stream as raw bytes (stride,
+// component type, normalized flag); the decoders convert a whole stream into a
+// caller-preallocated destination, e.g. a float field inside an AoS Vertex array.
+namespace AccessorDecoding
+{
+    // glTF 2.0 componentType values.
+    enum class ComponentType : int
+    {
+        Byte = 5120,
+        UnsignedByte = 5121,
+        Short = 5122,
+        UnsignedShort = 5123,
+        UnsignedInt = 5125,
+        Float = 5126,
+    };
+
+    struct AccessorView
+    {
+        const uint8_t* data = nullptr; // first element (bufferView + accessor offsets applied)
+        size_t count = 0;              // elements
+        size_t stride = 0;             // bytes between elements; 0 = tightly packed
+        ComponentType componentType = ComponentType::Float;
+        int componentCount = 1;        // SCALAR=1, VEC2=2, VEC3=3, VEC4=4
+        bool normalized = false;
+    };
+
+    [[nodiscard]] size_t ComponentSize(ComponentType type);
+    [[nodiscard]] size_t ElementSize(const AccessorView& view);
+    [[nodiscard]] size_t EffectiveStride(const AccessorView& view);
+
+    // Bytes the view reads past `data`; compare against what the buffer holds.
+    [[nodiscard]] size_t RequiredBytes(const AccessorView& view);
+
+    // Writes min(view.componentCount, dstComponents) floats per element to
+    // dst + i * dstStrideBytes. Integer components follow the glTF rules:
+    // normalized unsigned c / (2^n - 1), normalized signed max(c / (2^(n-1) - 1), -1),
+    // otherwise a plain cast. Returns false for an unsupported component type.
+    bool DecodeFloats(const AccessorView& view, float* dst, size_t dstStrideBytes, int dstComponents);
+
+    // Widens a SCALAR u8/u16/u32 index stream into dst[0, view.count).
+    bool DecodeIndices(const AccessorView& view, uint32_t* dst);
+}
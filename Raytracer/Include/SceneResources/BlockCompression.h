@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// CPU BCn block encoders and decoders. A block is 4x4 RGBA8 texels in row
+// order (64 bytes). Whole-image entry points split block rows across the
+// ThreadPool.
+namespace BlockCompression
+{
+    enum class BlockFormat : uint32_t
+    {
+        BC1, // RGB 5:6:5 endpoints, 2-bit indices (alpha ignored)
+        BC4, // one channel (R), 3-bit indices
+        BC5, // two channels (R, G) as two BC4 blocks
+        BC7, // RGBA, mode 6 only: 7-bit endpoints + p-bits, 4-bit indices
+    };
+
+    [[nodiscard]] constexpr size_t BlockBytes(BlockFormat format)
+    {
+        return format == BlockFormat::BC1 || format == BlockFormat::BC4 ? 8 : 16;
+    }
+
+    // Blocks covering width x height texels, in bytes.
+    [[nodiscard]] size_t CompressedSize(int width, int height, BlockFormat format);
+
+    void EncodeBC1(const uint8_t texels[64], uint8_t out[8]);
+    void EncodeBC4(const uint8_t values[16], uint8_t out[8]);
+    void EncodeBC5(const uint8_t texels[64], uint8_t out[16]);
+    void EncodeBC7(const uint8_t texels[64], uint8_t out[16]);
+
+    // Decoders write RGBA8 blocks. BC4 fills R, BC5 fills R and G; the other
+    // channels are 0 with alpha 255, as a GPU would sample them. DecodeBC7
+    // understands mode 6 only (what EncodeBC7 emits); other modes decode to 0.
+    void DecodeBC1(const uint8_t block[8], uint8_t texels[64]);
+    void DecodeBC4(const uint8_t block[8], uint8_t texels[64]);
+    void DecodeBC5(const uint8_t block[16], uint8_t texels[64]);
+    void DecodeBC7(const uint8_t block[16], uint8_t texels[64]);
+
+    // Whole image (tightly packed RGBA8). Partial edge blocks replicate the
+    // last row/column. Parallel over block rows.
+    std::vector<uint8_t> Compress(const uint8_t* rgba, int width, int height, BlockFormat format);
+    void Decompress(const uint8_t* blocks, int width, int height, BlockFormat format, std::vector<uint8_t>& rgba);
+}
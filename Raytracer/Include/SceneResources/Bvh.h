@@ -0,0 +1,285 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+// CPU bounding volume hierarchies for ray queries the GPU acceleration
+// structures cannot answer (picking, offline bakes, reference renders).
+// Builds use the ThreadPool.
+
+struct BvhAabb
+{
+    float min[3] = { std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max() };
+    float max[3] = { -std::numeric_limits<float>::max(), -std::numeric_limits<float>::max(), -std::numeric_limits<float>::max() };
+
+    void Grow(const float point[3])
+    {
+        for (int a = 0; a < 3; ++a)
+        {
+            min[a] = point[a] < min[a] ? point[a] : min[a];
+            max[a] = point[a] > max[a] ? point[a] : max[a];
+        }
+    }
+
+    void Grow(const BvhAabb& other)
+    {
+        for (int a = 0; a < 3; ++a)
+        {
+            min[a] = other.min[a] < min[a] ? other.min[a] : min[a];
+            max[a] = other.max[a] > max[a] ? other.max[a] : max[a];
+        }
+    }
+
+    [[nodiscard]] bool IsEmpty() const { return min[0] > max[0] || min[1] > max[1] || min[2] > max[2]; }
+
+    // Half the surface area; the SAH only ever compares ratios.
+    [[nodiscard]] float HalfArea() const
+    {
+        if (IsEmpty())
+            return 0.0f;
+        const float x = max[0] - min[0];
+        const float y = max[1] - min[1];
+        const float z = max[2] - min[2];
+        return x * y + y * z + z * x;
+    }
+};
+
+// 32 bytes. Interior when count == 0, with its children at `first` and
+// `first + 1`; a leaf covers `count` primitives of the build order from `first`.
+struct BvhNode
+{
+    float min[3];
+    uint32_t first;
+    float max[3];
+    uint32_t count;
+
+    [[nodiscard]] bool IsLeaf() const { return count != 0; }
+};
+static_assert(sizeof(BvhNode) == 32, "BvhNode must stay two nodes per cache line");
+
+struct BvhBuildSettings
+{
+    uint32_t binCount = 16;
+    uint32_t maxLeafSize = 4;
+    // Cost of visiting a node relative to one primitive test.
+    float traversalCost = 1.0f;
+    // Ranges with more primitives are binned by the whole pool; smaller
+    // subtrees are built start to finish on one thread each.
+    uint32_t parallelThreshold = 16384;
+};
+
+struct BvhBuildStats
+{
+    size_t primitiveCount = 0;
+    size_t nodeCount = 0;
+    size_t leafCount = 0;
+    uint32_t maxDepth = 0;
+    // Expected cost of a random ray through the tree, in primitive tests.
+    double sahCost = 0.0;
+    double milliseconds = 0.0;
+};
+
+// Binned SAH over primitive bounds (Wald, "On fast Construction of SAH-based
+// Bounding Volume Hierarchies", 2007), top-down. Bins also collect centroid
+// bounds, so children never rescan their primitives before binning. Ranges
+// that cannot be split by centroid are split at the median; depth is capped
+// at MAX_DEPTH so fixed traversal stacks are safe.
+namespace BvhBuilder
+{
+    constexpr uint32_t MAX_DEPTH = 64;
+
+    // Node 0 is the root. `order` receives the primitive order leaves index.
+    std::vector<BvhNode> Build(const BvhAabb* bounds, size_t count, std::vector<uint32_t>& order,
+        const BvhBuildSettings& settings = {}, BvhBuildStats* stats = nullptr);
+}
+
+struct BvhRay
+{
+    float origin[3] = { 0.0f, 0.0f, 0.0f };
+    float direction[3] = { 0.0f, 0.0f, 1.0f };
+    float tMin = 0.0f;
+    float tMax = std::numeric_limits<float>::infinity();
+};
+
+struct BvhHit
+{
+    static constexpr uint32_t INVALID = UINT32_MAX;
+
+    float t = std::numeric_limits<float>::infinity();
+    // DXR barycentrics: weights of the triangle's second and third vertex.
+    float u = 0.0f;
+    float v = 0.0f;
+    uint32_t primitive = INVALID; // triangle within its mesh, as PrimitiveIndex()
+    uint32_t instance = INVALID;
+
+    [[nodiscard]] bool IsHit() const { return primitive != INVALID; }
+};
+
+// Candidate filter for non-opaque triangles, the CPU side of an any-hit shader
+// calling IgnoreHit(): returning false discards the candidate and traversal
+// goes on. `primitive`, u and v are as in BvhHit.
+struct BvhHitFilter
+{
+    bool (*accept)(const void* context, uint32_t primitive, float u, float v) = nullptr;
+    const void* context = nullptr;
+
+    [[nodiscard]] bool Accept(uint32_t primitive, float u, float v) const { return !accept || accept(context, primitive, u, v); }
+};
+
+// Slab test against node bounds with the ray's reciprocal direction
+// precomputed. The far distance is widened by 1 + 2 * gamma(3) (Ize 2013) so
+// rounding cannot reject a box the ray touches; NaNs from a zero direction
+// component on a slab plane leave the interval unchanged.
+struct BvhRayBoxTest
+{
+    float origin[3];
+    float inverseDirection[3];
+
+    explicit BvhRayBoxTest(const BvhRay& ray)
+    {
+        for (int a = 0; a < 3; ++a)
+        {
+            origin[a] = ray.origin[a];
+            inverseDirection[a] = 1.0f / ray.direction[a];
+        }
+    }
+
+    // Entry distance into the node, or infinity when (tMin, tMax) misses it.
+    [[nodiscard]] float Enter(const BvhNode& node, float tMin, float tMax) const
+    {
+        constexpr float kFarScale = 1.0f + 2.0f * (3.0f * 0.5f * std::numeric_limits<float>::epsilon()) / (1.0f - 3.0f * 0.5f * std::numeric_limits<float>::epsilon());
+        for (int a = 0; a < 3; ++a)
+        {
+            float t0 = (node.min[a] - origin[a]) * inverseDirection[a];
+            float t1 = (node.max[a] - origin[a]) * inverseDirection[a];
+            if (t0 > t1)
+            {
+                const float swap = t0;
+                t0 = t1;
+                t1 = swap;
+            }
+            t1 *= kFarScale;
+            tMin = t0 > tMin ? t0 : tMin;
+            tMax = t1 < tMax ? t1 : tMax;
+            if (tMin > tMax)
+                return std::numeric_limits<float>::infinity();
+        }
+        return tMin;
+    }
+};
+
+// Front-to-back traversal shared by the BVH levels. Calls
+// leaf(const BvhNode&, float& tMax) for every leaf the ray enters before
+// tMax; the callback lowers tMax on a hit and returns true to stop early
+// (any-hit queries). Subtrees entered beyond the lowered tMax are skipped.
+template <typename LeafFn>
+void TraverseBvh(const std::vector<BvhNode>& nodes, const BvhRay& ray, float tMax, LeafFn&& leaf)
+{
+    constexpr float kMiss = std::numeric_limits<float>::infinity();
+    if (nodes.empty())
+        return;
+    const BvhRayBoxTest box(ray);
+    if (box.Enter(nodes[0], ray.tMin, tMax) == kMiss)
+        return;
+
+    struct Entry
+    {
+        const BvhNode* node;
+        float t;
+    };
+    Entry stack[BvhBuilder::MAX_DEPTH];
+    uint32_t stackSize = 0;
+    const BvhNode* node = nodes.data();
+    for (;;)
+    {
+        if (node->IsLeaf())
+        {
+            if (leaf(*node, tMax))
+                return;
+        }
+        else
+        {
+            const BvhNode* closer = &nodes[node->first];
+            const BvhNode* farther = closer + 1;
+            float tCloser = box.Enter(*closer, ray.tMin, tMax);
+            float tFarther = box.Enter(*farther, ray.tMin, tMax);
+            if (tFarther < tCloser)
+            {
+                const BvhNode* swapNode = closer;
+                closer = farther;
+                farther = swapNode;
+                const float swapT = tCloser;
+                tCloser = tFarther;
+                tFarther = swapT;
+            }
+            if (tCloser != kMiss)
+            {
+                if (tFarther != kMiss)
+                    stack[stackSize++] = { farther, tFarther };
+                node = closer;
+                continue;
+            }
+        }
+
+        node = nullptr;
+        while (stackSize > 0 && !node)
+        {
+            const Entry entry = stack[--stackSize];
+            if (entry.t <= tMax)
+                node = entry.node;
+        }
+        if (!node)
+            return;
+    }
+}
+
+// Triangles indexed into a position array whose entries are `positionStride`
+// bytes apart (e.g. the position at the start of each scene Vertex).
+struct BvhMesh
+{
+    const float* positions = nullptr;
+    size_t positionStride = 3 * sizeof(float);
+    const uint32_t* indices = nullptr;
+    size_t triangleCount = 0;
+};
+
+// BVH over one mesh. Triangles are copied in leaf order, so leaves read
+// contiguous memory. Intersection is the watertight test of Woop, Benthin and
+// Wald (JCGT 2013): no ray slips between triangles sharing an edge, and
+// box tests widen the far distance as in Ize, "Robust BVH Ray Traversal"
+// (JCGT 2013), so rounding cannot cull a box the ray grazes.
+class TriangleBvh
+{
+public:
+    void Build(const BvhMesh& mesh, const BvhBuildSettings& settings = {});
+
+    // Closest hit in (ray.tMin, min(ray.tMax, hit.t)). Updates t, u, v and
+    // primitive and returns true when it found a closer one. Candidates the
+    // filter rejects are skipped.
+    bool Intersect(const BvhRay& ray, BvhHit& hit, const BvhHitFilter* filter = nullptr) const;
+    // Any hit in (ray.tMin, ray.tMax).
+    [[nodiscard]] bool Occluded(const BvhRay& ray, const BvhHitFilter* filter = nullptr) const;
+
+    [[nodiscard]] BvhAabb GetBounds() const;
+    [[nodiscard]] size_t GetTriangleCount() const { return m_triangles.size(); }
+    [[nodiscard]] const std::vector<BvhNode>& GetNodes() const { return m_nodes; }
+    [[nodiscard]] const BvhBuildStats& GetStats() const { return m_stats; }
+
+private:
+    struct Triangle
+    {
+        float v0[3];
+        float v1[3];
+        float v2[3];
+        uint32_t index;
+    };
+
+    template <bool AnyHit>
+    bool Traverse(const BvhRay& ray, BvhHit& hit, const BvhHitFilter* filter) const;
+
+    std::vector<BvhNode> m_nodes;
+    std::vector<Triangle> m_triangles;
+    BvhBuildStats m_stats;
+};
@@ -1,21 +1,21 @@
 ﻿#pragma once
+#include "Resources/ConstantArena.h"
 
-class ConstantBuffer;
 class Model;
 
 class GameObject
 {
 public:
     GameObject() = default;
-    GameObject(const std::shared_ptr<Model>& model, const std::shared_ptr<ConstantBuffer>& modelWorldMatrixBuffer);
+    GameObject(const std::shared_ptr<Model>& model, ConstantAllocation worldMatrixConstants);
 
     [[nodiscard]] std::shared_ptr<Model> GetModel() const { return m_model; }
-    [[nodiscard]] std::shared_ptr<ConstantBuffer> GetWorldMatrixBuffer() const { return m_worldMatrixBuffer; }
+    [[nodiscard]] D3D12_GPU_VIRTUAL_ADDRESS GetWorldMatrixAddress() const { return m_worldMatrixConstants.GetGpuAddress(); }
     [[nodiscard]] DirectX::XMFLOAT4X4 GetWorldFloat4X4() const { return m_worldMatrix; }
     [[nodiscard]] DirectX::XMMATRIX GetWorldMatrix() const { return DirectX::XMLoadFloat4x4(&m_worldMatrix); }
 
     void UpdateWorldMatrix(const DirectX::XMFLOAT4X4& worldMatrix);
-    void UpdateWorldMatrix() const;
+    void UpdateWorldMatrix();
 
 private:
     friend class Renderer; // TODO: Maybe move the instantiation to other class?
@@ -23,6 +23,6 @@ private:
     
     std::shared_ptr<Model> m_model;
     
-    std::shared_ptr<ConstantBuffer> m_worldMatrixBuffer;
+    ConstantAllocation m_worldMatrixConstants; // world + inverse world
     DirectX::XMFLOAT4X4 m_worldMatrix;
 };
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "SceneResources/Voxelizer.h"
+
+// CPU twin of the VXPG bottom light tree (vxpgLightTree.hlsl): encode the lit
+// voxels into cluster/Morton/leaf sort keys, sort, initialize leaves, build
+// the Karras hierarchy and merge bounds, intensity and cluster roots bottom-up.
+// Every stage runs on the ThreadPool.
+//
+// BuildLightTree emits the shader's node array for the same inputs: same
+// sort keys, same node numbering (internal nodes first, then leaves in key
+// order), same half-packed AABBs and cluster roots. Leaf AABBs are computed
+// as separate multiply and add; a GPU that fuses them can differ by one half
+// ulp in rare corners. BuildWideLightTree runs the same pipeline with 32-bit
+// node indices and a wider key, lifting LIGHT_TREE_MAX_LEAVES; for inputs
+// under the cap it yields the same tree.
+
+// LightTreeNode.hlsl with the index width as a parameter.
+template <typename Index>
+struct LightTreeNodeT
+{
+    static constexpr Index NONE = static_cast<Index>(~Index(0));
+
+    uint32_t aabbMin[2]; // PackFloat3: x/y halves in [0], z half in the high bits of [1]
+    uint32_t aabbMax[2];
+    float intensity;     // leaf: premultiplied irradiance; internal: child sum
+    uint32_t flag;       // cluster id, 0xffffffff when the subtree spans several
+    Index parentIndex;
+    Index leftIndex;
+    Index rightIndex;
+    Index voxelIndex;    // leaf: compact id; internal: NONE
+};
+
+using LightTreeNode = LightTreeNodeT<uint16_t>;
+using LightTreeNodeWide = LightTreeNodeT<uint32_t>;
+static_assert(sizeof(LightTreeNode) == 32, "LightTreeNode must match the HLSL structured-buffer stride");
+static_assert(sizeof(LightTreeNodeWide) == 40, "LightTreeNodeWide must stay tightly packed");
+
+// What the tree pass reads per compact id: gCompactIds, gClusterAssignments
+// (-1 = no cluster) and gPremulIrradiance.
+struct LightTreeInput
+{
+    const uint32_t* compactIds = nullptr;
+    const int32_t* clusterAssignments = nullptr;
+    const float* premulIrradiance = nullptr;
+    uint32_t count = 0; // gVoxCounters[0]
+};
+
+struct LightTreeBuildStats
+{
+    uint32_t leafCount = 0;
+    double encodeMilliseconds = 0.0;
+    double sortMilliseconds = 0.0;
+    double hierarchyMilliseconds = 0.0; // leaf init + internal nodes
+    double mergeMilliseconds = 0.0;
+
+    [[nodiscard]] double TotalMilliseconds() const { return encodeMilliseconds + sortMilliseconds + hierarchyMilliseconds + mergeMilliseconds; }
+};
+
+template <typename Node>
+struct LightTreeT
+{
+    static constexpr uint32_t CLUSTER_COUNT = 32;
+
+    std::vector<uint64_t> sortKeys;     // sorted, leafCount entries (gSortKeys)
+    std::vector<Node> nodes;            // 2 * leafCount - 1
+    std::vector<int32_t> compactToLeaf; // per input entry: leaf node index or -1
+    int32_t clusterRoots[CLUSTER_COUNT];
+    uint32_t leafCount = 0;
+    bool overflow = false; // input count exceeded the variant's leaf cap
+    LightTreeBuildStats stats;
+};
+
+using LightTree = LightTreeT<LightTreeNode>;
+using LightTreeWide = LightTreeT<LightTreeNodeWide>;
+
+// Field-level difference of two node arrays, e.g. a CPU build and a GPU dump.
+struct LightTreeDiff
+{
+    size_t nodeCountDelta = 0;
+    size_t linkMismatches = 0;   // parent/left/right/voxel index
+    size_t flagMismatches = 0;
+    size_t boundsMismatches = 0; // packed AABB words
+    size_t intensityMismatches = 0;
+    float maxIntensityError = 0.0f; // relative
+    int64_t firstMismatch = -1;
+
+    [[nodiscard]] bool IsEmpty() const
+    {
+        return nodeCountDelta == 0 && linkMismatches == 0 && flagMismatches == 0 && boundsMismatches == 0 && intensityMismatches == 0;
+    }
+};
+
+// Clamped to LIGHT_TREE_MAX_LEAVES like EncodeTreeLeaves; the overflow flag
+// reports the clamp. grid provides gridMin, voxelSize and gridDim.
+LightTree BuildLightTree(const LightTreeInput& input, const VoxelGridConstants& grid);
+
+// Up to MAX_WIDE_LIGHT_TREE_LEAVES leaves: the key keeps 6 cluster bits, the
+// 30-bit Morton code and a 28-bit leaf id.
+constexpr uint32_t MAX_WIDE_LIGHT_TREE_LEAVES = 1u << 28;
+LightTreeWide BuildWideLightTree(const LightTreeInput& input, const VoxelGridConstants& grid);
+
+// intensityTolerance is relative; 0 demands identical floats.
+[[nodiscard]] LightTreeDiff CompareLightTrees(const LightTreeNode* first, size_t firstCount, const LightTreeNode* second, size_t secondCount,
+    float intensityTolerance = 0.0f);
@@ -1,14 +1,13 @@
 ﻿#pragma once
+#include "Resources/ConstantArena.h"
 #include "Resources/Texture.h"
 
-class ConstantBuffer;
-
 struct Material
 {
     Material();
     void UpdateMaterial();
     
-    std::shared_ptr<ConstantBuffer> m_materialBuffer;
+    ConstantAllocation m_constants; // MaterialData, rewritten by UpdateMaterial
     std::shared_ptr<Texture> m_albedoTexture;
     std::shared_ptr<Texture> m_normalTexture;
     std::shared_ptr<Texture> m_metallicRoughnessTexture;
@@ -23,7 +22,4 @@ struct Material
         float roughnessFactor = 1.0f;
         bool isOpaque{true};
     } m_data;
-
-private:
-    MaterialData m_mappedData;
 };
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "SceneResources/VertexPacking.h" // FloatVertex
+
+// Data-parallel normal and tangent generation behind MeshUtils::ComputeNormals
+// / ComputeTangents. Works on VertexPacking::FloatVertex (Vertex without
+// DirectXMath) and the ThreadPool; results do not depend on the thread count.
+namespace MeshAttributes
+{
+    using VertexPacking::FloatVertex;
+
+    // Area-weighted vertex normals. Face normals are computed into SoA arrays
+    // four faces at a time; each vertex then sums its corners in face order
+    // (CSR corner lists), so there are no racing writes and the sum order is
+    // fixed. Unreferenced / degenerate vertices get +Y.
+    void ComputeNormals(FloatVertex* vertices, size_t vertexCount, const uint32_t* indices, size_t indexCount);
+
+    // mikktspace tangents. Triangles are split into islands that share no
+    // mikktspace vertex (equal position, normal and uv); islands never affect
+    // each other, so each batch of islands runs the reference mikktspace on
+    // its own thread with triangle order preserved. A single connected island
+    // runs on one thread. Bit-identical to ComputeTangentsReference because the
+    // vendored mikktspace sorts its last edge run (upstream skips it, so the
+    // last faces of each call can lose neighbours, and which faces come last
+    // depends on the batching). Meshes with non-finite positions run serially.
+    void ComputeTangents(FloatVertex* vertices, size_t vertexCount, const uint32_t* indices, size_t indexCount);
+
+    // ComputeTangents with islands packed into batches of about batchTriangles
+    // triangles, independent of the thread count; lets tests force batching.
+    void ComputeTangentsInBatches(FloatVertex* vertices, size_t vertexCount, const uint32_t* indices, size_t indexCount, size_t batchTriangles);
+
+    // Single-threaded references (the pre-parallel implementations), kept for
+    // verification and benchmarking.
+    void ComputeNormalsReference(FloatVertex* vertices, size_t vertexCount, const uint32_t* indices, size_t indexCount);
+    void ComputeTangentsReference(FloatVertex* vertices, size_t vertexCount, const uint32_t* indices, size_t indexCount);
+}
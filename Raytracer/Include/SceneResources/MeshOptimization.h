@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Index/vertex-order optimization over raw arrays, used by
+// MeshUtils::OptimizeMesh. Remap tables map old vertex index -> new index;
+// UNUSED marks vertices no triangle references.
+namespace MeshOptimization
+{
+    constexpr uint32_t UNUSED = ~0u;
+
+    // Post-transform cache size the ACMR figures are measured against (FIFO).
+    constexpr uint32_t ACMR_CACHE_SIZE = 16;
+
+    // Welds bit-identical vertices of `stride` bytes. remap[vertexCount] receives
+    // the first occurrence's new index; returns the unique vertex count.
+    size_t GenerateWeldRemap(uint32_t* remap, const void* vertices, size_t vertexCount, size_t stride);
+
+    // Forsyth's linear-speed vertex cache optimization: reorders triangles in
+    // place so consecutive triangles reuse recently transformed vertices.
+    void OptimizeVertexCache(uint32_t* indices, size_t indexCount, size_t vertexCount);
+
+    // Renumbers vertices in first-use order of the index buffer so fetches walk
+    // memory forwards. remap[vertexCount]; returns the referenced vertex count.
+    size_t GenerateFetchRemap(uint32_t* remap, const uint32_t* indices, size_t indexCount, size_t vertexCount);
+
+    // Applies a remap: dst receives one vertex per new index (dst != src).
+    void RemapVertices(void* dst, const void* src, size_t vertexCount, size_t stride, const uint32_t* remap);
+    void RemapIndices(uint32_t* indices, size_t indexCount, const uint32_t* remap);
+
+    // Transformed vertices (FIFO cache misses) for the index buffer; ACMR is
+    // this over the triangle count.
+    size_t CountCacheMisses(const uint32_t* indices, size_t indexCount, size_t vertexCount, uint32_t cacheSize = ACMR_CACHE_SIZE);
+}
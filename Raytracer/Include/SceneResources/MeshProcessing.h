@@ -5,6 +5,8 @@
 #include <memory>
 
 #include "InputElements.h" // Vertex
+#include "SceneResources/VertexPacking.h"
+#include "Utils/ThreadPool.h"
 
 class Renderer;
 class SceneBuilder;
@@ -18,11 +20,41 @@ namespace MeshUtils
     // glTF/Tungsten spec: primitives without authored normals shade with face
     // normals. Area-weighted per-vertex accumulation, standard cross(v1-v0, v2-v0)
     // of the canonical CCW winding (matches the shader tri_normal).
+    // Data-parallel (MeshAttributes); bit-identical to the serial reference.
     void ComputeNormals(std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices);
 
     // mikktspace tangent generation (reads normals — run after ComputeNormals).
+    // Independent islands run in parallel; bit-identical to one mikktspace pass
+    // (MeshAttributes::ComputeTangents, Tests/MeshAttributesTests.cpp).
     void ComputeTangents(std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices);
 
+    // Normals and/or tangents for one primitive. With mesh.attributes.verify
+    // set (read it once on the loading thread), the single-threaded reference
+    // also runs on a copy and any mismatch is logged.
+    void GenerateAttributes(std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, bool normals, bool tangents, bool verify);
+    [[nodiscard]] bool IsAttributeVerificationEnabled();
+
+    // Primitives at least this many triangles get the whole pool for their
+    // attribute generation instead of sharing it with other primitives.
+    constexpr size_t LARGE_MESH_TRIANGLES = 65536;
+
+    // fn(i) for i in [0, count). Items with weight(i) < largeWeight run
+    // concurrently; heavier ones run one after another on the calling thread,
+    // so the parallel loops inside fn get the pool rather than running inline
+    // in a pool task. Returns the number of heavy items.
+    template <typename WeightFn, typename Fn>
+    size_t ForEachByWeight(size_t count, size_t largeWeight, WeightFn&& weight, Fn&& fn)
+    {
+        std::vector<size_t> small, large;
+        for (size_t i = 0; i < count; ++i)
+            (weight(i) < largeWeight ? small : large).push_back(i);
+
+        ThreadPool::Get().ParallelFor(small.size(), [&](size_t i) { fn(small[i]); });
+        for (size_t i : large)
+            fn(i);
+        return large.size();
+    }
+
     // Drop only truly degenerate (zero-area / collinear) triangles; thin flat
     // shells keep real area and survive.
     void DropDegenerateTriangles(const std::vector<Vertex>& vertices, std::vector<uint32_t>& indices);
@@ -31,6 +63,59 @@ namespace MeshUtils
     // non-finite positions/uvs; rebuild degenerate tangents from the normal.
     void EnforceVertexInvariants(std::vector<Vertex>& vertices);
 
+    // Totals for the load report. ACMR = cache misses per triangle against a
+    // MeshOptimization::ACMR_CACHE_SIZE entry FIFO.
+    struct MeshOptimizationStats
+    {
+        size_t verticesBefore = 0;
+        size_t verticesAfter = 0;
+        size_t triangles = 0;
+        size_t cacheMissesBefore = 0;
+        size_t cacheMissesAfter = 0;
+
+        void Accumulate(const MeshOptimizationStats& other);
+    };
+
+    // Weld bit-identical vertices, reorder triangles for post-transform cache
+    // reuse (Forsyth) and vertices into first-use order for fetch locality.
+    // Run last (after tangents/invariants): welding must see final attributes.
+    void OptimizeMesh(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, MeshOptimizationStats& stats);
+    void LogOptimizationStats(const char* loaderName, const MeshOptimizationStats& stats);
+
+    // Dry run of the compact layouts in VertexPacking.h (opt-in, mesh.packing.report):
+    // encode + decode each primitive and keep the worst-case error, so the
+    // importer can report what PackedVertex / QuantizedVertex would save.
+    struct VertexPackingStats
+    {
+        size_t vertices = 0;
+        VertexPacking::PackingError packed;
+        VertexPacking::PackingError quantized;
+
+        void Accumulate(const VertexPackingStats& other);
+    };
+
+    [[nodiscard]] bool IsVertexPackingReportEnabled();
+    void MeasureVertexPacking(const std::vector<Vertex>& vertices, const DirectX::XMFLOAT3& aabbMin, const DirectX::XMFLOAT3& aabbMax, VertexPackingStats& stats);
+    void LogVertexPackingStats(const char* loaderName, const VertexPackingStats& stats);
+
+    // Import-time instancing: meshes whose processed vertices and indices are
+    // byte-identical are stored once and share a Model (one BLAS, several
+    // game objects). HashGeometry picks candidates, GeometryEquals confirms.
+    [[nodiscard]] bool IsDeduplicationEnabled();
+    [[nodiscard]] uint64_t HashGeometry(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices);
+    [[nodiscard]] bool GeometryEquals(const std::vector<Vertex>& aVertices, const std::vector<uint32_t>& aIndices,
+                                      const std::vector<Vertex>& bVertices, const std::vector<uint32_t>& bIndices);
+
+    struct InstancingStats
+    {
+        size_t primitives = 0;       // mesh primitives placed in the scene
+        size_t models = 0;           // distinct models (BLASes) they resolve to
+        size_t foldedByPath = 0;     // geometry reused because the source file repeated
+        size_t foldedByContent = 0;  // geometry reused because the processed data matched
+        size_t bytesSaved = 0;       // vertex + index bytes not stored
+    };
+    void LogInstancingStats(const char* loaderName, const InstancingStats& stats);
+
     // Build BLAS per primitive + one TLAS over the builder's game objects.
     std::shared_ptr<AccelerationStructures> BuildAccelerationStructures(const Renderer& renderer, const SceneBuilder& scene);
 }
@@ -12,6 +12,8 @@ class IndexBuffer;
 
 struct Primitive
 {
+    static constexpr uint32_t INVALID_GEOMETRY_ID = UINT32_MAX;
+
     Primitive (const BufferView& vertexView, const BufferView& indexView, std::shared_ptr<Material> material = nullptr)
     {
         m_vertexBufferOffset = vertexView;
@@ -30,6 +32,9 @@ struct Primitive
     BufferView m_indexBufferOffset;
     BufferView m_vertexBufferOffset;
 
+    // Index into the scene's geometry-info buffer, assigned by SceneBuilder::AddModel.
+    uint32_t m_geometryId = INVALID_GEOMETRY_ID;
+
     DirectX::XMFLOAT3 m_localAabbMin{  FLT_MAX,  FLT_MAX,  FLT_MAX };
     DirectX::XMFLOAT3 m_localAabbMax{ -FLT_MAX, -FLT_MAX, -FLT_MAX };
 
@@ -13,6 +13,7 @@ class GameObject;
 class Model;
 class SceneNode;
 class SceneBuilder;
+class TransformHierarchy;
 
 struct GeometryInfo
 {
@@ -57,6 +58,10 @@ public:
     [[nodiscard]] const DirectX::XMFLOAT3& GetAabbMin() const { return m_aabbMin; }
     [[nodiscard]] const DirectX::XMFLOAT3& GetAabbMax() const { return m_aabbMax; }
 
+    // World matrices of nodes edited since the last call, in one batched pass,
+    // pushed to their game objects. A dirty-flag check when nothing moved.
+    void UpdateTransforms();
+
 private:
     friend class SceneBuilder;
     Scene() = default;
@@ -74,6 +79,9 @@ private:
     std::vector<std::shared_ptr<GameObject>> m_gameObjects;
     std::vector<std::shared_ptr<Model>> m_models;
 
+    std::shared_ptr<TransformHierarchy> m_transforms;
+    std::vector<SceneNode*> m_transformNodes; // by TransformHierarchy index
+
     std::shared_ptr<AccelerationStructures> m_rtRepresentation;
 
     DirectX::XMFLOAT3 m_aabbMin{ 0.0f, 0.0f, 0.0f };
@@ -92,20 +100,21 @@ public:
     void SetAccelerationStructures(const std::shared_ptr<AccelerationStructures>& accelerationStructures);
     void SetVertexBuffer(const std::shared_ptr<VertexBuffer>& vertexBuffer);
     void SetIndexBuffer(const std::shared_ptr<IndexBuffer>& indexBuffer);
+    // Flattens the node tree into the transform store (first call, or after
+    // AddChild), then computes the world matrices of dirty nodes in one pass
+    // and pushes them to their game objects.
     void UpdateMatrices();
 
     std::shared_ptr<SceneNode> GetRoot() const { return m_root; }
     std::vector<std::shared_ptr<GameObject>> GetGameObjects() const { return m_gameObjects; }
     std::shared_ptr<Model> GetModel(const int index) const { return m_models[index]; }
     std::vector<std::shared_ptr<Model>> GetModels() const { return m_models; }
+    const std::vector<LightData>& GetLightData() const { return m_lightData; }
     
     std::shared_ptr<Scene> Build(Renderer& renderer);
     
 private:
-    friend class SceneNode;
-
-    static void UpdateMatricesInNodesRecursively(const std::shared_ptr<SceneNode>& node);
-    std::vector<std::shared_ptr<Primitive>> GetAllPrimitives() const; 
+    void FlattenTransforms();
 
     std::shared_ptr<IndexBuffer> m_indexBuffer;
     std::shared_ptr<VertexBuffer> m_vertexBuffer;
@@ -113,8 +122,13 @@ private:
     std::string m_name;
     std::vector<std::shared_ptr<GameObject>> m_gameObjects;
     std::vector<std::shared_ptr<Model>> m_models;
+    std::vector<std::shared_ptr<Primitive>> m_primitives; // by geometry id
     std::shared_ptr<SceneNode> m_root;
 
+    std::shared_ptr<TransformHierarchy> m_transforms;
+    std::vector<SceneNode*> m_transformNodes;
+    bool m_transformsStale = true;
+
     std::shared_ptr<AccelerationStructures> m_rtRepresentation;
 
     std::vector<LightData> m_lightData;
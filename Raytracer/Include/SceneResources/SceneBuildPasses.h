@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "SceneResources/TransformHierarchy.h"
+
+// Whole-scene passes of SceneBuilder::Build over plain arrays. Instances are
+// laid out object by object, in TLAS order: object i owns the instance range
+// [offsets[i], offsets[i + 1]).
+namespace SceneBuildPasses
+{
+    using Matrix = TransformHierarchy::Matrix;
+
+    struct Bounds
+    {
+        float min[3] = { std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max() };
+        float max[3] = { -std::numeric_limits<float>::max(), -std::numeric_limits<float>::max(), -std::numeric_limits<float>::max() };
+
+        [[nodiscard]] bool IsEmpty() const { return min[0] > max[0]; }
+    };
+
+    // Exclusive prefix sum of the per-object instance counts with the total
+    // appended (counts.size() + 1 entries).
+    std::vector<size_t> InstanceOffsets(const std::vector<uint32_t>& counts);
+
+    // Union of every non-empty local box placed by its object's world matrix
+    // (row vectors: world = local * worlds[i]). Each box is transformed as
+    // centre plus |M| * extent, which is exactly the box around its eight
+    // transformed corners. Parallel over objects; empty if every box is.
+    [[nodiscard]] Bounds ComputeWorldBounds(const std::vector<Matrix>& worlds, const std::vector<size_t>& offsets, const std::vector<Bounds>& localBounds);
+}
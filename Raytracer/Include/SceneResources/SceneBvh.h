@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "SceneResources/Bvh.h"
+
+// One geometry of the scene's global index buffer: GeometryInfo plus the
+// index count Primitive::GetIndexView() carries. Indices are relative to
+// vertexOffset, as in the shaders.
+struct BvhGeometry
+{
+    uint32_t vertexOffset = 0;
+    uint32_t indexOffset = 0;
+    uint32_t indexCount = 0;
+};
+
+// A placed geometry; objectToWorld has InstanceInfo's DXR ObjectToWorld3x4
+// layout (world = objectToWorld * float4(position, 1)). Hits on non-opaque
+// instances go through the SceneBvh hit filter, as D3D12 geometry without
+// the OPAQUE flag runs its any-hit shader.
+struct BvhInstance
+{
+    uint32_t geometry = 0;
+    bool opaque = true;
+    float objectToWorld[3][4] = { { 1.0f, 0.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 1.0f, 0.0f } };
+};
+
+struct SceneBvhInput
+{
+    // Scene vertex positions, `positionStride` bytes apart (sizeof(Vertex)
+    // with the position first, as in the scene vertex buffer).
+    const float* positions = nullptr;
+    size_t positionStride = 3 * sizeof(float);
+    const uint32_t* indices = nullptr;
+    const BvhGeometry* geometries = nullptr;
+    size_t geometryCount = 0;
+    const BvhInstance* instances = nullptr;
+    size_t instanceCount = 0;
+};
+
+// Two-level CPU BVH mirroring the scene's BLAS/TLAS split: a TriangleBvh per
+// geometry, and an instance BVH over their world bounds. Hits report the
+// instance and the triangle within its geometry, like InstanceIndex() and
+// PrimitiveIndex() in DXR. Moving objects only needs SetInstances, which
+// rebuilds the small instance level. Queries are const and thread-safe.
+class SceneBvh
+{
+public:
+    struct Stats
+    {
+        size_t geometryCount = 0;
+        size_t instanceCount = 0;
+        size_t triangleCount = 0;       // over geometries
+        size_t instancedTriangles = 0;  // over instances
+        size_t geometryNodes = 0;
+        size_t instanceNodes = 0;
+        double geometryMilliseconds = 0.0;
+        double instanceMilliseconds = 0.0;
+    };
+
+    // Candidate filter for non-opaque instances; `instance` indexes the
+    // caller's instance array. Returning false discards the candidate.
+    using HitFilter = bool (*)(const void* context, uint32_t instance, uint32_t primitive, float u, float v);
+
+    void Build(const SceneBvhInput& input, const BvhBuildSettings& settings = {});
+    // Replaces the instances, keeping the geometry level.
+    void SetInstances(const BvhInstance* instances, size_t count);
+    void SetHitFilter(HitFilter filter, const void* context);
+
+    // Closest hit in (ray.tMin, ray.tMax), in world space.
+    bool Intersect(const BvhRay& ray, BvhHit& hit) const;
+    [[nodiscard]] bool Occluded(const BvhRay& ray) const;
+    // Intersect over a batch of rays on the ThreadPool.
+    void IntersectBatch(const BvhRay* rays, BvhHit* hits, size_t count) const;
+
+    [[nodiscard]] BvhAabb GetBounds() const;
+    [[nodiscard]] const TriangleBvh& GetGeometry(uint32_t geometry) const { return m_geometries[geometry]; }
+    [[nodiscard]] const Stats& GetStats() const { return m_stats; }
+
+private:
+    struct Instance
+    {
+        uint32_t geometry;
+        uint32_t index; // in the caller's instance array
+        bool opaque;
+        float worldToObject[3][4];
+    };
+
+    template <bool AnyHit>
+    bool Traverse(const BvhRay& ray, BvhHit& hit) const;
+
+    std::vector<TriangleBvh> m_geometries;
+    std::vector<Instance> m_instances; // leaf order; singular transforms dropped
+    std::vector<BvhNode> m_instanceNodes;
+    BvhBuildSettings m_settings;
+    HitFilter m_hitFilter = nullptr;
+    const void* m_hitFilterContext = nullptr;
+    Stats m_stats;
+};
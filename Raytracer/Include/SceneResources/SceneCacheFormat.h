@@ -0,0 +1,226 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "Utils/MappedFile.h"
+
+// Baked scene cache (.bsc): what SceneBuilder ends up with after an import —
+// final vertex/index arrays, primitive views + local AABBs, materials, the node
+// hierarchy, lights and decoded RGBA8 texture payloads — in one versioned,
+// memory-mappable file of plain records; SceneCaching bridges it to the engine.
+//
+// Layout: FileHeader, SectionEntry[sectionCount], then 16-byte aligned
+// section payloads. Every offset is from the start of the file.
+namespace SceneCacheFormat
+{
+    constexpr uint32_t MAGIC = 0x43534242; // "BBSC"
+    // Bump on any record or section change; older files are then rebuilt.
+    // Changes to what the importers put into the records are tracked by the
+    // header's pipelineVersion instead.
+    constexpr uint32_t VERSION = 3;
+    constexpr size_t SECTION_ALIGNMENT = 16;
+
+    enum class SectionId : uint32_t
+    {
+        Vertices = 1,
+        Indices,
+        Primitives,
+        Models,
+        Materials,
+        Nodes,
+        Lights,
+        Textures,
+        TexelData,
+        Dependencies,
+        Strings,
+    };
+
+    struct FileHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t sourceHash;   // content hash of the scene file this was baked from
+        uint32_t vertexStride; // sizeof(Vertex) at bake time
+        uint32_t sectionCount;
+        uint32_t nameOffset;   // into Strings
+        uint32_t nameLength;
+        uint32_t pipelineVersion; // importer output revision at bake time
+        uint32_t importFlags;     // importer settings at bake time
+    };
+
+    struct SectionEntry
+    {
+        uint32_t id;
+        uint32_t elementSize;
+        uint64_t offset;
+        uint64_t size;
+    };
+
+    struct PrimitiveRecord
+    {
+        uint64_t vertexOffset; // elements into Vertices
+        uint64_t vertexCount;
+        uint64_t indexOffset;  // elements into Indices
+        uint64_t indexCount;
+        float aabbMin[3];
+        float aabbMax[3];
+        int32_t materialIndex; // into Materials
+        uint32_t reserved;
+    };
+
+    struct ModelRecord
+    {
+        uint32_t firstPrimitive;
+        uint32_t primitiveCount;
+    };
+
+    struct MaterialRecord
+    {
+        float baseColorFactor[4];
+        float metallicFactor;
+        float roughnessFactor;
+        int32_t albedoTexture;            // into Textures, -1 = none
+        int32_t normalTexture;
+        int32_t metallicRoughnessTexture;
+        uint32_t isOpaque;
+    };
+
+    // Pre-order: a parent always precedes its children. Node 0 is the root.
+    struct NodeRecord
+    {
+        int32_t parent;     // -1 for the root
+        int32_t modelIndex; // game object's model, -1 = no game object
+        float position[3];
+        float rotation[4];  // quaternion xyzw
+        float scale[3];
+    };
+
+    struct LightRecord
+    {
+        uint32_t type;
+        float position[3];
+        float direction[3];
+        float color[3];
+        float intensity;
+        float range;
+    };
+
+    struct TextureRecord
+    {
+        uint32_t width;
+        uint32_t height;
+        uint64_t texelOffset; // bytes into TexelData, RGBA8 rows, no padding
+    };
+
+    // Every source file besides the keyed scene file, with its content hash.
+    struct DependencyRecord
+    {
+        uint64_t contentHash;
+        uint32_t pathOffset; // into Strings, UTF-8
+        uint32_t pathLength;
+    };
+
+    template <typename T>
+    struct ArrayView
+    {
+        const T* data = nullptr;
+        size_t count = 0;
+
+        [[nodiscard]] const T* begin() const { return data; }
+        [[nodiscard]] const T* end() const { return data + count; }
+        [[nodiscard]] size_t size() const { return count; }
+        [[nodiscard]] bool empty() const { return count == 0; }
+        const T& operator[](size_t i) const { return data[i]; }
+    };
+
+    // Everything a bake writes. Vertex data is opaque bytes of vertexStride each.
+    struct BakeInput
+    {
+        uint64_t sourceHash = 0;
+        uint32_t pipelineVersion = 0;
+        uint32_t importFlags = 0;
+        std::string name;
+        uint32_t vertexStride = 0;
+        const void* vertices = nullptr;
+        size_t vertexCount = 0;
+        const uint32_t* indices = nullptr;
+        size_t indexCount = 0;
+
+        std::vector<PrimitiveRecord> primitives;
+        std::vector<ModelRecord> models;
+        std::vector<MaterialRecord> materials;
+        std::vector<NodeRecord> nodes;
+        std::vector<LightRecord> lights;
+
+        struct Texture
+        {
+            uint32_t width = 0;
+            uint32_t height = 0;
+            std::vector<uint8_t> rgba; // width * height * 4
+        };
+        std::vector<Texture> textures;
+
+        struct Dependency
+        {
+            std::string path;
+            uint64_t contentHash = 0;
+        };
+        std::vector<Dependency> dependencies;
+    };
+
+    // Writes to a temporary file and renames it into place, so a reader never
+    // observes a half-written cache.
+    bool Write(const std::filesystem::path& path, const BakeInput& input);
+
+    // Maps a cache file and validates header, version, vertex stride, section
+    // bounds and cross references. Accessors point straight into the mapping.
+    class Reader
+    {
+    public:
+        bool Open(const std::filesystem::path& path, uint32_t expectedVertexStride);
+        void Close();
+
+        [[nodiscard]] uint64_t GetSourceHash() const { return m_header.sourceHash; }
+        [[nodiscard]] uint32_t GetPipelineVersion() const { return m_header.pipelineVersion; }
+        [[nodiscard]] uint32_t GetImportFlags() const { return m_header.importFlags; }
+        [[nodiscard]] std::string GetName() const;
+
+        [[nodiscard]] uint32_t GetVertexStride() const { return m_header.vertexStride; }
+        [[nodiscard]] const void* GetVertexData() const { return m_vertices.data; }
+        [[nodiscard]] size_t GetVertexCount() const { return m_header.vertexStride ? m_vertices.count / m_header.vertexStride : 0; }
+        [[nodiscard]] ArrayView<uint32_t> GetIndices() const { return m_indices; }
+        [[nodiscard]] ArrayView<PrimitiveRecord> GetPrimitives() const { return m_primitives; }
+        [[nodiscard]] ArrayView<ModelRecord> GetModels() const { return m_models; }
+        [[nodiscard]] ArrayView<MaterialRecord> GetMaterials() const { return m_materials; }
+        [[nodiscard]] ArrayView<NodeRecord> GetNodes() const { return m_nodes; }
+        [[nodiscard]] ArrayView<LightRecord> GetLights() const { return m_lights; }
+        [[nodiscard]] ArrayView<TextureRecord> GetTextures() const { return m_textures; }
+        [[nodiscard]] const uint8_t* GetTexels(const TextureRecord& texture) const { return m_texelData.data + texture.texelOffset; }
+        [[nodiscard]] ArrayView<DependencyRecord> GetDependencies() const { return m_dependencies; }
+        [[nodiscard]] std::string GetDependencyPath(const DependencyRecord& dependency) const;
+
+        [[nodiscard]] size_t GetFileSize() const { return m_file.Size(); }
+
+    private:
+        bool Validate(uint32_t expectedVertexStride);
+
+        MappedFile m_file;
+        FileHeader m_header{};
+
+        ArrayView<uint8_t> m_vertices;
+        ArrayView<uint32_t> m_indices;
+        ArrayView<PrimitiveRecord> m_primitives;
+        ArrayView<ModelRecord> m_models;
+        ArrayView<MaterialRecord> m_materials;
+        ArrayView<NodeRecord> m_nodes;
+        ArrayView<LightRecord> m_lights;
+        ArrayView<TextureRecord> m_textures;
+        ArrayView<uint8_t> m_texelData;
+        ArrayView<DependencyRecord> m_dependencies;
+        ArrayView<char> m_strings;
+    };
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <vector>
+
+#include "SceneResources/SceneBvh.h"
+#include "SceneResources/SceneCacheFormat.h"
+
+// The placed geometry of a baked scene cache, laid out as Scene::Build lays
+// out the GPU scene: a geometry per primitive record, an instance per (node,
+// model primitive) in node order with the node's world transform, and the
+// world bounds ComputeWorldAabb takes from the primitives' local boxes. Shared
+// by the CPU tools that work from a cache instead of a loaded Scene.
+struct SceneCacheGeometry
+{
+    std::vector<BvhGeometry> geometries; // indexed like GetPrimitives()
+    std::vector<BvhInstance> instances;  // `geometry` is the primitive record
+    BvhAabb bounds;
+
+    void Load(const SceneCacheFormat::Reader& cache);
+
+    // Positions straight from the cache's vertex data; valid while both live.
+    [[nodiscard]] SceneBvhInput MakeInput(const SceneCacheFormat::Reader& cache) const;
+};
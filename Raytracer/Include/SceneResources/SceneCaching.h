@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "SceneResources/SceneCacheFormat.h"
+
+class AssetId;
+class Renderer;
+class Scene;
+class SceneBuilder;
+class Texture;
+struct Vertex;
+
+// Engine side of the baked scene cache (SceneCacheFormat). ModelLoading keys a
+// cache file by the scene file's content hash. On a miss the importer records
+// the other files it read and its decoded textures into a Recorder, which bakes
+// the finished SceneBuilder before Build. On a hit the Scene is rebuilt from
+// the mapped file: no parsing, tangent generation or image decoding.
+namespace SceneCaching
+{
+    // Revision of what the importers bake for a given input. Bump whenever
+    // mesh processing (welding, reordering, tangents, instancing) or texture
+    // decoding changes its output; caches from another revision are rebuilt.
+    constexpr uint32_t IMPORT_PIPELINE_VERSION = 2;
+
+    // Importer settings that change what gets baked; caches baked under other
+    // settings are rebuilt. Welding and reordering always run (covered by the
+    // pipeline version) and vertex packing only reports, so neither has a flag.
+    enum ImportFlags : uint32_t
+    {
+        IMPORT_DEDUPLICATE = 1u << 0, // mesh.dedup.enabled
+    };
+    [[nodiscard]] uint32_t GetImportFlags();
+
+    [[nodiscard]] bool IsEnabled();
+
+    // SavedUserData/SceneCache/<stem>-<hash>.bsc
+    [[nodiscard]] std::filesystem::path GetCachePath(const AssetId& assetId, uint64_t sourceHash);
+
+    // Scene from a valid cache whose dependencies are unchanged, else nullptr.
+    std::shared_ptr<Scene> TryLoad(Renderer& renderer, const AssetId& assetId, uint64_t sourceHash);
+
+    class Recorder
+    {
+    public:
+        Recorder(const AssetId& assetId, uint64_t sourceHash);
+
+        // Any file besides the scene file that the import read. Hashed at bake time.
+        void AddDependency(const std::filesystem::path& path);
+        // The pixels handed to Renderer::CreateTexture (8-bit, 3 or 4 components).
+        void AddTexture(const std::shared_ptr<Texture>& texture, const uint8_t* pixels, int width, int height, int components);
+
+        // Bakes models, nodes and lights as they are now: call after UpdateMatrices,
+        // before Build. Failures only log; the import itself is unaffected.
+        void Write(const SceneBuilder& sceneBuilder, const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices);
+
+    private:
+        std::filesystem::path m_cachePath;
+        std::filesystem::path m_sourceDir;
+        std::string m_name;
+        uint64_t m_sourceHash;
+        uint32_t m_importFlags;
+
+        std::vector<std::filesystem::path> m_dependencies;
+        std::vector<SceneCacheFormat::BakeInput::Texture> m_textures;
+        std::unordered_map<const Texture*, int32_t> m_textureIndices;
+    };
+}
@@ -1,5 +1,6 @@
 ﻿#pragma once
 #include "Transform.h"
+#include "SceneResources/TransformHierarchy.h"
 
 class GameObject;
 class Model;
@@ -17,7 +18,9 @@ public:
     void AddChild(const std::shared_ptr<SceneNode>& child);
     void AddGameObject(const std::shared_ptr<GameObject> & gameObject);
     
-    // Not sure if I should leave these as const references? TODO: Check
+    // Setters only record the local transform (and mark the node dirty once the
+    // builder has flattened the tree); world matrices are computed in batches
+    // by SceneBuilder::UpdateMatrices and Scene::UpdateTransforms.
     void SetPosition(const DirectX::SimpleMath::Vector3& position);
     void SetRotation(const DirectX::SimpleMath::Quaternion& rotation);
     void SetRotation(const DirectX::SimpleMath::Vector3& rotation);
@@ -28,11 +31,12 @@ public:
 private:
     friend class SceneBuilder;
 
-    void UpdateModelConstantBuffer() const;
-    DirectX::SimpleMath::Matrix TraverseParentMatrices() const;
-    
     std::shared_ptr<SceneNode> m_parent;
     std::vector<std::shared_ptr<SceneNode>> m_children;
     std::shared_ptr<GameObject> m_gameObject;
     Transform m_transform;
+
+    // Slot in the owning builder's/scene's flat store; null until flattened.
+    TransformHierarchy* m_hierarchy = nullptr;
+    uint32_t m_transformIndex = 0;
 };
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// CPU SLIC over a ShadingPoints G-buffer, step for step as superpixelBuild.hlsl:
+// InitSeedCenters, N x [FindCenterAssociation -> SumCenter], then the final
+// association with the fuzzy four-nearest blend and the gather lists. Adds the
+// textbook SLIC centre update (the mean of a centre's members rather than of
+// its tile) and quality metrics, so superpixel size, weight and iteration
+// count can be tuned offline on a dumped frame. The passes run on the
+// ThreadPool and do not depend on the thread count.
+
+// ShadingPoints as a readback of it holds the texels: RGBA32F rows, xyz = the
+// primary hit's world position (x >= 1e29 without a hit), w = the bits of its
+// UNORM16x2 octahedral normal.
+struct SuperpixelInput
+{
+    const float* texels = nullptr;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    size_t rowPitch = 0; // bytes; 0 = width * 16
+};
+
+enum class SuperpixelCenterUpdate
+{
+    // SumCenter (ADR-0002): the mean of the tile's valid pixels. It does not
+    // read the association, so every iteration gives the centres of the first.
+    Tile,
+    // SLIC: the mean of the pixels associated with the centre, its screen
+    // position included.
+    Members,
+};
+
+struct SuperpixelSettings
+{
+    uint32_t size = 32;            // SUPERPIXEL_SIZE
+    uint32_t iterations = 1;       // SUPERPIXEL_ITERATIONS
+    float weight = 0.6f;           // superpixel.weight
+    float posNormalizer = 8.3329f; // superpixel.posNormalizer
+    SuperpixelCenterUpdate update = SuperpixelCenterUpdate::Tile;
+};
+
+struct SuperpixelStats
+{
+    uint32_t invalidPixels = 0;  // no primary hit
+    uint32_t fallbackPixels = 0; // every candidate failed the normal gate
+    uint32_t overflowPixels = 0; // past a superpixel's size^2 gather slots
+    double seedMilliseconds = 0.0;
+    double associateMilliseconds = 0.0; // every association pass
+    double updateMilliseconds = 0.0;    // every centre update
+    double gatherMilliseconds = 0.0;
+};
+
+// The pass's UAVs, CPU side. Superpixel ids are flat: y * mapX + x.
+struct Superpixels
+{
+    uint32_t mapX = 0;
+    uint32_t mapY = 0;
+    uint32_t size = 0;
+    std::vector<float> centers;        // u_center: mapX * mapY RGBA (position, normal bits)
+    std::vector<float> centerPixels;   // the xy each centre is associated at: tile middles, or member means
+    std::vector<int32_t> index;        // u_index: per pixel, -1 without a hit
+    std::vector<float> fuzzyWeights;   // u_fuzzy_weight: 4 per pixel, 0 = unused slot
+    std::vector<int32_t> fuzzyIndices; // u_fuzzy_index: 4 per pixel, -1 = unused slot
+    std::vector<uint32_t> counters;    // u_spixel_counter: members per superpixel, uncapped
+    // u_spixel_gathered: (mapX * size) x (mapY * size) int2. A superpixel's
+    // tile holds its first size^2 members in scan order (the GPU's order is
+    // arbitrary); unused slots are -1.
+    std::vector<int32_t> gathered;
+    SuperpixelStats stats;
+};
+
+struct SuperpixelQualitySettings
+{
+    uint32_t tolerance = 2;   // pixels (Chebyshev) between an edge and a boundary
+    float normalCos = 0.9f;   // neighbours with less normal agreement form an edge
+    float depthRatio = 3.0f;  // a step this many times its neighbours' forms an edge
+};
+
+struct SuperpixelQuality
+{
+    // Fraction of G-buffer edges (normal creases and position steps between
+    // pixels with a hit) with a superpixel boundary within tolerance.
+    double boundaryRecall = 0.0;
+    // Area-weighted isoperimetric quotient 4 pi A / P^2 (Schick et al. 2012):
+    // 1 for discs, 0.785 for the untouched square tiles.
+    double compactness = 0.0;
+    uint32_t edgePixels = 0;
+    uint32_t segments = 0; // superpixels with members
+};
+
+struct SuperpixelMeasurement
+{
+    uint32_t iterations = 0;
+    double milliseconds = 0.0; // Build
+    uint32_t fallbackPixels = 0;
+    SuperpixelQuality quality;
+};
+
+namespace SuperpixelClustering
+{
+    [[nodiscard]] Superpixels Build(const SuperpixelInput& input, const SuperpixelSettings& settings);
+
+    [[nodiscard]] SuperpixelQuality MeasureQuality(const SuperpixelInput& input, const Superpixels& superpixels,
+        const SuperpixelQualitySettings& settings = {});
+
+    // Build and MeasureQuality at 0..maxIterations iterations, everything else
+    // from settings.
+    [[nodiscard]] std::vector<SuperpixelMeasurement> MeasureIterations(const SuperpixelInput& input, const SuperpixelSettings& settings,
+        uint32_t maxIterations, const SuperpixelQualitySettings& qualitySettings = {});
+}
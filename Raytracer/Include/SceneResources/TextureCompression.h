@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "SceneResources/TextureProcessing.h"
+
+// Engine side of TextureProcessing: imported textures become mipmapped BCn
+// DDS files cached under SavedUserData/TextureCache, keyed by the texels'
+// content hash, usage and filter, so only the first load pays for encoding.
+namespace TextureCompression
+{
+    [[nodiscard]] bool IsEnabled();
+
+    // DDS bytes for tightly packed RGBA8 texels, from the cache or freshly
+    // encoded (and then cached). Empty on failure; the caller uploads the
+    // texels uncompressed instead.
+    std::vector<uint8_t> GetOrEncodeDds(const uint8_t* rgba, int width, int height, TextureProcessing::TextureUsage usage);
+}
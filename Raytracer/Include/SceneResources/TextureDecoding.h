@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+// CPU half of texture import: file/memory bytes to tightly packed RGBA8, the
+// only layout Renderer::CreateTexture uploads. Reentrant (stb keeps its error
+// state per thread), so loaders decode every image of a scene on the
+// ThreadPool and upload afterwards in one batch.
+namespace TextureDecoding
+{
+    struct Image
+    {
+        int width = 0;
+        int height = 0;
+        std::vector<uint8_t> rgba; // width * height * 4 bytes
+
+        [[nodiscard]] bool IsValid() const { return width > 0 && height > 0 && !rgba.empty(); }
+    };
+
+    // Any format stb_image reads (PNG, JPEG, TGA, BMP, HDR, ...); 16-bit and
+    // float sources are reduced to 8 bits. On failure `out` is left empty and
+    // `error` (if given) receives stb's reason.
+    bool DecodeMemory(const uint8_t* bytes, size_t size, Image& out, const char** error = nullptr);
+    bool DecodeFile(const std::filesystem::path& path, Image& out, const char** error = nullptr);
+
+    // 1 (grey), 2 (grey + alpha), 3 (RGB) or 4 (RGBA) 8-bit components per
+    // pixel to RGBA8. False for any other component count.
+    bool ExpandToRgba8(const uint8_t* pixels, int width, int height, int components, std::vector<uint8_t>& out);
+}
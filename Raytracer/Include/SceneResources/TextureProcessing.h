@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Offline texture preparation: mip chains filtered in the right space for the
+// texture's use, BCn encoding (BlockCompression) and a DDS container the
+// engine's DDS loader reads. Filtering and encoding split rows across the
+// ThreadPool.
+namespace TextureProcessing
+{
+    // What the shader does with the texels; picks the filter space and format.
+    enum class TextureUsage : uint32_t
+    {
+        Generic,           // RGBA, filtered as stored
+        Albedo,            // sRGB-encoded RGB + linear alpha
+        Normal,            // tangent-space XY(Z) in [-1, 1]; Z is rebuilt in the shader
+        MetallicRoughness, // glTF: G = roughness, B = metallic, no alpha
+        Mask,              // single channel in R
+    };
+
+    enum class MipFilter : uint32_t
+    {
+        Box,    // average of the covered texels
+        Kaiser, // Kaiser-windowed sinc (alpha 4, radius 2 destination texels)
+    };
+
+    // Values are the matching DXGI_FORMAT enumerants (UNORM, like the RGBA8
+    // upload path: albedo is still decoded from sRGB by the shaders).
+    enum class TextureFormat : uint32_t
+    {
+        RGBA8 = 28,
+        BC1 = 71,
+        BC4 = 80,
+        BC5 = 83,
+        BC7 = 98,
+    };
+
+    struct Surface
+    {
+        int width = 0;
+        int height = 0;
+        std::vector<uint8_t> data; // RGBA8 texels or BCn blocks
+    };
+
+    struct EncodedTexture
+    {
+        TextureFormat format = TextureFormat::RGBA8;
+        TextureUsage usage = TextureUsage::Generic; // what Encode was given; a DDS does not record it
+        std::vector<Surface> mips; // level 0 first
+
+        [[nodiscard]] bool IsValid() const { return !mips.empty(); }
+    };
+
+    // Albedo/Generic -> BC7, Normal -> BC5, MetallicRoughness -> BC5,
+    // Mask -> BC4. RGBA8 when the top level is not a multiple of 4 texels
+    // (D3D12 rejects such block-compressed resources).
+    [[nodiscard]] TextureFormat ChooseFormat(TextureUsage usage, int width, int height);
+
+    // True when `format` holds a MetallicRoughness map's roughness (glTF G)
+    // and metallic (glTF B) in R and G, each with its own BC4 endpoints. The
+    // texture's SRV swizzles them back to G and B, so shaders read the glTF
+    // layout whatever the format.
+    [[nodiscard]] bool StoresMetallicRoughnessInRG(TextureUsage usage, TextureFormat format);
+
+    // Levels down to 1x1, inclusive.
+    [[nodiscard]] int MipCount(int width, int height);
+
+    // Full RGBA8 chain, level 0 being a copy of `rgba`. Each level is filtered
+    // from the previous one kept in float (wrap addressing): albedo in linear
+    // light, normals renormalized after filtering.
+    std::vector<Surface> GenerateMips(const uint8_t* rgba, int width, int height, TextureUsage usage, MipFilter filter);
+
+    // One RGBA8 level in `format`, channels moved as StoresMetallicRoughnessInRG says.
+    Surface EncodeLevel(const Surface& level, TextureFormat format, TextureUsage usage);
+
+    // GenerateMips followed by the ChooseFormat encoder on every level.
+    EncodedTexture Encode(const uint8_t* rgba, int width, int height, TextureUsage usage, MipFilter filter);
+
+    // One level back to RGBA8, as shaders sample it through the texture's SRV.
+    void DecodeLevel(const EncodedTexture& texture, size_t level, std::vector<uint8_t>& rgba);
+
+    // Channels the encoder for `usage` preserves (bit c = channel c), for PSNR;
+    // MetallicRoughness drops glTF's unused R.
+    [[nodiscard]] uint32_t SignificantChannels(TextureUsage usage);
+
+    // PSNR in dB over the channels in `channelMask`; +infinity for identical input.
+    [[nodiscard]] double ComputePsnr(const uint8_t* a, const uint8_t* b, size_t texelCount, uint32_t channelMask);
+
+    // DDS with a DX10 header; ReadDds accepts exactly what WriteDds emits
+    // (2D, one array slice, a format above) and rejects truncated files.
+    std::vector<uint8_t> WriteDds(const EncodedTexture& texture);
+    bool ReadDds(const uint8_t* data, size_t size, EncodedTexture& out);
+}
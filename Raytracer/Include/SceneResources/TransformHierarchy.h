@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Flat transform store behind SceneNode. Local TRS lives in SoA arrays and
+// nodes are kept in topological order (a parent's index is below its
+// children's), so world matrices are one forward pass instead of a walk to the
+// root per node. Setters only set a dirty bit; Update recomputes the dirty
+// nodes and their descendants in one batch.
+//
+// Matrices are row-major with row vectors, like DirectXMath: local = S * R * T
+// (XMMatrixAffineTransformation with a zero rotation origin), world = local *
+// parentWorld.
+class TransformHierarchy
+{
+public:
+    static constexpr uint32_t NO_PARENT = UINT32_MAX;
+
+    struct Matrix
+    {
+        float m[4][4];
+    };
+
+    void Clear();
+    void Reserve(size_t count);
+
+    // `parent` must be NO_PARENT or an index returned earlier. The node starts dirty.
+    uint32_t Add(uint32_t parent, const float position[3], const float rotation[4], const float scale[3]);
+
+    void SetPosition(uint32_t node, const float position[3]);
+    void SetRotation(uint32_t node, const float rotation[4]); // quaternion xyzw
+    void SetScale(uint32_t node, const float scale[3]);
+
+    // Recomputes the world matrix of every dirty node and of its descendants,
+    // then clears the dirty bits. Appends the recomputed indices (ascending)
+    // to `changed` if given. Returns how many were recomputed.
+    size_t Update(std::vector<uint32_t>* changed = nullptr);
+
+    [[nodiscard]] size_t Size() const { return m_parent.size(); }
+    [[nodiscard]] uint32_t GetParent(uint32_t node) const { return m_parent[node]; }
+    [[nodiscard]] bool IsDirty(uint32_t node) const { return m_dirty[node] != 0; }
+    [[nodiscard]] const Matrix& GetWorld(uint32_t node) const { return m_world[node]; }
+
+private:
+    void MarkDirty(uint32_t node);
+    void ComputeLocals(const uint32_t* nodes, size_t count);
+
+    std::vector<uint32_t> m_parent;
+    std::vector<float> m_positionX, m_positionY, m_positionZ;
+    std::vector<float> m_rotationX, m_rotationY, m_rotationZ, m_rotationW;
+    std::vector<float> m_scaleX, m_scaleY, m_scaleZ;
+    std::vector<uint8_t> m_dirty;
+    bool m_anyDirty = false;
+
+    std::vector<Matrix> m_local;
+    std::vector<Matrix> m_world;
+    std::vector<uint32_t> m_scratch; // dirty list of the current Update
+};
@@ -5,6 +5,7 @@
 class Scene;
 class AssetId;
 class Renderer;
+namespace SceneCaching { class Recorder; }
 
 // Tungsten scene-format importer (ADR 0006). A second front-end to the engine's
 // Scene, parallel to glTF: parses a Tungsten `.json`, loads its `.wo3`/`.obj`
@@ -13,5 +14,7 @@ class Renderer;
 // (Tungsten emitters/env are not imported in v1).
 namespace TungstenLoading
 {
-    std::shared_ptr<Scene> LoadScene(Renderer& renderer, const AssetId& assetId);
+    // cacheRecorder (optional) receives the mesh/texture files read and the
+    // decoded textures, and bakes the scene cache before Build.
+    std::shared_ptr<Scene> LoadScene(Renderer& renderer, const AssetId& assetId, SceneCaching::Recorder* cacheRecorder = nullptr);
 }
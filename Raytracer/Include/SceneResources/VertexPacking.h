@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Compact vertex layouts and their CPU encoder/decoder. Normals and tangents
+// use the octahedral scheme of Octahedral.hlsl (same truncating UNORM lanes),
+// so a shader-side decode matches the CPU one bit for bit.
+namespace VertexPacking
+{
+    // Field-for-field mirror of Vertex (InputElements.h) without DirectXMath,
+    // so the codec builds anywhere. The engine static_asserts the layouts match.
+    struct FloatVertex
+    {
+        float position[3];
+        float normal[3];
+        float tangent[4]; // xyz direction, w = bitangent sign (+/-1)
+        float uv[2];
+    };
+    static_assert(sizeof(FloatVertex) == 48, "FloatVertex must mirror the 48-byte Vertex");
+
+    // 24 B: full-precision position.
+    struct PackedVertex
+    {
+        float position[3];
+        uint32_t normal;  // UNORM16x2 octahedral
+        uint32_t tangent; // x: UNORM15 in bits 0-14, bitangent sign in bit 15, y: UNORM16 in bits 16-31
+        uint16_t uv[2];   // IEEE 754 binary16
+    };
+    static_assert(sizeof(PackedVertex) == 24, "PackedVertex must be 24 bytes");
+
+    // 20 B: position as UNORM16 within the primitive's local AABB.
+    struct QuantizedVertex
+    {
+        uint16_t position[3];
+        uint16_t reserved;
+        uint32_t normal;
+        uint32_t tangent;
+        uint16_t uv[2];
+    };
+    static_assert(sizeof(QuantizedVertex) == 20, "QuantizedVertex must be 20 bytes");
+
+    // Octahedral.hlsl UnitVectorToUnorm32Octahedron / Unorm32OctahedronToUnitVector.
+    [[nodiscard]] uint32_t EncodeOctahedron(const float n[3]);
+    void DecodeOctahedron(uint32_t packed, float outN[3]);
+
+    // Octahedral tangent with the bitangent sign folded into bit 15.
+    [[nodiscard]] uint32_t EncodeTangent(const float t[3], float sign);
+    void DecodeTangent(uint32_t packed, float outT[4]);
+
+    // Round-to-nearest-even; overflow saturates to infinity, NaN stays NaN.
+    [[nodiscard]] uint16_t FloatToHalf(float value);
+    [[nodiscard]] float HalfToFloat(uint16_t value);
+
+    void Pack(const FloatVertex* src, size_t count, PackedVertex* dst);
+    void Unpack(const PackedVertex* src, size_t count, FloatVertex* dst);
+
+    // aabbMin/aabbMax must bound every position in src.
+    void PackQuantized(const FloatVertex* src, size_t count, const float aabbMin[3], const float aabbMax[3], QuantizedVertex* dst);
+    void UnpackQuantized(const QuantizedVertex* src, size_t count, const float aabbMin[3], const float aabbMax[3], FloatVertex* dst);
+
+    // Worst case over a decoded copy. Position error is in object units, angles
+    // in radians, UV error in UV units. Tangent sign flips are counted.
+    struct PackingError
+    {
+        float position = 0.0f;
+        float normalAngle = 0.0f;
+        float tangentAngle = 0.0f;
+        float uv = 0.0f;
+        size_t tangentSignFlips = 0;
+
+        void Merge(const PackingError& other);
+    };
+    [[nodiscard]] PackingError MeasureError(const FloatVertex* original, const FloatVertex* decoded, size_t count);
+}
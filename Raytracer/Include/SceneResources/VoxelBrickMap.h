@@ -0,0 +1,154 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "SceneResources/Voxelizer.h"
+
+// Sparse storage for the voxel grid. The grid is cut into 8^3 bricks; only
+// bricks holding an occupied voxel get a slot in the brick pool, reached
+// through an indirection table with one entry per brick. Above the bricks an
+// occupancy pyramid (each level halves the brick grid; a node is set when any
+// child is) lets traversals skip empty space at every scale. The pool keeps
+// the per-voxel channels of the dense resources VoxelizationPass allocates:
+// baked bounds, packed irradiance and VPL count.
+class VoxelBrickMap
+{
+public:
+    static constexpr uint32_t BRICK_DIM = 8;
+    static constexpr uint32_t BRICK_VOXELS = BRICK_DIM * BRICK_DIM * BRICK_DIM;
+    static constexpr uint32_t EMPTY_BRICK = UINT32_MAX;
+
+    enum Channel : uint32_t
+    {
+        BoundMinX,
+        BoundMinY,
+        BoundMinZ,
+        BoundMaxX,
+        BoundMaxY,
+        BoundMaxZ,
+        Irradiance,
+        VplCount,
+        ChannelCount,
+    };
+
+    struct MemoryStats
+    {
+        size_t brickCount = 0;      // bricks in the grid
+        size_t allocatedBricks = 0; // bricks in the pool
+        size_t occupiedVoxels = 0;
+        size_t indirectionBytes = 0;
+        size_t hierarchyBytes = 0;
+        size_t poolBytes = 0;
+        // The dense resources at the same gridDim: occupancy, both 4-uint
+        // bound buffers, irradiance and VPL count.
+        size_t denseBytes = 0;
+        double milliseconds = 0.0; // build time
+
+        [[nodiscard]] size_t TotalBytes() const { return indirectionBytes + hierarchyBytes + poolBytes; }
+    };
+
+    // Occupancy and bounds from the bake; irradiance and VPL count start at 0.
+    // A gridDim that is not a multiple of BRICK_DIM is padded to whole bricks
+    // whose voxels past the grid stay empty. False (and an empty map) for an
+    // empty or inconsistent bake.
+    bool Build(const VoxelBake& bake);
+
+    [[nodiscard]] uint32_t GetGridDim() const { return m_gridDim; }
+    [[nodiscard]] uint32_t GetBricksPerAxis() const { return m_bricksPerAxis; }
+    [[nodiscard]] const MemoryStats& GetMemoryStats() const { return m_stats; }
+
+    // Voxel coordinates must lie inside the grid.
+    [[nodiscard]] bool IsOccupied(uint32_t x, uint32_t y, uint32_t z) const
+    {
+        const uint32_t brick = m_indirection[BrickIndex(x, y, z)];
+        if (brick == EMPTY_BRICK)
+            return false;
+        const uint32_t local = LocalIndex(x, y, z);
+        return (m_brickOccupancy[static_cast<size_t>(brick) * 8 + (local >> 6)] >> (local & 63)) & 1u;
+    }
+
+    // The channel's value; outside the pool the value bakeClear / the frame
+    // clear leave in an untouched cell.
+    [[nodiscard]] uint32_t Load(uint32_t x, uint32_t y, uint32_t z, Channel channel) const
+    {
+        const uint32_t brick = m_indirection[BrickIndex(x, y, z)];
+        if (brick == EMPTY_BRICK)
+            return GetClearValue(channel);
+        return m_pool[PoolOffset(brick, channel) + LocalIndex(x, y, z)];
+    }
+
+    // Writable slot inside an allocated brick, else nullptr: accumulation into
+    // empty space is dropped, as injection only ever targets occupied voxels.
+    [[nodiscard]] uint32_t* Find(uint32_t x, uint32_t y, uint32_t z, Channel channel)
+    {
+        const uint32_t brick = m_indirection[BrickIndex(x, y, z)];
+        if (brick == EMPTY_BRICK)
+            return nullptr;
+        return &m_pool[PoolOffset(brick, channel) + LocalIndex(x, y, z)];
+    }
+
+    // Pool slot of a brick, or EMPTY_BRICK.
+    [[nodiscard]] uint32_t GetBrick(uint32_t bx, uint32_t by, uint32_t bz) const
+    {
+        return m_indirection[bx + (by + static_cast<size_t>(bz) * m_bricksPerAxis) * m_bricksPerAxis];
+    }
+
+    // Level 0 is the brick grid; level L node (x, y, z) covers 2^L bricks per axis.
+    [[nodiscard]] uint32_t GetLevelCount() const { return static_cast<uint32_t>(m_levels.size()); }
+    [[nodiscard]] uint32_t GetLevelDim(uint32_t level) const { return m_levelDims[level]; }
+    [[nodiscard]] bool IsNodeOccupied(uint32_t level, uint32_t x, uint32_t y, uint32_t z) const
+    {
+        const size_t dim = m_levelDims[level];
+        const size_t node = x + (y + z * dim) * dim;
+        return (m_levels[level][node >> 6] >> (node & 63)) & 1u;
+    }
+
+    // Zeroes irradiance and VPL count in every allocated brick (DispatchFrameClear).
+    void ClearAccumulators();
+
+    // Dense copy of one channel, gridDim^3 values in flat-id order.
+    void ExpandChannel(Channel channel, std::vector<uint32_t>& values) const;
+
+    [[nodiscard]] static uint32_t GetClearValue(Channel channel);
+
+private:
+    [[nodiscard]] size_t BrickIndex(uint32_t x, uint32_t y, uint32_t z) const
+    {
+        return (x >> 3) + ((y >> 3) + static_cast<size_t>(z >> 3) * m_bricksPerAxis) * m_bricksPerAxis;
+    }
+    [[nodiscard]] static uint32_t LocalIndex(uint32_t x, uint32_t y, uint32_t z)
+    {
+        return (x & 7u) | ((y & 7u) << 3) | ((z & 7u) << 6);
+    }
+    [[nodiscard]] static size_t PoolOffset(uint32_t brick, Channel channel)
+    {
+        return (static_cast<size_t>(brick) * ChannelCount + channel) * BRICK_VOXELS;
+    }
+
+    uint32_t m_gridDim = 0;
+    uint32_t m_bricksPerAxis = 0;
+    std::vector<uint32_t> m_indirection;
+    std::vector<std::vector<uint64_t>> m_levels; // occupancy bitsets, finest first
+    std::vector<uint32_t> m_levelDims;
+    std::vector<uint64_t> m_brickOccupancy;      // 8 words per allocated brick
+    std::vector<uint32_t> m_pool;                // ChannelCount * BRICK_VOXELS per allocated brick
+    MemoryStats m_stats;
+};
+
+// Random lookups against the bake's dense occupancy bitset and bound arrays
+// and against the brick map: agreement plus the time per lookup. Half the
+// queries hit occupied voxels (the access pattern of injection and guiding),
+// half are uniform over the grid.
+struct VoxelLookupBenchmark
+{
+    size_t queries = 0;
+    size_t mismatches = 0;
+    double denseOccupancyNs = 0.0;
+    double sparseOccupancyNs = 0.0;
+    double denseBoundsNs = 0.0;
+    double sparseBoundsNs = 0.0;
+};
+
+[[nodiscard]] VoxelLookupBenchmark MeasureVoxelLookups(const VoxelBake& bake, const VoxelBrickMap& map, size_t queries, uint32_t seed = 1);
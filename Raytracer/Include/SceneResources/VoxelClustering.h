@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// CPU clustering of fingerprinted lit voxels (vxpgCluster.hlsl and beyond).
+// Distance is the shader's: Hamming distance of the 128-bit visibility
+// fingerprints plus weighted position and premultiplied-irradiance terms.
+// On top of the shader's seeding-only scheme it offers exact and streaming
+// k-means++ seeding and Lloyd refinement, where a centre's fingerprint is the
+// per-bit majority of its members and its intensity their median (the
+// minimizers of the Hamming and L1 terms). The passes run on the ThreadPool
+// and do not depend on the thread count.
+
+// One uint4 of gVoxelFingerprints.
+struct VoxelFingerprint
+{
+    uint32_t words[4];
+};
+
+// ClusterCenter in vxpgCluster.hlsl (VxpgClusterPass::ClusterCenter).
+struct VoxelClusterCenter
+{
+    VoxelFingerprint fingerprint;
+    float position[3]; // voxel coordinates
+    float intensity;
+};
+static_assert(sizeof(VoxelClusterCenter) == 32, "VoxelClusterCenter must match the HLSL ClusterCenter");
+
+// Per compact id, as the cluster pass reads them.
+struct VoxelClusterInput
+{
+    const VoxelFingerprint* fingerprints = nullptr;
+    const float* premulIrradiance = nullptr;
+    const uint32_t* compactIds = nullptr; // compact id -> voxel flat id
+    uint32_t count = 0;                   // lit voxel count
+    uint32_t gridDim = 0;
+};
+
+enum class VoxelSeeding
+{
+    // SeedClusterCenters: candidateCount voxels drafted with the shader's pcg
+    // streams, k-means++ over the draft with its quirks (distances use seed 0's
+    // position and intensity; warp 0's candidates are only picked when every
+    // other weight is 0). Picks follow the shader's distribution, not its
+    // wave-by-wave random choices.
+    Shader,
+    // k-means++ over every voxel.
+    Exact,
+    // One pass reservoir sample of candidateCount voxels, then k-means++ over it.
+    Streaming,
+};
+
+struct VoxelClusterSettings
+{
+    uint32_t clusterCount = 32; // the GPU passes are fixed at CLUSTER_COUNT = 32
+    VoxelSeeding seeding = VoxelSeeding::Shader;
+    uint32_t candidateCount = 1024; // SeedClusterCenters' group size
+    uint32_t lloydIterations = 0;   // 0 = the shader's seeding-only clustering
+    float positionWeight = 0.0f;    // POSITION_WEIGHT
+    float intensityWeight = 1.0f;   // INTENSITY_WEIGHT
+    uint32_t seed = 0;              // Shader: gClusterSeedFrameTerm
+};
+
+struct VoxelClusterStats
+{
+    // Sum over voxels of the distance to their centre: entry 0 after seeding,
+    // entry i after Lloyd iteration i. Divide by the count for the mean
+    // within-cluster distance.
+    std::vector<double> cost;
+    uint32_t iterations = 0; // Lloyd iterations run (stops early once stable)
+    uint32_t emptyClusters = 0;
+    double seedMilliseconds = 0.0;
+    double assignMilliseconds = 0.0; // every assignment pass
+    double updateMilliseconds = 0.0; // every centre update
+};
+
+struct VoxelClusters
+{
+    std::vector<VoxelClusterCenter> centers;
+    std::vector<int32_t> seedCompactIds; // gClusterSeedCompactIds
+    std::vector<int32_t> assignments;    // gVoxelClusterAssignments
+    VoxelClusterStats stats;
+};
+
+namespace VoxelClustering
+{
+    [[nodiscard]] uint32_t Hamming(const VoxelFingerprint& a, const VoxelFingerprint& b);
+
+    // Hamming distance from one fingerprint to `count` others: AVX2 nibble
+    // lookups on x86-64 CPUs that have AVX2, hardware popcount otherwise.
+    void HammingDistances(const VoxelFingerprint& fingerprint, const VoxelFingerprint* others, uint32_t count, uint32_t* distances);
+
+    // Whether HammingDistances takes the AVX2 path (checked once, with CPUID).
+    [[nodiscard]] bool HammingDistancesUseAvx2();
+
+    // AssignVoxelClusters: nearest centre per voxel, first on ties. Returns
+    // the cost (sum of distances).
+    double Assign(const VoxelClusterInput& input, const VoxelClusterSettings& settings, const std::vector<VoxelClusterCenter>& centers,
+        std::vector<int32_t>& assignments);
+
+    [[nodiscard]] VoxelClusters Cluster(const VoxelClusterInput& input, const VoxelClusterSettings& settings);
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+#include "SceneResources/SceneBvh.h"
+
+// Grid constant buffer shared by the voxel passes (VoxelGridParams in
+// voxelGrid.hlsli followed by the runtime knobs). Plain floats so the CPU
+// voxelizer and offline tools see the exact layout the GPU reads.
+struct VoxelGridConstants
+{
+    float    gridMin[3];
+    float    voxelSize;
+    float    gridMax[3];
+    uint32_t gridDim;
+    uint32_t injectUseAvg;
+    uint32_t supervoxelFactor; // SUPERVOXEL_GRID_FACTOR; supervoxel = voxelCoord / factor
+    float    heatScale;
+    uint32_t reuseGiVpl; // 1 = VPL fitting samples come from last frame's guided-GI BSDF subtree (ADR 0009)
+};
+static_assert(sizeof(VoxelGridConstants) == 48, "VoxelGridConstants must match the HLSL cbuffer");
+
+// The bake flags VoxelizationPass rebakes on (voxel.bake.useCompact / clipping).
+struct VoxelBakeSettings
+{
+    uint32_t gridDim = 64;
+    bool useCompact = false;
+    bool clipping = false;
+};
+
+// The geometry bake, stored sparsely: occupancy as one bit per cell and the
+// quantized bounds of occupied cells only. Expand* produce the GPU resources'
+// contents (occupancy Texture3D<uint>, gBakedBoundMin/Max with 4 uints per
+// cell and bakeClear's values in empty cells). Cells are flat ids
+// x + y * dim + z * dim * dim, as in voxelize.hlsl.
+struct VoxelBake
+{
+    VoxelGridConstants grid{};
+    VoxelBakeSettings settings;
+    std::vector<uint64_t> occupancy;
+    std::vector<uint32_t> cells;  // occupied flat ids, ascending
+    std::vector<uint32_t> bounds; // per cell: min xyz, max xyz
+
+    [[nodiscard]] size_t GetCellCount() const { return static_cast<size_t>(grid.gridDim) * grid.gridDim * grid.gridDim; }
+    [[nodiscard]] bool IsOccupied(uint32_t flatId) const { return (occupancy[flatId >> 6] >> (flatId & 63)) & 1u; }
+
+    void ExpandOccupancy(std::vector<uint32_t>& texels) const;
+    void ExpandBounds(std::vector<uint32_t>& boundMin, std::vector<uint32_t>& boundMax) const;
+};
+
+struct VoxelBakeDiff
+{
+    size_t onlyInFirst = 0;
+    size_t onlyInSecond = 0;
+    size_t boundMismatches = 0; // cells occupied in both with different bounds
+    uint32_t maxBoundDelta = 0; // largest quantized difference among those
+
+    [[nodiscard]] bool IsEmpty() const { return onlyInFirst == 0 && onlyInSecond == 0 && boundMismatches == 0; }
+};
+
+// CPU twin of VoxelizationPass's bake (voxelize.hlsl): for each axis the
+// triangles are projected onto the grid face with conservative coverage of
+// the gridDim^2 viewport, each covered pixel's centre is put on the triangle
+// plane, and the voxel there is marked and gets the triangle's quantized
+// bound (optionally the Sutherland-Hodgman clip of TriangleClip.hlsl).
+// Vertices are snapped to the rasterizer's 1/256 pixel grid; remaining
+// differences to a GPU bake come from the hardware's conservative
+// uncertainty region. Runs on the ThreadPool.
+namespace Voxelizer
+{
+    constexpr uint32_t MIN_GRID_DIM = 32;
+    constexpr uint32_t MAX_GRID_DIM = 256;
+
+    // VoxelizationPass::OnSceneLoaded: a cube of gridDim voxels centred on the
+    // scene bounds. Updates the geometric fields and supervoxelFactor only.
+    void FitGrid(const BvhAabb& sceneBounds, uint32_t gridDim, VoxelGridConstants& grid);
+
+    // Empty bake when settings.gridDim is outside [MIN_GRID_DIM, MAX_GRID_DIM].
+    VoxelBake Bake(const SceneBvhInput& scene, const BvhAabb& sceneBounds, const VoxelBakeSettings& settings);
+
+    [[nodiscard]] VoxelBakeDiff Compare(const VoxelBake& first, const VoxelBake& second);
+
+    // <scene cache stem>.g<dim>[.compact][.clip].bvx next to the scene cache,
+    // so a bake is keyed by scene content and grid parameters.
+    [[nodiscard]] std::filesystem::path GetBakePath(const std::filesystem::path& sceneCachePath, const VoxelBakeSettings& settings);
+
+    // Written to a temporary file and renamed into place, like the scene cache.
+    bool Write(const std::filesystem::path& path, const VoxelBake& bake, uint64_t sourceHash);
+    // False unless the file matches sourceHash and settings exactly.
+    bool Read(const std::filesystem::path& path, uint64_t sourceHash, const VoxelBakeSettings& settings, VoxelBake& bake);
+}
@@ -0,0 +1,221 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "SceneResources/LightTree.h"
+#include "SceneResources/VoxelClustering.h"
+#include "SceneResources/Voxelizer.h"
+#include "Utils/MappedFile.h"
+
+// VXPG stage snapshot (.vxps): the intermediates of one frame as they stand
+// after RunVxpgPipelineUpTo, read back from the GPU, plus the grid constants
+// and every cvar. Sections of stages the frame did not run are left out.
+// Records reuse the CPU twins' types (VoxelFingerprint, VoxelClusterCenter,
+// LightTreeNode), so a snapshot can be fed straight into VoxelClustering,
+// BuildLightTree or SuperpixelClustering and compared. Plain records only:
+// reads and writes on any platform; tools/vxpg_snapshot.py reads the same
+// layout.
+//
+// Layout: FileHeader, SectionEntry[sectionCount], then 16-byte aligned
+// section payloads. Every offset is from the start of the file.
+namespace VxpgSnapshotFormat
+{
+    constexpr uint32_t MAGIC = 0x53505856; // "VXPS"
+    // Bump on any record or section change; tools/vxpg_snapshot.py checks it too.
+    constexpr uint32_t VERSION = 1;
+    constexpr size_t SECTION_ALIGNMENT = 16;
+
+    enum class SectionId : uint32_t
+    {
+        GridConstants = 1,     // VoxelGridConstants, one
+        CVars,                 // CVarRecord
+        Strings,               // UTF-8, referenced by CVarRecord
+        VoxelIrradiance,       // VoxelIrradianceRecord per injected voxel
+        CompactIds,            // uint32 per lit voxel: gCompactIds
+        PremulIrradiance,      // float per lit voxel
+        RepresentativeVpls,    // float4 per lit voxel: position, octahedral normal bits
+        Fingerprints,          // VoxelFingerprint per lit voxel
+        ClusterSeeds,          // int32 per cluster: seed compact ids
+        ClusterCenters,        // VoxelClusterCenter per cluster
+        ClusterAssignments,    // int32 per lit voxel
+        LightTreeNodes,        // LightTreeNode, 2 * leafCount - 1
+        LightTreeClusterRoots, // int32 per cluster
+        CompactToLeaf,         // int32 per lit voxel
+        ShadingPoints,         // float4 per pixel: world position, octahedral normal bits
+        SuperpixelIndex,       // int32 per pixel
+        ClusterVisibilityMask, // uint32 per superpixel
+        ClusterVisibility,     // float per (superpixel, cluster): soft visibility
+    };
+
+    struct FileHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t stage;      // VxpgStage the frame ran up to
+        uint32_t frameIndex;
+        uint32_t width;      // ShadingPoints resolution
+        uint32_t height;
+        uint32_t superpixelMapX;
+        uint32_t superpixelMapY;
+        uint32_t clusterCount;
+        uint32_t litVoxelCount; // gVoxCounters[0]
+        uint32_t leafCount;     // TreeBuildDispatchArgs numValidVoxels
+        uint32_t treeOverflow;  // TreeBuildDispatchArgs overflowFlag
+        uint32_t sectionCount;
+        uint32_t reserved;
+    };
+
+    struct SectionEntry
+    {
+        uint32_t id;
+        uint32_t elementSize;
+        uint64_t offset;
+        uint64_t size;
+    };
+
+    // The injection accumulators of one voxel with a nonzero value: the
+    // Texture3D grids are stored sparsely.
+    struct VoxelIrradianceRecord
+    {
+        uint32_t voxel;      // flat id x + y * dim + z * dim * dim
+        uint32_t irradiance; // packed fixed point (x100), as the grid holds it
+        uint32_t vplCount;
+    };
+
+    // A cvar's value as text (enums by name, float3 as "x y z").
+    struct CVarRecord
+    {
+        uint32_t type; // CVarType
+        uint32_t nameOffset; // into Strings
+        uint32_t nameLength;
+        uint32_t valueOffset;
+        uint32_t valueLength;
+    };
+
+    struct RepresentativeVpl
+    {
+        float position[3];
+        float normal; // octahedral UNORM16x2 bits
+    };
+
+    template <typename T>
+    struct ArrayView
+    {
+        const T* data = nullptr;
+        size_t count = 0;
+
+        [[nodiscard]] const T* begin() const { return data; }
+        [[nodiscard]] const T* end() const { return data + count; }
+        [[nodiscard]] size_t size() const { return count; }
+        [[nodiscard]] bool empty() const { return count == 0; }
+        const T& operator[](size_t i) const { return data[i]; }
+    };
+
+    struct CVarValue
+    {
+        uint32_t type = 0;
+        std::string name;
+        std::string value;
+    };
+
+    // Everything a capture writes. Empty arrays are left out of the file.
+    struct SnapshotInput
+    {
+        uint32_t stage = 0;
+        uint32_t frameIndex = 0;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint32_t superpixelMapX = 0;
+        uint32_t superpixelMapY = 0;
+        uint32_t clusterCount = 0;
+        uint32_t litVoxelCount = 0;
+        uint32_t leafCount = 0;
+        uint32_t treeOverflow = 0;
+        VoxelGridConstants grid{};
+        std::vector<CVarValue> cvars;
+
+        std::vector<VoxelIrradianceRecord> voxelIrradiance;
+        std::vector<uint32_t> compactIds;
+        std::vector<float> premulIrradiance;
+        std::vector<RepresentativeVpl> representativeVpls;
+        std::vector<VoxelFingerprint> fingerprints;
+        std::vector<int32_t> clusterSeeds;
+        std::vector<VoxelClusterCenter> clusterCenters;
+        std::vector<int32_t> clusterAssignments;
+        std::vector<LightTreeNode> lightTreeNodes;
+        std::vector<int32_t> lightTreeClusterRoots;
+        std::vector<int32_t> compactToLeaf;
+        std::vector<float> shadingPoints; // 4 per pixel
+        std::vector<int32_t> superpixelIndex;
+        std::vector<uint32_t> clusterVisibilityMask;
+        std::vector<float> clusterVisibility;
+    };
+
+    // Writes to a temporary file and renames it into place.
+    bool Write(const std::filesystem::path& path, const SnapshotInput& input);
+
+    // Maps a snapshot and validates header, version, section bounds and sizes
+    // against the header's counts. Accessors point straight into the mapping;
+    // a section the file lacks comes back empty.
+    class Reader
+    {
+    public:
+        bool Open(const std::filesystem::path& path);
+        void Close();
+
+        [[nodiscard]] const FileHeader& GetHeader() const { return m_header; }
+        [[nodiscard]] const VoxelGridConstants& GetGridConstants() const { return m_grid; }
+        [[nodiscard]] std::vector<CVarValue> GetCVars() const;
+
+        [[nodiscard]] ArrayView<VoxelIrradianceRecord> GetVoxelIrradiance() const { return m_voxelIrradiance; }
+        [[nodiscard]] ArrayView<uint32_t> GetCompactIds() const { return m_compactIds; }
+        [[nodiscard]] ArrayView<float> GetPremulIrradiance() const { return m_premulIrradiance; }
+        [[nodiscard]] ArrayView<RepresentativeVpl> GetRepresentativeVpls() const { return m_representativeVpls; }
+        [[nodiscard]] ArrayView<VoxelFingerprint> GetFingerprints() const { return m_fingerprints; }
+        [[nodiscard]] ArrayView<int32_t> GetClusterSeeds() const { return m_clusterSeeds; }
+        [[nodiscard]] ArrayView<VoxelClusterCenter> GetClusterCenters() const { return m_clusterCenters; }
+        [[nodiscard]] ArrayView<int32_t> GetClusterAssignments() const { return m_clusterAssignments; }
+        [[nodiscard]] ArrayView<LightTreeNode> GetLightTreeNodes() const { return m_lightTreeNodes; }
+        [[nodiscard]] ArrayView<int32_t> GetLightTreeClusterRoots() const { return m_lightTreeClusterRoots; }
+        [[nodiscard]] ArrayView<int32_t> GetCompactToLeaf() const { return m_compactToLeaf; }
+        [[nodiscard]] ArrayView<float> GetShadingPoints() const { return m_shadingPoints; }
+        [[nodiscard]] ArrayView<int32_t> GetSuperpixelIndex() const { return m_superpixelIndex; }
+        [[nodiscard]] ArrayView<uint32_t> GetClusterVisibilityMask() const { return m_clusterVisibilityMask; }
+        [[nodiscard]] ArrayView<float> GetClusterVisibility() const { return m_clusterVisibility; }
+
+        // The lit-voxel arrays as the CPU twins take them.
+        [[nodiscard]] VoxelClusterInput GetClusterInput() const;
+        [[nodiscard]] LightTreeInput GetLightTreeInput() const;
+
+        [[nodiscard]] size_t GetFileSize() const { return m_file.Size(); }
+
+    private:
+        bool Validate();
+
+        MappedFile m_file;
+        FileHeader m_header{};
+        VoxelGridConstants m_grid{};
+
+        ArrayView<CVarRecord> m_cvars;
+        ArrayView<char> m_strings;
+        ArrayView<VoxelIrradianceRecord> m_voxelIrradiance;
+        ArrayView<uint32_t> m_compactIds;
+        ArrayView<float> m_premulIrradiance;
+        ArrayView<RepresentativeVpl> m_representativeVpls;
+        ArrayView<VoxelFingerprint> m_fingerprints;
+        ArrayView<int32_t> m_clusterSeeds;
+        ArrayView<VoxelClusterCenter> m_clusterCenters;
+        ArrayView<int32_t> m_clusterAssignments;
+        ArrayView<LightTreeNode> m_lightTreeNodes;
+        ArrayView<int32_t> m_lightTreeClusterRoots;
+        ArrayView<int32_t> m_compactToLeaf;
+        ArrayView<float> m_shadingPoints;
+        ArrayView<int32_t> m_superpixelIndex;
+        ArrayView<uint32_t> m_clusterVisibilityMask;
+        ArrayView<float> m_clusterVisibility;
+    };
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+
+#include "Utils/MappedFile.h"
+
+// Tungsten native mesh (.wo3): headerless — uint64 vertexCount, vertices,
+// uint64 triangleCount, triangles. Vertex = pos(3f)+normal(3f)+uv(2f) = 32 B;
+// triangle = 3 int32 indices + int32 material id = 16 B. File maps the mesh
+// and validates the layout in place; callers convert straight from the
+// mapping into their own vertex arrays.
+namespace Wo3Mesh
+{
+    #pragma pack(push, 1)
+    struct Vertex { float px, py, pz, nx, ny, nz, u, v; };
+    struct Triangle { int32_t i0, i1, i2, material; };
+    #pragma pack(pop)
+    static_assert(sizeof(Vertex) == 32, "Wo3Mesh::Vertex must be 32 bytes");
+    static_assert(sizeof(Triangle) == 16, "Wo3Mesh::Triangle must be 16 bytes");
+
+    enum class Status
+    {
+        Ok,
+        OpenFailed,
+        TruncatedVertices,  // VertexCount() holds the declared count
+        TruncatedTriangles, // TriangleCount() holds the declared count
+        TooManyVertices,    // past 32-bit indexing
+    };
+
+    class File
+    {
+    public:
+        Status Open(const std::filesystem::path& path);
+
+        [[nodiscard]] const Vertex* Vertices() const { return m_vertices; }
+        [[nodiscard]] const Triangle* Triangles() const { return m_triangles; }
+        [[nodiscard]] uint64_t VertexCount() const { return m_vertexCount; }
+        [[nodiscard]] uint64_t TriangleCount() const { return m_triangleCount; }
+        [[nodiscard]] size_t Size() const { return m_file.Size(); }
+        [[nodiscard]] size_t TrailingBytes() const { return m_trailingBytes; }
+
+    private:
+        MappedFile m_file;
+        const Vertex* m_vertices = nullptr;
+        const Triangle* m_triangles = nullptr;
+        uint64_t m_vertexCount = 0;
+        uint64_t m_triangleCount = 0;
+        size_t m_trailingBytes = 0;
+    };
+
+    // Writes three indices per triangle to dst[0, 3 * TriangleCount()). Returns
+    // false at the first triangle indexing past the vertices (negative indices
+    // included) and stores it in badTriangle.
+    bool CopyIndices(const File& file, uint32_t* dst, size_t& badTriangle);
+}
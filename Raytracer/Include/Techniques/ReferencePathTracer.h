@@ -0,0 +1,162 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "Headless.h"
+#include "SceneResources/SceneBvh.h"
+#include "SceneResources/SceneCacheFormat.h"
+
+// CPU twin of the PathTracing technique (raytracing.hlsl) for converged
+// reference images without a GPU. Same estimator, same Cook-Torrance/GGX/
+// Smith/Schlick terms as BRDF.hlsl, same pcg seeds, camera rays and light
+// model; scene data comes from the baked scene cache (.bsc), so it runs
+// anywhere the cache can be mapped.
+//
+// Known differences from a GPU capture: textures are sampled bilinearly from
+// mip 0 of the uncompressed cache texels (the GPU reads BCn copies), and the
+// sky is whatever SetSky was given (the DDS skybox loader is Windows-only).
+
+// What Camera builds its matrices from. States only store position,
+// rotation and fov; the engine camera keeps a fixed 16:9 aspect.
+struct ReferenceCamera
+{
+    float position[3] = { 0.0f, 0.0f, -10.0f };
+    float rotation[4] = { 0.0f, 0.0f, 0.0f, 1.0f }; // quaternion xyzw
+    float fovYRadians = 1.04719755f;
+    float aspectRatio = 16.0f / 9.0f;
+};
+
+// One saved state of SavedUserData/states.json (StatesManager's format).
+struct ReferenceState
+{
+    ReferenceCamera camera;
+    bool hasLights = false; // replace the scene/config lights, as GoToState does
+    std::vector<SceneCacheFormat::LightRecord> lights;
+};
+
+bool LoadReferenceState(const std::filesystem::path& statesPath, const std::string& scene, const std::string& name, ReferenceState& state);
+
+// Names of the scene's saved states in file order; empty if it has none.
+std::vector<std::string> ListReferenceStates(const std::filesystem::path& statesPath, const std::string& scene);
+
+// HeadlessConfig lights in the cache's light record form; unknown types are skipped.
+std::vector<SceneCacheFormat::LightRecord> ConvertHeadlessLights(const std::vector<HeadlessLight>& lights);
+
+// Equirectangular sky as the skybox SRV holds it: linear RGBA float rows.
+struct ReferenceSky
+{
+    uint32_t width = 0;
+    uint32_t height = 0;
+    std::vector<float> rgba;
+};
+
+// An equirectangular PFM (RGB or greyscale, either byte order) as a sky, for
+// a skybox converted once from its DDS.
+bool LoadReferenceSky(const std::filesystem::path& path, ReferenceSky& sky);
+
+class ReferencePathTracer
+{
+public:
+    struct Settings
+    {
+        uint32_t width = 1280;
+        uint32_t height = 720;
+        uint32_t samplesPerPixel = 1;
+        uint32_t bounces = 1;
+        // Frames averaged as FrameAccumulationPass does; frame f seeds like frameIndex f.
+        uint32_t frames = 1;
+        float indirectSkyClamp = 0.0f;
+        bool skyLighting = true;
+        uint32_t tileSize = 16;
+
+        static Settings FromConfig(const HeadlessConfig& config, uint32_t frames);
+    };
+
+    struct Stats
+    {
+        uint64_t pathSamples = 0;
+        uint64_t closestHitRays = 0; // camera and bounce rays
+        uint64_t shadowRays = 0;
+        double milliseconds = 0.0;
+
+        [[nodiscard]] double MegaRaysPerSecond() const;
+        [[nodiscard]] double MegaSamplesPerSecond() const;
+    };
+
+    // The cache must stay open while the tracer is used: vertices, indices
+    // and texels are read straight from its mapping. Starts with the cache's lights.
+    bool Load(const SceneCacheFormat::Reader& cache, const BvhBuildSettings& bvhSettings = {});
+
+    void SetLights(std::vector<SceneCacheFormat::LightRecord> lights) { m_lights = std::move(lights); }
+    [[nodiscard]] const std::vector<SceneCacheFormat::LightRecord>& GetLights() const { return m_lights; }
+    void SetSky(ReferenceSky sky) { m_sky = std::move(sky); }
+
+    // Radiance as the accumulation buffer holds it before post-processing:
+    // width * height RGB floats, rows top to bottom. Tiles run on the
+    // ThreadPool; the image does not depend on the thread count.
+    Stats Render(const ReferenceCamera& camera, const Settings& settings, std::vector<float>& rgb) const;
+
+    [[nodiscard]] const SceneBvh& GetBvh() const { return m_bvh; }
+
+private:
+    struct Texture
+    {
+        uint32_t width;
+        uint32_t height;
+        const uint8_t* texels; // RGBA8
+    };
+
+    // MaterialRecord with the engine's defaults for primitives without one.
+    struct Material
+    {
+        float baseColorFactor[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+        float metallicFactor = 1.0f;
+        float roughnessFactor = 1.0f;
+        int32_t albedoTexture = -1;
+        int32_t normalTexture = -1;
+        int32_t metallicRoughnessTexture = -1;
+        bool opaque = true;
+    };
+
+    // InstanceInfo: one per (node, primitive), as the TLAS is built.
+    struct Instance
+    {
+        uint32_t geometry;
+        uint32_t material;
+        float objectToWorld[3][4];
+    };
+
+    struct TileContext;
+
+    static bool AcceptHit(const void* self, uint32_t instance, uint32_t primitive, float u, float v);
+    void RenderTile(const TileContext& context, uint32_t tile, Stats& stats) const;
+
+    const uint8_t* m_vertices = nullptr; // VertexPacking::FloatVertex records
+    const uint32_t* m_indices = nullptr;
+    std::vector<BvhGeometry> m_geometries;
+    std::vector<Instance> m_instances;
+    std::vector<Material> m_materials;
+    std::vector<Texture> m_textures;
+    std::vector<SceneCacheFormat::LightRecord> m_lights;
+    ReferenceSky m_sky;
+    SceneBvh m_bvh;
+};
+
+// Output files next to the engine's captures.
+namespace ReferenceOutput
+{
+    // Linear radiance as a little-endian PFM, the float output.
+    bool WritePfm(const std::filesystem::path& path, const float* rgb, uint32_t width, uint32_t height);
+
+    // Through postprocess.hlsl (exposure, contrast, ACES, lift, saturation,
+    // gamma) into an 8-bit PNG, comparable with tools/compare_captures.py.
+    bool WritePng(const std::filesystem::path& path, const float* rgb, uint32_t width, uint32_t height, const HeadlessConfig& config);
+
+    // Capture-style sidecar with the render settings and throughput.
+    bool WriteSidecarJson(const std::filesystem::path& path, const ReferenceCamera& camera, const ReferencePathTracer::Settings& settings,
+        const HeadlessConfig& config, const ReferencePathTracer::Stats& stats, const std::string& model, const std::string& place);
+}
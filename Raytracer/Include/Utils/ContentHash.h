@@ -0,0 +1,15 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+
+// 64-bit content hashing for cache keys (XXH64 algorithm). Not cryptographic:
+// it detects changed source data, not tampering.
+namespace ContentHash
+{
+    [[nodiscard]] uint64_t HashBytes(const void* data, size_t size, uint64_t seed = 0);
+
+    // Hashes the whole file through a read-only mapping; false if it cannot be opened.
+    bool HashFile(const std::filesystem::path& path, uint64_t& outHash);
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+
+// Read-only memory mapping of a whole file, shared by the loaders and offline
+// tools; Win32 file mapping on Windows, mmap elsewhere. An empty file maps successfully with Size() == 0 and Data() == nullptr.
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    bool Open(const std::filesystem::path& path);
+    void Close();
+
+    [[nodiscard]] bool IsOpen() const { return m_isOpen; }
+    [[nodiscard]] const uint8_t* Data() const { return m_data; }
+    [[nodiscard]] size_t Size() const { return m_size; }
+
+private:
+    const uint8_t* m_data = nullptr;
+    size_t m_size = 0;
+    bool m_isOpen = false;
+
+#ifdef _WIN32
+    void* m_file = nullptr;    // HANDLE
+    void* m_mapping = nullptr; // HANDLE
+#else
+    int m_fd = -1;
+#endif
+};
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// CPU sorting of uint64 keys (light-tree and other Morton-ordered builds).
+// LSD radix sort with per-thread histograms and a key/value scatter on the
+// ThreadPool: O(n) work, stable, no size cap. Passes whose digit is the same
+// for every key are skipped, which removes most of them for keys with
+// constant high bits. BitonicSort is the CPU model of BitonicSortPass, kept
+// as a reference.
+namespace RadixSort
+{
+    // BitonicCommon.hlsl BITONIC_NULL_KEY: padding that sorts after every key.
+    constexpr uint64_t NULL_KEY = ~uint64_t(0);
+
+    struct Settings
+    {
+        uint32_t digitBits = 11; // 11 (6 passes) or 8 (8 passes)
+    };
+
+    // Ascending. Keys with equal values keep their input order.
+    void Sort(uint64_t* keys, size_t count, const Settings& settings = {});
+    // values[i] follows keys[i].
+    void Sort(uint64_t* keys, uint32_t* values, size_t count, const Settings& settings = {});
+
+    // BitonicSortPass on a keyBuffer of `capacity` entries with `count` valid:
+    // [0, count) ends up sorted and [count, capacity) holds NULL_KEY, as after
+    // ClearCompactToLeaf + EncodeTreeLeaves + the network.
+    void SortPadded(uint64_t* keys, size_t count, size_t capacity, const Settings& settings = {});
+
+    // The bitonic network over count rounded up to a power of two (padded
+    // with NULL_KEY); compare-exchange stages run on the ThreadPool.
+    void BitonicSort(uint64_t* keys, size_t count);
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Fixed worker pool for load-time data-parallel work (scene import, mesh
+// processing, offline bakes). One batch runs at a time; the calling thread
+// takes tasks too and returns once every task has finished. Calls made from
+// inside a task run inline, so nested loops cannot deadlock.
+class ThreadPool
+{
+public:
+    // Process-wide pool sized to hardware_concurrency - 1 workers.
+    static ThreadPool& Get();
+
+    explicit ThreadPool(unsigned workerCount);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Workers plus the calling thread.
+    [[nodiscard]] unsigned GetThreadCount() const { return static_cast<unsigned>(m_workers.size()) + 1; }
+
+    // fn(size_t index) for every index in [0, count), in no particular order.
+    template <typename Fn>
+    void ParallelFor(size_t count, Fn&& fn)
+    {
+        using FnType = std::remove_reference_t<Fn>;
+        Run(count, [](void* context, size_t index) { (*static_cast<FnType*>(context))(index); }, &fn);
+    }
+
+    // fn(size_t begin, size_t end) over [0, count) split into grain-sized ranges.
+    template <typename Fn>
+    void ParallelForRange(size_t count, size_t grain, Fn&& fn)
+    {
+        if (count == 0)
+            return;
+        grain = grain > 0 ? grain : 1;
+        const size_t taskCount = (count + grain - 1) / grain;
+        auto task = [&fn, count, grain](size_t task)
+        {
+            const size_t begin = task * grain;
+            const size_t end = begin + grain < count ? begin + grain : count;
+            fn(begin, end);
+        };
+        ParallelFor(taskCount, task);
+    }
+
+private:
+    using InvokeFn = void (*)(void*, size_t);
+
+    void Run(size_t taskCount, InvokeFn invoke, void* context);
+    void Execute();
+    void WorkerLoop();
+
+    std::vector<std::thread> m_workers;
+
+    std::mutex m_submitMutex; // one batch at a time across calling threads
+    std::mutex m_mutex;
+    std::condition_variable m_wakeCv;
+    std::condition_variable m_doneCv;
+
+    InvokeFn m_invoke = nullptr;
+    void* m_context = nullptr;
+    size_t m_taskCount = 0;
+    std::atomic<size_t> m_nextTask{ 0 };
+
+    uint64_t m_generation = 0;
+    size_t m_finishedWorkers = 0;
+    bool m_stop = false;
+};
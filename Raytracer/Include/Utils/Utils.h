@@ -26,6 +26,25 @@ namespace RenderingUtils
         const tinygltf::Image& image,
         Microsoft::WRL::ComPtr<ID3D12Resource>& uploadBuffer);
 
+    // RGBA8 texture from tightly packed 3- or 4-component 8-bit rows.
+    Microsoft::WRL::ComPtr<ID3D12Resource> CreateDefaultTexture(
+        ID3D12Device* device,
+        ID3D12GraphicsCommandList* commandList,
+        const uint8_t* pixels,
+        int width,
+        int height,
+        int components,
+        Microsoft::WRL::ComPtr<ID3D12Resource>& uploadBuffer);
+
+    // Texture with every mip of an in-memory DDS file (DDSTextureLoader), in
+    // the same shader-resource state as above. Null if the loader rejects it.
+    Microsoft::WRL::ComPtr<ID3D12Resource> CreateDefaultTextureFromDds(
+        ID3D12Device* device,
+        ID3D12GraphicsCommandList* commandList,
+        const uint8_t* ddsData,
+        size_t ddsSize,
+        Microsoft::WRL::ComPtr<ID3D12Resource>& uploadBuffer);
+
     // DEFAULT-heap buffer with ALLOW_UNORDERED_ACCESS. byteSize is padded to
     // 256 B (tiny root-UAV alignment). Created in COMMON (InitialState ignored
     // for buffers); implicit promotion covers UAV access.
@@ -1,25 +1,15 @@
 #pragma once
 
 #include "Resources/RWStructuredBuffer.h"
+#include "SceneResources/Voxelizer.h"
 
 class Scene;
 
-struct VoxelGridConstants
-{
-    DirectX::XMFLOAT3 gridMin;
-    float             voxelSize;
-    DirectX::XMFLOAT3 gridMax;
-    uint32_t          gridDim;
-    uint32_t          injectUseAvg;
-    uint32_t          supervoxelFactor; // SUPERVOXEL_GRID_FACTOR; supervoxel = voxelCoord / factor
-    float             heatScale;
-    uint32_t          reuseGiVpl; // 1 = VPL fitting samples come from last frame's guided-GI BSDF subtree (ADR 0009)
-};
-
 // Geometry bake + per-frame injection-accumulator clear (ADR 0004). The scene
 // is conservative-rasterized into occupancy + quantized per-voxel bounds ONCE
 // per bake; a bake is invalidated by scene load, grid resize, or a bound-flag
-// change. Per frame only the irradiance/VPL-count clear runs.
+// change. Per frame only the irradiance/VPL-count clear runs. Voxelizer is
+// the CPU twin of the bake and fits the grid for both.
 class VoxelizationPass
 {
 public:
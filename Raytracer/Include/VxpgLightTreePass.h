@@ -53,6 +53,13 @@ public:
     D3D12_GPU_VIRTUAL_ADDRESS GetClusterRootsBufferVA() const { return m_clusterRoots->GetGPUVirtualAddress(); }
     D3D12_GPU_VIRTUAL_ADDRESS GetSuperpixelClusterHeapBufferVA() const { return m_spixelClusterHeap->GetGPUVirtualAddress(); }
 
+    // Readback (VxpgSnapshotManager). Nodes sit at the shader's 32 B stride,
+    // not sizeof(LightTreeNodeGpu).
+    RWStructuredBuffer<LightTreeNodeGpu>*         GetNodesBuffer() const { return m_nodes.get(); }
+    RWStructuredBuffer<int32_t>*                  GetCompactToLeafBuffer() const { return m_compactToLeaf.get(); }
+    RWStructuredBuffer<int32_t>*                  GetClusterRootsBuffer() const { return m_clusterRoots.get(); }
+    RWStructuredBuffer<TreeBuildDispatchArgsGpu>* GetDispatchArgsBuffer() const { return m_dispatchArgs.get(); }
+
 private:
     void CreateBuffers();
     void CreateRootSignature();
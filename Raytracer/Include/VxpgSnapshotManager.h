@@ -0,0 +1,106 @@
+#pragma once
+#include <array>
+#include <string>
+
+#include "SceneResources/Voxelizer.h" // VoxelGridConstants
+#include "VxpgStage.h"
+
+class VoxelizationPass;
+class LightInjectionPass;
+class VoxelGuidingBuildPass;
+class VxpgFingerprintPass;
+class VxpgClusterPass;
+class SuperpixelBuildPass;
+class VxpgClusterVisibilityPass;
+class VxpgLightTreePass;
+
+// Reads the VXPG intermediates of one frame back and writes them as a .vxps
+// snapshot (SceneResources/VxpgSnapshotFormat.h) for tools/vxpg_snapshot.py
+// and the CPU twins. Same flow as ScreenshotManager: Arm, RecordCopies once
+// the frame's VXPG passes are recorded, FinishCapture after its flush.
+class VxpgSnapshotManager
+{
+public:
+    // The passes whose outputs are read back; null ones are skipped.
+    struct Sources
+    {
+        VoxelizationPass*          voxelization      = nullptr;
+        LightInjectionPass*        lightInjection    = nullptr;
+        VoxelGuidingBuildPass*     guidingBuild      = nullptr;
+        VxpgFingerprintPass*       fingerprint       = nullptr;
+        VxpgClusterPass*           cluster           = nullptr;
+        SuperpixelBuildPass*       superpixel        = nullptr;
+        VxpgClusterVisibilityPass* clusterVisibility = nullptr;
+        VxpgLightTreePass*         lightTree         = nullptr;
+    };
+
+    void Initialize(
+        Microsoft::WRL::ComPtr<ID3D12Device5>              device,
+        Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList4> commandList);
+
+    // Capture the next frame to path; ignored while a capture is pending.
+    void Arm(const std::string& path);
+
+    // Copy what the stages up to `stage` wrote into the readback buffer. Call
+    // after the last VXPG pass and before anything clears the accumulators.
+    void RecordCopies(const Sources& sources, VxpgStage stage, uint32_t frameIndex);
+
+    // Map the readback buffer, trim to the frame's counts and write the file.
+    void FinishCapture();
+
+    bool IsCaptureDue() const { return m_captureDue; }
+    bool IsIdle()       const { return !m_captureDue; }
+
+private:
+    // One readback region per captured resource.
+    enum class Item
+    {
+        IrradianceGrid,
+        VplCountGrid,
+        ShadingPoints,
+        Counters,
+        CompactIds,
+        PremulIrradiance,
+        LightPoints,
+        Fingerprints,
+        ClusterSeeds,
+        ClusterCenters,
+        ClusterAssignments,
+        SuperpixelIndex,
+        VisibilityMask,
+        Visibility,
+        TreeNodes,
+        CompactToLeaf,
+        ClusterRoots,
+        TreeArgs,
+        Count,
+    };
+
+    struct Region
+    {
+        ID3D12Resource* resource = nullptr;
+        bool            texture  = false;
+        uint64_t        offset   = 0;
+        uint64_t        size     = 0;
+        D3D12_PLACED_SUBRESOURCE_FOOTPRINT footprint = {}; // textures
+        UINT            rows     = 0; // per slice
+        UINT64          rowBytes = 0; // tight
+    };
+
+    bool m_captureDue   = false;
+    bool m_copyRecorded = false;
+    std::string m_path;
+
+    std::array<Region, static_cast<size_t>(Item::Count)> m_regions;
+    VxpgStage          m_stage = VxpgStage::None;
+    uint32_t           m_frameIndex = 0;
+    VoxelGridConstants m_grid{};
+    uint32_t           m_mapX = 0;
+    uint32_t           m_mapY = 0;
+    uint32_t           m_clusterCount = 0;
+
+    Microsoft::WRL::ComPtr<ID3D12Device5>              m_device;
+    Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList4> m_commandList;
+    Microsoft::WRL::ComPtr<ID3D12Resource>             m_readbackBuffer;
+    uint64_t m_readbackBufferSize = 0;
+};
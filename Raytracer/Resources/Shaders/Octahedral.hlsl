@@ -45,4 +45,15 @@ float3 Unorm32OctahedronToUnitVector(uint pUnorm)
     return SignedOctahedronToUnitVector(p);
 }
 
+// Packed vertex tangent (VertexPacking.h): x lane is UNORM15 in bits 0-14 with
+// the bitangent sign in bit 15, y lane is UNORM16. Returns xyz + sign in w.
+float4 PackedTangentToTangent(uint packed)
+{
+    float2 p;
+    p.x = clamp(float(packed & 0x7fff) / float(0x7ffe), 0.0, 1.0);
+    p.y = clamp(float(packed >> 16) / float(0xfffe), 0.0, 1.0);
+    p = p * 2.0 - 1.0;
+    return float4(SignedOctahedronToUnitVector(p), (packed & 0x8000) ? -1.0 : 1.0);
+}
+
 #endif // OCTAHEDRAL_HLSL
@@ -340,7 +340,9 @@ float3 SampleWorldSpaceNormal(InstanceInfo instance, HitData data)
         return N;
     T = normalize(T);
 
-    float3 normalTS = SampleTexture(normalTexIdx, data.uv).xyz * 2.0 - 1.0;
+    // Z is rebuilt from XY: BC5 normal maps only store two channels.
+    float2 normalXY = SampleTexture(normalTexIdx, data.uv).xy * 2.0 - 1.0;
+    float3 normalTS = float3(normalXY, sqrt(saturate(1.0 - dot(normalXY, normalXY))));
     float3 B = cross(N, T) * data.tangent.w;
     float3x3 TBN = float3x3(T, B, N);
 
@@ -354,6 +356,8 @@ float4 SampleTextureColor(InstanceInfo instance, HitData data)
 
 float2 SampleRoughnessMetallic(InstanceInfo instance, HitData data)
 {
+    // glTF layout (G roughness, B metallic) also for BC5 maps, which store
+    // them in R/G: their SRV swizzles them back.
     float4 mr = SampleTexture(instance.roughnessTextureIndex, data.uv);
     return float2(instance.roughnessFactor * mr.g, instance.metallicFactor * mr.b);
 }
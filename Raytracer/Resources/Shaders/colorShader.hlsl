@@ -176,7 +176,9 @@ float4 pixel(VertexOut pin) : SV_Target
         T = normalize(projectedTangent);
         float3 B = cross(N, T) * pin.TangentW.w;
         float3x3 TBN = float3x3(T, B, N);
-        float3 normalTS = textureNormal.xyz * 2.0 - 1.0;
+        // Z is rebuilt from XY: BC5 normal maps only store two channels.
+        float2 normalXY = textureNormal.xy * 2.0 - 1.0;
+        float3 normalTS = float3(normalXY, sqrt(saturate(1.0 - dot(normalXY, normalXY))));
         worldNormal = normalize(mul(normalTS, TBN));
     }
 
@@ -64,7 +64,7 @@ RWStructuredBuffer<uint>  gVoxCounters     : register(u3);
 RWStructuredBuffer<uint>  gVoxCompactIds   : register(u4);
 // Per-pixel SLIC superpixel assignment (flat map index, -1 invalid), written by
 // SuperpixelBuildPass. SIByL u_spixelIdx. NOT pixel/32 — assignment follows
-// geometry. Global-heap slot 523.
+// geometry. DescriptorSlots::SUPERPIXELS, view SUPERPIXELS_INDEX.
 RWTexture2D<int> gSpixelIndexImage : register(u5);
 // voxelID (flat) -> compactID, sentinel -1 (built by VoxelGuidingBuildPass).
 RWStructuredBuffer<int>   gVoxInverseIndex : register(u6);
@@ -87,7 +87,7 @@ RWStructuredBuffer<int> gVoxelClusterAssignments : register(u11);
 RWStructuredBuffer<int> gClusterSeedCompactIds   : register(u12);
 
 // Cluster-visibility mask (debug view 10). SIByL u_spixel_visibility: bit k =
-// this superpixel tile can see light cluster k. Global-heap slot 530.
+// this superpixel tile can see light cluster k. DescriptorSlots::CLUSTER_VISIBILITY_MASK.
 RWTexture2D<uint> gClusterVisibilityMask : register(u13);
 
 // Bottom light tree (guided sampling + debug view 11). SIByL u_Nodes /
@@ -110,7 +110,7 @@ RWStructuredBuffer<uint4>         gVoxelLiveBoundMax : register(u19);
 // Fuzzy 4-nearest superpixel blend (SIByL u_fuzzyWeight / u_fuzzyIdx, written
 // by the superpixel pass): the 4 nearest superpixel centers per pixel and
 // their normalized 1/dist^2 weights. Top-level cluster selection becomes a
-// mixture over these parents. Global-heap slots 531/532.
+// mixture over these parents. DescriptorSlots::FUZZY_WEIGHT / FUZZY_INDEX.
 RWTexture2D<float4> gFuzzyWeights : register(u20);
 RWTexture2D<int4>   gFuzzyIndices : register(u21);
 
@@ -30,12 +30,12 @@
 
 // ---- cvis-specific resources (registers chosen to avoid RaytracingUtils') ----
 // Table (global heap): per-pixel + per-superpixel textures.
-RWTexture2D<float4> gVplPosition             : register(u1); // SIByL u_vpl_position (slot 526)
-RWTexture2D<uint4>  gVBuffer                 : register(u2); // shared primary VBuffer (slot 527)
-RWTexture2D<int>    gSuperpixelIndex         : register(u3); // SIByL u_spixelIdx (slot 523)
-RWTexture2D<int2>   gSpixelGathered          : register(u4); // SIByL u_spixel_gathered (slot 528)
-RWTexture2D<uint>   gSpixelCounter           : register(u5); // SIByL u_spixel_counter (slot 529)
-RWTexture2D<uint>   gClusterVisibilityMask   : register(u6); // SIByL u_spixel_visibility (slot 530)
+RWTexture2D<float4> gVplPosition             : register(u1); // SIByL u_vpl_position (DescriptorSlots::VPL_POSITION)
+RWTexture2D<uint4>  gVBuffer                 : register(u2); // shared primary VBuffer (DescriptorSlots::VBUFFER)
+RWTexture2D<int>    gSuperpixelIndex         : register(u3); // SIByL u_spixelIdx (DescriptorSlots::SUPERPIXELS, SUPERPIXELS_INDEX)
+RWTexture2D<int2>   gSpixelGathered          : register(u4); // SIByL u_spixel_gathered (DescriptorSlots::SUPERPIXEL_GATHERED)
+RWTexture2D<uint>   gSpixelCounter           : register(u5); // SIByL u_spixel_counter (DescriptorSlots::SUPERPIXEL_COUNTER)
+RWTexture2D<uint>   gClusterVisibilityMask   : register(u6); // SIByL u_spixel_visibility (DescriptorSlots::CLUSTER_VISIBILITY_MASK)
 
 // Root UAVs / SRVs: structured buffers.
 RWStructuredBuffer<int>    gVoxInverseIndex          : register(u7);  // voxelID -> compactID
@@ -1,50 +1,99 @@
 ﻿#include "pch.h"
 #include "DescriptorHeapAllocator.h"
 
-/// Descriptor heap allocator manages a descriptor heap by keeping track of free indices.
-/// It does not manage the lifetime of the descriptor heap itself.
-/// The descriptor heap must be created and released by the user.
-/// 
+#include "Constants.h"
+
+DescriptorHeapAllocator& DescriptorHeapAllocator::Get()
+{
+    static DescriptorHeapAllocator instance;
+    return instance;
+}
+
+/// Creates the shared shader-visible heap: `persistentCount` descriptors for long-lived views,
+/// followed by a `transientCount` ring for per-frame tables.
+///
 /// @param device The D3D12 device used to create the descriptor heap.
-/// @param descriptorHeap Descriptor heap to manage.
-DescriptorHeapAllocator::DescriptorHeapAllocator(ID3D12Device* device, ID3D12DescriptorHeap* descriptorHeap) :
-    m_device(device),
-    m_descriptorHeap(descriptorHeap)
+/// @param persistentCount Descriptors available to named slots, textures and ImGui.
+/// @param transientCount Descriptors shared by all in-flight frames' transient tables.
+void DescriptorHeapAllocator::Initialize(const Microsoft::WRL::ComPtr<ID3D12Device5>& device, uint32_t persistentCount, uint32_t transientCount)
+{
+    assert(device != nullptr && "Device cannot be null");
+    assert(!m_heap && "Descriptor heap allocator initialized twice");
+
+    D3D12_DESCRIPTOR_HEAP_DESC desc = {};
+    desc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
+    desc.NumDescriptors = persistentCount + transientCount;
+    desc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
+    desc.NodeMask = 0;
+    ThrowIfFailed(device->CreateDescriptorHeap(&desc, IID_PPV_ARGS(&m_heap)));
+    m_heap->SetName(L"Shader-Visible CBV/SRV/UAV Heap");
+
+    m_allocator = std::make_unique<DescriptorAllocator>(persistentCount, transientCount, Constants::Graphics::NUM_FRAMES);
+
+    m_descriptorStartCpuHandle = m_heap->GetCPUDescriptorHandleForHeapStart();
+    m_descriptorStartGpuHandle = m_heap->GetGPUDescriptorHandleForHeapStart();
+    m_handleIncrementSize = device->GetDescriptorHandleIncrementSize(desc.Type);
+}
+
+CD3DX12_CPU_DESCRIPTOR_HANDLE DescriptorHeapAllocator::GetCpuHandle(uint32_t index) const
+{
+    assert(index < m_allocator->GetCapacity() && "Descriptor index outside the heap");
+    return CD3DX12_CPU_DESCRIPTOR_HANDLE(m_descriptorStartCpuHandle, static_cast<INT>(index), m_handleIncrementSize);
+}
+
+CD3DX12_GPU_DESCRIPTOR_HANDLE DescriptorHeapAllocator::GetGpuHandle(uint32_t index) const
 {
-    assert(m_device != nullptr && "Device cannot be null");
-    assert(m_descriptorHeap != nullptr && "Descriptor heap cannot be null");
+    assert(index < m_allocator->GetCapacity() && "Descriptor index outside the heap");
+    return CD3DX12_GPU_DESCRIPTOR_HANDLE(m_descriptorStartGpuHandle, static_cast<INT>(index), m_handleIncrementSize);
+}
 
-    m_descriptorStartCpuHandle = descriptorHeap->GetCPUDescriptorHandleForHeapStart();
-    m_descriptorStartGpuHandle = descriptorHeap->GetGPUDescriptorHandleForHeapStart();
-    
-    const D3D12_DESCRIPTOR_HEAP_DESC desc = descriptorHeap->GetDesc();
-    
-    m_handleIncrementSize = m_device->GetDescriptorHandleIncrementSize(desc.Type);
-    m_freeIndices.reserve(desc.NumDescriptors);
-    
-    for (int i = 0; i < desc.NumDescriptors; i++)
-    {
-        m_freeIndices.push_back(i);
-    }
+uint32_t DescriptorHeapAllocator::GetNamedIndex(const NamedDescriptorSlot& slot, uint32_t element)
+{
+    assert(element < slot.count && "View outside its named slot");
+    const DescriptorAllocator::Range range = m_allocator->GetNamed(slot.name, slot.count);
+    if (!range.IsValid())
+        throw std::runtime_error(std::string("Descriptor heap is full, cannot register \"") + slot.name + "\"");
+    return range.offset + element;
 }
 
-DescriptorHeapAllocator::~DescriptorHeapAllocator()
+uint32_t DescriptorHeapAllocator::GetTextureTableIndex()
 {
-    // Useless.. TODO: consider allocating descriptor heaps in the constructor and releasing them in the destructor.
-    m_descriptorHeap = nullptr;
-    m_freeIndices.clear();
+    const DescriptorAllocator::Range range = m_allocator->GetBindlessTable(TEXTURE_TABLE, Constants::Graphics::MAX_TEXTURES);
+    if (!range.IsValid())
+        throw std::runtime_error("Descriptor heap is full, cannot create the texture table");
+    return range.offset;
+}
+
+int DescriptorHeapAllocator::AllocateTextureIndex()
+{
+    const uint32_t index = m_allocator->AllocateBindless(TEXTURE_TABLE);
+    if (index == DescriptorAllocator::INVALID)
+        throw std::runtime_error("Texture table is full (MAX_TEXTURES = " + std::to_string(Constants::Graphics::MAX_TEXTURES) + ")");
+    return static_cast<int>(index);
+}
+
+void DescriptorHeapAllocator::FreeTextureIndex(int textureIndex)
+{
+    if (textureIndex >= 0 && m_allocator)
+        m_allocator->FreeBindless(TEXTURE_TABLE, static_cast<uint32_t>(textureIndex));
+}
+
+uint32_t DescriptorHeapAllocator::AllocateTransient(uint32_t count)
+{
+    const DescriptorAllocator::Range range = m_allocator->AllocateTransient(count);
+    if (!range.IsValid())
+        throw std::runtime_error("Transient descriptor ring is full");
+    return range.offset;
 }
 
 void DescriptorHeapAllocator::Alloc(D3D12_CPU_DESCRIPTOR_HANDLE* outCpuHandle,
     D3D12_GPU_DESCRIPTOR_HANDLE* outGpuHandle)
 {
-    assert(m_freeIndices.size() > 0 && "No free indices available in the descriptor heap allocator");
+    const DescriptorAllocator::Range range = m_allocator->Allocate(1);
+    assert(range.IsValid() && "No free descriptors left in the shader-visible heap");
 
-    const int index = m_freeIndices.back();
-    m_freeIndices.pop_back();
-
-    if (outCpuHandle != nullptr) outCpuHandle->ptr = m_descriptorStartCpuHandle.ptr + static_cast<long long>(index * m_handleIncrementSize);
-    if (outGpuHandle != nullptr) outGpuHandle->ptr = m_descriptorStartGpuHandle.ptr + static_cast<long long>(index * m_handleIncrementSize);
+    if (outCpuHandle != nullptr) *outCpuHandle = GetCpuHandle(range.offset);
+    if (outGpuHandle != nullptr) *outGpuHandle = GetGpuHandle(range.offset);
 }
 
 void DescriptorHeapAllocator::Free(const D3D12_CPU_DESCRIPTOR_HANDLE& cpuHandle, const D3D12_GPU_DESCRIPTOR_HANDLE& gpuHandle)
@@ -53,9 +102,23 @@ void DescriptorHeapAllocator::Free(const D3D12_CPU_DESCRIPTOR_HANDLE& cpuHandle,
     UINT64 cpuIndex = (cpuHandle.ptr - m_descriptorStartCpuHandle.ptr) / m_handleIncrementSize;
     assert(gpuIndex == cpuIndex && "CPU and GPU handles do not match");
 
-    m_freeIndices.push_back(gpuIndex);
+    m_allocator->Free({ static_cast<uint32_t>(gpuIndex), 1 });
 }
 
+void DescriptorHeapAllocator::AdvanceFrame()
+{
+    m_allocator->AdvanceFrame();
+}
 
-
-
+void DescriptorHeapAllocator::LogReport() const
+{
+    const DescriptorAllocator::Stats stats = m_allocator->GetStats();
+    spdlog::info("Descriptor heap: {}/{} persistent descriptors used in {} range(s), {} free range(s), largest free {}, fragmentation {:.0f}%, {} awaiting frame retirement",
+        stats.persistent.used, stats.persistent.capacity, stats.persistent.allocationCount,
+        stats.persistent.freeRangeCount, stats.persistent.largestFree, stats.persistent.Fragmentation() * 100.0, stats.pendingFrees);
+    spdlog::info("  transient ring: {} in flight, peak {} of {}", stats.transientInFlight, stats.transientPeak, stats.transientCapacity);
+    for (const auto& [name, range] : stats.named)
+        spdlog::info("  {:<28} {:>5} +{}", name, range.offset, range.count);
+    for (const auto& [name, used, capacity] : stats.bindlessTables)
+        spdlog::info("  {} table: {}/{} entries used", name, used, capacity);
+}
@@ -5,6 +5,7 @@
 #include <shellapi.h>
 #include <filesystem>
 
+#include "DescriptorHeapAllocator.h"
 #include "imgui.h"
 #include "backends/imgui_impl_dx12.h"
 #include "backends/imgui_impl_win32.h"
@@ -49,9 +50,15 @@ void EditorUI::Initialize(
 	init_info.RTVFormat = DXGI_FORMAT_R8G8B8A8_UNORM;
 	init_info.DSVFormat = DXGI_FORMAT_D32_FLOAT;
 
-	init_info.LegacySingleSrvCpuDescriptor.ptr = srvHeap->GetCPUDescriptorHandleForHeapStart().ptr;
-	init_info.LegacySingleSrvGpuDescriptor.ptr = srvHeap->GetGPUDescriptorHandleForHeapStart().ptr;
 	init_info.SrvDescriptorHeap = srvHeap.Get();
+	init_info.SrvDescriptorAllocFn = [](ImGui_ImplDX12_InitInfo*, D3D12_CPU_DESCRIPTOR_HANDLE* outCpuHandle, D3D12_GPU_DESCRIPTOR_HANDLE* outGpuHandle)
+	{
+		DescriptorHeapAllocator::Get().Alloc(outCpuHandle, outGpuHandle);
+	};
+	init_info.SrvDescriptorFreeFn = [](ImGui_ImplDX12_InitInfo*, D3D12_CPU_DESCRIPTOR_HANDLE cpuHandle, D3D12_GPU_DESCRIPTOR_HANDLE gpuHandle)
+	{
+		DescriptorHeapAllocator::Get().Free(cpuHandle, gpuHandle);
+	};
 
 	ImGui_ImplDX12_Init(&init_info);
 	spdlog::info("ImGui initialized successfully.");
@@ -2,9 +2,11 @@
 #include "FrameAccumulationPass.h"
 
 #include "Constants.h"
+#include "DescriptorHeapAllocator.h"
 #include "Shader.h"
 #include "Window.h"
 #include "ResourceManager/ResourceManager.h"
+#include "Resources/GpuMemoryAllocator.h"
 
 void FrameAccumulationPass::Initialize(
     Microsoft::WRL::ComPtr<ID3D12Device5> device,
@@ -15,13 +17,6 @@ void FrameAccumulationPass::Initialize(
     m_device = device;
     m_commandList = commandList;
 
-    // Create descriptor heap for SRV + UAVs
-    D3D12_DESCRIPTOR_HEAP_DESC heapDesc = {};
-    heapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
-    heapDesc.NumDescriptors = 3;  // 1 SRV + 2 UAVs
-    heapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
-    ThrowIfFailed(m_device->CreateDescriptorHeap(&heapDesc, IID_PPV_ARGS(&m_descriptorHeap)));
-
     CreateResources();
     CreateRootSignature();
     CreatePSO();
@@ -61,6 +56,8 @@ void FrameAccumulationPass::CreateRootSignature()
 
 void FrameAccumulationPass::CreateResources()
 {
+    GpuMemoryAllocator::ScopedTag memoryTag("FrameAccumulationPass");
+
     spdlog::debug("Creating frame accumulation buffers");
 
     UINT width = Window::Get().GetWidth();
@@ -81,10 +78,8 @@ void FrameAccumulationPass::CreateResources()
         desc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
         desc.Flags = D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS;
 
-        ThrowIfFailed(m_device->CreateCommittedResource(
-            &CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT),
-            D3D12_HEAP_FLAG_NONE,
-            &desc,
+        ThrowIfFailed(GpuMemoryAllocator::Get().CreateResource(
+            desc,
             D3D12_RESOURCE_STATE_UNORDERED_ACCESS,
             nullptr,
             IID_PPV_ARGS(&m_accumulationBuffer)));
@@ -107,10 +102,8 @@ void FrameAccumulationPass::CreateResources()
         desc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
         desc.Flags = D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS;
 
-        ThrowIfFailed(m_device->CreateCommittedResource(
-            &CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT),
-            D3D12_HEAP_FLAG_NONE,
-            &desc,
+        ThrowIfFailed(GpuMemoryAllocator::Get().CreateResource(
+            desc,
             D3D12_RESOURCE_STATE_COPY_SOURCE,
             nullptr,
             IID_PPV_ARGS(&m_displayBuffer)));
@@ -142,9 +135,11 @@ void FrameAccumulationPass::Render(
     if (!m_initialized)
         return;
 
-    // Get descriptor handles
-    UINT descriptorSize = m_device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
-    CD3DX12_CPU_DESCRIPTOR_HANDLE cpuHandle = CD3DX12_CPU_DESCRIPTOR_HANDLE(m_descriptorHeap->GetCPUDescriptorHandleForHeapStart());
+    // The views change every frame, so the table comes from the shared heap's transient ring
+    auto& descriptors = DescriptorHeapAllocator::Get();
+    const uint32_t table = descriptors.AllocateTransient(3);
+    const UINT descriptorSize = descriptors.GetIncrementSize();
+    CD3DX12_CPU_DESCRIPTOR_HANDLE cpuHandle = descriptors.GetCpuHandle(table);
 
     // Create SRV for current frame at slot 0 (t0)
     D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
@@ -171,9 +166,9 @@ void FrameAccumulationPass::Render(
     m_commandList->SetPipelineState(m_pso.Get());
 
     // Set descriptor heap and bind descriptor table
-    ID3D12DescriptorHeap* heaps[] = { m_descriptorHeap.Get() };
+    ID3D12DescriptorHeap* heaps[] = { descriptors.GetHeap().Get() };
     m_commandList->SetDescriptorHeaps(_countof(heaps), heaps);
-    m_commandList->SetComputeRootDescriptorTable(0, m_descriptorHeap->GetGPUDescriptorHandleForHeapStart());
+    m_commandList->SetComputeRootDescriptorTable(0, descriptors.GetGpuHandle(table));
 
     // Bind root constant for frameCount
     m_commandList->SetComputeRoot32BitConstant(1, m_frameCount + 1, 0);
@@ -0,0 +1,86 @@
+#include "Headless.h"
+
+#include <fstream>
+#include <sstream>
+
+#include <spdlog/spdlog.h>
+
+#include "rapidjson/document.h"
+
+// Split from Headless.cpp (argv parsing needs Windows) so the portable build
+// and its tools read headless.json exactly as the engine does.
+HeadlessConfig LoadHeadlessConfig(const std::string& path)
+{
+    HeadlessConfig config;
+
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+    {
+        spdlog::info("Headless config not found at {}, using built-in defaults", path);
+        return config;
+    }
+
+    std::stringstream ss;
+    ss << file.rdbuf();
+    const std::string json = ss.str();
+
+    rapidjson::Document doc;
+    if (doc.Parse(json.c_str()).HasParseError() || !doc.IsObject())
+    {
+        spdlog::warn("Headless config at {} is not valid JSON, using built-in defaults", path);
+        return config;
+    }
+
+    auto readUint  = [&](const char* key, uint32_t& out) { if (doc.HasMember(key) && doc[key].IsUint())   out = doc[key].GetUint(); };
+    auto readFloat = [&](const char* key, float& out)    { if (doc.HasMember(key) && doc[key].IsNumber()) out = doc[key].GetFloat(); };
+    auto readBool  = [&](const char* key, bool& out)     { if (doc.HasMember(key) && doc[key].IsBool())   out = doc[key].GetBool(); };
+
+    readUint("width",  config.width);
+    readUint("height", config.height);
+    readUint("spp",     config.spp);
+    readUint("bounces", config.bounces);
+    readBool ("postProcessEnabled", config.postProcessEnabled);
+    readFloat("exposure",   config.exposure);
+    readFloat("contrast",   config.contrast);
+    readFloat("saturation", config.saturation);
+    readFloat("lift",       config.lift);
+    readFloat("indirectSkyClamp", config.indirectSkyClamp);
+    readBool ("skyLighting", config.skyLighting);
+    readUint ("guidingDebugView", config.guidingDebugView);
+    readUint ("treeWeightMode", config.treeWeightMode);
+    readBool ("secondBounce", config.secondBounce);
+    readBool ("oneSampleMis", config.oneSampleMis);
+    readBool ("oneSampleAdaptiveQ", config.oneSampleAdaptiveQ);
+    readBool ("injectionReuse", config.injectionReuse);
+    readFloat("defaultSeconds", config.defaultSeconds);
+    if (doc.HasMember("outputDir") && doc["outputDir"].IsString())
+        config.outputDir = doc["outputDir"].GetString();
+
+    if (doc.HasMember("lights") && doc["lights"].IsArray())
+    {
+        auto readVec3 = [](const rapidjson::Value& entry, const char* key, float out[3]) {
+            if (entry.HasMember(key) && entry[key].IsArray() && entry[key].Size() == 3)
+                for (rapidjson::SizeType i = 0; i < 3; ++i)
+                    if (entry[key][i].IsNumber())
+                        out[i] = entry[key][i].GetFloat();
+        };
+
+        for (const auto& entry : doc["lights"].GetArray())
+        {
+            if (!entry.IsObject())
+                continue;
+
+            HeadlessLight light;
+            if (entry.HasMember("type") && entry["type"].IsString())
+                light.type = entry["type"].GetString();
+            readVec3(entry, "position",  light.position);
+            readVec3(entry, "direction", light.direction);
+            readVec3(entry, "color",     light.color);
+            if (entry.HasMember("intensity") && entry["intensity"].IsNumber()) light.intensity = entry["intensity"].GetFloat();
+            if (entry.HasMember("range")     && entry["range"].IsNumber())     light.range     = entry["range"].GetFloat();
+            config.lights.push_back(light);
+        }
+    }
+
+    return config;
+}
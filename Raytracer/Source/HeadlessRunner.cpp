@@ -174,6 +174,14 @@ int HeadlessRunner::Run()
             while (!m_renderer.ScreenshotIdle())
                 PumpFrame();
 
+            // The frame right after the capture, same camera and converged state.
+            if (m_args.vxpgSnapshot)
+            {
+                m_renderer.ArmVxpgSnapshot(runDir + "/" + place + "-" + technique + ".vxps");
+                while (!m_renderer.VxpgSnapshotIdle())
+                    PumpFrame();
+            }
+
             spdlog::info("Captured {}-{}", place, technique);
         }
     }
@@ -3,6 +3,7 @@
 
 #include "AccelerationStructures.h"
 #include "Constants.h"
+#include "DescriptorHeapAllocator.h"
 #include "Renderer.h"
 #include "VoxelizationPass.h"
 #include "Window.h"
@@ -10,6 +11,7 @@
 #include "Resources/StructuredBuffer.h"
 #include "SceneResources/Scene.h"
 #include "Utils/PassConstants.h"
+#include "Resources/GpuMemoryAllocator.h"
 
 TechniqueDesc LightInjectionPass::GetTechniqueDesc() const
 {
@@ -86,49 +88,49 @@ void LightInjectionPass::CreateGlobalRootSignature()
     skybox_range.NumDescriptors = 1;
     skybox_range.RegisterSpace = 1;
     skybox_range.RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_SRV;
-    skybox_range.OffsetInDescriptorsFromTableStart = Constants::Graphics::SKYBOX_DESCRIPTOR_INDEX;
+    skybox_range.OffsetInDescriptorsFromTableStart = DescriptorHeapAllocator::Get().GetNamedIndex(DescriptorSlots::SKYBOX);
 
     D3D12_DESCRIPTOR_RANGE voxelIrradianceRange;
     voxelIrradianceRange.BaseShaderRegister = 1;
     voxelIrradianceRange.NumDescriptors = 1;
     voxelIrradianceRange.RegisterSpace = 0;
     voxelIrradianceRange.RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_UAV;
-    voxelIrradianceRange.OffsetInDescriptorsFromTableStart = Constants::Graphics::VOXEL_IRRADIANCE_DESCRIPTOR_INDEX;
+    voxelIrradianceRange.OffsetInDescriptorsFromTableStart = DescriptorHeapAllocator::Get().GetNamedIndex(DescriptorSlots::VOXEL_GRID, DescriptorSlots::VOXEL_GRID_IRRADIANCE);
 
     D3D12_DESCRIPTOR_RANGE voxelVplCountRange;
     voxelVplCountRange.BaseShaderRegister = 2;
     voxelVplCountRange.NumDescriptors = 1;
     voxelVplCountRange.RegisterSpace = 0;
     voxelVplCountRange.RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_UAV;
-    voxelVplCountRange.OffsetInDescriptorsFromTableStart = Constants::Graphics::VOXEL_VPL_COUNT_DESCRIPTOR_INDEX;
+    voxelVplCountRange.OffsetInDescriptorsFromTableStart = DescriptorHeapAllocator::Get().GetNamedIndex(DescriptorSlots::VOXEL_GRID, DescriptorSlots::VOXEL_GRID_VPL_COUNT);
 
     D3D12_DESCRIPTOR_RANGE shadingPointsRange;
     shadingPointsRange.BaseShaderRegister = 3; // u3
     shadingPointsRange.NumDescriptors = 1;
     shadingPointsRange.RegisterSpace = 0;
     shadingPointsRange.RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_UAV;
-    shadingPointsRange.OffsetInDescriptorsFromTableStart = Constants::Graphics::SHADINGPOINTS_DESCRIPTOR_INDEX;
+    shadingPointsRange.OffsetInDescriptorsFromTableStart = DescriptorHeapAllocator::Get().GetNamedIndex(DescriptorSlots::SHADING_POINTS);
 
     D3D12_DESCRIPTOR_RANGE voxelRepresentativeRange;
     voxelRepresentativeRange.BaseShaderRegister = 4; // u4
     voxelRepresentativeRange.NumDescriptors = 1;
     voxelRepresentativeRange.RegisterSpace = 0;
     voxelRepresentativeRange.RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_UAV;
-    voxelRepresentativeRange.OffsetInDescriptorsFromTableStart = Constants::Graphics::VOXEL_REPRESENTATIVE_DESCRIPTOR_INDEX;
+    voxelRepresentativeRange.OffsetInDescriptorsFromTableStart = DescriptorHeapAllocator::Get().GetNamedIndex(DescriptorSlots::VOXEL_REPRESENTATIVE);
 
     D3D12_DESCRIPTOR_RANGE vplPositionRange;
     vplPositionRange.BaseShaderRegister = 5; // u5
     vplPositionRange.NumDescriptors = 1;
     vplPositionRange.RegisterSpace = 0;
     vplPositionRange.RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_UAV;
-    vplPositionRange.OffsetInDescriptorsFromTableStart = Constants::Graphics::VPL_POSITION_DESCRIPTOR_INDEX;
+    vplPositionRange.OffsetInDescriptorsFromTableStart = DescriptorHeapAllocator::Get().GetNamedIndex(DescriptorSlots::VPL_POSITION);
 
     D3D12_DESCRIPTOR_RANGE vbufferRange;
     vbufferRange.BaseShaderRegister = 6; // u6
     vbufferRange.NumDescriptors = 1;
     vbufferRange.RegisterSpace = 0;
     vbufferRange.RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_UAV;
-    vbufferRange.OffsetInDescriptorsFromTableStart = Constants::Graphics::VBUFFER_DESCRIPTOR_INDEX;
+    vbufferRange.OffsetInDescriptorsFromTableStart = DescriptorHeapAllocator::Get().GetNamedIndex(DescriptorSlots::VBUFFER);
 
     D3D12_DESCRIPTOR_RANGE ranges[13] = {cbvRange, rtRange, tlasRange, vertex_range, index_range,
                                         texture_range, skybox_range, voxelIrradianceRange, voxelVplCountRange,
@@ -181,6 +183,8 @@ void LightInjectionPass::CreateShaderResourceHeap()
 
 void LightInjectionPass::CreateShadingPointsResource()
 {
+    GpuMemoryAllocator::ScopedTag memoryTag("LightInjectionPass");
+
     m_shadingPointsTex.Reset();
 
     D3D12_RESOURCE_DESC desc = {};
@@ -194,21 +198,18 @@ void LightInjectionPass::CreateShadingPointsResource()
     desc.Layout           = D3D12_TEXTURE_LAYOUT_UNKNOWN;
     desc.Flags            = D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS;
 
-    auto heapProps = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
     // Created in UNORDERED_ACCESS (matches VoxelizationPass textures): written as
     // a UAV by injection and read as a UAV by the raster debug overlay, so it
     // stays in this layout — UAV barriers between writer/reader handle ordering.
-    ThrowIfFailed(m_device->CreateCommittedResource(
-        &heapProps, D3D12_HEAP_FLAG_NONE, &desc,
+    ThrowIfFailed(GpuMemoryAllocator::Get().CreateResource(
+        desc,
         D3D12_RESOURCE_STATE_UNORDERED_ACCESS, nullptr, IID_PPV_ARGS(&m_shadingPointsTex)));
     m_shadingPointsTex->SetName(L"VXPG ShadingPoints");
 
     // UAV at the shared heap's ShadingPoints slot — bound via the global root
     // signature's u3 range so the injection raygen/closest-hit can write it.
-    auto increment = m_device->GetDescriptorHandleIncrementSize(m_srvUavHeap->GetDesc().Type);
-    D3D12_CPU_DESCRIPTOR_HANDLE uavHandle;
-    uavHandle.ptr = m_srvUavHeap->GetCPUDescriptorHandleForHeapStart().ptr
-                  + Constants::Graphics::SHADINGPOINTS_DESCRIPTOR_INDEX * increment;
+    auto& descriptors = DescriptorHeapAllocator::Get();
+    D3D12_CPU_DESCRIPTOR_HANDLE uavHandle = descriptors.GetCpuHandle(descriptors.GetNamedIndex(DescriptorSlots::SHADING_POINTS));
 
     D3D12_UNORDERED_ACCESS_VIEW_DESC uavDesc = {};
     uavDesc.Format        = DXGI_FORMAT_R32G32B32A32_FLOAT;
@@ -218,9 +219,9 @@ void LightInjectionPass::CreateShadingPointsResource()
 
 void LightInjectionPass::CreateRepresentativeResources()
 {
-    auto heapProps = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
-    auto increment = m_device->GetDescriptorHandleIncrementSize(m_srvUavHeap->GetDesc().Type);
-    const D3D12_CPU_DESCRIPTOR_HANDLE heapStart = m_srvUavHeap->GetCPUDescriptorHandleForHeapStart();
+    GpuMemoryAllocator::ScopedTag memoryTag("LightInjectionPass");
+
+    auto& descriptors = DescriptorHeapAllocator::Get();
 
     // Per-voxel representative VPL (pos + octa normal): grid-sized Texture3D.
     m_voxelRepresentativeTex.Reset();
@@ -237,13 +238,12 @@ void LightInjectionPass::CreateRepresentativeResources()
         desc.Layout           = D3D12_TEXTURE_LAYOUT_UNKNOWN;
         desc.Flags            = D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS;
 
-        ThrowIfFailed(m_device->CreateCommittedResource(
-            &heapProps, D3D12_HEAP_FLAG_NONE, &desc,
+        ThrowIfFailed(GpuMemoryAllocator::Get().CreateResource(
+            desc,
             D3D12_RESOURCE_STATE_UNORDERED_ACCESS, nullptr, IID_PPV_ARGS(&m_voxelRepresentativeTex)));
         m_voxelRepresentativeTex->SetName(L"VXPG VoxelRepresentative");
 
-        D3D12_CPU_DESCRIPTOR_HANDLE uavHandle;
-        uavHandle.ptr = heapStart.ptr + Constants::Graphics::VOXEL_REPRESENTATIVE_DESCRIPTOR_INDEX * increment;
+        D3D12_CPU_DESCRIPTOR_HANDLE uavHandle = descriptors.GetCpuHandle(descriptors.GetNamedIndex(DescriptorSlots::VOXEL_REPRESENTATIVE));
         D3D12_UNORDERED_ACCESS_VIEW_DESC uavDesc = {};
         uavDesc.Format               = DXGI_FORMAT_R32G32B32A32_FLOAT;
         uavDesc.ViewDimension        = D3D12_UAV_DIMENSION_TEXTURE3D;
@@ -265,13 +265,12 @@ void LightInjectionPass::CreateRepresentativeResources()
         desc.Layout           = D3D12_TEXTURE_LAYOUT_UNKNOWN;
         desc.Flags            = D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS;
 
-        ThrowIfFailed(m_device->CreateCommittedResource(
-            &heapProps, D3D12_HEAP_FLAG_NONE, &desc,
+        ThrowIfFailed(GpuMemoryAllocator::Get().CreateResource(
+            desc,
             D3D12_RESOURCE_STATE_UNORDERED_ACCESS, nullptr, IID_PPV_ARGS(&m_vplPositionTex)));
         m_vplPositionTex->SetName(L"VXPG VplPosition");
 
-        D3D12_CPU_DESCRIPTOR_HANDLE uavHandle;
-        uavHandle.ptr = heapStart.ptr + Constants::Graphics::VPL_POSITION_DESCRIPTOR_INDEX * increment;
+        D3D12_CPU_DESCRIPTOR_HANDLE uavHandle = descriptors.GetCpuHandle(descriptors.GetNamedIndex(DescriptorSlots::VPL_POSITION));
         D3D12_UNORDERED_ACCESS_VIEW_DESC uavDesc = {};
         uavDesc.Format        = DXGI_FORMAT_R32G32B32A32_FLOAT;
         uavDesc.ViewDimension = D3D12_UAV_DIMENSION_TEXTURE2D;
@@ -2,9 +2,11 @@
 #include "PostProcessPass.h"
 
 #include "Constants.h"
+#include "DescriptorHeapAllocator.h"
 #include "Shader.h"
 #include "Window.h"
 #include "ResourceManager/ResourceManager.h"
+#include "Resources/GpuMemoryAllocator.h"
 
 void PostProcessPass::Initialize(
     Microsoft::WRL::ComPtr<ID3D12Device5> device,
@@ -15,13 +17,6 @@ void PostProcessPass::Initialize(
     m_device = device;
     m_commandList = commandList;
 
-    // Create descriptor heap for SRV + UAV
-    D3D12_DESCRIPTOR_HEAP_DESC heapDesc = {};
-    heapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
-    heapDesc.NumDescriptors = 2;  // 1 SRV + 1 UAV
-    heapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
-    ThrowIfFailed(m_device->CreateDescriptorHeap(&heapDesc, IID_PPV_ARGS(&m_descriptorHeap)));
-
     CreateResources();
     CreateRootSignature();
     CreatePSO();
@@ -60,6 +55,8 @@ void PostProcessPass::CreateRootSignature()
 
 void PostProcessPass::CreateResources()
 {
+    GpuMemoryAllocator::ScopedTag memoryTag("PostProcessPass");
+
     spdlog::debug("Creating post-process output buffer");
 
     UINT width = Window::Get().GetWidth();
@@ -80,10 +77,8 @@ void PostProcessPass::CreateResources()
         desc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
         desc.Flags = D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS;
 
-        ThrowIfFailed(m_device->CreateCommittedResource(
-            &CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT),
-            D3D12_HEAP_FLAG_NONE,
-            &desc,
+        ThrowIfFailed(GpuMemoryAllocator::Get().CreateResource(
+            desc,
             D3D12_RESOURCE_STATE_COPY_SOURCE,
             nullptr,
             IID_PPV_ARGS(&m_outputBuffer)));
@@ -117,9 +112,11 @@ void PostProcessPass::Render(
     if (!m_initialized)
         return;
 
-    // Get descriptor handles
-    UINT descriptorSize = m_device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
-    CD3DX12_CPU_DESCRIPTOR_HANDLE cpuHandle = CD3DX12_CPU_DESCRIPTOR_HANDLE(m_descriptorHeap->GetCPUDescriptorHandleForHeapStart());
+    // The views change every frame, so the table comes from the shared heap's transient ring
+    auto& descriptors = DescriptorHeapAllocator::Get();
+    const uint32_t table = descriptors.AllocateTransient(2);
+    const UINT descriptorSize = descriptors.GetIncrementSize();
+    CD3DX12_CPU_DESCRIPTOR_HANDLE cpuHandle = descriptors.GetCpuHandle(table);
 
     // Create SRV for input at slot 0 (t0)
     D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
@@ -141,9 +138,9 @@ void PostProcessPass::Render(
     m_commandList->SetPipelineState(m_pso.Get());
 
     // Set descriptor heap and bind descriptor table
-    ID3D12DescriptorHeap* heaps[] = { m_descriptorHeap.Get() };
+    ID3D12DescriptorHeap* heaps[] = { descriptors.GetHeap().Get() };
     m_commandList->SetDescriptorHeaps(_countof(heaps), heaps);
-    m_commandList->SetComputeRootDescriptorTable(0, m_descriptorHeap->GetGPUDescriptorHandleForHeapStart());
+    m_commandList->SetComputeRootDescriptorTable(0, descriptors.GetGpuHandle(table));
 
     // Bind all post-process params as root constants
     static_assert(sizeof(PostProcessParams) == 4 * sizeof(uint32_t), "PostProcessParams must be exactly 4 floats");
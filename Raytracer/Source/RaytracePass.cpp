@@ -5,6 +5,7 @@
 
 #include "AccelerationStructures.h"
 #include "Constants.h"
+#include "DescriptorHeapAllocator.h"
 #include "DXRHelper.h"
 #include "Renderer.h"
 #include "Shader.h"
@@ -14,6 +15,7 @@
 #include "SceneResources/Primitive.h"
 #include "SceneResources/Scene.h"
 #include "Utils/PassConstants.h"
+#include "Resources/GpuMemoryAllocator.h"
 
 
 // ---------------------------------------------------------------------------
@@ -390,7 +392,7 @@ void RaytracePass::CreateGlobalRootSignature()
     skybox_range.NumDescriptors = 1;
     skybox_range.RegisterSpace = 1;
     skybox_range.RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_SRV;
-    skybox_range.OffsetInDescriptorsFromTableStart = Constants::Graphics::SKYBOX_DESCRIPTOR_INDEX;
+    skybox_range.OffsetInDescriptorsFromTableStart = DescriptorHeapAllocator::Get().GetNamedIndex(DescriptorSlots::SKYBOX);
 
     D3D12_DESCRIPTOR_RANGE ranges[7] = {cbvRange, rtRange, tlasRange, vertex_range, index_range, texture_range, skybox_range};
 
@@ -450,6 +452,8 @@ void RaytracePass::CreateShaderBindingTable()
 
 void RaytracePass::CreateRaytracingOutputBuffer()
 {
+    GpuMemoryAllocator::ScopedTag memoryTag("RaytracePass");
+
     spdlog::debug("Creating raytracing output buffer");
     D3D12_RESOURCE_DESC outputBufferDesc = {};
     outputBufferDesc.DepthOrArraySize = 1;
@@ -462,10 +466,8 @@ void RaytracePass::CreateRaytracingOutputBuffer()
     outputBufferDesc.SampleDesc.Count = 1;
     outputBufferDesc.Flags            = D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS;
 
-    ThrowIfFailed(m_device->CreateCommittedResource(
-        &CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT),
-        D3D12_HEAP_FLAG_NONE,
-        &outputBufferDesc,
+    ThrowIfFailed(GpuMemoryAllocator::Get().CreateResource(
+        outputBufferDesc,
         D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE,
         nullptr,
         IID_PPV_ARGS(&m_outputResource)));
@@ -3,10 +3,12 @@
 #include "Renderer.h"
 
 #include <algorithm>
+#include <chrono>
 #include <crtdbg.h>
 
 #include "Camera.h"
 #include "DDSTextureLoader/DDSTextureLoader12.h"
+#include "DescriptorHeapAllocator.h"
 #include "EditorUI.h"
 #include "FrameAccumulationPass.h"
 #include "StatesManager.h"
@@ -21,9 +23,12 @@
 #include "InputElements.h"
 #include "SceneResources/ModelLoading.h"
 #include "SceneResources/Primitive.h"
+#include "SceneResources/TextureCompression.h"
+#include "SceneResources/TextureDecoding.h"
 #include "RaytracePass.h"
 #include "Techniques/PathTracingPass.h"
 #include "ScreenshotManager.h"
+#include "VxpgSnapshotManager.h"
 #include "VoxelizationPass.h"
 #include "LightInjectionPass.h"
 #include "VBufferPass.h"
@@ -42,6 +47,9 @@
 #include "Shader.h"
 #include "Window.h"
 #include "Resources/ConstantBuffer.h"
+#include "Resources/GpuMemoryAllocator.h"
+#include "Resources/QueueUploadBackend.h"
+#include "Resources/UploadHeapArenaBacking.h"
 #include "Resources/IndexBuffer.h"
 #include "Resources/Texture.h"
 #include "Resources/VertexBuffer.h"
@@ -101,6 +109,8 @@ namespace
     }
 }
 
+static AutoCVarInt g_uploadRingMB("renderer.uploadRingMB", "Staging ring for buffer uploads; larger uploads stream through it in chunks (read at startup)", 64, CVarFlags::None);
+static AutoCVarInt g_textureUploadBatchMB("renderer.textureUploadBatchMB", "Staging memory a texture upload batch may hold before it is submitted early", 512, CVarFlags::None);
 static AutoCVarFloat g_cameraSpeed("renderer.camera.speed", "Specifies the base speed of camera", 1.0f, CVarFlags::EditDrag, 0.1f, 100.0f);
 static AutoCVarFloat g_cameraScrollFactor("renderer.camera.scrollFactor", "Multiplier per scroll tick for camera speed", 1.2f, CVarFlags::EditDrag, 1.01f, 3.0f);
 static AutoCVarFloat g_uvCoordX("renderer.uv.x", "Texture uv x offset", 0.0f, CVarFlags::EditDrag, 0.0f, 1.0f);
@@ -206,11 +216,16 @@ void Renderer::Initialize()
 
 	SetupDeviceAndDebug();
 	CheckTearingSupport();
+
+	g_constantArena = std::make_shared<ConstantArena>(std::make_unique<UploadHeapArenaBacking>(g_device), Constants::Graphics::NUM_FRAMES);
+	GpuMemoryAllocator::Get().Initialize(g_device);
 	
 	if (!CheckRayTracingSupport()) 	throw std::runtime_error("Raytracing is not supported on this device.");;
 	
 	CreateCommandQueue();
 	CreateCommandAllocators();
+	m_uploadScheduler = std::make_unique<UploadScheduler>(std::make_unique<QueueUploadBackend>(g_device, m_d3d12CommandQueue),
+		static_cast<uint64_t>(std::max(g_uploadRingMB.Get(), 1)) * 1024 * 1024);
 	CreateFence();
 	CreateSwapChain();
 	
@@ -230,7 +245,10 @@ void Renderer::Initialize()
 	CreateDescriptorHeaps();
 	CreateWorldProjCBV();
 
-	m_scene = ModelLoading::LoadScene(*this, AssetId("resources/models/abeautifulgame.glb"));
+	{
+		GpuMemoryAllocator::ScopedTag memoryTag("Scene");
+		m_scene = ModelLoading::LoadScene(*this, AssetId("resources/models/abeautifulgame.glb"));
+	}
 	m_statesManager->OnSceneChanged(ExtractModelName(std::string("resources/models/abeautifulgame.glb")));
 
 	CreateVertexSRV();
@@ -272,6 +290,9 @@ void Renderer::Initialize()
 	m_screenshotManager = std::make_shared<ScreenshotManager>();
 	m_screenshotManager->Initialize(g_device, m_d3d12CommandList);
 
+	m_vxpgSnapshotManager = std::make_shared<VxpgSnapshotManager>();
+	m_vxpgSnapshotManager->Initialize(g_device, m_d3d12CommandList);
+
 	m_voxelizationPass = std::make_shared<VoxelizationPass>();
 	m_voxelizationPass->Initialize(g_device, m_d3d12CommandList, m_rootSignature);
 
@@ -318,6 +339,8 @@ void Renderer::Initialize()
 	WireGuidingResources();
 
 	spdlog::info("Renderer initialized successfully.");
+	GpuMemoryAllocator::Get().LogReport();
+	DescriptorHeapAllocator::Get().LogReport();
 
 	LoadSkybox(L"Resources/Textures/qwantani_dusk_2_puresky_2k.dds");
 
@@ -483,10 +506,19 @@ void Renderer::Update(double elapsedTime, double totalTime)
 
 	if (m_scene->IsLightDataDirty())
 	{
-		m_scene->SetLightDataBuffer(CreateStructuredBuffer(m_scene->GetLightDataCPU()));
+		// Edits that keep the light count only rewrite the existing buffer.
+		const auto& lights = m_scene->GetLightDataCPU();
+		const auto lightBuffer = m_scene->GetLightDataBuffer();
+		if (lightBuffer && !lights.empty() && lightBuffer->GetElementsCount() == lights.size())
+			UpdateStructuredBuffer(*lightBuffer, lights);
+		else
+			m_scene->SetLightDataBuffer(CreateStructuredBuffer(lights));
 		m_scene->ClearLightDataDirty();
 	}
 
+	// Node edits since last frame (raster matrices only; the TLAS is built at load).
+	m_scene->UpdateTransforms();
+
 	// Camera change detection for accumulation reset. Skipped in headless: the
 	// camera only changes between captures (GoToState), and ArmScreenshot owns the
 	// reset — letting this fire would cancel the pending capture in Tick.
@@ -582,12 +614,12 @@ void Renderer::Render(double elapsedTime, double totalTime)
 
 		for (const auto& go : m_scene->GetGameObjects())
 		{
-			auto gpuAddress = go->m_worldMatrixBuffer->GetUnderlyingResource()->GetGPUVirtualAddress();
+			auto gpuAddress = go->GetWorldMatrixAddress();
 			m_d3d12CommandList->SetGraphicsRootConstantBufferView(1, gpuAddress);
 			
 			for (const auto& primitive : go->GetModel()->GetMeshes())
 			{
-				gpuAddress = primitive->m_material->m_materialBuffer->GetUnderlyingResource()->GetGPUVirtualAddress();
+				gpuAddress = primitive->m_material->m_constants.GetGpuAddress();
 				m_d3d12CommandList->SetGraphicsRootConstantBufferView(2, gpuAddress);
 				
 				auto vertex_view = primitive->GetVertexView();
@@ -643,7 +675,7 @@ void Renderer::Render(double elapsedTime, double totalTime)
 			m_d3d12CommandList->ResourceBarrier(1, &transition2);
 		}
 
-		// Restore main descriptor heap for ImGui (post-process pass may have changed it)
+		// Restore main descriptor heap for ImGui (passes with private heaps may have changed it)
 		ID3D12DescriptorHeap* mainHeaps[] = { m_srvCbvUavDescriptorHeap.Get() };
 		m_d3d12CommandList->SetDescriptorHeaps(_countof(mainHeaps), mainHeaps);
 
@@ -669,6 +701,8 @@ void Renderer::Render(double elapsedTime, double totalTime)
 
 	ThrowIfFailed(m_d3d12CommandList->Close());
 
+	// Buffer uploads recorded this frame (light edits) run ahead of it.
+	m_uploadScheduler->Submit();
 	m_d3d12CommandQueue->ExecuteCommandLists(_countof(commandLists), commandLists);
 	UINT presentFlags = m_tearingSupport ? DXGI_PRESENT_ALLOW_TEARING : 0; // TODO: do not check every time
 
@@ -676,14 +710,19 @@ void Renderer::Render(double elapsedTime, double totalTime)
 
 	FlushCommandQueue();
 	ResetCommandList();
+	g_constantArena->AdvanceFrame();
+	DescriptorHeapAllocator::Get().AdvanceFrame();
 
 	// Map readback buffer and write PNG; GPU is guaranteed done after FlushCommandQueue
 	if (m_screenshotManager->IsCaptureDue())
 		m_screenshotManager->FinishCapture();
+	if (m_vxpgSnapshotManager->IsCaptureDue())
+		m_vxpgSnapshotManager->FinishCapture();
 }
 
 void Renderer::CleanUp()
 {
+	m_uploadScheduler->WaitIdle();
 	FlushCommandQueue();
 
 	m_editorUI->Shutdown();
@@ -1035,17 +1074,18 @@ void Renderer::CreateDSVDescriptorHeap()
 
 void Renderer::CreateDescriptorHeaps()
 {
-	///	|							|						|								|					|					|					|							|
-	///	|	SRV IMGUI TEXTURE (1)	|	CBV MATRICES (1)	|	UAV RAYTRACING OUTPUT (1)	|	SRV TLAS (1)	|	VERTEX SRV (1)	|	INDEX SRV (1)	|	TEXTURES (MAX_TEXTURE)	|
-	///	|							|						|								|					|					|					|							|
-	
-	D3D12_DESCRIPTOR_HEAP_DESC desc;
-	desc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
-	desc.NumDescriptors = Constants::Graphics::NUM_BASE_DESCRIPTORS + Constants::Graphics::MAX_TEXTURES + 15; // +1 skybox, +3 voxel, +1 shadingpoints, +2 superpixel index/center, +2 repVPL/vplPosition, +1 vbuffer, +3 cvis gathered/counter/mask, +2 fuzzy weight/index
-	desc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
-	desc.NodeMask = 0;
-
-	ThrowIfFailed(g_device->CreateDescriptorHeap(&desc, IID_PPV_ARGS(&m_srvCbvUavDescriptorHeap)));
+	///	|					|						|								|					|					|					|							|					|					|
+	///	|	UNUSED (1)		|	CBV MATRICES (1)	|	UAV RAYTRACING OUTPUT (1)	|	SRV TLAS (1)	|	VERTEX SRV (1)	|	INDEX SRV (1)	|	TEXTURES (MAX_TEXTURE)	|	NAMED SLOTS...	|	TRANSIENT RING	|
+	///	|					|						|								|					|					|					|							|					|					|
+
+	auto& descriptors = DescriptorHeapAllocator::Get();
+	descriptors.Initialize(g_device, Constants::Graphics::NUM_PERSISTENT_DESCRIPTORS, Constants::Graphics::NUM_TRANSIENT_DESCRIPTORS);
+	m_srvCbvUavDescriptorHeap = descriptors.GetHeap();
+
+	// Registered first, so root signatures can keep addressing the scene table at 1..5 and the texture table at 6.
+	const uint32_t sceneTable = descriptors.GetNamedIndex(DescriptorSlots::SCENE_TABLE);
+	const uint32_t textureTable = descriptors.GetTextureTableIndex();
+	assert(sceneTable == 0 && textureTable == Constants::Graphics::NUM_BASE_DESCRIPTORS && "Scene and texture tables must lead the heap");
 }
 
 void Renderer::CreateWorldProjCBV()
@@ -1126,13 +1166,13 @@ void Renderer::CreateRasterizationRootSignature()
 	textureRange.RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_SRV;
 	textureRange.OffsetInDescriptorsFromTableStart = 6;
 
-	// u1 = occupancy, u2 = packed irradiance, u3 = vpl count (contiguous heap slots 519..521)
+	// u1 = occupancy, u2 = packed irradiance, u3 = vpl count (contiguous "Voxel Grid" slots)
 	D3D12_DESCRIPTOR_RANGE voxelOccupancyRange;
 	voxelOccupancyRange.BaseShaderRegister = 1;
 	voxelOccupancyRange.NumDescriptors = 3;
 	voxelOccupancyRange.RegisterSpace = 0;
 	voxelOccupancyRange.RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_UAV;
-	voxelOccupancyRange.OffsetInDescriptorsFromTableStart = Constants::Graphics::VOXEL_OCCUPANCY_DESCRIPTOR_INDEX;
+	voxelOccupancyRange.OffsetInDescriptorsFromTableStart = DescriptorHeapAllocator::Get().GetNamedIndex(DescriptorSlots::VOXEL_GRID);
 
 	// u4 = ShadingPoints G-buffer (debug overlay reads it by screen pixel)
 	D3D12_DESCRIPTOR_RANGE shadingPointsRange;
@@ -1140,7 +1180,7 @@ void Renderer::CreateRasterizationRootSignature()
 	shadingPointsRange.NumDescriptors = 1;
 	shadingPointsRange.RegisterSpace = 0;
 	shadingPointsRange.RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_UAV;
-	shadingPointsRange.OffsetInDescriptorsFromTableStart = Constants::Graphics::SHADINGPOINTS_DESCRIPTOR_INDEX;
+	shadingPointsRange.OffsetInDescriptorsFromTableStart = DescriptorHeapAllocator::Get().GetNamedIndex(DescriptorSlots::SHADING_POINTS);
 
 	// u7 = superpixel index, u8 = superpixel representative center (debug views 15/16)
 	D3D12_DESCRIPTOR_RANGE superpixelRange;
@@ -1148,7 +1188,7 @@ void Renderer::CreateRasterizationRootSignature()
 	superpixelRange.NumDescriptors = 2;
 	superpixelRange.RegisterSpace = 0;
 	superpixelRange.RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_UAV;
-	superpixelRange.OffsetInDescriptorsFromTableStart = Constants::Graphics::SUPERPIXEL_INDEX_DESCRIPTOR_INDEX;
+	superpixelRange.OffsetInDescriptorsFromTableStart = DescriptorHeapAllocator::Get().GetNamedIndex(DescriptorSlots::SUPERPIXELS);
 
 	D3D12_DESCRIPTOR_RANGE ranges[] = {cbvRange, rtRange, tlasRange, vertexRange, indexRange, textureRange, voxelOccupancyRange, shadingPointsRange, superpixelRange};
 
@@ -1334,11 +1374,10 @@ bool Renderer::CheckRayTracingSupport() const
 	return true;
 }
 
-void Renderer::CreateTextureSRV(const std::shared_ptr<Texture>& texture)
+void Renderer::CreateTextureSRV(const std::shared_ptr<Texture>& texture, UINT componentMapping)
 {
 	assert(texture && "Passed texture cannot be null!");
 	assert(texture->GetUnderlyingResource() && "Texture resources cannot be null!");
-	assert(texture->GetTextureIndex() < Constants::Graphics::MAX_TEXTURES && "Texture index exceeds maximum number of textures supported!");
 
 	spdlog::debug("Setting up texture SRV");
 
@@ -1359,10 +1398,10 @@ void Renderer::CreateTextureSRV(const std::shared_ptr<Texture>& texture)
 		// TODO: In case that texture is a TEXTURE 2D ARRAY
 	}
 	srv_desc.Format = desc.Format;
-	srv_desc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+	srv_desc.Shader4ComponentMapping = componentMapping;
 
-	auto handle = CD3DX12_CPU_DESCRIPTOR_HANDLE(m_srvCbvUavDescriptorHeap->GetCPUDescriptorHandleForHeapStart());
-	handle.Offset(6 + texture->GetTextureIndex(),  g_device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV));
+	auto& descriptors = DescriptorHeapAllocator::Get();
+	auto handle = descriptors.GetCpuHandle(descriptors.GetTextureTableIndex() + texture->GetTextureIndex());
 
 	g_device->CreateShaderResourceView(resource.Get(), &srv_desc, handle);
 }
@@ -1443,8 +1482,18 @@ void Renderer::LoadScene(const std::wstring& path)
 	WideCharToMultiByte(CP_UTF8, 0, path.c_str(), -1, pathUtf8, sizeof(pathUtf8), nullptr, nullptr);
 	spdlog::info("Scene has been changed. Loading: {}", pathUtf8);
 
-	g_textureIndex = 0;
-	m_scene = ModelLoading::LoadScene(*this, AssetId(pathUtf8));
+	{
+		GpuMemoryAllocator::ScopedTag memoryTag("Scene");
+		m_scene = ModelLoading::LoadScene(*this, AssetId(pathUtf8));
+	}
+
+	const ConstantArena::Stats arenaStats = g_constantArena->GetStats();
+	spdlog::info("Constant arena: {} allocation(s), {} KiB live in {} page(s) ({} KiB), {} awaiting frame retirement",
+		arenaStats.liveAllocations, arenaStats.liveBytes / 1024, arenaStats.pageCount, arenaStats.pageBytes / 1024, arenaStats.pendingFrees);
+	const UploadScheduler::Stats uploadStats = m_uploadScheduler->GetStats();
+	spdlog::info("Buffer uploads: {} upload(s), {} MiB as {} copies in {} submission(s), {} stall(s) on a full ring; ring peak {} / {} MiB",
+		uploadStats.uploads, uploadStats.bytes / (1024 * 1024), uploadStats.copies, uploadStats.submissions, uploadStats.stalls,
+		uploadStats.ringPeak / (1024 * 1024), uploadStats.ringCapacity / (1024 * 1024));
 
 	CreateVertexSRV();
 	CreateIndexSRV();
@@ -1462,6 +1511,9 @@ void Renderer::LoadScene(const std::wstring& path)
 		m_statesManager->OnSceneChanged(ExtractModelName(path));
 	if (m_voxelizationPass)
 		m_voxelizationPass->OnSceneLoaded(*m_scene);
+
+	GpuMemoryAllocator::Get().LogReport();
+	DescriptorHeapAllocator::Get().LogReport();
 }
 
 void Renderer::SetTechniqueByIndex(int index)
@@ -1526,6 +1578,16 @@ bool Renderer::ScreenshotIdle() const
 	return m_screenshotManager->IsIdle();
 }
 
+void Renderer::ArmVxpgSnapshot(const std::string& path)
+{
+	m_vxpgSnapshotManager->Arm(path);
+}
+
+bool Renderer::VxpgSnapshotIdle() const
+{
+	return m_vxpgSnapshotManager->IsIdle();
+}
+
 void Renderer::ApplyRenderConfig(const HeadlessConfig& config)
 {
 	g_numSamplesPerPixel.Set(static_cast<int32_t>(config.spp));
@@ -1678,6 +1740,21 @@ void Renderer::RunVxpgPipelineUpTo(VxpgStage stage)
 		m_lightTreePass->Run();
 	}
 
+	// Snapshot before the reuse clear below wipes the injection accumulators.
+	if (m_vxpgSnapshotManager->IsCaptureDue())
+	{
+		VxpgSnapshotManager::Sources sources;
+		sources.voxelization      = m_voxelizationPass.get();
+		sources.lightInjection    = m_lightInjectionPass.get();
+		sources.guidingBuild      = m_voxelGuidingBuildPass.get();
+		sources.fingerprint       = m_fingerprintPass.get();
+		sources.cluster           = m_clusterPass.get();
+		sources.superpixel        = m_superpixelBuildPass.get();
+		sources.clusterVisibility = m_clusterVisibilityPass.get();
+		sources.lightTree         = m_lightTreePass.get();
+		m_vxpgSnapshotManager->RecordCopies(sources, stage, m_passConstants->data.frameIndex);
+	}
+
 	// Reuse config (ADR 0009): the build above consumed last frame's VPL data;
 	// wipe the accumulators now so the guided GI raygen refills them fresh.
 	if (reuseGiVpl)
@@ -1692,18 +1769,11 @@ void Renderer::WriteVoxelUavsToGlobalHeap()
 	if (!m_voxelizationPass)
 		return;
 
-	auto descSize = g_device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
-	D3D12_CPU_DESCRIPTOR_HANDLE heapStart = m_srvCbvUavDescriptorHeap->GetCPUDescriptorHandleForHeapStart();
-
-	D3D12_CPU_DESCRIPTOR_HANDLE slot = heapStart;
-	slot.ptr = heapStart.ptr + static_cast<SIZE_T>(Constants::Graphics::VOXEL_OCCUPANCY_DESCRIPTOR_INDEX) * descSize;
-	m_voxelizationPass->WriteOccupancyUavTo(slot);
-
-	slot.ptr = heapStart.ptr + static_cast<SIZE_T>(Constants::Graphics::VOXEL_IRRADIANCE_DESCRIPTOR_INDEX) * descSize;
-	m_voxelizationPass->WriteIrradianceUavTo(slot);
-
-	slot.ptr = heapStart.ptr + static_cast<SIZE_T>(Constants::Graphics::VOXEL_VPL_COUNT_DESCRIPTOR_INDEX) * descSize;
-	m_voxelizationPass->WriteVplCountUavTo(slot);
+	auto& descriptors = DescriptorHeapAllocator::Get();
+	using namespace DescriptorSlots;
+	m_voxelizationPass->WriteOccupancyUavTo(descriptors.GetCpuHandle(descriptors.GetNamedIndex(VOXEL_GRID, VOXEL_GRID_OCCUPANCY)));
+	m_voxelizationPass->WriteIrradianceUavTo(descriptors.GetCpuHandle(descriptors.GetNamedIndex(VOXEL_GRID, VOXEL_GRID_IRRADIANCE)));
+	m_voxelizationPass->WriteVplCountUavTo(descriptors.GetCpuHandle(descriptors.GetNamedIndex(VOXEL_GRID, VOXEL_GRID_VPL_COUNT)));
 }
 
 void Renderer::WriteSuperpixelUavsToGlobalHeap()
@@ -1711,21 +1781,12 @@ void Renderer::WriteSuperpixelUavsToGlobalHeap()
 	if (!m_superpixelBuildPass)
 		return;
 
-	auto descSize = g_device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
-	D3D12_CPU_DESCRIPTOR_HANDLE heapStart = m_srvCbvUavDescriptorHeap->GetCPUDescriptorHandleForHeapStart();
-
-	D3D12_CPU_DESCRIPTOR_HANDLE slot = heapStart;
-	slot.ptr = heapStart.ptr + static_cast<SIZE_T>(Constants::Graphics::SUPERPIXEL_INDEX_DESCRIPTOR_INDEX) * descSize;
-	m_superpixelBuildPass->WriteIndexUavTo(slot);
-
-	slot.ptr = heapStart.ptr + static_cast<SIZE_T>(Constants::Graphics::SUPERPIXEL_CENTER_DESCRIPTOR_INDEX) * descSize;
-	m_superpixelBuildPass->WriteCenterUavTo(slot);
-
-	slot.ptr = heapStart.ptr + static_cast<SIZE_T>(Constants::Graphics::FUZZY_WEIGHT_DESCRIPTOR_INDEX) * descSize;
-	m_superpixelBuildPass->WriteFuzzyWeightUavTo(slot);
-
-	slot.ptr = heapStart.ptr + static_cast<SIZE_T>(Constants::Graphics::FUZZY_INDEX_DESCRIPTOR_INDEX) * descSize;
-	m_superpixelBuildPass->WriteFuzzyIndexUavTo(slot);
+	auto& descriptors = DescriptorHeapAllocator::Get();
+	using namespace DescriptorSlots;
+	m_superpixelBuildPass->WriteIndexUavTo(descriptors.GetCpuHandle(descriptors.GetNamedIndex(SUPERPIXELS, SUPERPIXELS_INDEX)));
+	m_superpixelBuildPass->WriteCenterUavTo(descriptors.GetCpuHandle(descriptors.GetNamedIndex(SUPERPIXELS, SUPERPIXELS_CENTER)));
+	m_superpixelBuildPass->WriteFuzzyWeightUavTo(descriptors.GetCpuHandle(descriptors.GetNamedIndex(FUZZY_WEIGHT)));
+	m_superpixelBuildPass->WriteFuzzyIndexUavTo(descriptors.GetCpuHandle(descriptors.GetNamedIndex(FUZZY_INDEX)));
 }
 
 void Renderer::WriteClusterVisibilityUavsToGlobalHeap()
@@ -1733,25 +1794,22 @@ void Renderer::WriteClusterVisibilityUavsToGlobalHeap()
 	if (!m_clusterVisibilityPass || !m_superpixelBuildPass)
 		return;
 
-	auto descSize = g_device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
-	D3D12_CPU_DESCRIPTOR_HANDLE heapStart = m_srvCbvUavDescriptorHeap->GetCPUDescriptorHandleForHeapStart();
+	auto& descriptors = DescriptorHeapAllocator::Get();
 
-	auto writeUav = [&](int index, ID3D12Resource* res, DXGI_FORMAT fmt)
+	auto writeUav = [&](const NamedDescriptorSlot& slot, ID3D12Resource* res, DXGI_FORMAT fmt)
 	{
 		if (!res) return;
-		D3D12_CPU_DESCRIPTOR_HANDLE slot = heapStart;
-		slot.ptr = heapStart.ptr + static_cast<SIZE_T>(index) * descSize;
 		D3D12_UNORDERED_ACCESS_VIEW_DESC uav = {};
 		uav.Format        = fmt;
 		uav.ViewDimension = D3D12_UAV_DIMENSION_TEXTURE2D;
-		g_device->CreateUnorderedAccessView(res, nullptr, &uav, slot);
+		g_device->CreateUnorderedAccessView(res, nullptr, &uav, descriptors.GetCpuHandle(descriptors.GetNamedIndex(slot)));
 	};
 
-	writeUav(Constants::Graphics::SPIXEL_GATHERED_DESCRIPTOR_INDEX,
+	writeUav(DescriptorSlots::SUPERPIXEL_GATHERED,
 		m_superpixelBuildPass->GetGatheredResource(), DXGI_FORMAT_R32G32_SINT);
-	writeUav(Constants::Graphics::SPIXEL_COUNTER_DESCRIPTOR_INDEX,
+	writeUav(DescriptorSlots::SUPERPIXEL_COUNTER,
 		m_superpixelBuildPass->GetCounterResource(), DXGI_FORMAT_R32_UINT);
-	writeUav(Constants::Graphics::CLUSTER_VISIBILITY_MASK_DESCRIPTOR_INDEX,
+	writeUav(DescriptorSlots::CLUSTER_VISIBILITY_MASK,
 		m_clusterVisibilityPass->GetMaskResource(), DXGI_FORMAT_R32_UINT);
 }
 
@@ -1798,7 +1856,7 @@ void Renderer::LoadSkybox(const std::wstring& path)
 		m_d3d12CommandList->ResourceBarrier(1, &barrier);
 	}
 
-	// Create SRV at SKYBOX_DESCRIPTOR_INDEX
+	// Create SRV in the "Skybox" slot
 	auto desc = textureResource->GetDesc();
 	D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
 	srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
@@ -1807,10 +1865,8 @@ void Renderer::LoadSkybox(const std::wstring& path)
 	srvDesc.Texture2D.MostDetailedMip = 0;
 	srvDesc.Texture2D.MipLevels = desc.MipLevels;
 
-	UINT descriptorSize = g_device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
-	CD3DX12_CPU_DESCRIPTOR_HANDLE srvHandle(
-		m_srvCbvUavDescriptorHeap->GetCPUDescriptorHandleForHeapStart(),
-		Constants::Graphics::SKYBOX_DESCRIPTOR_INDEX, descriptorSize);
+	auto& descriptors = DescriptorHeapAllocator::Get();
+	CD3DX12_CPU_DESCRIPTOR_HANDLE srvHandle = descriptors.GetCpuHandle(descriptors.GetNamedIndex(DescriptorSlots::SKYBOX));
 
 	g_device->CreateShaderResourceView(textureResource.Get(), &srvDesc, srvHandle);
 
@@ -1827,6 +1883,7 @@ void Renderer::OnShaderReload()
 	
 	ThrowIfFailed(m_d3d12CommandList->Close());
 	ID3D12CommandList* commandLists[] = { m_d3d12CommandList.Get() };
+	m_uploadScheduler->Submit();
 	m_d3d12CommandQueue->ExecuteCommandLists(_countof(commandLists), commandLists);
 
 	FlushCommandQueue();
@@ -1901,49 +1958,138 @@ void Renderer::ToggleRasterization()
 
 std::pair<std::shared_ptr<VertexBuffer>, std::shared_ptr<IndexBuffer>> Renderer::CreateSceneResources(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices)
 {
-	ComPtr<ID3D12Resource> vertex_upload_buffer;
-	ComPtr<ID3D12Resource> index_upload_buffer;
+	return CreateSceneResources(vertices.data(), vertices.size(), indices.data(), indices.size());
+}
 
-	auto cpuVertex = static_cast<BYTE*>(malloc(vertices.size() * sizeof(Vertex)));
-	auto cpuIndex = static_cast<BYTE*>(malloc(indices.size() * sizeof(uint32_t)));
-	memcpy(cpuVertex, vertices.data(), vertices.size() * sizeof(Vertex));
-	memcpy(cpuIndex, indices.data(), indices.size() * sizeof(uint32_t));
-	
-	auto vertex_buffer_resource = RenderingUtils::CreateDefaultBuffer(g_device.Get(), m_d3d12CommandList.Get(), cpuVertex, vertices.size() * sizeof(Vertex), vertex_upload_buffer);
-	auto index_buffer_resource = RenderingUtils::CreateDefaultBuffer(g_device.Get(), m_d3d12CommandList.Get(), cpuIndex, indices.size() * sizeof(uint32_t), index_upload_buffer);
-	
-	// Need to be closed and executed to create buffers before the upload buffers go out of scope.
-	ExecuteCommandsAndReset();
+// Source arrays are only read while staging the upload, so a mapped scene
+// cache can be passed straight through.
+std::pair<std::shared_ptr<VertexBuffer>, std::shared_ptr<IndexBuffer>> Renderer::CreateSceneResources(const Vertex* vertices, size_t vertexCount, const uint32_t* indices, size_t indexCount)
+{
+	const UINT64 vertexBytes = vertexCount * sizeof(Vertex);
+	const UINT64 indexBytes = indexCount * sizeof(uint32_t);
+	auto vertex_buffer_resource = CreateUploadedBuffer(vertices, vertexBytes, vertexBytes);
+	auto index_buffer_resource = CreateUploadedBuffer(indices, indexBytes, indexBytes);
 
-	auto vertex_buffer = std::make_shared<VertexBuffer>(g_device, vertex_buffer_resource, static_cast<UINT>(vertices.size()), sizeof(Vertex));
-	auto index_buffer = std::make_shared<IndexBuffer>(g_device, index_buffer_resource, static_cast<UINT>(indices.size()), DXGI_FORMAT_R32_UINT);
-	
-	AssertFreeClear(&cpuVertex);
-	AssertFreeClear(&cpuIndex);
+	auto vertex_buffer = std::make_shared<VertexBuffer>(g_device, vertex_buffer_resource, static_cast<UINT>(vertexCount), sizeof(Vertex));
+	auto index_buffer = std::make_shared<IndexBuffer>(g_device, index_buffer_resource, static_cast<UINT>(indexCount), DXGI_FORMAT_R32_UINT);
 	
 	return std::make_pair(vertex_buffer, index_buffer);
 }
 
-std::shared_ptr<Texture> Renderer::CreateTextureFromGLTF(const tinygltf::Image& image)
+ComPtr<ID3D12Resource> Renderer::CreateUploadedBuffer(const void* data, UINT64 dataSize, UINT64 bufferSize)
 {
+	// The copy overwrites all of it, so it may reuse freed heap memory. Buffers
+	// start in COMMON and are promoted to COPY_DEST by the copy itself.
+	ComPtr<ID3D12Resource> buffer;
+	ThrowIfFailed(GpuMemoryAllocator::Get().CreateResource(
+		CD3DX12_RESOURCE_DESC::Buffer(bufferSize),
+		D3D12_RESOURCE_STATE_COMMON,
+		nullptr,
+		IID_PPV_ARGS(&buffer),
+		false));
+
+	m_uploadScheduler->Enqueue(buffer.Get(), 0, data, dataSize);
+	if (bufferSize > dataSize)
+		m_uploadScheduler->Enqueue(buffer.Get(), dataSize, nullptr, bufferSize - dataSize);
+	return buffer;
+}
+
+std::shared_ptr<Texture> Renderer::CreateTextureFromGLTF(const tinygltf::Image& image, TextureProcessing::TextureUsage usage)
+{
+	return CreateTexture(image.image.data(), image.width, image.height, image.component, usage);
+}
+
+std::shared_ptr<Texture> Renderer::CreateTexture(const uint8_t* pixels, int width, int height, int components, TextureProcessing::TextureUsage usage)
+{
+	GpuMemoryAllocator::ScopedTag memoryTag("Scene textures");
 	ComPtr<ID3D12Resource> upload_buffer;
+	ComPtr<ID3D12Resource> texture_resource;
 
-	auto texture_resource = RenderingUtils::CreateDefaultTexture(g_device.Get(), m_d3d12CommandList.Get(), image, upload_buffer);
+	if (TextureCompression::IsEnabled())
+	{
+		std::vector<uint8_t> rgba;
+		const uint8_t* texels = pixels;
+		if (components != 4 && TextureDecoding::ExpandToRgba8(pixels, width, height, components, rgba))
+			texels = rgba.data();
+
+		const std::vector<uint8_t> dds = components == 4 || !rgba.empty()
+			? TextureCompression::GetOrEncodeDds(texels, width, height, usage)
+			: std::vector<uint8_t>();
+		if (!dds.empty())
+			texture_resource = RenderingUtils::CreateDefaultTextureFromDds(g_device.Get(), m_d3d12CommandList.Get(), dds.data(), dds.size(), upload_buffer);
+	}
+	if (!texture_resource)
+		texture_resource = RenderingUtils::CreateDefaultTexture(g_device.Get(), m_d3d12CommandList.Get(), pixels, width, height, components, upload_buffer);
 
 	std::shared_ptr<Texture> texture = std::make_shared<Texture>(g_device, texture_resource);
-	CreateTextureSRV(texture);
-
-	m_d3d12CommandList->Close();
-	ID3D12CommandList* commandLists[] = { m_d3d12CommandList.Get() };
-	m_d3d12CommandQueue->ExecuteCommandLists(_countof(commandLists), commandLists);
-	FlushCommandQueue();
-	ResetCommandList();
+	// BC5 metallic-roughness holds roughness/metallic in R/G; the view moves
+	// them back to G/B, where the shaders read glTF's layout.
+	const auto format = static_cast<TextureProcessing::TextureFormat>(texture_resource->GetDesc().Format);
+	CreateTextureSRV(texture, TextureProcessing::StoresMetallicRoughnessInRG(usage, format)
+		? D3D12_ENCODE_SHADER_4_COMPONENT_MAPPING(
+			D3D12_SHADER_COMPONENT_MAPPING_FORCE_VALUE_0,
+			D3D12_SHADER_COMPONENT_MAPPING_FROM_MEMORY_COMPONENT_0,
+			D3D12_SHADER_COMPONENT_MAPPING_FROM_MEMORY_COMPONENT_1,
+			D3D12_SHADER_COMPONENT_MAPPING_FORCE_VALUE_1)
+		: D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING);
+
+	if (m_batchingTextureUploads)
+	{
+		m_pendingTextureUploadBytes += upload_buffer->GetDesc().Width;
+		m_pendingTextureUploads.push_back(std::move(upload_buffer));
+		++m_batchedTextureCount;
+		if (m_pendingTextureUploadBytes >= static_cast<UINT64>(std::max(g_textureUploadBatchMB.Get(), 1)) * 1024 * 1024)
+			SubmitTextureUploads();
+	}
+	else
+	{
+		m_d3d12CommandList->Close();
+		ID3D12CommandList* commandLists[] = { m_d3d12CommandList.Get() };
+		m_uploadScheduler->Submit();
+		m_d3d12CommandQueue->ExecuteCommandLists(_countof(commandLists), commandLists);
+		FlushCommandQueue();
+		ResetCommandList();
+	}
 
 	m_textures.push_back(texture);
 	
 	return texture;
 }
 
+void Renderer::BeginTextureUploads()
+{
+	assert(!m_batchingTextureUploads && "Texture upload batches do not nest");
+	m_batchingTextureUploads = true;
+	m_batchedTextureCount = 0;
+	m_textureUploadSubmissions = 0;
+}
+
+void Renderer::EndTextureUploads()
+{
+	assert(m_batchingTextureUploads && "EndTextureUploads without BeginTextureUploads");
+	const auto start = std::chrono::high_resolution_clock::now();
+	SubmitTextureUploads();
+	m_batchingTextureUploads = false;
+
+	if (m_batchedTextureCount > 0)
+	{
+		spdlog::info("Uploaded {} texture(s) in {} submission(s); final submission took {:.1f} ms",
+			m_batchedTextureCount, m_textureUploadSubmissions,
+			std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count());
+	}
+}
+
+void Renderer::SubmitTextureUploads()
+{
+	if (m_pendingTextureUploads.empty())
+		return;
+
+	ExecuteCommandsAndReset();
+	m_pendingTextureUploads.clear();
+	m_pendingTextureUploadBytes = 0;
+	++m_textureUploadSubmissions;
+}
+
 ComPtr<IDXGIAdapter4> Renderer::GetHardwareAdapter(bool useWarp)
 {
 	ComPtr<IDXGIAdapter1> adapter1;
@@ -2013,21 +2159,8 @@ ComPtr<ID3D12Device5> Renderer::GetDeviceForAdapter(ComPtr<IDXGIAdapter1> adapte
 
 std::shared_ptr<GameObject> Renderer::InstantiateGameObject()
 {
-	ComPtr<ID3D12Resource> buffer;
-	
-	g_device->CreateCommittedResource(
-	&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD),
-	D3D12_HEAP_FLAG_NONE,
-	&CD3DX12_RESOURCE_DESC::Buffer(256),
-	D3D12_RESOURCE_STATE_GENERIC_READ,
-	nullptr,
-	IID_PPV_ARGS(&buffer));
-
-	auto constantBuffer = std::make_shared<ConstantBuffer>(g_device, buffer);
-	constantBuffer->SetResourceName(L"Model CBV Resource");
-
 	auto game_object = std::make_shared<GameObject>();
-	game_object->m_worldMatrixBuffer = constantBuffer;
+	game_object->m_worldMatrixConstants = g_constantArena->Allocate(2 * sizeof(DirectX::XMFLOAT4X4));
 
 	auto matrix = DirectX::XMMatrixIdentity();
 	DirectX::XMFLOAT4X4 modelWorldMatrix;
@@ -2041,6 +2174,8 @@ void Renderer::ExecuteCommandsAndReset()
 {
 	ThrowIfFailed(m_d3d12CommandList->Close());
 	ID3D12CommandList* commandLists[] = { m_d3d12CommandList.Get() };
+	// Pending buffer uploads go first: the list may already use their destinations.
+	m_uploadScheduler->Submit();
 	m_d3d12CommandQueue->ExecuteCommandLists(_countof(commandLists), commandLists);
 	FlushCommandQueue();
 	// WHY is resetting the allocator impossible if:
@@ -0,0 +1,154 @@
+#include "Resources/ConstantArena.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+ConstantAllocation::~ConstantAllocation()
+{
+    Release();
+}
+
+ConstantAllocation::ConstantAllocation(ConstantAllocation&& other) noexcept
+{
+    *this = std::move(other);
+}
+
+ConstantAllocation& ConstantAllocation::operator=(ConstantAllocation&& other) noexcept
+{
+    if (this != &other)
+    {
+        Release();
+        m_arena = std::move(other.m_arena);
+        m_cpu = other.m_cpu;
+        m_gpu = other.m_gpu;
+        m_size = other.m_size;
+        m_stride = other.m_stride;
+        m_version = other.m_version;
+        m_lastWriteFrame = other.m_lastWriteFrame;
+        other.m_cpu = nullptr;
+        other.m_gpu = 0;
+        other.m_size = 0;
+        other.m_stride = 0;
+    }
+    return *this;
+}
+
+void ConstantAllocation::Write(const void* data, size_t bytes)
+{
+    assert(IsValid() && "Writing an empty constant allocation");
+    assert(bytes == m_size && "Constant writes replace the whole allocation");
+
+    const uint64_t frame = m_arena->GetCurrentFrame();
+    if (frame != m_lastWriteFrame)
+    {
+        m_version = (m_version + 1) % m_arena->GetFrameCount();
+        m_lastWriteFrame = frame;
+    }
+    memcpy(m_cpu + static_cast<size_t>(m_version) * m_stride, data, bytes);
+}
+
+void ConstantAllocation::Release()
+{
+    if (!m_arena)
+        return;
+    m_arena->Free({ m_cpu, m_gpu }, m_stride);
+    m_arena.reset();
+}
+
+ConstantArena::ConstantArena(std::unique_ptr<ConstantArenaBacking> backing, uint32_t frameCount, size_t pageSize)
+    : m_backing(std::move(backing)),
+      m_frameCount(std::max(frameCount, 1u)),
+      m_pageSize((std::max(pageSize, SLOT_ALIGNMENT) + SLOT_ALIGNMENT - 1) / SLOT_ALIGNMENT * SLOT_ALIGNMENT)
+{
+    assert(m_backing && "ConstantArena needs a page backing");
+}
+
+ConstantAllocation ConstantArena::Allocate(size_t bytes)
+{
+    const uint32_t units = static_cast<uint32_t>((std::max<size_t>(bytes, 1) + SLOT_ALIGNMENT - 1) / SLOT_ALIGNMENT);
+    const uint32_t stride = units * static_cast<uint32_t>(SLOT_ALIGNMENT);
+    const size_t slotBytes = static_cast<size_t>(stride) * m_frameCount;
+
+    Slot slot{};
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        if (units < m_freeSlots.size() && !m_freeSlots[units].empty())
+        {
+            slot = m_freeSlots[units].back();
+            m_freeSlots[units].pop_back();
+        }
+        else
+        {
+            // The tail of the current page is abandoned rather than split: slot
+            // sizes are few (world matrices, materials) and refill the free lists.
+            if (m_currentPageUsed + slotBytes > m_currentPageSize)
+            {
+                const size_t pageBytes = std::max(m_pageSize, slotBytes);
+                m_currentPage = m_backing->AllocatePage(pageBytes);
+                assert(m_currentPage.cpu && "ConstantArenaBacking returned no memory");
+                assert(m_currentPage.gpu % SLOT_ALIGNMENT == 0 && "Constant page is not CBV-aligned");
+                m_currentPageUsed = 0;
+                m_currentPageSize = pageBytes;
+                ++m_pageCount;
+                m_pageBytes += pageBytes;
+            }
+            slot = { m_currentPage.cpu + m_currentPageUsed, m_currentPage.gpu + m_currentPageUsed };
+            m_currentPageUsed += slotBytes;
+        }
+
+        ++m_liveAllocations;
+        m_liveBytes += slotBytes;
+    }
+
+    // Zeroed so a binding made before the first write reads defined data.
+    memset(slot.cpu, 0, slotBytes);
+
+    ConstantAllocation allocation;
+    allocation.m_arena = shared_from_this();
+    allocation.m_cpu = slot.cpu;
+    allocation.m_gpu = slot.gpu;
+    allocation.m_size = static_cast<uint32_t>(bytes);
+    allocation.m_stride = stride;
+    return allocation;
+}
+
+void ConstantArena::Free(const Slot& slot, uint32_t stride)
+{
+    const uint32_t units = stride / static_cast<uint32_t>(SLOT_ALIGNMENT);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_pendingFrees.push_back({ slot, units, GetCurrentFrame() });
+    --m_liveAllocations;
+    m_liveBytes -= static_cast<size_t>(stride) * m_frameCount;
+}
+
+void ConstantArena::AdvanceFrame()
+{
+    const uint64_t frame = m_frame.fetch_add(1, std::memory_order_relaxed) + 1;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    // A slot freed during frame f may be read by frames up to f.
+    auto retired = std::partition(m_pendingFrees.begin(), m_pendingFrees.end(),
+        [&](const PendingFree& pending) { return pending.retireFrame + m_frameCount > frame; });
+    for (auto it = retired; it != m_pendingFrees.end(); ++it)
+    {
+        if (it->units >= m_freeSlots.size())
+            m_freeSlots.resize(it->units + 1);
+        m_freeSlots[it->units].push_back(it->slot);
+    }
+    m_pendingFrees.erase(retired, m_pendingFrees.end());
+}
+
+ConstantArena::Stats ConstantArena::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Stats stats;
+    stats.pageCount = m_pageCount;
+    stats.pageBytes = m_pageBytes;
+    stats.liveAllocations = m_liveAllocations;
+    stats.liveBytes = m_liveBytes;
+    stats.pendingFrees = m_pendingFrees.size();
+    return stats;
+}
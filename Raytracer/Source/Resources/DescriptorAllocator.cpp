@@ -0,0 +1,301 @@
+#include "Resources/DescriptorAllocator.h"
+
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+
+DescriptorRangeAllocator::DescriptorRangeAllocator(uint32_t base, uint32_t capacity)
+    : m_base(base),
+      m_capacity(capacity)
+{
+    if (m_capacity > 0)
+        InsertFree(m_base, m_capacity);
+}
+
+void DescriptorRangeAllocator::InsertFree(uint32_t offset, uint32_t count)
+{
+    m_freeByOffset.emplace(offset, count);
+    m_freeBySize.emplace(count, offset);
+}
+
+void DescriptorRangeAllocator::EraseFree(std::map<uint32_t, uint32_t>::iterator it)
+{
+    m_freeBySize.erase({ it->second, it->first });
+    m_freeByOffset.erase(it);
+}
+
+// Splits and merges re-key the existing nodes instead of allocating new ones;
+// node churn dominated the cost of both operations.
+void DescriptorRangeAllocator::ResizeFree(std::map<uint32_t, uint32_t>::iterator it, uint32_t offset, uint32_t count)
+{
+    auto sizeNode = m_freeBySize.extract({ it->second, it->first });
+    sizeNode.value() = { count, offset };
+    m_freeBySize.insert(std::move(sizeNode));
+
+    if (it->first == offset)
+    {
+        it->second = count;
+        return;
+    }
+    auto offsetNode = m_freeByOffset.extract(it);
+    offsetNode.key() = offset;
+    offsetNode.mapped() = count;
+    m_freeByOffset.insert(std::move(offsetNode));
+}
+
+uint32_t DescriptorRangeAllocator::Allocate(uint32_t count)
+{
+    assert(count > 0 && "Empty descriptor range");
+
+    // Smallest free range that fits, lowest offset among equals.
+    const auto fit = m_freeBySize.lower_bound({ count, 0 });
+    if (fit == m_freeBySize.end())
+        return INVALID;
+
+    const uint32_t size = fit->first;
+    const uint32_t offset = fit->second;
+    const auto it = m_freeByOffset.find(offset);
+    if (size > count)
+        ResizeFree(it, offset + count, size - count);
+    else
+        EraseFree(it);
+
+    m_used += count;
+    ++m_allocationCount;
+    return offset;
+}
+
+void DescriptorRangeAllocator::Free(uint32_t offset, uint32_t count)
+{
+    assert(count > 0 && offset >= m_base && offset + count <= m_base + m_capacity && "Descriptor range outside the allocator");
+    m_used -= count;
+    --m_allocationCount;
+
+    const auto next = m_freeByOffset.lower_bound(offset);
+    const auto prev = next != m_freeByOffset.begin() ? std::prev(next) : m_freeByOffset.end();
+    assert((next == m_freeByOffset.end() || offset + count <= next->first) && "Double or overlapping descriptor free");
+    assert((prev == m_freeByOffset.end() || prev->first + prev->second <= offset) && "Double or overlapping descriptor free");
+
+    const bool mergeNext = next != m_freeByOffset.end() && next->first == offset + count;
+    const bool mergePrev = prev != m_freeByOffset.end() && prev->first + prev->second == offset;
+    if (mergePrev && mergeNext)
+    {
+        const uint32_t merged = prev->second + count + next->second;
+        EraseFree(next);
+        ResizeFree(prev, prev->first, merged);
+    }
+    else if (mergePrev)
+        ResizeFree(prev, prev->first, prev->second + count);
+    else if (mergeNext)
+        ResizeFree(next, offset, count + next->second);
+    else
+        InsertFree(offset, count);
+}
+
+DescriptorRangeAllocator::Stats DescriptorRangeAllocator::GetStats() const
+{
+    Stats stats;
+    stats.capacity = m_capacity;
+    stats.used = m_used;
+    stats.allocationCount = m_allocationCount;
+    stats.freeRangeCount = m_freeByOffset.size();
+    stats.largestFree = m_freeBySize.empty() ? 0 : m_freeBySize.rbegin()->first;
+    return stats;
+}
+
+bool DescriptorRangeAllocator::Validate() const
+{
+    if (m_freeByOffset.size() != m_freeBySize.size())
+        return false;
+
+    uint64_t free = 0;
+    uint64_t previousEnd = 0;
+    bool first = true;
+    for (const auto& [offset, count] : m_freeByOffset)
+    {
+        if (count == 0 || offset < m_base || uint64_t(offset) + count > uint64_t(m_base) + m_capacity)
+            return false;
+        // Touching free ranges should have been merged.
+        if (!first && offset <= previousEnd)
+            return false;
+        if (m_freeBySize.count({ count, offset }) == 0)
+            return false;
+        free += count;
+        previousEnd = uint64_t(offset) + count;
+        first = false;
+    }
+    return free + m_used == m_capacity;
+}
+
+DescriptorRing::DescriptorRing(uint32_t base, uint32_t capacity, uint32_t frameCount)
+    : m_base(base),
+      m_capacity(capacity),
+      m_frameCount(std::max(frameCount, 1u))
+{
+}
+
+uint32_t DescriptorRing::Allocate(uint32_t count)
+{
+    assert(count > 0 && "Empty descriptor table");
+    if (count > m_capacity)
+        return INVALID;
+
+    uint64_t start = m_head;
+    const uint64_t slot = start % m_capacity;
+    if (slot + count > m_capacity)
+    {
+        start += m_capacity - slot;
+        // Nothing in flight: the skipped tail holds no live tables either.
+        if (m_tail == m_head)
+            m_tail = start;
+    }
+    if (start + count - m_tail > m_capacity)
+        return INVALID;
+
+    m_head = start + count;
+    m_peakInFlight = std::max(m_peakInFlight, GetInFlight());
+    return m_base + static_cast<uint32_t>(start % m_capacity);
+}
+
+void DescriptorRing::AdvanceFrame()
+{
+    m_frameEnds.push_back({ m_frame, m_head });
+    ++m_frame;
+    // Tables written during frame f may be read until frame f + frameCount begins.
+    while (!m_frameEnds.empty() && m_frameEnds.front().frame + m_frameCount <= m_frame)
+    {
+        m_tail = m_frameEnds.front().head;
+        m_frameEnds.pop_front();
+    }
+}
+
+DescriptorAllocator::DescriptorAllocator(uint32_t persistentCount, uint32_t transientCount, uint32_t frameCount)
+    : m_frameCount(std::max(frameCount, 1u)),
+      m_persistent(0, persistentCount),
+      m_transient(persistentCount, transientCount, frameCount)
+{
+}
+
+DescriptorAllocator::Range DescriptorAllocator::Allocate(uint32_t count)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const uint32_t offset = m_persistent.Allocate(count);
+    if (offset == DescriptorRangeAllocator::INVALID)
+        return {};
+    return { offset, count };
+}
+
+void DescriptorAllocator::Free(const Range& range)
+{
+    if (!range.IsValid())
+        return;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_pendingFrees.push_back({ nullptr, range, m_frame });
+}
+
+DescriptorAllocator::Range DescriptorAllocator::GetNamedLocked(const std::string& name, uint32_t count)
+{
+    const auto it = m_named.find(name);
+    if (it != m_named.end())
+    {
+        assert(it->second.count == count && "Named descriptor range requested with two different sizes");
+        return it->second;
+    }
+
+    const uint32_t offset = m_persistent.Allocate(count);
+    if (offset == DescriptorRangeAllocator::INVALID)
+        return {};
+    const Range range{ offset, count };
+    m_named.emplace(name, range);
+    return range;
+}
+
+DescriptorAllocator::Range DescriptorAllocator::GetNamed(const std::string& name, uint32_t count)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return GetNamedLocked(name, count);
+}
+
+DescriptorAllocator::Range DescriptorAllocator::GetBindlessTable(const std::string& name, uint32_t capacity)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    const auto it = m_bindless.find(name);
+    if (it != m_bindless.end())
+    {
+        assert(it->second.range.count == capacity && "Bindless table requested with two different capacities");
+        return it->second.range;
+    }
+
+    const Range range = GetNamedLocked(name, capacity);
+    if (range.IsValid())
+        m_bindless.try_emplace(name, BindlessTable{ range, DescriptorRangeAllocator(0, capacity) });
+    return range;
+}
+
+uint32_t DescriptorAllocator::AllocateBindless(const std::string& table)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    const auto it = m_bindless.find(table);
+    assert(it != m_bindless.end() && "Bindless table was never created");
+    const uint32_t index = it->second.entries.Allocate(1);
+    if (index != DescriptorRangeAllocator::INVALID)
+        ++it->second.used;
+    return index;
+}
+
+void DescriptorAllocator::FreeBindless(const std::string& table, uint32_t index)
+{
+    if (index == INVALID)
+        return;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    const auto it = m_bindless.find(table);
+    assert(it != m_bindless.end() && "Bindless table was never created");
+    --it->second.used;
+    m_pendingFrees.push_back({ &it->second, { index, 1 }, m_frame });
+}
+
+DescriptorAllocator::Range DescriptorAllocator::AllocateTransient(uint32_t count)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const uint32_t offset = m_transient.Allocate(count);
+    if (offset == DescriptorRing::INVALID)
+        return {};
+    return { offset, count };
+}
+
+void DescriptorAllocator::AdvanceFrame()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ++m_frame;
+    m_transient.AdvanceFrame();
+
+    // A range freed during frame f may be read by frames up to f.
+    auto retired = std::partition(m_pendingFrees.begin(), m_pendingFrees.end(),
+        [&](const PendingFree& pending) { return pending.retireFrame + m_frameCount > m_frame; });
+    for (auto it = retired; it != m_pendingFrees.end(); ++it)
+    {
+        DescriptorRangeAllocator& owner = it->table ? it->table->entries : m_persistent;
+        owner.Free(it->range.offset, it->range.count);
+    }
+    m_pendingFrees.erase(retired, m_pendingFrees.end());
+}
+
+DescriptorAllocator::Stats DescriptorAllocator::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Stats stats;
+    stats.persistent = m_persistent.GetStats();
+    stats.transientCapacity = m_transient.GetCapacity();
+    stats.transientInFlight = m_transient.GetInFlight();
+    stats.transientPeak = m_transient.GetPeakInFlight();
+    stats.pendingFrees = m_pendingFrees.size();
+    stats.named.assign(m_named.begin(), m_named.end());
+    for (const auto& [name, table] : m_bindless)
+        stats.bindlessTables.emplace_back(name, table.used, table.range.count);
+    return stats;
+}
@@ -0,0 +1,232 @@
+#include "pch.h"
+#include "Resources/GpuMemoryAllocator.h"
+
+#include "Renderer.h"
+#include "Utils/CVars.h"
+
+#include <atomic>
+
+static AutoCVarInt g_placedResources("memory.placedResources", "place DEFAULT-heap buffers and textures into shared heaps instead of committing each", 1, CVarFlags::EditCheckbox);
+static AutoCVarInt g_heapSizeMB("memory.heapSizeMB", "size of one shared resource heap (MiB), read at startup", 64);
+
+namespace
+{
+    thread_local const char* t_currentTag = nullptr;
+
+    // {6A4D3E51-2C8B-4E7A-9F16-0B5C7D2E9A31}
+    const GUID kPlacedAllocationGuid = { 0x6a4d3e51, 0x2c8b, 0x4e7a, { 0x9f, 0x16, 0x0b, 0x5c, 0x7d, 0x2e, 0x9a, 0x31 } };
+
+    const char* const kPoolNames[] = { "Buffers", "Textures", "Render targets" };
+
+    class D3D12HeapBacking : public HeapBacking
+    {
+    public:
+        D3D12HeapBacking(const Microsoft::WRL::ComPtr<ID3D12Device5>& device, D3D12_HEAP_FLAGS flags, const wchar_t* name)
+            : m_device(device), m_flags(flags), m_name(name) {}
+
+        bool CreateHeap(uint32_t heap, uint64_t bytes) override
+        {
+            D3D12_HEAP_DESC desc = {};
+            desc.SizeInBytes = bytes;
+            desc.Properties = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
+            desc.Alignment = D3D12_DEFAULT_MSAA_RESOURCE_PLACEMENT_ALIGNMENT;
+            desc.Flags = m_flags; // not CREATE_NOT_ZEROED: untouched ranges read as zero
+
+            Microsoft::WRL::ComPtr<ID3D12Heap> created;
+            const HRESULT hr = m_device->CreateHeap(&desc, IID_PPV_ARGS(&created));
+            if (FAILED(hr))
+            {
+                spdlog::warn("CreateHeap failed ({} MiB, hr={:#010x})", bytes >> 20, static_cast<uint32_t>(hr));
+                return false;
+            }
+            created->SetName((m_name + L" Heap " + std::to_wstring(heap)).c_str());
+
+            if (heap >= m_heaps.size())
+                m_heaps.resize(heap + 1);
+            m_heaps[heap] = std::move(created);
+            return true;
+        }
+
+        void DestroyHeap(uint32_t heap) override
+        {
+            m_heaps[heap].Reset();
+        }
+
+        ID3D12Heap* GetHeap(uint32_t heap) const { return m_heaps[heap].Get(); }
+
+    private:
+        Microsoft::WRL::ComPtr<ID3D12Device5> m_device;
+        D3D12_HEAP_FLAGS m_flags;
+        std::wstring m_name;
+        std::vector<Microsoft::WRL::ComPtr<ID3D12Heap>> m_heaps;
+    };
+
+    // Attached to the placed resource as private data; D3D12 releases it with
+    // the resource, which returns the range to its heap.
+    class PlacedAllocation final : public IUnknown
+    {
+    public:
+        PlacedAllocation(std::shared_ptr<HeapSuballocator> pool, const HeapSuballocator::Allocation& allocation)
+            : m_pool(std::move(pool)), m_allocation(allocation) {}
+
+        HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid, void** object) override
+        {
+            if (!object)
+                return E_POINTER;
+            if (riid == __uuidof(IUnknown))
+            {
+                *object = static_cast<IUnknown*>(this);
+                AddRef();
+                return S_OK;
+            }
+            *object = nullptr;
+            return E_NOINTERFACE;
+        }
+
+        ULONG STDMETHODCALLTYPE AddRef() override { return ++m_refCount; }
+
+        ULONG STDMETHODCALLTYPE Release() override
+        {
+            const ULONG count = --m_refCount;
+            if (count == 0)
+            {
+                m_pool->Free(m_allocation);
+                delete this;
+            }
+            return count;
+        }
+
+    private:
+        std::atomic<ULONG> m_refCount{ 1 };
+        std::shared_ptr<HeapSuballocator> m_pool;
+        HeapSuballocator::Allocation m_allocation;
+    };
+
+    double ToMiB(uint64_t bytes)
+    {
+        return static_cast<double>(bytes) / (1024.0 * 1024.0);
+    }
+}
+
+GpuMemoryAllocator& GpuMemoryAllocator::Get()
+{
+    static GpuMemoryAllocator allocator;
+    return allocator;
+}
+
+void GpuMemoryAllocator::Initialize(const Microsoft::WRL::ComPtr<ID3D12Device5>& device)
+{
+    m_device = device;
+    const uint64_t heapSize = static_cast<uint64_t>(std::max(g_heapSizeMB.Get(), 4)) << 20;
+
+    m_pools[POOL_BUFFERS] = std::make_shared<HeapSuballocator>(
+        std::make_unique<D3D12HeapBacking>(device, D3D12_HEAP_FLAG_ALLOW_ONLY_BUFFERS, L"Buffer"), heapSize);
+    m_pools[POOL_TEXTURES] = std::make_shared<HeapSuballocator>(
+        std::make_unique<D3D12HeapBacking>(device, D3D12_HEAP_FLAG_ALLOW_ONLY_NON_RT_DS_TEXTURES, L"Texture"), heapSize);
+    m_pools[POOL_RENDER_TARGETS] = std::make_shared<HeapSuballocator>(
+        std::make_unique<D3D12HeapBacking>(device, D3D12_HEAP_FLAG_ALLOW_ONLY_RT_DS_TEXTURES, L"Render Target"), heapSize);
+}
+
+HRESULT GpuMemoryAllocator::CreateResource(
+    const D3D12_RESOURCE_DESC& desc,
+    D3D12_RESOURCE_STATES initialState,
+    const D3D12_CLEAR_VALUE* clearValue,
+    REFIID riid,
+    void** resource,
+    bool zeroed)
+{
+    if (!m_device || !g_placedResources.Get())
+    {
+        const auto heapProps = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
+        const auto device = m_device ? m_device.Get() : Renderer::g_device.Get();
+        return device->CreateCommittedResource(&heapProps, D3D12_HEAP_FLAG_NONE, &desc, initialState, clearValue, riid, resource);
+    }
+
+    Pool pool = POOL_BUFFERS;
+    if (desc.Dimension != D3D12_RESOURCE_DIMENSION_BUFFER)
+    {
+        const bool renderTarget = (desc.Flags & (D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET | D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL)) != 0;
+        pool = renderTarget ? POOL_RENDER_TARGETS : POOL_TEXTURES;
+    }
+
+    // Alignment class: ask for small (4 KiB) placement first; the runtime
+    // answers with the larger alignment when the texture does not qualify.
+    D3D12_RESOURCE_DESC placedDesc = desc;
+    D3D12_RESOURCE_ALLOCATION_INFO info = {};
+    if (pool == POOL_TEXTURES && desc.SampleDesc.Count <= 1)
+    {
+        placedDesc.Alignment = D3D12_SMALL_RESOURCE_PLACEMENT_ALIGNMENT;
+        info = m_device->GetResourceAllocationInfo(0, 1, &placedDesc);
+        if (info.Alignment != D3D12_SMALL_RESOURCE_PLACEMENT_ALIGNMENT)
+            placedDesc.Alignment = 0;
+    }
+    if (placedDesc.Alignment == 0)
+        info = m_device->GetResourceAllocationInfo(0, 1, &placedDesc);
+
+    const auto& suballocator = m_pools[pool];
+    const HeapSuballocator::Allocation allocation = info.SizeInBytes != UINT64_MAX
+        ? suballocator->Allocate(info.SizeInBytes, info.Alignment, t_currentTag, zeroed)
+        : HeapSuballocator::Allocation{};
+
+    HRESULT hr = E_OUTOFMEMORY;
+    Microsoft::WRL::ComPtr<ID3D12Resource> placed;
+    if (allocation.IsValid())
+    {
+        const auto& backing = static_cast<D3D12HeapBacking&>(suballocator->GetBacking());
+        hr = m_device->CreatePlacedResource(backing.GetHeap(allocation.heap), allocation.offset, &placedDesc, initialState, clearValue, IID_PPV_ARGS(&placed));
+        if (FAILED(hr))
+            suballocator->Free(allocation);
+    }
+    if (FAILED(hr))
+    {
+        spdlog::warn("Placing a {}x{} resource failed (hr={:#010x}); creating it committed", desc.Width, desc.Height, static_cast<uint32_t>(hr));
+        const auto heapProps = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
+        return m_device->CreateCommittedResource(&heapProps, D3D12_HEAP_FLAG_NONE, &desc, initialState, clearValue, riid, resource);
+    }
+
+    // The resource takes its own reference to the token; drop ours.
+    auto* token = new PlacedAllocation(suballocator, allocation);
+    placed->SetPrivateDataInterface(kPlacedAllocationGuid, token);
+    token->Release();
+
+    return placed->QueryInterface(riid, resource);
+}
+
+void GpuMemoryAllocator::LogReport() const
+{
+    for (int pool = 0; pool < POOL_COUNT; ++pool)
+    {
+        if (!m_pools[pool])
+            continue;
+
+        uint64_t capacity = 0, used = 0;
+        for (const auto& heap : m_pools[pool]->GetHeapStats())
+        {
+            capacity += heap.usage.capacity;
+            used += heap.usage.usedBytes;
+            spdlog::info("  {} heap {}{}: {:.1f}/{:.1f} MiB used, {} allocation(s), {} free block(s), largest free {:.1f} MiB, fragmentation {:.0f}%",
+                kPoolNames[pool], heap.heap, heap.dedicated ? " (dedicated)" : "",
+                ToMiB(heap.usage.usedBytes), ToMiB(heap.usage.capacity), heap.usage.allocationCount,
+                heap.usage.freeBlockCount, ToMiB(heap.usage.largestFreeBlock), heap.usage.Fragmentation() * 100.0);
+        }
+        spdlog::info("GPU memory, {}: {:.1f} MiB used of {:.1f} MiB in heaps", kPoolNames[pool], ToMiB(used), ToMiB(capacity));
+
+        for (const auto& tag : m_pools[pool]->GetTagStats())
+        {
+            if (tag.peakBytes == 0)
+                continue;
+            spdlog::info("  {:<28} {:>6} live, {:>8.1f} MiB (peak {:.1f} MiB)", tag.tag, tag.allocationCount, ToMiB(tag.bytes), ToMiB(tag.peakBytes));
+        }
+    }
+}
+
+GpuMemoryAllocator::ScopedTag::ScopedTag(const char* tag)
+    : m_previous(t_currentTag)
+{
+    t_currentTag = tag;
+}
+
+GpuMemoryAllocator::ScopedTag::~ScopedTag()
+{
+    t_currentTag = m_previous;
+}
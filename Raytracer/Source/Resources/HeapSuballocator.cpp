@@ -0,0 +1,156 @@
+#include "Resources/HeapSuballocator.h"
+
+#include <algorithm>
+#include <cassert>
+
+HeapSuballocator::HeapSuballocator(std::unique_ptr<HeapBacking> backing, uint64_t heapSize)
+    : m_backing(std::move(backing)),
+      m_heapSize(std::max(heapSize, TlsfAllocator::GRANULARITY) / TlsfAllocator::GRANULARITY * TlsfAllocator::GRANULARITY)
+{
+    assert(m_backing && "HeapSuballocator needs a heap backing");
+}
+
+HeapSuballocator::~HeapSuballocator()
+{
+    for (uint32_t heap = 0; heap < m_heaps.size(); ++heap)
+    {
+        if (m_heaps[heap].allocator)
+            m_backing->DestroyHeap(heap);
+    }
+}
+
+uint32_t HeapSuballocator::CreateHeap(uint64_t bytes, bool dedicated)
+{
+    auto slot = std::find_if(m_heaps.begin(), m_heaps.end(), [](const Heap& heap) { return !heap.allocator; });
+    const uint32_t heap = static_cast<uint32_t>(slot - m_heaps.begin());
+    if (!m_backing->CreateHeap(heap, bytes))
+        return INVALID;
+
+    if (slot == m_heaps.end())
+        m_heaps.emplace_back();
+    m_heaps[heap].allocator = std::make_unique<TlsfAllocator>(bytes);
+    m_heaps[heap].dedicated = dedicated;
+    return heap;
+}
+
+void HeapSuballocator::DestroyHeap(uint32_t heap)
+{
+    m_backing->DestroyHeap(heap);
+    m_heaps[heap].allocator.reset();
+    m_heaps[heap].dedicated = false;
+}
+
+uint32_t HeapSuballocator::InternTag(const char* tag)
+{
+    const std::string name = tag && *tag ? tag : "Untagged";
+    const auto [it, inserted] = m_tagIndices.try_emplace(name, static_cast<uint32_t>(m_tags.size()));
+    if (inserted)
+        m_tags.push_back({ name });
+    return it->second;
+}
+
+HeapSuballocator::Allocation HeapSuballocator::Allocate(uint64_t size, uint64_t alignment, const char* tag, bool untouched)
+{
+    alignment = std::max(alignment, TlsfAllocator::GRANULARITY);
+    const uint64_t rounded = (std::max<uint64_t>(size, 1) + alignment - 1) & ~(alignment - 1);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    uint32_t heap = INVALID;
+    TlsfAllocator::Allocation placed;
+    auto place = [&](TlsfAllocator& allocator)
+    {
+        return untouched ? allocator.AllocateUntouched(size, alignment) : allocator.Allocate(size, alignment);
+    };
+    if (rounded > m_heapSize / 2)
+    {
+        // Heap offsets start at 0, so a heap of exactly the rounded size is aligned.
+        heap = CreateHeap(rounded, true);
+        if (heap != INVALID)
+            placed = m_heaps[heap].allocator->Allocate(rounded, alignment);
+    }
+    else
+    {
+        for (uint32_t candidate = 0; candidate < m_heaps.size() && !placed.IsValid(); ++candidate)
+        {
+            if (m_heaps[candidate].allocator && !m_heaps[candidate].dedicated)
+            {
+                placed = place(*m_heaps[candidate].allocator);
+                heap = candidate;
+            }
+        }
+        if (!placed.IsValid())
+        {
+            heap = CreateHeap(m_heapSize, false);
+            if (heap != INVALID)
+                placed = place(*m_heaps[heap].allocator);
+        }
+    }
+    if (!placed.IsValid())
+        return {};
+
+    Allocation allocation;
+    allocation.heap = heap;
+    allocation.block = placed.block;
+    allocation.tag = InternTag(tag);
+    allocation.offset = placed.offset;
+    allocation.size = placed.size;
+
+    TagStats& stats = m_tags[allocation.tag];
+    ++stats.allocationCount;
+    stats.bytes += placed.size;
+    stats.peakBytes = std::max(stats.peakBytes, stats.bytes);
+    return allocation;
+}
+
+void HeapSuballocator::Free(const Allocation& allocation)
+{
+    if (!allocation.IsValid())
+        return;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    Heap& heap = m_heaps[allocation.heap];
+    heap.allocator->Free(allocation.block);
+
+    TagStats& stats = m_tags[allocation.tag];
+    --stats.allocationCount;
+    stats.bytes -= allocation.size;
+
+    if (!heap.allocator->IsEmpty())
+        return;
+    if (heap.dedicated)
+    {
+        DestroyHeap(allocation.heap);
+        return;
+    }
+    // Keep one empty shared heap around so a free/allocate cycle at the
+    // boundary does not create and destroy a heap each time.
+    for (uint32_t other = 0; other < m_heaps.size(); ++other)
+    {
+        const Heap& candidate = m_heaps[other];
+        if (other != allocation.heap && candidate.allocator && !candidate.dedicated && candidate.allocator->IsEmpty())
+        {
+            DestroyHeap(allocation.heap);
+            return;
+        }
+    }
+}
+
+std::vector<HeapSuballocator::HeapStats> HeapSuballocator::GetHeapStats() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<HeapStats> stats;
+    for (uint32_t heap = 0; heap < m_heaps.size(); ++heap)
+    {
+        if (m_heaps[heap].allocator)
+            stats.push_back({ heap, m_heaps[heap].dedicated, m_heaps[heap].allocator->GetStats() });
+    }
+    return stats;
+}
+
+std::vector<HeapSuballocator::TagStats> HeapSuballocator::GetTagStats() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_tags;
+}
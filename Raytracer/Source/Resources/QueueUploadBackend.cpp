@@ -0,0 +1,93 @@
+#include "pch.h"
+#include "Resources/QueueUploadBackend.h"
+
+#include <algorithm>
+
+QueueUploadBackend::QueueUploadBackend(const Microsoft::WRL::ComPtr<ID3D12Device5>& device, const Microsoft::WRL::ComPtr<ID3D12CommandQueue>& queue)
+    : m_device(device),
+      m_queue(queue)
+{
+    ThrowIfFailed(m_device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&m_fence)));
+    m_fence->SetName(L"Upload Fence");
+
+    m_fenceEvent = CreateEventEx(nullptr, FALSE, FALSE, EVENT_ALL_ACCESS);
+    if (m_fenceEvent == nullptr)
+        ThrowIfFailed(HRESULT_FROM_WIN32(GetLastError()));
+
+    // Created closed; every Submit resets it onto a free allocator.
+    ThrowIfFailed(m_device->CreateCommandList1(0, D3D12_COMMAND_LIST_TYPE_DIRECT, D3D12_COMMAND_LIST_FLAG_NONE, IID_PPV_ARGS(&m_commandList)));
+    m_commandList->SetName(L"Upload Command List");
+}
+
+QueueUploadBackend::~QueueUploadBackend()
+{
+    if (m_ring)
+        m_ring->Unmap(0, nullptr);
+    if (m_fenceEvent)
+        CloseHandle(m_fenceEvent);
+}
+
+uint8_t* QueueUploadBackend::AllocateStagingRing(uint64_t bytes)
+{
+    ThrowIfFailed(m_device->CreateCommittedResource(
+        &CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD),
+        D3D12_HEAP_FLAG_NONE,
+        &CD3DX12_RESOURCE_DESC::Buffer(bytes),
+        D3D12_RESOURCE_STATE_GENERIC_READ,
+        nullptr,
+        IID_PPV_ARGS(&m_ring)));
+    m_ring->SetName(L"Upload Staging Ring");
+
+    uint8_t* cpu = nullptr;
+    const CD3DX12_RANGE readRange(0, 0); // CPU never reads staging data back
+    ThrowIfFailed(m_ring->Map(0, &readRange, reinterpret_cast<void**>(&cpu)));
+    return cpu;
+}
+
+uint64_t QueueUploadBackend::Submit(const std::vector<UploadCopy>& copies)
+{
+    // An allocator can be reset once the batch recorded with it has completed.
+    const uint64_t completed = m_fence->GetCompletedValue();
+    auto recorder = std::find_if(m_recorders.begin(), m_recorders.end(),
+        [completed](const Recorder& r) { return r.fence <= completed; });
+    if (recorder == m_recorders.end())
+    {
+        Recorder created;
+        ThrowIfFailed(m_device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&created.allocator)));
+        created.allocator->SetName((L"Upload Command Allocator " + std::to_wstring(m_recorders.size())).c_str());
+        m_recorders.push_back(std::move(created));
+        recorder = std::prev(m_recorders.end());
+    }
+    else
+    {
+        ThrowIfFailed(recorder->allocator->Reset());
+    }
+
+    ThrowIfFailed(m_commandList->Reset(recorder->allocator.Get(), nullptr));
+    for (const UploadCopy& copy : copies)
+    {
+        m_commandList->CopyBufferRegion(static_cast<ID3D12Resource*>(copy.destination), copy.destinationOffset,
+            m_ring.Get(), copy.stagingOffset, copy.size);
+    }
+    ThrowIfFailed(m_commandList->Close());
+
+    ID3D12CommandList* commandLists[] = { m_commandList.Get() };
+    m_queue->ExecuteCommandLists(_countof(commandLists), commandLists);
+    ThrowIfFailed(m_queue->Signal(m_fence.Get(), ++m_fenceValue));
+    recorder->fence = m_fenceValue;
+    return m_fenceValue;
+}
+
+uint64_t QueueUploadBackend::GetCompletedFence()
+{
+    return m_fence->GetCompletedValue();
+}
+
+void QueueUploadBackend::WaitForFence(uint64_t value)
+{
+    if (m_fence->GetCompletedValue() >= value)
+        return;
+
+    ThrowIfFailed(m_fence->SetEventOnCompletion(value, m_fenceEvent));
+    WaitForSingleObject(m_fenceEvent, INFINITE);
+}
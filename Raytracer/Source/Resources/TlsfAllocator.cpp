@@ -0,0 +1,339 @@
+#include "Resources/TlsfAllocator.h"
+
+#include <algorithm>
+#include <cassert>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace
+{
+    uint32_t LowestBit(uint64_t value)
+    {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanForward64(&index, value);
+        return index;
+#else
+        return static_cast<uint32_t>(__builtin_ctzll(value));
+#endif
+    }
+
+    uint32_t HighestBit(uint64_t value)
+    {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanReverse64(&index, value);
+        return index;
+#else
+        return 63u - static_cast<uint32_t>(__builtin_clzll(value));
+#endif
+    }
+
+    uint64_t AlignUp(uint64_t value, uint64_t alignment)
+    {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+}
+
+TlsfAllocator::TlsfAllocator(uint64_t capacity)
+    : m_capacity(capacity / GRANULARITY * GRANULARITY)
+{
+    assert(m_capacity > 0 && "TLSF range smaller than its granularity");
+    for (auto& firstLevel : m_freeHeads)
+        std::fill(std::begin(firstLevel), std::end(firstLevel), INVALID);
+
+    const uint32_t block = NewBlock();
+    m_blocks[block] = { 0, m_capacity, INVALID, INVALID, INVALID, INVALID, true };
+    InsertFree(block);
+}
+
+// Size classes in GRANULARITY units: linear below SL_COUNT, then SL_COUNT
+// subdivisions per power of two.
+void TlsfAllocator::MappingInsert(uint64_t units, uint32_t& fl, uint32_t& sl)
+{
+    if (units < SL_COUNT)
+    {
+        fl = 0;
+        sl = static_cast<uint32_t>(units);
+        return;
+    }
+    const uint32_t msb = HighestBit(units);
+    fl = msb - SL_BITS + 1;
+    sl = static_cast<uint32_t>(units >> (msb - SL_BITS)) - SL_COUNT;
+}
+
+// Rounds up to the next class boundary so any block in the class fits.
+void TlsfAllocator::MappingSearch(uint64_t units, uint32_t& fl, uint32_t& sl)
+{
+    if (units >= SL_COUNT)
+        units += (uint64_t(1) << (HighestBit(units) - SL_BITS)) - 1;
+    MappingInsert(units, fl, sl);
+}
+
+uint32_t TlsfAllocator::NewBlock()
+{
+    if (!m_unusedBlocks.empty())
+    {
+        const uint32_t block = m_unusedBlocks.back();
+        m_unusedBlocks.pop_back();
+        return block;
+    }
+    m_blocks.push_back({});
+    return static_cast<uint32_t>(m_blocks.size() - 1);
+}
+
+void TlsfAllocator::ReleaseBlock(uint32_t block)
+{
+    m_unusedBlocks.push_back(block);
+}
+
+void TlsfAllocator::InsertFree(uint32_t block)
+{
+    uint32_t fl, sl;
+    MappingInsert(m_blocks[block].size / GRANULARITY, fl, sl);
+
+    const uint32_t head = m_freeHeads[fl][sl];
+    m_blocks[block].isFree = true;
+    m_blocks[block].prevFree = INVALID;
+    m_blocks[block].nextFree = head;
+    if (head != INVALID)
+        m_blocks[head].prevFree = block;
+    m_freeHeads[fl][sl] = block;
+    m_slBitmap[fl] |= 1u << sl;
+    m_flBitmap |= uint64_t(1) << fl;
+}
+
+void TlsfAllocator::RemoveFree(uint32_t block)
+{
+    uint32_t fl, sl;
+    MappingInsert(m_blocks[block].size / GRANULARITY, fl, sl);
+
+    const Block& b = m_blocks[block];
+    if (b.prevFree != INVALID)
+        m_blocks[b.prevFree].nextFree = b.nextFree;
+    else
+        m_freeHeads[fl][sl] = b.nextFree;
+    if (b.nextFree != INVALID)
+        m_blocks[b.nextFree].prevFree = b.prevFree;
+
+    if (m_freeHeads[fl][sl] == INVALID)
+    {
+        m_slBitmap[fl] &= ~(1u << sl);
+        if (m_slBitmap[fl] == 0)
+            m_flBitmap &= ~(uint64_t(1) << fl);
+    }
+    m_blocks[block].isFree = false;
+}
+
+uint32_t TlsfAllocator::FindFree(uint64_t size)
+{
+    uint32_t fl, sl;
+    MappingSearch(size / GRANULARITY, fl, sl);
+    if (fl >= FL_COUNT)
+        return INVALID;
+
+    uint32_t slMap = m_slBitmap[fl] & (~0u << sl);
+    if (slMap == 0)
+    {
+        const uint64_t flMap = fl + 1 < 64 ? m_flBitmap & (~uint64_t(0) << (fl + 1)) : 0;
+        if (flMap == 0)
+            return INVALID;
+        fl = LowestBit(flMap);
+        slMap = m_slBitmap[fl];
+    }
+    return m_freeHeads[fl][LowestBit(slMap)];
+}
+
+void TlsfAllocator::SplitTail(uint32_t block, uint64_t size)
+{
+    const uint32_t tail = NewBlock();
+    Block& b = m_blocks[block];
+    m_blocks[tail] = { b.offset + size, b.size - size, block, b.nextPhysical, INVALID, INVALID, false };
+    if (b.nextPhysical != INVALID)
+        m_blocks[b.nextPhysical].prevPhysical = tail;
+    else
+        m_lastBlock = tail;
+    b.nextPhysical = tail;
+    b.size = size;
+}
+
+uint32_t TlsfAllocator::MergeWithPrevious(uint32_t block)
+{
+    const uint32_t prev = m_blocks[block].prevPhysical;
+    const Block b = m_blocks[block];
+    m_blocks[prev].size += b.size;
+    m_blocks[prev].nextPhysical = b.nextPhysical;
+    if (b.nextPhysical != INVALID)
+        m_blocks[b.nextPhysical].prevPhysical = prev;
+    else
+        m_lastBlock = prev;
+    ReleaseBlock(block);
+    return prev;
+}
+
+TlsfAllocator::Allocation TlsfAllocator::Allocate(uint64_t size, uint64_t alignment)
+{
+    assert((alignment & (alignment - 1)) == 0 && "Alignment must be a power of two");
+    size = AlignUp(std::max<uint64_t>(size, 1), GRANULARITY);
+    alignment = std::max(alignment, GRANULARITY);
+    if (size > m_capacity)
+        return {};
+
+    // Worst-case front padding is reserved up front, so the first fit always
+    // works. Failing that, a block of just `size` still fits if it happens to
+    // be aligned well enough (e.g. a heap-sized request at offset 0).
+    uint32_t block = FindFree(size + (alignment - GRANULARITY));
+    if (block == INVALID)
+    {
+        block = FindFree(size);
+        if (block == INVALID)
+            return {};
+        const Block& candidate = m_blocks[block];
+        if (AlignUp(candidate.offset, alignment) + size > candidate.offset + candidate.size)
+            return {};
+    }
+    RemoveFree(block);
+    return Claim(block, AlignUp(m_blocks[block].offset, alignment), size);
+}
+
+TlsfAllocator::Allocation TlsfAllocator::AllocateUntouched(uint64_t size, uint64_t alignment)
+{
+    assert((alignment & (alignment - 1)) == 0 && "Alignment must be a power of two");
+    size = AlignUp(std::max<uint64_t>(size, 1), GRANULARITY);
+    alignment = std::max(alignment, GRANULARITY);
+
+    // Everything above the high water mark is the tail of the last block.
+    const uint32_t block = m_lastBlock;
+    const Block& last = m_blocks[block];
+    const uint64_t offset = AlignUp(std::max(last.offset, m_highWater), alignment);
+    if (!last.isFree || offset + size > m_capacity)
+        return {};
+
+    RemoveFree(block);
+    return Claim(block, offset, size);
+}
+
+TlsfAllocator::Allocation TlsfAllocator::Claim(uint32_t block, uint64_t offset, uint64_t size)
+{
+    const uint64_t padding = offset - m_blocks[block].offset;
+    if (padding > 0)
+    {
+        // The padding stays free; its physical predecessor is in use, or the
+        // two would have been merged.
+        SplitTail(block, padding);
+        const uint32_t aligned = m_blocks[block].nextPhysical;
+        InsertFree(block);
+        block = aligned;
+    }
+    if (m_blocks[block].size > size)
+    {
+        SplitTail(block, size);
+        InsertFree(m_blocks[block].nextPhysical);
+    }
+
+    m_blocks[block].isFree = false;
+    m_usedBytes += size;
+    ++m_allocationCount;
+    m_highWater = std::max(m_highWater, offset + size);
+    return { block, offset, size };
+}
+
+void TlsfAllocator::Free(uint32_t block)
+{
+    assert(block < m_blocks.size() && !m_blocks[block].isFree && "Invalid or double TLSF free");
+    m_usedBytes -= m_blocks[block].size;
+    --m_allocationCount;
+
+    const uint32_t next = m_blocks[block].nextPhysical;
+    if (next != INVALID && m_blocks[next].isFree)
+    {
+        RemoveFree(next);
+        MergeWithPrevious(next);
+    }
+    const uint32_t prev = m_blocks[block].prevPhysical;
+    if (prev != INVALID && m_blocks[prev].isFree)
+    {
+        RemoveFree(prev);
+        block = MergeWithPrevious(block);
+    }
+    InsertFree(block);
+}
+
+TlsfAllocator::Stats TlsfAllocator::GetStats() const
+{
+    Stats stats;
+    stats.capacity = m_capacity;
+    stats.usedBytes = m_usedBytes;
+    stats.freeBytes = m_capacity - m_usedBytes;
+    stats.allocationCount = m_allocationCount;
+    for (uint32_t fl = 0; fl < FL_COUNT; ++fl)
+    {
+        for (uint32_t sl = 0; sl < SL_COUNT; ++sl)
+        {
+            for (uint32_t b = m_freeHeads[fl][sl]; b != INVALID; b = m_blocks[b].nextFree)
+            {
+                ++stats.freeBlockCount;
+                stats.largestFreeBlock = std::max(stats.largestFreeBlock, m_blocks[b].size);
+            }
+        }
+    }
+    return stats;
+}
+
+bool TlsfAllocator::Validate() const
+{
+    // Block 0 is created first at offset 0 and only ever absorbs its successors.
+    uint64_t expectedOffset = 0;
+    uint64_t used = 0;
+    size_t allocations = 0;
+    size_t freeBlocks = 0;
+    uint32_t prev = INVALID;
+    bool prevFree = false;
+    for (uint32_t b = 0; b != INVALID; b = m_blocks[b].nextPhysical)
+    {
+        const Block& block = m_blocks[b];
+        if (block.offset != expectedOffset || block.size == 0 || block.size % GRANULARITY != 0)
+            return false;
+        if (block.prevPhysical != prev)
+            return false;
+        if (block.isFree && prevFree)
+            return false;
+        if (block.isFree)
+            ++freeBlocks;
+        else
+        {
+            used += block.size;
+            ++allocations;
+        }
+        expectedOffset += block.size;
+        prev = b;
+        prevFree = block.isFree;
+    }
+    if (expectedOffset != m_capacity || used != m_usedBytes || allocations != m_allocationCount)
+        return false;
+
+    size_t listed = 0;
+    for (uint32_t fl = 0; fl < FL_COUNT; ++fl)
+    {
+        if (((m_flBitmap >> fl) & 1) != (m_slBitmap[fl] != 0 ? 1u : 0u))
+            return false;
+        for (uint32_t sl = 0; sl < SL_COUNT; ++sl)
+        {
+            if (((m_slBitmap[fl] >> sl) & 1) != (m_freeHeads[fl][sl] != INVALID ? 1u : 0u))
+                return false;
+            uint32_t prevInList = INVALID;
+            for (uint32_t b = m_freeHeads[fl][sl]; b != INVALID; b = m_blocks[b].nextFree)
+            {
+                uint32_t blockFl, blockSl;
+                MappingInsert(m_blocks[b].size / GRANULARITY, blockFl, blockSl);
+                if (!m_blocks[b].isFree || blockFl != fl || blockSl != sl || m_blocks[b].prevFree != prevInList)
+                    return false;
+                prevInList = b;
+                ++listed;
+            }
+        }
+    }
+    return listed == freeBlocks;
+}
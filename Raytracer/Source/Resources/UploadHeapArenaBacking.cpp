@@ -0,0 +1,34 @@
+#include "pch.h"
+#include "Resources/UploadHeapArenaBacking.h"
+
+UploadHeapArenaBacking::UploadHeapArenaBacking(const Microsoft::WRL::ComPtr<ID3D12Device5>& device)
+    : m_device(device)
+{
+}
+
+UploadHeapArenaBacking::~UploadHeapArenaBacking()
+{
+    for (const auto& page : m_pages)
+        page->Unmap(0, nullptr);
+}
+
+ConstantArenaBacking::Page UploadHeapArenaBacking::AllocatePage(size_t bytes)
+{
+    Microsoft::WRL::ComPtr<ID3D12Resource> resource;
+    ThrowIfFailed(m_device->CreateCommittedResource(
+        &CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD),
+        D3D12_HEAP_FLAG_NONE,
+        &CD3DX12_RESOURCE_DESC::Buffer(bytes),
+        D3D12_RESOURCE_STATE_GENERIC_READ,
+        nullptr,
+        IID_PPV_ARGS(&resource)));
+    resource->SetName((L"Constant Arena Page " + std::to_wstring(m_pages.size())).c_str());
+
+    Page page;
+    const CD3DX12_RANGE readRange(0, 0); // CPU never reads constants back
+    ThrowIfFailed(resource->Map(0, &readRange, reinterpret_cast<void**>(&page.cpu)));
+    page.gpu = resource->GetGPUVirtualAddress();
+
+    m_pages.push_back(std::move(resource));
+    return page;
+}
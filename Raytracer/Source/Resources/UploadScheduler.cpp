@@ -0,0 +1,132 @@
+#include "Resources/UploadScheduler.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+namespace
+{
+    uint64_t AlignUp(uint64_t value, uint64_t alignment)
+    {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+}
+
+UploadScheduler::UploadScheduler(std::unique_ptr<UploadBackend> backend, uint64_t ringSize)
+    : m_backend(std::move(backend)),
+      // Whole chunks of STAGING_ALIGNMENT, so chunks of one upload stay contiguous.
+      m_capacity(std::max(ringSize / (4 * STAGING_ALIGNMENT), uint64_t(1)) * 4 * STAGING_ALIGNMENT),
+      m_maxChunk(m_capacity / 4)
+{
+    m_ring = m_backend->AllocateStagingRing(m_capacity);
+    m_stats.ringCapacity = m_capacity;
+}
+
+UploadScheduler::~UploadScheduler()
+{
+    // The GPU may still be reading the ring.
+    WaitIdle();
+}
+
+void UploadScheduler::Enqueue(void* destination, uint64_t destinationOffset, const void* data, uint64_t size)
+{
+    const auto* source = static_cast<const uint8_t*>(data);
+    ++m_stats.uploads;
+    m_stats.bytes += size;
+
+    for (uint64_t done = 0; done < size;)
+    {
+        const uint64_t chunk = std::min(size - done, m_maxChunk);
+        const uint64_t offset = AllocateStaging(chunk);
+        if (source)
+            std::memcpy(m_ring + offset, source + done, chunk);
+        else
+            std::memset(m_ring + offset, 0, chunk);
+
+        // Taken after AllocateStaging, which may have submitted the pending copies.
+        UploadCopy* last = m_pending.empty() ? nullptr : &m_pending.back();
+        if (last && last->destination == destination
+            && last->destinationOffset + last->size == destinationOffset + done
+            && last->stagingOffset + last->size == offset)
+            last->size += chunk;
+        else
+            m_pending.push_back({ destination, destinationOffset + done, offset, chunk });
+        done += chunk;
+    }
+}
+
+uint64_t UploadScheduler::Submit()
+{
+    if (m_pending.empty())
+        return 0;
+
+    const uint64_t fence = m_backend->Submit(m_pending);
+    m_inFlight.push_back({ fence, m_head });
+    m_stats.copies += m_pending.size();
+    ++m_stats.submissions;
+    m_pending.clear();
+    return fence;
+}
+
+void UploadScheduler::WaitIdle()
+{
+    Submit();
+    if (!m_inFlight.empty())
+        m_backend->WaitForFence(m_inFlight.back().fence);
+    Reclaim();
+}
+
+uint64_t UploadScheduler::AllocateStaging(uint64_t bytes)
+{
+    const uint64_t aligned = AlignUp(bytes, STAGING_ALIGNMENT);
+    assert(aligned <= m_capacity);
+
+    for (;;)
+    {
+        Reclaim();
+
+        // A copy never wraps; the end of the ring is skipped instead.
+        uint64_t start = m_head;
+        const uint64_t offset = start % m_capacity;
+        if (offset + aligned > m_capacity)
+        {
+            start += m_capacity - offset;
+            // Nothing staged or in flight: the skipped end holds no data either.
+            if (m_tail == m_head)
+                m_tail = start;
+        }
+        if (start + aligned - m_tail <= m_capacity)
+        {
+            m_head = start + aligned;
+            m_stats.ringPeak = std::max(m_stats.ringPeak, m_head - m_tail);
+            return start % m_capacity;
+        }
+
+        // Ring full: pending copies go out first, then the oldest batch must finish.
+        Submit();
+        assert(!m_inFlight.empty());
+        ++m_stats.stalls;
+        m_backend->WaitForFence(m_inFlight.front().fence);
+    }
+}
+
+void UploadScheduler::Reclaim()
+{
+    if (m_inFlight.empty())
+        return;
+
+    const uint64_t completed = m_backend->GetCompletedFence();
+    while (!m_inFlight.empty() && m_inFlight.front().fence <= completed)
+    {
+        m_tail = m_inFlight.front().head;
+        m_inFlight.pop_front();
+    }
+}
+
+UploadScheduler::Stats UploadScheduler::GetStats() const
+{
+    Stats stats = m_stats;
+    stats.ringInUse = m_head - m_tail;
+    stats.pendingCopies = m_pending.size();
+    return stats;
+}
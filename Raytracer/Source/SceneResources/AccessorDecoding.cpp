@@ -0,0 +1,295 @@
+#include "SceneResources/AccessorDecoding.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#define ACCESSOR_DECODING_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace AccessorDecoding
+{
+namespace
+{
+    template <typename T>
+    float NormalizedScale()
+    {
+        return 1.0f / static_cast<float>(std::numeric_limits<T>::max());
+    }
+
+    // Scalar path for any integer component type.
+    template <typename T>
+    void DecodeIntegers(const AccessorView& view, float* dst, size_t dstStrideBytes, int components)
+    {
+        const size_t stride = EffectiveStride(view);
+        const float scale = view.normalized ? NormalizedScale<T>() : 1.0f;
+        const bool clampSigned = view.normalized && std::numeric_limits<T>::is_signed;
+
+        auto* out = reinterpret_cast<uint8_t*>(dst);
+        for (size_t i = 0; i < view.count; ++i)
+        {
+            const uint8_t* src = view.data + i * stride;
+            float* element = reinterpret_cast<float*>(out + i * dstStrideBytes);
+            for (int c = 0; c < components; ++c)
+            {
+                T value;
+                std::memcpy(&value, src + c * sizeof(T), sizeof(T));
+                const float f = static_cast<float>(value) * scale;
+                element[c] = clampSigned ? std::max(f, -1.0f) : f;
+            }
+        }
+    }
+
+#ifdef ACCESSOR_DECODING_SSE2
+    // Four components widened to int32 lanes, converted and scaled in one go.
+    template <ComponentType Type>
+    inline __m128i LoadWidened(const uint8_t* src)
+    {
+        if constexpr (Type == ComponentType::UnsignedByte || Type == ComponentType::Byte)
+        {
+            uint32_t packed;
+            std::memcpy(&packed, src, 4);
+            const __m128i bytes = _mm_cvtsi32_si128(static_cast<int>(packed));
+            const __m128i zero = _mm_setzero_si128();
+            if constexpr (Type == ComponentType::UnsignedByte)
+                return _mm_unpacklo_epi16(_mm_unpacklo_epi8(bytes, zero), zero);
+            // Sign-extend by placing each byte in the top of its lane and shifting back.
+            return _mm_srai_epi32(_mm_unpacklo_epi16(zero, _mm_unpacklo_epi8(zero, bytes)), 24);
+        }
+        else if constexpr (Type == ComponentType::UnsignedShort)
+        {
+            return _mm_unpacklo_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(src)), _mm_setzero_si128());
+        }
+        else
+        {
+            return _mm_srai_epi32(_mm_unpacklo_epi16(_mm_setzero_si128(), _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src))), 16);
+        }
+    }
+
+    // One loop per component type and destination width, so neither is
+    // branched on per element.
+    template <ComponentType Type, typename T>
+    void DecodeVec4Sse(const AccessorView& view, float* dst, size_t dstStrideBytes, int components)
+    {
+        const size_t stride = EffectiveStride(view);
+        const __m128 scale = _mm_set1_ps(view.normalized ? NormalizedScale<T>() : 1.0f);
+        const __m128 lower = _mm_set1_ps(view.normalized && std::numeric_limits<T>::is_signed ? -1.0f : -std::numeric_limits<float>::max());
+        auto* out = reinterpret_cast<uint8_t*>(dst);
+        auto decode = [&](size_t i) { return _mm_max_ps(_mm_mul_ps(_mm_cvtepi32_ps(LoadWidened<Type>(view.data + i * stride)), scale), lower); };
+        switch (components)
+        {
+        case 4:
+            for (size_t i = 0; i < view.count; ++i)
+                _mm_storeu_ps(reinterpret_cast<float*>(out + i * dstStrideBytes), decode(i));
+            break;
+        case 3:
+            for (size_t i = 0; i < view.count; ++i)
+            {
+                float* element = reinterpret_cast<float*>(out + i * dstStrideBytes);
+                const __m128 f = decode(i);
+                _mm_storel_pi(reinterpret_cast<__m64*>(element), f);
+                _mm_store_ss(element + 2, _mm_movehl_ps(f, f));
+            }
+            break;
+        default:
+        {
+            alignas(16) float lanes[4];
+            for (size_t i = 0; i < view.count; ++i)
+            {
+                _mm_store_ps(lanes, decode(i));
+                std::memcpy(out + i * dstStrideBytes, lanes, static_cast<size_t>(components) * sizeof(float));
+            }
+            break;
+        }
+        }
+    }
+
+    // VEC4 integer streams (tangents, colours, joints/weights). The 4-component
+    // load never reads past the element, so every element takes the SIMD path.
+    bool DecodeIntegerVec4Sse(const AccessorView& view, float* dst, size_t dstStrideBytes, int components)
+    {
+        switch (view.componentType)
+        {
+        case ComponentType::UnsignedByte:  DecodeVec4Sse<ComponentType::UnsignedByte, uint8_t>(view, dst, dstStrideBytes, components); return true;
+        case ComponentType::Byte:          DecodeVec4Sse<ComponentType::Byte, int8_t>(view, dst, dstStrideBytes, components); return true;
+        case ComponentType::UnsignedShort: DecodeVec4Sse<ComponentType::UnsignedShort, uint16_t>(view, dst, dstStrideBytes, components); return true;
+        case ComponentType::Short:         DecodeVec4Sse<ComponentType::Short, int16_t>(view, dst, dstStrideBytes, components); return true;
+        default: return false;
+        }
+    }
+#endif
+
+    void DecodeFloatComponents(const AccessorView& view, float* dst, size_t dstStrideBytes, int components)
+    {
+        const size_t stride = EffectiveStride(view);
+        auto* out = reinterpret_cast<uint8_t*>(dst);
+
+        // Fixed-size copies let the compiler emit single moves per element.
+        switch (components)
+        {
+        case 2:
+            for (size_t i = 0; i < view.count; ++i)
+                std::memcpy(out + i * dstStrideBytes, view.data + i * stride, 2 * sizeof(float));
+            break;
+        case 3:
+            for (size_t i = 0; i < view.count; ++i)
+                std::memcpy(out + i * dstStrideBytes, view.data + i * stride, 3 * sizeof(float));
+            break;
+        case 4:
+            for (size_t i = 0; i < view.count; ++i)
+                std::memcpy(out + i * dstStrideBytes, view.data + i * stride, 4 * sizeof(float));
+            break;
+        default:
+            for (size_t i = 0; i < view.count; ++i)
+                std::memcpy(out + i * dstStrideBytes, view.data + i * stride, components * sizeof(float));
+            break;
+        }
+    }
+}
+
+size_t ComponentSize(ComponentType type)
+{
+    switch (type)
+    {
+    case ComponentType::Byte:
+    case ComponentType::UnsignedByte:  return 1;
+    case ComponentType::Short:
+    case ComponentType::UnsignedShort: return 2;
+    case ComponentType::UnsignedInt:
+    case ComponentType::Float:         return 4;
+    }
+    return 0;
+}
+
+size_t ElementSize(const AccessorView& view)
+{
+    return ComponentSize(view.componentType) * static_cast<size_t>(view.componentCount);
+}
+
+size_t EffectiveStride(const AccessorView& view)
+{
+    return view.stride != 0 ? view.stride : ElementSize(view);
+}
+
+size_t RequiredBytes(const AccessorView& view)
+{
+    if (view.count == 0)
+        return 0;
+    return (view.count - 1) * EffectiveStride(view) + ElementSize(view);
+}
+
+bool DecodeFloats(const AccessorView& view, float* dst, size_t dstStrideBytes, int dstComponents)
+{
+    const int components = std::min(view.componentCount, dstComponents);
+    if (view.count == 0 || components <= 0)
+        return true;
+
+    switch (view.componentType)
+    {
+    case ComponentType::Float:
+        DecodeFloatComponents(view, dst, dstStrideBytes, components);
+        return true;
+    case ComponentType::UnsignedByte:
+#ifdef ACCESSOR_DECODING_SSE2
+        if (view.componentCount == 4) return DecodeIntegerVec4Sse(view, dst, dstStrideBytes, components);
+#endif
+        DecodeIntegers<uint8_t>(view, dst, dstStrideBytes, components);
+        return true;
+    case ComponentType::Byte:
+#ifdef ACCESSOR_DECODING_SSE2
+        if (view.componentCount == 4) return DecodeIntegerVec4Sse(view, dst, dstStrideBytes, components);
+#endif
+        DecodeIntegers<int8_t>(view, dst, dstStrideBytes, components);
+        return true;
+    case ComponentType::UnsignedShort:
+#ifdef ACCESSOR_DECODING_SSE2
+        if (view.componentCount == 4) return DecodeIntegerVec4Sse(view, dst, dstStrideBytes, components);
+#endif
+        DecodeIntegers<uint16_t>(view, dst, dstStrideBytes, components);
+        return true;
+    case ComponentType::Short:
+#ifdef ACCESSOR_DECODING_SSE2
+        if (view.componentCount == 4) return DecodeIntegerVec4Sse(view, dst, dstStrideBytes, components);
+#endif
+        DecodeIntegers<int16_t>(view, dst, dstStrideBytes, components);
+        return true;
+    case ComponentType::UnsignedInt:
+        DecodeIntegers<uint32_t>(view, dst, dstStrideBytes, components);
+        return true;
+    }
+    return false;
+}
+
+bool DecodeIndices(const AccessorView& view, uint32_t* dst)
+{
+    const size_t stride = EffectiveStride(view);
+    const size_t size = ComponentSize(view.componentType);
+    const bool tight = stride == size;
+
+    switch (view.componentType)
+    {
+    case ComponentType::UnsignedInt:
+        if (tight)
+        {
+            std::memcpy(dst, view.data, view.count * sizeof(uint32_t));
+            return true;
+        }
+        for (size_t i = 0; i < view.count; ++i)
+            std::memcpy(&dst[i], view.data + i * stride, sizeof(uint32_t));
+        return true;
+
+    case ComponentType::UnsignedShort:
+    {
+        size_t i = 0;
+#ifdef ACCESSOR_DECODING_SSE2
+        if (tight)
+        {
+            const __m128i zero = _mm_setzero_si128();
+            for (; i + 8 <= view.count; i += 8)
+            {
+                const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(view.data + i * 2));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_unpacklo_epi16(v, zero));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 4), _mm_unpackhi_epi16(v, zero));
+            }
+        }
+#endif
+        for (; i < view.count; ++i)
+        {
+            uint16_t value;
+            std::memcpy(&value, view.data + i * stride, sizeof(value));
+            dst[i] = value;
+        }
+        return true;
+    }
+
+    case ComponentType::UnsignedByte:
+    {
+        size_t i = 0;
+#ifdef ACCESSOR_DECODING_SSE2
+        if (tight)
+        {
+            const __m128i zero = _mm_setzero_si128();
+            for (; i + 16 <= view.count; i += 16)
+            {
+                const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(view.data + i));
+                const __m128i lo = _mm_unpacklo_epi8(v, zero);
+                const __m128i hi = _mm_unpackhi_epi8(v, zero);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_unpacklo_epi16(lo, zero));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 4), _mm_unpackhi_epi16(lo, zero));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 8), _mm_unpacklo_epi16(hi, zero));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 12), _mm_unpackhi_epi16(hi, zero));
+            }
+        }
+#endif
+        for (; i < view.count; ++i)
+            dst[i] = view.data[i * stride];
+        return true;
+    }
+
+    default:
+        return false;
+    }
+}
+}
@@ -0,0 +1,638 @@
+#include "SceneResources/BlockCompression.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "Utils/ThreadPool.h"
+
+namespace BlockCompression
+{
+namespace
+{
+    // BC7 4-bit index interpolation weights (out of 64).
+    constexpr int kBC7Weights4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+    // Nearest kBC7Weights4 entry for each weight 0..64.
+    const struct BC7IndexTable
+    {
+        int index[65];
+
+        BC7IndexTable()
+        {
+            for (int weight = 0; weight <= 64; ++weight)
+            {
+                int best = 0;
+                for (int k = 1; k < 16; ++k)
+                    if (std::abs(kBC7Weights4[k] - weight) < std::abs(kBC7Weights4[best] - weight))
+                        best = k;
+                index[weight] = best;
+            }
+        }
+
+        int operator[](int weight) const { return index[weight]; }
+    } kBC7IndexForWeight;
+
+    // Dominant direction of the block's colour distribution (power iteration on
+    // the covariance). Falls back to the grey diagonal for flat blocks.
+    void PrincipalAxis(const float points[16][4], int dims, const float mean[4], float axis[4])
+    {
+        float covariance[4][4] = {};
+        for (int i = 0; i < 16; ++i)
+        {
+            float d[4];
+            for (int c = 0; c < dims; ++c)
+                d[c] = points[i][c] - mean[c];
+            for (int r = 0; r < dims; ++r)
+                for (int c = 0; c < dims; ++c)
+                    covariance[r][c] += d[r] * d[c];
+        }
+
+        float v[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+        for (int iteration = 0; iteration < 8; ++iteration)
+        {
+            float next[4] = {};
+            for (int r = 0; r < dims; ++r)
+                for (int c = 0; c < dims; ++c)
+                    next[r] += covariance[r][c] * v[c];
+
+            float length = 0.0f;
+            for (int c = 0; c < dims; ++c)
+                length += next[c] * next[c];
+            length = std::sqrt(length);
+            if (length < 1e-8f)
+                break;
+            for (int c = 0; c < dims; ++c)
+                v[c] = next[c] / length;
+        }
+
+        float length = 0.0f;
+        for (int c = 0; c < dims; ++c)
+            length += v[c] * v[c];
+        length = std::sqrt(length);
+        for (int c = 0; c < 4; ++c)
+            axis[c] = c < dims ? v[c] / length : 0.0f;
+    }
+
+    // Endpoints at the extremes of the block's projection onto its principal axis.
+    void FitEndpoints(const float points[16][4], int dims, float e0[4], float e1[4])
+    {
+        float mean[4] = {};
+        for (int i = 0; i < 16; ++i)
+            for (int c = 0; c < dims; ++c)
+                mean[c] += points[i][c] * (1.0f / 16.0f);
+
+        float axis[4];
+        PrincipalAxis(points, dims, mean, axis);
+
+        float tMin = 0.0f, tMax = 0.0f;
+        for (int i = 0; i < 16; ++i)
+        {
+            float t = 0.0f;
+            for (int c = 0; c < dims; ++c)
+                t += (points[i][c] - mean[c]) * axis[c];
+            tMin = std::min(tMin, t);
+            tMax = std::max(tMax, t);
+        }
+        for (int c = 0; c < 4; ++c)
+        {
+            e0[c] = c < dims ? std::clamp(mean[c] + axis[c] * tMin, 0.0f, 255.0f) : 0.0f;
+            e1[c] = c < dims ? std::clamp(mean[c] + axis[c] * tMax, 0.0f, 255.0f) : 0.0f;
+        }
+    }
+
+    // Least-squares endpoints for fixed interpolation weights w_i in [0, 1]
+    // (value = (1 - w) * e0 + w * e1). False if the system is singular.
+    bool RefineEndpoints(const float points[16][4], int dims, const float weights[16], float e0[4], float e1[4])
+    {
+        float a = 0.0f, b = 0.0f, c = 0.0f;
+        float x[4] = {}, y[4] = {};
+        for (int i = 0; i < 16; ++i)
+        {
+            const float w = weights[i];
+            const float iw = 1.0f - w;
+            a += iw * iw;
+            b += iw * w;
+            c += w * w;
+            for (int k = 0; k < dims; ++k)
+            {
+                x[k] += iw * points[i][k];
+                y[k] += w * points[i][k];
+            }
+        }
+        const float determinant = a * c - b * b;
+        if (std::fabs(determinant) < 1e-6f)
+            return false;
+        for (int k = 0; k < dims; ++k)
+        {
+            e0[k] = std::clamp((c * x[k] - b * y[k]) / determinant, 0.0f, 255.0f);
+            e1[k] = std::clamp((a * y[k] - b * x[k]) / determinant, 0.0f, 255.0f);
+        }
+        return true;
+    }
+
+    // Endpoint values are clamped to [0, 255] before quantization.
+    int QuantizeNonNegative(float value, float scale)
+    {
+        return static_cast<int>(std::max(value, 0.0f) * scale + 0.5f);
+    }
+
+    // ---- BC1 ----
+
+    uint16_t To565(const float color[4])
+    {
+        const int r = QuantizeNonNegative(color[0], 31.0f / 255.0f);
+        const int g = QuantizeNonNegative(color[1], 63.0f / 255.0f);
+        const int b = QuantizeNonNegative(color[2], 31.0f / 255.0f);
+        return static_cast<uint16_t>((std::clamp(r, 0, 31) << 11) | (std::clamp(g, 0, 63) << 5) | std::clamp(b, 0, 31));
+    }
+
+    void From565(uint16_t value, int out[3])
+    {
+        const int r = (value >> 11) & 31;
+        const int g = (value >> 5) & 63;
+        const int b = value & 31;
+        out[0] = (r << 3) | (r >> 2);
+        out[1] = (g << 2) | (g >> 4);
+        out[2] = (b << 3) | (b >> 2);
+    }
+
+    // Four-colour palette (c0 > c1); three-colour + black otherwise.
+    void BC1Palette(uint16_t c0, uint16_t c1, int palette[4][3])
+    {
+        From565(c0, palette[0]);
+        From565(c1, palette[1]);
+        for (int k = 0; k < 3; ++k)
+        {
+            if (c0 > c1)
+            {
+                palette[2][k] = (2 * palette[0][k] + palette[1][k] + 1) / 3;
+                palette[3][k] = (palette[0][k] + 2 * palette[1][k] + 1) / 3;
+            }
+            else
+            {
+                palette[2][k] = (palette[0][k] + palette[1][k]) / 2;
+                palette[3][k] = 0;
+            }
+        }
+    }
+
+    // ---- BC4 ----
+
+    void BC4Palette(int r0, int r1, int palette[8])
+    {
+        palette[0] = r0;
+        palette[1] = r1;
+        if (r0 > r1)
+        {
+            for (int k = 1; k <= 6; ++k)
+                palette[k + 1] = ((7 - k) * r0 + k * r1 + 3) / 7;
+        }
+        else
+        {
+            for (int k = 1; k <= 4; ++k)
+                palette[k + 1] = ((5 - k) * r0 + k * r1 + 2) / 5;
+            palette[6] = 0;
+            palette[7] = 255;
+        }
+    }
+
+    // ---- BC7 bit I/O (LSB first) ----
+
+    struct BitWriter
+    {
+        uint8_t* out;
+        int position = 0;
+
+        void Write(uint32_t value, int bits)
+        {
+            for (int i = 0; i < bits; ++i, ++position)
+                if (value & (1u << i))
+                    out[position >> 3] |= static_cast<uint8_t>(1u << (position & 7));
+        }
+    };
+
+    struct BitReader
+    {
+        const uint8_t* in;
+        int position = 0;
+
+        uint32_t Read(int bits)
+        {
+            uint32_t value = 0;
+            for (int i = 0; i < bits; ++i, ++position)
+                value |= static_cast<uint32_t>((in[position >> 3] >> (position & 7)) & 1) << i;
+            return value;
+        }
+    };
+
+    void GatherBlock(const uint8_t* rgba, int width, int height, int blockX, int blockY, uint8_t texels[64])
+    {
+        for (int y = 0; y < 4; ++y)
+        {
+            const int sy = std::min(blockY * 4 + y, height - 1);
+            for (int x = 0; x < 4; ++x)
+            {
+                const int sx = std::min(blockX * 4 + x, width - 1);
+                std::memcpy(texels + (y * 4 + x) * 4, rgba + (static_cast<size_t>(sy) * width + sx) * 4, 4);
+            }
+        }
+    }
+}
+
+size_t CompressedSize(int width, int height, BlockFormat format)
+{
+    const size_t blocksX = static_cast<size_t>((width + 3) / 4);
+    const size_t blocksY = static_cast<size_t>((height + 3) / 4);
+    return blocksX * blocksY * BlockBytes(format);
+}
+
+void EncodeBC1(const uint8_t texels[64], uint8_t out[8])
+{
+    float points[16][4];
+    for (int i = 0; i < 16; ++i)
+        for (int c = 0; c < 4; ++c)
+            points[i][c] = texels[i * 4 + c];
+
+    float e0[4], e1[4];
+    FitEndpoints(points, 3, e0, e1);
+
+    uint16_t bestC0 = 0, bestC1 = 0;
+    uint32_t bestIndices = 0;
+    int bestError = -1;
+    for (int iteration = 0; iteration < 3; ++iteration)
+    {
+        uint16_t c0 = To565(e1); // brighter end first: c0 > c1 selects 4-colour mode
+        uint16_t c1 = To565(e0);
+        if (c0 < c1)
+            std::swap(c0, c1);
+
+        int palette[4][3];
+        BC1Palette(c0, c1, palette);
+
+        uint32_t indices = 0;
+        int error = 0;
+        float weights[16];
+        static constexpr float kWeightOf[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+        for (int i = 0; i < 16; ++i)
+        {
+            int best = 0, bestDistance = INT32_MAX;
+            const int candidates = c0 == c1 ? 1 : 4;
+            for (int k = 0; k < candidates; ++k)
+            {
+                const int dr = palette[k][0] - texels[i * 4 + 0];
+                const int dg = palette[k][1] - texels[i * 4 + 1];
+                const int db = palette[k][2] - texels[i * 4 + 2];
+                const int distance = dr * dr + dg * dg + db * db;
+                if (distance < bestDistance)
+                {
+                    bestDistance = distance;
+                    best = k;
+                }
+            }
+            indices |= static_cast<uint32_t>(best) << (2 * i);
+            error += bestDistance;
+            weights[i] = kWeightOf[best];
+        }
+
+        if (bestError < 0 || error < bestError)
+        {
+            bestError = error;
+            bestC0 = c0;
+            bestC1 = c1;
+            bestIndices = indices;
+        }
+        if (error == 0 || c0 == c1)
+            break;
+
+        // Refit in palette order: weight 0 is c0's endpoint.
+        float r0[4], r1[4];
+        if (!RefineEndpoints(points, 3, weights, r0, r1))
+            break;
+        std::memcpy(e1, r0, sizeof(r0));
+        std::memcpy(e0, r1, sizeof(r1));
+    }
+
+    out[0] = static_cast<uint8_t>(bestC0);
+    out[1] = static_cast<uint8_t>(bestC0 >> 8);
+    out[2] = static_cast<uint8_t>(bestC1);
+    out[3] = static_cast<uint8_t>(bestC1 >> 8);
+    std::memcpy(out + 4, &bestIndices, 4);
+}
+
+void EncodeBC4(const uint8_t values[16], uint8_t out[8])
+{
+    int minimum = 255, maximum = 0;
+    for (int i = 0; i < 16; ++i)
+    {
+        minimum = std::min<int>(minimum, values[i]);
+        maximum = std::max<int>(maximum, values[i]);
+    }
+
+    std::memset(out, 0, 8);
+    out[0] = static_cast<uint8_t>(maximum);
+    out[1] = static_cast<uint8_t>(minimum);
+    if (maximum == minimum)
+        return;
+
+    int palette[8];
+    BC4Palette(maximum, minimum, palette);
+
+    uint64_t indices = 0;
+    for (int i = 0; i < 16; ++i)
+    {
+        int best = 0, bestDistance = INT32_MAX;
+        for (int k = 0; k < 8; ++k)
+        {
+            const int distance = std::abs(palette[k] - values[i]);
+            if (distance < bestDistance)
+            {
+                bestDistance = distance;
+                best = k;
+            }
+        }
+        indices |= static_cast<uint64_t>(best) << (3 * i);
+    }
+    for (int b = 0; b < 6; ++b)
+        out[2 + b] = static_cast<uint8_t>(indices >> (8 * b));
+}
+
+void EncodeBC5(const uint8_t texels[64], uint8_t out[16])
+{
+    uint8_t red[16], green[16];
+    for (int i = 0; i < 16; ++i)
+    {
+        red[i] = texels[i * 4 + 0];
+        green[i] = texels[i * 4 + 1];
+    }
+    EncodeBC4(red, out);
+    EncodeBC4(green, out + 8);
+}
+
+void EncodeBC7(const uint8_t texels[64], uint8_t out[16])
+{
+    float points[16][4];
+    for (int i = 0; i < 16; ++i)
+        for (int c = 0; c < 4; ++c)
+            points[i][c] = texels[i * 4 + c];
+
+    float e0[4], e1[4];
+    FitEndpoints(points, 4, e0, e1);
+
+    int bestEndpoints[2][4] = {};
+    int bestPBits[2] = {};
+    int bestIndices[16] = {};
+    int bestError = -1;
+    for (int iteration = 0; iteration < 2; ++iteration)
+    {
+        int iterationError = -1;
+        int iterationIndices[16] = {};
+        // Each endpoint shares one p-bit (the LSB) across its four channels.
+        for (int pBits = 0; pBits < 4; ++pBits)
+        {
+            const int p[2] = { pBits & 1, pBits >> 1 };
+            int endpoints[2][4];
+            for (int c = 0; c < 4; ++c)
+            {
+                const int q0 = std::min(QuantizeNonNegative(e0[c] - p[0], 0.5f), 127);
+                const int q1 = std::min(QuantizeNonNegative(e1[c] - p[1], 0.5f), 127);
+                endpoints[0][c] = q0;
+                endpoints[1][c] = q1;
+            }
+
+            int palette[16][4];
+            for (int k = 0; k < 16; ++k)
+            {
+                for (int c = 0; c < 4; ++c)
+                {
+                    const int a = (endpoints[0][c] << 1) | p[0];
+                    const int b = (endpoints[1][c] << 1) | p[1];
+                    palette[k][c] = ((64 - kBC7Weights4[k]) * a + kBC7Weights4[k] * b + 32) >> 6;
+                }
+            }
+
+            // Project onto the endpoint segment for the nearest weight, then
+            // settle between it and its neighbours on actual error.
+            int axis[4], axisLength = 0;
+            for (int c = 0; c < 4; ++c)
+            {
+                axis[c] = palette[15][c] - palette[0][c];
+                axisLength += axis[c] * axis[c];
+            }
+
+            const float toWeight = axisLength > 0 ? 64.0f / static_cast<float>(axisLength) : 0.0f;
+
+            int indices[16];
+            int error = 0;
+            for (int i = 0; i < 16; ++i)
+            {
+                int dot = 0;
+                for (int c = 0; c < 4; ++c)
+                    dot += (texels[i * 4 + c] - palette[0][c]) * axis[c];
+                const int guess = kBC7IndexForWeight[std::clamp(static_cast<int>(static_cast<float>(dot) * toWeight + 0.5f), 0, 64)];
+
+                int best = guess, bestDistance = INT32_MAX;
+                for (int k = std::max(guess - 1, 0); k <= std::min(guess + 1, 15); ++k)
+                {
+                    int distance = 0;
+                    for (int c = 0; c < 4; ++c)
+                    {
+                        const int d = palette[k][c] - texels[i * 4 + c];
+                        distance += d * d;
+                    }
+                    if (distance < bestDistance)
+                    {
+                        bestDistance = distance;
+                        best = k;
+                    }
+                }
+                indices[i] = best;
+                error += bestDistance;
+            }
+
+            if (iterationError < 0 || error < iterationError)
+            {
+                iterationError = error;
+                std::memcpy(iterationIndices, indices, sizeof(indices));
+            }
+            if (bestError < 0 || error < bestError)
+            {
+                bestError = error;
+                std::memcpy(bestEndpoints, endpoints, sizeof(endpoints));
+                bestPBits[0] = p[0];
+                bestPBits[1] = p[1];
+                std::memcpy(bestIndices, indices, sizeof(indices));
+            }
+        }
+        if (bestError == 0)
+            break;
+
+        float weights[16];
+        for (int i = 0; i < 16; ++i)
+            weights[i] = static_cast<float>(kBC7Weights4[iterationIndices[i]]) / 64.0f;
+        if (!RefineEndpoints(points, 4, weights, e0, e1))
+            break;
+    }
+
+    // The anchor (texel 0) index is stored with its top bit implied zero.
+    if (bestIndices[0] & 8)
+    {
+        for (int c = 0; c < 4; ++c)
+            std::swap(bestEndpoints[0][c], bestEndpoints[1][c]);
+        std::swap(bestPBits[0], bestPBits[1]);
+        for (int& index : bestIndices)
+            index = 15 - index;
+    }
+
+    std::memset(out, 0, 16);
+    BitWriter writer{ out };
+    writer.Write(1u << 6, 7); // mode 6
+    for (int c = 0; c < 4; ++c)
+    {
+        writer.Write(static_cast<uint32_t>(bestEndpoints[0][c]), 7);
+        writer.Write(static_cast<uint32_t>(bestEndpoints[1][c]), 7);
+    }
+    writer.Write(static_cast<uint32_t>(bestPBits[0]), 1);
+    writer.Write(static_cast<uint32_t>(bestPBits[1]), 1);
+    for (int i = 0; i < 16; ++i)
+        writer.Write(static_cast<uint32_t>(bestIndices[i]), i == 0 ? 3 : 4);
+}
+
+void DecodeBC1(const uint8_t block[8], uint8_t texels[64])
+{
+    const uint16_t c0 = static_cast<uint16_t>(block[0] | (block[1] << 8));
+    const uint16_t c1 = static_cast<uint16_t>(block[2] | (block[3] << 8));
+    uint32_t indices;
+    std::memcpy(&indices, block + 4, 4);
+
+    int palette[4][3];
+    BC1Palette(c0, c1, palette);
+    for (int i = 0; i < 16; ++i)
+    {
+        const int index = (indices >> (2 * i)) & 3;
+        for (int c = 0; c < 3; ++c)
+            texels[i * 4 + c] = static_cast<uint8_t>(palette[index][c]);
+        texels[i * 4 + 3] = c0 <= c1 && index == 3 ? 0 : 255;
+    }
+}
+
+void DecodeBC4(const uint8_t block[8], uint8_t texels[64])
+{
+    int palette[8];
+    BC4Palette(block[0], block[1], palette);
+
+    uint64_t indices = 0;
+    for (int b = 0; b < 6; ++b)
+        indices |= static_cast<uint64_t>(block[2 + b]) << (8 * b);
+    for (int i = 0; i < 16; ++i)
+    {
+        texels[i * 4 + 0] = static_cast<uint8_t>(palette[(indices >> (3 * i)) & 7]);
+        texels[i * 4 + 1] = 0;
+        texels[i * 4 + 2] = 0;
+        texels[i * 4 + 3] = 255;
+    }
+}
+
+void DecodeBC5(const uint8_t block[16], uint8_t texels[64])
+{
+    uint8_t green[64];
+    DecodeBC4(block, texels);
+    DecodeBC4(block + 8, green);
+    for (int i = 0; i < 16; ++i)
+        texels[i * 4 + 1] = green[i * 4];
+}
+
+void DecodeBC7(const uint8_t block[16], uint8_t texels[64])
+{
+    if ((block[0] & 0x7f) != 0x40)
+    {
+        std::memset(texels, 0, 64);
+        return;
+    }
+
+    BitReader reader{ block, 7 };
+    int endpoints[2][4];
+    for (int c = 0; c < 4; ++c)
+    {
+        endpoints[0][c] = static_cast<int>(reader.Read(7)) << 1;
+        endpoints[1][c] = static_cast<int>(reader.Read(7)) << 1;
+    }
+    const int p0 = static_cast<int>(reader.Read(1));
+    const int p1 = static_cast<int>(reader.Read(1));
+    for (int c = 0; c < 4; ++c)
+    {
+        endpoints[0][c] |= p0;
+        endpoints[1][c] |= p1;
+    }
+    for (int i = 0; i < 16; ++i)
+    {
+        const int weight = kBC7Weights4[reader.Read(i == 0 ? 3 : 4)];
+        for (int c = 0; c < 4; ++c)
+            texels[i * 4 + c] = static_cast<uint8_t>(((64 - weight) * endpoints[0][c] + weight * endpoints[1][c] + 32) >> 6);
+    }
+}
+
+std::vector<uint8_t> Compress(const uint8_t* rgba, int width, int height, BlockFormat format)
+{
+    const int blocksX = (width + 3) / 4;
+    const int blocksY = (height + 3) / 4;
+    const size_t blockBytes = BlockBytes(format);
+    std::vector<uint8_t> blocks(CompressedSize(width, height, format));
+
+    const size_t grain = std::max<size_t>(1, 256 / static_cast<size_t>(blocksX));
+    ThreadPool::Get().ParallelForRange(static_cast<size_t>(blocksY), grain, [&](size_t begin, size_t end)
+    {
+        uint8_t texels[64];
+        for (size_t by = begin; by < end; ++by)
+        {
+            for (int bx = 0; bx < blocksX; ++bx)
+            {
+                GatherBlock(rgba, width, height, bx, static_cast<int>(by), texels);
+                uint8_t* out = blocks.data() + (by * blocksX + bx) * blockBytes;
+                switch (format)
+                {
+                case BlockFormat::BC1: EncodeBC1(texels, out); break;
+                case BlockFormat::BC4:
+                {
+                    uint8_t red[16];
+                    for (int i = 0; i < 16; ++i)
+                        red[i] = texels[i * 4];
+                    EncodeBC4(red, out);
+                    break;
+                }
+                case BlockFormat::BC5: EncodeBC5(texels, out); break;
+                case BlockFormat::BC7: EncodeBC7(texels, out); break;
+                }
+            }
+        }
+    });
+    return blocks;
+}
+
+void Decompress(const uint8_t* blocks, int width, int height, BlockFormat format, std::vector<uint8_t>& rgba)
+{
+    const int blocksX = (width + 3) / 4;
+    const int blocksY = (height + 3) / 4;
+    const size_t blockBytes = BlockBytes(format);
+    rgba.resize(static_cast<size_t>(width) * height * 4);
+
+    uint8_t texels[64];
+    for (int by = 0; by < blocksY; ++by)
+    {
+        for (int bx = 0; bx < blocksX; ++bx)
+        {
+            const uint8_t* block = blocks + (static_cast<size_t>(by) * blocksX + bx) * blockBytes;
+            switch (format)
+            {
+            case BlockFormat::BC1: DecodeBC1(block, texels); break;
+            case BlockFormat::BC4: DecodeBC4(block, texels); break;
+            case BlockFormat::BC5: DecodeBC5(block, texels); break;
+            case BlockFormat::BC7: DecodeBC7(block, texels); break;
+            }
+            for (int y = 0; y < 4 && by * 4 + y < height; ++y)
+                for (int x = 0; x < 4 && bx * 4 + x < width; ++x)
+                    std::memcpy(rgba.data() + ((static_cast<size_t>(by) * 4 + y) * width + bx * 4 + x) * 4, texels + (y * 4 + x) * 4, 4);
+        }
+    }
+}
+}
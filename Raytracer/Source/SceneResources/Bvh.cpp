@@ -0,0 +1,621 @@
+#include "SceneResources/Bvh.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <numeric>
+
+#include "Utils/ThreadPool.h"
+
+namespace
+{
+    constexpr uint32_t kMaxBins = 64;
+    // Primitives per binning task of a parallel split.
+    constexpr size_t kBinGrain = 16384;
+    constexpr size_t kTriangleGrain = 16384;
+
+    struct Centroid
+    {
+        float c[3];
+    };
+
+    struct Bin
+    {
+        BvhAabb bounds;
+        BvhAabb centroids;
+        uint32_t count = 0;
+    };
+
+    using AxisBins = std::array<std::array<Bin, kMaxBins>, 3>;
+
+    // A node's slice of the build order, with the bounds binning already knows.
+    struct BuildRange
+    {
+        uint32_t begin;
+        uint32_t end;
+        uint32_t depth;
+        BvhAabb bounds;
+        BvhAabb centroids;
+    };
+
+    struct Split
+    {
+        bool leaf = true;
+        uint32_t mid = 0;
+        BvhAabb leftBounds, leftCentroids;
+        BvhAabb rightBounds, rightCentroids;
+    };
+
+    struct BuildCounters
+    {
+        size_t leafCount = 0;
+        uint32_t maxDepth = 0;
+
+        void Add(const BuildCounters& other)
+        {
+            leafCount += other.leafCount;
+            maxDepth = std::max(maxDepth, other.maxDepth);
+        }
+    };
+
+    void SetBounds(BvhNode& node, const BvhAabb& bounds)
+    {
+        std::copy(bounds.min, bounds.min + 3, node.min);
+        std::copy(bounds.max, bounds.max + 3, node.max);
+    }
+
+    class Builder
+    {
+    public:
+        Builder(const BvhAabb* bounds, const Centroid* centroids, uint32_t* order, const BvhBuildSettings& settings)
+            : m_bounds(bounds),
+              m_centroids(centroids),
+              m_order(order),
+              m_settings(settings),
+              m_binCount(std::clamp(settings.binCount, 2u, kMaxBins))
+        {
+        }
+
+        // Bins the range on all three axes and partitions it at the cheapest
+        // SAH plane, or decides on a leaf. `bins` is scratch, reused across
+        // calls: at 64 bins it is too large to clear per node.
+        Split FindSplit(const BuildRange& range, bool parallel, AxisBins& bins) const
+        {
+            Split split;
+            const uint32_t count = range.end - range.begin;
+            if (count <= 1 || range.depth + 1 >= BvhBuilder::MAX_DEPTH)
+                return split;
+
+            float scale[3];
+            bool splittable = false;
+            for (int a = 0; a < 3; ++a)
+            {
+                const float extent = range.centroids.max[a] - range.centroids.min[a];
+                scale[a] = extent > 0.0f ? static_cast<float>(m_binCount) / extent : 0.0f;
+                splittable |= extent > 0.0f;
+            }
+            if (!splittable)
+            {
+                // Every centroid coincides: only the leaf size limit can force a split.
+                if (count <= m_settings.maxLeafSize)
+                    return split;
+                return MedianSplit(range);
+            }
+
+            if (parallel && count > 2 * kBinGrain)
+            {
+                const size_t tasks = (count + kBinGrain - 1) / kBinGrain;
+                std::vector<AxisBins> partial(tasks);
+                ThreadPool::Get().ParallelFor(tasks, [&](size_t task)
+                {
+                    ClearBins(partial[task]);
+                    const uint32_t begin = range.begin + static_cast<uint32_t>(task * kBinGrain);
+                    const uint32_t end = std::min(range.end, static_cast<uint32_t>(begin + kBinGrain));
+                    FillBins(begin, end, range.centroids, scale, partial[task]);
+                });
+                ClearBins(bins);
+                for (size_t task = 0; task < tasks; ++task)
+                {
+                    for (int a = 0; a < 3; ++a)
+                    {
+                        for (uint32_t b = 0; b < m_binCount; ++b)
+                        {
+                            bins[a][b].bounds.Grow(partial[task][a][b].bounds);
+                            bins[a][b].centroids.Grow(partial[task][a][b].centroids);
+                            bins[a][b].count += partial[task][a][b].count;
+                        }
+                    }
+                }
+            }
+            else
+            {
+                ClearBins(bins);
+                FillBins(range.begin, range.end, range.centroids, scale, bins);
+            }
+
+            // Sweep each axis from both ends: planes sit between bins b and b + 1.
+            const float nodeArea = std::max(range.bounds.HalfArea(), std::numeric_limits<float>::min());
+            float bestCost = std::numeric_limits<float>::infinity();
+            int bestAxis = -1;
+            uint32_t bestPlane = 0;
+            for (int a = 0; a < 3; ++a)
+            {
+                if (scale[a] == 0.0f)
+                    continue;
+
+                std::array<float, kMaxBins> rightCost{};
+                BvhAabb right;
+                uint32_t rightCount = 0;
+                for (uint32_t b = m_binCount - 1; b > 0; --b)
+                {
+                    right.Grow(bins[a][b].bounds);
+                    rightCount += bins[a][b].count;
+                    rightCost[b] = rightCount > 0 ? right.HalfArea() * static_cast<float>(rightCount) : -1.0f;
+                }
+
+                BvhAabb left;
+                uint32_t leftCount = 0;
+                for (uint32_t plane = 1; plane < m_binCount; ++plane)
+                {
+                    left.Grow(bins[a][plane - 1].bounds);
+                    leftCount += bins[a][plane - 1].count;
+                    if (leftCount == 0 || rightCost[plane] < 0.0f)
+                        continue;
+                    const float cost = m_settings.traversalCost + (left.HalfArea() * static_cast<float>(leftCount) + rightCost[plane]) / nodeArea;
+                    if (cost < bestCost)
+                    {
+                        bestCost = cost;
+                        bestAxis = a;
+                        bestPlane = plane;
+                    }
+                }
+            }
+
+            if (bestAxis < 0 || (bestCost >= static_cast<float>(count) && count <= m_settings.maxLeafSize))
+                return split;
+
+            const int axis = bestAxis;
+            const float minCentroid = range.centroids.min[axis];
+            const float axisScale = scale[axis];
+            uint32_t* mid = std::partition(m_order + range.begin, m_order + range.end, [&](uint32_t primitive)
+            {
+                return BinOf(m_centroids[primitive].c[axis], minCentroid, axisScale) < bestPlane;
+            });
+
+            split.leaf = false;
+            split.mid = static_cast<uint32_t>(mid - m_order);
+            for (uint32_t b = 0; b < m_binCount; ++b)
+            {
+                BvhAabb& bounds = b < bestPlane ? split.leftBounds : split.rightBounds;
+                BvhAabb& centroids = b < bestPlane ? split.leftCentroids : split.rightCentroids;
+                bounds.Grow(bins[axis][b].bounds);
+                centroids.Grow(bins[axis][b].centroids);
+            }
+            return split;
+        }
+
+        // Builds the subtree under `range` on this thread. local[0] is the
+        // subtree root; interior nodes index `local`.
+        void BuildSubtree(const BuildRange& range, std::vector<BvhNode>& local, BuildCounters& counters) const
+        {
+            struct Pending
+            {
+                uint32_t node;
+                BuildRange range;
+            };
+
+            local.clear();
+            local.push_back({});
+            std::vector<Pending> stack;
+            stack.push_back({ 0, range });
+            AxisBins bins;
+            while (!stack.empty())
+            {
+                const Pending pending = stack.back();
+                stack.pop_back();
+
+                const uint32_t child = static_cast<uint32_t>(local.size());
+                const Split split = FindSplit(pending.range, false, bins);
+                BvhNode& node = local[pending.node];
+                SetBounds(node, pending.range.bounds);
+                counters.maxDepth = std::max(counters.maxDepth, pending.range.depth);
+                if (split.leaf)
+                {
+                    node.first = pending.range.begin;
+                    node.count = pending.range.end - pending.range.begin;
+                    ++counters.leafCount;
+                    continue;
+                }
+
+                node.first = child;
+                node.count = 0;
+                local.resize(local.size() + 2);
+                // Right first, so the left subtree is laid out right after its parent.
+                stack.push_back({ child + 1, { split.mid, pending.range.end, pending.range.depth + 1, split.rightBounds, split.rightCentroids } });
+                stack.push_back({ child, { pending.range.begin, split.mid, pending.range.depth + 1, split.leftBounds, split.leftCentroids } });
+            }
+        }
+
+    private:
+        static uint32_t BinOf(float centroid, float minCentroid, float scale, uint32_t binCount)
+        {
+            const float position = (centroid - minCentroid) * scale;
+            // Also catches NaN centroids of degenerate primitives.
+            if (!(position > 0.0f))
+                return 0;
+            return std::min(static_cast<uint32_t>(position), binCount - 1);
+        }
+
+        uint32_t BinOf(float centroid, float minCentroid, float scale) const
+        {
+            return BinOf(centroid, minCentroid, scale, m_binCount);
+        }
+
+        void ClearBins(AxisBins& bins) const
+        {
+            for (int a = 0; a < 3; ++a)
+                std::fill_n(bins[a].begin(), m_binCount, Bin());
+        }
+
+        void FillBins(uint32_t begin, uint32_t end, const BvhAabb& centroids, const float scale[3], AxisBins& bins) const
+        {
+            for (uint32_t i = begin; i < end; ++i)
+            {
+                const uint32_t primitive = m_order[i];
+                const Centroid& centroid = m_centroids[primitive];
+                for (int a = 0; a < 3; ++a)
+                {
+                    if (scale[a] == 0.0f)
+                        continue;
+                    Bin& bin = bins[a][BinOf(centroid.c[a], centroids.min[a], scale[a])];
+                    bin.bounds.Grow(m_bounds[primitive]);
+                    bin.centroids.Grow(centroid.c);
+                    ++bin.count;
+                }
+            }
+        }
+
+        Split MedianSplit(const BuildRange& range) const
+        {
+            Split split;
+            split.leaf = false;
+            split.mid = range.begin + (range.end - range.begin) / 2;
+            for (uint32_t i = range.begin; i < range.end; ++i)
+            {
+                const uint32_t primitive = m_order[i];
+                (i < split.mid ? split.leftBounds : split.rightBounds).Grow(m_bounds[primitive]);
+                (i < split.mid ? split.leftCentroids : split.rightCentroids).Grow(m_centroids[primitive].c);
+            }
+            return split;
+        }
+
+        const BvhAabb* m_bounds;
+        const Centroid* m_centroids;
+        uint32_t* m_order;
+        const BvhBuildSettings& m_settings;
+        uint32_t m_binCount;
+    };
+
+    // Woop, Benthin and Wald, "Watertight Ray/Triangle Intersection" (JCGT
+    // 2013): the ray is sheared onto +z, and the edge functions of shared
+    // edges are computed from the same values, with a double-precision retry
+    // when one lands exactly on zero.
+    struct WatertightRay
+    {
+        int kx = 0;
+        int ky = 1;
+        int kz = 2;
+        float sx = 0.0f;
+        float sy = 0.0f;
+        float sz = 1.0f;
+        float origin[3] = {};
+        bool valid = false;
+
+        explicit WatertightRay(const BvhRay& ray)
+        {
+            const float ax = std::abs(ray.direction[0]);
+            const float ay = std::abs(ray.direction[1]);
+            const float az = std::abs(ray.direction[2]);
+            kz = ax > ay ? (ax > az ? 0 : 2) : (ay > az ? 1 : 2);
+            if (!(std::abs(ray.direction[kz]) > 0.0f))
+                return;
+            kx = kz == 2 ? 0 : kz + 1;
+            ky = kx == 2 ? 0 : kx + 1;
+            // Keep the winding: swapping x and y when looking down -z.
+            if (ray.direction[kz] < 0.0f)
+                std::swap(kx, ky);
+            sx = ray.direction[kx] / ray.direction[kz];
+            sy = ray.direction[ky] / ray.direction[kz];
+            sz = 1.0f / ray.direction[kz];
+            std::copy(ray.origin, ray.origin + 3, origin);
+            valid = true;
+        }
+
+        bool Intersect(const float v0[3], const float v1[3], const float v2[3], float tMin, float tMax, float& t, float& u, float& v) const
+        {
+            const float az = v0[kz] - origin[kz];
+            const float bz = v1[kz] - origin[kz];
+            const float cz = v2[kz] - origin[kz];
+            const float ax = v0[kx] - origin[kx] - sx * az;
+            const float ay = v0[ky] - origin[ky] - sy * az;
+            const float bx = v1[kx] - origin[kx] - sx * bz;
+            const float by = v1[ky] - origin[ky] - sy * bz;
+            const float cx = v2[kx] - origin[kx] - sx * cz;
+            const float cy = v2[ky] - origin[ky] - sy * cz;
+
+            float e0 = cx * by - cy * bx;
+            float e1 = ax * cy - ay * cx;
+            float e2 = bx * ay - by * ax;
+            if (e0 == 0.0f || e1 == 0.0f || e2 == 0.0f)
+            {
+                e0 = static_cast<float>(static_cast<double>(cx) * by - static_cast<double>(cy) * bx);
+                e1 = static_cast<float>(static_cast<double>(ax) * cy - static_cast<double>(ay) * cx);
+                e2 = static_cast<float>(static_cast<double>(bx) * ay - static_cast<double>(by) * ax);
+            }
+            if ((e0 < 0.0f || e1 < 0.0f || e2 < 0.0f) && (e0 > 0.0f || e1 > 0.0f || e2 > 0.0f))
+                return false;
+
+            const float det = e0 + e1 + e2;
+            if (det == 0.0f)
+                return false;
+
+            const float scaledT = e0 * (sz * az) + e1 * (sz * bz) + e2 * (sz * cz);
+            const float inverseDet = 1.0f / det;
+            const float hitT = scaledT * inverseDet;
+            if (!(hitT > tMin && hitT < tMax))
+                return false;
+
+            t = hitT;
+            u = e1 * inverseDet;
+            v = e2 * inverseDet;
+            return true;
+        }
+    };
+}
+
+namespace BvhBuilder
+{
+    std::vector<BvhNode> Build(const BvhAabb* bounds, size_t count, std::vector<uint32_t>& order,
+        const BvhBuildSettings& settings, BvhBuildStats* stats)
+    {
+        const auto start = std::chrono::high_resolution_clock::now();
+        std::vector<BvhNode> nodes;
+        order.resize(count);
+        if (count == 0)
+        {
+            if (stats)
+                *stats = {};
+            return nodes;
+        }
+        std::iota(order.begin(), order.end(), 0u);
+
+        std::vector<Centroid> centroids(count);
+        const size_t tasks = (count + kBinGrain - 1) / kBinGrain;
+        std::vector<BvhAabb> partialBounds(tasks);
+        std::vector<BvhAabb> partialCentroids(tasks);
+        ThreadPool::Get().ParallelFor(tasks, [&](size_t task)
+        {
+            const size_t end = std::min(count, (task + 1) * kBinGrain);
+            for (size_t i = task * kBinGrain; i < end; ++i)
+            {
+                for (int a = 0; a < 3; ++a)
+                    centroids[i].c[a] = 0.5f * (bounds[i].min[a] + bounds[i].max[a]);
+                partialBounds[task].Grow(bounds[i]);
+                if (!bounds[i].IsEmpty())
+                    partialCentroids[task].Grow(centroids[i].c);
+            }
+        });
+        BuildRange root{ 0, static_cast<uint32_t>(count), 0, {}, {} };
+        for (size_t task = 0; task < tasks; ++task)
+        {
+            root.bounds.Grow(partialBounds[task]);
+            root.centroids.Grow(partialCentroids[task]);
+        }
+        if (root.centroids.IsEmpty())
+            root.centroids = BvhAabb{ { 0.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 0.0f } };
+
+        const Builder builder(bounds, centroids.data(), order.data(), settings);
+        BuildCounters counters;
+
+        // Top of the tree: split large ranges with the whole pool behind each.
+        struct Subtree
+        {
+            uint32_t node;
+            BuildRange range;
+        };
+        std::vector<Subtree> subtrees;
+        std::vector<Subtree> stack{ { 0, root } };
+        nodes.reserve(2 * count);
+        nodes.push_back({});
+        AxisBins bins;
+        while (!stack.empty())
+        {
+            const Subtree top = stack.back();
+            stack.pop_back();
+            if (top.range.end - top.range.begin <= std::max(settings.parallelThreshold, 1u))
+            {
+                subtrees.push_back(top);
+                continue;
+            }
+
+            const Split split = builder.FindSplit(top.range, true, bins);
+            BvhNode& node = nodes[top.node];
+            SetBounds(node, top.range.bounds);
+            counters.maxDepth = std::max(counters.maxDepth, top.range.depth);
+            if (split.leaf)
+            {
+                node.first = top.range.begin;
+                node.count = top.range.end - top.range.begin;
+                ++counters.leafCount;
+                continue;
+            }
+            const uint32_t child = static_cast<uint32_t>(nodes.size());
+            node.first = child;
+            node.count = 0;
+            nodes.resize(nodes.size() + 2);
+            stack.push_back({ child + 1, { split.mid, top.range.end, top.range.depth + 1, split.rightBounds, split.rightCentroids } });
+            stack.push_back({ child, { top.range.begin, split.mid, top.range.depth + 1, split.leftBounds, split.leftCentroids } });
+        }
+
+        // Largest subtrees first, so the last tasks to finish are small ones.
+        std::sort(subtrees.begin(), subtrees.end(), [](const Subtree& a, const Subtree& b)
+        {
+            return a.range.end - a.range.begin > b.range.end - b.range.begin;
+        });
+        std::vector<std::vector<BvhNode>> locals(subtrees.size());
+        std::vector<BuildCounters> localCounters(subtrees.size());
+        ThreadPool::Get().ParallelFor(subtrees.size(), [&](size_t i)
+        {
+            builder.BuildSubtree(subtrees[i].range, locals[i], localCounters[i]);
+        });
+
+        // Splice: each local root replaces its placeholder, the rest is appended.
+        std::vector<size_t> offsets(subtrees.size());
+        size_t total = nodes.size();
+        for (size_t i = 0; i < subtrees.size(); ++i)
+        {
+            offsets[i] = total;
+            total += locals[i].size() - 1;
+            counters.Add(localCounters[i]);
+        }
+        nodes.resize(total);
+        ThreadPool::Get().ParallelFor(subtrees.size(), [&](size_t i)
+        {
+            const std::vector<BvhNode>& local = locals[i];
+            const auto remap = [&](BvhNode node)
+            {
+                if (!node.IsLeaf())
+                    node.first = static_cast<uint32_t>(offsets[i] + node.first - 1);
+                return node;
+            };
+            nodes[subtrees[i].node] = remap(local[0]);
+            for (size_t n = 1; n < local.size(); ++n)
+                nodes[offsets[i] + n - 1] = remap(local[n]);
+        });
+
+        if (stats)
+        {
+            BvhAabb rootBounds;
+            rootBounds.Grow(root.bounds);
+            const double rootArea = std::max(static_cast<double>(rootBounds.HalfArea()), 1e-30);
+            double cost = 0.0;
+            for (const BvhNode& node : nodes)
+            {
+                BvhAabb box;
+                std::copy(node.min, node.min + 3, box.min);
+                std::copy(node.max, node.max + 3, box.max);
+                cost += box.HalfArea() * (node.IsLeaf() ? static_cast<double>(node.count) : settings.traversalCost);
+            }
+
+            stats->primitiveCount = count;
+            stats->nodeCount = nodes.size();
+            stats->leafCount = counters.leafCount;
+            stats->maxDepth = counters.maxDepth;
+            stats->sahCost = cost / rootArea;
+            stats->milliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+        }
+        return nodes;
+    }
+}
+
+void TriangleBvh::Build(const BvhMesh& mesh, const BvhBuildSettings& settings)
+{
+    const auto start = std::chrono::high_resolution_clock::now();
+    const auto* base = reinterpret_cast<const uint8_t*>(mesh.positions);
+    const auto position = [&](uint32_t index)
+    {
+        return reinterpret_cast<const float*>(base + static_cast<size_t>(index) * mesh.positionStride);
+    };
+
+    // Triangles with a non-finite vertex keep empty bounds and are never hit.
+    std::vector<BvhAabb> bounds(mesh.triangleCount);
+    ThreadPool::Get().ParallelForRange(mesh.triangleCount, kTriangleGrain, [&](size_t begin, size_t end)
+    {
+        for (size_t t = begin; t < end; ++t)
+        {
+            BvhAabb box;
+            bool finite = true;
+            for (int corner = 0; corner < 3; ++corner)
+            {
+                const float* p = position(mesh.indices[t * 3 + corner]);
+                finite &= std::isfinite(p[0]) && std::isfinite(p[1]) && std::isfinite(p[2]);
+                box.Grow(p);
+            }
+            if (finite)
+                bounds[t] = box;
+        }
+    });
+
+    std::vector<uint32_t> order;
+    m_nodes = BvhBuilder::Build(bounds.data(), bounds.size(), order, settings, &m_stats);
+
+    m_triangles.resize(mesh.triangleCount);
+    ThreadPool::Get().ParallelForRange(mesh.triangleCount, kTriangleGrain, [&](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; ++i)
+        {
+            Triangle& triangle = m_triangles[i];
+            const uint32_t* corners = mesh.indices + static_cast<size_t>(order[i]) * 3;
+            std::copy(position(corners[0]), position(corners[0]) + 3, triangle.v0);
+            std::copy(position(corners[1]), position(corners[1]) + 3, triangle.v1);
+            std::copy(position(corners[2]), position(corners[2]) + 3, triangle.v2);
+            triangle.index = order[i];
+        }
+    });
+    m_stats.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+BvhAabb TriangleBvh::GetBounds() const
+{
+    BvhAabb bounds;
+    if (!m_nodes.empty())
+    {
+        std::copy(m_nodes[0].min, m_nodes[0].min + 3, bounds.min);
+        std::copy(m_nodes[0].max, m_nodes[0].max + 3, bounds.max);
+    }
+    return bounds;
+}
+
+template <bool AnyHit>
+bool TriangleBvh::Traverse(const BvhRay& ray, BvhHit& hit, const BvhHitFilter* filter) const
+{
+    const WatertightRay watertight(ray);
+    if (!watertight.valid)
+        return false;
+
+    bool found = false;
+    TraverseBvh(m_nodes, ray, AnyHit ? ray.tMax : std::min(ray.tMax, hit.t), [&](const BvhNode& leaf, float& tMax)
+    {
+        for (uint32_t i = leaf.first; i < leaf.first + leaf.count; ++i)
+        {
+            const Triangle& triangle = m_triangles[i];
+            float t, u, v;
+            if (!watertight.Intersect(triangle.v0, triangle.v1, triangle.v2, ray.tMin, tMax, t, u, v))
+                continue;
+            if (filter && !filter->Accept(triangle.index, u, v))
+                continue;
+            found = true;
+            if (AnyHit)
+                return true;
+            tMax = t;
+            hit.t = t;
+            hit.u = u;
+            hit.v = v;
+            hit.primitive = triangle.index;
+        }
+        return false;
+    });
+    return found;
+}
+
+bool TriangleBvh::Intersect(const BvhRay& ray, BvhHit& hit, const BvhHitFilter* filter) const
+{
+    return Traverse<false>(ray, hit, filter);
+}
+
+bool TriangleBvh::Occluded(const BvhRay& ray, const BvhHitFilter* filter) const
+{
+    BvhHit hit;
+    return Traverse<true>(ray, hit, filter);
+}
@@ -2,11 +2,10 @@
 #include "SceneResources/GameObject.h"
 
 #include "Utils/Utils.h"
-#include "Resources/ConstantBuffer.h"
 
-GameObject::GameObject(const std::shared_ptr<Model>& model, const std::shared_ptr<ConstantBuffer>& modelWorldMatrixBuffer)
+GameObject::GameObject(const std::shared_ptr<Model>& model, ConstantAllocation worldMatrixConstants)
     :   m_model(model),
-        m_worldMatrixBuffer(modelWorldMatrixBuffer),
+        m_worldMatrixConstants(std::move(worldMatrixConstants)),
         m_worldMatrix(MathUtils::XMFloat4x4Identity())
 {
     UpdateWorldMatrix();   
@@ -18,22 +17,17 @@ void GameObject::UpdateWorldMatrix(const DirectX::XMFLOAT4X4& worldMatrix)
     UpdateWorldMatrix();
 }
 
-void GameObject::UpdateWorldMatrix() const
+void GameObject::UpdateWorldMatrix()
 {
-    auto data_bucket = DirectX::XMFLOAT4X4{};
-    DirectX::XMFLOAT4X4* mapped_data = &data_bucket;
-
-    m_worldMatrixBuffer->MapDataToWholeBuffer(reinterpret_cast<void**>(&mapped_data));
-
+    DirectX::XMFLOAT4X4 constants[2];
     DirectX::XMMATRIX W = DirectX::XMLoadFloat4x4(&m_worldMatrix);
 
     // Transpose for HLSL column-major cbuffer layout (row-vector mul convention)
-    DirectX::XMStoreFloat4x4(&mapped_data[0], DirectX::XMMatrixTranspose(W));
+    DirectX::XMStoreFloat4x4(&constants[0], DirectX::XMMatrixTranspose(W));
 
     // Upload inverse WITHOUT transpose: HLSL reads it as transpose(W^-1) = (W^-1)^T,
     // which is exactly the inverse-transpose needed for correct normal transforms.
     DirectX::XMVECTOR det;
-    DirectX::XMStoreFloat4x4(&mapped_data[1], DirectX::XMMatrixInverse(&det, W));
-
-    m_worldMatrixBuffer->Unmap();
+    DirectX::XMStoreFloat4x4(&constants[1], DirectX::XMMatrixInverse(&det, W));
+    m_worldMatrixConstants.Write(constants, sizeof(constants));
 }
@@ -0,0 +1,374 @@
+#include "SceneResources/LightTree.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <memory>
+
+#include "Constants.h"
+#include "SceneResources/VertexPacking.h"
+#include "Utils/RadixSort.h"
+#include "Utils/ThreadPool.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace
+{
+    constexpr uint32_t kMaxLeaves = Constants::Graphics::LIGHT_TREE_MAX_LEAVES;
+    constexpr uint32_t kNoCluster = 0xffffffffu;
+    constexpr size_t kLeafGrain = 1024;
+
+    using Clock = std::chrono::high_resolution_clock;
+
+    double MillisecondsSince(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    // 64 for 0, as Clz64 in the shader.
+    int Clz64(uint64_t value)
+    {
+        if (value == 0)
+            return 64;
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanReverse64(&index, value);
+        return 63 - static_cast<int>(index);
+#else
+        return __builtin_clzll(value);
+#endif
+    }
+
+    uint32_t IntegerExplode2Bit(uint32_t x)
+    {
+        x = (x * 0x00010001u) & 0xFF0000FFu;
+        x = (x * 0x00000101u) & 0x0F00F00Fu;
+        x = (x * 0x00000011u) & 0xC30C30C3u;
+        x = (x * 0x00000005u) & 0x49249249u;
+        return x;
+    }
+
+    // EncodeTreeLeaves: the voxel centre in the unit cube, then MortonCode3D.
+    uint32_t VoxelMortonCode(const uint32_t coord[3], uint32_t gridDim)
+    {
+        const float dim = static_cast<float>(gridDim);
+        uint32_t exploded[3];
+        for (int a = 0; a < 3; ++a)
+        {
+            const float unipos = std::min(std::max(static_cast<float>(coord[a]) + 0.5f, 0.0f), dim) / dim;
+            const float scaled = std::min(std::max(unipos * 1024.0f, 0.0f), 1023.0f);
+            exploded[a] = IntegerExplode2Bit(static_cast<uint32_t>(scaled));
+        }
+        return exploded[0] * 4u + exploded[1] * 2u + exploded[2];
+    }
+
+    void ReconstructVoxelCoord(uint32_t voxelId, uint32_t gridDim, uint32_t coord[3])
+    {
+        coord[0] = voxelId % gridDim;
+        coord[1] = (voxelId / gridDim) % gridDim;
+        coord[2] = voxelId / (gridDim * gridDim);
+    }
+
+    void PackFloat3(const float v[3], uint32_t packed[2])
+    {
+        packed[0] = VertexPacking::FloatToHalf(v[0]) | (static_cast<uint32_t>(VertexPacking::FloatToHalf(v[1])) << 16);
+        packed[1] = static_cast<uint32_t>(VertexPacking::FloatToHalf(v[2])) << 16;
+    }
+
+    void UnpackFloat3(const uint32_t packed[2], float v[3])
+    {
+        v[0] = VertexPacking::HalfToFloat(static_cast<uint16_t>(packed[0] & 0xffff));
+        v[1] = VertexPacking::HalfToFloat(static_cast<uint16_t>(packed[0] >> 16));
+        v[2] = VertexPacking::HalfToFloat(static_cast<uint16_t>(packed[1] >> 16));
+    }
+
+    // The shader's key: cluster << 48 | morton << 16 | leaf id. An unclustered
+    // leaf (-1) keeps the low 16 bits of its cluster and sorts last.
+    struct CompactKey
+    {
+        static constexpr uint64_t ID_MASK = 0xffff;
+
+        static uint64_t Encode(uint32_t cluster, uint32_t morton, uint32_t leafId)
+        {
+            return (static_cast<uint64_t>(cluster) << 48) | (static_cast<uint64_t>(morton) << 16) | leafId;
+        }
+    };
+
+    // 6 cluster bits (63 for anything outside [0, 32)), 30 Morton bits, 28 id
+    // bits. Orders leaves like CompactKey, so both variants agree below the cap.
+    struct WideKey
+    {
+        static constexpr uint64_t ID_MASK = (uint64_t(1) << 28) - 1;
+
+        static uint64_t Encode(uint32_t cluster, uint32_t morton, uint32_t leafId)
+        {
+            const uint64_t field = cluster < LightTree::CLUSTER_COUNT ? cluster : 63u;
+            return (field << 58) | (static_cast<uint64_t>(morton) << 28) | leafId;
+        }
+    };
+
+    int CommonUpperBits(const std::vector<uint64_t>& keys, uint32_t lhs, int rhs)
+    {
+        return Clz64(keys[lhs] ^ keys[rhs]);
+    }
+
+    // BuildTreeInternalNodes' DetermineRange, as the shader writes it.
+    void DetermineRange(const std::vector<uint64_t>& keys, uint32_t numLeaves, uint32_t idx, uint32_t& first, uint32_t& last)
+    {
+        if (idx == 0)
+        {
+            first = 0;
+            last = numLeaves - 1;
+            return;
+        }
+
+        const int lDelta = CommonUpperBits(keys, idx, static_cast<int>(idx) - 1);
+        const int rDelta = CommonUpperBits(keys, idx, static_cast<int>(idx) + 1);
+        const int d = rDelta > lDelta ? 1 : -1;
+
+        const int deltaMin = std::min(lDelta, rDelta);
+        const auto deltaAt = [&](int i) { return 0 <= i && i < static_cast<int>(numLeaves) ? CommonUpperBits(keys, idx, i) : -1; };
+        int lMax = 2;
+        while (deltaAt(static_cast<int>(idx) + d * lMax) > deltaMin)
+            lMax <<= 1;
+
+        int l = 0;
+        for (int t = lMax >> 1; t > 0; t >>= 1)
+        {
+            if (deltaAt(static_cast<int>(idx) + (l + t) * d) > deltaMin)
+                l += t;
+        }
+
+        const uint32_t jdx = idx + static_cast<uint32_t>(l * d);
+        first = d < 0 ? jdx : idx;
+        last = d < 0 ? idx : jdx;
+    }
+
+    uint32_t FindSplit(const std::vector<uint64_t>& keys, uint32_t first, uint32_t last)
+    {
+        const uint64_t firstCode = keys[first];
+        const uint64_t lastCode = keys[last];
+        if (firstCode == lastCode)
+            return (first + last) >> 1;
+
+        const int deltaNode = Clz64(firstCode ^ lastCode);
+        int split = static_cast<int>(first);
+        int stride = static_cast<int>(last - first);
+        do
+        {
+            stride = (stride + 1) >> 1;
+            const int middle = split + stride;
+            if (middle < static_cast<int>(last) && Clz64(firstCode ^ keys[middle]) > deltaNode)
+                split = middle;
+        } while (stride > 1);
+        return static_cast<uint32_t>(split);
+    }
+
+    template <typename Key, typename Node>
+    void BuildTree(const LightTreeInput& input, const VoxelGridConstants& grid, uint32_t maxLeaves, LightTreeT<Node>& tree)
+    {
+        using Index = decltype(Node::parentIndex);
+        ThreadPool& pool = ThreadPool::Get();
+
+        // EncodeTreeLeaves
+        auto start = Clock::now();
+        const uint32_t n = std::min(input.count, maxLeaves);
+        tree.leafCount = n;
+        tree.overflow = input.count > maxLeaves;
+        tree.compactToLeaf.assign(input.count, -1);
+        std::fill(std::begin(tree.clusterRoots), std::end(tree.clusterRoots), -1);
+        tree.sortKeys.resize(n);
+        pool.ParallelForRange(n, kLeafGrain, [&](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; ++i)
+            {
+                uint32_t coord[3];
+                ReconstructVoxelCoord(input.compactIds[i], grid.gridDim, coord);
+                const uint32_t cluster = static_cast<uint32_t>(input.clusterAssignments[i]);
+                tree.sortKeys[i] = Key::Encode(cluster, VoxelMortonCode(coord, grid.gridDim), static_cast<uint32_t>(i));
+            }
+        });
+        tree.stats.leafCount = n;
+        tree.stats.encodeMilliseconds = MillisecondsSince(start);
+
+        // Keys are unique, so any correct sort gives the bitonic network's order.
+        start = Clock::now();
+        RadixSort::Sort(tree.sortKeys.data(), tree.sortKeys.size());
+        tree.stats.sortMilliseconds = MillisecondsSince(start);
+
+        // InitializeTreeNodes + BuildTreeInternalNodes
+        start = Clock::now();
+        Node blank{};
+        blank.parentIndex = blank.leftIndex = blank.rightIndex = blank.voxelIndex = Node::NONE;
+        tree.nodes.assign(n ? 2 * static_cast<size_t>(n) - 1 : 0, blank);
+        const uint32_t numInternal = n ? n - 1 : 0;
+        pool.ParallelForRange(n, kLeafGrain, [&](size_t begin, size_t end)
+        {
+            for (size_t leafId = begin; leafId < end; ++leafId)
+            {
+                const uint32_t compactId = static_cast<uint32_t>(tree.sortKeys[leafId] & Key::ID_MASK);
+                uint32_t coord[3];
+                ReconstructVoxelCoord(input.compactIds[compactId], grid.gridDim, coord);
+
+                float boundMin[3];
+                float boundMax[3];
+                for (int a = 0; a < 3; ++a)
+                {
+                    boundMin[a] = grid.gridMin[a] + static_cast<float>(coord[a]) * grid.voxelSize;
+                    boundMax[a] = boundMin[a] + grid.voxelSize;
+                }
+
+                const size_t tid = numInternal + leafId;
+                Node& node = tree.nodes[tid];
+                PackFloat3(boundMin, node.aabbMin);
+                PackFloat3(boundMax, node.aabbMax);
+                node.intensity = input.premulIrradiance[compactId];
+                node.voxelIndex = static_cast<Index>(compactId);
+                node.flag = static_cast<uint32_t>(input.clusterAssignments[compactId]);
+                tree.compactToLeaf[compactId] = static_cast<int32_t>(tid);
+            }
+        });
+        pool.ParallelForRange(numInternal, kLeafGrain, [&](size_t begin, size_t end)
+        {
+            for (size_t idx = begin; idx < end; ++idx)
+            {
+                uint32_t first;
+                uint32_t last;
+                DetermineRange(tree.sortKeys, n, static_cast<uint32_t>(idx), first, last);
+                const uint32_t gamma = FindSplit(tree.sortKeys, first, last);
+
+                // Each node has exactly one parent, so the parent writes never race.
+                const uint32_t left = gamma + (first == gamma ? numInternal : 0);
+                const uint32_t right = gamma + 1 + (last == gamma + 1 ? numInternal : 0);
+                tree.nodes[idx].leftIndex = static_cast<Index>(left);
+                tree.nodes[idx].rightIndex = static_cast<Index>(right);
+                tree.nodes[left].parentIndex = static_cast<Index>(idx);
+                tree.nodes[right].parentIndex = static_cast<Index>(idx);
+            }
+        });
+        tree.stats.hierarchyMilliseconds = MillisecondsSince(start);
+
+        // MergeTreeNodes: one walk per leaf; the second child to reach a
+        // parent merges it and carries on, as the shader's sibling gate does.
+        start = Clock::now();
+        if (n == 1)
+            tree.clusterRoots[std::min(tree.nodes[0].flag, LightTree::CLUSTER_COUNT - 1)] = 0;
+
+        std::unique_ptr<std::atomic<uint32_t>[]> visited(new std::atomic<uint32_t>[numInternal ? numInternal : 1]);
+        for (uint32_t i = 0; i < numInternal; ++i)
+            visited[i].store(0, std::memory_order_relaxed);
+        std::unique_ptr<std::atomic<int32_t>[]> clusterRoots(new std::atomic<int32_t>[LightTree::CLUSTER_COUNT]);
+        for (uint32_t c = 0; c < LightTree::CLUSTER_COUNT; ++c)
+            clusterRoots[c].store(tree.clusterRoots[c], std::memory_order_relaxed);
+
+        pool.ParallelForRange(n > 1 ? n : 0, kLeafGrain, [&](size_t begin, size_t end)
+        {
+            for (size_t leafId = begin; leafId < end; ++leafId)
+            {
+                uint32_t lhsNodeId = static_cast<uint32_t>(numInternal + leafId);
+                Node lhs = tree.nodes[lhsNodeId];
+                Index parent = lhs.parentIndex;
+                while (parent != Node::NONE)
+                {
+                    if (visited[parent].fetch_add(1, std::memory_order_acq_rel) == 0)
+                        break; // the sibling's walk merges this parent
+
+                    Node merged = tree.nodes[parent];
+                    const uint32_t rhsNodeId = lhsNodeId != merged.rightIndex ? merged.rightIndex : merged.leftIndex;
+                    const Node& rhs = tree.nodes[rhsNodeId];
+
+                    merged.intensity = lhs.intensity + rhs.intensity;
+                    float lhsBounds[2][3];
+                    float rhsBounds[2][3];
+                    UnpackFloat3(lhs.aabbMin, lhsBounds[0]);
+                    UnpackFloat3(lhs.aabbMax, lhsBounds[1]);
+                    UnpackFloat3(rhs.aabbMin, rhsBounds[0]);
+                    UnpackFloat3(rhs.aabbMax, rhsBounds[1]);
+                    float boundMin[3];
+                    float boundMax[3];
+                    for (int a = 0; a < 3; ++a)
+                    {
+                        boundMin[a] = std::min(lhsBounds[0][a], rhsBounds[0][a]);
+                        boundMax[a] = std::max(lhsBounds[1][a], rhsBounds[1][a]);
+                    }
+                    PackFloat3(boundMin, merged.aabbMin);
+                    PackFloat3(boundMax, merged.aabbMax);
+
+                    merged.flag = lhs.flag == rhs.flag ? lhs.flag : kNoCluster;
+                    if (lhs.flag != merged.flag && lhs.flag < LightTree::CLUSTER_COUNT)
+                        clusterRoots[lhs.flag].store(static_cast<int32_t>(lhsNodeId), std::memory_order_relaxed);
+                    if (rhs.flag != merged.flag && rhs.flag < LightTree::CLUSTER_COUNT)
+                        clusterRoots[rhs.flag].store(static_cast<int32_t>(rhsNodeId), std::memory_order_relaxed);
+                    if (merged.parentIndex == Node::NONE && lhs.flag == rhs.flag && merged.flag < LightTree::CLUSTER_COUNT)
+                        clusterRoots[merged.flag].store(0, std::memory_order_relaxed);
+
+                    tree.nodes[parent] = merged;
+                    lhs = merged;
+                    lhsNodeId = parent;
+                    parent = merged.parentIndex;
+                }
+            }
+        });
+        for (uint32_t c = 0; c < LightTree::CLUSTER_COUNT; ++c)
+            tree.clusterRoots[c] = clusterRoots[c].load(std::memory_order_relaxed);
+        tree.stats.mergeMilliseconds = MillisecondsSince(start);
+    }
+}
+
+LightTree BuildLightTree(const LightTreeInput& input, const VoxelGridConstants& grid)
+{
+    LightTree tree;
+    BuildTree<CompactKey>(input, grid, kMaxLeaves, tree);
+    return tree;
+}
+
+LightTreeWide BuildWideLightTree(const LightTreeInput& input, const VoxelGridConstants& grid)
+{
+    LightTreeWide tree;
+    BuildTree<WideKey>(input, grid, MAX_WIDE_LIGHT_TREE_LEAVES, tree);
+    return tree;
+}
+
+LightTreeDiff CompareLightTrees(const LightTreeNode* first, size_t firstCount, const LightTreeNode* second, size_t secondCount, float intensityTolerance)
+{
+    LightTreeDiff diff;
+    diff.nodeCountDelta = firstCount > secondCount ? firstCount - secondCount : secondCount - firstCount;
+    const size_t count = std::min(firstCount, secondCount);
+    for (size_t i = 0; i < count; ++i)
+    {
+        const LightTreeNode& a = first[i];
+        const LightTreeNode& b = second[i];
+        bool same = true;
+        if (a.parentIndex != b.parentIndex || a.leftIndex != b.leftIndex || a.rightIndex != b.rightIndex || a.voxelIndex != b.voxelIndex)
+        {
+            ++diff.linkMismatches;
+            same = false;
+        }
+        if (a.flag != b.flag)
+        {
+            ++diff.flagMismatches;
+            same = false;
+        }
+        if (a.aabbMin[0] != b.aabbMin[0] || a.aabbMin[1] != b.aabbMin[1] || a.aabbMax[0] != b.aabbMax[0] || a.aabbMax[1] != b.aabbMax[1])
+        {
+            ++diff.boundsMismatches;
+            same = false;
+        }
+        if (a.intensity != b.intensity)
+        {
+            const float error = std::fabs(a.intensity - b.intensity) / std::max(std::fabs(a.intensity), std::fabs(b.intensity));
+            diff.maxIntensityError = std::max(diff.maxIntensityError, error);
+            if (!(error <= intensityTolerance))
+            {
+                ++diff.intensityMismatches;
+                same = false;
+            }
+        }
+        if (!same && diff.firstMismatch < 0)
+            diff.firstMismatch = static_cast<int64_t>(i);
+    }
+    return diff;
+}
@@ -0,0 +1,316 @@
+#include "SceneResources/MeshAttributes.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <vector>
+
+extern "C" {
+#include <mikktspace/mikktspace.h>
+#include <mikktspace/mikktspace.c>
+}
+
+#include "SceneResources/MeshOptimization.h"
+#include "Utils/ThreadPool.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#define MESH_ATTRIBUTES_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace MeshAttributes
+{
+namespace
+{
+    constexpr size_t kFaceGrain = 16384;
+    constexpr size_t kVertexGrain = 16384;
+    // Below this, a tangent batch is not worth a task of its own.
+    constexpr size_t kMinTangentBatchTriangles = 4096;
+
+    void NormalizeOrUp(float n[3])
+    {
+        const float lengthSq = n[0] * n[0] + n[1] * n[1] + n[2] * n[2];
+        if (lengthSq > 0.0f)
+        {
+            const float length = std::sqrt(lengthSq);
+            n[0] /= length;
+            n[1] /= length;
+            n[2] /= length;
+        }
+        else
+        {
+            n[0] = 0.0f; n[1] = 1.0f; n[2] = 0.0f; // degenerate/unreferenced vertex
+        }
+    }
+
+    // cross(p1 - p0, p2 - p0), the canonical CCW face normal (unnormalized, so
+    // the per-vertex sum is area weighted).
+    void FaceNormal(const FloatVertex* vertices, const uint32_t* tri, float& x, float& y, float& z)
+    {
+        const float* p0 = vertices[tri[0]].position;
+        const float* p1 = vertices[tri[1]].position;
+        const float* p2 = vertices[tri[2]].position;
+        const float e1x = p1[0] - p0[0], e1y = p1[1] - p0[1], e1z = p1[2] - p0[2];
+        const float e2x = p2[0] - p0[0], e2y = p2[1] - p0[1], e2z = p2[2] - p0[2];
+        x = e1y * e2z - e1z * e2y;
+        y = e1z * e2x - e1x * e2z;
+        z = e1x * e2y - e1y * e2x;
+    }
+
+    void ComputeFaceNormals(const FloatVertex* vertices, const uint32_t* indices, size_t begin, size_t end, float* fx, float* fy, float* fz)
+    {
+        size_t f = begin;
+#ifdef MESH_ATTRIBUTES_SSE2
+        // Same operations as FaceNormal lane for lane, so both paths agree bit for bit.
+        for (; f + 4 <= end; f += 4)
+        {
+            __m128 p[3][3];
+            for (int corner = 0; corner < 3; ++corner)
+            {
+                const float* a = vertices[indices[(f + 0) * 3 + corner]].position;
+                const float* b = vertices[indices[(f + 1) * 3 + corner]].position;
+                const float* c = vertices[indices[(f + 2) * 3 + corner]].position;
+                const float* d = vertices[indices[(f + 3) * 3 + corner]].position;
+                for (int axis = 0; axis < 3; ++axis)
+                    p[corner][axis] = _mm_setr_ps(a[axis], b[axis], c[axis], d[axis]);
+            }
+            const __m128 e1x = _mm_sub_ps(p[1][0], p[0][0]), e1y = _mm_sub_ps(p[1][1], p[0][1]), e1z = _mm_sub_ps(p[1][2], p[0][2]);
+            const __m128 e2x = _mm_sub_ps(p[2][0], p[0][0]), e2y = _mm_sub_ps(p[2][1], p[0][1]), e2z = _mm_sub_ps(p[2][2], p[0][2]);
+            _mm_storeu_ps(fx + f, _mm_sub_ps(_mm_mul_ps(e1y, e2z), _mm_mul_ps(e1z, e2y)));
+            _mm_storeu_ps(fy + f, _mm_sub_ps(_mm_mul_ps(e1z, e2x), _mm_mul_ps(e1x, e2z)));
+            _mm_storeu_ps(fz + f, _mm_sub_ps(_mm_mul_ps(e1x, e2y), _mm_mul_ps(e1y, e2x)));
+        }
+#endif
+        for (; f < end; ++f)
+            FaceNormal(vertices, indices + f * 3, fx[f], fy[f], fz[f]);
+    }
+
+    struct MikkBatch
+    {
+        FloatVertex* vertices;
+        const uint32_t* indices;
+        const uint32_t* triangles; // nullptr = all triangles in order
+        size_t triangleCount;
+    };
+
+    FloatVertex& Corner(const SMikkTSpaceContext* context, int face, int corner)
+    {
+        const auto* batch = static_cast<const MikkBatch*>(context->m_pUserData);
+        const size_t triangle = batch->triangles ? batch->triangles[face] : static_cast<size_t>(face);
+        return batch->vertices[batch->indices[triangle * 3 + corner]];
+    }
+
+    void RunMikkTSpace(const MikkBatch& batch)
+    {
+        SMikkTSpaceInterface iface = {};
+        iface.m_getNumFaces = [](const SMikkTSpaceContext* context) -> int
+        {
+            return static_cast<int>(static_cast<const MikkBatch*>(context->m_pUserData)->triangleCount);
+        };
+        iface.m_getNumVerticesOfFace = [](const SMikkTSpaceContext*, const int) -> int
+        {
+            return 3;
+        };
+        iface.m_getPosition = [](const SMikkTSpaceContext* context, float out[], const int face, const int corner)
+        {
+            const FloatVertex& v = Corner(context, face, corner);
+            out[0] = v.position[0]; out[1] = v.position[1]; out[2] = v.position[2];
+        };
+        iface.m_getNormal = [](const SMikkTSpaceContext* context, float out[], const int face, const int corner)
+        {
+            const FloatVertex& v = Corner(context, face, corner);
+            out[0] = v.normal[0]; out[1] = v.normal[1]; out[2] = v.normal[2];
+        };
+        iface.m_getTexCoord = [](const SMikkTSpaceContext* context, float out[], const int face, const int corner)
+        {
+            const FloatVertex& v = Corner(context, face, corner);
+            out[0] = v.uv[0]; out[1] = v.uv[1];
+        };
+        iface.m_setTSpaceBasic = [](const SMikkTSpaceContext* context, const float tangent[], const float sign, const int face, const int corner)
+        {
+            FloatVertex& v = Corner(context, face, corner);
+            v.tangent[0] = tangent[0]; v.tangent[1] = tangent[1]; v.tangent[2] = tangent[2]; v.tangent[3] = sign;
+        };
+
+        SMikkTSpaceContext context = { &iface, const_cast<MikkBatch*>(&batch) };
+        genTangSpaceDefault(&context);
+    }
+
+    // mikktspace merges vertices whose position, normal and uv compare equal;
+    // -0 == +0 there, so signed zeros are folded before the bitwise weld.
+    struct MikkKey
+    {
+        float values[8];
+    };
+
+    uint32_t FindRoot(std::vector<uint32_t>& parent, uint32_t x)
+    {
+        while (parent[x] != x)
+        {
+            parent[x] = parent[parent[x]];
+            x = parent[x];
+        }
+        return x;
+    }
+}
+
+void ComputeNormals(FloatVertex* vertices, size_t vertexCount, const uint32_t* indices, size_t indexCount)
+{
+    ThreadPool& pool = ThreadPool::Get();
+    const size_t faceCount = indexCount / 3;
+
+    std::vector<float> fx(faceCount), fy(faceCount), fz(faceCount);
+    pool.ParallelForRange(faceCount, kFaceGrain, [&](size_t begin, size_t end)
+    {
+        ComputeFaceNormals(vertices, indices, begin, end, fx.data(), fy.data(), fz.data());
+    });
+
+    // Corner lists per vertex, filled in face order (counting sort).
+    std::vector<uint32_t> offsets(vertexCount + 1, 0);
+    for (size_t i = 0; i < faceCount * 3; ++i)
+        offsets[indices[i] + 1]++;
+    std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+    std::vector<uint32_t> cornerFaces(faceCount * 3);
+    {
+        std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+        for (size_t i = 0; i < faceCount * 3; ++i)
+            cornerFaces[cursor[indices[i]]++] = static_cast<uint32_t>(i / 3);
+    }
+
+    pool.ParallelForRange(vertexCount, kVertexGrain, [&](size_t begin, size_t end)
+    {
+        for (size_t v = begin; v < end; ++v)
+        {
+            float n[3] = { 0.0f, 0.0f, 0.0f };
+            for (uint32_t c = offsets[v]; c < offsets[v + 1]; ++c)
+            {
+                const uint32_t face = cornerFaces[c];
+                n[0] += fx[face];
+                n[1] += fy[face];
+                n[2] += fz[face];
+            }
+            NormalizeOrUp(n);
+            std::copy(n, n + 3, vertices[v].normal);
+        }
+    });
+}
+
+void ComputeTangents(FloatVertex* vertices, size_t vertexCount, const uint32_t* indices, size_t indexCount)
+{
+    ThreadPool& pool = ThreadPool::Get();
+    const size_t triangleCount = indexCount / 3;
+    if (pool.GetThreadCount() == 1 || triangleCount < 2 * kMinTangentBatchTriangles)
+    {
+        ComputeTangentsReference(vertices, vertexCount, indices, indexCount);
+        return;
+    }
+    const size_t target = std::max(kMinTangentBatchTriangles, triangleCount / (size_t(pool.GetThreadCount()) * 4));
+    ComputeTangentsInBatches(vertices, vertexCount, indices, indexCount, target);
+}
+
+void ComputeTangentsInBatches(FloatVertex* vertices, size_t vertexCount, const uint32_t* indices, size_t indexCount, size_t batchTriangles)
+{
+    const size_t triangleCount = indexCount / 3;
+
+    // Vertex classes as mikktspace sees them. Its weld stops splitting a
+    // bucket at a non-finite position, which makes the result depend on
+    // what else is in the bucket; such meshes take the serial path.
+    std::vector<MikkKey> keys(vertexCount);
+    for (size_t v = 0; v < vertexCount; ++v)
+    {
+        const FloatVertex& vertex = vertices[v];
+        if (!std::isfinite(vertex.position[0]) || !std::isfinite(vertex.position[1]) || !std::isfinite(vertex.position[2]))
+        {
+            ComputeTangentsReference(vertices, vertexCount, indices, indexCount);
+            return;
+        }
+        const float values[8] = { vertex.position[0], vertex.position[1], vertex.position[2],
+                                  vertex.normal[0], vertex.normal[1], vertex.normal[2], vertex.uv[0], vertex.uv[1] };
+        for (int i = 0; i < 8; ++i)
+            keys[v].values[i] = values[i] + 0.0f; // -0 -> +0
+    }
+    std::vector<uint32_t> vertexClass(vertexCount);
+    const size_t classCount = MeshOptimization::GenerateWeldRemap(vertexClass.data(), keys.data(), vertexCount, sizeof(MikkKey));
+
+    // Islands: triangles connected through a shared vertex class.
+    std::vector<uint32_t> parent(classCount);
+    std::iota(parent.begin(), parent.end(), 0u);
+    for (size_t t = 0; t < triangleCount; ++t)
+    {
+        const uint32_t a = FindRoot(parent, vertexClass[indices[t * 3 + 0]]);
+        const uint32_t b = FindRoot(parent, vertexClass[indices[t * 3 + 1]]);
+        const uint32_t c = FindRoot(parent, vertexClass[indices[t * 3 + 2]]);
+        parent[b] = a;
+        parent[FindRoot(parent, c)] = a;
+    }
+
+    // Pack islands, in order of their first triangle, into batches of roughly
+    // equal size; a triangle's batch follows its island.
+    const size_t target = std::max<size_t>(1, batchTriangles);
+    std::vector<uint32_t> islandBatch(classCount, MeshOptimization::UNUSED);
+    std::vector<uint32_t> triangleBatch(triangleCount);
+    std::vector<size_t> batchSizes(1, 0);
+    {
+        std::vector<size_t> islandSize(classCount, 0);
+        for (size_t t = 0; t < triangleCount; ++t)
+            islandSize[FindRoot(parent, vertexClass[indices[t * 3]])]++;
+
+        for (size_t t = 0; t < triangleCount; ++t)
+        {
+            const uint32_t island = FindRoot(parent, vertexClass[indices[t * 3]]);
+            if (islandBatch[island] == MeshOptimization::UNUSED)
+            {
+                if (batchSizes.back() >= target)
+                    batchSizes.push_back(0);
+                islandBatch[island] = static_cast<uint32_t>(batchSizes.size() - 1);
+                batchSizes.back() += islandSize[island];
+            }
+            triangleBatch[t] = islandBatch[island];
+        }
+    }
+
+    if (batchSizes.size() == 1)
+    {
+        ComputeTangentsReference(vertices, vertexCount, indices, indexCount);
+        return;
+    }
+
+    std::vector<std::vector<uint32_t>> batches(batchSizes.size());
+    for (size_t b = 0; b < batchSizes.size(); ++b)
+        batches[b].reserve(batchSizes[b]);
+    for (size_t t = 0; t < triangleCount; ++t)
+        batches[triangleBatch[t]].push_back(static_cast<uint32_t>(t));
+
+    // Batches touch disjoint vertex sets: a vertex index belongs to one class.
+    ThreadPool::Get().ParallelFor(batches.size(), [&](size_t b)
+    {
+        RunMikkTSpace({ vertices, indices, batches[b].data(), batches[b].size() });
+    });
+}
+
+void ComputeNormalsReference(FloatVertex* vertices, size_t vertexCount, const uint32_t* indices, size_t indexCount)
+{
+    for (size_t v = 0; v < vertexCount; ++v)
+        vertices[v].normal[0] = vertices[v].normal[1] = vertices[v].normal[2] = 0.0f;
+
+    for (size_t i = 0; i + 2 < indexCount; i += 3)
+    {
+        float x, y, z;
+        FaceNormal(vertices, indices + i, x, y, z);
+        for (size_t k = 0; k < 3; ++k)
+        {
+            float* n = vertices[indices[i + k]].normal;
+            n[0] += x; n[1] += y; n[2] += z;
+        }
+    }
+
+    for (size_t v = 0; v < vertexCount; ++v)
+        NormalizeOrUp(vertices[v].normal);
+}
+
+void ComputeTangentsReference(FloatVertex* vertices, size_t vertexCount, const uint32_t* indices, size_t indexCount)
+{
+    (void)vertexCount;
+    RunMikkTSpace({ vertices, indices, nullptr, indexCount / 3 });
+}
+}
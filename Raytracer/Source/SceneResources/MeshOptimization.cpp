@@ -0,0 +1,280 @@
+#include "SceneResources/MeshOptimization.h"
+
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#include "Utils/ContentHash.h"
+
+namespace MeshOptimization
+{
+namespace
+{
+    // Forsyth, "Linear-Speed Vertex Cache Optimisation" (2006). The scoring
+    // cache is larger than the measured FIFO on purpose, as in the paper.
+    constexpr int kScoreCacheSize = 32;
+    constexpr int kMaxValenceTable = 32;
+    constexpr float kCacheDecayPower = 1.5f;
+    constexpr float kLastTriScore = 0.75f;
+    constexpr float kValenceBoostScale = 2.0f;
+    constexpr float kValenceBoostPower = 0.5f;
+
+    struct ScoreTables
+    {
+        float cache[kScoreCacheSize];
+        float valence[kMaxValenceTable];
+
+        ScoreTables()
+        {
+            for (int i = 0; i < kScoreCacheSize; ++i)
+            {
+                // The last triangle's three vertices share one fixed score so the
+                // order they were added in does not matter.
+                cache[i] = i < 3 ? kLastTriScore
+                                 : std::pow(1.0f - float(i - 3) / float(kScoreCacheSize - 3), kCacheDecayPower);
+            }
+            valence[0] = 0.0f;
+            for (int i = 1; i < kMaxValenceTable; ++i)
+                valence[i] = kValenceBoostScale * std::pow(float(i), -kValenceBoostPower);
+        }
+    };
+
+    float VertexScore(const ScoreTables& tables, int cachePosition, uint32_t remainingValence)
+    {
+        if (remainingValence == 0)
+            return -1.0f; // no triangles left to pull in
+        float score = cachePosition >= 0 ? tables.cache[cachePosition] : 0.0f;
+        score += remainingValence < kMaxValenceTable
+            ? tables.valence[remainingValence]
+            : kValenceBoostScale * std::pow(float(remainingValence), -kValenceBoostPower);
+        return score;
+    }
+
+    size_t HashTableSize(size_t count)
+    {
+        size_t size = 16;
+        while (size < count + count / 2)
+            size *= 2;
+        return size;
+    }
+}
+
+size_t GenerateWeldRemap(uint32_t* remap, const void* vertices, size_t vertexCount, size_t stride)
+{
+    assert(vertexCount <= UNUSED);
+    const auto* bytes = static_cast<const uint8_t*>(vertices);
+
+    // Open addressing over vertex indices; slots hold the first occurrence.
+    const size_t tableSize = HashTableSize(vertexCount);
+    const size_t mask = tableSize - 1;
+    std::vector<uint32_t> table(tableSize, UNUSED);
+
+    size_t unique = 0;
+    for (size_t i = 0; i < vertexCount; ++i)
+    {
+        const uint8_t* vertex = bytes + i * stride;
+        size_t slot = static_cast<size_t>(ContentHash::HashBytes(vertex, stride)) & mask;
+        for (size_t probe = 1;; ++probe)
+        {
+            const uint32_t existing = table[slot];
+            if (existing == UNUSED)
+            {
+                table[slot] = static_cast<uint32_t>(i);
+                remap[i] = static_cast<uint32_t>(unique++);
+                break;
+            }
+            if (std::memcmp(bytes + size_t(existing) * stride, vertex, stride) == 0)
+            {
+                remap[i] = remap[existing];
+                break;
+            }
+            slot = (slot + probe) & mask; // triangular probing visits every slot
+        }
+    }
+    return unique;
+}
+
+void OptimizeVertexCache(uint32_t* indices, size_t indexCount, size_t vertexCount)
+{
+    const size_t triangleCount = indexCount / 3;
+    if (triangleCount == 0)
+        return;
+
+    static const ScoreTables tables;
+
+    // Triangle adjacency per vertex (CSR). The first `valence[v]` entries of a
+    // vertex's range are its triangles not yet emitted.
+    std::vector<uint32_t> valence(vertexCount, 0);
+    for (size_t i = 0; i < triangleCount * 3; ++i)
+        valence[indices[i]]++;
+
+    std::vector<uint32_t> adjacencyOffset(vertexCount + 1, 0);
+    for (size_t v = 0; v < vertexCount; ++v)
+        adjacencyOffset[v + 1] = adjacencyOffset[v] + valence[v];
+
+    std::vector<uint32_t> adjacency(triangleCount * 3);
+    {
+        std::vector<uint32_t> fill(adjacencyOffset.begin(), adjacencyOffset.end() - 1);
+        for (size_t t = 0; t < triangleCount; ++t)
+            for (size_t k = 0; k < 3; ++k)
+                adjacency[fill[indices[t * 3 + k]]++] = static_cast<uint32_t>(t);
+    }
+
+    std::vector<int> cachePosition(vertexCount, -1);
+    std::vector<float> vertexScore(vertexCount);
+    for (size_t v = 0; v < vertexCount; ++v)
+        vertexScore[v] = VertexScore(tables, -1, valence[v]);
+
+    std::vector<float> triangleScore(triangleCount);
+    std::vector<uint8_t> emitted(triangleCount, 0);
+    for (size_t t = 0; t < triangleCount; ++t)
+        triangleScore[t] = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+
+    std::vector<uint32_t> output(triangleCount * 3);
+
+    uint32_t cache[kScoreCacheSize + 3];
+    uint32_t nextCache[kScoreCacheSize + 3];
+    size_t cacheCount = 0;
+
+    size_t bestTriangle = 0;
+    for (size_t t = 1; t < triangleCount; ++t)
+        if (triangleScore[t] > triangleScore[bestTriangle])
+            bestTriangle = t;
+
+    size_t inputCursor = 0; // dead-end fallback: next unemitted triangle in input order
+    for (size_t outputTriangle = 0; outputTriangle < triangleCount; ++outputTriangle)
+    {
+        if (bestTriangle == SIZE_MAX)
+        {
+            while (emitted[inputCursor])
+                ++inputCursor;
+            bestTriangle = inputCursor;
+        }
+
+        const uint32_t* tri = indices + bestTriangle * 3;
+        std::memcpy(&output[outputTriangle * 3], tri, 3 * sizeof(uint32_t));
+        emitted[bestTriangle] = 1;
+
+        // Retire the triangle from its vertices' live adjacency.
+        for (size_t k = 0; k < 3; ++k)
+        {
+            const uint32_t v = tri[k];
+            uint32_t* begin = adjacency.data() + adjacencyOffset[v];
+            uint32_t* end = begin + valence[v];
+            for (uint32_t* it = begin; it != end; ++it)
+            {
+                if (*it == bestTriangle)
+                {
+                    std::swap(*it, *(end - 1));
+                    break;
+                }
+            }
+            valence[v]--;
+        }
+
+        // New LRU order: this triangle's vertices first, then the old cache.
+        size_t nextCount = 0;
+        for (size_t k = 0; k < 3; ++k)
+        {
+            const uint32_t v = tri[k];
+            if (k > 0 && (v == tri[0] || (k == 2 && v == tri[1])))
+                continue;
+            nextCache[nextCount++] = v;
+        }
+        for (size_t i = 0; i < cacheCount; ++i)
+        {
+            const uint32_t v = cache[i];
+            if (v != tri[0] && v != tri[1] && v != tri[2])
+                nextCache[nextCount++] = v;
+        }
+
+        // Entries past the scoring window fall out; rescore them as uncached.
+        for (size_t i = kScoreCacheSize; i < nextCount; ++i)
+        {
+            cachePosition[nextCache[i]] = -1;
+            vertexScore[nextCache[i]] = VertexScore(tables, -1, valence[nextCache[i]]);
+        }
+        cacheCount = nextCount < size_t(kScoreCacheSize) ? nextCount : size_t(kScoreCacheSize);
+        for (size_t i = 0; i < cacheCount; ++i)
+        {
+            const uint32_t v = nextCache[i];
+            cache[i] = v;
+            cachePosition[v] = static_cast<int>(i);
+            vertexScore[v] = VertexScore(tables, static_cast<int>(i), valence[v]);
+        }
+
+        // Only triangles touching changed vertices can change score; the best
+        // of those is the next candidate.
+        bestTriangle = SIZE_MAX;
+        float bestScore = -1.0f;
+        for (size_t i = 0; i < nextCount; ++i)
+        {
+            const uint32_t v = nextCache[i];
+            const uint32_t* begin = adjacency.data() + adjacencyOffset[v];
+            for (const uint32_t* it = begin; it != begin + valence[v]; ++it)
+            {
+                const uint32_t* t = indices + size_t(*it) * 3;
+                const float score = vertexScore[t[0]] + vertexScore[t[1]] + vertexScore[t[2]];
+                triangleScore[*it] = score;
+                if (score > bestScore)
+                {
+                    bestScore = score;
+                    bestTriangle = *it;
+                }
+            }
+        }
+    }
+
+    std::memcpy(indices, output.data(), triangleCount * 3 * sizeof(uint32_t));
+}
+
+size_t GenerateFetchRemap(uint32_t* remap, const uint32_t* indices, size_t indexCount, size_t vertexCount)
+{
+    for (size_t v = 0; v < vertexCount; ++v)
+        remap[v] = UNUSED;
+
+    uint32_t next = 0;
+    for (size_t i = 0; i < indexCount; ++i)
+    {
+        uint32_t& slot = remap[indices[i]];
+        if (slot == UNUSED)
+            slot = next++;
+    }
+    return next;
+}
+
+void RemapVertices(void* dst, const void* src, size_t vertexCount, size_t stride, const uint32_t* remap)
+{
+    auto* out = static_cast<uint8_t*>(dst);
+    const auto* in = static_cast<const uint8_t*>(src);
+    for (size_t v = 0; v < vertexCount; ++v)
+        if (remap[v] != UNUSED)
+            std::memcpy(out + size_t(remap[v]) * stride, in + v * stride, stride);
+}
+
+void RemapIndices(uint32_t* indices, size_t indexCount, const uint32_t* remap)
+{
+    for (size_t i = 0; i < indexCount; ++i)
+        indices[i] = remap[indices[i]];
+}
+
+size_t CountCacheMisses(const uint32_t* indices, size_t indexCount, size_t vertexCount, uint32_t cacheSize)
+{
+    // FIFO via insertion timestamps: a vertex is resident while fewer than
+    // cacheSize misses happened since it was loaded.
+    std::vector<uint32_t> loadedAt(vertexCount, 0);
+    uint32_t timestamp = cacheSize + 1;
+    size_t misses = 0;
+    for (size_t i = 0; i < indexCount; ++i)
+    {
+        const uint32_t v = indices[i];
+        if (timestamp - loadedAt[v] > cacheSize)
+        {
+            loadedAt[v] = timestamp++;
+            ++misses;
+        }
+    }
+    return misses;
+}
+}
@@ -2,15 +2,13 @@
 #include "SceneResources/MeshProcessing.h"
 
 #include <algorithm>
+#include <chrono>
 #include <cmath>
+#include <cstddef>
+#include <cstring>
 #include <unordered_map>
 #include <spdlog/spdlog.h>
 
-extern "C" {
-#include <mikktspace/mikktspace.h>
-#include <mikktspace/mikktspace.c>
-}
-
 #include "AccelerationStructures.h"
 #include "Renderer.h"
 #include "SceneResources/Scene.h"
@@ -18,93 +16,75 @@ extern "C" {
 #include "SceneResources/Primitive.h"
 #include "SceneResources/GameObject.h"
 #include "SceneResources/Material.h"
+#include "SceneResources/MeshAttributes.h"
+#include "SceneResources/MeshOptimization.h"
+#include "Utils/ContentHash.h"
 
-namespace MeshUtils
-{
-
-void ComputeNormals(std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices)
-{
-    using namespace DirectX;
+static AutoCVarInt g_packingReport("mesh.packing.report", "Log what the packed vertex layouts would save per scene, and their error", 0, CVarFlags::EditCheckbox);
 
-    for (Vertex& vertex : vertices)
-        vertex.Normal = {0, 0, 0};
+static AutoCVarInt g_deduplicate("mesh.dedup.enabled", "Store identical meshes once at import and instance them", 1, CVarFlags::EditCheckbox);
 
-    for (size_t i = 0; i + 2 < indices.size(); i += 3)
-    {
-        Vertex& v0 = vertices[indices[i]];
-        Vertex& v1 = vertices[indices[i + 1]];
-        Vertex& v2 = vertices[indices[i + 2]];
+static AutoCVarInt g_verifyAttributes("mesh.attributes.verify", "Check parallel normal/tangent generation against the serial reference at load (slow)", 0, CVarFlags::EditCheckbox);
 
-        const XMVECTOR p0 = XMLoadFloat3(&v0.Pos);
-        const XMVECTOR faceNormal = XMVector3Cross(
-            XMVectorSubtract(XMLoadFloat3(&v1.Pos), p0),
-            XMVectorSubtract(XMLoadFloat3(&v2.Pos), p0));
+static_assert(sizeof(Vertex) == sizeof(VertexPacking::FloatVertex), "VertexPacking::FloatVertex must mirror Vertex");
+static_assert(offsetof(Vertex, Normal) == offsetof(VertexPacking::FloatVertex, normal), "VertexPacking::FloatVertex must mirror Vertex");
+static_assert(offsetof(Vertex, Tangent) == offsetof(VertexPacking::FloatVertex, tangent), "VertexPacking::FloatVertex must mirror Vertex");
+static_assert(offsetof(Vertex, Tex0) == offsetof(VertexPacking::FloatVertex, uv), "VertexPacking::FloatVertex must mirror Vertex");
 
-        for (Vertex* vertex : { &v0, &v1, &v2 })
-            XMStoreFloat3(&vertex->Normal, XMVectorAdd(XMLoadFloat3(&vertex->Normal), faceNormal));
-    }
+namespace MeshUtils
+{
 
-    for (Vertex& vertex : vertices)
-    {
-        const XMVECTOR accumulated = XMLoadFloat3(&vertex.Normal);
-        if (XMVectorGetX(XMVector3LengthSq(accumulated)) > 0.0f)
-            XMStoreFloat3(&vertex.Normal, XMVector3Normalize(accumulated));
-        else
-            vertex.Normal = {0, 1, 0}; // degenerate/unreferenced vertex
-    }
+void ComputeNormals(std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices)
+{
+    MeshAttributes::ComputeNormals(reinterpret_cast<VertexPacking::FloatVertex*>(vertices.data()), vertices.size(), indices.data(), indices.size());
 }
 
 void ComputeTangents(std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices)
 {
-    struct UserData
-    {
-        std::vector<Vertex>* vertices;
-        const std::vector<uint32_t>* indices;
-    } userData = { &vertices, &indices };
-
-    SMikkTSpaceInterface iface = {};
-
-    iface.m_getNumFaces = [](const SMikkTSpaceContext* pContext) -> int
-    {
-        const auto* data = static_cast<UserData*>(pContext->m_pUserData);
-        return static_cast<int>(data->indices->size() / 3);
-    };
-
-    iface.m_getNumVerticesOfFace = [](const SMikkTSpaceContext*, const int) -> int
-    {
-        return 3;
-    };
-
-    iface.m_getPosition = [](const SMikkTSpaceContext* pContext, float fvPosOut[], const int iFace, const int iVert)
-    {
-        const auto* data = static_cast<UserData*>(pContext->m_pUserData);
-        const Vertex& v = (*data->vertices)[(*data->indices)[iFace * 3 + iVert]];
-        fvPosOut[0] = v.Pos.x; fvPosOut[1] = v.Pos.y; fvPosOut[2] = v.Pos.z;
-    };
-
-    iface.m_getNormal = [](const SMikkTSpaceContext* pContext, float fvNormOut[], const int iFace, const int iVert)
-    {
-        const auto* data = static_cast<UserData*>(pContext->m_pUserData);
-        const Vertex& v = (*data->vertices)[(*data->indices)[iFace * 3 + iVert]];
-        fvNormOut[0] = v.Normal.x; fvNormOut[1] = v.Normal.y; fvNormOut[2] = v.Normal.z;
-    };
-
-    iface.m_getTexCoord = [](const SMikkTSpaceContext* pContext, float fvTexcOut[], const int iFace, const int iVert)
-    {
-        const auto* data = static_cast<UserData*>(pContext->m_pUserData);
-        const Vertex& v = (*data->vertices)[(*data->indices)[iFace * 3 + iVert]];
-        fvTexcOut[0] = v.Tex0.x; fvTexcOut[1] = v.Tex0.y;
-    };
+    MeshAttributes::ComputeTangents(reinterpret_cast<VertexPacking::FloatVertex*>(vertices.data()), vertices.size(), indices.data(), indices.size());
+}
 
-    iface.m_setTSpaceBasic = [](const SMikkTSpaceContext* pContext, const float fvTangent[], const float fSign, const int iFace, const int iVert)
-    {
-        auto* data = static_cast<UserData*>(pContext->m_pUserData);
-        Vertex& v = (*data->vertices)[(*data->indices)[iFace * 3 + iVert]];
-        v.Tangent = {fvTangent[0], fvTangent[1], fvTangent[2], fSign};
-    };
+bool IsAttributeVerificationEnabled()
+{
+    return g_verifyAttributes.Get() != 0;
+}
 
-    SMikkTSpaceContext ctx = { &iface, &userData };
-    genTangSpaceDefault(&ctx);
+void GenerateAttributes(std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, bool normals, bool tangents, bool verify)
+{
+    if (!normals && !tangents)
+        return;
+
+    std::vector<Vertex> reference;
+    if (verify)
+        reference = vertices;
+
+    const auto start = std::chrono::high_resolution_clock::now();
+    if (normals)
+        ComputeNormals(vertices, indices);
+    if (tangents)
+        ComputeTangents(vertices, indices);
+
+    if (!verify)
+        return;
+
+    const auto parallelEnd = std::chrono::high_resolution_clock::now();
+    auto* referenceData = reinterpret_cast<VertexPacking::FloatVertex*>(reference.data());
+    if (normals)
+        MeshAttributes::ComputeNormalsReference(referenceData, reference.size(), indices.data(), indices.size());
+    if (tangents)
+        MeshAttributes::ComputeTangentsReference(referenceData, reference.size(), indices.data(), indices.size());
+    const auto referenceEnd = std::chrono::high_resolution_clock::now();
+
+    size_t mismatches = 0;
+    for (size_t i = 0; i < vertices.size(); ++i)
+        mismatches += std::memcmp(&vertices[i], &reference[i], sizeof(Vertex)) != 0;
+
+    const double parallelMs = std::chrono::duration<double, std::milli>(parallelEnd - start).count();
+    const double referenceMs = std::chrono::duration<double, std::milli>(referenceEnd - parallelEnd).count();
+    if (mismatches > 0)
+        spdlog::error("Mesh attributes: {} of {} vertices differ from the reference", mismatches, vertices.size());
+    spdlog::info("Mesh attributes: {} triangles, parallel {:.2f} ms vs reference {:.2f} ms, {}",
+        indices.size() / 3, parallelMs, referenceMs, mismatches == 0 ? "identical" : "MISMATCH");
 }
 
 void DropDegenerateTriangles(const std::vector<Vertex>& vertices, std::vector<uint32_t>& indices)
@@ -180,6 +160,141 @@ void EnforceVertexInvariants(std::vector<Vertex>& vertices)
     }
 }
 
+void MeshOptimizationStats::Accumulate(const MeshOptimizationStats& other)
+{
+    verticesBefore += other.verticesBefore;
+    verticesAfter += other.verticesAfter;
+    triangles += other.triangles;
+    cacheMissesBefore += other.cacheMissesBefore;
+    cacheMissesAfter += other.cacheMissesAfter;
+}
+
+void OptimizeMesh(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, MeshOptimizationStats& stats)
+{
+    stats.verticesBefore += vertices.size();
+    stats.triangles += indices.size() / 3;
+    stats.cacheMissesBefore += MeshOptimization::CountCacheMisses(indices.data(), indices.size(), vertices.size());
+
+    std::vector<uint32_t> remap(vertices.size());
+    std::vector<Vertex> scratch;
+
+    const size_t unique = MeshOptimization::GenerateWeldRemap(remap.data(), vertices.data(), vertices.size(), sizeof(Vertex));
+    if (unique < vertices.size())
+    {
+        scratch.resize(unique);
+        MeshOptimization::RemapVertices(scratch.data(), vertices.data(), vertices.size(), sizeof(Vertex), remap.data());
+        MeshOptimization::RemapIndices(indices.data(), indices.size(), remap.data());
+        vertices.swap(scratch);
+    }
+
+    MeshOptimization::OptimizeVertexCache(indices.data(), indices.size(), vertices.size());
+
+    // Also drops vertices no triangle references (e.g. after DropDegenerateTriangles).
+    remap.resize(vertices.size());
+    const size_t referenced = MeshOptimization::GenerateFetchRemap(remap.data(), indices.data(), indices.size(), vertices.size());
+    scratch.resize(referenced);
+    MeshOptimization::RemapVertices(scratch.data(), vertices.data(), vertices.size(), sizeof(Vertex), remap.data());
+    MeshOptimization::RemapIndices(indices.data(), indices.size(), remap.data());
+    vertices.swap(scratch);
+
+    stats.verticesAfter += vertices.size();
+    stats.cacheMissesAfter += MeshOptimization::CountCacheMisses(indices.data(), indices.size(), vertices.size());
+}
+
+void LogOptimizationStats(const char* loaderName, const MeshOptimizationStats& stats)
+{
+    if (stats.triangles == 0)
+        return;
+
+    const double triangles = static_cast<double>(stats.triangles);
+    spdlog::info("{}: mesh optimization: {} -> {} unique vertices, ACMR {:.3f} -> {:.3f} ({} triangles, {}-entry FIFO)",
+        loaderName, stats.verticesBefore, stats.verticesAfter,
+        static_cast<double>(stats.cacheMissesBefore) / triangles, static_cast<double>(stats.cacheMissesAfter) / triangles,
+        stats.triangles, MeshOptimization::ACMR_CACHE_SIZE);
+}
+
+void VertexPackingStats::Accumulate(const VertexPackingStats& other)
+{
+    vertices += other.vertices;
+    packed.Merge(other.packed);
+    quantized.Merge(other.quantized);
+}
+
+bool IsVertexPackingReportEnabled()
+{
+    return g_packingReport.Get() != 0;
+}
+
+void MeasureVertexPacking(const std::vector<Vertex>& vertices, const DirectX::XMFLOAT3& aabbMin, const DirectX::XMFLOAT3& aabbMax, VertexPackingStats& stats)
+{
+    if (vertices.empty())
+        return;
+
+    const auto* source = reinterpret_cast<const VertexPacking::FloatVertex*>(vertices.data());
+    std::vector<VertexPacking::FloatVertex> decoded(vertices.size());
+
+    std::vector<VertexPacking::PackedVertex> packed(vertices.size());
+    VertexPacking::Pack(source, vertices.size(), packed.data());
+    VertexPacking::Unpack(packed.data(), packed.size(), decoded.data());
+    stats.packed.Merge(VertexPacking::MeasureError(source, decoded.data(), vertices.size()));
+
+    const float minimum[3] = { aabbMin.x, aabbMin.y, aabbMin.z };
+    const float maximum[3] = { aabbMax.x, aabbMax.y, aabbMax.z };
+    std::vector<VertexPacking::QuantizedVertex> quantized(vertices.size());
+    VertexPacking::PackQuantized(source, vertices.size(), minimum, maximum, quantized.data());
+    VertexPacking::UnpackQuantized(quantized.data(), quantized.size(), minimum, maximum, decoded.data());
+    stats.quantized.Merge(VertexPacking::MeasureError(source, decoded.data(), vertices.size()));
+
+    stats.vertices += vertices.size();
+}
+
+void LogVertexPackingStats(const char* loaderName, const VertexPackingStats& stats)
+{
+    if (stats.vertices == 0)
+        return;
+
+    constexpr double toMB = 1.0 / (1024.0 * 1024.0);
+    constexpr double toDegrees = 180.0 / 3.14159265358979323846;
+    const double full = static_cast<double>(stats.vertices * sizeof(Vertex)) * toMB;
+    const double packed = static_cast<double>(stats.vertices * sizeof(VertexPacking::PackedVertex)) * toMB;
+    const double quantized = static_cast<double>(stats.vertices * sizeof(VertexPacking::QuantizedVertex)) * toMB;
+
+    spdlog::info("{}: vertex packing: {} vertices, {:.1f} MB fp32 -> {:.1f} MB packed (-{:.1f} MB) / {:.1f} MB quantized (-{:.1f} MB)",
+        loaderName, stats.vertices, full, packed, full - packed, quantized, full - quantized);
+    spdlog::info("{}: vertex packing error: normal {:.4f} deg, tangent {:.4f} deg ({} sign flips), uv {:.2e}, quantized position {:.2e}",
+        loaderName, stats.packed.normalAngle * toDegrees, stats.packed.tangentAngle * toDegrees,
+        stats.packed.tangentSignFlips, stats.packed.uv, stats.quantized.position);
+}
+
+bool IsDeduplicationEnabled()
+{
+    return g_deduplicate.Get() != 0;
+}
+
+uint64_t HashGeometry(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices)
+{
+    const uint64_t vertexHash = ContentHash::HashBytes(vertices.data(), vertices.size() * sizeof(Vertex));
+    return ContentHash::HashBytes(indices.data(), indices.size() * sizeof(uint32_t), vertexHash);
+}
+
+bool GeometryEquals(const std::vector<Vertex>& aVertices, const std::vector<uint32_t>& aIndices,
+                    const std::vector<Vertex>& bVertices, const std::vector<uint32_t>& bIndices)
+{
+    return aVertices.size() == bVertices.size() && aIndices.size() == bIndices.size() &&
+        std::memcmp(aVertices.data(), bVertices.data(), aVertices.size() * sizeof(Vertex)) == 0 &&
+        std::memcmp(aIndices.data(), bIndices.data(), aIndices.size() * sizeof(uint32_t)) == 0;
+}
+
+void LogInstancingStats(const char* loaderName, const InstancingStats& stats)
+{
+    if (stats.primitives == 0)
+        return;
+
+    spdlog::info("{}: instancing: {} mesh primitive(s) -> {} model(s), folded {} instance(s) ({} by file, {} by content), {:.1f} MB geometry not stored",
+        loaderName, stats.primitives, stats.models, stats.primitives - stats.models,
+        stats.foldedByPath, stats.foldedByContent, static_cast<double>(stats.bytesSaved) / (1024.0 * 1024.0));
+}
+
 std::shared_ptr<AccelerationStructures> BuildAccelerationStructures(const Renderer& renderer, const SceneBuilder& scene)
 {
     using Microsoft::WRL::ComPtr;
@@ -3,6 +3,7 @@
 
 #include <algorithm>
 #include <cfloat>
+#include <chrono>
 #include <cmath>
 #include <filesystem>
 #include <unordered_map>
@@ -11,161 +12,175 @@
 
 #include "AccelerationStructures.h"
 #include "InputElements.h"
+#include "SceneResources/AccessorDecoding.h"
 #include "SceneResources/MeshProcessing.h"
 #include "SceneResources/TungstenLoading.h"
 #include "SceneResources/Model.h"
 #include "SceneResources/Primitive.h"
 #include "Renderer.h"
 #include "SceneResources/Scene.h"
+#include "SceneResources/SceneCaching.h"
 #include "SceneResources/SceneNode.h"
+#include "SceneResources/TextureDecoding.h"
 #include "ResourceManager/ResourceManagerTypes.h"
 #include "SceneResources/GameObject.h"
 #include "SceneResources/Material.h"
 #include "Resources/IndexBuffer.h"
 #include "Resources/VertexBuffer.h"
+#include "Utils/ContentHash.h"
+#include "Utils/ThreadPool.h"
 
-static void ExtractVertices(const tinygltf::Model& model, tinygltf::Primitive& primitive, std::vector<Vertex>& outVertices)
+// Resolves a glTF accessor into a bounds-checked byte view. Sparse accessors
+// and accessors without a bufferView are not supported by the importer.
+static bool MakeAccessorView(const tinygltf::Model& model, int accessorIndex, AccessorDecoding::AccessorView& outView)
 {
-    const bool has_position = primitive.attributes.find("POSITION") != primitive.attributes.end();
-    const bool has_normal = primitive.attributes.find("NORMAL") != primitive.attributes.end();
-    const bool has_tangent = primitive.attributes.find("TANGENT") != primitive.attributes.end();
-    const bool has_tex_coords = primitive.attributes.find("TEXCOORD_0") != primitive.attributes.end();
-    assert(has_position && "Mesh primitive must have POSITION attribute");
-
-    const float* positions = nullptr;
-    const float* normals = nullptr;
-    const float* tangents = nullptr;
-    const float* texCoords = nullptr;
-    size_t vertex_count = 0;
-
+    if (accessorIndex < 0 || accessorIndex >= static_cast<int>(model.accessors.size()))
+        return false;
 
-    
-    // POSITION
+    const tinygltf::Accessor& accessor = model.accessors[accessorIndex];
+    if (accessor.sparse.isSparse)
     {
-        const tinygltf::Accessor& accessor = model.accessors[primitive.attributes["POSITION"]];
-        const tinygltf::BufferView& buffer_view = model.bufferViews[accessor.bufferView];
-        const tinygltf::Buffer& buffer = model.buffers[buffer_view.buffer];
-
-        positions = reinterpret_cast<const float*>(&buffer.data[buffer_view.byteOffset + accessor.byteOffset]);
-        assert(positions && "Failed to extract vertices from glTF model. The POSITION attribute is null.");
-        
-        // Each accessor for attributes has the same count.
-        vertex_count = accessor.count;
+        spdlog::warn("glTF accessor '{}' is sparse; sparse accessors are not supported", accessor.name);
+        return false;
     }
+    if (accessor.bufferView < 0)
+        return false;
 
-    if (has_normal)
+    const tinygltf::BufferView& buffer_view = model.bufferViews[accessor.bufferView];
+    const tinygltf::Buffer& buffer = model.buffers[buffer_view.buffer];
+    const int stride = accessor.ByteStride(buffer_view);
+    if (stride <= 0)
     {
-        const tinygltf::Accessor& accessor = model.accessors[primitive.attributes["NORMAL"]];
-        const tinygltf::BufferView& buffer_view = model.bufferViews[accessor.bufferView];
-        const tinygltf::Buffer& buffer = model.buffers[buffer_view.buffer];
-
-        normals = reinterpret_cast<const float*>(&buffer.data[buffer_view.byteOffset + accessor.byteOffset]);
+        spdlog::error("glTF accessor '{}' has an invalid byteStride", accessor.name);
+        return false;
     }
 
-    if (has_tangent)
-    {
-        const tinygltf::Accessor& accessor = model.accessors[primitive.attributes["TANGENT"]];
-        const tinygltf::BufferView& buffer_view = model.bufferViews[accessor.bufferView];
-        const tinygltf::Buffer& buffer = model.buffers[buffer_view.buffer];
+    outView.data = buffer.data.data() + buffer_view.byteOffset + accessor.byteOffset;
+    outView.count = accessor.count;
+    outView.stride = static_cast<size_t>(stride);
+    outView.componentType = static_cast<AccessorDecoding::ComponentType>(accessor.componentType);
+    outView.componentCount = tinygltf::GetNumComponentsInType(static_cast<uint32_t>(accessor.type));
+    outView.normalized = accessor.normalized;
 
-        tangents = reinterpret_cast<const float*>(&buffer.data[buffer_view.byteOffset + accessor.byteOffset]);
-    }
-    
-    //TEXTURE COORDINATES
-    if (has_tex_coords)
+    const size_t begin = buffer_view.byteOffset + accessor.byteOffset;
+    if (outView.componentCount <= 0 || begin + AccessorDecoding::RequiredBytes(outView) > buffer.data.size())
     {
-        const tinygltf::Accessor& accessor = model.accessors[primitive.attributes["TEXCOORD_0"]];
-        const tinygltf::BufferView& buffer_view = model.bufferViews[accessor.bufferView];
-        const tinygltf::Buffer& buffer = model.buffers[buffer_view.buffer];
-
-        texCoords = reinterpret_cast<const float*>(&buffer.data[buffer_view.byteOffset + accessor.byteOffset]);
+        spdlog::error("glTF accessor '{}' reads past the end of its buffer", accessor.name);
+        return false;
     }
+    return true;
+}
 
-    // PROCESS
+static int FindAttribute(const tinygltf::Primitive& primitive, const char* name)
+{
+    const auto it = primitive.attributes.find(name);
+    return it != primitive.attributes.end() ? it->second : -1;
+}
 
-    for (size_t i = 0; i < vertex_count; i++)
+// Decodes every attribute stream straight into a preallocated Vertex array.
+// outHasNormals / outHasTangents report streams that actually decoded, so a
+// present but unreadable NORMAL or TANGENT is generated like a missing one.
+static bool ExtractVertices(const tinygltf::Model& model, const tinygltf::Primitive& primitive, std::vector<Vertex>& outVertices, bool& outHasNormals, bool& outHasTangents)
+{
+    using AccessorDecoding::AccessorView;
+
+    AccessorView positions;
+    if (!MakeAccessorView(model, FindAttribute(primitive, "POSITION"), positions))
     {
-        Vertex vertex{};
+        spdlog::error("glTF mesh primitive has no readable POSITION attribute");
+        return false;
+    }
 
-        // Inverting Y and Z to convert from right-handed to left-handed coordinate system. https://stackoverflow.com/questions/16986017/how-do-i-make-blender-operate-in-left-hand
-        vertex.Pos.x = positions[i * 3 + 0];
-        vertex.Pos.y = positions[i * 3 + 1];
-        vertex.Pos.z = positions[i * 3 + 2];
+    // Each accessor for attributes has the same count. Defaults cover missing
+    // streams: ComputeNormals / ComputeTangents fill those in later.
+    outVertices.assign(positions.count, Vertex{ {0, 0, 0}, {0, 1, 0}, {0, 0, 0, 1.0f}, {0, 0} });
+    Vertex* base = outVertices.data();
+    constexpr size_t stride = sizeof(Vertex);
 
-        vertex.Normal = DirectX::XMFLOAT3{0, 1, 0};
-        vertex.Tex0 = DirectX::XMFLOAT2{0,0};
+    AccessorDecoding::DecodeFloats(positions, &base->Pos.x, stride, 3);
 
-        if (has_normal)
-        {
-            vertex.Normal.x = normals[i * 3 + 0];
-            vertex.Normal.y = normals[i * 3 + 1];
-            vertex.Normal.z = normals[i * 3 + 2];
-        }
-        
-        if (has_tex_coords)
-        {
-            vertex.Tex0.x = texCoords[i * 2 + 0];
-            vertex.Tex0.y = texCoords[i * 2 + 1];
-        }
+    AccessorView view;
+    outHasNormals = MakeAccessorView(model, FindAttribute(primitive, "NORMAL"), view) && view.count == positions.count
+        && view.componentCount >= 3 && AccessorDecoding::DecodeFloats(view, &base->Normal.x, stride, 3);
 
-        if (has_tangent)
-        {
-            // glTF TANGENT is VEC4: xyz = tangent direction, w = handedness (+/-1)
-            vertex.Tangent.x = tangents[i * 4 + 0];
-            vertex.Tangent.y = tangents[i * 4 + 1];
-            vertex.Tangent.z = tangents[i * 4 + 2];
-            vertex.Tangent.w = tangents[i * 4 + 3];
-        }
-        else
-        {
-            vertex.Tangent = {0, 0, 0, 1.0f};  // Accumulated per-triangle in ComputeTangents
-        }
+    // glTF TANGENT is VEC4: xyz = tangent direction, w = handedness (+/-1)
+    outHasTangents = MakeAccessorView(model, FindAttribute(primitive, "TANGENT"), view) && view.count == positions.count
+        && view.componentCount == 4 && AccessorDecoding::DecodeFloats(view, &base->Tangent.x, stride, 4);
+
+    if (MakeAccessorView(model, FindAttribute(primitive, "TEXCOORD_0"), view) && view.count == positions.count)
+        AccessorDecoding::DecodeFloats(view, &base->Tex0.x, stride, 2);
+
+    return true;
+}
+
+static bool ExtractIndices(const tinygltf::Model& model, const tinygltf::Primitive& primitive, std::vector<uint32_t>& outIndices)
+{
+    AccessorDecoding::AccessorView view;
+    if (!MakeAccessorView(model, primitive.indices, view))
+    {
+        spdlog::error("Failed loading glTF model. Mesh primitive must have readable indices");
+        return false;
+    }
+
+    outIndices.resize(view.count);
+    if (!AccessorDecoding::DecodeIndices(view, outIndices.data()))
+    {
+        spdlog::error("Unsupported glTF index component type {}", static_cast<int>(view.componentType));
+        outIndices.clear();
+        return false;
+    }
 
-        outVertices.push_back(vertex);
+    if (outIndices.size() % 3 != 0)
+    {
+        spdlog::warn("glTF index count {} is not a multiple of 3; trailing indices dropped", outIndices.size());
+        outIndices.resize(outIndices.size() - outIndices.size() % 3);
     }
+    return true;
 }
 
-static void ExtractIndices(const tinygltf::Model& model, const tinygltf::Primitive& primitive, std::vector<uint32_t>& outIndices)
+// Image loader for tinygltf: keeps the encoded bytes (width -1 marks them) so
+// DecodeImages can decode every image on the pool after parsing.
+static bool DeferImageDecode(tinygltf::Image* image, const int, std::string*, std::string*, int, int, const unsigned char* bytes, int size, void*)
 {
-    assert(primitive.indices >= 0 && "Failed loading glTF model. Mesh primitive must have indices");
-    
-    const auto& accessor = model.accessors[primitive.indices];
-    const auto& buffer_view = model.bufferViews[accessor.bufferView];
-    const auto& buffer = model.buffers[buffer_view.buffer];
-    
-    switch (accessor.componentType)
+    image->image.assign(bytes, bytes + size);
+    image->width = image->height = image->component = -1;
+    return true;
+}
+
+static void DecodeImages(tinygltf::Model& model)
+{
+    const auto start = std::chrono::high_resolution_clock::now();
+    std::vector<const char*> errors(model.images.size(), nullptr);
+    ThreadPool::Get().ParallelFor(model.images.size(), [&](size_t i)
     {
-        case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
-        {
-            const uint16_t* rawIndices = reinterpret_cast<const uint16_t*>(&buffer.data[buffer_view.byteOffset + accessor.byteOffset]);
-            outIndices.reserve(accessor.count);
-            for (int i = 0; i < accessor.count; i+=3)
-            {
-                outIndices.push_back(rawIndices[i]);
-                outIndices.push_back(rawIndices[i+1]);
-                outIndices.push_back(rawIndices[i+2]);
-            }
-
-            break;
-        }
+        tinygltf::Image& image = model.images[i];
+        if (image.width != -1 || image.image.empty())
+            return;
 
-        case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT:
-        {
-            const uint32_t* rawIndices = reinterpret_cast<const uint32_t*>(&buffer.data[buffer_view.byteOffset + accessor.byteOffset]);
-            outIndices.reserve(accessor.count);
-            for (int i = 0; i < accessor.count; i+=3)
-            {
-                outIndices.push_back(rawIndices[i]);
-                outIndices.push_back(rawIndices[i+1]);
-                outIndices.push_back(rawIndices[i+2]);
-            }
-            break;
-        }
-        default:
+        TextureDecoding::Image decoded;
+        if (!TextureDecoding::DecodeMemory(image.image.data(), image.image.size(), decoded, &errors[i]))
         {
-            assert("False: Unsupported index component type");
-            break;            
+            image.image.clear();
+            image.width = image.height = image.component = 0;
+            return;
         }
+        image.width = decoded.width;
+        image.height = decoded.height;
+        image.component = 4;
+        image.bits = 8;
+        image.pixel_type = TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE;
+        image.image = std::move(decoded.rgba);
+    });
+
+    for (size_t i = 0; i < errors.size(); ++i)
+        if (errors[i])
+            spdlog::warn("glTF: cannot decode image {} '{}': {}", i, model.images[i].name, errors[i]);
+
+    if (!model.images.empty())
+    {
+        spdlog::info("glTF: decoded {} image(s) in {:.1f} ms on {} thread(s)", model.images.size(),
+            std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count(),
+            ThreadPool::Get().GetThreadCount());
     }
 }
 
@@ -174,6 +189,7 @@ static bool LoadTinyGLTFModel(const std::filesystem::path &path, tinygltf::Model
     tinygltf::TinyGLTF loader;
     std::string err;
     std::string warn;
+    loader.SetImageLoader(DeferImageDecode, nullptr);
 
     spdlog::debug("Loading glTF model from path: {}", path.string());
     
@@ -201,60 +217,110 @@ static bool LoadTinyGLTFModel(const std::filesystem::path &path, tinygltf::Model
     return true;
 }
 
-static std::shared_ptr<Texture> GetOrCreateTexture(Renderer& renderer, const tinygltf::Model& model, int textureIndex, std::unordered_map<int, std::shared_ptr<Texture>>& textureCache)
+// An image referenced from several material slots is encoded for the first one.
+static std::shared_ptr<Texture> GetOrCreateTexture(Renderer& renderer, const tinygltf::Model& model, int textureIndex, TextureProcessing::TextureUsage usage, std::unordered_map<int, std::shared_ptr<Texture>>& textureCache, SceneCaching::Recorder* cacheRecorder)
 {
     int sourceIndex = model.textures[textureIndex].source;
     auto it = textureCache.find(sourceIndex);
     if (it != textureCache.end())
         return it->second;
 
-    auto texture = renderer.CreateTextureFromGLTF(model.images[sourceIndex]);
+    const tinygltf::Image& image = model.images[sourceIndex];
+    if (image.width <= 0 || image.height <= 0 || image.image.empty())
+    {
+        textureCache[sourceIndex] = nullptr;
+        return nullptr;
+    }
+    auto texture = renderer.CreateTextureFromGLTF(image, usage);
+    if (cacheRecorder)
+        cacheRecorder->AddTexture(texture, image.image.data(), image.width, image.height, image.component);
     textureCache[sourceIndex] = texture;
     return texture;
 }
 
-static std::shared_ptr<Primitive> LoadPrimitive(Renderer& renderer, const tinygltf::Model& model, tinygltf::Primitive& primitive, std::vector<Vertex>& outVertices, std::vector<uint32_t>& outIndices, std::unordered_map<int, std::shared_ptr<Texture>>& textureCache)
+// External .bin buffers and images; embedded data: URIs are covered by the
+// scene file's own hash.
+static void AddCacheDependencies(const tinygltf::Model& model, const std::filesystem::path& sceneDir, SceneCaching::Recorder& cacheRecorder)
 {
-    assert(primitive.indices >= 0 && "Failed loading glTF model. Mesh primitive must have indices");
+    auto isExternal = [](const std::string& uri) { return !uri.empty() && uri.rfind("data:", 0) != 0; };
+    for (const tinygltf::Buffer& buffer : model.buffers)
+        if (isExternal(buffer.uri))
+            cacheRecorder.AddDependency(sceneDir / std::filesystem::u8path(buffer.uri));
+    for (const tinygltf::Image& image : model.images)
+        if (isExternal(image.uri))
+            cacheRecorder.AddDependency(sceneDir / std::filesystem::u8path(image.uri));
+}
 
-    std::vector<Vertex> vertices = {};
-    std::vector<uint32_t> indices = {};
-    
-    ExtractIndices(model, primitive, indices);
-    ExtractVertices(model, primitive, vertices);
+// CPU half of a primitive load: decode and degenerate drop, then normals/tangents,
+// then invariants, optimization and the local AABB. Touches no renderer state, so
+// primitives of all meshes run concurrently within each stage.
+struct PrimitiveGeometry
+{
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    DirectX::XMFLOAT3 localMin{  FLT_MAX,  FLT_MAX,  FLT_MAX };
+    DirectX::XMFLOAT3 localMax{ -FLT_MAX, -FLT_MAX, -FLT_MAX };
+    bool hasNormals = false;
+    bool hasTangents = false;
+    MeshUtils::MeshOptimizationStats optimizationStats;
+    MeshUtils::VertexPackingStats packingStats;
+};
+
+static void DecodePrimitiveGeometry(const tinygltf::Model& model, const tinygltf::Primitive& primitive, PrimitiveGeometry& out)
+{
+    if (!ExtractIndices(model, primitive, out.indices) || !ExtractVertices(model, primitive, out.vertices, out.hasNormals, out.hasTangents))
+    {
+        out.vertices.clear();
+        out.indices.clear();
+        return;
+    }
 
-    assert(vertices.size() < INT_MAX);
-    assert(indices.size() < INT_MAX);
+    assert(out.vertices.size() < INT_MAX);
+    assert(out.indices.size() < INT_MAX);
 
-    MeshUtils::DropDegenerateTriangles(vertices, indices);
+    MeshUtils::DropDegenerateTriangles(out.vertices, out.indices);
+}
 
-    const bool has_normal = primitive.attributes.find("NORMAL") != primitive.attributes.end();
-    if (!has_normal)
-        MeshUtils::ComputeNormals(vertices, indices);
+static void FinishPrimitiveGeometry(bool measurePacking, PrimitiveGeometry& out)
+{
+    MeshUtils::EnforceVertexInvariants(out.vertices);
+    MeshUtils::OptimizeMesh(out.vertices, out.indices, out.optimizationStats);
 
-    const bool has_tangent = primitive.attributes.find("TANGENT") != primitive.attributes.end();
-    if (!has_tangent)
-        MeshUtils::ComputeTangents(vertices, indices);
+    for (const Vertex& v : out.vertices)
+    {
+        out.localMin.x = std::min(out.localMin.x, v.Pos.x);
+        out.localMin.y = std::min(out.localMin.y, v.Pos.y);
+        out.localMin.z = std::min(out.localMin.z, v.Pos.z);
+        out.localMax.x = std::max(out.localMax.x, v.Pos.x);
+        out.localMax.y = std::max(out.localMax.y, v.Pos.y);
+        out.localMax.z = std::max(out.localMax.z, v.Pos.z);
+    }
 
-    MeshUtils::EnforceVertexInvariants(vertices);
+    if (measurePacking)
+        MeshUtils::MeasureVertexPacking(out.vertices, out.localMin, out.localMax, out.packingStats);
+}
 
+// Renderer half: material/textures and the buffer views at the given offsets
+// into the scene-wide vertex/index arrays.
+static std::shared_ptr<Primitive> CreatePrimitive(Renderer& renderer, const tinygltf::Model& model, const tinygltf::Primitive& primitive, const PrimitiveGeometry& geometry, size_t vertexOffset, size_t indexOffset, std::unordered_map<int, std::shared_ptr<Texture>>& textureCache, SceneCaching::Recorder* cacheRecorder)
+{
     std::shared_ptr<Material> material = std::make_shared<Material>();
 
     if (!model.materials.empty())
     {
         if (int albedo_index = model.materials[primitive.material].pbrMetallicRoughness.baseColorTexture.index; albedo_index >= 0)
         {
-            material->m_albedoTexture = GetOrCreateTexture(renderer, model, albedo_index, textureCache);
+            material->m_albedoTexture = GetOrCreateTexture(renderer, model, albedo_index, TextureProcessing::TextureUsage::Albedo, textureCache, cacheRecorder);
         }
 
         if (int normal_texture_index = model.materials[primitive.material].normalTexture.index; normal_texture_index >= 0)
         {
-            material->m_normalTexture = GetOrCreateTexture(renderer, model, normal_texture_index, textureCache);
+            material->m_normalTexture = GetOrCreateTexture(renderer, model, normal_texture_index, TextureProcessing::TextureUsage::Normal, textureCache, cacheRecorder);
         }
 
         if (int metallic_roughness_index = model.materials[primitive.material].pbrMetallicRoughness.metallicRoughnessTexture.index; metallic_roughness_index >= 0)
         {
-            material->m_metallicRoughnessTexture = GetOrCreateTexture(renderer, model, metallic_roughness_index, textureCache);
+            material->m_metallicRoughnessTexture = GetOrCreateTexture(renderer, model, metallic_roughness_index, TextureProcessing::TextureUsage::MetallicRoughness, textureCache, cacheRecorder);
         }
         
         if (model.materials[primitive.material].alphaMode != "OPAQUE")
@@ -273,37 +339,21 @@ static std::shared_ptr<Primitive> LoadPrimitive(Renderer& renderer, const tinygl
 
     auto index_view = BufferView();
     index_view.buffer = nullptr;
-    index_view.count = indices.size();
-    index_view.offset = outIndices.size();
-    index_view.offsetBytes = outIndices.size() * sizeof(uint32_t);
-    index_view.size = indices.size() * sizeof(uint32_t);
+    index_view.count = geometry.indices.size();
+    index_view.offset = indexOffset;
+    index_view.offsetBytes = indexOffset * sizeof(uint32_t);
+    index_view.size = geometry.indices.size() * sizeof(uint32_t);
 
     auto vertex_view = BufferView();
     vertex_view.buffer = nullptr;
-    vertex_view.count = vertices.size();
-    vertex_view.offset = outVertices.size();
-    vertex_view.offsetBytes = outVertices.size() * sizeof(Vertex);
-    vertex_view.size = vertices.size() * sizeof(Vertex);
-
-    DirectX::XMFLOAT3 local_min{  FLT_MAX,  FLT_MAX,  FLT_MAX };
-    DirectX::XMFLOAT3 local_max{ -FLT_MAX, -FLT_MAX, -FLT_MAX };
-    for (const Vertex& v : vertices)
-    {
-        local_min.x = std::min(local_min.x, v.Pos.x);
-        local_min.y = std::min(local_min.y, v.Pos.y);
-        local_min.z = std::min(local_min.z, v.Pos.z);
-        local_max.x = std::max(local_max.x, v.Pos.x);
-        local_max.y = std::max(local_max.y, v.Pos.y);
-        local_max.z = std::max(local_max.z, v.Pos.z);
-    }
-
-    // Need to be done here after buffer views to have correct offset.
-    outVertices.insert(outVertices.end(), vertices.begin(), vertices.end());
-    outIndices.insert(outIndices.end(), indices.begin(), indices.end());
+    vertex_view.count = geometry.vertices.size();
+    vertex_view.offset = vertexOffset;
+    vertex_view.offsetBytes = vertexOffset * sizeof(Vertex);
+    vertex_view.size = geometry.vertices.size() * sizeof(Vertex);
 
     auto prim = std::make_shared<Primitive>(vertex_view, index_view, material);
-    prim->m_localAabbMin = local_min;
-    prim->m_localAabbMax = local_max;
+    prim->m_localAabbMin = geometry.localMin;
+    prim->m_localAabbMax = geometry.localMax;
     return prim;
 }
 
@@ -501,20 +551,18 @@ static void LoadLights(const tinygltf::Model& model, SceneBuilder& sceneBuilder)
     }
 }
 
-std::shared_ptr<Scene> ModelLoading::LoadScene(Renderer& renderer, const AssetId& assetId)
+static std::shared_ptr<Scene> LoadGLTFScene(Renderer& renderer, const AssetId& assetId, SceneCaching::Recorder* cacheRecorder)
 {
-    spdlog::info("Loading scene {}", assetId.AsString());
-
-    std::string extension = assetId.AsPath().extension().string();
-    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
-    if (extension == ".json")
-        return TungstenLoading::LoadScene(renderer, assetId);
-
     tinygltf::Model model;
     bool succeeded = LoadTinyGLTFModel(assetId.AsPath(), model);
 
     assert(succeeded && "Failed to load model");
     assert(model.scenes.size() > 0 && "Model has no scenes!");
+
+    DecodeImages(model);
+
+    if (cacheRecorder)
+        AddCacheDependencies(model, assetId.AsPath().parent_path(), *cacheRecorder);
     
     auto scene_builder = SceneBuilder();
 
@@ -524,18 +572,97 @@ std::shared_ptr<Scene> ModelLoading::LoadScene(Renderer& renderer, const AssetId
     std::vector<uint32_t> indices;
     std::unordered_map<int, std::shared_ptr<Texture>> textureCache;
     
-    for (auto gltf_model : model.meshes)
+    // Flatten every mesh primitive; the geometry stage runs one pool task each.
+    struct PrimitiveJob
+    {
+        size_t meshIndex;
+        const tinygltf::Primitive* primitive;
+        PrimitiveGeometry geometry;
+    };
+    std::vector<PrimitiveJob> jobs;
+    for (size_t mesh_index = 0; mesh_index < model.meshes.size(); ++mesh_index)
+        for (const auto& primitive : model.meshes[mesh_index].primitives)
+            jobs.push_back({ mesh_index, &primitive, {} });
+
+    const bool measure_packing = MeshUtils::IsVertexPackingReportEnabled();
+    const bool verify_attributes = MeshUtils::IsAttributeVerificationEnabled();
+    const auto geometry_start = std::chrono::high_resolution_clock::now();
+    ThreadPool::Get().ParallelFor(jobs.size(), [&](size_t i)
+    {
+        DecodePrimitiveGeometry(model, *jobs[i].primitive, jobs[i].geometry);
+    });
+
+    // Normals/tangents where the asset has no decodable stream. Large
+    // primitives take the whole pool one at a time; the rest share it.
+    const auto attributes_start = std::chrono::high_resolution_clock::now();
+    const size_t large_primitives = MeshUtils::ForEachByWeight(jobs.size(), MeshUtils::LARGE_MESH_TRIANGLES,
+        [&](size_t i) { return jobs[i].geometry.indices.size() / 3; },
+        [&](size_t i)
+        {
+            PrimitiveGeometry& geometry = jobs[i].geometry;
+            MeshUtils::GenerateAttributes(geometry.vertices, geometry.indices, !geometry.hasNormals, !geometry.hasTangents, verify_attributes);
+        });
+    const double attributes_ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - attributes_start).count();
+
+    ThreadPool::Get().ParallelFor(jobs.size(), [&](size_t i)
+    {
+        FinishPrimitiveGeometry(measure_packing, jobs[i].geometry);
+    });
+    const double geometry_ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - geometry_start).count();
+
+    // Offsets by prefix sum in mesh/primitive order, same layout as a serial load.
+    std::vector<size_t> vertex_offsets(jobs.size());
+    std::vector<size_t> index_offsets(jobs.size());
+    for (size_t i = 0; i < jobs.size(); ++i)
+    {
+        vertex_offsets[i] = vertices.size();
+        index_offsets[i] = indices.size();
+        vertices.resize(vertices.size() + jobs[i].geometry.vertices.size());
+        indices.resize(indices.size() + jobs[i].geometry.indices.size());
+    }
+    ThreadPool::Get().ParallelFor(jobs.size(), [&](size_t i)
+    {
+        const PrimitiveGeometry& geometry = jobs[i].geometry;
+        std::copy(geometry.vertices.begin(), geometry.vertices.end(), vertices.begin() + static_cast<ptrdiff_t>(vertex_offsets[i]));
+        std::copy(geometry.indices.begin(), geometry.indices.end(), indices.begin() + static_cast<ptrdiff_t>(index_offsets[i]));
+    });
+
+    spdlog::info("glTF: processed {} primitive(s), {} vertices / {} indices in {:.1f} ms on {} thread(s)",
+        jobs.size(), vertices.size(), indices.size(), geometry_ms, ThreadPool::Get().GetThreadCount());
+    spdlog::info("glTF: normals/tangents took {:.1f} ms ({} large primitive(s) split across the pool)", attributes_ms, large_primitives);
+
+    MeshUtils::MeshOptimizationStats optimization_stats;
+    MeshUtils::VertexPackingStats packing_stats;
+    for (const PrimitiveJob& job : jobs)
+    {
+        optimization_stats.Accumulate(job.geometry.optimizationStats);
+        packing_stats.Accumulate(job.geometry.packingStats);
+    }
+    MeshUtils::LogOptimizationStats("glTF", optimization_stats);
+    MeshUtils::LogVertexPackingStats("glTF", packing_stats);
+
+    renderer.BeginTextureUploads();
+    size_t job_index = 0;
+    for (size_t mesh_index = 0; mesh_index < model.meshes.size(); ++mesh_index)
     {
         auto current_model = std::make_shared<Model>();
 
-        for (auto& primitive : gltf_model.primitives)
+        for (; job_index < jobs.size() && jobs[job_index].meshIndex == mesh_index; ++job_index)
         {
-            auto prim = LoadPrimitive(renderer, model, primitive, vertices, indices, textureCache);
+            PrimitiveJob& job = jobs[job_index];
+            // Undecodable or fully degenerate: nothing to draw or trace.
+            if (job.geometry.indices.empty())
+                continue;
+            auto prim = CreatePrimitive(renderer, model, *job.primitive, job.geometry, vertex_offsets[job_index], index_offsets[job_index], textureCache, cacheRecorder);
             current_model->AddMesh(prim);
+
+            std::vector<Vertex>().swap(job.geometry.vertices);
+            std::vector<uint32_t>().swap(job.geometry.indices);
         }
 
         scene_builder.AddModel(current_model);
     }
+    renderer.EndTextureUploads();
 
     LoadLights(model, scene_builder);
     
@@ -595,7 +722,41 @@ std::shared_ptr<Scene> ModelLoading::LoadScene(Renderer& renderer, const AssetId
     }
 
     scene_builder.UpdateMatrices(); // Needs to be done before TLAS building for instances to have the correct positions.
+    if (cacheRecorder)
+        cacheRecorder->Write(scene_builder, vertices, indices);
     scene_builder.SetAccelerationStructures(MeshUtils::BuildAccelerationStructures(renderer, scene_builder));
     
     return scene_builder.Build(renderer);
+}
+
+std::shared_ptr<Scene> ModelLoading::LoadScene(Renderer& renderer, const AssetId& assetId)
+{
+    spdlog::info("Loading scene {}", assetId.AsString());
+    const auto start = std::chrono::high_resolution_clock::now();
+
+    // The cache is keyed by the scene file; the importer records everything
+    // else it reads as dependencies of the baked file.
+    uint64_t source_hash = 0;
+    std::unique_ptr<SceneCaching::Recorder> cache_recorder;
+    if (SceneCaching::IsEnabled() && ContentHash::HashFile(assetId.AsPath(), source_hash))
+    {
+        if (auto scene = SceneCaching::TryLoad(renderer, assetId, source_hash))
+        {
+            spdlog::info("Loaded scene {} from cache in {:.1f} ms", assetId.AsString(),
+                std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count());
+            return scene;
+        }
+        cache_recorder = std::make_unique<SceneCaching::Recorder>(assetId, source_hash);
+    }
+
+    std::string extension = assetId.AsPath().extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+    auto scene = extension == ".json"
+        ? TungstenLoading::LoadScene(renderer, assetId, cache_recorder.get())
+        : LoadGLTFScene(renderer, assetId, cache_recorder.get());
+
+    spdlog::info("Imported scene {} in {:.1f} ms{}", assetId.AsString(),
+        std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count(),
+        cache_recorder ? " (including cache bake)" : "");
+    return scene;
 } 
\ No newline at end of file
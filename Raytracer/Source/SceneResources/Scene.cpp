@@ -1,7 +1,8 @@
 ﻿#include "pch.h"
 #include "SceneResources/Scene.h"
 
-#include <cfloat>
+#include <chrono>
+#include <cstring>
 
 #include "SceneResources/GameObject.h"
 #include "Model.h"
@@ -12,11 +13,39 @@
 #include "SceneResources/Model.h"
 #include "SceneResources/Material.h"
 #include "SceneResources/Primitive.h"
+#include "SceneResources/SceneBuildPasses.h"
 #include "SceneResources/SceneNode.h"
+#include "SceneResources/TransformHierarchy.h"
+#include "Utils/ThreadPool.h"
+
+// One batched world-matrix pass over the dirty subtrees, then a constant
+// buffer upload for each recomputed node that carries a game object.
+static void ApplyTransforms(TransformHierarchy& transforms, const std::vector<SceneNode*>& nodes)
+{
+    std::vector<uint32_t> changed;
+    transforms.Update(&changed);
+    for (const uint32_t index : changed)
+    {
+        if (const auto gameObject = nodes[index]->GetGameObject())
+        {
+            DirectX::XMFLOAT4X4 world;
+            static_assert(sizeof(world) == sizeof(TransformHierarchy::Matrix), "Both are row-major 4x4 floats");
+            std::memcpy(&world, &transforms.GetWorld(index), sizeof(world));
+            gameObject->UpdateWorldMatrix(world);
+        }
+    }
+}
+
+void Scene::UpdateTransforms()
+{
+    if (m_transforms)
+        ApplyTransforms(*m_transforms, m_transformNodes);
+}
 
 SceneBuilder::SceneBuilder()
 {
     m_root = std::make_shared<SceneNode>();
+    m_transforms = std::make_shared<TransformHierarchy>();
 }
 
 void SceneBuilder::AddGameObject(const std::shared_ptr<GameObject>& gameObject, const std::shared_ptr<Model>& model)
@@ -25,14 +54,23 @@ void SceneBuilder::AddGameObject(const std::shared_ptr<GameObject>& gameObject,
     m_gameObjects.push_back(gameObject);
 }
 
+// Geometry ids are the primitives' indices in the geometry-info buffer, in
+// model order; importers add a model only once its meshes are complete.
 void SceneBuilder::AddModel(const std::shared_ptr<Model>& model)
 {
     m_models.push_back(model);
+    for (const auto& primitive : model->GetMeshes())
+    {
+        assert(primitive->m_geometryId == Primitive::INVALID_GEOMETRY_ID && "Primitive added to the scene twice");
+        primitive->m_geometryId = static_cast<uint32_t>(m_primitives.size());
+        m_primitives.push_back(primitive);
+    }
 }
 
 void SceneBuilder::AddChild(const std::shared_ptr<SceneNode>& parent, const std::shared_ptr<SceneNode>& child)
 {
     parent->AddChild(child);
+    m_transformsStale = true;
 }
 
 void SceneBuilder::AddLightData(const LightData& lightData)
@@ -62,153 +100,175 @@ void SceneBuilder::SetIndexBuffer(const std::shared_ptr<IndexBuffer>& indexBuffe
 
 void SceneBuilder::UpdateMatrices()
 {
-    UpdateMatricesInNodesRecursively(m_root);
+    if (m_transformsStale)
+        FlattenTransforms();
+    ApplyTransforms(*m_transforms, m_transformNodes);
 }
 
-static std::shared_ptr<StructuredBuffer<GeometryInfo>> CreateGeometryInfoBuffer(Renderer& renderer, const std::vector<std::shared_ptr<Primitive>>& primitives)
+// Pre-order, so every parent lands before its children and siblings keep
+// their insertion order. Rebinds every node to its new slot (all dirty).
+void SceneBuilder::FlattenTransforms()
 {
-    std::vector<GeometryInfo> models_info;
-    
-    for (auto primitive : primitives)
-    {
-        GeometryInfo info = {};
-        info.vertexOffset = primitive->GetVertexView().offset;
-        info.indexOffset = primitive->GetIndexView().offset;
-        models_info.push_back(info);
-    }
+    m_transforms->Clear();
+    m_transformNodes.clear();
 
-    auto geo_buffer = renderer.CreateStructuredBuffer(models_info);
-    
-    return geo_buffer;
-}
-
-static std::shared_ptr<StructuredBuffer<InstanceInfo>> CreateInstanceInfoBuffer(Renderer& renderer, const std::vector<std::shared_ptr<GameObject>>& gameObjects, const std::vector<std::shared_ptr<Primitive>>& primitives)
-{
-    std::vector<InstanceInfo> instances_info;
-    
-    for (auto go : gameObjects)
+    std::vector<std::pair<SceneNode*, uint32_t>> stack = { { m_root.get(), TransformHierarchy::NO_PARENT } };
+    while (!stack.empty())
     {
-        auto model = go->GetModel();
+        const auto [node, parent] = stack.back();
+        stack.pop_back();
 
-        for (auto primitive : model->GetMeshes())
-        {
-            auto it = std::find(primitives.begin(), primitives.end(), primitive);
-            assert(it != primitives.end() && "Primitive not found in the list of all primitives when creating instance info buffer.");
-            int geometry_id = static_cast<int>(std::distance(primitives.begin(), it));
-            int texture_id = -1;
-            int normal_texture_id = -1;
-            int roughness_texture_id = -1;
-            float metallic_factor = 1.0f;
-            float roughness_factor = 1.0f;
-            DirectX::XMFLOAT4 base_color_factor = { 1.0f, 1.0f, 1.0f, 1.0f };
-
-            if (primitive->m_material)
-            {
-                if (primitive->m_material->m_albedoTexture)
-                    texture_id = primitive->m_material->m_albedoTexture->GetTextureIndex();
-
-                if (primitive->m_material->m_normalTexture)
-                    normal_texture_id = primitive->m_material->m_normalTexture->GetTextureIndex();
-
-                if (primitive->m_material->m_metallicRoughnessTexture)
-                    roughness_texture_id = primitive->m_material->m_metallicRoughnessTexture->GetTextureIndex();
-
-                metallic_factor = primitive->m_material->m_data.metallicFactor;
-                roughness_factor = primitive->m_material->m_data.roughnessFactor;
-                base_color_factor = primitive->m_material->m_data.baseColorFactor;
-            }
-
-            InstanceInfo info = {};
-            info.geometryId = geometry_id;
-            info.textureId = texture_id;
-            info.normalTextureId = normal_texture_id;
-            info.roughnessTextureId = roughness_texture_id;
-            info.metallicFactor = metallic_factor;
-            info.roughnessFactor = roughness_factor;
-            info.baseColorFactor = base_color_factor;
-            // Explicit transpose into the DXR ObjectToWorld3x4 layout.
-            const DirectX::XMFLOAT4X4 world = go->GetWorldFloat4X4();
-            for (int r = 0; r < 3; ++r)
-                for (int c = 0; c < 4; ++c)
-                    info.objectToWorld.m[r][c] = world.m[c][r];
-            instances_info.push_back(info);
-        }
-    }
+        const Transform& transform = node->m_transform;
+        node->m_hierarchy = m_transforms.get();
+        node->m_transformIndex = m_transforms->Add(parent, &transform.position.x, &transform.rotation.x, &transform.scale.x);
+        m_transformNodes.push_back(node);
 
-    return renderer.CreateStructuredBuffer(instances_info);
+        const auto& children = node->GetChildren();
+        for (auto it = children.rbegin(); it != children.rend(); ++it)
+            stack.emplace_back(it->get(), node->m_transformIndex);
+    }
+    m_transformsStale = false;
 }
 
-static std::shared_ptr<StructuredBuffer<LightData>> CreateLightDataBuffer(Renderer& renderer, const std::vector<LightData>& lightData)
+static double MillisecondsSince(std::chrono::high_resolution_clock::time_point start)
 {
-    return renderer.CreateStructuredBuffer(lightData);
+    return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
 }
 
-static void ComputeWorldAabb(const std::vector<std::shared_ptr<GameObject>>& gameObjects, DirectX::XMFLOAT3& outMin, DirectX::XMFLOAT3& outMax)
+static std::vector<GeometryInfo> PackGeometryInfo(const std::vector<std::shared_ptr<Primitive>>& primitives)
 {
-    using namespace DirectX;
-    XMVECTOR vmin = XMVectorReplicate( FLT_MAX);
-    XMVECTOR vmax = XMVectorReplicate(-FLT_MAX);
-    bool any_seen = false;
+    std::vector<GeometryInfo> geometryInfo(primitives.size());
+    ThreadPool::Get().ParallelFor(primitives.size(), [&](size_t i)
+    {
+        const Primitive& primitive = *primitives[i];
+        geometryInfo[i].vertexOffset = primitive.GetVertexView().offset;
+        geometryInfo[i].indexOffset = primitive.GetIndexView().offset;
+    });
+    return geometryInfo;
+}
 
-    for (const auto& go : gameObjects)
+static InstanceInfo MakeInstanceInfo(const Primitive& primitive, const DirectX::XMFLOAT4X4& world)
+{
+    InstanceInfo info = {};
+    info.geometryId = primitive.m_geometryId;
+    info.textureId = -1;
+    info.normalTextureId = -1;
+    info.roughnessTextureId = -1;
+    info.metallicFactor = 1.0f;
+    info.roughnessFactor = 1.0f;
+    info.baseColorFactor = { 1.0f, 1.0f, 1.0f, 1.0f };
+
+    if (const Material* material = primitive.m_material.get())
     {
-        const auto model = go->GetModel();
-        if (!model) continue;
+        if (material->m_albedoTexture)
+            info.textureId = material->m_albedoTexture->GetTextureIndex();
 
-        const XMMATRIX world = go->GetWorldMatrix();
+        if (material->m_normalTexture)
+            info.normalTextureId = material->m_normalTexture->GetTextureIndex();
 
-        for (const auto& primitive : model->GetMeshes())
-        {
-            const XMFLOAT3 lmin = primitive->m_localAabbMin;
-            const XMFLOAT3 lmax = primitive->m_localAabbMax;
-            if (lmin.x > lmax.x) continue; // empty primitive
-
-            const XMFLOAT3 corners[8] = {
-                { lmin.x, lmin.y, lmin.z }, { lmax.x, lmin.y, lmin.z },
-                { lmin.x, lmax.y, lmin.z }, { lmax.x, lmax.y, lmin.z },
-                { lmin.x, lmin.y, lmax.z }, { lmax.x, lmin.y, lmax.z },
-                { lmin.x, lmax.y, lmax.z }, { lmax.x, lmax.y, lmax.z },
-            };
-            for (const XMFLOAT3& c : corners)
-            {
-                XMVECTOR p = XMVector3Transform(XMLoadFloat3(&c), world);
-                vmin = XMVectorMin(vmin, p);
-                vmax = XMVectorMax(vmax, p);
-                any_seen = true;
-            }
-        }
+        if (material->m_metallicRoughnessTexture)
+            info.roughnessTextureId = material->m_metallicRoughnessTexture->GetTextureIndex();
+
+        info.metallicFactor = material->m_data.metallicFactor;
+        info.roughnessFactor = material->m_data.roughnessFactor;
+        info.baseColorFactor = material->m_data.baseColorFactor;
     }
 
-    if (!any_seen)
+    // Explicit transpose into the DXR ObjectToWorld3x4 layout.
+    for (int r = 0; r < 3; ++r)
+        for (int c = 0; c < 4; ++c)
+            info.objectToWorld.m[r][c] = world.m[c][r];
+    return info;
+}
+
+// One entry per (game object, primitive) in the same order as the TLAS
+// instances (MeshUtils::BuildAccelerationStructures). A prefix sum over the
+// game objects' primitive counts gives every object its output range; the
+// same pass gathers world matrices and local bounds in that layout for the
+// world AABB.
+static std::vector<InstanceInfo> PackInstanceInfo(const std::vector<std::shared_ptr<GameObject>>& gameObjects,
+    std::vector<size_t>& offsets, std::vector<SceneBuildPasses::Matrix>& worlds, std::vector<SceneBuildPasses::Bounds>& localBounds)
+{
+    static_assert(sizeof(DirectX::XMFLOAT4X4) == sizeof(SceneBuildPasses::Matrix), "Both are row-major 4x4 floats");
+
+    std::vector<uint32_t> counts(gameObjects.size(), 0);
+    for (size_t i = 0; i < gameObjects.size(); ++i)
     {
-        outMin = { -1.0f, -1.0f, -1.0f };
-        outMax = {  1.0f,  1.0f,  1.0f };
-        return;
+        const auto& model = gameObjects[i]->GetModel();
+        counts[i] = model ? static_cast<uint32_t>(model->GetMeshes().size()) : 0;
     }
+    offsets = SceneBuildPasses::InstanceOffsets(counts);
 
-    XMStoreFloat3(&outMin, vmin);
-    XMStoreFloat3(&outMax, vmax);
+    std::vector<InstanceInfo> instanceInfo(offsets.back());
+    worlds.resize(gameObjects.size());
+    localBounds.assign(offsets.back(), SceneBuildPasses::Bounds{});
+    ThreadPool::Get().ParallelFor(gameObjects.size(), [&](size_t i)
+    {
+        const auto model = gameObjects[i]->GetModel();
+        if (!model)
+            return;
+        const DirectX::XMFLOAT4X4 world = gameObjects[i]->GetWorldFloat4X4();
+        std::memcpy(&worlds[i], &world, sizeof(world));
+        size_t out = offsets[i];
+        for (const auto& primitive : model->GetMeshes())
+        {
+            assert(primitive->m_geometryId != Primitive::INVALID_GEOMETRY_ID && "Primitive was never added to the scene through SceneBuilder::AddModel");
+            SceneBuildPasses::Bounds& bounds = localBounds[out];
+            std::memcpy(bounds.min, &primitive->m_localAabbMin, sizeof(bounds.min));
+            std::memcpy(bounds.max, &primitive->m_localAabbMax, sizeof(bounds.max));
+            instanceInfo[out++] = MakeInstanceInfo(*primitive, world);
+        }
+    });
+    return instanceInfo;
 }
 
 std::shared_ptr<Scene> SceneBuilder::Build(Renderer& renderer)
 {
     assert(!m_isBuilt && "Scene has already been built");
     m_isBuilt = true;
-    
-    UpdateMatricesInNodesRecursively(m_root);
 
-    auto all_prims = GetAllPrimitives();
-    
-    auto geo_info_buffer = CreateGeometryInfoBuffer(renderer, all_prims);
-    auto instance_info_buffer = CreateInstanceInfoBuffer(renderer, m_gameObjects, all_prims);
-    auto light_data_buffer = CreateLightDataBuffer(renderer, m_lightData);
+    auto stageStart = std::chrono::high_resolution_clock::now();
+    UpdateMatrices();
+    const double transformsMs = MillisecondsSince(stageStart);
+
+    stageStart = std::chrono::high_resolution_clock::now();
+    const std::vector<GeometryInfo> geometryInfo = PackGeometryInfo(m_primitives);
+    const double geometryInfoMs = MillisecondsSince(stageStart);
+
+    stageStart = std::chrono::high_resolution_clock::now();
+    std::vector<size_t> instanceOffsets;
+    std::vector<SceneBuildPasses::Matrix> worlds;
+    std::vector<SceneBuildPasses::Bounds> localBounds;
+    const std::vector<InstanceInfo> instanceInfo = PackInstanceInfo(m_gameObjects, instanceOffsets, worlds, localBounds);
+    const double instanceInfoMs = MillisecondsSince(stageStart);
 
     Scene scene;
+    stageStart = std::chrono::high_resolution_clock::now();
+    const SceneBuildPasses::Bounds worldBounds = SceneBuildPasses::ComputeWorldBounds(worlds, instanceOffsets, localBounds);
+    if (worldBounds.IsEmpty())
+    {
+        scene.m_aabbMin = { -1.0f, -1.0f, -1.0f };
+        scene.m_aabbMax = {  1.0f,  1.0f,  1.0f };
+    }
+    else
+    {
+        scene.m_aabbMin = { worldBounds.min[0], worldBounds.min[1], worldBounds.min[2] };
+        scene.m_aabbMax = { worldBounds.max[0], worldBounds.max[1], worldBounds.max[2] };
+    }
+    const double aabbMs = MillisecondsSince(stageStart);
+
+    stageStart = std::chrono::high_resolution_clock::now();
+    auto geo_info_buffer = renderer.CreateStructuredBuffer(geometryInfo);
+    auto instance_info_buffer = renderer.CreateStructuredBuffer(instanceInfo);
+    auto light_data_buffer = renderer.CreateStructuredBuffer(m_lightData);
+    const double uploadMs = MillisecondsSince(stageStart);
+
     scene.m_lightDataCPU = m_lightData;
-    ComputeWorldAabb(m_gameObjects, scene.m_aabbMin, scene.m_aabbMax);
     scene.m_gameObjects = std::move(m_gameObjects);
     scene.m_models = std::move(m_models);
     scene.m_root = std::move(m_root);
+    scene.m_transforms = std::move(m_transforms);
+    scene.m_transformNodes = std::move(m_transformNodes);
     scene.m_name = std::move(m_name);
     scene.m_rtRepresentation = std::move(m_rtRepresentation);
     scene.m_vertexBuffer = std::move(m_vertexBuffer);
@@ -217,33 +277,11 @@ std::shared_ptr<Scene> SceneBuilder::Build(Renderer& renderer)
     scene.m_instanceInfoBuffer = std::move(instance_info_buffer);
     scene.m_lightDataBuffer = std::move(light_data_buffer);
 
+    spdlog::info("Scene build: {} primitive(s), {} instance(s); transforms {:.2f} ms, geometry info {:.2f} ms, instance info {:.2f} ms, world AABB {:.2f} ms, buffer upload {:.2f} ms",
+        geometryInfo.size(), instanceInfo.size(), transformsMs, geometryInfoMs, instanceInfoMs, aabbMs, uploadMs);
     spdlog::info("Scene AABB: min=({:.3f},{:.3f},{:.3f}) max=({:.3f},{:.3f},{:.3f})",
         scene.m_aabbMin.x, scene.m_aabbMin.y, scene.m_aabbMin.z,
         scene.m_aabbMax.x, scene.m_aabbMax.y, scene.m_aabbMax.z);
 
     return std::make_shared<Scene>(std::move(scene));
 }
-
-void SceneBuilder::UpdateMatricesInNodesRecursively(const std::shared_ptr<SceneNode>& node)
-{
-    node->UpdateModelConstantBuffer();
-    for (const auto& child : node->GetChildren())
-    {
-        UpdateMatricesInNodesRecursively(child);
-    }
-}
-
-std::vector<std::shared_ptr<Primitive>> SceneBuilder::GetAllPrimitives() const
-{
-    std::vector<std::shared_ptr<Primitive>> primitives;
-
-    for (auto model : m_models)
-    {
-        for (auto primitive : model->GetMeshes())
-        {
-            primitives.emplace_back(primitive);
-        }
-    }
-
-    return primitives;
-}
@@ -0,0 +1,78 @@
+#include "SceneResources/SceneBuildPasses.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "Utils/ThreadPool.h"
+
+namespace SceneBuildPasses
+{
+namespace
+{
+    // Objects per ThreadPool task; one object is only a few boxes.
+    constexpr size_t kObjectGrain = 256;
+
+    void Merge(Bounds& into, const Bounds& other)
+    {
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            into.min[axis] = std::min(into.min[axis], other.min[axis]);
+            into.max[axis] = std::max(into.max[axis], other.max[axis]);
+        }
+    }
+
+    Bounds TransformBox(const Bounds& local, const Matrix& world)
+    {
+        float centre[3];
+        float extent[3];
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            centre[axis] = 0.5f * (local.min[axis] + local.max[axis]);
+            extent[axis] = 0.5f * (local.max[axis] - local.min[axis]);
+        }
+
+        Bounds out;
+        for (int c = 0; c < 3; ++c)
+        {
+            float worldCentre = world.m[3][c];
+            float worldExtent = 0.0f;
+            for (int r = 0; r < 3; ++r)
+            {
+                worldCentre += centre[r] * world.m[r][c];
+                worldExtent += extent[r] * std::fabs(world.m[r][c]);
+            }
+            out.min[c] = worldCentre - worldExtent;
+            out.max[c] = worldCentre + worldExtent;
+        }
+        return out;
+    }
+}
+
+std::vector<size_t> InstanceOffsets(const std::vector<uint32_t>& counts)
+{
+    std::vector<size_t> offsets(counts.size() + 1, 0);
+    for (size_t i = 0; i < counts.size(); ++i)
+        offsets[i + 1] = offsets[i] + counts[i];
+    return offsets;
+}
+
+Bounds ComputeWorldBounds(const std::vector<Matrix>& worlds, const std::vector<size_t>& offsets, const std::vector<Bounds>& localBounds)
+{
+    const size_t objectCount = worlds.size();
+    const size_t taskCount = (objectCount + kObjectGrain - 1) / kObjectGrain;
+    std::vector<Bounds> partial(taskCount);
+    ThreadPool::Get().ParallelForRange(objectCount, kObjectGrain, [&](size_t begin, size_t end)
+    {
+        Bounds& bounds = partial[begin / kObjectGrain];
+        for (size_t object = begin; object < end; ++object)
+            for (size_t box = offsets[object]; box < offsets[object + 1]; ++box)
+                if (!localBounds[box].IsEmpty())
+                    Merge(bounds, TransformBox(localBounds[box], worlds[object]));
+    });
+
+    Bounds bounds;
+    for (const Bounds& part : partial)
+        Merge(bounds, part);
+    return bounds;
+}
+}
@@ -0,0 +1,254 @@
+#include "SceneResources/SceneBvh.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <numeric>
+
+#include "Utils/ThreadPool.h"
+
+namespace
+{
+    constexpr size_t kRayGrain = 256;
+
+    // Binds an instance to SceneBvh's filter for one TriangleBvh query.
+    struct InstanceFilter
+    {
+        SceneBvh::HitFilter filter;
+        const void* context;
+        uint32_t instance;
+
+        static bool Accept(const void* self, uint32_t primitive, float u, float v)
+        {
+            const auto* bound = static_cast<const InstanceFilter*>(self);
+            return bound->filter(bound->context, bound->instance, primitive, u, v);
+        }
+    };
+
+    double MillisecondsSince(std::chrono::high_resolution_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    }
+
+    void TransformPoint(const float m[3][4], const float p[3], float out[3])
+    {
+        for (int r = 0; r < 3; ++r)
+            out[r] = m[r][0] * p[0] + m[r][1] * p[1] + m[r][2] * p[2] + m[r][3];
+    }
+
+    void TransformVector(const float m[3][4], const float v[3], float out[3])
+    {
+        for (int r = 0; r < 3; ++r)
+            out[r] = m[r][0] * v[0] + m[r][1] * v[1] + m[r][2] * v[2];
+    }
+
+    // Inverse of an affine 3x4; false when the linear part is singular.
+    bool InvertAffine(const float m[3][4], float out[3][4])
+    {
+        const double a = m[0][0], b = m[0][1], c = m[0][2];
+        const double d = m[1][0], e = m[1][1], f = m[1][2];
+        const double g = m[2][0], h = m[2][1], i = m[2][2];
+        const double det = a * (e * i - f * h) - b * (d * i - f * g) + c * (d * h - e * g);
+        if (!std::isfinite(det) || det == 0.0)
+            return false;
+
+        const double inv = 1.0 / det;
+        const double linear[3][3] = {
+            { (e * i - f * h) * inv, (c * h - b * i) * inv, (b * f - c * e) * inv },
+            { (f * g - d * i) * inv, (a * i - c * g) * inv, (c * d - a * f) * inv },
+            { (d * h - e * g) * inv, (b * g - a * h) * inv, (a * e - b * d) * inv },
+        };
+        for (int r = 0; r < 3; ++r)
+        {
+            for (int col = 0; col < 3; ++col)
+                out[r][col] = static_cast<float>(linear[r][col]);
+            out[r][3] = static_cast<float>(-(linear[r][0] * m[0][3] + linear[r][1] * m[1][3] + linear[r][2] * m[2][3]));
+        }
+        return true;
+    }
+}
+
+void SceneBvh::Build(const SceneBvhInput& input, const BvhBuildSettings& settings)
+{
+    const auto start = std::chrono::high_resolution_clock::now();
+    m_settings = settings;
+    m_geometries.assign(input.geometryCount, TriangleBvh());
+
+    const auto meshOf = [&](size_t geometry)
+    {
+        const BvhGeometry& range = input.geometries[geometry];
+        BvhMesh mesh;
+        mesh.positions = reinterpret_cast<const float*>(reinterpret_cast<const uint8_t*>(input.positions) + static_cast<size_t>(range.vertexOffset) * input.positionStride);
+        mesh.positionStride = input.positionStride;
+        mesh.indices = input.indices + range.indexOffset;
+        mesh.triangleCount = range.indexCount / 3;
+        return mesh;
+    };
+
+    // Large geometries one after another, each on the whole pool; the rest
+    // one geometry per task (nested pool calls would run inline anyway).
+    std::vector<uint32_t> large;
+    std::vector<uint32_t> small;
+    for (uint32_t g = 0; g < input.geometryCount; ++g)
+        (input.geometries[g].indexCount / 3 > settings.parallelThreshold ? large : small).push_back(g);
+    std::sort(small.begin(), small.end(), [&](uint32_t a, uint32_t b)
+    {
+        return input.geometries[a].indexCount > input.geometries[b].indexCount;
+    });
+
+    for (uint32_t g : large)
+        m_geometries[g].Build(meshOf(g), settings);
+    ThreadPool::Get().ParallelFor(small.size(), [&](size_t i)
+    {
+        m_geometries[small[i]].Build(meshOf(small[i]), settings);
+    });
+
+    m_stats = {};
+    m_stats.geometryCount = input.geometryCount;
+    for (const TriangleBvh& geometry : m_geometries)
+    {
+        m_stats.triangleCount += geometry.GetTriangleCount();
+        m_stats.geometryNodes += geometry.GetNodes().size();
+    }
+    m_stats.geometryMilliseconds = MillisecondsSince(start);
+
+    SetInstances(input.instances, input.instanceCount);
+}
+
+void SceneBvh::SetInstances(const BvhInstance* instances, size_t count)
+{
+    const auto start = std::chrono::high_resolution_clock::now();
+
+    // World bounds of each instance: its geometry's root box, corners transformed.
+    std::vector<Instance> candidates;
+    std::vector<BvhAabb> bounds;
+    candidates.reserve(count);
+    bounds.reserve(count);
+    size_t instancedTriangles = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        const BvhInstance& instance = instances[i];
+        if (instance.geometry >= m_geometries.size())
+            continue;
+        const BvhAabb local = m_geometries[instance.geometry].GetBounds();
+        Instance placed;
+        if (local.IsEmpty() || !InvertAffine(instance.objectToWorld, placed.worldToObject))
+            continue;
+
+        BvhAabb world;
+        for (int corner = 0; corner < 8; ++corner)
+        {
+            const float p[3] = { (corner & 1) ? local.max[0] : local.min[0], (corner & 2) ? local.max[1] : local.min[1], (corner & 4) ? local.max[2] : local.min[2] };
+            float transformed[3];
+            TransformPoint(instance.objectToWorld, p, transformed);
+            world.Grow(transformed);
+        }
+        placed.geometry = instance.geometry;
+        placed.index = static_cast<uint32_t>(i);
+        placed.opaque = instance.opaque;
+        candidates.push_back(placed);
+        bounds.push_back(world);
+        instancedTriangles += m_geometries[instance.geometry].GetTriangleCount();
+    }
+
+    // Instances rarely share a leaf usefully: their boxes overlap far more than triangles do.
+    BvhBuildSettings settings = m_settings;
+    settings.maxLeafSize = 1;
+    std::vector<uint32_t> order;
+    m_instanceNodes = BvhBuilder::Build(bounds.data(), bounds.size(), order, settings);
+    m_instances.resize(order.size());
+    for (size_t i = 0; i < order.size(); ++i)
+        m_instances[i] = candidates[order[i]];
+
+    m_stats.instanceCount = m_instances.size();
+    m_stats.instancedTriangles = instancedTriangles;
+    m_stats.instanceNodes = m_instanceNodes.size();
+    m_stats.instanceMilliseconds = MillisecondsSince(start);
+}
+
+void SceneBvh::SetHitFilter(HitFilter filter, const void* context)
+{
+    m_hitFilter = filter;
+    m_hitFilterContext = context;
+}
+
+template <bool AnyHit>
+bool SceneBvh::Traverse(const BvhRay& ray, BvhHit& hit) const
+{
+    bool found = false;
+    TraverseBvh(m_instanceNodes, ray, AnyHit ? ray.tMax : std::min(ray.tMax, hit.t), [&](const BvhNode& leaf, float& tMax)
+    {
+        for (uint32_t i = leaf.first; i < leaf.first + leaf.count; ++i)
+        {
+            const Instance& instance = m_instances[i];
+
+            // Unnormalised object-space direction: t means the same in both spaces.
+            BvhRay local;
+            TransformPoint(instance.worldToObject, ray.origin, local.origin);
+            TransformVector(instance.worldToObject, ray.direction, local.direction);
+            local.tMin = ray.tMin;
+            local.tMax = tMax;
+
+            const InstanceFilter bound{ m_hitFilter, m_hitFilterContext, instance.index };
+            BvhHitFilter filter;
+            if (!instance.opaque && m_hitFilter)
+            {
+                filter.accept = &InstanceFilter::Accept;
+                filter.context = &bound;
+            }
+
+            const TriangleBvh& geometry = m_geometries[instance.geometry];
+            if (AnyHit)
+            {
+                if (geometry.Occluded(local, &filter))
+                {
+                    found = true;
+                    return true;
+                }
+                continue;
+            }
+            if (geometry.Intersect(local, hit, &filter))
+            {
+                hit.instance = instance.index;
+                tMax = hit.t;
+                found = true;
+            }
+        }
+        return false;
+    });
+    return found;
+}
+
+bool SceneBvh::Intersect(const BvhRay& ray, BvhHit& hit) const
+{
+    return Traverse<false>(ray, hit);
+}
+
+bool SceneBvh::Occluded(const BvhRay& ray) const
+{
+    BvhHit hit;
+    return Traverse<true>(ray, hit);
+}
+
+void SceneBvh::IntersectBatch(const BvhRay* rays, BvhHit* hits, size_t count) const
+{
+    ThreadPool::Get().ParallelForRange(count, kRayGrain, [&](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; ++i)
+        {
+            hits[i] = BvhHit();
+            Intersect(rays[i], hits[i]);
+        }
+    });
+}
+
+BvhAabb SceneBvh::GetBounds() const
+{
+    BvhAabb bounds;
+    if (!m_instanceNodes.empty())
+    {
+        std::copy(m_instanceNodes[0].min, m_instanceNodes[0].min + 3, bounds.min);
+        std::copy(m_instanceNodes[0].max, m_instanceNodes[0].max + 3, bounds.max);
+    }
+    return bounds;
+}
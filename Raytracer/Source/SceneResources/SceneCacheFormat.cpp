@@ -0,0 +1,267 @@
+#include "SceneResources/SceneCacheFormat.h"
+
+#include <cstdio>
+#include <cstring>
+#include <system_error>
+
+namespace SceneCacheFormat
+{
+namespace
+{
+    size_t AlignUp(size_t value, size_t alignment)
+    {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+
+    struct PendingSection
+    {
+        SectionId id;
+        uint32_t elementSize;
+        const void* data;
+        size_t size;
+    };
+
+    template <typename T>
+    PendingSection MakeSection(SectionId id, const std::vector<T>& values)
+    {
+        return { id, static_cast<uint32_t>(sizeof(T)), values.data(), values.size() * sizeof(T) };
+    }
+
+    template <typename T>
+    bool ResolveSection(const uint8_t* base, size_t fileSize, const SectionEntry& entry, ArrayView<T>& out)
+    {
+        if (entry.elementSize != sizeof(T) || entry.size % sizeof(T) != 0)
+            return false;
+        if (entry.offset % alignof(T) != 0 || entry.offset > fileSize || entry.size > fileSize - entry.offset)
+            return false;
+        out.data = reinterpret_cast<const T*>(base + entry.offset);
+        out.count = static_cast<size_t>(entry.size / sizeof(T));
+        return true;
+    }
+
+    bool StringInRange(const ArrayView<char>& strings, uint32_t offset, uint32_t length)
+    {
+        return static_cast<size_t>(offset) <= strings.count && length <= strings.count - offset;
+    }
+}
+
+bool Write(const std::filesystem::path& path, const BakeInput& input)
+{
+    // String blob: name first, then dependency paths.
+    std::vector<char> strings(input.name.begin(), input.name.end());
+    std::vector<DependencyRecord> dependencies;
+    dependencies.reserve(input.dependencies.size());
+    for (const BakeInput::Dependency& dependency : input.dependencies)
+    {
+        DependencyRecord record{};
+        record.contentHash = dependency.contentHash;
+        record.pathOffset = static_cast<uint32_t>(strings.size());
+        record.pathLength = static_cast<uint32_t>(dependency.path.size());
+        strings.insert(strings.end(), dependency.path.begin(), dependency.path.end());
+        dependencies.push_back(record);
+    }
+
+    std::vector<TextureRecord> textures;
+    std::vector<uint8_t> texels;
+    textures.reserve(input.textures.size());
+    for (const BakeInput::Texture& texture : input.textures)
+    {
+        if (texture.rgba.size() != static_cast<size_t>(texture.width) * texture.height * 4)
+            return false;
+        textures.push_back({ texture.width, texture.height, static_cast<uint64_t>(texels.size()) });
+        texels.insert(texels.end(), texture.rgba.begin(), texture.rgba.end());
+    }
+
+    const PendingSection sections[] = {
+        { SectionId::Vertices, input.vertexStride, input.vertices, input.vertexCount * input.vertexStride },
+        { SectionId::Indices, static_cast<uint32_t>(sizeof(uint32_t)), input.indices, input.indexCount * sizeof(uint32_t) },
+        MakeSection(SectionId::Primitives, input.primitives),
+        MakeSection(SectionId::Models, input.models),
+        MakeSection(SectionId::Materials, input.materials),
+        MakeSection(SectionId::Nodes, input.nodes),
+        MakeSection(SectionId::Lights, input.lights),
+        MakeSection(SectionId::Textures, textures),
+        MakeSection(SectionId::TexelData, texels),
+        MakeSection(SectionId::Dependencies, dependencies),
+        MakeSection(SectionId::Strings, strings),
+    };
+    constexpr size_t sectionCount = sizeof(sections) / sizeof(sections[0]);
+
+    FileHeader header{};
+    header.magic = MAGIC;
+    header.version = VERSION;
+    header.sourceHash = input.sourceHash;
+    header.vertexStride = input.vertexStride;
+    header.sectionCount = static_cast<uint32_t>(sectionCount);
+    header.nameOffset = 0;
+    header.nameLength = static_cast<uint32_t>(input.name.size());
+    header.pipelineVersion = input.pipelineVersion;
+    header.importFlags = input.importFlags;
+
+    SectionEntry entries[sectionCount] = {};
+    size_t cursor = AlignUp(sizeof(FileHeader) + sizeof(entries), SECTION_ALIGNMENT);
+    for (size_t i = 0; i < sectionCount; ++i)
+    {
+        entries[i].id = static_cast<uint32_t>(sections[i].id);
+        entries[i].elementSize = sections[i].elementSize;
+        entries[i].offset = cursor;
+        entries[i].size = sections[i].size;
+        cursor = AlignUp(cursor + sections[i].size, SECTION_ALIGNMENT);
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(path.parent_path(), ec);
+
+    std::filesystem::path temporary = path;
+    temporary += ".tmp";
+    FILE* file = nullptr;
+#ifdef _WIN32
+    if (_wfopen_s(&file, temporary.c_str(), L"wb") != 0)
+        file = nullptr;
+#else
+    file = std::fopen(temporary.c_str(), "wb");
+#endif
+    if (!file)
+        return false;
+
+    static const uint8_t padding[SECTION_ALIGNMENT] = {};
+    size_t written = 0;
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+              std::fwrite(entries, sizeof(entries), 1, file) == 1;
+    written = sizeof(header) + sizeof(entries);
+    for (size_t i = 0; ok && i < sectionCount; ++i)
+    {
+        const size_t pad = static_cast<size_t>(entries[i].offset) - written;
+        ok = pad == 0 || std::fwrite(padding, 1, pad, file) == pad;
+        if (ok && sections[i].size > 0)
+            ok = std::fwrite(sections[i].data, 1, sections[i].size, file) == sections[i].size;
+        written = static_cast<size_t>(entries[i].offset) + sections[i].size;
+    }
+    ok = std::fclose(file) == 0 && ok;
+
+    if (!ok)
+    {
+        std::filesystem::remove(temporary, ec);
+        return false;
+    }
+
+    std::filesystem::rename(temporary, path, ec);
+    if (ec)
+    {
+        std::filesystem::remove(temporary, ec);
+        return false;
+    }
+    return true;
+}
+
+bool Reader::Open(const std::filesystem::path& path, uint32_t expectedVertexStride)
+{
+    Close();
+    if (!m_file.Open(path))
+        return false;
+    if (!Validate(expectedVertexStride))
+    {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+void Reader::Close()
+{
+    m_file.Close();
+    *this = Reader();
+}
+
+bool Reader::Validate(uint32_t expectedVertexStride)
+{
+    const uint8_t* base = m_file.Data();
+    const size_t size = m_file.Size();
+    if (size < sizeof(FileHeader))
+        return false;
+
+    std::memcpy(&m_header, base, sizeof(FileHeader));
+    if (m_header.magic != MAGIC || m_header.version != VERSION || m_header.vertexStride != expectedVertexStride)
+        return false;
+    if (m_header.sectionCount > (size - sizeof(FileHeader)) / sizeof(SectionEntry))
+        return false;
+
+    const auto* entries = reinterpret_cast<const SectionEntry*>(base + sizeof(FileHeader));
+    for (uint32_t i = 0; i < m_header.sectionCount; ++i)
+    {
+        const SectionEntry& entry = entries[i];
+        bool ok = true;
+        switch (static_cast<SectionId>(entry.id))
+        {
+        case SectionId::Vertices:
+            ok = entry.elementSize == m_header.vertexStride && entry.offset <= size && entry.size <= size - entry.offset &&
+                 entry.size % m_header.vertexStride == 0;
+            m_vertices = { base + entry.offset, static_cast<size_t>(entry.size) };
+            break;
+        case SectionId::Indices:      ok = ResolveSection(base, size, entry, m_indices); break;
+        case SectionId::Primitives:   ok = ResolveSection(base, size, entry, m_primitives); break;
+        case SectionId::Models:       ok = ResolveSection(base, size, entry, m_models); break;
+        case SectionId::Materials:    ok = ResolveSection(base, size, entry, m_materials); break;
+        case SectionId::Nodes:        ok = ResolveSection(base, size, entry, m_nodes); break;
+        case SectionId::Lights:       ok = ResolveSection(base, size, entry, m_lights); break;
+        case SectionId::Textures:     ok = ResolveSection(base, size, entry, m_textures); break;
+        case SectionId::TexelData:    ok = ResolveSection(base, size, entry, m_texelData); break;
+        case SectionId::Dependencies: ok = ResolveSection(base, size, entry, m_dependencies); break;
+        case SectionId::Strings:      ok = ResolveSection(base, size, entry, m_strings); break;
+        default: break; // unknown sections are skipped
+        }
+        if (!ok)
+            return false;
+    }
+
+    // Cross references, so consumers can index without re-checking.
+    const size_t vertexCount = GetVertexCount();
+    for (const PrimitiveRecord& primitive : m_primitives)
+    {
+        if (primitive.vertexOffset > vertexCount || primitive.vertexCount > vertexCount - primitive.vertexOffset)
+            return false;
+        if (primitive.indexOffset > m_indices.count || primitive.indexCount > m_indices.count - primitive.indexOffset)
+            return false;
+        if (primitive.materialIndex < -1 || primitive.materialIndex >= static_cast<int32_t>(m_materials.count))
+            return false;
+        for (uint64_t i = primitive.indexOffset; i < primitive.indexOffset + primitive.indexCount; ++i)
+            if (m_indices[static_cast<size_t>(i)] >= primitive.vertexCount)
+                return false;
+    }
+    for (const ModelRecord& model : m_models)
+        if (model.firstPrimitive > m_primitives.count || model.primitiveCount > m_primitives.count - model.firstPrimitive)
+            return false;
+    for (const MaterialRecord& material : m_materials)
+        for (int32_t texture : { material.albedoTexture, material.normalTexture, material.metallicRoughnessTexture })
+            if (texture < -1 || texture >= static_cast<int32_t>(m_textures.count))
+                return false;
+    for (size_t i = 0; i < m_nodes.count; ++i)
+    {
+        const NodeRecord& node = m_nodes[i];
+        if ((i == 0) != (node.parent == -1) || node.parent >= static_cast<int32_t>(i))
+            return false;
+        if (node.modelIndex < -1 || node.modelIndex >= static_cast<int32_t>(m_models.count))
+            return false;
+    }
+    for (const TextureRecord& texture : m_textures)
+    {
+        const uint64_t bytes = static_cast<uint64_t>(texture.width) * texture.height * 4;
+        if (texture.texelOffset > m_texelData.count || bytes > m_texelData.count - texture.texelOffset)
+            return false;
+    }
+    for (const DependencyRecord& dependency : m_dependencies)
+        if (!StringInRange(m_strings, dependency.pathOffset, dependency.pathLength))
+            return false;
+    return StringInRange(m_strings, m_header.nameOffset, m_header.nameLength);
+}
+
+std::string Reader::GetName() const
+{
+    return std::string(m_strings.data + m_header.nameOffset, m_header.nameLength);
+}
+
+std::string Reader::GetDependencyPath(const DependencyRecord& dependency) const
+{
+    return std::string(m_strings.data + dependency.pathOffset, dependency.pathLength);
+}
+}
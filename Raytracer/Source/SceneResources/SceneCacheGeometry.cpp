@@ -0,0 +1,69 @@
+#include "SceneResources/SceneCacheGeometry.h"
+
+#include "SceneResources/TransformHierarchy.h"
+
+void SceneCacheGeometry::Load(const SceneCacheFormat::Reader& cache)
+{
+    const auto primitives = cache.GetPrimitives();
+    geometries.clear();
+    geometries.reserve(primitives.size());
+    for (const SceneCacheFormat::PrimitiveRecord& primitive : primitives)
+        geometries.push_back({ static_cast<uint32_t>(primitive.vertexOffset), static_cast<uint32_t>(primitive.indexOffset), static_cast<uint32_t>(primitive.indexCount) });
+
+    // Node worlds as SceneNode computes them; InstanceInfo stores their transpose.
+    const auto nodes = cache.GetNodes();
+    TransformHierarchy hierarchy;
+    hierarchy.Reserve(nodes.size());
+    for (const SceneCacheFormat::NodeRecord& node : nodes)
+        hierarchy.Add(node.parent >= 0 ? static_cast<uint32_t>(node.parent) : TransformHierarchy::NO_PARENT, node.position, node.rotation, node.scale);
+    hierarchy.Update();
+
+    const auto models = cache.GetModels();
+    instances.clear();
+    bounds = BvhAabb();
+    for (size_t n = 0; n < nodes.size(); ++n)
+    {
+        if (nodes[n].modelIndex < 0)
+            continue;
+        const TransformHierarchy::Matrix& world = hierarchy.GetWorld(static_cast<uint32_t>(n));
+        const SceneCacheFormat::ModelRecord& model = models[nodes[n].modelIndex];
+        for (uint32_t p = model.firstPrimitive; p < model.firstPrimitive + model.primitiveCount; ++p)
+        {
+            BvhInstance instance;
+            instance.geometry = p;
+            for (int r = 0; r < 3; ++r)
+                for (int c = 0; c < 4; ++c)
+                    instance.objectToWorld[r][c] = world.m[c][r];
+            instances.push_back(instance);
+
+            const SceneCacheFormat::PrimitiveRecord& primitive = primitives[p];
+            if (primitive.aabbMin[0] > primitive.aabbMax[0])
+                continue; // empty primitive
+            for (int corner = 0; corner < 8; ++corner)
+            {
+                const float local[3] = {
+                    (corner & 1) ? primitive.aabbMax[0] : primitive.aabbMin[0],
+                    (corner & 2) ? primitive.aabbMax[1] : primitive.aabbMin[1],
+                    (corner & 4) ? primitive.aabbMax[2] : primitive.aabbMin[2],
+                };
+                float point[3];
+                for (int r = 0; r < 3; ++r)
+                    point[r] = local[0] * world.m[0][r] + local[1] * world.m[1][r] + local[2] * world.m[2][r] + world.m[3][r];
+                bounds.Grow(point);
+            }
+        }
+    }
+}
+
+SceneBvhInput SceneCacheGeometry::MakeInput(const SceneCacheFormat::Reader& cache) const
+{
+    SceneBvhInput input;
+    input.positions = static_cast<const float*>(cache.GetVertexData());
+    input.positionStride = cache.GetVertexStride();
+    input.indices = cache.GetIndices().data;
+    input.geometries = geometries.data();
+    input.geometryCount = geometries.size();
+    input.instances = instances.data();
+    input.instanceCount = instances.size();
+    return input;
+}
@@ -0,0 +1,463 @@
+#include "pch.h"
+#include "SceneResources/SceneCaching.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <spdlog/spdlog.h>
+
+#include "AccelerationStructures.h"
+#include "InputElements.h"
+#include "Renderer.h"
+#include "ResourceManager/ResourceManagerTypes.h"
+#include "Resources/Buffer.h"
+#include "Resources/IndexBuffer.h"
+#include "Resources/VertexBuffer.h"
+#include "SceneResources/GameObject.h"
+#include "SceneResources/LightData.h"
+#include "SceneResources/Material.h"
+#include "SceneResources/MeshProcessing.h"
+#include "SceneResources/Model.h"
+#include "SceneResources/Primitive.h"
+#include "SceneResources/Scene.h"
+#include "SceneResources/SceneNode.h"
+#include "Utils/ContentHash.h"
+#include "Utils/ThreadPool.h"
+
+static AutoCVarInt g_sceneCacheEnabled("scene.cache.enabled", "Load scenes from / bake them into SavedUserData/SceneCache", 1, CVarFlags::EditCheckbox);
+
+namespace
+{
+    constexpr const char* kCacheDir = "SavedUserData/SceneCache";
+
+    double MillisecondsSince(std::chrono::high_resolution_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    }
+
+    // A file that cannot be read hashes to 0, so "was missing at bake time and
+    // still is" counts as unchanged.
+    uint64_t HashOrZero(const std::filesystem::path& path)
+    {
+        uint64_t hash = 0;
+        return ContentHash::HashFile(path, hash) ? hash : 0;
+    }
+
+    SceneCacheFormat::MaterialRecord MakeMaterialRecord(const Material& material, const std::unordered_map<const Texture*, int32_t>& textureIndices)
+    {
+        auto textureIndex = [&](const std::shared_ptr<Texture>& texture) -> int32_t
+        {
+            if (!texture)
+                return -1;
+            const auto it = textureIndices.find(texture.get());
+            if (it == textureIndices.end())
+            {
+                spdlog::warn("Scene cache: material texture was not recorded; baked without it");
+                return -1;
+            }
+            return it->second;
+        };
+
+        SceneCacheFormat::MaterialRecord record{};
+        record.baseColorFactor[0] = material.m_data.baseColorFactor.x;
+        record.baseColorFactor[1] = material.m_data.baseColorFactor.y;
+        record.baseColorFactor[2] = material.m_data.baseColorFactor.z;
+        record.baseColorFactor[3] = material.m_data.baseColorFactor.w;
+        record.metallicFactor = material.m_data.metallicFactor;
+        record.roughnessFactor = material.m_data.roughnessFactor;
+        record.albedoTexture = textureIndex(material.m_albedoTexture);
+        record.normalTexture = textureIndex(material.m_normalTexture);
+        record.metallicRoughnessTexture = textureIndex(material.m_metallicRoughnessTexture);
+        record.isOpaque = material.m_data.isOpaque ? 1u : 0u;
+        return record;
+    }
+
+    SceneCacheFormat::NodeRecord MakeNodeRecord(const SceneNode& node, int32_t parent, int32_t modelIndex)
+    {
+        const Transform& transform = node.GetTransform();
+        SceneCacheFormat::NodeRecord record{};
+        record.parent = parent;
+        record.modelIndex = modelIndex;
+        record.position[0] = transform.position.x;
+        record.position[1] = transform.position.y;
+        record.position[2] = transform.position.z;
+        record.rotation[0] = transform.rotation.x;
+        record.rotation[1] = transform.rotation.y;
+        record.rotation[2] = transform.rotation.z;
+        record.rotation[3] = transform.rotation.w;
+        record.scale[0] = transform.scale.x;
+        record.scale[1] = transform.scale.y;
+        record.scale[2] = transform.scale.z;
+        return record;
+    }
+
+    void ApplyNodeRecord(SceneNode& node, const SceneCacheFormat::NodeRecord& record)
+    {
+        node.SetPosition({ record.position[0], record.position[1], record.position[2] });
+        node.SetRotation(DirectX::SimpleMath::Quaternion(record.rotation[0], record.rotation[1], record.rotation[2], record.rotation[3]));
+        node.SetScale({ record.scale[0], record.scale[1], record.scale[2] });
+    }
+}
+
+bool SceneCaching::IsEnabled()
+{
+    return g_sceneCacheEnabled.Get() != 0;
+}
+
+uint32_t SceneCaching::GetImportFlags()
+{
+    return MeshUtils::IsDeduplicationEnabled() ? IMPORT_DEDUPLICATE : 0u;
+}
+
+std::filesystem::path SceneCaching::GetCachePath(const AssetId& assetId, uint64_t sourceHash)
+{
+    char hash[17];
+    std::snprintf(hash, sizeof(hash), "%016llx", static_cast<unsigned long long>(sourceHash));
+    return std::filesystem::path(kCacheDir) / (assetId.AsPath().stem().string() + "-" + hash + ".bsc");
+}
+
+std::shared_ptr<Scene> SceneCaching::TryLoad(Renderer& renderer, const AssetId& assetId, uint64_t sourceHash)
+{
+    const auto start = std::chrono::high_resolution_clock::now();
+    const std::filesystem::path cachePath = GetCachePath(assetId, sourceHash);
+
+    std::error_code ec;
+    if (!std::filesystem::exists(cachePath, ec))
+        return nullptr;
+
+    SceneCacheFormat::Reader reader;
+    if (!reader.Open(cachePath, sizeof(Vertex)) || reader.GetSourceHash() != sourceHash || reader.GetNodes().empty())
+    {
+        spdlog::warn("Scene cache: ignoring unreadable or outdated '{}'", cachePath.string());
+        return nullptr;
+    }
+    if (reader.GetPipelineVersion() != IMPORT_PIPELINE_VERSION)
+    {
+        spdlog::info("Scene cache: '{}' was baked by import pipeline {} (current {}); rebuilding",
+            cachePath.string(), reader.GetPipelineVersion(), IMPORT_PIPELINE_VERSION);
+        return nullptr;
+    }
+    if (reader.GetImportFlags() != GetImportFlags())
+    {
+        spdlog::info("Scene cache: '{}' was baked with other import settings (flags {:#x}, current {:#x}); rebuilding",
+            cachePath.string(), reader.GetImportFlags(), GetImportFlags());
+        return nullptr;
+    }
+
+    const std::filesystem::path sourceDir = assetId.AsPath().parent_path();
+    const auto dependencies = reader.GetDependencies();
+    std::vector<uint8_t> changed(dependencies.size(), 0);
+    ThreadPool::Get().ParallelFor(dependencies.size(), [&](size_t i)
+    {
+        const std::filesystem::path path = sourceDir / std::filesystem::u8path(reader.GetDependencyPath(dependencies[i]));
+        changed[i] = HashOrZero(path) != dependencies[i].contentHash;
+    });
+    for (size_t i = 0; i < dependencies.size(); ++i)
+    {
+        if (changed[i])
+        {
+            spdlog::info("Scene cache: '{}' changed since '{}' was baked", reader.GetDependencyPath(dependencies[i]), cachePath.string());
+            return nullptr;
+        }
+    }
+
+    SceneBuilder sceneBuilder;
+    sceneBuilder.SetName(assetId.AsString());
+
+    // Usage follows the first material slot that references each texture, as in the importers.
+    const auto textureRecords = reader.GetTextures();
+    std::vector<TextureProcessing::TextureUsage> usages(textureRecords.size(), TextureProcessing::TextureUsage::Generic);
+    std::vector<uint8_t> usageKnown(textureRecords.size(), 0);
+    auto noteUsage = [&](int32_t index, TextureProcessing::TextureUsage usage)
+    {
+        if (index >= 0 && static_cast<size_t>(index) < usages.size() && !usageKnown[index])
+        {
+            usages[index] = usage;
+            usageKnown[index] = 1;
+        }
+    };
+    for (const SceneCacheFormat::MaterialRecord& record : reader.GetMaterials())
+    {
+        noteUsage(record.albedoTexture, TextureProcessing::TextureUsage::Albedo);
+        noteUsage(record.normalTexture, TextureProcessing::TextureUsage::Normal);
+        noteUsage(record.metallicRoughnessTexture, TextureProcessing::TextureUsage::MetallicRoughness);
+    }
+
+    std::vector<std::shared_ptr<Texture>> textures;
+    textures.reserve(textureRecords.size());
+    renderer.BeginTextureUploads();
+    for (size_t i = 0; i < textureRecords.size(); ++i)
+    {
+        const SceneCacheFormat::TextureRecord& record = textureRecords[i];
+        textures.push_back(renderer.CreateTexture(reader.GetTexels(record), static_cast<int>(record.width), static_cast<int>(record.height), 4, usages[i]));
+    }
+    renderer.EndTextureUploads();
+
+    auto textureAt = [&](int32_t index) { return index >= 0 ? textures[index] : std::shared_ptr<Texture>(); };
+
+    std::vector<std::shared_ptr<Material>> materials;
+    materials.reserve(reader.GetMaterials().size());
+    for (const SceneCacheFormat::MaterialRecord& record : reader.GetMaterials())
+    {
+        auto material = std::make_shared<Material>();
+        material->m_data.baseColorFactor = { record.baseColorFactor[0], record.baseColorFactor[1], record.baseColorFactor[2], record.baseColorFactor[3] };
+        material->m_data.metallicFactor = record.metallicFactor;
+        material->m_data.roughnessFactor = record.roughnessFactor;
+        material->m_data.isOpaque = record.isOpaque != 0;
+        material->m_albedoTexture = textureAt(record.albedoTexture);
+        material->m_normalTexture = textureAt(record.normalTexture);
+        material->m_metallicRoughnessTexture = textureAt(record.metallicRoughnessTexture);
+        material->UpdateMaterial();
+        materials.push_back(material);
+    }
+
+    const auto indices = reader.GetIndices();
+    auto vertexIndexPair = renderer.CreateSceneResources(
+        static_cast<const Vertex*>(reader.GetVertexData()), reader.GetVertexCount(), indices.data, indices.count);
+    const auto vertexBuffer = std::static_pointer_cast<Buffer>(vertexIndexPair.first);
+    const auto indexBuffer = std::static_pointer_cast<Buffer>(vertexIndexPair.second);
+    sceneBuilder.SetVertexBuffer(vertexIndexPair.first);
+    sceneBuilder.SetIndexBuffer(vertexIndexPair.second);
+
+    const auto primitives = reader.GetPrimitives();
+    std::vector<std::shared_ptr<Model>> models;
+    models.reserve(reader.GetModels().size());
+    for (const SceneCacheFormat::ModelRecord& record : reader.GetModels())
+    {
+        auto model = std::make_shared<Model>();
+        for (uint32_t i = record.firstPrimitive; i < record.firstPrimitive + record.primitiveCount; ++i)
+        {
+            const SceneCacheFormat::PrimitiveRecord& source = primitives[i];
+
+            BufferView vertexView{};
+            vertexView.buffer = vertexBuffer;
+            vertexView.count = source.vertexCount;
+            vertexView.offset = source.vertexOffset;
+            vertexView.offsetBytes = source.vertexOffset * sizeof(Vertex);
+            vertexView.size = source.vertexCount * sizeof(Vertex);
+
+            BufferView indexView{};
+            indexView.buffer = indexBuffer;
+            indexView.count = source.indexCount;
+            indexView.offset = source.indexOffset;
+            indexView.offsetBytes = source.indexOffset * sizeof(uint32_t);
+            indexView.size = source.indexCount * sizeof(uint32_t);
+
+            auto primitive = std::make_shared<Primitive>(vertexView, indexView, source.materialIndex >= 0 ? materials[source.materialIndex] : std::shared_ptr<Material>());
+            primitive->m_localAabbMin = { source.aabbMin[0], source.aabbMin[1], source.aabbMin[2] };
+            primitive->m_localAabbMax = { source.aabbMax[0], source.aabbMax[1], source.aabbMax[2] };
+            model->AddMesh(primitive);
+        }
+        sceneBuilder.AddModel(model);
+        models.push_back(model);
+    }
+
+    // Pre-order, so parents exist before their children and game objects are
+    // added in the same order the importer added them.
+    const auto nodeRecords = reader.GetNodes();
+    std::vector<std::shared_ptr<SceneNode>> nodes(nodeRecords.size());
+    nodes[0] = sceneBuilder.GetRoot();
+    ApplyNodeRecord(*nodes[0], nodeRecords[0]);
+    for (size_t i = 1; i < nodeRecords.size(); ++i)
+    {
+        const SceneCacheFormat::NodeRecord& record = nodeRecords[i];
+        auto node = std::make_shared<SceneNode>();
+        if (record.modelIndex >= 0)
+        {
+            auto gameObject = renderer.InstantiateGameObject();
+            sceneBuilder.AddGameObject(gameObject, models[record.modelIndex]);
+            node->AddGameObject(gameObject);
+        }
+        ApplyNodeRecord(*node, record);
+        sceneBuilder.AddChild(nodes[record.parent], node);
+        nodes[i] = node;
+    }
+
+    for (const SceneCacheFormat::LightRecord& record : reader.GetLights())
+    {
+        LightData light;
+        light.type = static_cast<LightType>(record.type);
+        light.position = { record.position[0], record.position[1], record.position[2] };
+        light.direction = { record.direction[0], record.direction[1], record.direction[2] };
+        light.color = { record.color[0], record.color[1], record.color[2] };
+        light.intensity = record.intensity;
+        light.range = record.range;
+        sceneBuilder.AddLightData(light);
+    }
+
+    sceneBuilder.UpdateMatrices();
+    sceneBuilder.SetAccelerationStructures(MeshUtils::BuildAccelerationStructures(renderer, sceneBuilder));
+
+    spdlog::info("Scene cache: loaded '{}' ({:.1f} MB, {} primitive(s), {} texture(s)) in {:.1f} ms",
+        cachePath.string(), static_cast<double>(reader.GetFileSize()) / (1024.0 * 1024.0),
+        primitives.size(), textures.size(), MillisecondsSince(start));
+
+    return sceneBuilder.Build(renderer);
+}
+
+SceneCaching::Recorder::Recorder(const AssetId& assetId, uint64_t sourceHash) :
+    m_cachePath(GetCachePath(assetId, sourceHash)),
+    m_sourceDir(assetId.AsPath().parent_path()),
+    m_name(assetId.AsString()),
+    m_sourceHash(sourceHash),
+    m_importFlags(GetImportFlags())
+{
+}
+
+void SceneCaching::Recorder::AddDependency(const std::filesystem::path& path)
+{
+    m_dependencies.push_back(path);
+}
+
+void SceneCaching::Recorder::AddTexture(const std::shared_ptr<Texture>& texture, const uint8_t* pixels, int width, int height, int components)
+{
+    if (!texture || m_textureIndices.count(texture.get()) != 0)
+        return;
+    if (components != 3 && components != 4)
+    {
+        spdlog::warn("Scene cache: {}-component texture not recorded", components);
+        return;
+    }
+
+    SceneCacheFormat::BakeInput::Texture record;
+    record.width = static_cast<uint32_t>(width);
+    record.height = static_cast<uint32_t>(height);
+    record.rgba.resize(static_cast<size_t>(width) * height * 4);
+    if (components == 4)
+    {
+        std::memcpy(record.rgba.data(), pixels, record.rgba.size());
+    }
+    else
+    {
+        for (size_t i = 0, count = static_cast<size_t>(width) * height; i < count; ++i)
+        {
+            record.rgba[i * 4 + 0] = pixels[i * 3 + 0];
+            record.rgba[i * 4 + 1] = pixels[i * 3 + 1];
+            record.rgba[i * 4 + 2] = pixels[i * 3 + 2];
+            record.rgba[i * 4 + 3] = 255;
+        }
+    }
+
+    m_textureIndices[texture.get()] = static_cast<int32_t>(m_textures.size());
+    m_textures.push_back(std::move(record));
+}
+
+void SceneCaching::Recorder::Write(const SceneBuilder& sceneBuilder, const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices)
+{
+    const auto start = std::chrono::high_resolution_clock::now();
+
+    SceneCacheFormat::BakeInput input;
+    input.sourceHash = m_sourceHash;
+    input.pipelineVersion = IMPORT_PIPELINE_VERSION;
+    input.importFlags = m_importFlags;
+    input.name = m_name;
+    input.vertexStride = sizeof(Vertex);
+    input.vertices = vertices.data();
+    input.vertexCount = vertices.size();
+    input.indices = indices.data();
+    input.indexCount = indices.size();
+
+    std::unordered_map<const Model*, int32_t> modelIndices;
+    std::unordered_map<const Material*, int32_t> materialIndices;
+    for (const std::shared_ptr<Model>& model : sceneBuilder.GetModels())
+    {
+        SceneCacheFormat::ModelRecord modelRecord{};
+        modelRecord.firstPrimitive = static_cast<uint32_t>(input.primitives.size());
+        modelRecord.primitiveCount = static_cast<uint32_t>(model->GetMeshes().size());
+
+        for (const std::shared_ptr<Primitive>& primitive : model->GetMeshes())
+        {
+            SceneCacheFormat::PrimitiveRecord record{};
+            record.vertexOffset = primitive->m_vertexBufferOffset.offset;
+            record.vertexCount = primitive->m_vertexBufferOffset.count;
+            record.indexOffset = primitive->m_indexBufferOffset.offset;
+            record.indexCount = primitive->m_indexBufferOffset.count;
+            record.aabbMin[0] = primitive->m_localAabbMin.x;
+            record.aabbMin[1] = primitive->m_localAabbMin.y;
+            record.aabbMin[2] = primitive->m_localAabbMin.z;
+            record.aabbMax[0] = primitive->m_localAabbMax.x;
+            record.aabbMax[1] = primitive->m_localAabbMax.y;
+            record.aabbMax[2] = primitive->m_localAabbMax.z;
+            record.materialIndex = -1;
+
+            if (const Material* material = primitive->m_material.get())
+            {
+                auto [it, inserted] = materialIndices.try_emplace(material, static_cast<int32_t>(input.materials.size()));
+                if (inserted)
+                    input.materials.push_back(MakeMaterialRecord(*material, m_textureIndices));
+                record.materialIndex = it->second;
+            }
+            input.primitives.push_back(record);
+        }
+
+        modelIndices[model.get()] = static_cast<int32_t>(input.models.size());
+        input.models.push_back(modelRecord);
+    }
+
+    // Iterative pre-order walk; children pushed in reverse to keep their order.
+    std::vector<std::pair<const SceneNode*, int32_t>> stack = { { sceneBuilder.GetRoot().get(), -1 } };
+    while (!stack.empty())
+    {
+        const auto [node, parent] = stack.back();
+        stack.pop_back();
+
+        int32_t modelIndex = -1;
+        if (const std::shared_ptr<GameObject> gameObject = node->GetGameObject())
+        {
+            const auto it = modelIndices.find(gameObject->GetModel().get());
+            if (it == modelIndices.end())
+            {
+                spdlog::warn("Scene cache: game object model is not part of the scene; '{}' not baked", m_name);
+                return;
+            }
+            modelIndex = it->second;
+        }
+
+        const int32_t index = static_cast<int32_t>(input.nodes.size());
+        input.nodes.push_back(MakeNodeRecord(*node, parent, modelIndex));
+
+        const auto& children = node->GetChildren();
+        for (auto child = children.rbegin(); child != children.rend(); ++child)
+            stack.emplace_back(child->get(), index);
+    }
+
+    for (const LightData& light : sceneBuilder.GetLightData())
+    {
+        SceneCacheFormat::LightRecord record{};
+        record.type = static_cast<uint32_t>(light.type);
+        record.position[0] = light.position.x;
+        record.position[1] = light.position.y;
+        record.position[2] = light.position.z;
+        record.direction[0] = light.direction.x;
+        record.direction[1] = light.direction.y;
+        record.direction[2] = light.direction.z;
+        record.color[0] = light.color.x;
+        record.color[1] = light.color.y;
+        record.color[2] = light.color.z;
+        record.intensity = light.intensity;
+        record.range = light.range;
+        input.lights.push_back(record);
+    }
+
+    input.dependencies.resize(m_dependencies.size());
+    ThreadPool::Get().ParallelFor(m_dependencies.size(), [&](size_t i)
+    {
+        input.dependencies[i].path = m_dependencies[i].lexically_relative(m_sourceDir).generic_u8string();
+        input.dependencies[i].contentHash = HashOrZero(m_dependencies[i]);
+    });
+
+    input.textures = std::move(m_textures);
+    m_textureIndices.clear();
+
+    if (!SceneCacheFormat::Write(m_cachePath, input))
+    {
+        spdlog::warn("Scene cache: failed to write '{}'", m_cachePath.string());
+        return;
+    }
+
+    std::error_code ec;
+    const auto size = std::filesystem::file_size(m_cachePath, ec);
+    spdlog::info("Scene cache: baked '{}' ({:.1f} MB, {} dependencies) in {:.1f} ms",
+        m_cachePath.string(), ec ? 0.0 : static_cast<double>(size) / (1024.0 * 1024.0),
+        input.dependencies.size(), MillisecondsSince(start));
+}
@@ -19,47 +19,31 @@ void SceneNode::AddGameObject(const std::shared_ptr<GameObject> & gameObject)
 void SceneNode::SetPosition(const DirectX::SimpleMath::Vector3& position)
 {
     m_transform.position = position;
-    UpdateModelConstantBuffer();
+    if (m_hierarchy)
+        m_hierarchy->SetPosition(m_transformIndex, &m_transform.position.x);
 }
 
 void SceneNode::SetRotation(const DirectX::SimpleMath::Quaternion& rotation)
 {
     m_transform.rotation = rotation;
-    UpdateModelConstantBuffer();
+    if (m_hierarchy)
+        m_hierarchy->SetRotation(m_transformIndex, &m_transform.rotation.x);
 }
 
 void SceneNode::SetRotation(const DirectX::SimpleMath::Vector3& rotation)
 {
-    m_transform.rotation = DirectX::SimpleMath::Quaternion::CreateFromYawPitchRoll(rotation.y, rotation.x, rotation.z);
-    UpdateModelConstantBuffer();
+    SetRotation(DirectX::SimpleMath::Quaternion::CreateFromYawPitchRoll(rotation.y, rotation.x, rotation.z));
 }
 
 void SceneNode::SetScale(const DirectX::SimpleMath::Vector3& scale)
 {
     m_transform.scale = scale;
-    UpdateModelConstantBuffer();
+    if (m_hierarchy)
+        m_hierarchy->SetScale(m_transformIndex, &m_transform.scale.x);
 }
 
 SceneNode::SceneNode(const std::shared_ptr<SceneNode>& parent, const Transform& transform) :
     m_parent(parent),
     m_transform(transform)
 {
-    UpdateModelConstantBuffer();
-}
-
-void SceneNode::UpdateModelConstantBuffer() const
-{
-    if (!m_gameObject) return;
-
-    const DirectX::XMFLOAT4X4 model_matrix = TraverseParentMatrices();
-    m_gameObject->UpdateWorldMatrix(model_matrix);
-}
-
-DirectX::SimpleMath::Matrix SceneNode::TraverseParentMatrices() const
-{
-    if (m_parent)
-    {
-        return m_transform.GetMatrix() * m_parent->TraverseParentMatrices();
-    }
-    return m_transform.GetMatrix();
 }
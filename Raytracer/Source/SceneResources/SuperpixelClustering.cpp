@@ -0,0 +1,614 @@
+#include "SceneResources/SuperpixelClustering.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+#include "SceneResources/VertexPacking.h"
+#include "Utils/ThreadPool.h"
+
+namespace
+{
+    constexpr size_t kRowGrain = 8;
+    constexpr float kInvalidPosition = 1e29f;   // SP_INVALID_POS
+    constexpr float kGatedDistance = 1000000.0f; // ComputeSlicDistance's facing-away distance
+    constexpr float kNearestDistance = 999999.0f;
+    constexpr float kFacingCos = 0.01f;
+    constexpr float kPi = 3.14159265358979f;
+
+    using Clock = std::chrono::high_resolution_clock;
+
+    double MillisecondsSince(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    const float* Texel(const SuperpixelInput& input, uint32_t x, uint32_t y)
+    {
+        const size_t pitch = input.rowPitch != 0 ? input.rowPitch : size_t(input.width) * 4 * sizeof(float);
+        return reinterpret_cast<const float*>(reinterpret_cast<const uint8_t*>(input.texels) + y * pitch) + size_t(x) * 4;
+    }
+
+    bool IsValid(const float* texel)
+    {
+        return texel[0] < kInvalidPosition;
+    }
+
+    void DecodeNormal(float bits, float outN[3])
+    {
+        uint32_t packed;
+        std::memcpy(&packed, &bits, sizeof(packed));
+        VertexPacking::DecodeOctahedron(packed, outN);
+    }
+
+    float EncodeNormal(const float n[3])
+    {
+        const uint32_t packed = VertexPacking::EncodeOctahedron(n);
+        float bits;
+        std::memcpy(&bits, &packed, sizeof(bits));
+        return bits;
+    }
+
+    float Dot3(const float a[3], const float b[3])
+    {
+        return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+    }
+
+    // SpixelImageCenter: the tile middle, pulled inward at the image edge.
+    void TileMiddle(uint32_t sx, uint32_t sy, uint32_t size, uint32_t width, uint32_t height, uint32_t& outX, uint32_t& outY)
+    {
+        outX = sx * size + size / 2;
+        outY = sy * size + size / 2;
+        outX = outX >= width ? (sx * size + width) / 2 : outX;
+        outY = outY >= height ? (sy * size + height) / 2 : outY;
+    }
+
+    // A centre as FindCenterAssociation stages it in groupshared memory.
+    struct CenterView
+    {
+        float position[3];
+        float normal[3];
+        float xy[2];
+    };
+
+    // FuzzyNearest: the four smallest distances seen; a fifth displaces the
+    // current maximum if it is closer.
+    struct FuzzyNearest
+    {
+        int32_t centers[4];
+        float dist2[4];
+        int32_t count = 0;
+
+        void Insert(int32_t center, float d2)
+        {
+            if (count < 4)
+            {
+                centers[count] = center;
+                dist2[count] = d2;
+                ++count;
+                return;
+            }
+            int32_t maxIdx = 0;
+            for (int32_t i = 1; i < 4; ++i)
+            {
+                if (dist2[i] > dist2[maxIdx])
+                    maxIdx = i;
+            }
+            if (d2 < dist2[maxIdx])
+            {
+                centers[maxIdx] = center;
+                dist2[maxIdx] = d2;
+            }
+        }
+
+        // WriteFuzzy: normalized inverse squared distances; an exact match
+        // takes all of the weight.
+        void Write(float* outWeights, int32_t* outCenters) const
+        {
+            float w[4] = {};
+            for (int32_t i = 0; i < 4; ++i)
+                outCenters[i] = i < count ? centers[i] : -1;
+            if (count > 0)
+            {
+                int32_t zeroIdx = -1;
+                for (int32_t i = 0; i < count; ++i)
+                {
+                    if (dist2[i] == 0.0f)
+                        zeroIdx = i;
+                    else
+                        w[i] = 1.0f / dist2[i];
+                }
+                if (zeroIdx != -1)
+                {
+                    std::fill(w, w + 4, 0.0f);
+                    w[zeroIdx] = 1.0f;
+                }
+                const float sum = w[0] + w[1] + w[2] + w[3];
+                for (float& weight : w)
+                    weight /= sum;
+            }
+            std::copy(w, w + 4, outWeights);
+        }
+    };
+
+    struct Context
+    {
+        const SuperpixelInput& input;
+        const SuperpixelSettings& settings;
+        Superpixels& result;
+        float maxXyDist;
+        std::vector<CenterView> views;
+    };
+
+    void StageCenters(Context& context)
+    {
+        const Superpixels& result = context.result;
+        context.views.resize(size_t(result.mapX) * result.mapY);
+        for (size_t id = 0; id < context.views.size(); ++id)
+        {
+            CenterView& view = context.views[id];
+            std::copy(&result.centers[id * 4], &result.centers[id * 4] + 3, view.position);
+            DecodeNormal(result.centers[id * 4 + 3], view.normal);
+            view.xy[0] = result.centerPixels[id * 2];
+            view.xy[1] = result.centerPixels[id * 2 + 1];
+        }
+    }
+
+    // FindCenterAssociation over the 3x3 tiles around each pixel's own.
+    // writeGather's fuzzy outputs and counts only come from the final pass.
+    void Associate(Context& context, bool final)
+    {
+        StageCenters(context);
+        const SuperpixelInput& input = context.input;
+        const SuperpixelSettings& settings = context.settings;
+        Superpixels& result = context.result;
+        std::vector<uint32_t> rowInvalid(final ? input.height : 0);
+        std::vector<uint32_t> rowFallback(final ? input.height : 0);
+        const CenterView* views = context.views.data();
+        const uint32_t mapX = result.mapX;
+
+        ThreadPool::Get().ParallelForRange(input.height, kRowGrain, [&](size_t begin, size_t end)
+        {
+            for (uint32_t y = static_cast<uint32_t>(begin); y < end; ++y)
+            {
+                // The candidate tiles, clipped to the map, in the shader's order.
+                const uint32_t ctrY = y / settings.size;
+                const uint32_t cy0 = ctrY > 0 ? ctrY - 1 : 0;
+                const uint32_t cy1 = std::min(result.mapY - 1, ctrY + 1);
+                int32_t* index = &result.index[size_t(y) * input.width];
+                for (uint32_t x = 0; x < input.width; ++x)
+                {
+                    const size_t pixel = size_t(y) * input.width + x;
+                    const float* texel = Texel(input, x, y);
+                    const bool valid = IsValid(texel);
+                    const uint32_t ctrX = x / settings.size;
+                    const uint32_t cx0 = ctrX > 0 ? ctrX - 1 : 0;
+                    const uint32_t cx1 = std::min(mapX - 1, ctrX + 1);
+                    float pixN[3] = {};
+                    if (valid)
+                        DecodeNormal(texel[3], pixN);
+                    const float pixXy[2] = { static_cast<float>(x), static_cast<float>(y) };
+
+                    int32_t minIdx = -1;
+                    int32_t minIdxF = -1;
+                    float dist = kNearestDistance;
+                    float distF = kNearestDistance;
+                    FuzzyNearest fuzzy;
+                    FuzzyNearest fuzzyFallback;
+
+                    for (uint32_t cy = cy0; valid && cy <= cy1; ++cy)
+                    {
+                        for (uint32_t cx = cx0; cx <= cx1; ++cx)
+                        {
+                            const int32_t spId = static_cast<int32_t>(cy * mapX + cx);
+                            const CenterView& center = views[spId];
+
+                            // ComputeSlicDistance.
+                            const float dotN = Dot3(pixN, center.normal);
+                            const float dCol[3] = { texel[0] - center.position[0], texel[1] - center.position[1], texel[2] - center.position[2] };
+                            const float dcolor = Dot3(dCol, dCol);
+                            const float dX = pixXy[0] - center.xy[0];
+                            const float dY = pixXy[1] - center.xy[1];
+                            const float dxy = dX * dX + dY * dY;
+                            const float ungated = dcolor * settings.posNormalizer + settings.weight * dxy * context.maxXyDist;
+                            const float gated = dotN > kFacingCos ? ungated : kGatedDistance;
+
+                            if (gated < dist)
+                            {
+                                dist = gated;
+                                minIdx = spId;
+                            }
+                            if (ungated < distF)
+                            {
+                                distF = ungated;
+                                minIdxF = spId;
+                            }
+                            if (final)
+                            {
+                                fuzzy.Insert(spId, gated);
+                                fuzzyFallback.Insert(spId, ungated);
+                            }
+                        }
+                    }
+
+                    const bool gateValid = minIdx >= 0;
+                    index[x] = valid ? (gateValid ? minIdx : minIdxF) : -1;
+                    if (!final)
+                        continue;
+
+                    if (!gateValid || !valid)
+                        fuzzy = fuzzyFallback;
+                    if (!valid)
+                        fuzzy.count = 0;
+                    fuzzy.Write(&result.fuzzyWeights[pixel * 4], &result.fuzzyIndices[pixel * 4]);
+                    rowInvalid[y] += valid ? 0u : 1u;
+                    rowFallback[y] += valid && !gateValid ? 1u : 0u;
+                }
+            }
+        });
+
+        for (uint32_t y = 0; final && y < input.height; ++y)
+        {
+            result.stats.invalidPixels += rowInvalid[y];
+            result.stats.fallbackPixels += rowFallback[y];
+        }
+    }
+
+    // fn(x, y, pixel) for every pixel of the 3x3 tiles around tile (sx, sy),
+    // in scan order.
+    template <typename Fn>
+    void ForNeighbourhood(const SuperpixelInput& input, uint32_t size, uint32_t sx, uint32_t sy, Fn&& fn)
+    {
+        const uint32_t x0 = sx > 0 ? (sx - 1) * size : 0;
+        const uint32_t y0 = sy > 0 ? (sy - 1) * size : 0;
+        const uint32_t x1 = std::min(input.width, (sx + 2) * size);
+        const uint32_t y1 = std::min(input.height, (sy + 2) * size);
+        for (uint32_t y = y0; y < y1; ++y)
+        {
+            for (uint32_t x = x0; x < x1; ++x)
+                fn(x, y, size_t(y) * input.width + x);
+        }
+    }
+
+    // SumCenter, or its SLIC counterpart over the centre's members. Sums are
+    // in double (the shader reduces in float), and a centre without pixels or
+    // with cancelling normals keeps its previous value.
+    void UpdateCenters(Context& context)
+    {
+        const SuperpixelInput& input = context.input;
+        const uint32_t size = context.settings.size;
+        const bool members = context.settings.update == SuperpixelCenterUpdate::Members;
+        Superpixels& result = context.result;
+
+        ThreadPool::Get().ParallelFor(size_t(result.mapX) * result.mapY, [&](size_t id)
+        {
+            const uint32_t sx = static_cast<uint32_t>(id % result.mapX);
+            const uint32_t sy = static_cast<uint32_t>(id / result.mapX);
+            double position[3] = {};
+            double normal[3] = {};
+            double xy[2] = {};
+            uint32_t count = 0;
+            auto add = [&](uint32_t x, uint32_t y)
+            {
+                const float* texel = Texel(input, x, y);
+                float n[3];
+                DecodeNormal(texel[3], n);
+                for (int axis = 0; axis < 3; ++axis)
+                {
+                    position[axis] += texel[axis];
+                    normal[axis] += n[axis];
+                }
+                xy[0] += x;
+                xy[1] += y;
+                ++count;
+            };
+
+            if (members)
+            {
+                ForNeighbourhood(input, size, sx, sy, [&](uint32_t x, uint32_t y, size_t pixel)
+                {
+                    if (result.index[pixel] == static_cast<int32_t>(id))
+                        add(x, y);
+                });
+            }
+            else
+            {
+                const uint32_t x1 = std::min(input.width, (sx + 1) * size);
+                const uint32_t y1 = std::min(input.height, (sy + 1) * size);
+                for (uint32_t y = sy * size; y < y1; ++y)
+                {
+                    for (uint32_t x = sx * size; x < x1; ++x)
+                    {
+                        if (IsValid(Texel(input, x, y)))
+                            add(x, y);
+                    }
+                }
+            }
+
+            const double length2 = normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2];
+            if (count == 0 || length2 <= 1e-12)
+                return;
+            const double length = std::sqrt(length2);
+            const float n[3] = { static_cast<float>(normal[0] / length), static_cast<float>(normal[1] / length), static_cast<float>(normal[2] / length) };
+            float* center = &result.centers[id * 4];
+            for (int axis = 0; axis < 3; ++axis)
+                center[axis] = static_cast<float>(position[axis] / count);
+            center[3] = EncodeNormal(n);
+            if (members)
+            {
+                result.centerPixels[id * 2] = static_cast<float>(xy[0] / count);
+                result.centerPixels[id * 2 + 1] = static_cast<float>(xy[1] / count);
+            }
+        });
+    }
+
+    // The final association's counters and pixel lists.
+    void Gather(Context& context)
+    {
+        const SuperpixelInput& input = context.input;
+        const uint32_t size = context.settings.size;
+        const uint32_t capacity = size * size;
+        Superpixels& result = context.result;
+        const size_t gatheredWidth = size_t(result.mapX) * size;
+        std::vector<uint32_t> overflow(size_t(result.mapX) * result.mapY, 0);
+
+        ThreadPool::Get().ParallelFor(overflow.size(), [&](size_t id)
+        {
+            const uint32_t sx = static_cast<uint32_t>(id % result.mapX);
+            const uint32_t sy = static_cast<uint32_t>(id / result.mapX);
+            uint32_t count = 0;
+            ForNeighbourhood(input, size, sx, sy, [&](uint32_t x, uint32_t y, size_t pixel)
+            {
+                if (result.index[pixel] != static_cast<int32_t>(id))
+                    return;
+                if (count < capacity)
+                {
+                    const size_t slot = (size_t(sy) * size + count / size) * gatheredWidth + size_t(sx) * size + count % size;
+                    result.gathered[slot * 2] = static_cast<int32_t>(x);
+                    result.gathered[slot * 2 + 1] = static_cast<int32_t>(y);
+                }
+                ++count;
+            });
+            result.counters[id] = count;
+            overflow[id] = count > capacity ? count - capacity : 0;
+        });
+
+        for (uint32_t dropped : overflow)
+            result.stats.overflowPixels += dropped;
+    }
+}
+
+Superpixels SuperpixelClustering::Build(const SuperpixelInput& input, const SuperpixelSettings& settings)
+{
+    Superpixels result;
+    if (!input.texels || input.width == 0 || input.height == 0 || settings.size == 0)
+        return result;
+
+    const size_t pixelCount = size_t(input.width) * input.height;
+    result.size = settings.size;
+    result.mapX = (input.width + settings.size - 1) / settings.size;
+    result.mapY = (input.height + settings.size - 1) / settings.size;
+    const size_t superpixelCount = size_t(result.mapX) * result.mapY;
+    result.centers.resize(superpixelCount * 4);
+    result.centerPixels.resize(superpixelCount * 2);
+    result.index.resize(pixelCount);
+    result.fuzzyWeights.resize(pixelCount * 4);
+    result.fuzzyIndices.resize(pixelCount * 4);
+    result.counters.resize(superpixelCount);
+    result.gathered.assign(superpixelCount * settings.size * settings.size * 2, -1);
+
+    // The pass's squared screen-xy normalizer: (1 / (1.4242 * spixel_size))^2.
+    const float xyNorm = 1.0f / (1.4242f * static_cast<float>(settings.size));
+    Context context{ input, settings, result, xyNorm * xyNorm, {} };
+
+    // InitSeedCenters.
+    auto start = Clock::now();
+    for (uint32_t sy = 0; sy < result.mapY; ++sy)
+    {
+        for (uint32_t sx = 0; sx < result.mapX; ++sx)
+        {
+            const size_t id = size_t(sy) * result.mapX + sx;
+            uint32_t x, y;
+            TileMiddle(sx, sy, settings.size, input.width, input.height, x, y);
+            std::copy(Texel(input, x, y), Texel(input, x, y) + 4, &result.centers[id * 4]);
+            result.centerPixels[id * 2] = static_cast<float>(x);
+            result.centerPixels[id * 2 + 1] = static_cast<float>(y);
+        }
+    }
+    result.stats.seedMilliseconds = MillisecondsSince(start);
+
+    for (uint32_t iteration = 0; iteration < settings.iterations; ++iteration)
+    {
+        start = Clock::now();
+        Associate(context, false);
+        result.stats.associateMilliseconds += MillisecondsSince(start);
+
+        start = Clock::now();
+        UpdateCenters(context);
+        result.stats.updateMilliseconds += MillisecondsSince(start);
+    }
+
+    start = Clock::now();
+    Associate(context, true);
+    result.stats.associateMilliseconds += MillisecondsSince(start);
+
+    start = Clock::now();
+    Gather(context);
+    result.stats.gatherMilliseconds = MillisecondsSince(start);
+    return result;
+}
+
+SuperpixelQuality SuperpixelClustering::MeasureQuality(const SuperpixelInput& input, const Superpixels& superpixels,
+    const SuperpixelQualitySettings& settings)
+{
+    SuperpixelQuality quality;
+    const uint32_t width = input.width;
+    const uint32_t height = input.height;
+    if (!input.texels || superpixels.index.size() != size_t(width) * height || width == 0 || height == 0)
+        return quality;
+
+    ThreadPool& pool = ThreadPool::Get();
+    const size_t pixelCount = size_t(width) * height;
+    std::vector<float> normals(pixelCount * 3);
+    pool.ParallelForRange(height, kRowGrain, [&](size_t begin, size_t end)
+    {
+        for (uint32_t y = static_cast<uint32_t>(begin); y < end; ++y)
+        {
+            for (uint32_t x = 0; x < width; ++x)
+                DecodeNormal(Texel(input, x, y)[3], &normals[(size_t(y) * width + x) * 3]);
+        }
+    });
+
+    auto valid = [&](int64_t x, int64_t y)
+    {
+        return x >= 0 && y >= 0 && x < width && y < height && IsValid(Texel(input, static_cast<uint32_t>(x), static_cast<uint32_t>(y)));
+    };
+    auto distance2 = [&](int64_t x0, int64_t y0, int64_t x1, int64_t y1)
+    {
+        const float* a = Texel(input, static_cast<uint32_t>(x0), static_cast<uint32_t>(y0));
+        const float* b = Texel(input, static_cast<uint32_t>(x1), static_cast<uint32_t>(y1));
+        const float d[3] = { a[0] - b[0], a[1] - b[1], a[2] - b[2] };
+        return Dot3(d, d);
+    };
+    // The step from p to its (dx, dy) neighbour q against the steps just
+    // before p and just after q. Edges against pixels without a hit are left
+    // out: those pixels belong to no superpixel, so they would be recalled by
+    // construction.
+    const float ratio2 = settings.depthRatio * settings.depthRatio;
+    auto isEdge = [&](int64_t x, int64_t y, int64_t dx, int64_t dy)
+    {
+        if (!valid(x, y) || !valid(x + dx, y + dy))
+            return false;
+        const size_t p = size_t(y) * width + size_t(x);
+        const size_t q = size_t(y + dy) * width + size_t(x + dx);
+        if (Dot3(&normals[p * 3], &normals[q * 3]) < settings.normalCos)
+            return true;
+        const float step = distance2(x, y, x + dx, y + dy);
+        float reference = -1.0f;
+        if (valid(x - dx, y - dy))
+            reference = distance2(x - dx, y - dy, x, y);
+        if (valid(x + 2 * dx, y + 2 * dy))
+        {
+            const float after = distance2(x + dx, y + dy, x + 2 * dx, y + 2 * dy);
+            reference = reference < 0.0f ? after : std::min(reference, after);
+        }
+        return reference >= 0.0f && step > 0.0f && step > ratio2 * reference;
+    };
+
+    // Edge pixels, superpixel boundaries, and the boundaries dilated by the
+    // tolerance (separably: rows, then columns).
+    const std::vector<int32_t>& index = superpixels.index;
+    std::vector<uint8_t> edge(pixelCount);
+    std::vector<uint8_t> boundary(pixelCount);
+    std::vector<uint8_t> dilatedRows(pixelCount);
+    pool.ParallelForRange(height, kRowGrain, [&](size_t begin, size_t end)
+    {
+        for (uint32_t y = static_cast<uint32_t>(begin); y < end; ++y)
+        {
+            for (uint32_t x = 0; x < width; ++x)
+            {
+                const size_t p = size_t(y) * width + x;
+                edge[p] = isEdge(x, y, 1, 0) || isEdge(x, y, 0, 1);
+                boundary[p] = (x + 1 < width && index[p] != index[p + 1]) || (y + 1 < height && index[p] != index[p + width]);
+            }
+            for (uint32_t x = 0; x < width; ++x)
+            {
+                const uint32_t x0 = x > settings.tolerance ? x - settings.tolerance : 0;
+                const uint32_t x1 = std::min(width - 1, x + settings.tolerance);
+                uint8_t any = 0;
+                for (uint32_t i = x0; i <= x1 && !any; ++i)
+                    any = boundary[size_t(y) * width + i];
+                dilatedRows[size_t(y) * width + x] = any;
+            }
+        }
+    });
+
+    std::vector<uint32_t> rowEdges(height);
+    std::vector<uint32_t> rowRecalled(height);
+    pool.ParallelForRange(height, kRowGrain, [&](size_t begin, size_t end)
+    {
+        for (uint32_t y = static_cast<uint32_t>(begin); y < end; ++y)
+        {
+            const uint32_t y0 = y > settings.tolerance ? y - settings.tolerance : 0;
+            const uint32_t y1 = std::min(height - 1, y + settings.tolerance);
+            for (uint32_t x = 0; x < width; ++x)
+            {
+                if (!edge[size_t(y) * width + x])
+                    continue;
+                ++rowEdges[y];
+                for (uint32_t i = y0; i <= y1; ++i)
+                {
+                    if (dilatedRows[size_t(i) * width + x])
+                    {
+                        ++rowRecalled[y];
+                        break;
+                    }
+                }
+            }
+        }
+    });
+
+    uint64_t recalled = 0;
+    for (uint32_t y = 0; y < height; ++y)
+    {
+        quality.edgePixels += rowEdges[y];
+        recalled += rowRecalled[y];
+    }
+    quality.boundaryRecall = quality.edgePixels > 0 ? static_cast<double>(recalled) / quality.edgePixels : 1.0;
+
+    // Area and perimeter (pixel sides against another label or the image
+    // border) of every superpixel, from the 3x3 tiles its members lie in.
+    const size_t superpixelCount = size_t(superpixels.mapX) * superpixels.mapY;
+    std::vector<uint64_t> area(superpixelCount);
+    std::vector<uint64_t> perimeter(superpixelCount);
+    pool.ParallelFor(superpixelCount, [&](size_t id)
+    {
+        const int32_t label = static_cast<int32_t>(id);
+        const uint32_t sx = static_cast<uint32_t>(id % superpixels.mapX);
+        const uint32_t sy = static_cast<uint32_t>(id / superpixels.mapX);
+        ForNeighbourhood(input, superpixels.size, sx, sy, [&](uint32_t x, uint32_t y, size_t pixel)
+        {
+            if (index[pixel] != label)
+                return;
+            ++area[id];
+            perimeter[id] += (x == 0 || index[pixel - 1] != label) + (x + 1 == width || index[pixel + 1] != label) +
+                (y == 0 || index[pixel - width] != label) + (y + 1 == height || index[pixel + width] != label);
+        });
+    });
+
+    uint64_t covered = 0;
+    double weighted = 0.0;
+    for (size_t id = 0; id < superpixelCount; ++id)
+    {
+        if (area[id] == 0)
+            continue;
+        ++quality.segments;
+        covered += area[id];
+        const double a = static_cast<double>(area[id]);
+        const double p = static_cast<double>(perimeter[id]);
+        weighted += a * 4.0 * kPi * a / (p * p);
+    }
+    quality.compactness = covered > 0 ? weighted / static_cast<double>(covered) : 0.0;
+    return quality;
+}
+
+std::vector<SuperpixelMeasurement> SuperpixelClustering::MeasureIterations(const SuperpixelInput& input, const SuperpixelSettings& settings,
+    uint32_t maxIterations, const SuperpixelQualitySettings& qualitySettings)
+{
+    std::vector<SuperpixelMeasurement> measurements;
+    for (uint32_t iterations = 0; iterations <= maxIterations; ++iterations)
+    {
+        SuperpixelSettings iterationSettings = settings;
+        iterationSettings.iterations = iterations;
+        SuperpixelMeasurement measurement;
+        measurement.iterations = iterations;
+        const auto start = Clock::now();
+        const Superpixels superpixels = Build(input, iterationSettings);
+        measurement.milliseconds = MillisecondsSince(start);
+        measurement.fallbackPixels = superpixels.stats.fallbackPixels;
+        measurement.quality = MeasureQuality(input, superpixels, qualitySettings);
+        measurements.push_back(measurement);
+    }
+    return measurements;
+}
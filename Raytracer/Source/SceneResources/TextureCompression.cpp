@@ -0,0 +1,131 @@
+#include "pch.h"
+#include "SceneResources/TextureCompression.h"
+
+#include <chrono>
+#include <cstdio>
+#include <spdlog/spdlog.h>
+
+#include "Utils/ContentHash.h"
+#include "Utils/MappedFile.h"
+
+static AutoCVarInt g_textureCompressEnabled("texture.compress", "Upload imported textures as mipmapped BCn, cached in SavedUserData/TextureCache", 1, CVarFlags::EditCheckbox);
+static AutoCVarInt g_textureCompressFilter("texture.compress.filter", "Mip filter for compressed textures: 0 = box, 1 = Kaiser", 1, CVarFlags::None);
+static AutoCVarInt g_textureCompressReport("texture.compress.report", "Log PSNR and encode throughput of every texture compressed", 0, CVarFlags::EditCheckbox);
+
+using TextureProcessing::TextureUsage;
+
+namespace
+{
+    constexpr const char* kCacheDir = "SavedUserData/TextureCache";
+
+    // Bump when the encoders or the mip filters change their output.
+    constexpr uint32_t kEncoderVersion = 2;
+
+    const char* UsageName(TextureUsage usage)
+    {
+        switch (usage)
+        {
+        case TextureUsage::Albedo: return "albedo";
+        case TextureUsage::Normal: return "normal";
+        case TextureUsage::MetallicRoughness: return "metallic-roughness";
+        case TextureUsage::Mask: return "mask";
+        default: return "generic";
+        }
+    }
+
+    std::filesystem::path GetCachePath(const uint8_t* rgba, int width, int height, TextureUsage usage, TextureProcessing::MipFilter filter)
+    {
+        const uint32_t key[5] = { kEncoderVersion, static_cast<uint32_t>(usage), static_cast<uint32_t>(filter), static_cast<uint32_t>(width), static_cast<uint32_t>(height) };
+        const uint64_t seed = ContentHash::HashBytes(key, sizeof(key));
+        const uint64_t hash = ContentHash::HashBytes(rgba, static_cast<size_t>(width) * height * 4, seed);
+
+        char name[24];
+        std::snprintf(name, sizeof(name), "%016llx.dds", static_cast<unsigned long long>(hash));
+        return std::filesystem::path(kCacheDir) / name;
+    }
+
+    bool ReadCached(const std::filesystem::path& path, std::vector<uint8_t>& dds)
+    {
+        MappedFile file;
+        if (!file.Open(path))
+            return false;
+
+        TextureProcessing::EncodedTexture texture;
+        if (!TextureProcessing::ReadDds(file.Data(), file.Size(), texture))
+        {
+            spdlog::warn("Texture cache: ignoring unreadable '{}'", path.string());
+            return false;
+        }
+        dds.assign(file.Data(), file.Data() + file.Size());
+        return true;
+    }
+
+    // Written beside the target and renamed, so a crash never leaves a truncated cache entry.
+    void WriteCached(const std::filesystem::path& path, const std::vector<uint8_t>& dds)
+    {
+        std::error_code ec;
+        std::filesystem::create_directories(path.parent_path(), ec);
+
+        std::filesystem::path temporary = path;
+        temporary += ".tmp";
+        FILE* file = nullptr;
+        if (_wfopen_s(&file, temporary.c_str(), L"wb") != 0 || !file)
+        {
+            spdlog::warn("Texture cache: cannot write '{}'", temporary.string());
+            return;
+        }
+        const bool ok = std::fwrite(dds.data(), 1, dds.size(), file) == dds.size();
+        if (std::fclose(file) != 0 || !ok)
+        {
+            std::filesystem::remove(temporary, ec);
+            return;
+        }
+        std::filesystem::rename(temporary, path, ec);
+        if (ec)
+            std::filesystem::remove(temporary, ec);
+    }
+
+    void Report(const TextureProcessing::EncodedTexture& texture, const uint8_t* rgba, int width, int height, TextureUsage usage, double milliseconds)
+    {
+        std::vector<uint8_t> decoded;
+        TextureProcessing::DecodeLevel(texture, 0, decoded);
+        const double psnr = TextureProcessing::ComputePsnr(rgba, decoded.data(), static_cast<size_t>(width) * height, TextureProcessing::SignificantChannels(usage));
+
+        size_t encodedBytes = 0;
+        for (const TextureProcessing::Surface& level : texture.mips)
+            encodedBytes += level.data.size();
+        const double sourceMB = static_cast<double>(width) * height * 4 / (1024.0 * 1024.0);
+
+        spdlog::info("Texture compression: {}x{} {} as DXGI format {} with {} mips, {:.2f} dB PSNR (mip 0), {:.1f} -> {:.1f} MB, {:.1f} ms ({:.1f} MB/s)",
+            width, height, UsageName(usage), static_cast<uint32_t>(texture.format), texture.mips.size(), psnr,
+            sourceMB * 4.0 / 3.0, static_cast<double>(encodedBytes) / (1024.0 * 1024.0), milliseconds, sourceMB / (milliseconds / 1000.0));
+    }
+}
+
+bool TextureCompression::IsEnabled()
+{
+    return g_textureCompressEnabled.Get() != 0;
+}
+
+std::vector<uint8_t> TextureCompression::GetOrEncodeDds(const uint8_t* rgba, int width, int height, TextureUsage usage)
+{
+    const auto filter = g_textureCompressFilter.Get() == 0 ? TextureProcessing::MipFilter::Box : TextureProcessing::MipFilter::Kaiser;
+    const std::filesystem::path cachePath = GetCachePath(rgba, width, height, usage, filter);
+
+    std::vector<uint8_t> dds;
+    if (ReadCached(cachePath, dds))
+        return dds;
+
+    const auto start = std::chrono::high_resolution_clock::now();
+    const TextureProcessing::EncodedTexture texture = TextureProcessing::Encode(rgba, width, height, usage, filter);
+    const double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    if (!texture.IsValid())
+        return dds;
+
+    if (g_textureCompressReport.Get() != 0)
+        Report(texture, rgba, width, height, usage, milliseconds);
+
+    dds = TextureProcessing::WriteDds(texture);
+    WriteCached(cachePath, dds);
+    return dds;
+}
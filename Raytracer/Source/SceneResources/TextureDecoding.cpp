@@ -0,0 +1,90 @@
+#include "SceneResources/TextureDecoding.h"
+
+#include <climits>
+#include <cstring>
+
+#include <tinygltf/stb_image.h> // implementation in tiny_gltf.cc
+
+#include "Utils/MappedFile.h"
+
+namespace TextureDecoding
+{
+bool DecodeMemory(const uint8_t* bytes, size_t size, Image& out, const char** error)
+{
+    out = Image{};
+    if (size > static_cast<size_t>(INT_MAX))
+    {
+        if (error)
+            *error = "image too large";
+        return false;
+    }
+
+    int width = 0, height = 0, components = 0;
+    stbi_uc* pixels = stbi_load_from_memory(bytes, static_cast<int>(size), &width, &height, &components, 4);
+    if (!pixels)
+    {
+        if (error)
+            *error = stbi_failure_reason();
+        return false;
+    }
+
+    out.width = width;
+    out.height = height;
+    out.rgba.assign(pixels, pixels + static_cast<size_t>(width) * height * 4);
+    stbi_image_free(pixels);
+    return true;
+}
+
+bool DecodeFile(const std::filesystem::path& path, Image& out, const char** error)
+{
+    MappedFile file;
+    if (!file.Open(path) || file.Size() == 0)
+    {
+        out = Image{};
+        if (error)
+            *error = "cannot open file";
+        return false;
+    }
+    return DecodeMemory(file.Data(), file.Size(), out, error);
+}
+
+bool ExpandToRgba8(const uint8_t* pixels, int width, int height, int components, std::vector<uint8_t>& out)
+{
+    if (components < 1 || components > 4 || width <= 0 || height <= 0)
+        return false;
+
+    const size_t count = static_cast<size_t>(width) * height;
+    out.resize(count * 4);
+    uint8_t* dst = out.data();
+    switch (components)
+    {
+    case 4:
+        std::memcpy(dst, pixels, count * 4);
+        break;
+    case 3:
+        for (size_t i = 0; i < count; ++i, dst += 4, pixels += 3)
+        {
+            dst[0] = pixels[0];
+            dst[1] = pixels[1];
+            dst[2] = pixels[2];
+            dst[3] = 255;
+        }
+        break;
+    case 2:
+        for (size_t i = 0; i < count; ++i, dst += 4, pixels += 2)
+        {
+            dst[0] = dst[1] = dst[2] = pixels[0];
+            dst[3] = pixels[1];
+        }
+        break;
+    default:
+        for (size_t i = 0; i < count; ++i, dst += 4, ++pixels)
+        {
+            dst[0] = dst[1] = dst[2] = pixels[0];
+            dst[3] = 255;
+        }
+        break;
+    }
+    return true;
+}
+}
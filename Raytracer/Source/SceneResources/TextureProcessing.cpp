@@ -0,0 +1,531 @@
+#include "SceneResources/TextureProcessing.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#include "SceneResources/BlockCompression.h"
+#include "Utils/ThreadPool.h"
+
+namespace TextureProcessing
+{
+namespace
+{
+    using BlockCompression::BlockFormat;
+
+    constexpr float kPi = 3.14159265358979323846f;
+    constexpr float kKaiserAlpha = 4.0f;
+    constexpr float kKaiserRadius = 2.0f;
+
+    // Rows per ThreadPool task; levels are small enough that finer grains only add overhead.
+    constexpr size_t kRowGrain = 16;
+
+    bool IsBlockCompressed(TextureFormat format)
+    {
+        return format != TextureFormat::RGBA8;
+    }
+
+    BlockFormat ToBlockFormat(TextureFormat format)
+    {
+        switch (format)
+        {
+        case TextureFormat::BC1: return BlockFormat::BC1;
+        case TextureFormat::BC4: return BlockFormat::BC4;
+        case TextureFormat::BC5: return BlockFormat::BC5;
+        default: return BlockFormat::BC7;
+        }
+    }
+
+    size_t SurfaceSize(TextureFormat format, int width, int height)
+    {
+        return IsBlockCompressed(format)
+            ? BlockCompression::CompressedSize(width, height, ToBlockFormat(format))
+            : static_cast<size_t>(width) * height * 4;
+    }
+
+    // ---- colour spaces ----
+
+    float SrgbToLinear(float value)
+    {
+        return value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+    }
+
+    float LinearToSrgb(float value)
+    {
+        return value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+    }
+
+    const std::array<float, 256>& SrgbToLinearTable()
+    {
+        static const std::array<float, 256> table = []
+        {
+            std::array<float, 256> values{};
+            for (int i = 0; i < 256; ++i)
+                values[i] = SrgbToLinear(static_cast<float>(i) / 255.0f);
+            return values;
+        }();
+        return table;
+    }
+
+    uint8_t ToUnorm8(float value)
+    {
+        return static_cast<uint8_t>(std::lround(std::clamp(value, 0.0f, 1.0f) * 255.0f));
+    }
+
+    // Texels in the space the usage is filtered in.
+    void ToWorkingSpace(const uint8_t* rgba, size_t texelCount, TextureUsage usage, std::vector<float>& out)
+    {
+        out.resize(texelCount * 4);
+        const auto& toLinear = SrgbToLinearTable();
+        for (size_t i = 0; i < texelCount * 4; ++i)
+        {
+            const bool colour = (i & 3) != 3;
+            const float unorm = static_cast<float>(rgba[i]) / 255.0f;
+            if (usage == TextureUsage::Albedo && colour)
+                out[i] = toLinear[rgba[i]];
+            else if (usage == TextureUsage::Normal && colour)
+                out[i] = unorm * 2.0f - 1.0f;
+            else
+                out[i] = unorm;
+        }
+    }
+
+    void FromWorkingSpace(const float* texels, size_t texelCount, TextureUsage usage, uint8_t* out)
+    {
+        for (size_t i = 0; i < texelCount; ++i)
+        {
+            const float* t = texels + i * 4;
+            uint8_t* o = out + i * 4;
+            if (usage == TextureUsage::Albedo)
+            {
+                for (int c = 0; c < 3; ++c)
+                    o[c] = ToUnorm8(LinearToSrgb(std::max(t[c], 0.0f)));
+            }
+            else if (usage == TextureUsage::Normal)
+            {
+                const float length = std::sqrt(t[0] * t[0] + t[1] * t[1] + t[2] * t[2]);
+                const float scale = length > 1e-6f ? 1.0f / length : 0.0f;
+                for (int c = 0; c < 3; ++c)
+                    o[c] = ToUnorm8(length > 1e-6f ? t[c] * scale * 0.5f + 0.5f : (c == 2 ? 1.0f : 0.5f));
+            }
+            else
+            {
+                for (int c = 0; c < 3; ++c)
+                    o[c] = ToUnorm8(t[c]);
+            }
+            o[3] = ToUnorm8(t[3]);
+        }
+    }
+
+    // ---- filtering ----
+
+    // Modified Bessel function of the first kind, order 0 (power series).
+    float BesselI0(float x)
+    {
+        float sum = 1.0f, term = 1.0f;
+        const float quarterSquare = x * x * 0.25f;
+        for (int k = 1; k < 32 && term > sum * 1e-8f; ++k)
+        {
+            term *= quarterSquare / static_cast<float>(k * k);
+            sum += term;
+        }
+        return sum;
+    }
+
+    // x in destination texels from the destination texel's centre.
+    float FilterWeight(MipFilter filter, float x)
+    {
+        const float ax = std::fabs(x);
+        if (filter == MipFilter::Box)
+            return ax < 0.5f ? 1.0f : (ax == 0.5f ? 0.5f : 0.0f);
+
+        if (ax >= kKaiserRadius)
+            return 0.0f;
+        const float sinc = ax < 1e-6f ? 1.0f : std::sin(kPi * x) / (kPi * x);
+        const float r = x / kKaiserRadius;
+        return sinc * BesselI0(kKaiserAlpha * std::sqrt(1.0f - r * r)) / BesselI0(kKaiserAlpha);
+    }
+
+    // Normalized taps of one destination axis, CSR by destination index.
+    struct Taps
+    {
+        std::vector<uint32_t> offsets; // dstSize + 1
+        std::vector<int> sources;
+        std::vector<float> weights;
+    };
+
+    Taps BuildTaps(int srcSize, int dstSize, MipFilter filter)
+    {
+        const float scale = static_cast<float>(srcSize) / static_cast<float>(dstSize);
+        const float radius = (filter == MipFilter::Box ? 0.5f : kKaiserRadius) * scale;
+
+        Taps taps;
+        taps.offsets.reserve(static_cast<size_t>(dstSize) + 1);
+        taps.offsets.push_back(0);
+        for (int o = 0; o < dstSize; ++o)
+        {
+            const float centre = (static_cast<float>(o) + 0.5f) * scale;
+            const int first = static_cast<int>(std::floor(centre - radius));
+            const int last = static_cast<int>(std::ceil(centre + radius));
+            const size_t begin = taps.weights.size();
+            float total = 0.0f;
+            for (int i = first; i <= last; ++i)
+            {
+                const float weight = FilterWeight(filter, (static_cast<float>(i) + 0.5f - centre) / scale);
+                if (weight == 0.0f)
+                    continue;
+                taps.sources.push_back(((i % srcSize) + srcSize) % srcSize);
+                taps.weights.push_back(weight);
+                total += weight;
+            }
+            for (size_t k = begin; k < taps.weights.size(); ++k)
+                taps.weights[k] /= total;
+            taps.offsets.push_back(static_cast<uint32_t>(taps.weights.size()));
+        }
+        return taps;
+    }
+
+    // Separable downsample of a float RGBA level: rows first, then columns.
+    void Downsample(const std::vector<float>& src, int srcWidth, int srcHeight, std::vector<float>& dst, int dstWidth, int dstHeight, MipFilter filter)
+    {
+        const Taps horizontal = BuildTaps(srcWidth, dstWidth, filter);
+        const Taps vertical = BuildTaps(srcHeight, dstHeight, filter);
+
+        std::vector<float> rows(static_cast<size_t>(dstWidth) * srcHeight * 4);
+        ThreadPool::Get().ParallelForRange(static_cast<size_t>(srcHeight), kRowGrain, [&](size_t begin, size_t end)
+        {
+            for (size_t y = begin; y < end; ++y)
+            {
+                const float* in = src.data() + y * srcWidth * 4;
+                float* out = rows.data() + y * dstWidth * 4;
+                for (int x = 0; x < dstWidth; ++x)
+                {
+                    float sum[4] = {};
+                    for (uint32_t k = horizontal.offsets[x]; k < horizontal.offsets[x + 1]; ++k)
+                        for (int c = 0; c < 4; ++c)
+                            sum[c] += horizontal.weights[k] * in[horizontal.sources[k] * 4 + c];
+                    std::memcpy(out + x * 4, sum, sizeof(sum));
+                }
+            }
+        });
+
+        dst.assign(static_cast<size_t>(dstWidth) * dstHeight * 4, 0.0f);
+        ThreadPool::Get().ParallelForRange(static_cast<size_t>(dstHeight), kRowGrain, [&](size_t begin, size_t end)
+        {
+            for (size_t y = begin; y < end; ++y)
+            {
+                float* out = dst.data() + y * dstWidth * 4;
+                for (uint32_t k = vertical.offsets[y]; k < vertical.offsets[y + 1]; ++k)
+                {
+                    const float weight = vertical.weights[k];
+                    const float* in = rows.data() + static_cast<size_t>(vertical.sources[k]) * dstWidth * 4;
+                    for (int i = 0; i < dstWidth * 4; ++i)
+                        out[i] += weight * in[i];
+                }
+            }
+        });
+    }
+
+    // ---- DDS ----
+
+    constexpr uint32_t kDdsMagic = 0x20534444; // "DDS "
+    constexpr uint32_t kFourCCDX10 = 0x30315844; // "DX10"
+
+    constexpr uint32_t kDdsdCaps = 0x1, kDdsdHeight = 0x2, kDdsdWidth = 0x4, kDdsdPitch = 0x8;
+    constexpr uint32_t kDdsdPixelFormat = 0x1000, kDdsdMipMapCount = 0x20000, kDdsdLinearSize = 0x80000;
+    constexpr uint32_t kDdpfFourCC = 0x4;
+    constexpr uint32_t kDdsCapsComplex = 0x8, kDdsCapsTexture = 0x1000, kDdsCapsMipMap = 0x400000;
+    constexpr uint32_t kResourceDimensionTexture2D = 3;
+
+    struct DdsPixelFormat
+    {
+        uint32_t size;
+        uint32_t flags;
+        uint32_t fourCC;
+        uint32_t rgbBitCount;
+        uint32_t masks[4];
+    };
+
+    struct DdsHeader
+    {
+        uint32_t size;
+        uint32_t flags;
+        uint32_t height;
+        uint32_t width;
+        uint32_t pitchOrLinearSize;
+        uint32_t depth;
+        uint32_t mipMapCount;
+        uint32_t reserved1[11];
+        DdsPixelFormat pixelFormat;
+        uint32_t caps[4];
+        uint32_t reserved2;
+    };
+
+    struct DdsHeaderDX10
+    {
+        uint32_t dxgiFormat;
+        uint32_t resourceDimension;
+        uint32_t miscFlag;
+        uint32_t arraySize;
+        uint32_t miscFlags2;
+    };
+
+    static_assert(sizeof(DdsHeader) == 124 && sizeof(DdsHeaderDX10) == 20, "DDS headers are fixed-size");
+
+    bool IsKnownFormat(uint32_t dxgiFormat)
+    {
+        switch (static_cast<TextureFormat>(dxgiFormat))
+        {
+        case TextureFormat::RGBA8:
+        case TextureFormat::BC1:
+        case TextureFormat::BC4:
+        case TextureFormat::BC5:
+        case TextureFormat::BC7:
+            return true;
+        }
+        return false;
+    }
+}
+
+TextureFormat ChooseFormat(TextureUsage usage, int width, int height)
+{
+    if (width % 4 != 0 || height % 4 != 0)
+        return TextureFormat::RGBA8;
+
+    switch (usage)
+    {
+    case TextureUsage::Normal: return TextureFormat::BC5;
+    case TextureUsage::MetallicRoughness: return TextureFormat::BC5;
+    case TextureUsage::Mask: return TextureFormat::BC4;
+    default: return TextureFormat::BC7;
+    }
+}
+
+bool StoresMetallicRoughnessInRG(TextureUsage usage, TextureFormat format)
+{
+    return usage == TextureUsage::MetallicRoughness && format == TextureFormat::BC5;
+}
+
+int MipCount(int width, int height)
+{
+    int count = 1;
+    for (int size = std::max(width, height); size > 1; size /= 2)
+        ++count;
+    return count;
+}
+
+std::vector<Surface> GenerateMips(const uint8_t* rgba, int width, int height, TextureUsage usage, MipFilter filter)
+{
+    const int levelCount = MipCount(width, height);
+    std::vector<Surface> levels(levelCount);
+    levels[0].width = width;
+    levels[0].height = height;
+    levels[0].data.assign(rgba, rgba + static_cast<size_t>(width) * height * 4);
+
+    std::vector<float> current, next;
+    ToWorkingSpace(rgba, static_cast<size_t>(width) * height, usage, current);
+    for (int level = 1; level < levelCount; ++level)
+    {
+        const Surface& previous = levels[level - 1];
+        Surface& surface = levels[level];
+        surface.width = std::max(previous.width / 2, 1);
+        surface.height = std::max(previous.height / 2, 1);
+
+        Downsample(current, previous.width, previous.height, next, surface.width, surface.height, filter);
+
+        surface.data.resize(static_cast<size_t>(surface.width) * surface.height * 4);
+        ThreadPool::Get().ParallelForRange(static_cast<size_t>(surface.height), kRowGrain, [&](size_t begin, size_t end)
+        {
+            const size_t rowTexels = static_cast<size_t>(surface.width);
+            FromWorkingSpace(next.data() + begin * rowTexels * 4, (end - begin) * rowTexels, usage, surface.data.data() + begin * rowTexels * 4);
+        });
+        current.swap(next);
+    }
+    return levels;
+}
+
+Surface EncodeLevel(const Surface& level, TextureFormat format, TextureUsage usage)
+{
+    Surface out{ level.width, level.height, {} };
+    if (!IsBlockCompressed(format))
+    {
+        out.data = level.data;
+        return out;
+    }
+    if (!StoresMetallicRoughnessInRG(usage, format))
+    {
+        out.data = BlockCompression::Compress(level.data.data(), level.width, level.height, ToBlockFormat(format));
+        return out;
+    }
+
+    std::vector<uint8_t> moved(level.data.size());
+    for (size_t i = 0; i < moved.size(); i += 4)
+    {
+        moved[i] = level.data[i + 1];
+        moved[i + 1] = level.data[i + 2];
+        moved[i + 2] = 0;
+        moved[i + 3] = 255;
+    }
+    out.data = BlockCompression::Compress(moved.data(), level.width, level.height, ToBlockFormat(format));
+    return out;
+}
+
+EncodedTexture Encode(const uint8_t* rgba, int width, int height, TextureUsage usage, MipFilter filter)
+{
+    EncodedTexture texture;
+    texture.format = ChooseFormat(usage, width, height);
+    texture.usage = usage;
+    texture.mips = GenerateMips(rgba, width, height, usage, filter);
+    if (IsBlockCompressed(texture.format))
+    {
+        for (Surface& level : texture.mips)
+            level = EncodeLevel(level, texture.format, usage);
+    }
+    return texture;
+}
+
+void DecodeLevel(const EncodedTexture& texture, size_t level, std::vector<uint8_t>& rgba)
+{
+    const Surface& surface = texture.mips[level];
+    if (!IsBlockCompressed(texture.format))
+    {
+        rgba = surface.data;
+        return;
+    }
+    BlockCompression::Decompress(surface.data.data(), surface.width, surface.height, ToBlockFormat(texture.format), rgba);
+
+    // The SRV's swizzle: R <- 0, G <- R, B <- G, A <- 1.
+    if (StoresMetallicRoughnessInRG(texture.usage, texture.format))
+    {
+        for (size_t i = 0; i < rgba.size(); i += 4)
+        {
+            rgba[i + 2] = rgba[i + 1];
+            rgba[i + 1] = rgba[i];
+            rgba[i] = 0;
+            rgba[i + 3] = 255;
+        }
+    }
+}
+
+uint32_t SignificantChannels(TextureUsage usage)
+{
+    switch (usage)
+    {
+    case TextureUsage::Normal: return 0x3;
+    case TextureUsage::MetallicRoughness: return 0x6;
+    case TextureUsage::Mask: return 0x1;
+    default: return 0xf;
+    }
+}
+
+double ComputePsnr(const uint8_t* a, const uint8_t* b, size_t texelCount, uint32_t channelMask)
+{
+    double squaredError = 0.0;
+    size_t samples = 0;
+    for (size_t i = 0; i < texelCount; ++i)
+    {
+        for (int c = 0; c < 4; ++c)
+        {
+            if (!(channelMask & (1u << c)))
+                continue;
+            const double d = static_cast<double>(a[i * 4 + c]) - static_cast<double>(b[i * 4 + c]);
+            squaredError += d * d;
+            ++samples;
+        }
+    }
+    if (samples == 0 || squaredError == 0.0)
+        return std::numeric_limits<double>::infinity();
+    return 10.0 * std::log10(255.0 * 255.0 / (squaredError / static_cast<double>(samples)));
+}
+
+std::vector<uint8_t> WriteDds(const EncodedTexture& texture)
+{
+    const Surface& top = texture.mips.front();
+    const bool compressed = IsBlockCompressed(texture.format);
+
+    DdsHeader header{};
+    header.size = sizeof(DdsHeader);
+    header.flags = kDdsdCaps | kDdsdHeight | kDdsdWidth | kDdsdPixelFormat | kDdsdMipMapCount | (compressed ? kDdsdLinearSize : kDdsdPitch);
+    header.height = static_cast<uint32_t>(top.height);
+    header.width = static_cast<uint32_t>(top.width);
+    header.pitchOrLinearSize = static_cast<uint32_t>(compressed ? top.data.size() : static_cast<size_t>(top.width) * 4);
+    header.mipMapCount = static_cast<uint32_t>(texture.mips.size());
+    header.pixelFormat.size = sizeof(DdsPixelFormat);
+    header.pixelFormat.flags = kDdpfFourCC;
+    header.pixelFormat.fourCC = kFourCCDX10;
+    header.caps[0] = kDdsCapsTexture | (texture.mips.size() > 1 ? kDdsCapsComplex | kDdsCapsMipMap : 0);
+
+    DdsHeaderDX10 dx10{};
+    dx10.dxgiFormat = static_cast<uint32_t>(texture.format);
+    dx10.resourceDimension = kResourceDimensionTexture2D;
+    dx10.arraySize = 1;
+
+    size_t dataSize = 0;
+    for (const Surface& level : texture.mips)
+        dataSize += level.data.size();
+
+    std::vector<uint8_t> file(sizeof(kDdsMagic) + sizeof(header) + sizeof(dx10) + dataSize);
+    uint8_t* cursor = file.data();
+    std::memcpy(cursor, &kDdsMagic, sizeof(kDdsMagic));
+    cursor += sizeof(kDdsMagic);
+    std::memcpy(cursor, &header, sizeof(header));
+    cursor += sizeof(header);
+    std::memcpy(cursor, &dx10, sizeof(dx10));
+    cursor += sizeof(dx10);
+    for (const Surface& level : texture.mips)
+    {
+        std::memcpy(cursor, level.data.data(), level.data.size());
+        cursor += level.data.size();
+    }
+    return file;
+}
+
+bool ReadDds(const uint8_t* data, size_t size, EncodedTexture& out)
+{
+    out = EncodedTexture();
+
+    uint32_t magic;
+    DdsHeader header;
+    DdsHeaderDX10 dx10;
+    constexpr size_t kHeadersSize = sizeof(magic) + sizeof(header) + sizeof(dx10);
+    if (size < kHeadersSize)
+        return false;
+    std::memcpy(&magic, data, sizeof(magic));
+    std::memcpy(&header, data + sizeof(magic), sizeof(header));
+    std::memcpy(&dx10, data + sizeof(magic) + sizeof(header), sizeof(dx10));
+
+    if (magic != kDdsMagic || header.size != sizeof(DdsHeader) || header.pixelFormat.fourCC != kFourCCDX10
+        || dx10.resourceDimension != kResourceDimensionTexture2D || dx10.arraySize != 1 || !IsKnownFormat(dx10.dxgiFormat)
+        || header.width == 0 || header.height == 0 || header.width > (1u << 16) || header.height > (1u << 16))
+        return false;
+
+    const int width = static_cast<int>(header.width);
+    const int height = static_cast<int>(header.height);
+    const uint32_t mipCount = std::max(header.mipMapCount, 1u);
+    if (mipCount > static_cast<uint32_t>(MipCount(width, height)))
+        return false;
+
+    EncodedTexture texture;
+    texture.format = static_cast<TextureFormat>(dx10.dxgiFormat);
+    size_t offset = kHeadersSize;
+    for (uint32_t level = 0; level < mipCount; ++level)
+    {
+        Surface surface;
+        surface.width = std::max(width >> level, 1);
+        surface.height = std::max(height >> level, 1);
+        const size_t levelSize = SurfaceSize(texture.format, surface.width, surface.height);
+        if (size - offset < levelSize)
+            return false;
+        surface.data.assign(data + offset, data + offset + levelSize);
+        offset += levelSize;
+        texture.mips.push_back(std::move(surface));
+    }
+    if (offset != size)
+        return false;
+
+    out = std::move(texture);
+    return true;
+}
+}
@@ -0,0 +1,207 @@
+#include "SceneResources/TransformHierarchy.h"
+
+#include <cassert>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#define TRANSFORM_HIERARCHY_SSE2 1
+#include <xmmintrin.h>
+#endif
+
+namespace
+{
+    using Matrix = TransformHierarchy::Matrix;
+
+    // Row-vector product a * b.
+    void Multiply(const Matrix& a, const Matrix& b, Matrix& out)
+    {
+#ifdef TRANSFORM_HIERARCHY_SSE2
+        const __m128 b0 = _mm_loadu_ps(b.m[0]);
+        const __m128 b1 = _mm_loadu_ps(b.m[1]);
+        const __m128 b2 = _mm_loadu_ps(b.m[2]);
+        const __m128 b3 = _mm_loadu_ps(b.m[3]);
+        for (int r = 0; r < 4; ++r)
+        {
+            const __m128 xy = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(a.m[r][0]), b0), _mm_mul_ps(_mm_set1_ps(a.m[r][1]), b1));
+            const __m128 zw = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(a.m[r][2]), b2), _mm_mul_ps(_mm_set1_ps(a.m[r][3]), b3));
+            _mm_storeu_ps(out.m[r], _mm_add_ps(xy, zw));
+        }
+#else
+        for (int r = 0; r < 4; ++r)
+            for (int c = 0; c < 4; ++c)
+                out.m[r][c] = (a.m[r][0] * b.m[0][c] + a.m[r][1] * b.m[1][c]) + (a.m[r][2] * b.m[2][c] + a.m[r][3] * b.m[3][c]);
+#endif
+    }
+}
+
+void TransformHierarchy::Clear()
+{
+    m_parent.clear();
+    m_positionX.clear(); m_positionY.clear(); m_positionZ.clear();
+    m_rotationX.clear(); m_rotationY.clear(); m_rotationZ.clear(); m_rotationW.clear();
+    m_scaleX.clear(); m_scaleY.clear(); m_scaleZ.clear();
+    m_dirty.clear();
+    m_anyDirty = false;
+    m_local.clear();
+    m_world.clear();
+}
+
+void TransformHierarchy::Reserve(size_t count)
+{
+    m_parent.reserve(count);
+    m_positionX.reserve(count); m_positionY.reserve(count); m_positionZ.reserve(count);
+    m_rotationX.reserve(count); m_rotationY.reserve(count); m_rotationZ.reserve(count); m_rotationW.reserve(count);
+    m_scaleX.reserve(count); m_scaleY.reserve(count); m_scaleZ.reserve(count);
+    m_dirty.reserve(count);
+    m_local.reserve(count);
+    m_world.reserve(count);
+}
+
+uint32_t TransformHierarchy::Add(uint32_t parent, const float position[3], const float rotation[4], const float scale[3])
+{
+    const uint32_t node = static_cast<uint32_t>(m_parent.size());
+    assert((parent == NO_PARENT || parent < node) && "Parents must be added before their children");
+
+    m_parent.push_back(parent);
+    m_positionX.push_back(position[0]); m_positionY.push_back(position[1]); m_positionZ.push_back(position[2]);
+    m_rotationX.push_back(rotation[0]); m_rotationY.push_back(rotation[1]); m_rotationZ.push_back(rotation[2]); m_rotationW.push_back(rotation[3]);
+    m_scaleX.push_back(scale[0]); m_scaleY.push_back(scale[1]); m_scaleZ.push_back(scale[2]);
+    m_dirty.push_back(1);
+    m_anyDirty = true;
+    m_local.emplace_back();
+    m_world.emplace_back();
+    return node;
+}
+
+void TransformHierarchy::SetPosition(uint32_t node, const float position[3])
+{
+    m_positionX[node] = position[0];
+    m_positionY[node] = position[1];
+    m_positionZ[node] = position[2];
+    MarkDirty(node);
+}
+
+void TransformHierarchy::SetRotation(uint32_t node, const float rotation[4])
+{
+    m_rotationX[node] = rotation[0];
+    m_rotationY[node] = rotation[1];
+    m_rotationZ[node] = rotation[2];
+    m_rotationW[node] = rotation[3];
+    MarkDirty(node);
+}
+
+void TransformHierarchy::SetScale(uint32_t node, const float scale[3])
+{
+    m_scaleX[node] = scale[0];
+    m_scaleY[node] = scale[1];
+    m_scaleZ[node] = scale[2];
+    MarkDirty(node);
+}
+
+void TransformHierarchy::MarkDirty(uint32_t node)
+{
+    m_dirty[node] = 1;
+    m_anyDirty = true;
+}
+
+// S * R(q) * T, four nodes per SSE lane group: gather TRS from the SoA arrays,
+// build the nine scaled rotation terms side by side, transpose into rows.
+void TransformHierarchy::ComputeLocals(const uint32_t* nodes, size_t count)
+{
+    size_t i = 0;
+#ifdef TRANSFORM_HIERARCHY_SSE2
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 two = _mm_set1_ps(2.0f);
+    for (; i + 4 <= count; i += 4)
+    {
+        const uint32_t a = nodes[i], b = nodes[i + 1], c = nodes[i + 2], d = nodes[i + 3];
+        auto gather = [&](const std::vector<float>& values) { return _mm_setr_ps(values[a], values[b], values[c], values[d]); };
+
+        const __m128 qx = gather(m_rotationX), qy = gather(m_rotationY), qz = gather(m_rotationZ), qw = gather(m_rotationW);
+        const __m128 sx = gather(m_scaleX), sy = gather(m_scaleY), sz = gather(m_scaleZ);
+
+        const __m128 xx = _mm_mul_ps(qx, qx), yy = _mm_mul_ps(qy, qy), zz = _mm_mul_ps(qz, qz);
+        const __m128 xy = _mm_mul_ps(qx, qy), xz = _mm_mul_ps(qx, qz), yz = _mm_mul_ps(qy, qz);
+        const __m128 wx = _mm_mul_ps(qw, qx), wy = _mm_mul_ps(qw, qy), wz = _mm_mul_ps(qw, qz);
+
+        __m128 row0[4] = {
+            _mm_mul_ps(sx, _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz)))),
+            _mm_mul_ps(sx, _mm_mul_ps(two, _mm_add_ps(xy, wz))),
+            _mm_mul_ps(sx, _mm_mul_ps(two, _mm_sub_ps(xz, wy))),
+            _mm_setzero_ps() };
+        __m128 row1[4] = {
+            _mm_mul_ps(sy, _mm_mul_ps(two, _mm_sub_ps(xy, wz))),
+            _mm_mul_ps(sy, _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz)))),
+            _mm_mul_ps(sy, _mm_mul_ps(two, _mm_add_ps(yz, wx))),
+            _mm_setzero_ps() };
+        __m128 row2[4] = {
+            _mm_mul_ps(sz, _mm_mul_ps(two, _mm_add_ps(xz, wy))),
+            _mm_mul_ps(sz, _mm_mul_ps(two, _mm_sub_ps(yz, wx))),
+            _mm_mul_ps(sz, _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy)))),
+            _mm_setzero_ps() };
+        __m128 row3[4] = { gather(m_positionX), gather(m_positionY), gather(m_positionZ), one };
+
+        _MM_TRANSPOSE4_PS(row0[0], row0[1], row0[2], row0[3]);
+        _MM_TRANSPOSE4_PS(row1[0], row1[1], row1[2], row1[3]);
+        _MM_TRANSPOSE4_PS(row2[0], row2[1], row2[2], row2[3]);
+        _MM_TRANSPOSE4_PS(row3[0], row3[1], row3[2], row3[3]);
+
+        const uint32_t lanes[4] = { a, b, c, d };
+        for (int lane = 0; lane < 4; ++lane)
+        {
+            Matrix& local = m_local[lanes[lane]];
+            _mm_storeu_ps(local.m[0], row0[lane]);
+            _mm_storeu_ps(local.m[1], row1[lane]);
+            _mm_storeu_ps(local.m[2], row2[lane]);
+            _mm_storeu_ps(local.m[3], row3[lane]);
+        }
+    }
+#endif
+    for (; i < count; ++i)
+    {
+        const uint32_t n = nodes[i];
+        const float x = m_rotationX[n], y = m_rotationY[n], z = m_rotationZ[n], w = m_rotationW[n];
+        const float sx = m_scaleX[n], sy = m_scaleY[n], sz = m_scaleZ[n];
+        Matrix& local = m_local[n];
+        local = { {
+            { sx * (1.0f - 2.0f * (y * y + z * z)), sx * (2.0f * (x * y + w * z)), sx * (2.0f * (x * z - w * y)), 0.0f },
+            { sy * (2.0f * (x * y - w * z)), sy * (1.0f - 2.0f * (x * x + z * z)), sy * (2.0f * (y * z + w * x)), 0.0f },
+            { sz * (2.0f * (x * z + w * y)), sz * (2.0f * (y * z - w * x)), sz * (1.0f - 2.0f * (x * x + y * y)), 0.0f },
+            { m_positionX[n], m_positionY[n], m_positionZ[n], 1.0f },
+        } };
+    }
+}
+
+size_t TransformHierarchy::Update(std::vector<uint32_t>* changed)
+{
+    if (!m_anyDirty)
+        return 0;
+
+    // Parents precede children, so one forward sweep pushes dirtiness down the tree.
+    m_scratch.clear();
+    for (uint32_t node = 0; node < m_parent.size(); ++node)
+    {
+        const uint32_t parent = m_parent[node];
+        if (!m_dirty[node] && parent != NO_PARENT && m_dirty[parent])
+            m_dirty[node] = 1;
+        if (m_dirty[node])
+            m_scratch.push_back(node);
+    }
+
+    ComputeLocals(m_scratch.data(), m_scratch.size());
+    for (const uint32_t node : m_scratch)
+    {
+        const uint32_t parent = m_parent[node];
+        if (parent == NO_PARENT)
+            m_world[node] = m_local[node];
+        else
+            Multiply(m_local[node], m_world[parent], m_world[node]);
+    }
+
+    for (const uint32_t node : m_scratch)
+        m_dirty[node] = 0;
+    m_anyDirty = false;
+
+    if (changed)
+        changed->insert(changed->end(), m_scratch.begin(), m_scratch.end());
+    return m_scratch.size();
+}
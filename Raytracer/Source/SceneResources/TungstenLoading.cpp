@@ -3,24 +3,27 @@
 
 #include <algorithm>
 #include <cfloat>
+#include <chrono>
 #include <cmath>
 #include <cstdint>
 #include <filesystem>
 #include <fstream>
+#include <map>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
 #include <spdlog/spdlog.h>
 #include <rapidjson/document.h>
-#include <tinygltf/tiny_gltf.h>   // tinygltf::Image (reuses the glTF texture upload)
-#include <tinygltf/stb_image.h>   // stbi_load prototypes; implementation in tiny_gltf.cc
 
 #include "InputElements.h"
 #include "ResourceManager/ResourceManagerTypes.h" // AssetId
 #include "SceneResources/MeshProcessing.h"
 #include "SceneResources/Scene.h"
+#include "SceneResources/SceneCaching.h"
 #include "SceneResources/SceneNode.h"
+#include "SceneResources/TextureDecoding.h"
+#include "SceneResources/Wo3Mesh.h"
 #include "SceneResources/Model.h"
 #include "SceneResources/Primitive.h"
 #include "SceneResources/GameObject.h"
@@ -30,50 +33,51 @@
 #include "Resources/VertexBuffer.h"
 #include "Resources/IndexBuffer.h"
 #include "Renderer.h"
+#include "Utils/ThreadPool.h"
 
 namespace
 {
-    // Tungsten native mesh (.wo3): headerless — uint64 vertexCount, vertices,
-    // uint64 triangleCount, triangles. Vertex = pos(3f)+normal(3f)+uv(2f) = 32 B;
-    // triangle = 3 int32 indices + int32 material id = 16 B.
-    #pragma pack(push, 1)
-    struct Wo3Vertex { float px, py, pz, nx, ny, nz, u, v; };
-    struct Wo3Triangle { int32_t i0, i1, i2, material; };
-    #pragma pack(pop)
-    static_assert(sizeof(Wo3Vertex) == 32, "Wo3Vertex must be 32 bytes");
-    static_assert(sizeof(Wo3Triangle) == 16, "Wo3Triangle must be 16 bytes");
-
-    bool LoadWo3(const std::filesystem::path& path, std::vector<Vertex>& outVertices, std::vector<uint32_t>& outIndices)
+    // Accumulated .wo3 read cost for the per-scene load report.
+    struct Wo3ReadStats
     {
-        std::ifstream file(path, std::ios::binary);
-        if (!file)
-        {
-            spdlog::error("Tungsten: cannot open mesh '{}'", path.string());
-            return false;
-        }
-
-        uint64_t vertexCount = 0;
-        file.read(reinterpret_cast<char*>(&vertexCount), sizeof(vertexCount));
-        std::vector<Wo3Vertex> sourceVertices(static_cast<size_t>(vertexCount));
-        if (vertexCount > 0)
-            file.read(reinterpret_cast<char*>(sourceVertices.data()), static_cast<std::streamsize>(vertexCount * sizeof(Wo3Vertex)));
+        size_t files = 0;
+        uint64_t bytes = 0;
+        double seconds = 0.0;
+    };
 
-        uint64_t triangleCount = 0;
-        file.read(reinterpret_cast<char*>(&triangleCount), sizeof(triangleCount));
-        std::vector<Wo3Triangle> sourceTriangles(static_cast<size_t>(triangleCount));
-        if (triangleCount > 0)
-            file.read(reinterpret_cast<char*>(sourceTriangles.data()), static_cast<std::streamsize>(triangleCount * sizeof(Wo3Triangle)));
+    // Maps the file and validates the headerless layout in place; vertices and
+    // triangles are converted straight from the mapping into the output arrays.
+    bool LoadWo3(const std::filesystem::path& path, std::vector<Vertex>& outVertices, std::vector<uint32_t>& outIndices, Wo3ReadStats& stats)
+    {
+        const auto start = std::chrono::high_resolution_clock::now();
 
-        if (!file)
+        Wo3Mesh::File file;
+        switch (file.Open(path))
         {
-            spdlog::error("Tungsten: truncated mesh '{}'", path.string());
+        case Wo3Mesh::Status::Ok:
+            break;
+        case Wo3Mesh::Status::OpenFailed:
+            spdlog::error("Tungsten: cannot open mesh '{}'", path.string());
+            return false;
+        case Wo3Mesh::Status::TruncatedVertices:
+            spdlog::error("Tungsten: truncated mesh '{}' ({} vertices declared)", path.string(), file.VertexCount());
+            return false;
+        case Wo3Mesh::Status::TruncatedTriangles:
+            spdlog::error("Tungsten: truncated mesh '{}' ({} triangles declared)", path.string(), file.TriangleCount());
+            return false;
+        case Wo3Mesh::Status::TooManyVertices:
+            spdlog::error("Tungsten: mesh '{}' exceeds 32-bit indexing ({} vertices)", path.string(), file.VertexCount());
             return false;
         }
 
-        outVertices.resize(static_cast<size_t>(vertexCount));
+        if (file.TrailingBytes() != 0)
+            spdlog::warn("Tungsten: {} trailing byte(s) after mesh data in '{}'", file.TrailingBytes(), path.string());
+
+        const Wo3Mesh::Vertex* sourceVertices = file.Vertices();
+        outVertices.resize(static_cast<size_t>(file.VertexCount()));
         for (size_t i = 0; i < outVertices.size(); ++i)
         {
-            const Wo3Vertex& s = sourceVertices[i];
+            const Wo3Mesh::Vertex& s = sourceVertices[i];
             Vertex& d = outVertices[i];
             d.Pos = { s.px, s.py, s.pz };
             d.Normal = { s.nx, s.ny, s.nz };
@@ -83,13 +87,19 @@ namespace
 
         // Canonical CCW winding: mirror the glTF loader — positions and winding
         // kept as authored (both formats are right-handed Y-up).
-        outIndices.reserve(static_cast<size_t>(triangleCount) * 3);
-        for (const Wo3Triangle& t : sourceTriangles)
+        outIndices.resize(static_cast<size_t>(file.TriangleCount()) * 3);
+        size_t badTriangle = 0;
+        if (!Wo3Mesh::CopyIndices(file, outIndices.data(), badTriangle))
         {
-            outIndices.push_back(static_cast<uint32_t>(t.i0));
-            outIndices.push_back(static_cast<uint32_t>(t.i1));
-            outIndices.push_back(static_cast<uint32_t>(t.i2));
+            spdlog::error("Tungsten: triangle {} in '{}' indexes past {} vertices", badTriangle, path.string(), file.VertexCount());
+            outVertices.clear();
+            outIndices.clear();
+            return false;
         }
+
+        stats.files += 1;
+        stats.bytes += file.Size();
+        stats.seconds += std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
         return true;
     }
 
@@ -186,35 +196,80 @@ namespace
         return std::sqrt(std::clamp(r, 0.0f, 1.0f));
     }
 
+    // Decoded images by path string, filled on the pool before any material is
+    // built; LoadTextureFromFile consumes (and frees) them.
+    using DecodedTextures = std::unordered_map<std::string, TextureDecoding::Image>;
+
+    // Every texture file the given BSDFs reference, decoded in parallel.
+    DecodedTextures DecodeTextures(const std::vector<const rapidjson::Value*>& bsdfs, const std::filesystem::path& sceneDir)
+    {
+        const auto start = std::chrono::high_resolution_clock::now();
+
+        DecodedTextures decoded;
+        std::vector<std::pair<std::string, TextureDecoding::Image>> work;
+        for (const rapidjson::Value* bsdf : bsdfs)
+        {
+            if (!bsdf->HasMember("albedo") || !(*bsdf)["albedo"].IsString())
+                continue;
+            std::string key = (sceneDir / (*bsdf)["albedo"].GetString()).string();
+            if (decoded.try_emplace(key).second)
+                work.emplace_back(std::move(key), TextureDecoding::Image{});
+        }
+
+        std::vector<const char*> errors(work.size(), nullptr);
+        ThreadPool::Get().ParallelFor(work.size(), [&](size_t i)
+        {
+            TextureDecoding::DecodeFile(work[i].first, work[i].second, &errors[i]);
+        });
+
+        for (size_t i = 0; i < work.size(); ++i)
+        {
+            if (errors[i])
+                spdlog::warn("Tungsten: failed to load texture '{}': {}", work[i].first, errors[i]);
+            decoded[work[i].first] = std::move(work[i].second);
+        }
+
+        if (!work.empty())
+        {
+            spdlog::info("Tungsten: decoded {} texture(s) in {:.1f} ms on {} thread(s)", work.size(),
+                std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count(),
+                ThreadPool::Get().GetThreadCount());
+        }
+        return decoded;
+    }
+
     std::shared_ptr<Texture> LoadTextureFromFile(
         Renderer& renderer,
         const std::filesystem::path& path,
-        std::unordered_map<std::string, std::shared_ptr<Texture>>& cache)
+        DecodedTextures& decoded,
+        std::unordered_map<std::string, std::shared_ptr<Texture>>& cache,
+        SceneCaching::Recorder* cacheRecorder)
     {
         const std::string key = path.string();
         auto it = cache.find(key);
         if (it != cache.end())
             return it->second;
 
-        int width = 0, height = 0, channels = 0;
-        stbi_uc* pixels = stbi_load(key.c_str(), &width, &height, &channels, 4);
-        if (!pixels)
+        if (cacheRecorder)
+            cacheRecorder->AddDependency(path);
+
+        TextureDecoding::Image image;
+        if (auto decodedIt = decoded.find(key); decodedIt != decoded.end())
+            image = std::move(decodedIt->second);
+        else if (const char* error = nullptr; !TextureDecoding::DecodeFile(path, image, &error))
+            spdlog::warn("Tungsten: failed to load texture '{}': {}", key, error);
+
+        if (!image.IsValid())
         {
-            spdlog::warn("Tungsten: failed to load texture '{}'", key);
             cache[key] = nullptr;
             return nullptr;
         }
 
-        tinygltf::Image image;
-        image.width = width;
-        image.height = height;
-        image.component = 4;
-        image.bits = 8;
-        image.pixel_type = TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE;
-        image.image.assign(pixels, pixels + static_cast<size_t>(width) * height * 4);
-        stbi_image_free(pixels);
+        // Albedo is the only textured slot MakeMaterialFromBsdf maps.
+        std::shared_ptr<Texture> texture = renderer.CreateTexture(image.rgba.data(), image.width, image.height, 4, TextureProcessing::TextureUsage::Albedo);
+        if (cacheRecorder)
+            cacheRecorder->AddTexture(texture, image.rgba.data(), image.width, image.height, 4);
 
-        std::shared_ptr<Texture> texture = renderer.CreateTextureFromGLTF(image);
         cache[key] = texture;
         return texture;
     }
@@ -225,7 +280,9 @@ namespace
         Renderer& renderer,
         const rapidjson::Value& bsdf,
         const std::filesystem::path& sceneDir,
-        std::unordered_map<std::string, std::shared_ptr<Texture>>& textureCache)
+        DecodedTextures& decodedTextures,
+        std::unordered_map<std::string, std::shared_ptr<Texture>>& textureCache,
+        SceneCaching::Recorder* cacheRecorder)
     {
         auto material = std::make_shared<Material>();
 
@@ -279,14 +336,14 @@ namespace
         material->m_data.roughnessFactor = roughness;
 
         if (!albedo.texturePath.empty())
-            material->m_albedoTexture = LoadTextureFromFile(renderer, sceneDir / albedo.texturePath, textureCache);
+            material->m_albedoTexture = LoadTextureFromFile(renderer, sceneDir / albedo.texturePath, decodedTextures, textureCache, cacheRecorder);
 
         material->UpdateMaterial();
         return material;
     }
 }
 
-std::shared_ptr<Scene> TungstenLoading::LoadScene(Renderer& renderer, const AssetId& assetId)
+std::shared_ptr<Scene> TungstenLoading::LoadScene(Renderer& renderer, const AssetId& assetId, SceneCaching::Recorder* cacheRecorder)
 {
     using namespace DirectX;
     namespace fs = std::filesystem;
@@ -330,73 +387,250 @@ std::shared_ptr<Scene> TungstenLoading::LoadScene(Renderer& renderer, const Asse
 
     int meshCount = 0, skippedCount = 0;
 
+    // Mesh primitives in document order. Analytic quad/cube/sphere and
+    // emitter-only primitives are not v1.
+    std::vector<const rapidjson::Value*> meshPrims;
     if (doc.HasMember("primitives") && doc["primitives"].IsArray())
     {
         for (const rapidjson::Value& prim : doc["primitives"].GetArray())
         {
             const char* type = prim.HasMember("type") && prim["type"].IsString() ? prim["type"].GetString() : "";
-
             if (std::string(type) != "mesh" || !prim.HasMember("file") || !prim["file"].IsString())
             {
-                // Analytic quad/cube/sphere and emitter-only primitives: not v1.
                 ++skippedCount;
                 continue;
             }
+            meshPrims.push_back(&prim);
+        }
+    }
 
-            const fs::path meshPath = sceneDir / prim["file"].GetString();
-            std::vector<Vertex> primVertices;
-            std::vector<uint32_t> primIndices;
-            if (!LoadWo3(meshPath, primVertices, primIndices) || primVertices.empty() || primIndices.empty())
+    // Geometry owner per primitive: itself, or an earlier primitive whose mesh
+    // it reuses. Repeated .wo3 paths fold here, before anything is read;
+    // identical processed data folds after processing below.
+    const bool deduplicate = MeshUtils::IsDeduplicationEnabled();
+    MeshUtils::InstancingStats instancingStats;
+    std::vector<size_t> geometryOwner(meshPrims.size());
+    std::unordered_map<std::string, size_t> ownerByPath;
+    for (size_t i = 0; i < meshPrims.size(); ++i)
+    {
+        const fs::path meshPath = sceneDir / (*meshPrims[i])["file"].GetString();
+        geometryOwner[i] = i;
+        if (deduplicate)
+        {
+            const auto [it, inserted] = ownerByPath.try_emplace(meshPath.lexically_normal().generic_string(), i);
+            if (!inserted)
             {
-                ++skippedCount;
+                geometryOwner[i] = it->second;
+                ++instancingStats.foldedByPath;
                 continue;
             }
+        }
+        if (cacheRecorder)
+            cacheRecorder->AddDependency(meshPath);
+    }
 
-            MeshUtils::DropDegenerateTriangles(primVertices, primIndices);
-            MeshUtils::ComputeTangents(primVertices, primIndices); // .wo3 carries normals, not tangents
-            MeshUtils::EnforceVertexInvariants(primVertices);
+    // CPU stages (read, degenerate drop, mikktspace, invariants, optimization, AABB) are
+    // independent per primitive: one pool task each, except that large meshes get
+    // the whole pool for their tangents. Everything touching the
+    // renderer or the shared buffers stays on this thread below, in document
+    // order, so the output matches a serial load byte for byte.
+    struct MeshJob
+    {
+        std::vector<Vertex> vertices;
+        std::vector<uint32_t> indices;
+        XMFLOAT3 localMin{ FLT_MAX, FLT_MAX, FLT_MAX };
+        XMFLOAT3 localMax{ -FLT_MAX, -FLT_MAX, -FLT_MAX };
+        Wo3ReadStats readStats;
+        MeshUtils::MeshOptimizationStats optimizationStats;
+        MeshUtils::VertexPackingStats packingStats;
+        bool loaded = false;
+    };
+    std::vector<MeshJob> jobs(meshPrims.size());
 
-            BufferView vertexView{};
-            vertexView.buffer = nullptr;
-            vertexView.count = primVertices.size();
-            vertexView.offset = vertices.size();
-            vertexView.offsetBytes = vertices.size() * sizeof(Vertex);
-            vertexView.size = primVertices.size() * sizeof(Vertex);
+    const bool measurePacking = MeshUtils::IsVertexPackingReportEnabled();
+    const bool verifyAttributes = MeshUtils::IsAttributeVerificationEnabled();
+    const auto processStart = std::chrono::high_resolution_clock::now();
+    ThreadPool::Get().ParallelFor(jobs.size(), [&](size_t i)
+    {
+        MeshJob& job = jobs[i];
+        if (geometryOwner[i] != i)
+            return;
+        const fs::path meshPath = sceneDir / (*meshPrims[i])["file"].GetString();
+        if (!LoadWo3(meshPath, job.vertices, job.indices, job.readStats) || job.vertices.empty() || job.indices.empty())
+            return;
+
+        MeshUtils::DropDegenerateTriangles(job.vertices, job.indices);
+        job.loaded = true;
+    });
+
+    // .wo3 carries normals, not tangents.
+    const auto tangentStart = std::chrono::high_resolution_clock::now();
+    const size_t largeMeshes = MeshUtils::ForEachByWeight(jobs.size(), MeshUtils::LARGE_MESH_TRIANGLES,
+        [&](size_t i) { return jobs[i].loaded ? jobs[i].indices.size() / 3 : 0; },
+        [&](size_t i)
+        {
+            if (jobs[i].loaded)
+                MeshUtils::GenerateAttributes(jobs[i].vertices, jobs[i].indices, false, true, verifyAttributes);
+        });
+    const double tangentSeconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - tangentStart).count();
 
-            BufferView indexView{};
-            indexView.buffer = nullptr;
-            indexView.count = primIndices.size();
-            indexView.offset = indices.size();
-            indexView.offsetBytes = indices.size() * sizeof(uint32_t);
-            indexView.size = primIndices.size() * sizeof(uint32_t);
-
-            XMFLOAT3 localMin{ FLT_MAX, FLT_MAX, FLT_MAX };
-            XMFLOAT3 localMax{ -FLT_MAX, -FLT_MAX, -FLT_MAX };
-            for (const Vertex& v : primVertices)
+    ThreadPool::Get().ParallelFor(jobs.size(), [&](size_t i)
+    {
+        MeshJob& job = jobs[i];
+        if (!job.loaded)
+            return;
+
+        MeshUtils::EnforceVertexInvariants(job.vertices);
+        MeshUtils::OptimizeMesh(job.vertices, job.indices, job.optimizationStats);
+
+        for (const Vertex& v : job.vertices)
+        {
+            job.localMin.x = std::min(job.localMin.x, v.Pos.x); job.localMax.x = std::max(job.localMax.x, v.Pos.x);
+            job.localMin.y = std::min(job.localMin.y, v.Pos.y); job.localMax.y = std::max(job.localMax.y, v.Pos.y);
+            job.localMin.z = std::min(job.localMin.z, v.Pos.z); job.localMax.z = std::max(job.localMax.z, v.Pos.z);
+        }
+        if (measurePacking)
+            MeshUtils::MeasureVertexPacking(job.vertices, job.localMin, job.localMax, job.packingStats);
+    });
+    const double processSeconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - processStart).count();
+
+    // Different files, same mesh after processing (exported copies, re-saved
+    // instances). Processing is deterministic, so equal input gives equal bytes.
+    if (deduplicate)
+    {
+        std::vector<uint64_t> geometryHashes(jobs.size(), 0);
+        ThreadPool::Get().ParallelFor(jobs.size(), [&](size_t i)
+        {
+            if (jobs[i].loaded)
+                geometryHashes[i] = MeshUtils::HashGeometry(jobs[i].vertices, jobs[i].indices);
+        });
+
+        std::unordered_map<uint64_t, std::vector<size_t>> ownersByHash;
+        for (size_t i = 0; i < jobs.size(); ++i)
+        {
+            if (!jobs[i].loaded)
+                continue;
+            std::vector<size_t>& candidates = ownersByHash[geometryHashes[i]];
+            const auto match = std::find_if(candidates.begin(), candidates.end(), [&](size_t j)
+            {
+                return MeshUtils::GeometryEquals(jobs[i].vertices, jobs[i].indices, jobs[j].vertices, jobs[j].indices);
+            });
+            if (match == candidates.end())
             {
-                localMin.x = std::min(localMin.x, v.Pos.x); localMax.x = std::max(localMax.x, v.Pos.x);
-                localMin.y = std::min(localMin.y, v.Pos.y); localMax.y = std::max(localMax.y, v.Pos.y);
-                localMin.z = std::min(localMin.z, v.Pos.z); localMax.z = std::max(localMax.z, v.Pos.z);
+                candidates.push_back(i);
+                continue;
             }
+            geometryOwner[i] = *match;
+            ++instancingStats.foldedByContent;
+        }
+
+        // Path duplicates follow their owner if it was folded too.
+        for (size_t i = 0; i < jobs.size(); ++i)
+            geometryOwner[i] = geometryOwner[geometryOwner[i]];
 
-            // Resolve the primitive's BSDF (named reference or inline object).
-            std::shared_ptr<Material> material;
-            if (prim.HasMember("bsdf"))
+        for (size_t i = 0; i < jobs.size(); ++i)
+        {
+            const MeshJob& owner = jobs[geometryOwner[i]];
+            if (geometryOwner[i] != i && owner.loaded)
+                instancingStats.bytesSaved += owner.vertices.size() * sizeof(Vertex) + owner.indices.size() * sizeof(uint32_t);
+        }
+        for (size_t i = 0; i < jobs.size(); ++i)
+        {
+            if (geometryOwner[i] != i && jobs[i].loaded)
             {
-                const rapidjson::Value& bsdfRef = prim["bsdf"];
-                if (bsdfRef.IsString())
-                {
-                    auto it = bsdfsByName.find(bsdfRef.GetString());
-                    if (it != bsdfsByName.end())
-                        material = MakeMaterialFromBsdf(renderer, *it->second, sceneDir, textureCache);
-                    else
-                        spdlog::warn("Tungsten: primitive references unknown bsdf '{}'", bsdfRef.GetString());
-                }
-                else if (bsdfRef.IsObject())
-                {
-                    material = MakeMaterialFromBsdf(renderer, bsdfRef, sceneDir, textureCache);
-                }
+                jobs[i].loaded = false;
+                std::vector<Vertex>().swap(jobs[i].vertices);
+                std::vector<uint32_t>().swap(jobs[i].indices);
             }
+        }
+    }
+
+    // Offsets into the shared buffers: exclusive prefix sum over loaded jobs.
+    std::vector<size_t> vertexOffsets(jobs.size(), 0);
+    std::vector<size_t> indexOffsets(jobs.size(), 0);
+    size_t totalVertices = 0, totalIndices = 0;
+    Wo3ReadStats wo3Stats;
+    MeshUtils::MeshOptimizationStats optimizationStats;
+    MeshUtils::VertexPackingStats packingStats;
+    for (size_t i = 0; i < jobs.size(); ++i)
+    {
+        if (geometryOwner[i] == i)
+        {
+            optimizationStats.Accumulate(jobs[i].optimizationStats);
+            packingStats.Accumulate(jobs[i].packingStats);
+        }
+        wo3Stats.files += jobs[i].readStats.files;
+        wo3Stats.bytes += jobs[i].readStats.bytes;
+        wo3Stats.seconds += jobs[i].readStats.seconds;
+        if (!jobs[i].loaded)
+            continue;
+        vertexOffsets[i] = totalVertices;
+        indexOffsets[i] = totalIndices;
+        totalVertices += jobs[i].vertices.size();
+        totalIndices += jobs[i].indices.size();
+    }
+
+    vertices.resize(totalVertices);
+    indices.resize(totalIndices);
+    ThreadPool::Get().ParallelFor(jobs.size(), [&](size_t i)
+    {
+        MeshJob& job = jobs[i];
+        if (!job.loaded)
+            return;
+        std::copy(job.vertices.begin(), job.vertices.end(), vertices.begin() + static_cast<ptrdiff_t>(vertexOffsets[i]));
+        std::copy(job.indices.begin(), job.indices.end(), indices.begin() + static_cast<ptrdiff_t>(indexOffsets[i]));
+    });
+
+    // Resolve each loaded primitive's BSDF (named reference or inline object),
+    // then decode every texture those BSDFs use before building materials.
+    std::vector<const rapidjson::Value*> primBsdfs(jobs.size(), nullptr);
+    std::vector<const rapidjson::Value*> usedBsdfs;
+    for (size_t i = 0; i < jobs.size(); ++i)
+    {
+        const rapidjson::Value& prim = *meshPrims[i];
+        if (!jobs[geometryOwner[i]].loaded || !prim.HasMember("bsdf"))
+            continue;
+
+        const rapidjson::Value& bsdfRef = prim["bsdf"];
+        if (bsdfRef.IsString())
+        {
+            auto it = bsdfsByName.find(bsdfRef.GetString());
+            if (it != bsdfsByName.end())
+                primBsdfs[i] = it->second;
+            else
+                spdlog::warn("Tungsten: primitive references unknown bsdf '{}'", bsdfRef.GetString());
+        }
+        else if (bsdfRef.IsObject())
+        {
+            primBsdfs[i] = &bsdfRef;
+        }
+        if (primBsdfs[i])
+            usedBsdfs.push_back(primBsdfs[i]);
+    }
+    DecodedTextures decodedTextures = DecodeTextures(usedBsdfs, sceneDir);
+
+    // One material per BSDF (named or inline) and one model per (geometry,
+    // BSDF) pair; every further primitive with the same pair is an instance.
+    std::unordered_map<const rapidjson::Value*, std::shared_ptr<Material>> materialsByBsdf;
+    std::map<std::pair<size_t, const rapidjson::Value*>, std::shared_ptr<Model>> modelsByKey;
+    renderer.BeginTextureUploads();
+    for (size_t i = 0; i < jobs.size(); ++i)
+    {
+        MeshJob& job = jobs[geometryOwner[i]];
+        if (!job.loaded)
+        {
+            ++skippedCount;
+            continue;
+        }
+        const rapidjson::Value& prim = *meshPrims[i];
+        const rapidjson::Value* bsdf = primBsdfs[i];
+
+        std::shared_ptr<Model>& model = modelsByKey[{ geometryOwner[i], bsdf }];
+        if (!model)
+        {
+            std::shared_ptr<Material>& material = materialsByBsdf[bsdf];
+            if (!material && bsdf)
+                material = MakeMaterialFromBsdf(renderer, *bsdf, sceneDir, decodedTextures, textureCache, cacheRecorder);
             if (!material)
             {
                 material = std::make_shared<Material>();
@@ -406,50 +640,86 @@ std::shared_ptr<Scene> TungstenLoading::LoadScene(Renderer& renderer, const Asse
                 material->UpdateMaterial();
             }
 
-            vertices.insert(vertices.end(), primVertices.begin(), primVertices.end());
-            indices.insert(indices.end(), primIndices.begin(), primIndices.end());
+            const size_t owner = geometryOwner[i];
+
+            BufferView vertexView{};
+            vertexView.buffer = nullptr;
+            vertexView.count = job.vertices.size();
+            vertexView.offset = vertexOffsets[owner];
+            vertexView.offsetBytes = vertexOffsets[owner] * sizeof(Vertex);
+            vertexView.size = job.vertices.size() * sizeof(Vertex);
+
+            BufferView indexView{};
+            indexView.buffer = nullptr;
+            indexView.count = job.indices.size();
+            indexView.offset = indexOffsets[owner];
+            indexView.offsetBytes = indexOffsets[owner] * sizeof(uint32_t);
+            indexView.size = job.indices.size() * sizeof(uint32_t);
 
             auto primitive = std::make_shared<Primitive>(vertexView, indexView, material);
-            primitive->m_localAabbMin = localMin;
-            primitive->m_localAabbMax = localMax;
+            primitive->m_localAabbMin = job.localMin;
+            primitive->m_localAabbMax = job.localMax;
 
-            auto model = std::make_shared<Model>();
+            model = std::make_shared<Model>();
             model->AddMesh(primitive);
             sceneBuilder.AddModel(model);
+        }
 
-            auto gameObject = renderer.InstantiateGameObject();
-            sceneBuilder.AddGameObject(gameObject, model);
+        auto gameObject = renderer.InstantiateGameObject();
+        sceneBuilder.AddGameObject(gameObject, model);
 
-            auto node = std::make_shared<SceneNode>();
-            node->AddGameObject(gameObject);
+        auto node = std::make_shared<SceneNode>();
+        node->AddGameObject(gameObject);
 
-            SimpleMath::Vector3 position{ 0, 0, 0 };
-            SimpleMath::Vector3 scale{ 1, 1, 1 };
-            SimpleMath::Vector3 rotationDeg{ 0, 0, 0 };
-            if (prim.HasMember("transform") && prim["transform"].IsObject())
-            {
-                const rapidjson::Value& transform = prim["transform"];
-                if (transform.HasMember("position")) position = ParseVec3(transform["position"], position);
-                if (transform.HasMember("scale")) scale = ParseScale(transform["scale"]);
-                if (transform.HasMember("rotation")) rotationDeg = ParseVec3(transform["rotation"], rotationDeg);
-            }
+        SimpleMath::Vector3 position{ 0, 0, 0 };
+        SimpleMath::Vector3 scale{ 1, 1, 1 };
+        SimpleMath::Vector3 rotationDeg{ 0, 0, 0 };
+        if (prim.HasMember("transform") && prim["transform"].IsObject())
+        {
+            const rapidjson::Value& transform = prim["transform"];
+            if (transform.HasMember("position")) position = ParseVec3(transform["position"], position);
+            if (transform.HasMember("scale")) scale = ParseScale(transform["scale"]);
+            if (transform.HasMember("rotation")) rotationDeg = ParseVec3(transform["rotation"], rotationDeg);
+        }
 
-            const float toRad = 3.14159265358979323846f / 180.0f;
-            // Tungsten rotation = XYZ Euler degrees. Single-axis cases (this scene)
-            // are order/handedness-robust; verify sign on multi-axis scenes.
-            SimpleMath::Quaternion rotation = SimpleMath::Quaternion::CreateFromYawPitchRoll(
-                rotationDeg.y * toRad, rotationDeg.x * toRad, rotationDeg.z * toRad);
+        const float toRad = 3.14159265358979323846f / 180.0f;
+        // Tungsten rotation = XYZ Euler degrees. Single-axis cases (this scene)
+        // are order/handedness-robust; verify sign on multi-axis scenes.
+        SimpleMath::Quaternion rotation = SimpleMath::Quaternion::CreateFromYawPitchRoll(
+            rotationDeg.y * toRad, rotationDeg.x * toRad, rotationDeg.z * toRad);
 
-            node->SetScale(scale);
-            node->SetRotation(rotation);
-            node->SetPosition(position);
-            sceneBuilder.AddChild(sceneBuilder.GetRoot(), node);
+        node->SetScale(scale);
+        node->SetRotation(rotation);
+        node->SetPosition(position);
+        sceneBuilder.AddChild(sceneBuilder.GetRoot(), node);
 
-            ++meshCount;
-        }
+        ++meshCount;
+    }
+    renderer.EndTextureUploads();
+
+    // The shared arrays own the data now.
+    for (MeshJob& job : jobs)
+    {
+        std::vector<Vertex>().swap(job.vertices);
+        std::vector<uint32_t>().swap(job.indices);
     }
+    instancingStats.primitives = static_cast<size_t>(meshCount);
+    instancingStats.models = modelsByKey.size();
 
     spdlog::info("Tungsten: loaded {} mesh primitive(s), skipped {} (analytic/emitter/failed)", meshCount, skippedCount);
+    spdlog::info("Tungsten: mesh processing took {:.1f} ms on {} thread(s)", processSeconds * 1000.0, ThreadPool::Get().GetThreadCount());
+    spdlog::info("Tungsten: tangents took {:.1f} ms ({} large mesh(es) split across the pool)", tangentSeconds * 1000.0, largeMeshes);
+    MeshUtils::LogOptimizationStats("Tungsten", optimizationStats);
+    MeshUtils::LogVertexPackingStats("Tungsten", packingStats);
+    MeshUtils::LogInstancingStats("Tungsten", instancingStats);
+    if (wo3Stats.files > 0 && wo3Stats.seconds > 0.0)
+    {
+        const double megabytes = static_cast<double>(wo3Stats.bytes) / (1024.0 * 1024.0);
+        // Summed across workers: per-thread read throughput, not wall time.
+        spdlog::info("Tungsten: read {} .wo3 file(s), {:.1f} MB in {:.1f} ms ({:.0f} MB/s, {:.3f} ms/file)",
+            wo3Stats.files, megabytes, wo3Stats.seconds * 1000.0, megabytes / wo3Stats.seconds,
+            wo3Stats.seconds * 1000.0 / static_cast<double>(wo3Stats.files));
+    }
 
     if (meshCount == 0)
     {
@@ -483,6 +753,8 @@ std::shared_ptr<Scene> TungstenLoading::LoadScene(Renderer& renderer, const Asse
     }
 
     sceneBuilder.UpdateMatrices();
+    if (cacheRecorder)
+        cacheRecorder->Write(sceneBuilder, vertices, indices);
     sceneBuilder.SetAccelerationStructures(MeshUtils::BuildAccelerationStructures(renderer, sceneBuilder));
 
     return sceneBuilder.Build(renderer);
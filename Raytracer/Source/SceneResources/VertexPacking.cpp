@@ -0,0 +1,248 @@
+#include "SceneResources/VertexPacking.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace VertexPacking
+{
+namespace
+{
+    uint32_t FloatBits(float value)
+    {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+
+    float BitsToFloat(uint32_t bits)
+    {
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    // Octahedral.hlsl UnitVectorToSignedOctahedron.
+    void UnitVectorToSignedOctahedron(const float n[3], float& outX, float& outY)
+    {
+        const float l1 = std::fabs(n[0]) + std::fabs(n[1]) + std::fabs(n[2]);
+        const float x = l1 > 0.0f ? n[0] / l1 : 0.0f;
+        const float y = l1 > 0.0f ? n[1] / l1 : 0.0f;
+        if (n[2] < 0.0f)
+        {
+            // OctWrap
+            outX = (1.0f - std::fabs(y)) * (x < 0.0f ? -1.0f : 1.0f);
+            outY = (1.0f - std::fabs(x)) * (y < 0.0f ? -1.0f : 1.0f);
+        }
+        else
+        {
+            outX = x;
+            outY = y;
+        }
+    }
+
+    // Octahedral.hlsl SignedOctahedronToUnitVector.
+    void SignedOctahedronToUnitVector(float x, float y, float outN[3])
+    {
+        float z = 1.0f - std::fabs(x) - std::fabs(y);
+        const float t = std::max(-z, 0.0f);
+        x += x >= 0.0f ? -t : t;
+        y += y >= 0.0f ? -t : t;
+        const float length = std::sqrt(x * x + y * y + z * z);
+        outN[0] = x / length;
+        outN[1] = y / length;
+        outN[2] = z / length;
+    }
+
+    // Truncating, like the shader's uint() conversion.
+    uint32_t ToUnorm(float signedValue, float scale)
+    {
+        const float unorm = std::clamp(signedValue * 0.5f + 0.5f, 0.0f, 1.0f);
+        return static_cast<uint32_t>(unorm * scale);
+    }
+
+    float FromUnorm(uint32_t value, float scale)
+    {
+        return std::clamp(static_cast<float>(value) / scale, 0.0f, 1.0f) * 2.0f - 1.0f;
+    }
+
+    constexpr float kUnorm16 = static_cast<float>(0xfffe);
+    constexpr float kUnorm15 = static_cast<float>(0x7ffe);
+    constexpr uint32_t kTangentSignBit = 1u << 15;
+
+    uint16_t QuantizeUnorm16(float value, float minimum, float extent)
+    {
+        if (!(extent > 0.0f))
+            return 0;
+        const float unorm = std::clamp((value - minimum) / extent, 0.0f, 1.0f);
+        return static_cast<uint16_t>(unorm * 65535.0f + 0.5f);
+    }
+
+    float DequantizeUnorm16(uint16_t value, float minimum, float extent)
+    {
+        return minimum + extent * (static_cast<float>(value) / 65535.0f);
+    }
+
+    float AngleBetween(const float a[3], const float b[3])
+    {
+        const float la = std::sqrt(a[0] * a[0] + a[1] * a[1] + a[2] * a[2]);
+        const float lb = std::sqrt(b[0] * b[0] + b[1] * b[1] + b[2] * b[2]);
+        if (!(la > 0.0f) || !(lb > 0.0f))
+            return 0.0f;
+        const float cosine = (a[0] * b[0] + a[1] * b[1] + a[2] * b[2]) / (la * lb);
+        return std::acos(std::clamp(cosine, -1.0f, 1.0f));
+    }
+
+    void PackAttributes(const FloatVertex& v, uint32_t& normal, uint32_t& tangent, uint16_t uv[2])
+    {
+        normal = EncodeOctahedron(v.normal);
+        tangent = EncodeTangent(v.tangent, v.tangent[3]);
+        uv[0] = FloatToHalf(v.uv[0]);
+        uv[1] = FloatToHalf(v.uv[1]);
+    }
+
+    void UnpackAttributes(uint32_t normal, uint32_t tangent, const uint16_t uv[2], FloatVertex& v)
+    {
+        DecodeOctahedron(normal, v.normal);
+        DecodeTangent(tangent, v.tangent);
+        v.uv[0] = HalfToFloat(uv[0]);
+        v.uv[1] = HalfToFloat(uv[1]);
+    }
+}
+
+uint32_t EncodeOctahedron(const float n[3])
+{
+    float x, y;
+    UnitVectorToSignedOctahedron(n, x, y);
+    return ToUnorm(x, kUnorm16) | (ToUnorm(y, kUnorm16) << 16);
+}
+
+void DecodeOctahedron(uint32_t packed, float outN[3])
+{
+    SignedOctahedronToUnitVector(FromUnorm(packed & 0xffff, kUnorm16), FromUnorm(packed >> 16, kUnorm16), outN);
+}
+
+uint32_t EncodeTangent(const float t[3], float sign)
+{
+    float x, y;
+    UnitVectorToSignedOctahedron(t, x, y);
+    return ToUnorm(x, kUnorm15) | (sign < 0.0f ? kTangentSignBit : 0u) | (ToUnorm(y, kUnorm16) << 16);
+}
+
+void DecodeTangent(uint32_t packed, float outT[4])
+{
+    SignedOctahedronToUnitVector(FromUnorm(packed & 0x7fff, kUnorm15), FromUnorm(packed >> 16, kUnorm16), outT);
+    outT[3] = (packed & kTangentSignBit) ? -1.0f : 1.0f;
+}
+
+uint16_t FloatToHalf(float value)
+{
+    // Rounding through the FPU (F. Giesen, "float_to_half_fast3_rtne").
+    uint32_t bits = FloatBits(value);
+    const uint32_t sign = bits & 0x80000000u;
+    bits ^= sign;
+
+    uint16_t half;
+    if (bits >= 0x47800000u) // exponent overflow: infinity, or NaN (quiet)
+    {
+        half = bits > 0x7f800000u ? 0x7e00 : 0x7c00;
+    }
+    else if (bits < 0x38800000u) // zero or half denormal: let the add round
+    {
+        const uint32_t denormMagic = ((127 - 15) + (23 - 10) + 1) << 23;
+        half = static_cast<uint16_t>(FloatBits(BitsToFloat(bits) + BitsToFloat(denormMagic)) - denormMagic);
+    }
+    else
+    {
+        const uint32_t mantissaOdd = (bits >> 13) & 1;
+        bits += (static_cast<uint32_t>(15 - 127) << 23) + 0xfff;
+        bits += mantissaOdd;
+        half = static_cast<uint16_t>(bits >> 13);
+    }
+    return static_cast<uint16_t>(half | (sign >> 16));
+}
+
+float HalfToFloat(uint16_t value)
+{
+    const uint32_t sign = static_cast<uint32_t>(value & 0x8000) << 16;
+    const uint32_t exponent = (value >> 10) & 0x1f;
+    const uint32_t mantissa = value & 0x3ff;
+
+    if (exponent == 0x1f)
+        return BitsToFloat(sign | 0x7f800000u | (mantissa << 13));
+    if (exponent == 0)
+    {
+        // Zero or denormal: mantissa * 2^-24, exact in float.
+        const float magnitude = static_cast<float>(mantissa) * BitsToFloat(0x33800000u);
+        return BitsToFloat(FloatBits(magnitude) | sign);
+    }
+    return BitsToFloat(sign | ((exponent + 112) << 23) | (mantissa << 13));
+}
+
+void Pack(const FloatVertex* src, size_t count, PackedVertex* dst)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        std::memcpy(dst[i].position, src[i].position, sizeof(dst[i].position));
+        PackAttributes(src[i], dst[i].normal, dst[i].tangent, dst[i].uv);
+    }
+}
+
+void Unpack(const PackedVertex* src, size_t count, FloatVertex* dst)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        std::memcpy(dst[i].position, src[i].position, sizeof(dst[i].position));
+        UnpackAttributes(src[i].normal, src[i].tangent, src[i].uv, dst[i]);
+    }
+}
+
+void PackQuantized(const FloatVertex* src, size_t count, const float aabbMin[3], const float aabbMax[3], QuantizedVertex* dst)
+{
+    const float extent[3] = { aabbMax[0] - aabbMin[0], aabbMax[1] - aabbMin[1], aabbMax[2] - aabbMin[2] };
+    for (size_t i = 0; i < count; ++i)
+    {
+        for (int axis = 0; axis < 3; ++axis)
+            dst[i].position[axis] = QuantizeUnorm16(src[i].position[axis], aabbMin[axis], extent[axis]);
+        dst[i].reserved = 0;
+        PackAttributes(src[i], dst[i].normal, dst[i].tangent, dst[i].uv);
+    }
+}
+
+void UnpackQuantized(const QuantizedVertex* src, size_t count, const float aabbMin[3], const float aabbMax[3], FloatVertex* dst)
+{
+    const float extent[3] = { aabbMax[0] - aabbMin[0], aabbMax[1] - aabbMin[1], aabbMax[2] - aabbMin[2] };
+    for (size_t i = 0; i < count; ++i)
+    {
+        for (int axis = 0; axis < 3; ++axis)
+            dst[i].position[axis] = DequantizeUnorm16(src[i].position[axis], aabbMin[axis], std::max(extent[axis], 0.0f));
+        UnpackAttributes(src[i].normal, src[i].tangent, src[i].uv, dst[i]);
+    }
+}
+
+void PackingError::Merge(const PackingError& other)
+{
+    position = std::max(position, other.position);
+    normalAngle = std::max(normalAngle, other.normalAngle);
+    tangentAngle = std::max(tangentAngle, other.tangentAngle);
+    uv = std::max(uv, other.uv);
+    tangentSignFlips += other.tangentSignFlips;
+}
+
+PackingError MeasureError(const FloatVertex* original, const FloatVertex* decoded, size_t count)
+{
+    PackingError error;
+    for (size_t i = 0; i < count; ++i)
+    {
+        const FloatVertex& a = original[i];
+        const FloatVertex& b = decoded[i];
+        for (int axis = 0; axis < 3; ++axis)
+            error.position = std::max(error.position, std::fabs(a.position[axis] - b.position[axis]));
+        error.normalAngle = std::max(error.normalAngle, AngleBetween(a.normal, b.normal));
+        error.tangentAngle = std::max(error.tangentAngle, AngleBetween(a.tangent, b.tangent));
+        error.uv = std::max({ error.uv, std::fabs(a.uv[0] - b.uv[0]), std::fabs(a.uv[1] - b.uv[1]) });
+        error.tangentSignFlips += (a.tangent[3] < 0.0f) != (b.tangent[3] < 0.0f);
+    }
+    return error;
+}
+}
@@ -0,0 +1,318 @@
+#include "SceneResources/VoxelBrickMap.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include "Utils/ThreadPool.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace
+{
+    constexpr size_t kBrickGrain = 64;
+    constexpr size_t kDenseBytesPerVoxel = 4 + 16 + 16 + 4 + 4; // occupancy, bound min/max, irradiance, VPL count
+
+    uint32_t PopCount(uint64_t value)
+    {
+#ifdef _MSC_VER
+        return static_cast<uint32_t>(__popcnt64(value));
+#else
+        return static_cast<uint32_t>(__builtin_popcountll(value));
+#endif
+    }
+
+    // `width` <= 8 occupancy bits from flatId on, which may straddle two words.
+    uint64_t RowBits(const std::vector<uint64_t>& occupancy, size_t flatId, size_t width)
+    {
+        const size_t shift = flatId & 63;
+        uint64_t bits = occupancy[flatId >> 6] >> shift;
+        if (shift + width > 64)
+            bits |= occupancy[(flatId >> 6) + 1] << (64 - shift);
+        return bits & ((uint64_t(1) << width) - 1);
+    }
+
+    uint32_t LowestBit(uint64_t value)
+    {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanForward64(&index, value);
+        return index;
+#else
+        return static_cast<uint32_t>(__builtin_ctzll(value));
+#endif
+    }
+
+    // pcg_hash, as the shaders seed their RNG.
+    uint32_t Pcg(uint32_t& state)
+    {
+        state = state * 747796405u + 2891336453u;
+        const uint32_t word = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+        return (word >> 22u) ^ word;
+    }
+
+    double NanosecondsPer(std::chrono::high_resolution_clock::time_point start, size_t count)
+    {
+        const double ns = std::chrono::duration<double, std::nano>(std::chrono::high_resolution_clock::now() - start).count();
+        return count ? ns / static_cast<double>(count) : 0.0;
+    }
+}
+
+uint32_t VoxelBrickMap::GetClearValue(Channel channel)
+{
+    // bakeClear.hlsl for the bounds; the frame clear zeroes the accumulators.
+    return channel <= BoundMinZ ? 0xffffffffu : 0u;
+}
+
+bool VoxelBrickMap::Build(const VoxelBake& bake)
+{
+    const auto start = std::chrono::high_resolution_clock::now();
+    *this = VoxelBrickMap();
+
+    const uint32_t dim = bake.grid.gridDim;
+    const size_t cellCount = bake.GetCellCount();
+    if (dim == 0 || bake.occupancy.size() != (cellCount + 63) / 64 || bake.bounds.size() != bake.cells.size() * 6)
+        return false;
+
+    m_gridDim = dim;
+    m_bricksPerAxis = (dim + BRICK_DIM - 1) / BRICK_DIM;
+    const size_t bpa = m_bricksPerAxis;
+    const size_t brickCount = bpa * bpa * bpa;
+
+    // Each brick's 512 occupancy bits, a byte per row of 8 voxels along x.
+    // Edge bricks of a grid that is not a multiple of 8 are padded: rows and
+    // voxels past the grid stay empty.
+    std::vector<uint64_t> masks(brickCount * 8, 0);
+    ThreadPool::Get().ParallelForRange(brickCount, kBrickGrain, [&](size_t begin, size_t end)
+    {
+        for (size_t b = begin; b < end; ++b)
+        {
+            const size_t x = (b % bpa) * BRICK_DIM;
+            const size_t y = (b / bpa % bpa) * BRICK_DIM;
+            const size_t z = (b / (bpa * bpa)) * BRICK_DIM;
+            const size_t width = std::min<size_t>(BRICK_DIM, dim - x);
+            for (size_t lz = 0; lz < BRICK_DIM && z + lz < dim; ++lz)
+            {
+                uint64_t word = 0;
+                for (size_t ly = 0; ly < BRICK_DIM && y + ly < dim; ++ly)
+                {
+                    const size_t flatId = x + (y + ly) * dim + (z + lz) * dim * dim;
+                    word |= RowBits(bake.occupancy, flatId, width) << (ly * 8);
+                }
+                masks[b * 8 + lz] = word;
+            }
+        }
+    });
+
+    // Pool slots in brick order, so the pool walks the grid like the dense layout.
+    m_indirection.assign(brickCount, EMPTY_BRICK);
+    std::vector<uint32_t> allocated;
+    for (size_t b = 0; b < brickCount; ++b)
+    {
+        const uint64_t* mask = &masks[b * 8];
+        if (std::any_of(mask, mask + 8, [](uint64_t word) { return word != 0; }))
+        {
+            m_indirection[b] = static_cast<uint32_t>(allocated.size());
+            allocated.push_back(static_cast<uint32_t>(b));
+        }
+    }
+
+    // Rank of each occupancy word: the index of its first cell in bake.cells.
+    std::vector<uint32_t> rank(bake.occupancy.size());
+    uint32_t occupied = 0;
+    for (size_t w = 0; w < bake.occupancy.size(); ++w)
+    {
+        rank[w] = occupied;
+        occupied += PopCount(bake.occupancy[w]);
+    }
+
+    m_brickOccupancy.resize(allocated.size() * 8);
+    m_pool.resize(allocated.size() * ChannelCount * BRICK_VOXELS);
+    ThreadPool::Get().ParallelForRange(allocated.size(), kBrickGrain, [&](size_t begin, size_t end)
+    {
+        for (size_t slot = begin; slot < end; ++slot)
+        {
+            const size_t b = allocated[slot];
+            std::copy(&masks[b * 8], &masks[b * 8] + 8, &m_brickOccupancy[slot * 8]);
+            for (uint32_t c = 0; c < ChannelCount; ++c)
+            {
+                uint32_t* channel = &m_pool[PoolOffset(static_cast<uint32_t>(slot), static_cast<Channel>(c))];
+                std::fill(channel, channel + BRICK_VOXELS, GetClearValue(static_cast<Channel>(c)));
+            }
+
+            const size_t x = (b % bpa) * BRICK_DIM;
+            const size_t y = (b / bpa % bpa) * BRICK_DIM;
+            const size_t z = (b / (bpa * bpa)) * BRICK_DIM;
+            for (uint32_t word = 0; word < 8; ++word)
+            {
+                for (uint64_t bits = masks[b * 8 + word]; bits; bits &= bits - 1)
+                {
+                    const uint32_t local = word * 64 + LowestBit(bits);
+                    const size_t flatId = (x + (local & 7u)) + (y + ((local >> 3) & 7u)) * dim + (z + (local >> 6)) * dim * dim;
+                    const uint64_t below = bake.occupancy[flatId >> 6] & ((uint64_t(1) << (flatId & 63)) - 1);
+                    const size_t cell = rank[flatId >> 6] + PopCount(below);
+                    for (uint32_t c = 0; c < 6; ++c)
+                        m_pool[PoolOffset(static_cast<uint32_t>(slot), static_cast<Channel>(c)) + local] = bake.bounds[cell * 6 + c];
+                }
+            }
+        }
+    });
+
+    // Occupancy pyramid over the brick grid, down to a single node.
+    size_t levelDim = bpa;
+    std::vector<uint64_t> level((brickCount + 63) / 64, 0);
+    for (uint32_t b : allocated)
+        level[b >> 6] |= uint64_t(1) << (b & 63);
+    m_levels.push_back(std::move(level));
+    m_levelDims.push_back(static_cast<uint32_t>(levelDim));
+    while (levelDim > 1)
+    {
+        const size_t parentDim = (levelDim + 1) / 2;
+        std::vector<uint64_t> parent((parentDim * parentDim * parentDim + 63) / 64, 0);
+        const std::vector<uint64_t>& child = m_levels.back();
+        for (size_t w = 0; w < child.size(); ++w)
+        {
+            for (uint64_t bits = child[w]; bits; bits &= bits - 1)
+            {
+                const size_t node = w * 64 + LowestBit(bits);
+                const size_t px = (node % levelDim) / 2;
+                const size_t py = (node / levelDim % levelDim) / 2;
+                const size_t pz = (node / (levelDim * levelDim)) / 2;
+                const size_t p = px + (py + pz * parentDim) * parentDim;
+                parent[p >> 6] |= uint64_t(1) << (p & 63);
+            }
+        }
+        m_levels.push_back(std::move(parent));
+        m_levelDims.push_back(static_cast<uint32_t>(parentDim));
+        levelDim = parentDim;
+    }
+
+    m_stats.brickCount = brickCount;
+    m_stats.allocatedBricks = allocated.size();
+    m_stats.occupiedVoxels = occupied;
+    m_stats.indirectionBytes = m_indirection.size() * sizeof(uint32_t);
+    for (const std::vector<uint64_t>& bits : m_levels)
+        m_stats.hierarchyBytes += bits.size() * sizeof(uint64_t);
+    m_stats.poolBytes = m_brickOccupancy.size() * sizeof(uint64_t) + m_pool.size() * sizeof(uint32_t);
+    m_stats.denseBytes = cellCount * kDenseBytesPerVoxel;
+    m_stats.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    return true;
+}
+
+void VoxelBrickMap::ClearAccumulators()
+{
+    const size_t brickCount = m_brickOccupancy.size() / 8;
+    ThreadPool::Get().ParallelForRange(brickCount, kBrickGrain, [&](size_t begin, size_t end)
+    {
+        for (size_t slot = begin; slot < end; ++slot)
+        {
+            uint32_t* first = &m_pool[PoolOffset(static_cast<uint32_t>(slot), Irradiance)];
+            std::fill(first, first + 2 * BRICK_VOXELS, 0u);
+        }
+    });
+}
+
+void VoxelBrickMap::ExpandChannel(Channel channel, std::vector<uint32_t>& values) const
+{
+    const size_t dim = m_gridDim;
+    values.assign(dim * dim * dim, GetClearValue(channel));
+    const size_t bpa = m_bricksPerAxis;
+    for (size_t b = 0; b < m_indirection.size(); ++b)
+    {
+        if (m_indirection[b] == EMPTY_BRICK)
+            continue;
+        const uint32_t* source = &m_pool[PoolOffset(m_indirection[b], channel)];
+        const size_t x = (b % bpa) * BRICK_DIM;
+        const size_t y = (b / bpa % bpa) * BRICK_DIM;
+        const size_t z = (b / (bpa * bpa)) * BRICK_DIM;
+        const size_t width = std::min<size_t>(BRICK_DIM, dim - x);
+        for (size_t lz = 0; lz < BRICK_DIM && z + lz < dim; ++lz)
+            for (size_t ly = 0; ly < BRICK_DIM && y + ly < dim; ++ly)
+                std::copy(source + (lz * 64 + ly * 8), source + (lz * 64 + ly * 8) + width, &values[x + (y + ly) * dim + (z + lz) * dim * dim]);
+    }
+}
+
+VoxelLookupBenchmark MeasureVoxelLookups(const VoxelBake& bake, const VoxelBrickMap& map, size_t queries, uint32_t seed)
+{
+    VoxelLookupBenchmark result;
+    const uint32_t dim = bake.grid.gridDim;
+    if (dim == 0 || map.GetGridDim() != dim || queries == 0)
+        return result;
+
+    std::vector<uint32_t> flatIds(queries);
+    uint32_t state = seed;
+    for (size_t i = 0; i < queries; ++i)
+    {
+        if ((i & 1) && !bake.cells.empty())
+            flatIds[i] = bake.cells[Pcg(state) % bake.cells.size()];
+        else
+        {
+            const uint64_t high = Pcg(state);
+            flatIds[i] = static_cast<uint32_t>((high << 32 | Pcg(state)) % bake.GetCellCount());
+        }
+    }
+    std::vector<uint32_t> coords(queries * 3);
+    for (size_t i = 0; i < queries; ++i)
+    {
+        coords[i * 3] = flatIds[i] % dim;
+        coords[i * 3 + 1] = flatIds[i] / dim % dim;
+        coords[i * 3 + 2] = flatIds[i] / (dim * dim);
+    }
+    result.queries = queries;
+
+    // Agreement first, outside the timed loops.
+    std::vector<uint32_t> boundMin;
+    std::vector<uint32_t> boundMax;
+    bake.ExpandBounds(boundMin, boundMax);
+    for (size_t i = 0; i < queries; ++i)
+    {
+        const uint32_t x = coords[i * 3], y = coords[i * 3 + 1], z = coords[i * 3 + 2];
+        bool same = bake.IsOccupied(flatIds[i]) == map.IsOccupied(x, y, z);
+        for (uint32_t c = 0; c < 3; ++c)
+        {
+            same &= boundMin[static_cast<size_t>(flatIds[i]) * 4 + c] == map.Load(x, y, z, static_cast<VoxelBrickMap::Channel>(VoxelBrickMap::BoundMinX + c));
+            same &= boundMax[static_cast<size_t>(flatIds[i]) * 4 + c] == map.Load(x, y, z, static_cast<VoxelBrickMap::Channel>(VoxelBrickMap::BoundMaxX + c));
+        }
+        result.mismatches += same ? 0 : 1;
+    }
+
+    // Both sides start from voxel coordinates, as a shader does.
+    volatile uint32_t sink = 0;
+    uint32_t sum = 0;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < queries; ++i)
+    {
+        const size_t flatId = coords[i * 3] + (coords[i * 3 + 1] + static_cast<size_t>(coords[i * 3 + 2]) * dim) * dim;
+        sum += bake.IsOccupied(static_cast<uint32_t>(flatId));
+    }
+    result.denseOccupancyNs = NanosecondsPer(start, queries);
+
+    start = std::chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < queries; ++i)
+        sum += map.IsOccupied(coords[i * 3], coords[i * 3 + 1], coords[i * 3 + 2]);
+    result.sparseOccupancyNs = NanosecondsPer(start, queries);
+
+    start = std::chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < queries; ++i)
+    {
+        const size_t flatId = coords[i * 3] + (coords[i * 3 + 1] + static_cast<size_t>(coords[i * 3 + 2]) * dim) * dim;
+        for (uint32_t c = 0; c < 3; ++c)
+            sum += boundMin[flatId * 4 + c] ^ boundMax[flatId * 4 + c];
+    }
+    result.denseBoundsNs = NanosecondsPer(start, queries);
+
+    start = std::chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < queries; ++i)
+    {
+        const uint32_t x = coords[i * 3], y = coords[i * 3 + 1], z = coords[i * 3 + 2];
+        for (uint32_t c = 0; c < 3; ++c)
+            sum += map.Load(x, y, z, static_cast<VoxelBrickMap::Channel>(VoxelBrickMap::BoundMinX + c))
+                ^ map.Load(x, y, z, static_cast<VoxelBrickMap::Channel>(VoxelBrickMap::BoundMaxX + c));
+    }
+    result.sparseBoundsNs = NanosecondsPer(start, queries);
+
+    sink = sum;
+    (void)sink;
+    return result;
+}
@@ -0,0 +1,480 @@
+#include "SceneResources/VoxelClustering.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <numeric>
+
+#include "Utils/ThreadPool.h"
+
+// The AVX2 kernel is compiled on every x86-64 build and picked at run time,
+// so it does not need /arch:AVX2 or -mavx2 for the whole project.
+#if defined(__x86_64__) || defined(_M_X64)
+#define VOXEL_CLUSTERING_AVX2 1
+#include <immintrin.h>
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#if defined(VOXEL_CLUSTERING_AVX2) && !defined(_MSC_VER)
+#define VOXEL_CLUSTERING_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define VOXEL_CLUSTERING_TARGET_AVX2
+#endif
+
+namespace
+{
+    constexpr size_t kVoxelGrain = 4096;
+    constexpr uint32_t kWarpSize = 32;
+    constexpr float kInitialNearestDistance = 100000000.0f; // SeedClusterCenters
+    constexpr float kAssignNearestDistance = 999999.9999f;  // AssignVoxelClusters
+
+    using Clock = std::chrono::high_resolution_clock;
+
+    double MillisecondsSince(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    uint32_t PopCount(uint64_t value)
+    {
+#ifdef _MSC_VER
+        return static_cast<uint32_t>(__popcnt64(value));
+#else
+        return static_cast<uint32_t>(__builtin_popcountll(value));
+#endif
+    }
+
+#ifdef VOXEL_CLUSTERING_AVX2
+    // AVX2 in the CPU and the YMM state enabled by the OS.
+    bool DetectAvx2()
+    {
+#ifdef _MSC_VER
+        int info[4];
+        __cpuid(info, 0);
+        if (info[0] < 7)
+            return false;
+        __cpuid(info, 1);
+        const bool osxsave = (info[2] & (1 << 27)) != 0;
+        const bool avx = (info[2] & (1 << 28)) != 0;
+        if (!osxsave || !avx || (_xgetbv(0) & 6) != 6)
+            return false;
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+#else
+        return __builtin_cpu_supports("avx2");
+#endif
+    }
+
+    // Two fingerprints per register; nibble popcount through a byte shuffle,
+    // then byte sums per 64-bit lane (W. Mula's method). Handles an even
+    // number of fingerprints and returns how many.
+    VOXEL_CLUSTERING_TARGET_AVX2 uint32_t HammingDistancesAvx2(const VoxelFingerprint& fingerprint, const VoxelFingerprint* others, uint32_t count,
+        uint32_t* distances)
+    {
+        const __m256i self = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(fingerprint.words)));
+        const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+        const __m256i lowNibble = _mm256_set1_epi8(0x0f);
+        uint32_t i = 0;
+        for (; i + 2 <= count; i += 2)
+        {
+            const __m256i diff = _mm256_xor_si256(self, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(others + i)));
+            const __m256i low = _mm256_shuffle_epi8(lookup, _mm256_and_si256(diff, lowNibble));
+            const __m256i high = _mm256_shuffle_epi8(lookup, _mm256_and_si256(_mm256_srli_epi16(diff, 4), lowNibble));
+            const __m256i sums = _mm256_sad_epu8(_mm256_add_epi8(low, high), _mm256_setzero_si256());
+            const __m256i pairs = _mm256_add_epi64(sums, _mm256_srli_si256(sums, 8));
+            distances[i] = static_cast<uint32_t>(_mm256_extract_epi32(pairs, 0));
+            distances[i + 1] = static_cast<uint32_t>(_mm256_extract_epi32(pairs, 4));
+        }
+        return i;
+    }
+#endif
+
+    // Random.hlsl pcg_hash.
+    uint32_t PcgHash(uint32_t input)
+    {
+        const uint32_t state = input * 747796405u + 2891336453u;
+        const uint32_t word = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+        return (word >> 22u) ^ word;
+    }
+
+    // vxpgCluster.hlsl NextRandom, in float as the shader computes it.
+    float NextRandom(uint32_t& state)
+    {
+        state = PcgHash(state);
+        return static_cast<float>(state) * (1.0f / 4294967296.0f);
+    }
+
+    // Double precision for the samplers' running sums.
+    double NextUnit(uint32_t& state)
+    {
+        state = PcgHash(state);
+        return static_cast<double>(state) * (1.0 / 4294967296.0);
+    }
+
+    VoxelClusterCenter MakeCenter(const VoxelClusterInput& input, uint32_t compactId)
+    {
+        VoxelClusterCenter center;
+        center.fingerprint = input.fingerprints[compactId];
+        const uint32_t voxelId = input.compactIds[compactId];
+        center.position[0] = static_cast<float>(voxelId % input.gridDim);
+        center.position[1] = static_cast<float>((voxelId / input.gridDim) % input.gridDim);
+        center.position[2] = static_cast<float>(voxelId / (input.gridDim * input.gridDim));
+        center.intensity = input.premulIrradiance[compactId];
+        return center;
+    }
+
+    // ClusterDistance with the Hamming term already counted.
+    float Distance(uint32_t hamming, const VoxelClusterCenter& a, const float position[3], float intensity, const VoxelClusterSettings& settings)
+    {
+        float result = static_cast<float>(hamming);
+        if (settings.positionWeight != 0.0f)
+        {
+            const float dx = a.position[0] - position[0];
+            const float dy = a.position[1] - position[1];
+            const float dz = a.position[2] - position[2];
+            result += settings.positionWeight * std::sqrt(dx * dx + dy * dy + dz * dz);
+        }
+        return result + settings.intensityWeight * std::fabs(a.intensity - intensity);
+    }
+
+    float Distance(const VoxelClusterCenter& a, const VoxelClusterCenter& b, const VoxelClusterSettings& settings)
+    {
+        return Distance(VoxelClustering::Hamming(a.fingerprint, b.fingerprint), a, b.position, b.intensity, settings);
+    }
+
+    // Index i with prefix(weights, i) <= target < prefix(weights, i + 1), over
+    // per-range partial sums so the draw does not depend on the thread count.
+    size_t SampleWeighted(const std::vector<double>& weights, const std::vector<double>& rangeSums, size_t grain, double target)
+    {
+        size_t range = 0;
+        while (range + 1 < rangeSums.size() && target >= rangeSums[range])
+            target -= rangeSums[range++];
+        const size_t end = std::min(weights.size(), (range + 1) * grain);
+        size_t last = range * grain;
+        for (size_t i = range * grain; i < end; ++i)
+        {
+            if (weights[i] <= 0.0)
+                continue;
+            last = i;
+            if (target < weights[i])
+                return i;
+            target -= weights[i];
+        }
+        return last; // rounding left target past the end: the last weighted entry
+    }
+
+    // SeedClusterCenters over the shader's candidate draft.
+    void SeedLikeShader(const VoxelClusterInput& input, const VoxelClusterSettings& settings, VoxelClusters& clusters)
+    {
+        const uint32_t candidateCount = std::max(settings.candidateCount, 1u);
+        std::vector<uint32_t> candidates(candidateCount);
+        for (uint32_t t = 0; t < candidateCount; ++t)
+        {
+            uint32_t state = PcgHash((t * 9781u + settings.seed * 26699u) | 1u);
+            const int drafted = static_cast<int>(NextRandom(state) * static_cast<float>(input.count));
+            candidates[t] = static_cast<uint32_t>(std::clamp(drafted, 0, static_cast<int>(input.count) - 1));
+        }
+
+        const VoxelClusterCenter first = MakeCenter(input, candidates[0]);
+        clusters.centers.push_back(first);
+        clusters.seedCompactIds.push_back(static_cast<int32_t>(candidates[0]));
+
+        std::vector<VoxelClusterCenter> drafts(candidateCount);
+        for (uint32_t t = 0; t < candidateCount; ++t)
+            drafts[t] = MakeCenter(input, candidates[t]);
+
+        // Only the fingerprint of the compared-against centre is refreshed.
+        VoxelClusterCenter current = first;
+        std::vector<double> nearest(candidateCount, kInitialNearestDistance);
+        std::vector<double> weights(candidateCount);
+        // Warp 0's sum is zeroed at the top level of the shader's tree.
+        const uint32_t begin = candidateCount > kWarpSize ? kWarpSize : 0;
+        uint32_t rng = PcgHash(settings.seed ^ 0x9e3779b9u);
+        for (uint32_t seedId = 1; seedId < settings.clusterCount; ++seedId)
+        {
+            double total = 0.0;
+            for (uint32_t t = 0; t < candidateCount; ++t)
+            {
+                nearest[t] = std::min(nearest[t], static_cast<double>(Distance(drafts[t], current, settings)));
+                weights[t] = nearest[t] * nearest[t];
+                total += t >= begin ? weights[t] : 0.0;
+            }
+
+            uint32_t picked = 0;
+            if (total > 0.0)
+            {
+                double target = NextUnit(rng) * total;
+                picked = begin;
+                for (uint32_t t = begin; t < candidateCount; ++t)
+                {
+                    if (weights[t] <= 0.0)
+                        continue;
+                    picked = t;
+                    if (target < weights[t])
+                        break;
+                    target -= weights[t];
+                }
+            }
+            else
+            {
+                picked = static_cast<uint32_t>(NextUnit(rng) * candidateCount);
+            }
+
+            clusters.centers.push_back(drafts[picked]);
+            clusters.seedCompactIds.push_back(static_cast<int32_t>(candidates[picked]));
+            current.fingerprint = drafts[picked].fingerprint;
+        }
+    }
+
+    // Textbook k-means++ over `pool` (compact ids), or every voxel when empty.
+    void SeedPlusPlus(const VoxelClusterInput& input, const VoxelClusterSettings& settings, const std::vector<uint32_t>& pool, uint32_t& rng,
+        VoxelClusters& clusters)
+    {
+        const size_t count = pool.empty() ? input.count : pool.size();
+        const auto compactIdAt = [&](size_t i) { return pool.empty() ? static_cast<uint32_t>(i) : pool[i]; };
+        const size_t rangeCount = (count + kVoxelGrain - 1) / kVoxelGrain;
+
+        std::vector<double> nearest(count, static_cast<double>(kInitialNearestDistance));
+        std::vector<double> weights(count);
+        std::vector<double> rangeSums(rangeCount);
+
+        size_t picked = std::min(static_cast<size_t>(NextUnit(rng) * count), count - 1);
+        for (uint32_t seedId = 0; seedId < settings.clusterCount; ++seedId)
+        {
+            const VoxelClusterCenter center = MakeCenter(input, compactIdAt(picked));
+            clusters.centers.push_back(center);
+            clusters.seedCompactIds.push_back(static_cast<int32_t>(compactIdAt(picked)));
+            if (seedId + 1 == settings.clusterCount)
+                break;
+
+            ThreadPool::Get().ParallelForRange(count, kVoxelGrain, [&](size_t begin, size_t end)
+            {
+                double sum = 0.0;
+                for (size_t i = begin; i < end; ++i)
+                {
+                    const VoxelClusterCenter voxel = MakeCenter(input, compactIdAt(i));
+                    nearest[i] = std::min(nearest[i], static_cast<double>(Distance(voxel, center, settings)));
+                    weights[i] = nearest[i] * nearest[i];
+                    sum += weights[i];
+                }
+                rangeSums[begin / kVoxelGrain] = sum;
+            });
+
+            const double total = std::accumulate(rangeSums.begin(), rangeSums.end(), 0.0);
+            if (total > 0.0)
+                picked = SampleWeighted(weights, rangeSums, kVoxelGrain, NextUnit(rng) * total);
+            else
+                picked = std::min(static_cast<size_t>(NextUnit(rng) * count), count - 1);
+        }
+    }
+
+    // Algorithm R over the compact ids in one pass.
+    std::vector<uint32_t> ReservoirSample(uint32_t count, uint32_t sampleCount, uint32_t& rng)
+    {
+        std::vector<uint32_t> reservoir;
+        reservoir.reserve(std::min(count, sampleCount));
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            if (i < sampleCount)
+            {
+                reservoir.push_back(i);
+                continue;
+            }
+            const uint64_t slot = static_cast<uint64_t>(NextUnit(rng) * (static_cast<double>(i) + 1.0));
+            if (slot < sampleCount)
+                reservoir[slot] = i;
+        }
+        return reservoir;
+    }
+
+    // Per-bit majority fingerprint (ties keep the previous bit), median
+    // intensity and mean position of each cluster's members. Empty clusters
+    // keep their centre.
+    void UpdateCenters(const VoxelClusterInput& input, const std::vector<int32_t>& assignments, std::vector<VoxelClusterCenter>& centers)
+    {
+        const size_t k = centers.size();
+        const size_t rangeCount = (static_cast<size_t>(input.count) + kVoxelGrain - 1) / kVoxelGrain;
+        std::vector<uint32_t> bitCounts(rangeCount * k * 128, 0);
+        std::vector<double> positionSums(rangeCount * k * 3, 0.0);
+        ThreadPool::Get().ParallelForRange(input.count, kVoxelGrain, [&](size_t begin, size_t end)
+        {
+            const size_t range = begin / kVoxelGrain;
+            for (size_t i = begin; i < end; ++i)
+            {
+                const int32_t cluster = assignments[i];
+                if (cluster < 0)
+                    continue;
+                uint32_t* counts = &bitCounts[(range * k + cluster) * 128];
+                const VoxelFingerprint& fingerprint = input.fingerprints[i];
+                for (uint32_t w = 0; w < 4; ++w)
+                    for (uint32_t bits = fingerprint.words[w]; bits; bits &= bits - 1)
+                        ++counts[w * 32 + PopCount((bits & (0u - bits)) - 1)];
+                const VoxelClusterCenter voxel = MakeCenter(input, static_cast<uint32_t>(i));
+                for (int a = 0; a < 3; ++a)
+                    positionSums[(range * k + cluster) * 3 + a] += voxel.position[a];
+            }
+        });
+
+        // Members grouped by cluster for the medians.
+        std::vector<uint32_t> memberCounts(k + 1, 0);
+        for (int32_t cluster : assignments)
+            if (cluster >= 0)
+                ++memberCounts[cluster + 1];
+        std::partial_sum(memberCounts.begin(), memberCounts.end(), memberCounts.begin());
+        std::vector<float> intensities(memberCounts[k]);
+        std::vector<uint32_t> cursor(memberCounts.begin(), memberCounts.end() - 1);
+        for (uint32_t i = 0; i < input.count; ++i)
+            if (assignments[i] >= 0)
+                intensities[cursor[assignments[i]]++] = input.premulIrradiance[i];
+
+        ThreadPool::Get().ParallelFor(k, [&](size_t c)
+        {
+            const uint32_t members = memberCounts[c + 1] - memberCounts[c];
+            if (members == 0)
+                return;
+            VoxelClusterCenter& center = centers[c];
+            for (uint32_t bit = 0; bit < 128; ++bit)
+            {
+                uint32_t ones = 0;
+                for (size_t range = 0; range < rangeCount; ++range)
+                    ones += bitCounts[(range * k + c) * 128 + bit];
+                uint32_t& word = center.fingerprint.words[bit / 32];
+                const uint32_t mask = 1u << (bit % 32);
+                if (2 * ones > members)
+                    word |= mask;
+                else if (2 * ones < members)
+                    word &= ~mask;
+            }
+            for (int a = 0; a < 3; ++a)
+            {
+                double sum = 0.0;
+                for (size_t range = 0; range < rangeCount; ++range)
+                    sum += positionSums[(range * k + c) * 3 + a];
+                center.position[a] = static_cast<float>(sum / members);
+            }
+            float* first = intensities.data() + memberCounts[c];
+            float* middle = first + members / 2;
+            std::nth_element(first, middle, first + members);
+            center.intensity = *middle;
+        });
+    }
+}
+
+uint32_t VoxelClustering::Hamming(const VoxelFingerprint& a, const VoxelFingerprint& b)
+{
+    const uint64_t low = (static_cast<uint64_t>(a.words[1] ^ b.words[1]) << 32) | (a.words[0] ^ b.words[0]);
+    const uint64_t high = (static_cast<uint64_t>(a.words[3] ^ b.words[3]) << 32) | (a.words[2] ^ b.words[2]);
+    return PopCount(low) + PopCount(high);
+}
+
+bool VoxelClustering::HammingDistancesUseAvx2()
+{
+#ifdef VOXEL_CLUSTERING_AVX2
+    static const bool supported = DetectAvx2();
+    return supported;
+#else
+    return false;
+#endif
+}
+
+void VoxelClustering::HammingDistances(const VoxelFingerprint& fingerprint, const VoxelFingerprint* others, uint32_t count, uint32_t* distances)
+{
+    uint32_t i = 0;
+#ifdef VOXEL_CLUSTERING_AVX2
+    if (HammingDistancesUseAvx2())
+        i = HammingDistancesAvx2(fingerprint, others, count, distances);
+#endif
+    for (; i < count; ++i)
+        distances[i] = Hamming(fingerprint, others[i]);
+}
+
+double VoxelClustering::Assign(const VoxelClusterInput& input, const VoxelClusterSettings& settings, const std::vector<VoxelClusterCenter>& centers,
+    std::vector<int32_t>& assignments)
+{
+    const uint32_t k = static_cast<uint32_t>(centers.size());
+    std::vector<VoxelFingerprint> centerFingerprints(k);
+    for (uint32_t c = 0; c < k; ++c)
+        centerFingerprints[c] = centers[c].fingerprint;
+
+    assignments.resize(input.count);
+    const size_t rangeCount = (static_cast<size_t>(input.count) + kVoxelGrain - 1) / kVoxelGrain;
+    std::vector<double> rangeCosts(rangeCount, 0.0);
+    ThreadPool::Get().ParallelForRange(input.count, kVoxelGrain, [&](size_t begin, size_t end)
+    {
+        std::vector<uint32_t> hamming(k);
+        double cost = 0.0;
+        for (size_t i = begin; i < end; ++i)
+        {
+            const VoxelClusterCenter voxel = MakeCenter(input, static_cast<uint32_t>(i));
+            HammingDistances(voxel.fingerprint, centerFingerprints.data(), k, hamming.data());
+            int32_t nearestCluster = -1;
+            float nearestDistance = kAssignNearestDistance;
+            for (uint32_t c = 0; c < k; ++c)
+            {
+                const float d = Distance(hamming[c], centers[c], voxel.position, voxel.intensity, settings);
+                if (d < nearestDistance)
+                {
+                    nearestDistance = d;
+                    nearestCluster = static_cast<int32_t>(c);
+                }
+            }
+            assignments[i] = nearestCluster;
+            cost += nearestCluster >= 0 ? nearestDistance : 0.0f;
+        }
+        rangeCosts[begin / kVoxelGrain] = cost;
+    });
+    return std::accumulate(rangeCosts.begin(), rangeCosts.end(), 0.0);
+}
+
+VoxelClusters VoxelClustering::Cluster(const VoxelClusterInput& input, const VoxelClusterSettings& settings)
+{
+    VoxelClusters clusters;
+    if (input.count == 0 || settings.clusterCount == 0 || input.gridDim == 0)
+        return clusters;
+
+    auto start = Clock::now();
+    uint32_t rng = PcgHash(settings.seed * 26699u + 1u);
+    switch (settings.seeding)
+    {
+    case VoxelSeeding::Shader:
+        SeedLikeShader(input, settings, clusters);
+        break;
+    case VoxelSeeding::Exact:
+        SeedPlusPlus(input, settings, {}, rng, clusters);
+        break;
+    case VoxelSeeding::Streaming:
+        SeedPlusPlus(input, settings, ReservoirSample(input.count, std::max(settings.candidateCount, 1u), rng), rng, clusters);
+        break;
+    }
+    clusters.stats.seedMilliseconds = MillisecondsSince(start);
+
+    start = Clock::now();
+    clusters.stats.cost.push_back(Assign(input, settings, clusters.centers, clusters.assignments));
+    clusters.stats.assignMilliseconds = MillisecondsSince(start);
+
+    std::vector<int32_t> previous;
+    for (uint32_t iteration = 0; iteration < settings.lloydIterations; ++iteration)
+    {
+        start = Clock::now();
+        UpdateCenters(input, clusters.assignments, clusters.centers);
+        clusters.stats.updateMilliseconds += MillisecondsSince(start);
+
+        start = Clock::now();
+        previous.swap(clusters.assignments);
+        clusters.stats.cost.push_back(Assign(input, settings, clusters.centers, clusters.assignments));
+        clusters.stats.assignMilliseconds += MillisecondsSince(start);
+        ++clusters.stats.iterations;
+        if (previous == clusters.assignments)
+            break;
+    }
+
+    std::vector<bool> used(clusters.centers.size(), false);
+    for (int32_t cluster : clusters.assignments)
+        if (cluster >= 0)
+            used[cluster] = true;
+    clusters.stats.emptyClusters = static_cast<uint32_t>(std::count(used.begin(), used.end(), false));
+    return clusters;
+}
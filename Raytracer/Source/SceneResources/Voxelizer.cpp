@@ -0,0 +1,662 @@
+#include "SceneResources/Voxelizer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <system_error>
+
+#include "Constants.h"
+#include "Utils/MappedFile.h"
+#include "Utils/ThreadPool.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace
+{
+    constexpr size_t kTriangleGrain = 1024;
+    constexpr uint32_t kClearMin = 0xffffffffu; // bakeClear.hlsl
+    constexpr uint32_t kClearMax = 0u;
+    constexpr float kSubpixelSteps = 256.0f;    // D3D 16.8 fixed-point vertex snapping
+    constexpr int kMaxClipVertices = 9;
+    constexpr float kPlaneThicknessEpsilon = 0.00001f;
+
+    constexpr uint32_t kFileMagic = 0x42585642; // "BVXB"
+    constexpr uint32_t kFileVersion = 1;
+
+    struct BakeFileHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t sourceHash;
+        VoxelGridConstants grid;
+        uint32_t gridDim;
+        uint32_t flags; // 1 = useCompact, 2 = clipping
+        uint64_t occupiedCount;
+    };
+
+    struct Float3
+    {
+        float v[3];
+        float& operator[](int i) { return v[i]; }
+        float operator[](int i) const { return v[i]; }
+    };
+
+    struct WorldTriangle
+    {
+        Float3 p[3];
+    };
+
+    uint32_t PopCount(uint64_t value)
+    {
+#ifdef _MSC_VER
+        return static_cast<uint32_t>(__popcnt64(value));
+#else
+        return static_cast<uint32_t>(__builtin_popcountll(value));
+#endif
+    }
+
+    uint32_t LowestBit(uint64_t value)
+    {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanForward64(&index, value);
+        return index;
+#else
+        return static_cast<uint32_t>(__builtin_ctzll(value));
+#endif
+    }
+
+    uint32_t FlagsOf(const VoxelBakeSettings& settings)
+    {
+        return (settings.useCompact ? 1u : 0u) | (settings.clipping ? 2u : 0u);
+    }
+
+    // HLSL saturate: NaN becomes 0.
+    float Saturate(float value)
+    {
+        return value > 0.0f ? (value < 1.0f ? value : 1.0f) : 0.0f;
+    }
+
+    // uint(saturate(x) * 4294967295.0f): the float product rounds to 2^32 at
+    // x = 1, which the GPU's float-to-uint conversion clamps.
+    uint32_t Quantize(float value)
+    {
+        const float scaled = Saturate(value) * 4294967295.0f;
+        return scaled >= 4294967295.0f ? 0xffffffffu : static_cast<uint32_t>(scaled);
+    }
+
+    void CollectCells(const std::vector<uint64_t>& occupancy, std::vector<uint32_t>& cells)
+    {
+        cells.clear();
+        for (size_t w = 0; w < occupancy.size(); ++w)
+            for (uint64_t bits = occupancy[w]; bits; bits &= bits - 1)
+                cells.push_back(static_cast<uint32_t>(w * 64 + LowestBit(bits)));
+    }
+
+    // Without useCompact every fragment injects the whole voxel cube.
+    void FillCubeBounds(size_t cellCount, std::vector<uint32_t>& bounds)
+    {
+        bounds.resize(cellCount * 6);
+        for (size_t i = 0; i < cellCount; ++i)
+        {
+            std::fill(&bounds[i * 6], &bounds[i * 6] + 3, Quantize(0.0f));
+            std::fill(&bounds[i * 6 + 3], &bounds[i * 6 + 3] + 3, Quantize(1.0f));
+        }
+    }
+
+    // TriangleClip.hlsl
+    int ClassifyAgainstPlane(int sign, int axis, const Float3& planeVertex, const Float3& vertex)
+    {
+        const float d = static_cast<float>(sign) * (vertex[axis] - planeVertex[axis]);
+        if (d > kPlaneThicknessEpsilon) return 1;
+        if (d < -kPlaneThicknessEpsilon) return -1;
+        return 0;
+    }
+
+    void ClipPolygonAgainstPlane(Float3 vertices[kMaxClipVertices], int& vertexCount, int sign, int axis, const Float3& planeVertex)
+    {
+        const int count = vertexCount;
+        if (count <= 1)
+            return;
+
+        Float3 clipped[kMaxClipVertices];
+        int k = 0;
+        bool allOnPlane = true;
+        const auto emit = [&](const Float3& vertex)
+        {
+            if (k < kMaxClipVertices)
+                clipped[k++] = vertex;
+        };
+
+        Float3 previous = vertices[count - 1];
+        int previousSide = ClassifyAgainstPlane(sign, axis, planeVertex, previous);
+        for (int j = 0; j < count; ++j)
+        {
+            const Float3 current = vertices[j];
+            const int currentSide = ClassifyAgainstPlane(sign, axis, planeVertex, current);
+            if (currentSide == 0)
+            {
+                if (previousSide != 0)
+                    emit(current);
+            }
+            else
+            {
+                allOnPlane = false;
+                if (previousSide == 0)
+                {
+                    if (k == 0 || std::memcmp(&clipped[k - 1], &previous, sizeof(Float3)) != 0)
+                        emit(previous);
+                }
+                else if ((currentSide < 0 && previousSide > 0) || (currentSide > 0 && previousSide < 0))
+                {
+                    const float alpha = (current[axis] - planeVertex[axis]) / (current[axis] - previous[axis]);
+                    Float3 crossing;
+                    for (int a = 0; a < 3; ++a)
+                        crossing[a] = current[a] + (previous[a] - current[a]) * alpha;
+                    emit(crossing);
+                }
+
+                if (currentSide > 0)
+                    emit(current);
+            }
+
+            previous = current;
+            previousSide = currentSide;
+        }
+
+        if (allOnPlane)
+            return;
+        vertexCount = k;
+        for (int j = 0; j < k; ++j)
+            vertices[j] = clipped[j];
+    }
+
+    void ClipTriangleAgainstAABB(Float3 vertices[kMaxClipVertices], int& vertexCount, const Float3& boxMin, const Float3& boxMax)
+    {
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            ClipPolygonAgainstPlane(vertices, vertexCount, 1, axis, boxMin);
+            ClipPolygonAgainstPlane(vertices, vertexCount, -1, axis, boxMax);
+        }
+    }
+
+    // voxelize.hlsl InjectTriangleVoxelBound, before the atomic merge.
+    void TriangleVoxelBound(const Float3 triangleVoxelSpace[3], const int voxelId[3], const VoxelBakeSettings& settings, uint32_t quantized[6])
+    {
+        Float3 voxelMin;
+        Float3 voxelMax;
+        for (int a = 0; a < 3; ++a)
+        {
+            voxelMin[a] = static_cast<float>(voxelId[a]);
+            voxelMax[a] = voxelMin[a] + 1.0f;
+        }
+
+        Float3 boundMin = voxelMin;
+        Float3 boundMax = voxelMax;
+        if (settings.useCompact)
+        {
+            int vertexCount = 3;
+            Float3 vertices[kMaxClipVertices];
+            vertices[0] = triangleVoxelSpace[0];
+            vertices[1] = triangleVoxelSpace[1];
+            vertices[2] = triangleVoxelSpace[2];
+            if (settings.clipping)
+                ClipTriangleAgainstAABB(vertices, vertexCount, voxelMin, voxelMax);
+
+            for (int a = 0; a < 3; ++a)
+            {
+                boundMin[a] = 99999.0f;
+                boundMax[a] = -99999.0f;
+            }
+            for (int i = 0; i < vertexCount; ++i)
+            {
+                for (int a = 0; a < 3; ++a)
+                {
+                    boundMin[a] = std::min(boundMin[a], vertices[i][a]);
+                    boundMax[a] = std::max(boundMax[a], vertices[i][a]);
+                }
+            }
+            for (int a = 0; a < 3; ++a)
+            {
+                boundMax[a] = std::max(std::min(boundMax[a], voxelMax[a]), voxelMin[a]);
+                boundMin[a] = std::min(std::max(boundMin[a], voxelMin[a]), voxelMax[a]);
+            }
+        }
+
+        for (int a = 0; a < 3; ++a)
+        {
+            quantized[a] = Quantize(boundMin[a] - voxelMin[a]);
+            quantized[3 + a] = Quantize(boundMax[a] - voxelMin[a]);
+        }
+    }
+
+    // The three fixed-axis draws of DispatchBake: fragment(voxelId, flatId,
+    // triangleVoxelSpace) for every conservatively covered pixel whose centre,
+    // moved onto the triangle plane, lands inside the grid.
+    template <typename FragmentFn>
+    void RasterizeTriangle(const WorldTriangle& triangle, const VoxelGridConstants& grid, FragmentFn&& fragment)
+    {
+        const int dim = static_cast<int>(grid.gridDim);
+        const float extent[3] = { grid.gridMax[0] - grid.gridMin[0], grid.gridMax[1] - grid.gridMin[1], grid.gridMax[2] - grid.gridMin[2] };
+
+        Float3 triangleVoxelSpace[3];
+        for (int k = 0; k < 3; ++k)
+            for (int a = 0; a < 3; ++a)
+                triangleVoxelSpace[k][a] = (triangle.p[k][a] - grid.gridMin[a]) / grid.voxelSize;
+
+        // ProjectForAxis: (y, z), (x, z), (x, y).
+        static constexpr int kPlaneAxes[3][2] = { { 1, 2 }, { 0, 2 }, { 0, 1 } };
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            const int ax = kPlaneAxes[axis][0];
+            const int ay = kPlaneAxes[axis][1];
+
+            // WorldToNdc, then the dim x dim viewport (y down), snapped to 1/256 pixel.
+            double x[3];
+            double y[3];
+            for (int k = 0; k < 3; ++k)
+            {
+                const float ndcX = (triangle.p[k][ax] - grid.gridMin[ax]) / extent[ax] * 2.0f - 1.0f;
+                const float ndcY = (triangle.p[k][ay] - grid.gridMin[ay]) / extent[ay] * 2.0f - 1.0f;
+                x[k] = std::nearbyint((ndcX + 1.0f) * 0.5f * static_cast<float>(dim) * kSubpixelSteps) / kSubpixelSteps;
+                y[k] = std::nearbyint((1.0f - ndcY) * 0.5f * static_cast<float>(dim) * kSubpixelSteps) / kSubpixelSteps;
+            }
+
+            // Exact on the snapped grid. Zero-area triangles are culled, as
+            // conservative rasterization does with degenerates.
+            const double area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+            if (area == 0.0 || !std::isfinite(area))
+                continue;
+            const double orientation = area > 0.0 ? 1.0 : -1.0;
+
+            const double minX = std::min({ x[0], x[1], x[2] });
+            const double maxX = std::max({ x[0], x[1], x[2] });
+            const double minY = std::min({ y[0], y[1], y[2] });
+            const double maxY = std::max({ y[0], y[1], y[2] });
+            const int px0 = std::max(static_cast<int>(std::ceil(minX)) - 1, 0);
+            const int px1 = std::min(static_cast<int>(std::floor(maxX)), dim - 1);
+            const int py0 = std::max(static_cast<int>(std::ceil(minY)) - 1, 0);
+            const int py1 = std::min(static_cast<int>(std::floor(maxY)), dim - 1);
+
+            // Edge k runs from vertex k to k + 1 and is >= 0 inside; a pixel
+            // overlaps the triangle when every edge is >= 0 at its best corner.
+            double edgeA[3];
+            double edgeB[3];
+            double edgeC[3];
+            double reach[3];
+            for (int k = 0; k < 3; ++k)
+            {
+                const int next = (k + 1) % 3;
+                edgeA[k] = -(y[next] - y[k]) * orientation;
+                edgeB[k] = (x[next] - x[k]) * orientation;
+                edgeC[k] = -(edgeA[k] * x[k] + edgeB[k] * y[k]);
+                reach[k] = 0.5 * (std::abs(edgeA[k]) + std::abs(edgeB[k]));
+            }
+            const double inverseArea = 1.0 / (area * orientation);
+
+            for (int py = py0; py <= py1; ++py)
+            {
+                const double cy = py + 0.5;
+                for (int px = px0; px <= px1; ++px)
+                {
+                    const double cx = px + 0.5;
+                    double e[3];
+                    bool covered = true;
+                    for (int k = 0; k < 3 && covered; ++k)
+                    {
+                        e[k] = edgeA[k] * cx + edgeB[k] * cy + edgeC[k];
+                        covered = e[k] + reach[k] >= 0.0;
+                    }
+                    if (!covered)
+                        continue;
+
+                    // SV_Barycentrics at the pixel centre (extrapolated when it
+                    // lies outside the triangle): vertex k weighs the edge opposite it.
+                    const float b0 = static_cast<float>(e[1] * inverseArea);
+                    const float b1 = static_cast<float>(e[2] * inverseArea);
+                    const float b2 = static_cast<float>(e[0] * inverseArea);
+
+                    int voxelId[3];
+                    bool inBounds = true;
+                    for (int a = 0; a < 3; ++a)
+                    {
+                        const float posW = triangle.p[0][a] * b0 + triangle.p[1][a] * b1 + triangle.p[2][a] * b2;
+                        voxelId[a] = static_cast<int>(std::floor((posW - grid.gridMin[a]) / grid.voxelSize));
+                        inBounds = inBounds && voxelId[a] >= 0 && voxelId[a] < dim;
+                    }
+                    if (!inBounds)
+                        continue;
+
+                    const uint32_t flatId = static_cast<uint32_t>(voxelId[0]) + static_cast<uint32_t>(voxelId[1]) * grid.gridDim + static_cast<uint32_t>(voxelId[2]) * grid.gridDim * grid.gridDim;
+                    fragment(voxelId, flatId, triangleVoxelSpace);
+                }
+            }
+        }
+    }
+
+    std::vector<WorldTriangle> TransformTriangles(const SceneBvhInput& scene)
+    {
+        std::vector<size_t> first(scene.instanceCount + 1, 0);
+        for (size_t i = 0; i < scene.instanceCount; ++i)
+        {
+            const uint32_t geometry = scene.instances[i].geometry;
+            first[i + 1] = first[i] + (geometry < scene.geometryCount ? scene.geometries[geometry].indexCount / 3 : 0);
+        }
+
+        std::vector<WorldTriangle> triangles(first.back());
+        ThreadPool::Get().ParallelFor(scene.instanceCount, [&](size_t i)
+        {
+            const BvhInstance& instance = scene.instances[i];
+            if (instance.geometry >= scene.geometryCount)
+                return;
+            const BvhGeometry& geometry = scene.geometries[instance.geometry];
+            const auto* base = reinterpret_cast<const uint8_t*>(scene.positions) + static_cast<size_t>(geometry.vertexOffset) * scene.positionStride;
+            const uint32_t* indices = scene.indices + geometry.indexOffset;
+            for (size_t t = 0; t < first[i + 1] - first[i]; ++t)
+            {
+                WorldTriangle& out = triangles[first[i] + t];
+                for (int k = 0; k < 3; ++k)
+                {
+                    const auto* p = reinterpret_cast<const float*>(base + static_cast<size_t>(indices[t * 3 + k]) * scene.positionStride);
+                    for (int r = 0; r < 3; ++r)
+                        out.p[k][r] = instance.objectToWorld[r][0] * p[0] + instance.objectToWorld[r][1] * p[1] + instance.objectToWorld[r][2] * p[2] + instance.objectToWorld[r][3];
+                }
+            }
+        });
+        return triangles;
+    }
+
+    void AtomicMin(std::atomic<uint32_t>& target, uint32_t value)
+    {
+        uint32_t current = target.load(std::memory_order_relaxed);
+        while (value < current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {}
+    }
+
+    void AtomicMax(std::atomic<uint32_t>& target, uint32_t value)
+    {
+        uint32_t current = target.load(std::memory_order_relaxed);
+        while (value > current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {}
+    }
+}
+
+void VoxelBake::ExpandOccupancy(std::vector<uint32_t>& texels) const
+{
+    texels.assign(GetCellCount(), 0u);
+    for (uint32_t cell : cells)
+        texels[cell] = 1u;
+}
+
+void VoxelBake::ExpandBounds(std::vector<uint32_t>& boundMin, std::vector<uint32_t>& boundMax) const
+{
+    boundMin.assign(GetCellCount() * 4, kClearMin);
+    boundMax.assign(GetCellCount() * 4, kClearMax);
+    for (size_t i = 0; i < cells.size(); ++i)
+    {
+        const size_t flatId = cells[i];
+        std::copy(&bounds[i * 6], &bounds[i * 6] + 3, &boundMin[flatId * 4]);
+        std::copy(&bounds[i * 6 + 3], &bounds[i * 6 + 3] + 3, &boundMax[flatId * 4]);
+    }
+}
+
+void Voxelizer::FitGrid(const BvhAabb& sceneBounds, uint32_t gridDim, VoxelGridConstants& grid)
+{
+    float size[3];
+    float center[3];
+    for (int a = 0; a < 3; ++a)
+    {
+        size[a] = std::max(sceneBounds.max[a] - sceneBounds.min[a], 1e-4f);
+        center[a] = (sceneBounds.min[a] + sceneBounds.max[a]) * 0.5f;
+    }
+    const float maxExtent = std::max({ size[0], size[1], size[2] });
+    const float voxelSize = maxExtent / static_cast<float>(gridDim);
+    const float half = voxelSize * static_cast<float>(gridDim) * 0.5f;
+
+    for (int a = 0; a < 3; ++a)
+    {
+        grid.gridMin[a] = center[a] - half;
+        grid.gridMax[a] = center[a] + half;
+    }
+    grid.voxelSize = voxelSize;
+    grid.gridDim = gridDim;
+    // Adaptive cluster factor: raise above the floor so svDim <= SUPERVOXEL_DIM_CAP,
+    // bounding the supervoxel count to MAX_SUPERVOXELS at any grid resolution.
+    const uint32_t dimCap = static_cast<uint32_t>(Constants::Graphics::SUPERVOXEL_DIM_CAP);
+    const uint32_t ceilToCap = (gridDim + dimCap - 1) / dimCap;
+    grid.supervoxelFactor = std::max<uint32_t>(Constants::Graphics::SUPERVOXEL_GRID_FACTOR, ceilToCap);
+}
+
+VoxelBake Voxelizer::Bake(const SceneBvhInput& scene, const BvhAabb& sceneBounds, const VoxelBakeSettings& settings)
+{
+    VoxelBake bake;
+    bake.settings = settings;
+    if (settings.gridDim < MIN_GRID_DIM || settings.gridDim > MAX_GRID_DIM)
+        return bake;
+    FitGrid(sceneBounds, settings.gridDim, bake.grid);
+
+    const std::vector<WorldTriangle> triangles = TransformTriangles(scene);
+    const VoxelGridConstants& grid = bake.grid;
+    const size_t wordCount = (bake.GetCellCount() + 63) / 64;
+
+    // Occupancy: InterlockedOr of every fragment.
+    std::unique_ptr<std::atomic<uint64_t>[]> occupancy(new std::atomic<uint64_t>[wordCount]);
+    for (size_t w = 0; w < wordCount; ++w)
+        occupancy[w].store(0, std::memory_order_relaxed);
+    ThreadPool::Get().ParallelForRange(triangles.size(), kTriangleGrain, [&](size_t begin, size_t end)
+    {
+        for (size_t t = begin; t < end; ++t)
+        {
+            RasterizeTriangle(triangles[t], grid, [&](const int*, uint32_t flatId, const Float3*)
+            {
+                const uint64_t bit = uint64_t(1) << (flatId & 63);
+                std::atomic<uint64_t>& word = occupancy[flatId >> 6];
+                if (!(word.load(std::memory_order_relaxed) & bit))
+                    word.fetch_or(bit, std::memory_order_relaxed);
+            });
+        }
+    });
+
+    bake.occupancy.resize(wordCount);
+    std::vector<uint32_t> rank(wordCount);
+    uint32_t occupied = 0;
+    for (size_t w = 0; w < wordCount; ++w)
+    {
+        bake.occupancy[w] = occupancy[w].load(std::memory_order_relaxed);
+        rank[w] = occupied;
+        occupied += PopCount(bake.occupancy[w]);
+    }
+    bake.cells.reserve(occupied);
+    CollectCells(bake.occupancy, bake.cells);
+
+    if (!settings.useCompact)
+    {
+        FillCubeBounds(occupied, bake.bounds);
+        return bake;
+    }
+
+    // Tight bounds: a second pass merges every fragment's bound into its cell
+    // (InterlockedMin/Max), now that occupied cells have compact indices.
+    std::unique_ptr<std::atomic<uint32_t>[]> bounds(new std::atomic<uint32_t>[static_cast<size_t>(occupied) * 6]);
+    for (size_t i = 0; i < occupied; ++i)
+    {
+        for (int c = 0; c < 3; ++c)
+        {
+            bounds[i * 6 + c].store(kClearMin, std::memory_order_relaxed);
+            bounds[i * 6 + 3 + c].store(kClearMax, std::memory_order_relaxed);
+        }
+    }
+    ThreadPool::Get().ParallelForRange(triangles.size(), kTriangleGrain, [&](size_t begin, size_t end)
+    {
+        for (size_t t = begin; t < end; ++t)
+        {
+            RasterizeTriangle(triangles[t], grid, [&](const int* voxelId, uint32_t flatId, const Float3* triangleVoxelSpace)
+            {
+                uint32_t quantized[6];
+                TriangleVoxelBound(triangleVoxelSpace, voxelId, settings, quantized);
+                const uint64_t below = bake.occupancy[flatId >> 6] & ((uint64_t(1) << (flatId & 63)) - 1);
+                const size_t cell = rank[flatId >> 6] + PopCount(below);
+                for (int c = 0; c < 3; ++c)
+                {
+                    AtomicMin(bounds[cell * 6 + c], quantized[c]);
+                    AtomicMax(bounds[cell * 6 + 3 + c], quantized[3 + c]);
+                }
+            });
+        }
+    });
+
+    bake.bounds.resize(static_cast<size_t>(occupied) * 6);
+    for (size_t i = 0; i < bake.bounds.size(); ++i)
+        bake.bounds[i] = bounds[i].load(std::memory_order_relaxed);
+    return bake;
+}
+
+VoxelBakeDiff Voxelizer::Compare(const VoxelBake& first, const VoxelBake& second)
+{
+    VoxelBakeDiff diff;
+    size_t i = 0;
+    size_t j = 0;
+    while (i < first.cells.size() || j < second.cells.size())
+    {
+        if (j == second.cells.size() || (i < first.cells.size() && first.cells[i] < second.cells[j]))
+        {
+            ++diff.onlyInFirst;
+            ++i;
+            continue;
+        }
+        if (i == first.cells.size() || second.cells[j] < first.cells[i])
+        {
+            ++diff.onlyInSecond;
+            ++j;
+            continue;
+        }
+
+        uint32_t delta = 0;
+        for (int c = 0; c < 6; ++c)
+        {
+            const uint32_t a = first.bounds[i * 6 + c];
+            const uint32_t b = second.bounds[j * 6 + c];
+            delta = std::max(delta, a > b ? a - b : b - a);
+        }
+        if (delta != 0)
+        {
+            ++diff.boundMismatches;
+            diff.maxBoundDelta = std::max(diff.maxBoundDelta, delta);
+        }
+        ++i;
+        ++j;
+    }
+    return diff;
+}
+
+std::filesystem::path Voxelizer::GetBakePath(const std::filesystem::path& sceneCachePath, const VoxelBakeSettings& settings)
+{
+    std::string suffix = ".g" + std::to_string(settings.gridDim);
+    if (settings.useCompact)
+        suffix += ".compact";
+    if (settings.clipping)
+        suffix += ".clip";
+    std::filesystem::path path = sceneCachePath;
+    path.replace_extension();
+    path += suffix + ".bvx";
+    return path;
+}
+
+bool Voxelizer::Write(const std::filesystem::path& path, const VoxelBake& bake, uint64_t sourceHash)
+{
+    if (bake.occupancy.empty())
+        return false;
+
+    BakeFileHeader header{};
+    header.magic = kFileMagic;
+    header.version = kFileVersion;
+    header.sourceHash = sourceHash;
+    header.grid = bake.grid;
+    header.gridDim = bake.settings.gridDim;
+    header.flags = FlagsOf(bake.settings);
+    header.occupiedCount = bake.cells.size();
+
+    std::error_code ec;
+    std::filesystem::create_directories(path.parent_path(), ec);
+
+    std::filesystem::path temporary = path;
+    temporary += ".tmp";
+    FILE* file = nullptr;
+#ifdef _WIN32
+    if (_wfopen_s(&file, temporary.c_str(), L"wb") != 0)
+        file = nullptr;
+#else
+    file = std::fopen(temporary.c_str(), "wb");
+#endif
+    if (!file)
+        return false;
+
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+              std::fwrite(bake.occupancy.data(), sizeof(uint64_t), bake.occupancy.size(), file) == bake.occupancy.size();
+    if (ok && bake.settings.useCompact && !bake.bounds.empty())
+        ok = std::fwrite(bake.bounds.data(), sizeof(uint32_t), bake.bounds.size(), file) == bake.bounds.size();
+    ok = std::fclose(file) == 0 && ok;
+
+    if (!ok)
+    {
+        std::filesystem::remove(temporary, ec);
+        return false;
+    }
+
+    std::filesystem::rename(temporary, path, ec);
+    if (ec)
+    {
+        std::filesystem::remove(temporary, ec);
+        return false;
+    }
+    return true;
+}
+
+bool Voxelizer::Read(const std::filesystem::path& path, uint64_t sourceHash, const VoxelBakeSettings& settings, VoxelBake& bake)
+{
+    MappedFile file;
+    if (!file.Open(path) || file.Size() < sizeof(BakeFileHeader))
+        return false;
+
+    BakeFileHeader header;
+    std::memcpy(&header, file.Data(), sizeof(header));
+    if (header.magic != kFileMagic || header.version != kFileVersion || header.sourceHash != sourceHash)
+        return false;
+    if (header.gridDim != settings.gridDim || header.grid.gridDim != settings.gridDim || header.flags != FlagsOf(settings))
+        return false;
+    if (settings.gridDim < MIN_GRID_DIM || settings.gridDim > MAX_GRID_DIM)
+        return false;
+
+    const size_t cellCount = static_cast<size_t>(settings.gridDim) * settings.gridDim * settings.gridDim;
+    const size_t wordCount = (cellCount + 63) / 64;
+    const size_t boundCount = settings.useCompact ? static_cast<size_t>(header.occupiedCount) * 6 : 0;
+    if (header.occupiedCount > cellCount || file.Size() != sizeof(header) + wordCount * sizeof(uint64_t) + boundCount * sizeof(uint32_t))
+        return false;
+
+    VoxelBake loaded;
+    loaded.grid = header.grid;
+    loaded.settings = settings;
+    loaded.occupancy.resize(wordCount);
+    std::memcpy(loaded.occupancy.data(), file.Data() + sizeof(header), wordCount * sizeof(uint64_t));
+
+    loaded.cells.reserve(static_cast<size_t>(header.occupiedCount));
+    CollectCells(loaded.occupancy, loaded.cells);
+    if (loaded.cells.size() != header.occupiedCount)
+        return false;
+
+    if (settings.useCompact)
+    {
+        loaded.bounds.resize(boundCount);
+        std::memcpy(loaded.bounds.data(), file.Data() + sizeof(header) + wordCount * sizeof(uint64_t), boundCount * sizeof(uint32_t));
+    }
+    else
+    {
+        FillCubeBounds(loaded.cells.size(), loaded.bounds);
+    }
+
+    bake = std::move(loaded);
+    return true;
+}
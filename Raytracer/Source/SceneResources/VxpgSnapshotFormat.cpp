@@ -0,0 +1,307 @@
+#include "SceneResources/VxpgSnapshotFormat.h"
+
+#include <cstdio>
+#include <cstring>
+#include <system_error>
+
+namespace VxpgSnapshotFormat
+{
+namespace
+{
+    size_t AlignUp(size_t value, size_t alignment)
+    {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+
+    struct PendingSection
+    {
+        SectionId id;
+        uint32_t elementSize;
+        const void* data;
+        size_t size;
+    };
+
+    template <typename T>
+    PendingSection MakeSection(SectionId id, const std::vector<T>& values)
+    {
+        return { id, static_cast<uint32_t>(sizeof(T)), values.data(), values.size() * sizeof(T) };
+    }
+
+    template <typename T>
+    bool ResolveSection(const uint8_t* base, size_t fileSize, const SectionEntry& entry, ArrayView<T>& out)
+    {
+        if (entry.elementSize != sizeof(T) || entry.size % sizeof(T) != 0)
+            return false;
+        if (entry.offset % alignof(T) != 0 || entry.offset > fileSize || entry.size > fileSize - entry.offset)
+            return false;
+        out.data = reinterpret_cast<const T*>(base + entry.offset);
+        out.count = static_cast<size_t>(entry.size / sizeof(T));
+        return true;
+    }
+
+    bool StringInRange(const ArrayView<char>& strings, uint32_t offset, uint32_t length)
+    {
+        return static_cast<size_t>(offset) <= strings.count && length <= strings.count - offset;
+    }
+
+    // Empty, or exactly `expected` elements.
+    template <typename T>
+    bool HasCount(const ArrayView<T>& view, size_t expected)
+    {
+        return view.empty() || view.count == expected;
+    }
+}
+
+bool Write(const std::filesystem::path& path, const SnapshotInput& input)
+{
+    std::vector<char> strings;
+    std::vector<CVarRecord> cvars;
+    cvars.reserve(input.cvars.size());
+    for (const CVarValue& cvar : input.cvars)
+    {
+        CVarRecord record{};
+        record.type = cvar.type;
+        record.nameOffset = static_cast<uint32_t>(strings.size());
+        record.nameLength = static_cast<uint32_t>(cvar.name.size());
+        strings.insert(strings.end(), cvar.name.begin(), cvar.name.end());
+        record.valueOffset = static_cast<uint32_t>(strings.size());
+        record.valueLength = static_cast<uint32_t>(cvar.value.size());
+        strings.insert(strings.end(), cvar.value.begin(), cvar.value.end());
+        cvars.push_back(record);
+    }
+
+    const PendingSection candidates[] = {
+        { SectionId::GridConstants, static_cast<uint32_t>(sizeof(VoxelGridConstants)), &input.grid, sizeof(VoxelGridConstants) },
+        MakeSection(SectionId::CVars, cvars),
+        MakeSection(SectionId::Strings, strings),
+        MakeSection(SectionId::VoxelIrradiance, input.voxelIrradiance),
+        MakeSection(SectionId::CompactIds, input.compactIds),
+        MakeSection(SectionId::PremulIrradiance, input.premulIrradiance),
+        MakeSection(SectionId::RepresentativeVpls, input.representativeVpls),
+        MakeSection(SectionId::Fingerprints, input.fingerprints),
+        MakeSection(SectionId::ClusterSeeds, input.clusterSeeds),
+        MakeSection(SectionId::ClusterCenters, input.clusterCenters),
+        MakeSection(SectionId::ClusterAssignments, input.clusterAssignments),
+        MakeSection(SectionId::LightTreeNodes, input.lightTreeNodes),
+        MakeSection(SectionId::LightTreeClusterRoots, input.lightTreeClusterRoots),
+        MakeSection(SectionId::CompactToLeaf, input.compactToLeaf),
+        MakeSection(SectionId::ShadingPoints, input.shadingPoints),
+        MakeSection(SectionId::SuperpixelIndex, input.superpixelIndex),
+        MakeSection(SectionId::ClusterVisibilityMask, input.clusterVisibilityMask),
+        MakeSection(SectionId::ClusterVisibility, input.clusterVisibility),
+    };
+    std::vector<PendingSection> sections;
+    for (const PendingSection& section : candidates)
+    {
+        if (section.size > 0)
+            sections.push_back(section);
+    }
+
+    FileHeader header{};
+    header.magic = MAGIC;
+    header.version = VERSION;
+    header.stage = input.stage;
+    header.frameIndex = input.frameIndex;
+    header.width = input.width;
+    header.height = input.height;
+    header.superpixelMapX = input.superpixelMapX;
+    header.superpixelMapY = input.superpixelMapY;
+    header.clusterCount = input.clusterCount;
+    header.litVoxelCount = input.litVoxelCount;
+    header.leafCount = input.leafCount;
+    header.treeOverflow = input.treeOverflow;
+    header.sectionCount = static_cast<uint32_t>(sections.size());
+
+    std::vector<SectionEntry> entries(sections.size());
+    size_t cursor = AlignUp(sizeof(FileHeader) + entries.size() * sizeof(SectionEntry), SECTION_ALIGNMENT);
+    for (size_t i = 0; i < sections.size(); ++i)
+    {
+        entries[i].id = static_cast<uint32_t>(sections[i].id);
+        entries[i].elementSize = sections[i].elementSize;
+        entries[i].offset = cursor;
+        entries[i].size = sections[i].size;
+        cursor = AlignUp(cursor + sections[i].size, SECTION_ALIGNMENT);
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(path.parent_path(), ec);
+
+    std::filesystem::path temporary = path;
+    temporary += ".tmp";
+    FILE* file = nullptr;
+#ifdef _WIN32
+    if (_wfopen_s(&file, temporary.c_str(), L"wb") != 0)
+        file = nullptr;
+#else
+    file = std::fopen(temporary.c_str(), "wb");
+#endif
+    if (!file)
+        return false;
+
+    static const uint8_t padding[SECTION_ALIGNMENT] = {};
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+              (entries.empty() || std::fwrite(entries.data(), sizeof(SectionEntry), entries.size(), file) == entries.size());
+    size_t written = sizeof(header) + entries.size() * sizeof(SectionEntry);
+    for (size_t i = 0; ok && i < sections.size(); ++i)
+    {
+        const size_t pad = static_cast<size_t>(entries[i].offset) - written;
+        ok = pad == 0 || std::fwrite(padding, 1, pad, file) == pad;
+        if (ok)
+            ok = std::fwrite(sections[i].data, 1, sections[i].size, file) == sections[i].size;
+        written = static_cast<size_t>(entries[i].offset) + sections[i].size;
+    }
+    ok = std::fclose(file) == 0 && ok;
+
+    if (!ok)
+    {
+        std::filesystem::remove(temporary, ec);
+        return false;
+    }
+
+    std::filesystem::rename(temporary, path, ec);
+    if (ec)
+    {
+        std::filesystem::remove(temporary, ec);
+        return false;
+    }
+    return true;
+}
+
+bool Reader::Open(const std::filesystem::path& path)
+{
+    Close();
+    if (!m_file.Open(path))
+        return false;
+    if (!Validate())
+    {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+void Reader::Close()
+{
+    m_file.Close();
+    *this = Reader();
+}
+
+bool Reader::Validate()
+{
+    const uint8_t* base = m_file.Data();
+    const size_t size = m_file.Size();
+    if (size < sizeof(FileHeader))
+        return false;
+
+    std::memcpy(&m_header, base, sizeof(FileHeader));
+    if (m_header.magic != MAGIC || m_header.version != VERSION)
+        return false;
+    if (m_header.sectionCount > (size - sizeof(FileHeader)) / sizeof(SectionEntry))
+        return false;
+
+    ArrayView<VoxelGridConstants> grid;
+    const auto* entries = reinterpret_cast<const SectionEntry*>(base + sizeof(FileHeader));
+    for (uint32_t i = 0; i < m_header.sectionCount; ++i)
+    {
+        const SectionEntry& entry = entries[i];
+        bool ok = true;
+        switch (static_cast<SectionId>(entry.id))
+        {
+        case SectionId::GridConstants:         ok = ResolveSection(base, size, entry, grid); break;
+        case SectionId::CVars:                 ok = ResolveSection(base, size, entry, m_cvars); break;
+        case SectionId::Strings:               ok = ResolveSection(base, size, entry, m_strings); break;
+        case SectionId::VoxelIrradiance:       ok = ResolveSection(base, size, entry, m_voxelIrradiance); break;
+        case SectionId::CompactIds:            ok = ResolveSection(base, size, entry, m_compactIds); break;
+        case SectionId::PremulIrradiance:      ok = ResolveSection(base, size, entry, m_premulIrradiance); break;
+        case SectionId::RepresentativeVpls:    ok = ResolveSection(base, size, entry, m_representativeVpls); break;
+        case SectionId::Fingerprints:          ok = ResolveSection(base, size, entry, m_fingerprints); break;
+        case SectionId::ClusterSeeds:          ok = ResolveSection(base, size, entry, m_clusterSeeds); break;
+        case SectionId::ClusterCenters:        ok = ResolveSection(base, size, entry, m_clusterCenters); break;
+        case SectionId::ClusterAssignments:    ok = ResolveSection(base, size, entry, m_clusterAssignments); break;
+        case SectionId::LightTreeNodes:        ok = ResolveSection(base, size, entry, m_lightTreeNodes); break;
+        case SectionId::LightTreeClusterRoots: ok = ResolveSection(base, size, entry, m_lightTreeClusterRoots); break;
+        case SectionId::CompactToLeaf:         ok = ResolveSection(base, size, entry, m_compactToLeaf); break;
+        case SectionId::ShadingPoints:         ok = ResolveSection(base, size, entry, m_shadingPoints); break;
+        case SectionId::SuperpixelIndex:       ok = ResolveSection(base, size, entry, m_superpixelIndex); break;
+        case SectionId::ClusterVisibilityMask: ok = ResolveSection(base, size, entry, m_clusterVisibilityMask); break;
+        case SectionId::ClusterVisibility:     ok = ResolveSection(base, size, entry, m_clusterVisibility); break;
+        default: break; // unknown sections are skipped
+        }
+        if (!ok)
+            return false;
+    }
+    if (grid.count != 1)
+        return false;
+    m_grid = grid[0];
+
+    // Sizes against the header, so consumers can index without re-checking.
+    const size_t cellCount = static_cast<size_t>(m_grid.gridDim) * m_grid.gridDim * m_grid.gridDim;
+    const size_t lit = m_header.litVoxelCount;
+    const size_t pixels = static_cast<size_t>(m_header.width) * m_header.height;
+    const size_t superpixels = static_cast<size_t>(m_header.superpixelMapX) * m_header.superpixelMapY;
+    const size_t clusters = m_header.clusterCount;
+    const size_t nodes = m_header.leafCount > 0 ? size_t(2) * m_header.leafCount - 1 : 0;
+    if (!HasCount(m_compactIds, lit) || !HasCount(m_premulIrradiance, lit) || !HasCount(m_representativeVpls, lit) ||
+        !HasCount(m_fingerprints, lit) || !HasCount(m_clusterAssignments, lit) || !HasCount(m_compactToLeaf, lit))
+        return false;
+    if (!HasCount(m_clusterSeeds, clusters) || !HasCount(m_clusterCenters, clusters) || !HasCount(m_lightTreeClusterRoots, clusters))
+        return false;
+    if (!HasCount(m_lightTreeNodes, nodes) || !HasCount(m_shadingPoints, pixels * 4) || !HasCount(m_superpixelIndex, pixels))
+        return false;
+    if (!HasCount(m_clusterVisibilityMask, superpixels) || !HasCount(m_clusterVisibility, superpixels * clusters))
+        return false;
+    for (const VoxelIrradianceRecord& record : m_voxelIrradiance)
+    {
+        if (record.voxel >= cellCount)
+            return false;
+    }
+    for (uint32_t voxel : m_compactIds)
+    {
+        if (voxel >= cellCount)
+            return false;
+    }
+    for (const CVarRecord& cvar : m_cvars)
+    {
+        if (!StringInRange(m_strings, cvar.nameOffset, cvar.nameLength) || !StringInRange(m_strings, cvar.valueOffset, cvar.valueLength))
+            return false;
+    }
+    return true;
+}
+
+std::vector<CVarValue> Reader::GetCVars() const
+{
+    std::vector<CVarValue> cvars;
+    cvars.reserve(m_cvars.count);
+    for (const CVarRecord& record : m_cvars)
+    {
+        cvars.push_back({ record.type, std::string(m_strings.data + record.nameOffset, record.nameLength),
+            std::string(m_strings.data + record.valueOffset, record.valueLength) });
+    }
+    return cvars;
+}
+
+VoxelClusterInput Reader::GetClusterInput() const
+{
+    VoxelClusterInput input;
+    if (m_fingerprints.empty() || m_premulIrradiance.empty() || m_compactIds.empty())
+        return input;
+    input.fingerprints = m_fingerprints.data;
+    input.premulIrradiance = m_premulIrradiance.data;
+    input.compactIds = m_compactIds.data;
+    input.count = m_header.litVoxelCount;
+    input.gridDim = m_grid.gridDim;
+    return input;
+}
+
+LightTreeInput Reader::GetLightTreeInput() const
+{
+    LightTreeInput input;
+    if (m_compactIds.empty() || m_clusterAssignments.empty() || m_premulIrradiance.empty())
+        return input;
+    input.compactIds = m_compactIds.data;
+    input.clusterAssignments = m_clusterAssignments.data;
+    input.premulIrradiance = m_premulIrradiance.data;
+    input.count = m_header.litVoxelCount;
+    return input;
+}
+}
@@ -0,0 +1,68 @@
+#include "SceneResources/Wo3Mesh.h"
+
+#include <cstring>
+
+namespace Wo3Mesh
+{
+    Status File::Open(const std::filesystem::path& path)
+    {
+        *this = File();
+        if (!m_file.Open(path))
+            return Status::OpenFailed;
+
+        const uint8_t* data = m_file.Data();
+        const size_t size = m_file.Size();
+
+        if (size < sizeof(m_vertexCount))
+            return Status::TruncatedVertices;
+        std::memcpy(&m_vertexCount, data, sizeof(m_vertexCount));
+
+        // Overflow-safe: a count can never exceed what the remaining bytes hold.
+        size_t offset = sizeof(m_vertexCount);
+        if (m_vertexCount > (size - offset) / sizeof(Vertex))
+            return Status::TruncatedVertices;
+        const auto* vertices = reinterpret_cast<const Vertex*>(data + offset);
+        offset += static_cast<size_t>(m_vertexCount) * sizeof(Vertex);
+
+        if (size - offset < sizeof(m_triangleCount))
+            return Status::TruncatedTriangles;
+        std::memcpy(&m_triangleCount, data + offset, sizeof(m_triangleCount));
+        offset += sizeof(m_triangleCount);
+
+        if (m_triangleCount > (size - offset) / sizeof(Triangle))
+            return Status::TruncatedTriangles;
+        const auto* triangles = reinterpret_cast<const Triangle*>(data + offset);
+        offset += static_cast<size_t>(m_triangleCount) * sizeof(Triangle);
+
+        if (m_vertexCount > UINT32_MAX)
+            return Status::TooManyVertices;
+
+        m_vertices = vertices;
+        m_triangles = triangles;
+        m_trailingBytes = size - offset;
+        return Status::Ok;
+    }
+
+    bool CopyIndices(const File& file, uint32_t* dst, size_t& badTriangle)
+    {
+        const Triangle* triangles = file.Triangles();
+        const uint64_t vertexCount = file.VertexCount();
+        const size_t triangleCount = static_cast<size_t>(file.TriangleCount());
+        for (size_t i = 0; i < triangleCount; ++i)
+        {
+            const Triangle& t = triangles[i];
+            // Unsigned compare also rejects negative indices.
+            if (static_cast<uint64_t>(static_cast<uint32_t>(t.i0)) >= vertexCount ||
+                static_cast<uint64_t>(static_cast<uint32_t>(t.i1)) >= vertexCount ||
+                static_cast<uint64_t>(static_cast<uint32_t>(t.i2)) >= vertexCount)
+            {
+                badTriangle = i;
+                return false;
+            }
+            dst[i * 3 + 0] = static_cast<uint32_t>(t.i0);
+            dst[i * 3 + 1] = static_cast<uint32_t>(t.i1);
+            dst[i * 3 + 2] = static_cast<uint32_t>(t.i2);
+        }
+        return true;
+    }
+}
@@ -5,6 +5,7 @@
 #include "ResourceManager/ResourceManager.h"
 #include "Shader.h"
 #include "Utils/Utils.h"
+#include "Resources/GpuMemoryAllocator.h"
 
 using Microsoft::WRL::ComPtr;
 
@@ -94,14 +95,14 @@ void SuperpixelBuildPass::CreatePSOs()
 
 void SuperpixelBuildPass::CreateBuffers()
 {
-    auto heapProps = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
+    GpuMemoryAllocator::ScopedTag memoryTag("SuperpixelBuildPass");
 
     auto makeTex = [&](DXGI_FORMAT fmt, uint32_t w, uint32_t h, const wchar_t* name, ComPtr<ID3D12Resource>& out)
     {
         D3D12_RESOURCE_DESC desc = CD3DX12_RESOURCE_DESC::Tex2D(
             fmt, w, h, 1, 1, 1, 0, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS);
-        ThrowIfFailed(m_device->CreateCommittedResource(
-            &heapProps, D3D12_HEAP_FLAG_NONE, &desc,
+        ThrowIfFailed(GpuMemoryAllocator::Get().CreateResource(
+            desc,
             D3D12_RESOURCE_STATE_UNORDERED_ACCESS, nullptr, IID_PPV_ARGS(&out)));
         out->SetName(name);
     };
@@ -3,6 +3,7 @@
 
 #include "AccelerationStructures.h"
 #include "Constants.h"
+#include "DescriptorHeapAllocator.h"
 #include "Renderer.h"
 #include "ResourceManager/ResourceManager.h"
 #include "Shader.h"
@@ -17,6 +18,7 @@
 #include "Resources/StructuredBuffer.h"
 #include "SceneResources/Scene.h"
 #include "Utils/PassConstants.h"
+#include "Resources/GpuMemoryAllocator.h"
 
 // -1 = auto (inline RayQuery on AMD RDNA, RT pipeline elsewhere — RDNA's
 // shader-based traversal skips the pipeline/SBT machinery nearly for free,
@@ -107,8 +109,8 @@ TechniqueDesc GuidedPathTracingPass::GetTechniqueDesc() const
 void GuidedPathTracingPass::CreateGlobalRootSignature()
 {
     // Base 7-param scene binding extended with: voxel irradiance/count UAVs
-    // (u1/u2, global heap slots 520/521), voxel grid CBV (b4), the superpixel
-    // index texture (u5, heap slot 523), and root UAVs for the guiding
+    // (u1/u2, shared-heap "Voxel Grid" slots), voxel grid CBV (b4), the superpixel
+    // index texture (u5, "Superpixels" slot), and root UAVs for the guiding
     // distribution and light-tree buffers (u3 counters, u4 ids, u6 inverse
     // index, u10-u17 fingerprint/cluster/tree/heap).
 
@@ -159,21 +161,21 @@ void GuidedPathTracingPass::CreateGlobalRootSignature()
     skybox_range.NumDescriptors = 1;
     skybox_range.RegisterSpace = 1;
     skybox_range.RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_SRV;
-    skybox_range.OffsetInDescriptorsFromTableStart = Constants::Graphics::SKYBOX_DESCRIPTOR_INDEX;
+    skybox_range.OffsetInDescriptorsFromTableStart = DescriptorHeapAllocator::Get().GetNamedIndex(DescriptorSlots::SKYBOX);
 
     D3D12_DESCRIPTOR_RANGE voxelIrradianceRange;
     voxelIrradianceRange.BaseShaderRegister = 1;
     voxelIrradianceRange.NumDescriptors = 1;
     voxelIrradianceRange.RegisterSpace = 0;
     voxelIrradianceRange.RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_UAV;
-    voxelIrradianceRange.OffsetInDescriptorsFromTableStart = Constants::Graphics::VOXEL_IRRADIANCE_DESCRIPTOR_INDEX;
+    voxelIrradianceRange.OffsetInDescriptorsFromTableStart = DescriptorHeapAllocator::Get().GetNamedIndex(DescriptorSlots::VOXEL_GRID, DescriptorSlots::VOXEL_GRID_IRRADIANCE);
 
     D3D12_DESCRIPTOR_RANGE voxelVplCountRange;
     voxelVplCountRange.BaseShaderRegister = 2;
     voxelVplCountRange.NumDescriptors = 1;
     voxelVplCountRange.RegisterSpace = 0;
     voxelVplCountRange.RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_UAV;
-    voxelVplCountRange.OffsetInDescriptorsFromTableStart = Constants::Graphics::VOXEL_VPL_COUNT_DESCRIPTOR_INDEX;
+    voxelVplCountRange.OffsetInDescriptorsFromTableStart = DescriptorHeapAllocator::Get().GetNamedIndex(DescriptorSlots::VOXEL_GRID, DescriptorSlots::VOXEL_GRID_VPL_COUNT);
 
     // Debug views 6/7 read the injection-pass outputs (texture UAVs can't be
     // root descriptors, so they ride the shared-heap table at their slots).
@@ -182,21 +184,21 @@ void GuidedPathTracingPass::CreateGlobalRootSignature()
     voxelRepresentativeRange.NumDescriptors = 1;
     voxelRepresentativeRange.RegisterSpace = 0;
     voxelRepresentativeRange.RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_UAV;
-    voxelRepresentativeRange.OffsetInDescriptorsFromTableStart = Constants::Graphics::VOXEL_REPRESENTATIVE_DESCRIPTOR_INDEX;
+    voxelRepresentativeRange.OffsetInDescriptorsFromTableStart = DescriptorHeapAllocator::Get().GetNamedIndex(DescriptorSlots::VOXEL_REPRESENTATIVE);
 
     D3D12_DESCRIPTOR_RANGE vplPositionRange;
     vplPositionRange.BaseShaderRegister = 8;
     vplPositionRange.NumDescriptors = 1;
     vplPositionRange.RegisterSpace = 0;
     vplPositionRange.RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_UAV;
-    vplPositionRange.OffsetInDescriptorsFromTableStart = Constants::Graphics::VPL_POSITION_DESCRIPTOR_INDEX;
+    vplPositionRange.OffsetInDescriptorsFromTableStart = DescriptorHeapAllocator::Get().GetNamedIndex(DescriptorSlots::VPL_POSITION);
 
     D3D12_DESCRIPTOR_RANGE vbufferRange;
     vbufferRange.BaseShaderRegister = 9; // u9
     vbufferRange.NumDescriptors = 1;
     vbufferRange.RegisterSpace = 0;
     vbufferRange.RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_UAV;
-    vbufferRange.OffsetInDescriptorsFromTableStart = Constants::Graphics::VBUFFER_DESCRIPTOR_INDEX;
+    vbufferRange.OffsetInDescriptorsFromTableStart = DescriptorHeapAllocator::Get().GetNamedIndex(DescriptorSlots::VBUFFER);
 
     // Cluster-visibility mask (debug view 10), texture UAV in the shared heap.
     D3D12_DESCRIPTOR_RANGE clusterMaskRange;
@@ -204,7 +206,7 @@ void GuidedPathTracingPass::CreateGlobalRootSignature()
     clusterMaskRange.NumDescriptors = 1;
     clusterMaskRange.RegisterSpace = 0;
     clusterMaskRange.RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_UAV;
-    clusterMaskRange.OffsetInDescriptorsFromTableStart = Constants::Graphics::CLUSTER_VISIBILITY_MASK_DESCRIPTOR_INDEX;
+    clusterMaskRange.OffsetInDescriptorsFromTableStart = DescriptorHeapAllocator::Get().GetNamedIndex(DescriptorSlots::CLUSTER_VISIBILITY_MASK);
 
     // Superpixel index texture (SLIC assignment) — selects the top-level heap
     // row for both MIS strategies.
@@ -213,7 +215,7 @@ void GuidedPathTracingPass::CreateGlobalRootSignature()
     spixelIndexRange.NumDescriptors = 1;
     spixelIndexRange.RegisterSpace = 0;
     spixelIndexRange.RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_UAV;
-    spixelIndexRange.OffsetInDescriptorsFromTableStart = Constants::Graphics::SUPERPIXEL_INDEX_DESCRIPTOR_INDEX;
+    spixelIndexRange.OffsetInDescriptorsFromTableStart = DescriptorHeapAllocator::Get().GetNamedIndex(DescriptorSlots::SUPERPIXELS, DescriptorSlots::SUPERPIXELS_INDEX);
 
     // Fuzzy 4-nearest blend (superpixel pass outputs): per-pixel weights + ids
     // for the guided integrator's mixture top-level pdf.
@@ -222,14 +224,14 @@ void GuidedPathTracingPass::CreateGlobalRootSignature()
     fuzzyWeightRange.NumDescriptors = 1;
     fuzzyWeightRange.RegisterSpace = 0;
     fuzzyWeightRange.RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_UAV;
-    fuzzyWeightRange.OffsetInDescriptorsFromTableStart = Constants::Graphics::FUZZY_WEIGHT_DESCRIPTOR_INDEX;
+    fuzzyWeightRange.OffsetInDescriptorsFromTableStart = DescriptorHeapAllocator::Get().GetNamedIndex(DescriptorSlots::FUZZY_WEIGHT);
 
     D3D12_DESCRIPTOR_RANGE fuzzyIndexRange;
     fuzzyIndexRange.BaseShaderRegister = 21; // u21
     fuzzyIndexRange.NumDescriptors = 1;
     fuzzyIndexRange.RegisterSpace = 0;
     fuzzyIndexRange.RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_UAV;
-    fuzzyIndexRange.OffsetInDescriptorsFromTableStart = Constants::Graphics::FUZZY_INDEX_DESCRIPTOR_INDEX;
+    fuzzyIndexRange.OffsetInDescriptorsFromTableStart = DescriptorHeapAllocator::Get().GetNamedIndex(DescriptorSlots::FUZZY_INDEX);
 
     D3D12_DESCRIPTOR_RANGE ranges[16] = {cbvRange, rtRange, tlasRange, vertex_range, index_range,
                                          texture_range, skybox_range, voxelIrradianceRange, voxelVplCountRange,
@@ -281,6 +283,8 @@ void GuidedPathTracingPass::CreateGlobalRootSignature()
 
 void GuidedPathTracingPass::EnsureAdaptiveQResources(uint32_t width, uint32_t height)
 {
+    GpuMemoryAllocator::ScopedTag memoryTag("GuidedPathTracingPass");
+
     const uint32_t tilesPerRow    = (width + 15) / 16;
     const uint32_t tilesPerColumn = (height + 15) / 16;
     if (m_tileGuideQ && tilesPerRow == m_tileGridWidth && tilesPerColumn == m_tileGridHeight)
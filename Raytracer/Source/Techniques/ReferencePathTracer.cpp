@@ -0,0 +1,946 @@
+#include "Techniques/ReferencePathTracer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <unordered_map>
+
+#include "SceneResources/SceneCacheGeometry.h"
+#include "SceneResources/VertexPacking.h"
+#include "Utils/ThreadPool.h"
+
+// STB_IMAGE_WRITE_IMPLEMENTATION is compiled by Vendor/tinygltf/tiny_gltf.cc.
+#include "tinygltf/stb_image_write.h"
+#include "rapidjson/document.h"
+#include "rapidjson/prettywriter.h"
+#include "rapidjson/stringbuffer.h"
+
+namespace
+{
+    // consts.hlsl, RaytracingUtils.hlsl, BRDF.hlsl
+    constexpr float kPi = 3.14159265359f;
+    constexpr float kEpsilon = 0.001f;
+    constexpr float kMinRoughness = 0.04f;
+    constexpr float kRayTMin = 0.001f;
+    constexpr float kRayTMax = 100.0f;
+    constexpr float kDielectricF0 = 0.04f;
+
+    struct Float3
+    {
+        float x, y, z;
+
+        Float3 operator+(const Float3& o) const { return { x + o.x, y + o.y, z + o.z }; }
+        Float3 operator-(const Float3& o) const { return { x - o.x, y - o.y, z - o.z }; }
+        Float3 operator-() const { return { -x, -y, -z }; }
+        Float3 operator*(const Float3& o) const { return { x * o.x, y * o.y, z * o.z }; }
+        Float3 operator*(float s) const { return { x * s, y * s, z * s }; }
+        Float3 operator/(float s) const { return { x / s, y / s, z / s }; }
+        Float3& operator+=(const Float3& o) { x += o.x; y += o.y; z += o.z; return *this; }
+        Float3& operator*=(const Float3& o) { x *= o.x; y *= o.y; z *= o.z; return *this; }
+        [[nodiscard]] bool IsZero() const { return x == 0.0f && y == 0.0f && z == 0.0f; }
+    };
+
+    Float3 Splat(float s) { return { s, s, s }; }
+    Float3 Load3(const float* v) { return { v[0], v[1], v[2] }; }
+    float Dot(const Float3& a, const Float3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+    Float3 Cross(const Float3& a, const Float3& b) { return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x }; }
+    float Length(const Float3& v) { return std::sqrt(Dot(v, v)); }
+    Float3 Normalize(const Float3& v) { return v * (1.0f / std::sqrt(Dot(v, v))); }
+    float Saturate(float v) { return std::clamp(v, 0.0f, 1.0f); }
+    Float3 Reflect(const Float3& i, const Float3& n) { return i - n * (2.0f * Dot(n, i)); }
+
+    Float3 Mul3x3(const float m[3][4], const Float3& v)
+    {
+        return { m[0][0] * v.x + m[0][1] * v.y + m[0][2] * v.z,
+                 m[1][0] * v.x + m[1][1] * v.y + m[1][2] * v.z,
+                 m[2][0] * v.x + m[2][1] * v.y + m[2][2] * v.z };
+    }
+
+    Float3 MulPoint(const float m[3][4], const Float3& p)
+    {
+        return Mul3x3(m, p) + Float3{ m[0][3], m[1][3], m[2][3] };
+    }
+
+    // RaytracingUtils.hlsl TransformNormalToWorld: cofactor / det.
+    Float3 TransformNormalToWorld(const float m[3][4], const Float3& n)
+    {
+        const Float3 a{ m[0][0], m[0][1], m[0][2] };
+        const Float3 b{ m[1][0], m[1][1], m[1][2] };
+        const Float3 c{ m[2][0], m[2][1], m[2][2] };
+        const Float3 cof0 = Cross(b, c);
+        const float det = Dot(a, cof0);
+        if (std::abs(det) < 1e-12f)
+            return Normalize(Mul3x3(m, n));
+        const Float3 cof1 = Cross(c, a);
+        const Float3 cof2 = Cross(a, b);
+        return Normalize(Float3{ Dot(cof0, n), Dot(cof1, n), Dot(cof2, n) } * (1.0f / det));
+    }
+
+    Float3 Rotate(const float q[4], const Float3& v)
+    {
+        const Float3 u{ q[0], q[1], q[2] };
+        const Float3 t = Cross(u, v) * 2.0f;
+        return v + t * q[3] + Cross(u, t);
+    }
+
+    // Random.hlsl
+    uint32_t PcgHash(uint32_t state)
+    {
+        state = state * 747796405u + 2891336453u;
+        const uint32_t word = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+        return (word >> 22u) ^ word;
+    }
+
+    float ToUnit(uint32_t value)
+    {
+        return static_cast<float>(value) * (1.0f / 4294967296.0f);
+    }
+
+    void Random2D(uint32_t seed, float xi[2])
+    {
+        xi[0] = ToUnit(PcgHash(seed));
+        xi[1] = ToUnit(PcgHash(seed ^ 0x9e3779b9u));
+    }
+
+    float Random1D(uint32_t seed)
+    {
+        return ToUnit(PcgHash(seed));
+    }
+
+    // BRDF.hlsl
+    float DistributionGGX(float NdotH, float roughness)
+    {
+        const float a = roughness * roughness;
+        const float a2 = a * a;
+        const float denom = NdotH * NdotH * (a2 - 1.0f) + 1.0f;
+        return a2 / (kPi * denom * denom);
+    }
+
+    Float3 FresnelSchlick(float cosTheta, const Float3& F0)
+    {
+        return F0 + (Splat(1.0f) - F0) * std::pow(Saturate(1.0f - cosTheta), 5.0f);
+    }
+
+    float GeometrySchlickGGX(float NdotX, float roughness)
+    {
+        const float r = roughness + 1.0f;
+        const float k = (r * r) / 8.0f;
+        return NdotX / (NdotX * (1.0f - k) + k);
+    }
+
+    float GeometrySmith(float NdotV, float NdotL, float roughness)
+    {
+        return GeometrySchlickGGX(NdotV, roughness) * GeometrySchlickGGX(NdotL, roughness);
+    }
+
+    float SmithG1_GGX(float NdotX, float roughness)
+    {
+        const float a = roughness * roughness;
+        const float k = (a * a) / 2.0f;
+        return NdotX / (NdotX * (1.0f - k) + k);
+    }
+
+    float SmithG_GGX(float NdotV, float NdotL, float roughness)
+    {
+        return SmithG1_GGX(NdotV, roughness) * SmithG1_GGX(NdotL, roughness);
+    }
+
+    Float3 TangentToWorld(const Float3& dir, const Float3& N)
+    {
+        const Float3 up = std::abs(N.y) < 0.999f ? Float3{ 0.0f, 1.0f, 0.0f } : Float3{ 1.0f, 0.0f, 0.0f };
+        const Float3 T = Normalize(Cross(up, N));
+        const Float3 B = Cross(N, T);
+        return T * dir.x + B * dir.y + N * dir.z;
+    }
+
+    Float3 ImportanceSampleGGX(const float xi[2], const Float3& N, float roughness)
+    {
+        const float a = roughness * roughness;
+        const float a2 = a * a;
+        const float phi = 2.0f * kPi * xi[0];
+        const float cosTheta = std::sqrt((1.0f - xi[1]) / (1.0f + (a2 - 1.0f) * xi[1]));
+        const float sinTheta = std::sqrt(std::max(0.0f, 1.0f - cosTheta * cosTheta));
+        return TangentToWorld({ sinTheta * std::cos(phi), sinTheta * std::sin(phi), cosTheta }, N);
+    }
+
+    Float3 CosineSampleHemisphere(const float xi[2], const Float3& N)
+    {
+        const float phi = 2.0f * kPi * xi[0];
+        const float cosTheta = std::sqrt(1.0f - xi[1]);
+        const float sinTheta = std::sqrt(xi[1]);
+        return TangentToWorld({ sinTheta * std::cos(phi), sinTheta * std::sin(phi), cosTheta }, N);
+    }
+
+    // raytracing.hlsl
+    struct SurfaceData
+    {
+        Float3 N;
+        Float3 V;
+        float NdotV;
+        Float3 F0;
+        Float3 albedo;
+        float roughness;
+        float metallic;
+    };
+
+    Float3 EvalSpecularBounce(const SurfaceData& s, const Float3& H, const Float3& bounceDir)
+    {
+        if (Dot(bounceDir, s.N) <= 0.0f)
+            return Splat(0.0f);
+        const float NdotH = std::max(Dot(s.N, H), kEpsilon);
+        const float NdotL = std::max(Dot(s.N, bounceDir), kEpsilon);
+        const float VdotH = std::max(Dot(s.V, H), kEpsilon);
+        const Float3 F = FresnelSchlick(VdotH, s.F0);
+        const float G = SmithG_GGX(s.NdotV, NdotL, s.roughness);
+        return F * (G * VdotH / (s.NdotV * NdotH + kEpsilon));
+    }
+
+    Float3 EvalDiffuseBounce(const SurfaceData& s, const Float3& kD, const Float3& bounceDir)
+    {
+        if (Dot(bounceDir, s.N) <= 0.0f)
+            return Splat(0.0f);
+        return kD * s.albedo;
+    }
+
+    Float3 EvalSpecularDirect(const SurfaceData& s, const Float3& L)
+    {
+        const Float3 H = Normalize(s.V + L);
+        const float NdotL = std::max(Dot(s.N, L), kEpsilon);
+        const float NdotH = std::max(Dot(s.N, H), kEpsilon);
+        const float VdotH = std::max(Dot(s.V, H), kEpsilon);
+        const Float3 F = FresnelSchlick(VdotH, s.F0);
+        const float G = GeometrySmith(s.NdotV, NdotL, s.roughness);
+        const float D = DistributionGGX(NdotH, s.roughness);
+        return F * (G * D) / (4.0f * s.NdotV * NdotL + kEpsilon);
+    }
+
+    Float3 EvalDirectBRDF(const SurfaceData& s, const Float3& L)
+    {
+        if (Dot(s.N, L) <= 0.0f)
+            return Splat(0.0f);
+        const Float3 F = FresnelSchlick(std::max(Dot(s.V, Normalize(s.V + L)), 0.0f), s.F0);
+        const Float3 kD = (Splat(1.0f) - F) * (1.0f - s.metallic);
+        return EvalSpecularDirect(s, L) + kD * (s.albedo / kPi);
+    }
+
+    float GetLightAttenuation(const Float3& shadingPoint, const SceneCacheFormat::LightRecord& light)
+    {
+        if (light.type == 0)
+            return 1.0f;
+        const float dist = Length(Load3(light.position) - shadingPoint);
+        float attenuation = 1.0f / (dist * dist + kEpsilon);
+        if (light.range > 0.0f)
+        {
+            const float ratio = dist / light.range;
+            const float window = Saturate(1.0f - ratio * ratio * ratio * ratio);
+            attenuation *= window * window;
+        }
+        return attenuation;
+    }
+
+    // raytracing.shadow.hlsl; spot lights are not implemented there either.
+    Float3 GetShadowRayDirection(const Float3& shadingPoint, const SceneCacheFormat::LightRecord& light)
+    {
+        if (light.type == 0)
+            return -Load3(light.direction);
+        if (light.type == 1)
+            return Normalize(Load3(light.position) - shadingPoint);
+        return { 0.0f, -1.0f, 0.0f };
+    }
+
+    float GetShadowRayTMax(const Float3& shadingPoint, const SceneCacheFormat::LightRecord& light)
+    {
+        if (light.type == 1)
+            return Length(Load3(light.position) - shadingPoint);
+        return kRayTMax;
+    }
+
+    // postprocess.hlsl
+    Float3 ACESFilmic(const Float3& x)
+    {
+        const auto curve = [](float v) { return Saturate((v * (2.51f * v + 0.03f)) / (v * (2.43f * v + 0.59f) + 0.14f)); };
+        return { curve(x.x), curve(x.y), curve(x.z) };
+    }
+
+    // R8G8B8A8_UNORM store: NaN becomes 0.
+    uint8_t ToUnorm8(float value)
+    {
+        if (!(value > 0.0f))
+            return 0;
+        return static_cast<uint8_t>(std::lround(std::min(value, 1.0f) * 255.0f));
+    }
+
+    BvhRay MakeRay(const Float3& origin, const Float3& direction, float tMin, float tMax)
+    {
+        BvhRay ray;
+        ray.origin[0] = origin.x;
+        ray.origin[1] = origin.y;
+        ray.origin[2] = origin.z;
+        ray.direction[0] = direction.x;
+        ray.direction[1] = direction.y;
+        ray.direction[2] = direction.z;
+        ray.tMin = tMin;
+        ray.tMax = tMax;
+        return ray;
+    }
+
+    bool ReadFloats(const rapidjson::Value& value, float* out, rapidjson::SizeType count)
+    {
+        if (!value.IsArray() || value.Size() != count)
+            return false;
+        for (rapidjson::SizeType i = 0; i < count; ++i)
+        {
+            if (!value[i].IsNumber())
+                return false;
+        }
+        for (rapidjson::SizeType i = 0; i < count; ++i)
+            out[i] = value[i].GetFloat();
+        return true;
+    }
+
+    rapidjson::Value MakeArray(const float* values, size_t count, rapidjson::Document::AllocatorType& alloc)
+    {
+        rapidjson::Value a(rapidjson::kArrayType);
+        for (size_t i = 0; i < count; ++i)
+            a.PushBack(values[i], alloc);
+        return a;
+    }
+
+    rapidjson::Value MakeStr(const std::string& s, rapidjson::Document::AllocatorType& alloc)
+    {
+        rapidjson::Value v;
+        v.SetString(s.c_str(), static_cast<rapidjson::SizeType>(s.size()), alloc);
+        return v;
+    }
+
+    uint32_t LightTypeFromString(const std::string& s)
+    {
+        if (s == "directional") return 0;
+        if (s == "spot")        return 2;
+        return 1;
+    }
+}
+
+// Bilinear, wrap, level 0: SampleLevel(..., uv, 0) with the wrap samplers.
+template <typename Texel>
+static void SampleBilinear(const Texel* texels, uint32_t width, uint32_t height, float u, float v, float scale, float out[4])
+{
+    const float x = u * static_cast<float>(width) - 0.5f;
+    const float y = v * static_cast<float>(height) - 0.5f;
+    const float x0f = std::floor(x);
+    const float y0f = std::floor(y);
+    const float fx = x - x0f;
+    const float fy = y - y0f;
+    const auto wrap = [](float i, uint32_t size)
+    {
+        const float m = std::fmod(i, static_cast<float>(size));
+        const int wrapped = static_cast<int>(m < 0.0f ? m + static_cast<float>(size) : m);
+        return static_cast<size_t>(std::min(wrapped, static_cast<int>(size) - 1));
+    };
+    const size_t x0 = wrap(x0f, width);
+    const size_t x1 = wrap(x0f + 1.0f, width);
+    const size_t y0 = wrap(y0f, height);
+    const size_t y1 = wrap(y0f + 1.0f, height);
+    for (int c = 0; c < 4; ++c)
+    {
+        const float t00 = static_cast<float>(texels[(y0 * width + x0) * 4 + c]);
+        const float t10 = static_cast<float>(texels[(y0 * width + x1) * 4 + c]);
+        const float t01 = static_cast<float>(texels[(y1 * width + x0) * 4 + c]);
+        const float t11 = static_cast<float>(texels[(y1 * width + x1) * 4 + c]);
+        const float top = t00 + (t10 - t00) * fx;
+        const float bottom = t01 + (t11 - t01) * fx;
+        out[c] = (top + (bottom - top) * fy) * scale;
+    }
+}
+
+namespace
+{
+    bool ParseStates(const std::filesystem::path& statesPath, const std::string& scene, rapidjson::Document& doc)
+    {
+        std::ifstream file(statesPath, std::ios::binary);
+        if (!file)
+            return false;
+        std::stringstream ss;
+        ss << file.rdbuf();
+        const std::string json = ss.str();
+        return !doc.Parse(json.c_str()).HasParseError() && doc.IsObject() && doc.HasMember(scene.c_str()) && doc[scene.c_str()].IsArray();
+    }
+}
+
+std::vector<std::string> ListReferenceStates(const std::filesystem::path& statesPath, const std::string& scene)
+{
+    std::vector<std::string> names;
+    rapidjson::Document doc;
+    if (!ParseStates(statesPath, scene, doc))
+        return names;
+    for (const auto& entry : doc[scene.c_str()].GetArray())
+        if (entry.IsObject() && entry.HasMember("name") && entry["name"].IsString())
+            names.emplace_back(entry["name"].GetString());
+    return names;
+}
+
+bool LoadReferenceState(const std::filesystem::path& statesPath, const std::string& scene, const std::string& name, ReferenceState& state)
+{
+    rapidjson::Document doc;
+    if (!ParseStates(statesPath, scene, doc))
+        return false;
+
+    for (const auto& entry : doc[scene.c_str()].GetArray())
+    {
+        if (!entry.IsObject() || !entry.HasMember("name") || !entry["name"].IsString() || name != entry["name"].GetString())
+            continue;
+
+        state = ReferenceState();
+        if (entry.HasMember("position")) ReadFloats(entry["position"], state.camera.position, 3);
+        if (entry.HasMember("rotation")) ReadFloats(entry["rotation"], state.camera.rotation, 4);
+        if (entry.HasMember("fov") && entry["fov"].IsNumber()) state.camera.fovYRadians = entry["fov"].GetFloat();
+
+        if (entry.HasMember("lights") && entry["lights"].IsArray())
+        {
+            state.hasLights = true;
+            for (const auto& lo : entry["lights"].GetArray())
+            {
+                if (!lo.IsObject()) continue;
+                SceneCacheFormat::LightRecord light{};
+                light.type = lo.HasMember("type") && lo["type"].IsString() ? LightTypeFromString(lo["type"].GetString()) : 1u;
+                if (lo.HasMember("position"))  ReadFloats(lo["position"],  light.position, 3);
+                if (lo.HasMember("direction")) ReadFloats(lo["direction"], light.direction, 3);
+                if (lo.HasMember("color"))     ReadFloats(lo["color"],     light.color, 3);
+                if (lo.HasMember("intensity") && lo["intensity"].IsNumber()) light.intensity = lo["intensity"].GetFloat();
+                if (lo.HasMember("range")     && lo["range"].IsNumber())     light.range     = lo["range"].GetFloat();
+                state.lights.push_back(light);
+            }
+        }
+        return true;
+    }
+    return false;
+}
+
+std::vector<SceneCacheFormat::LightRecord> ConvertHeadlessLights(const std::vector<HeadlessLight>& lights)
+{
+    const std::unordered_map<std::string, uint32_t> typeByName = {
+        { "directional", 0u },
+        { "point",       1u },
+        { "spot",        2u },
+    };
+
+    std::vector<SceneCacheFormat::LightRecord> out;
+    out.reserve(lights.size());
+    for (const HeadlessLight& source : lights)
+    {
+        const auto it = typeByName.find(source.type);
+        if (it == typeByName.end())
+            continue;
+
+        SceneCacheFormat::LightRecord light{};
+        light.type = it->second;
+        std::copy(source.position, source.position + 3, light.position);
+        std::copy(source.direction, source.direction + 3, light.direction);
+        std::copy(source.color, source.color + 3, light.color);
+        light.intensity = source.intensity;
+        light.range = source.range;
+        out.push_back(light);
+    }
+    return out;
+}
+
+bool LoadReferenceSky(const std::filesystem::path& path, ReferenceSky& sky)
+{
+    std::ifstream file(path, std::ios::binary);
+    std::string magic;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    float scale = 0.0f;
+    if (!(file >> magic >> width >> height >> scale) || (magic != "PF" && magic != "Pf") || width == 0 || height == 0 || scale == 0.0f)
+        return false;
+    file.get(); // the single whitespace byte before the raster
+
+    const size_t channels = magic == "PF" ? 3 : 1;
+    std::vector<float> raster(static_cast<size_t>(width) * height * channels);
+    if (!file.read(reinterpret_cast<char*>(raster.data()), static_cast<std::streamsize>(raster.size() * sizeof(float))))
+        return false;
+
+    // Negative scale = little-endian.
+    const uint16_t probe = 1;
+    const bool hostLittleEndian = *reinterpret_cast<const uint8_t*>(&probe) == 1;
+    if ((scale < 0.0f) != hostLittleEndian)
+    {
+        for (float& value : raster)
+        {
+            uint8_t* bytes = reinterpret_cast<uint8_t*>(&value);
+            std::swap(bytes[0], bytes[3]);
+            std::swap(bytes[1], bytes[2]);
+        }
+    }
+
+    // PFM rows run bottom to top; the SRV's top to bottom.
+    sky.width = width;
+    sky.height = height;
+    sky.rgba.resize(static_cast<size_t>(width) * height * 4);
+    for (uint32_t y = 0; y < height; ++y)
+    {
+        const float* source = raster.data() + static_cast<size_t>(height - 1 - y) * width * channels;
+        float* dest = sky.rgba.data() + static_cast<size_t>(y) * width * 4;
+        for (uint32_t x = 0; x < width; ++x)
+        {
+            for (size_t c = 0; c < 3; ++c)
+                dest[x * 4 + c] = source[x * channels + (channels == 3 ? c : 0)];
+            dest[x * 4 + 3] = 1.0f;
+        }
+    }
+    return true;
+}
+
+ReferencePathTracer::Settings ReferencePathTracer::Settings::FromConfig(const HeadlessConfig& config, uint32_t frames)
+{
+    Settings settings;
+    settings.width = config.width;
+    settings.height = config.height;
+    settings.samplesPerPixel = config.spp;
+    settings.bounces = config.bounces;
+    settings.frames = frames;
+    settings.indirectSkyClamp = config.indirectSkyClamp;
+    settings.skyLighting = config.skyLighting;
+    return settings;
+}
+
+double ReferencePathTracer::Stats::MegaRaysPerSecond() const
+{
+    return milliseconds > 0.0 ? static_cast<double>(closestHitRays + shadowRays) / (milliseconds * 1000.0) : 0.0;
+}
+
+double ReferencePathTracer::Stats::MegaSamplesPerSecond() const
+{
+    return milliseconds > 0.0 ? static_cast<double>(pathSamples) / (milliseconds * 1000.0) : 0.0;
+}
+
+bool ReferencePathTracer::Load(const SceneCacheFormat::Reader& cache, const BvhBuildSettings& bvhSettings)
+{
+    if (cache.GetVertexStride() != sizeof(VertexPacking::FloatVertex) || cache.GetVertexCount() == 0 || cache.GetIndices().empty())
+        return false;
+
+    m_vertices = static_cast<const uint8_t*>(cache.GetVertexData());
+    m_indices = cache.GetIndices().data;
+
+    m_textures.clear();
+    for (const SceneCacheFormat::TextureRecord& texture : cache.GetTextures())
+        m_textures.push_back({ texture.width, texture.height, cache.GetTexels(texture) });
+
+    // The last material stands in for primitives without one.
+    m_materials.clear();
+    for (const SceneCacheFormat::MaterialRecord& record : cache.GetMaterials())
+    {
+        Material material;
+        std::copy(record.baseColorFactor, record.baseColorFactor + 4, material.baseColorFactor);
+        material.metallicFactor = record.metallicFactor;
+        material.roughnessFactor = record.roughnessFactor;
+        material.albedoTexture = record.albedoTexture;
+        material.normalTexture = record.normalTexture;
+        material.metallicRoughnessTexture = record.metallicRoughnessTexture;
+        material.opaque = record.isOpaque != 0;
+        m_materials.push_back(material);
+    }
+    const auto defaultMaterial = static_cast<uint32_t>(m_materials.size());
+    m_materials.emplace_back();
+
+    SceneCacheGeometry placed;
+    placed.Load(cache);
+    m_geometries = placed.geometries;
+
+    const auto primitives = cache.GetPrimitives();
+    m_instances.clear();
+    m_instances.reserve(placed.instances.size());
+    for (BvhInstance& bvhInstance : placed.instances)
+    {
+        Instance instance;
+        instance.geometry = bvhInstance.geometry;
+        const int32_t materialIndex = primitives[bvhInstance.geometry].materialIndex;
+        instance.material = materialIndex >= 0 ? static_cast<uint32_t>(materialIndex) : defaultMaterial;
+        std::copy(&bvhInstance.objectToWorld[0][0], &bvhInstance.objectToWorld[0][0] + 12, &instance.objectToWorld[0][0]);
+        m_instances.push_back(instance);
+        bvhInstance.opaque = m_materials[instance.material].opaque;
+    }
+
+    const SceneBvhInput input = placed.MakeInput(cache);
+    m_bvh.Build(input, bvhSettings);
+    m_bvh.SetHitFilter(&ReferencePathTracer::AcceptHit, this);
+
+    m_lights.assign(cache.GetLights().begin(), cache.GetLights().end());
+    return true;
+}
+
+// The AnyHit / ShadowHit alpha test of non-opaque geometry.
+bool ReferencePathTracer::AcceptHit(const void* self, uint32_t instance, uint32_t primitive, float u, float v)
+{
+    const auto& tracer = *static_cast<const ReferencePathTracer*>(self);
+    const Instance& placed = tracer.m_instances[instance];
+    const Material& material = tracer.m_materials[placed.material];
+    float alpha = material.baseColorFactor[3];
+    if (material.albedoTexture >= 0)
+    {
+        const BvhGeometry& geometry = tracer.m_geometries[placed.geometry];
+        const uint32_t* indices = tracer.m_indices + geometry.indexOffset + primitive * 3;
+        const auto* vertices = reinterpret_cast<const VertexPacking::FloatVertex*>(tracer.m_vertices) + geometry.vertexOffset;
+        const float w = 1.0f - u - v;
+        const float uv[2] = {
+            w * vertices[indices[0]].uv[0] + u * vertices[indices[1]].uv[0] + v * vertices[indices[2]].uv[0],
+            w * vertices[indices[0]].uv[1] + u * vertices[indices[1]].uv[1] + v * vertices[indices[2]].uv[1],
+        };
+        const Texture& texture = tracer.m_textures[material.albedoTexture];
+        float texel[4];
+        SampleBilinear(texture.texels, texture.width, texture.height, uv[0], uv[1], 1.0f / 255.0f, texel);
+        alpha *= texel[3];
+    }
+    return alpha >= kEpsilon;
+}
+
+struct ReferencePathTracer::TileContext
+{
+    const Settings* settings;
+    uint32_t tilesX;
+    Float3 origin;
+    Float3 forward;
+    Float3 right;
+    Float3 up;
+    float tanHalfFovY;
+    float aspectRatio;
+    float* rgb;
+};
+
+ReferencePathTracer::Stats ReferencePathTracer::Render(const ReferenceCamera& camera, const Settings& settings, std::vector<float>& rgb) const
+{
+    const auto start = std::chrono::high_resolution_clock::now();
+    rgb.assign(static_cast<size_t>(settings.width) * settings.height * 3, 0.0f);
+
+    // Camera::UpdateMatrices; viewI * projectionI of the camera ray reduce to
+    // forward + ndc.x * tan * aspect * right + ndc.y * tan * up.
+    TileContext context;
+    context.settings = &settings;
+    const uint32_t tileSize = std::max(settings.tileSize, 1u);
+    context.tilesX = (settings.width + tileSize - 1) / tileSize;
+    context.origin = Load3(camera.position);
+    context.forward = Rotate(camera.rotation, { 0.0f, 0.0f, 1.0f });
+    context.right = Rotate(camera.rotation, { -1.0f, 0.0f, 0.0f });
+    context.up = Rotate(camera.rotation, { 0.0f, 1.0f, 0.0f });
+    context.tanHalfFovY = std::tan(camera.fovYRadians * 0.5f);
+    context.aspectRatio = camera.aspectRatio;
+    context.rgb = rgb.data();
+
+    const uint32_t tilesY = (settings.height + tileSize - 1) / tileSize;
+    const size_t tileCount = static_cast<size_t>(context.tilesX) * tilesY;
+    std::vector<Stats> tileStats(tileCount);
+    ThreadPool::Get().ParallelFor(tileCount, [&](size_t tile)
+    {
+        RenderTile(context, static_cast<uint32_t>(tile), tileStats[tile]);
+    });
+
+    Stats stats;
+    for (const Stats& tile : tileStats)
+    {
+        stats.pathSamples += tile.pathSamples;
+        stats.closestHitRays += tile.closestHitRays;
+        stats.shadowRays += tile.shadowRays;
+    }
+    stats.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    return stats;
+}
+
+// raytracing.hlsl RayGen for every pixel of the tile, over all frames.
+void ReferencePathTracer::RenderTile(const TileContext& context, uint32_t tile, Stats& stats) const
+{
+    const Settings& settings = *context.settings;
+    const uint32_t tileSize = std::max(settings.tileSize, 1u);
+    const uint32_t x0 = (tile % context.tilesX) * tileSize;
+    const uint32_t y0 = (tile / context.tilesX) * tileSize;
+    const uint32_t x1 = std::min(x0 + tileSize, settings.width);
+    const uint32_t y1 = std::min(y0 + tileSize, settings.height);
+    const uint32_t spp = std::max(settings.samplesPerPixel, 1u);
+    const uint32_t frames = std::max(settings.frames, 1u);
+
+    const auto skyRadiance = [&](const Float3& dir, uint32_t vertexIndex)
+    {
+        if ((vertexIndex > 0u && !settings.skyLighting) || m_sky.rgba.empty())
+            return Splat(0.0f);
+        const float u = std::atan2(dir.z, dir.x) / (2.0f * kPi) + 0.5f;
+        const float v = -std::asin(std::clamp(dir.y, -1.0f, 1.0f)) / kPi + 0.5f;
+        float texel[4];
+        SampleBilinear(m_sky.rgba.data(), m_sky.width, m_sky.height, u, v, 1.0f, texel);
+        Float3 sky{ texel[0], texel[1], texel[2] };
+        if (vertexIndex > 0u && settings.indirectSkyClamp > 0.0f)
+            sky = { std::min(sky.x, settings.indirectSkyClamp), std::min(sky.y, settings.indirectSkyClamp), std::min(sky.z, settings.indirectSkyClamp) };
+        return sky;
+    };
+
+    const auto sampleTexture = [&](int32_t index, const float uv[2], float out[4])
+    {
+        if (index < 0)
+        {
+            out[0] = out[1] = out[2] = out[3] = 1.0f;
+            return;
+        }
+        const Texture& texture = m_textures[index];
+        SampleBilinear(texture.texels, texture.width, texture.height, uv[0], uv[1], 1.0f / 255.0f, out);
+    };
+
+    for (uint32_t y = y0; y < y1; ++y)
+    {
+        for (uint32_t x = x0; x < x1; ++x)
+        {
+            const uint32_t pixelId = x + y * settings.width;
+            Float3 pixel = Splat(0.0f);
+            for (uint32_t frameIndex = 0; frameIndex < frames; ++frameIndex)
+            {
+                Float3 accumulated = Splat(0.0f);
+                for (uint32_t i = 0; i < spp; ++i)
+                {
+                    uint32_t seed = PcgHash(pixelId ^ (i * 2654435761u) ^ (frameIndex * 805459861u));
+
+                    float jitter[2];
+                    Random2D(seed, jitter);
+                    const float dx = ((static_cast<float>(x) + 0.5f + (jitter[0] - 0.5f)) / static_cast<float>(settings.width)) * 2.0f - 1.0f;
+                    const float dy = ((static_cast<float>(y) + 0.5f + (jitter[1] - 0.5f)) / static_cast<float>(settings.height)) * 2.0f - 1.0f;
+                    Float3 rayOrigin = context.origin;
+                    Float3 rayDir = Normalize(context.forward + context.right * (dx * context.tanHalfFovY * context.aspectRatio) + context.up * (-dy * context.tanHalfFovY));
+                    seed = PcgHash(seed);
+
+                    Float3 radiance = Splat(0.0f);
+                    Float3 pathThroughput = Splat(1.0f);
+                    for (uint32_t vertexIndex = 0; vertexIndex <= settings.bounces; ++vertexIndex)
+                    {
+                        BvhHit hit;
+                        ++stats.closestHitRays;
+                        if (!m_bvh.Intersect(MakeRay(rayOrigin, rayDir, kRayTMin, kRayTMax), hit))
+                        {
+                            radiance += pathThroughput * skyRadiance(rayDir, vertexIndex);
+                            break;
+                        }
+
+                        // GetHitData with an explicit objectToWorld.
+                        const Instance& instance = m_instances[hit.instance];
+                        const Material& material = m_materials[instance.material];
+                        const BvhGeometry& geometry = m_geometries[instance.geometry];
+                        const uint32_t* indices = m_indices + geometry.indexOffset + hit.primitive * 3;
+                        const auto* vertices = reinterpret_cast<const VertexPacking::FloatVertex*>(m_vertices) + geometry.vertexOffset;
+                        const VertexPacking::FloatVertex& a = vertices[indices[0]];
+                        const VertexPacking::FloatVertex& b = vertices[indices[1]];
+                        const VertexPacking::FloatVertex& c = vertices[indices[2]];
+                        const float w0 = 1.0f - hit.u - hit.v;
+                        const float w1 = hit.u;
+                        const float w2 = hit.v;
+
+                        const Float3 triNormal = Normalize(Cross(Load3(b.position) - Load3(a.position), Load3(c.position) - Load3(a.position)));
+                        const float uv[2] = { w0 * a.uv[0] + w1 * b.uv[0] + w2 * c.uv[0], w0 * a.uv[1] + w1 * b.uv[1] + w2 * c.uv[1] };
+                        const Float3 normal = TransformNormalToWorld(instance.objectToWorld, Normalize(Load3(a.normal) * w0 + Load3(b.normal) * w1 + Load3(c.normal) * w2));
+                        const Float3 interpTangent = Normalize(Load3(a.tangent) * w0 + Load3(b.tangent) * w1 + Load3(c.tangent) * w2);
+                        const Float3 tangent = Normalize(Mul3x3(instance.objectToWorld, interpTangent));
+                        const float tangentSign = a.tangent[3];
+                        const Float3 position = MulPoint(instance.objectToWorld, Load3(a.position) * w0 + Load3(b.position) * w1 + Load3(c.position) * w2);
+
+                        float albedoTexel[4];
+                        sampleTexture(material.albedoTexture, uv, albedoTexel);
+                        const Float3 albedo = Float3{ albedoTexel[0], albedoTexel[1], albedoTexel[2] } * Load3(material.baseColorFactor);
+                        float mr[4];
+                        sampleTexture(material.metallicRoughnessTexture, uv, mr);
+                        const float roughness = std::max(material.roughnessFactor * mr[1], kMinRoughness);
+                        const float metallic = material.metallicFactor * mr[2];
+
+                        // SampleWorldSpaceNormal
+                        Float3 N = normal;
+                        if (material.normalTexture >= 0)
+                        {
+                            Float3 T = tangent - N * Dot(tangent, N);
+                            if (Dot(T, T) >= 1e-8f)
+                            {
+                                T = Normalize(T);
+                                float texel[4];
+                                sampleTexture(material.normalTexture, uv, texel);
+                                const float nx = texel[0] * 2.0f - 1.0f;
+                                const float ny = texel[1] * 2.0f - 1.0f;
+                                const float nz = std::sqrt(Saturate(1.0f - (nx * nx + ny * ny)));
+                                const Float3 B = Cross(N, T) * tangentSign;
+                                N = Normalize(T * nx + B * ny + N * nz);
+                            }
+                        }
+                        const Float3 V = -rayDir;
+
+                        const Float3 geometricN = Normalize(Mul3x3(instance.objectToWorld, triNormal));
+                        if (Dot(geometricN, V) < 0.0f)
+                            N = -N;
+
+                        SurfaceData surface;
+                        surface.N = N;
+                        surface.V = V;
+                        surface.NdotV = std::max(Dot(N, V), 1e-4f);
+                        surface.F0 = Splat(kDielectricF0) + (albedo - Splat(kDielectricF0)) * metallic;
+                        surface.albedo = albedo;
+                        surface.roughness = roughness;
+                        surface.metallic = metallic;
+
+                        // CalculateDirectLightning
+                        Float3 direct = Splat(0.0f);
+                        for (const SceneCacheFormat::LightRecord& light : m_lights)
+                        {
+                            const Float3 L = GetShadowRayDirection(position, light);
+                            ++stats.shadowRays;
+                            if (m_bvh.Occluded(MakeRay(position + surface.N * kEpsilon, L, kRayTMin, GetShadowRayTMax(position, light))))
+                                continue;
+                            const float atten = GetLightAttenuation(position, light);
+                            const Float3 brdf = EvalDirectBRDF(surface, L);
+                            direct += brdf * Load3(light.color) * (light.intensity * atten * std::max(Dot(surface.N, L), 0.0f));
+                        }
+                        radiance += pathThroughput * direct;
+
+                        if (vertexIndex >= settings.bounces)
+                            break;
+
+                        const Float3 F = FresnelSchlick(surface.NdotV, surface.F0);
+                        const float specularProb = (F.x + F.y + F.z) / 3.0f;
+
+                        float xi[2];
+                        Random2D(seed, xi);
+                        seed = PcgHash(seed);
+                        const float pathSelector = Random1D(seed);
+                        seed = PcgHash(seed);
+
+                        Float3 bounceDir;
+                        Float3 throughput;
+                        if (pathSelector < specularProb)
+                        {
+                            const Float3 H = ImportanceSampleGGX(xi, N, roughness);
+                            bounceDir = Reflect(-V, H);
+                            throughput = EvalSpecularBounce(surface, H, bounceDir);
+                            if (throughput.IsZero())
+                                break;
+                            throughput = throughput / specularProb;
+                        }
+                        else
+                        {
+                            const Float3 kD = (Splat(1.0f) - F) * (1.0f - metallic);
+                            bounceDir = CosineSampleHemisphere(xi, N);
+                            throughput = EvalDiffuseBounce(surface, kD, bounceDir);
+                            if (throughput.IsZero())
+                                break;
+                            throughput = throughput / (1.0f - specularProb);
+                        }
+
+                        pathThroughput *= throughput;
+                        rayOrigin = position;
+                        rayDir = bounceDir;
+                    }
+                    accumulated += radiance;
+                    ++stats.pathSamples;
+                }
+                pixel += accumulated / static_cast<float>(spp);
+            }
+
+            float* out = context.rgb + static_cast<size_t>(pixelId) * 3;
+            out[0] = pixel.x / static_cast<float>(frames);
+            out[1] = pixel.y / static_cast<float>(frames);
+            out[2] = pixel.z / static_cast<float>(frames);
+        }
+    }
+}
+
+bool ReferenceOutput::WritePfm(const std::filesystem::path& path, const float* rgb, uint32_t width, uint32_t height)
+{
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file)
+        return false;
+
+    // Negative scale = little-endian; rows run bottom to top.
+    char header[64];
+    const int headerSize = std::snprintf(header, sizeof(header), "PF\n%u %u\n-1.0\n", width, height);
+    file.write(header, headerSize);
+    for (uint32_t row = height; row-- > 0;)
+        file.write(reinterpret_cast<const char*>(rgb + static_cast<size_t>(row) * width * 3), static_cast<std::streamsize>(width) * 3 * sizeof(float));
+    return file.good();
+}
+
+bool ReferenceOutput::WritePng(const std::filesystem::path& path, const float* rgb, uint32_t width, uint32_t height, const HeadlessConfig& config)
+{
+    std::vector<uint8_t> pixels(static_cast<size_t>(width) * height * 4);
+    for (size_t i = 0; i < static_cast<size_t>(width) * height; ++i)
+    {
+        Float3 color = Load3(rgb + i * 3) * config.exposure;
+        color = { std::pow(std::max(color.x, 0.0f), config.contrast), std::pow(std::max(color.y, 0.0f), config.contrast), std::pow(std::max(color.z, 0.0f), config.contrast) };
+        color = ACESFilmic(color);
+        color += (Splat(1.0f) - color) * config.lift;
+        const float luma = Dot(color, { 0.2126f, 0.7152f, 0.0722f });
+        color = Splat(luma) + (color - Splat(luma)) * config.saturation;
+
+        pixels[i * 4 + 0] = ToUnorm8(std::pow(color.x, 1.0f / 2.2f));
+        pixels[i * 4 + 1] = ToUnorm8(std::pow(color.y, 1.0f / 2.2f));
+        pixels[i * 4 + 2] = ToUnorm8(std::pow(color.z, 1.0f / 2.2f));
+        pixels[i * 4 + 3] = 255;
+    }
+    return stbi_write_png(path.string().c_str(), static_cast<int>(width), static_cast<int>(height), 4, pixels.data(), static_cast<int>(width * 4)) != 0;
+}
+
+bool ReferenceOutput::WriteSidecarJson(const std::filesystem::path& path, const ReferenceCamera& camera, const ReferencePathTracer::Settings& settings,
+    const HeadlessConfig& config, const ReferencePathTracer::Stats& stats, const std::string& model, const std::string& place)
+{
+    using namespace rapidjson;
+    Document doc(kObjectType);
+    auto& a = doc.GetAllocator();
+
+    {
+        Value cam(kObjectType);
+        cam.AddMember("position", MakeArray(camera.position, 3, a), a);
+        cam.AddMember("rotation", MakeArray(camera.rotation, 4, a), a);
+        cam.AddMember("fov",      camera.fovYRadians, a);
+        doc.AddMember("camera", cam, a);
+    }
+    {
+        Value sc(kObjectType);
+        sc.AddMember("model", MakeStr(model, a), a);
+        sc.AddMember("place", MakeStr(place, a), a);
+        doc.AddMember("scene", sc, a);
+    }
+    doc.AddMember("technique", "Reference", a);
+    {
+        Value pp(kObjectType);
+        pp.AddMember("enabled",    config.postProcessEnabled, a);
+        pp.AddMember("exposure",   config.exposure,   a);
+        pp.AddMember("contrast",   config.contrast,   a);
+        pp.AddMember("saturation", config.saturation, a);
+        pp.AddMember("lift",       config.lift,       a);
+        doc.AddMember("postProcess", pp, a);
+    }
+    {
+        Value rt(kObjectType);
+        rt.AddMember("spp",     settings.samplesPerPixel, a);
+        rt.AddMember("bounces", settings.bounces,         a);
+        rt.AddMember("frames",  settings.frames,          a);
+        doc.AddMember("raytracing", rt, a);
+    }
+    {
+        Value rd(kObjectType);
+        rd.AddMember("width",  settings.width,  a);
+        rd.AddMember("height", settings.height, a);
+        doc.AddMember("render", rd, a);
+    }
+    {
+        Value perf(kObjectType);
+        perf.AddMember("milliseconds",      stats.milliseconds, a);
+        perf.AddMember("pathSamples",       stats.pathSamples, a);
+        perf.AddMember("closestHitRays",    stats.closestHitRays, a);
+        perf.AddMember("shadowRays",        stats.shadowRays, a);
+        perf.AddMember("megaRaysPerSecond", stats.MegaRaysPerSecond(), a);
+        perf.AddMember("megaSamplesPerSecond", stats.MegaSamplesPerSecond(), a);
+        perf.AddMember("threads",           ThreadPool::Get().GetThreadCount(), a);
+        doc.AddMember("throughput", perf, a);
+    }
+
+    StringBuffer sb;
+    PrettyWriter<StringBuffer> writer(sb);
+    doc.Accept(writer);
+
+    std::ofstream f(path, std::ios::binary | std::ios::trunc);
+    if (!f)
+        return false;
+    f.write(sb.GetString(), static_cast<std::streamsize>(sb.GetSize()));
+    return f.good();
+}
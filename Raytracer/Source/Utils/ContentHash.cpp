@@ -0,0 +1,100 @@
+#include "Utils/ContentHash.h"
+
+#include <cstring>
+
+#include "Utils/MappedFile.h"
+
+namespace
+{
+    constexpr uint64_t PRIME1 = 11400714785074694791ull;
+    constexpr uint64_t PRIME2 = 14029467366897019727ull;
+    constexpr uint64_t PRIME3 = 1609587929392839161ull;
+    constexpr uint64_t PRIME4 = 9650029242287828579ull;
+    constexpr uint64_t PRIME5 = 2870177450012600261ull;
+
+    inline uint64_t Rotl(uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+
+    inline uint64_t Read64(const uint8_t* p) { uint64_t v; std::memcpy(&v, p, sizeof(v)); return v; }
+    inline uint32_t Read32(const uint8_t* p) { uint32_t v; std::memcpy(&v, p, sizeof(v)); return v; }
+
+    inline uint64_t Round(uint64_t acc, uint64_t input)
+    {
+        acc += input * PRIME2;
+        acc = Rotl(acc, 31);
+        return acc * PRIME1;
+    }
+
+    inline uint64_t MergeRound(uint64_t acc, uint64_t value)
+    {
+        acc ^= Round(0, value);
+        return acc * PRIME1 + PRIME4;
+    }
+}
+
+uint64_t ContentHash::HashBytes(const void* data, size_t size, uint64_t seed)
+{
+    const auto* p = static_cast<const uint8_t*>(data);
+    const uint8_t* const end = p + size;
+    uint64_t h;
+
+    if (size >= 32)
+    {
+        uint64_t v1 = seed + PRIME1 + PRIME2;
+        uint64_t v2 = seed + PRIME2;
+        uint64_t v3 = seed;
+        uint64_t v4 = seed - PRIME1;
+        const uint8_t* const limit = end - 32;
+        do
+        {
+            v1 = Round(v1, Read64(p)); p += 8;
+            v2 = Round(v2, Read64(p)); p += 8;
+            v3 = Round(v3, Read64(p)); p += 8;
+            v4 = Round(v4, Read64(p)); p += 8;
+        } while (p <= limit);
+
+        h = Rotl(v1, 1) + Rotl(v2, 7) + Rotl(v3, 12) + Rotl(v4, 18);
+        h = MergeRound(h, v1);
+        h = MergeRound(h, v2);
+        h = MergeRound(h, v3);
+        h = MergeRound(h, v4);
+    }
+    else
+    {
+        h = seed + PRIME5;
+    }
+
+    h += static_cast<uint64_t>(size);
+
+    for (; p + 8 <= end; p += 8)
+    {
+        h ^= Round(0, Read64(p));
+        h = Rotl(h, 27) * PRIME1 + PRIME4;
+    }
+    if (p + 4 <= end)
+    {
+        h ^= static_cast<uint64_t>(Read32(p)) * PRIME1;
+        h = Rotl(h, 23) * PRIME2 + PRIME3;
+        p += 4;
+    }
+    for (; p < end; ++p)
+    {
+        h ^= static_cast<uint64_t>(*p) * PRIME5;
+        h = Rotl(h, 11) * PRIME1;
+    }
+
+    h ^= h >> 33;
+    h *= PRIME2;
+    h ^= h >> 29;
+    h *= PRIME3;
+    h ^= h >> 32;
+    return h;
+}
+
+bool ContentHash::HashFile(const std::filesystem::path& path, uint64_t& outHash)
+{
+    MappedFile file;
+    if (!file.Open(path))
+        return false;
+    outHash = HashBytes(file.Data(), file.Size());
+    return true;
+}
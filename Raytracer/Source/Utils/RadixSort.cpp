@@ -0,0 +1,182 @@
+#include "Utils/RadixSort.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "Utils/ThreadPool.h"
+
+namespace
+{
+    constexpr size_t kBlockMin = 16384; // keys per histogram/scatter block
+    constexpr size_t kBitonicGrain = 16384;
+    constexpr size_t kMaxRadix = 2048;
+    constexpr uint32_t kLineKeys = 8; // one 64-byte line of keys
+
+    // Blocks keep their place in every pass, so ordering the scatter offsets
+    // digit-major, block-minor makes each pass stable.
+    template <bool HasValues>
+    void SortImpl(uint64_t* keys, uint32_t* values, size_t count, uint32_t digitBits)
+    {
+        if (count < 2)
+            return;
+
+        ThreadPool& pool = ThreadPool::Get();
+        digitBits = digitBits >= 11 ? 11u : 8u;
+        const size_t radix = size_t(1) << digitBits;
+        const uint64_t digitMask = radix - 1;
+        const size_t blockCount = std::max<size_t>(1, std::min<size_t>(pool.GetThreadCount(), count / kBlockMin));
+        std::vector<size_t> blockBounds(blockCount + 1);
+        for (size_t b = 0; b <= blockCount; ++b)
+            blockBounds[b] = count * b / blockCount;
+
+        // Bits that differ anywhere in the input; a pass over a digit without
+        // any of them would only copy.
+        std::vector<uint64_t> blockDiff(blockCount, 0);
+        pool.ParallelFor(blockCount, [&](size_t b)
+        {
+            uint64_t diff = 0;
+            for (size_t i = blockBounds[b]; i < blockBounds[b + 1]; ++i)
+                diff |= keys[i] ^ keys[0];
+            blockDiff[b] = diff;
+        });
+        uint64_t diff = 0;
+        for (uint64_t blockBits : blockDiff)
+            diff |= blockBits;
+        if (diff == 0)
+            return;
+
+        std::vector<uint64_t> keyScratch(count);
+        std::vector<uint32_t> valueScratch(HasValues ? count : 0);
+        uint64_t* keySource = keys;
+        uint64_t* keyTarget = keyScratch.data();
+        uint32_t* valueSource = values;
+        uint32_t* valueTarget = valueScratch.data();
+        std::vector<size_t> offsets(blockCount * radix);
+
+        for (uint32_t shift = 0; shift < 64; shift += digitBits)
+        {
+            if (((diff >> shift) & digitMask) == 0)
+                continue;
+
+            // Counters live in a local array: a pointer into offsets may alias
+            // the uint64 keys and would force a reload per element.
+            pool.ParallelFor(blockCount, [&](size_t b)
+            {
+                size_t histogram[kMaxRadix] = {};
+                const uint64_t* source = keySource;
+                for (size_t i = blockBounds[b]; i < blockBounds[b + 1]; ++i)
+                    ++histogram[(source[i] >> shift) & digitMask];
+                std::copy(histogram, histogram + radix, &offsets[b * radix]);
+            });
+
+            size_t sum = 0;
+            for (size_t d = 0; d < radix; ++d)
+            {
+                for (size_t b = 0; b < blockCount; ++b)
+                {
+                    const size_t digitCount = offsets[b * radix + d];
+                    offsets[b * radix + d] = sum;
+                    sum += digitCount;
+                }
+            }
+
+            // Writes go through a cache line per digit first. Scattering key by
+            // key into up to 2048 streams thrashes the cache, and structured
+            // keys (sequential low bits) make every stream alias the same sets.
+            pool.ParallelFor(blockCount, [&](size_t b)
+            {
+                size_t offset[kMaxRadix];
+                uint32_t fill[kMaxRadix] = {};
+                std::copy(&offsets[b * radix], &offsets[b * radix] + radix, offset);
+                std::vector<uint64_t> keyLines(radix * kLineKeys);
+                std::vector<uint32_t> valueLines(HasValues ? radix * kLineKeys : 0);
+                const uint64_t* source = keySource;
+                uint64_t* target = keyTarget;
+                for (size_t i = blockBounds[b]; i < blockBounds[b + 1]; ++i)
+                {
+                    const size_t digit = (source[i] >> shift) & digitMask;
+                    const uint32_t used = fill[digit];
+                    keyLines[digit * kLineKeys + used] = source[i];
+                    if constexpr (HasValues)
+                        valueLines[digit * kLineKeys + used] = valueSource[i];
+                    if (used + 1 < kLineKeys)
+                    {
+                        fill[digit] = used + 1;
+                        continue;
+                    }
+                    std::copy(&keyLines[digit * kLineKeys], &keyLines[digit * kLineKeys] + kLineKeys, target + offset[digit]);
+                    if constexpr (HasValues)
+                        std::copy(&valueLines[digit * kLineKeys], &valueLines[digit * kLineKeys] + kLineKeys, valueTarget + offset[digit]);
+                    offset[digit] += kLineKeys;
+                    fill[digit] = 0;
+                }
+                for (size_t digit = 0; digit < radix; ++digit)
+                {
+                    std::copy(&keyLines[digit * kLineKeys], &keyLines[digit * kLineKeys] + fill[digit], target + offset[digit]);
+                    if constexpr (HasValues)
+                        std::copy(&valueLines[digit * kLineKeys], &valueLines[digit * kLineKeys] + fill[digit], valueTarget + offset[digit]);
+                }
+            });
+
+            std::swap(keySource, keyTarget);
+            std::swap(valueSource, valueTarget);
+        }
+
+        if (keySource != keys)
+        {
+            std::copy(keySource, keySource + count, keys);
+            if constexpr (HasValues)
+                std::copy(valueSource, valueSource + count, values);
+        }
+    }
+}
+
+void RadixSort::Sort(uint64_t* keys, size_t count, const Settings& settings)
+{
+    SortImpl<false>(keys, nullptr, count, settings.digitBits);
+}
+
+void RadixSort::Sort(uint64_t* keys, uint32_t* values, size_t count, const Settings& settings)
+{
+    SortImpl<true>(keys, values, count, settings.digitBits);
+}
+
+void RadixSort::SortPadded(uint64_t* keys, size_t count, size_t capacity, const Settings& settings)
+{
+    count = std::min(count, capacity);
+    std::fill(keys + count, keys + capacity, NULL_KEY);
+    Sort(keys, count, settings);
+}
+
+void RadixSort::BitonicSort(uint64_t* keys, size_t count)
+{
+    if (count < 2)
+        return;
+
+    size_t size = 1;
+    while (size < count)
+        size <<= 1;
+    std::vector<uint64_t> padded(size, NULL_KEY);
+    std::copy(keys, keys + count, padded.begin());
+
+    ThreadPool& pool = ThreadPool::Get();
+    for (size_t k = 2; k <= size; k <<= 1)
+    {
+        for (size_t j = k >> 1; j > 0; j >>= 1)
+        {
+            pool.ParallelForRange(size, kBitonicGrain, [&](size_t begin, size_t end)
+            {
+                for (size_t i = begin; i < end; ++i)
+                {
+                    const size_t partner = i ^ j;
+                    if (partner <= i)
+                        continue;
+                    const bool ascending = (i & k) == 0;
+                    if ((padded[i] > padded[partner]) == ascending)
+                        std::swap(padded[i], padded[partner]);
+                }
+            });
+        }
+    }
+    std::copy(padded.begin(), padded.begin() + count, keys);
+}
@@ -0,0 +1,98 @@
+#include "Utils/ThreadPool.h"
+
+namespace
+{
+    thread_local bool t_insidePoolTask = false;
+}
+
+ThreadPool& ThreadPool::Get()
+{
+    static ThreadPool pool(std::thread::hardware_concurrency() > 1 ? std::thread::hardware_concurrency() - 1 : 0);
+    return pool;
+}
+
+ThreadPool::ThreadPool(unsigned workerCount)
+{
+    m_workers.reserve(workerCount);
+    for (unsigned i = 0; i < workerCount; ++i)
+        m_workers.emplace_back([this] { WorkerLoop(); });
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wakeCv.notify_all();
+    for (std::thread& worker : m_workers)
+        worker.join();
+}
+
+void ThreadPool::Run(size_t taskCount, InvokeFn invoke, void* context)
+{
+    if (taskCount == 0)
+        return;
+
+    // Nested, single-task or worker-less batches gain nothing from a hand-off.
+    if (t_insidePoolTask || taskCount == 1 || m_workers.empty())
+    {
+        for (size_t i = 0; i < taskCount; ++i)
+            invoke(context, i);
+        return;
+    }
+
+    std::lock_guard<std::mutex> submitLock(m_submitMutex);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_invoke = invoke;
+        m_context = context;
+        m_taskCount = taskCount;
+        m_nextTask.store(0, std::memory_order_relaxed);
+        m_finishedWorkers = 0;
+        ++m_generation;
+    }
+    m_wakeCv.notify_all();
+
+    Execute();
+
+    // Every worker must have left the batch before `context` goes out of scope.
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_doneCv.wait(lock, [this] { return m_finishedWorkers == m_workers.size(); });
+    m_invoke = nullptr;
+    m_context = nullptr;
+}
+
+void ThreadPool::Execute()
+{
+    t_insidePoolTask = true;
+    for (size_t i = m_nextTask.fetch_add(1, std::memory_order_relaxed); i < m_taskCount;
+         i = m_nextTask.fetch_add(1, std::memory_order_relaxed))
+    {
+        m_invoke(m_context, i);
+    }
+    t_insidePoolTask = false;
+}
+
+void ThreadPool::WorkerLoop()
+{
+    uint64_t seenGeneration = 0;
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wakeCv.wait(lock, [&] { return m_stop || m_generation != seenGeneration; });
+            if (m_stop)
+                return;
+            seenGeneration = m_generation;
+        }
+
+        Execute();
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            ++m_finishedWorkers;
+        }
+        m_doneCv.notify_one();
+    }
+}
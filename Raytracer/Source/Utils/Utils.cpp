@@ -2,7 +2,9 @@
 #include "Utils/Utils.h"
 #include <comdef.h>
 
+#include "DDSTextureLoader/DDSTextureLoader12.h"
 #include "Renderer.h"
+#include "Resources/GpuMemoryAllocator.h"
 #include "tinygltf/tiny_gltf.h"
 
 // DRED post-mortem: which command in which command list the GPU died on, plus
@@ -204,17 +206,16 @@ namespace RenderingUtils
 		ComPtr<ID3D12Resource>& uploadBuffer)
 	{
 		ComPtr<ID3D12Resource> defaultBuffer;
-		// Create the actual default buffer resource.
-		const auto defaultHeap = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
+		// Create the actual default buffer resource; the copy below overwrites
+		// all of it, so it may reuse freed heap memory.
 		const auto bufferDesc = CD3DX12_RESOURCE_DESC::Buffer(byteSize);
 
-		HRESULT hr = device->CreateCommittedResource(
-			&defaultHeap,
-			D3D12_HEAP_FLAG_NONE,
-			&bufferDesc,
+		HRESULT hr = GpuMemoryAllocator::Get().CreateResource(
+			bufferDesc,
 			D3D12_RESOURCE_STATE_COMMON,
 			nullptr,
-			IID_PPV_ARGS(defaultBuffer.GetAddressOf()));
+			IID_PPV_ARGS(defaultBuffer.GetAddressOf()),
+			false);
 
     	assert(SUCCEEDED(hr));
     	
@@ -268,21 +269,31 @@ namespace RenderingUtils
 		ID3D12GraphicsCommandList* commandList,
 		const tinygltf::Image& image,
 		ComPtr<ID3D12Resource>& uploadBuffer)
+    {
+		return CreateDefaultTexture(device, commandList, image.image.data(), image.width, image.height, image.component, uploadBuffer);
+    }
+
+	ComPtr<ID3D12Resource> CreateDefaultTexture(
+		ID3D12Device* device,
+		ID3D12GraphicsCommandList* commandList,
+		const uint8_t* pixels,
+		int width,
+		int height,
+		int components,
+		ComPtr<ID3D12Resource>& uploadBuffer)
     {
 		spdlog::debug("Creating default texture resource.");
     	
 	    ComPtr<ID3D12Resource> defaultTexture;
 	    {
-		    const auto heapProperties = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
-	    	const auto textureDesc = CD3DX12_RESOURCE_DESC::Tex2D(DXGI_FORMAT_R8G8B8A8_UNORM, image.width, image.height, 1, 1);
+	    	const auto textureDesc = CD3DX12_RESOURCE_DESC::Tex2D(DXGI_FORMAT_R8G8B8A8_UNORM, width, height, 1, 1);
 
-	    	ThrowIfFailed(device->CreateCommittedResource(
-				&heapProperties,
-				D3D12_HEAP_FLAG_NONE,
-				&textureDesc,
+	    	ThrowIfFailed(GpuMemoryAllocator::Get().CreateResource(
+				textureDesc,
 				D3D12_RESOURCE_STATE_COPY_DEST,
 				nullptr,
-				IID_PPV_ARGS(&defaultTexture)));
+				IID_PPV_ARGS(&defaultTexture),
+				false));
 	    }
     	
     	D3D12_PLACED_SUBRESOURCE_FOOTPRINT footprint;
@@ -311,23 +322,23 @@ namespace RenderingUtils
 
     	const UINT dstRowPitch = footprint.Footprint.RowPitch;
 
-    	if (image.component == 4)
+    	if (components == 4)
     	{
     		for (UINT i = 0; i < rowCount; i++)
     		{
     			memcpy(
     				static_cast<uint8_t*>(pData) + dstRowPitch * i,
-    				&image.image[0] + image.width * 4 * i,
-    				image.width * 4);
+    				pixels + static_cast<size_t>(width) * 4 * i,
+    				static_cast<size_t>(width) * 4);
     		}
     	}
-    	else if (image.component == 3)
+    	else if (components == 3)
     	{
     		for (UINT i = 0; i < rowCount; i++)
     		{
-    			const uint8_t* srcRow = &image.image[0] + image.width * 3 * i;
+    			const uint8_t* srcRow = pixels + static_cast<size_t>(width) * 3 * i;
     			uint8_t* dstRow = static_cast<uint8_t*>(pData) + dstRowPitch * i;
-    			for (int px = 0; px < image.width; px++)
+    			for (int px = 0; px < width; px++)
     			{
     				dstRow[px * 4 + 0] = srcRow[px * 3 + 0];
     				dstRow[px * 4 + 1] = srcRow[px * 3 + 1];
@@ -338,7 +349,7 @@ namespace RenderingUtils
     	}
     	else
     	{
-    		spdlog::error("Unsupported image component count: {}", image.component);
+    		spdlog::error("Unsupported image component count: {}", components);
     	}
 
     	D3D12_TEXTURE_COPY_LOCATION defaultCopyLocation = {};
@@ -367,6 +378,56 @@ namespace RenderingUtils
     	return defaultTexture;
     }
 
+	ComPtr<ID3D12Resource> CreateDefaultTextureFromDds(
+		ID3D12Device* device,
+		ID3D12GraphicsCommandList* commandList,
+		const uint8_t* ddsData,
+		size_t ddsSize,
+		ComPtr<ID3D12Resource>& uploadBuffer)
+	{
+		ComPtr<ID3D12Resource> defaultTexture;
+		std::vector<D3D12_SUBRESOURCE_DATA> subresources;
+		const HRESULT hr = DirectX::LoadDDSTextureFromMemory(device, ddsData, ddsSize, &defaultTexture, subresources);
+		if (FAILED(hr))
+		{
+			spdlog::error("Failed to load DDS texture from memory: {}", std::system_category().message(hr));
+			return nullptr;
+		}
+
+		const UINT64 uploadSize = GetRequiredIntermediateSize(defaultTexture.Get(), 0, static_cast<UINT>(subresources.size()));
+		{
+			const auto heapProperties = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD);
+			const auto bufferDesc = CD3DX12_RESOURCE_DESC::Buffer(uploadSize);
+			ThrowIfFailed(device->CreateCommittedResource(
+				&heapProperties,
+				D3D12_HEAP_FLAG_NONE,
+				&bufferDesc,
+				D3D12_RESOURCE_STATE_GENERIC_READ,
+				nullptr,
+				IID_PPV_ARGS(&uploadBuffer)));
+		}
+
+		{
+			const auto barrier = CD3DX12_RESOURCE_BARRIER::Transition(defaultTexture.Get(),
+				D3D12_RESOURCE_STATE_COMMON,
+				D3D12_RESOURCE_STATE_COPY_DEST);
+			commandList->ResourceBarrier(1, &barrier);
+		}
+
+		// Copies into the upload buffer now, so ddsData may go away after this call.
+		UpdateSubresources(commandList, defaultTexture.Get(), uploadBuffer.Get(),
+			0, 0, static_cast<UINT>(subresources.size()), subresources.data());
+
+		{
+			const auto barrier = CD3DX12_RESOURCE_BARRIER::Transition(defaultTexture.Get(),
+				D3D12_RESOURCE_STATE_COPY_DEST,
+				D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE | D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE);
+			commandList->ResourceBarrier(1, &barrier);
+		}
+
+		return defaultTexture;
+	}
+
     ComPtr<ID3D12Resource> CreateUavBuffer(
         ID3D12Device* device,
         UINT64 byteSize,
@@ -374,13 +435,11 @@ namespace RenderingUtils
     {
         byteSize = Align(byteSize, 256);
 
-        const auto heapProps = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
         const auto desc = CD3DX12_RESOURCE_DESC::Buffer(byteSize, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS);
 
         ComPtr<ID3D12Resource> buffer;
-        HRESULT hr = device->CreateCommittedResource(
-            &heapProps, D3D12_HEAP_FLAG_NONE, &desc,
-            D3D12_RESOURCE_STATE_COMMON, nullptr,
+        HRESULT hr = GpuMemoryAllocator::Get().CreateResource(
+            desc, D3D12_RESOURCE_STATE_COMMON, nullptr,
             IID_PPV_ARGS(&buffer));
         if (FAILED(hr))
         {
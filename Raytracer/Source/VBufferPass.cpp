@@ -3,12 +3,14 @@
 
 #include "AccelerationStructures.h"
 #include "Constants.h"
+#include "DescriptorHeapAllocator.h"
 #include "Renderer.h"
 #include "Window.h"
 #include "Resources/ShaderBindingTable.h"
 #include "Resources/StructuredBuffer.h"
 #include "SceneResources/Scene.h"
 #include "Utils/PassConstants.h"
+#include "Resources/GpuMemoryAllocator.h"
 
 TechniqueDesc VBufferPass::GetTechniqueDesc() const
 {
@@ -32,7 +34,7 @@ void VBufferPass::CreateGlobalRootSignature()
 {
     // Subset of the standard scene binding: camera CBV, TLAS, vertex/index +
     // textures (alpha-cutout any hit), plus the VBuffer output UAV (u9,
-    // global heap slot VBUFFER_DESCRIPTOR_INDEX).
+    // shared-heap "VBuffer" slot).
 
     D3D12_DESCRIPTOR_RANGE cbvRange;
     cbvRange.BaseShaderRegister = 0;
@@ -74,7 +76,7 @@ void VBufferPass::CreateGlobalRootSignature()
     vbufferRange.NumDescriptors = 1;
     vbufferRange.RegisterSpace = 0;
     vbufferRange.RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_UAV;
-    vbufferRange.OffsetInDescriptorsFromTableStart = Constants::Graphics::VBUFFER_DESCRIPTOR_INDEX;
+    vbufferRange.OffsetInDescriptorsFromTableStart = DescriptorHeapAllocator::Get().GetNamedIndex(DescriptorSlots::VBUFFER);
 
     D3D12_DESCRIPTOR_RANGE allRanges[6] = {cbvRange, tlasRange, vertex_range, index_range,
                                            texture_range, vbufferRange};
@@ -120,6 +122,8 @@ void VBufferPass::CreateShaderResourceHeap()
 
 void VBufferPass::CreateVBufferResource()
 {
+    GpuMemoryAllocator::ScopedTag memoryTag("VBufferPass");
+
     m_vbufferTex.Reset();
 
     D3D12_RESOURCE_DESC desc = {};
@@ -133,16 +137,13 @@ void VBufferPass::CreateVBufferResource()
     desc.Layout           = D3D12_TEXTURE_LAYOUT_UNKNOWN;
     desc.Flags            = D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS;
 
-    auto heapProps = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
-    ThrowIfFailed(m_device->CreateCommittedResource(
-        &heapProps, D3D12_HEAP_FLAG_NONE, &desc,
+    ThrowIfFailed(GpuMemoryAllocator::Get().CreateResource(
+        desc,
         D3D12_RESOURCE_STATE_UNORDERED_ACCESS, nullptr, IID_PPV_ARGS(&m_vbufferTex)));
     m_vbufferTex->SetName(L"VXPG VBuffer");
 
-    auto increment = m_device->GetDescriptorHandleIncrementSize(m_srvUavHeap->GetDesc().Type);
-    D3D12_CPU_DESCRIPTOR_HANDLE uavHandle;
-    uavHandle.ptr = m_srvUavHeap->GetCPUDescriptorHandleForHeapStart().ptr
-                  + Constants::Graphics::VBUFFER_DESCRIPTOR_INDEX * increment;
+    auto& descriptors = DescriptorHeapAllocator::Get();
+    D3D12_CPU_DESCRIPTOR_HANDLE uavHandle = descriptors.GetCpuHandle(descriptors.GetNamedIndex(DescriptorSlots::VBUFFER));
 
     D3D12_UNORDERED_ACCESS_VIEW_DESC uavDesc = {};
     uavDesc.Format        = DXGI_FORMAT_R32G32B32A32_UINT;
@@ -6,6 +6,7 @@
 #include "ResourceManager/ResourceManager.h"
 #include "Shader.h"
 #include "Utils/Utils.h"
+#include "Resources/GpuMemoryAllocator.h"
 
 using Microsoft::WRL::ComPtr;
 
@@ -30,6 +31,8 @@ void VoxelGuidingBuildPass::Initialize(
 
 void VoxelGuidingBuildPass::CreateBuffers()
 {
+    GpuMemoryAllocator::ScopedTag memoryTag("VoxelGuidingBuildPass");
+
     constexpr uint32_t capacity = Constants::Graphics::VOXEL_GUIDING_CAPACITY;
 
     // Counters buffer stays 2 elements: element [1] is retired (was the CDF
@@ -44,6 +47,8 @@ void VoxelGuidingBuildPass::CreateBuffers()
 
 void VoxelGuidingBuildPass::CreateGridSizedBuffers()
 {
+    GpuMemoryAllocator::ScopedTag memoryTag("VoxelGuidingBuildPass");
+
     // Grid-sized (one element per cell), not capacity-sized. Bound as ROOT
     // UAVs (no bounds checking), so they MUST track the grid dim exactly —
     // undersized means the shaders write past the end and corrupt GPU memory.
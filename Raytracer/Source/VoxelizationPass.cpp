@@ -4,7 +4,6 @@
 #include <algorithm>
 #include <cstring>
 
-#include "Constants.h"
 #include "InputElements.h"
 #include "Shader.h"
 #include "ResourceManager/ResourceManager.h"
@@ -15,6 +14,7 @@
 #include "SceneResources/GameObject.h"
 #include "SceneResources/Model.h"
 #include "SceneResources/Primitive.h"
+#include "Resources/GpuMemoryAllocator.h"
 
 using Microsoft::WRL::ComPtr;
 
@@ -54,15 +54,15 @@ void VoxelizationPass::Initialize(
 
 void VoxelizationPass::CreateResources()
 {
-    auto heapProps = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
+    GpuMemoryAllocator::ScopedTag memoryTag("VoxelizationPass");
 
     // Occupancy Texture3D<uint>
     {
         D3D12_RESOURCE_DESC desc = CD3DX12_RESOURCE_DESC::Tex3D(
             DXGI_FORMAT_R32_UINT, m_gridDim, m_gridDim, m_gridDim, 1,
             D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS);
-        ThrowIfFailed(m_device->CreateCommittedResource(
-            &heapProps, D3D12_HEAP_FLAG_NONE, &desc,
+        ThrowIfFailed(GpuMemoryAllocator::Get().CreateResource(
+            desc,
             D3D12_RESOURCE_STATE_UNORDERED_ACCESS, nullptr,
             IID_PPV_ARGS(&m_occupancyTex)));
         m_occupancyTex->SetName(L"VoxelOccupancy");
@@ -74,14 +74,14 @@ void VoxelizationPass::CreateResources()
             DXGI_FORMAT_R32_UINT, m_gridDim, m_gridDim, m_gridDim, 1,
             D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS);
 
-        ThrowIfFailed(m_device->CreateCommittedResource(
-            &heapProps, D3D12_HEAP_FLAG_NONE, &desc,
+        ThrowIfFailed(GpuMemoryAllocator::Get().CreateResource(
+            desc,
             D3D12_RESOURCE_STATE_UNORDERED_ACCESS, nullptr,
             IID_PPV_ARGS(&m_irradianceTex)));
         m_irradianceTex->SetName(L"VoxelIrradiance");
 
-        ThrowIfFailed(m_device->CreateCommittedResource(
-            &heapProps, D3D12_HEAP_FLAG_NONE, &desc,
+        ThrowIfFailed(GpuMemoryAllocator::Get().CreateResource(
+            desc,
             D3D12_RESOURCE_STATE_UNORDERED_ACCESS, nullptr,
             IID_PPV_ARGS(&m_vplCountTex)));
         m_vplCountTex->SetName(L"VoxelVplCount");
@@ -320,38 +320,18 @@ void VoxelizationPass::OnSceneLoaded(const Scene& scene)
     m_cachedAabbMin = aabbMin;
     m_cachedAabbMax = aabbMax;
 
-    DirectX::XMFLOAT3 size{
-        std::max(aabbMax.x - aabbMin.x, 1e-4f),
-        std::max(aabbMax.y - aabbMin.y, 1e-4f),
-        std::max(aabbMax.z - aabbMin.z, 1e-4f),
-    };
-    const float maxExtent = std::max({ size.x, size.y, size.z });
-    const float voxelSize = maxExtent / static_cast<float>(m_gridDim);
-
-    DirectX::XMFLOAT3 center{
-        (aabbMin.x + aabbMax.x) * 0.5f,
-        (aabbMin.y + aabbMax.y) * 0.5f,
-        (aabbMin.z + aabbMax.z) * 0.5f,
-    };
-    const float half = voxelSize * static_cast<float>(m_gridDim) * 0.5f;
-
-    m_gridConstants.gridMin   = { center.x - half, center.y - half, center.z - half };
-    m_gridConstants.gridMax   = { center.x + half, center.y + half, center.z + half };
-    m_gridConstants.voxelSize = voxelSize;
-    m_gridConstants.gridDim   = m_gridDim;
-    // Adaptive cluster factor: raise above the floor so svDim <= SUPERVOXEL_DIM_CAP,
-    // bounding the supervoxel count to MAX_SUPERVOXELS at any grid resolution.
-    const uint32_t dimCap = static_cast<uint32_t>(Constants::Graphics::SUPERVOXEL_DIM_CAP);
-    const uint32_t ceilToCap = (m_gridDim + dimCap - 1) / dimCap;
-    m_gridConstants.supervoxelFactor = std::max<uint32_t>(Constants::Graphics::SUPERVOXEL_GRID_FACTOR, ceilToCap);
+    BvhAabb bounds;
+    std::memcpy(bounds.min, &aabbMin, sizeof(bounds.min));
+    std::memcpy(bounds.max, &aabbMax, sizeof(bounds.max));
+    Voxelizer::FitGrid(bounds, m_gridDim, m_gridConstants);
 
     WriteGridConstantsCB();
     m_haveScene = true;
     m_bakeValid = false;
 
     spdlog::debug("VoxelizationPass: gridMin=({:.3f},{:.3f},{:.3f}) gridMax=({:.3f},{:.3f},{:.3f}) voxelSize={:.4f}",
-        m_gridConstants.gridMin.x, m_gridConstants.gridMin.y, m_gridConstants.gridMin.z,
-        m_gridConstants.gridMax.x, m_gridConstants.gridMax.y, m_gridConstants.gridMax.z,
+        m_gridConstants.gridMin[0], m_gridConstants.gridMin[1], m_gridConstants.gridMin[2],
+        m_gridConstants.gridMax[0], m_gridConstants.gridMax[1], m_gridConstants.gridMax[2],
         m_gridConstants.voxelSize);
 }
 
@@ -439,7 +419,7 @@ void VoxelizationPass::DispatchBake(const Scene& scene)
 
         for (const auto& go : scene.GetGameObjects())
         {
-            auto worldGpu = go->GetWorldMatrixBuffer()->GetUnderlyingResource()->GetGPUVirtualAddress();
+            auto worldGpu = go->GetWorldMatrixAddress();
             m_commandList->SetGraphicsRootConstantBufferView(1, worldGpu);
 
             for (const auto& primitive : go->GetModel()->GetMeshes())
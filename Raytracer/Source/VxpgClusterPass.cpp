@@ -9,6 +9,7 @@
 #include "ResourceManager/ResourceManager.h"
 #include "Shader.h"
 #include "Utils/Utils.h"
+#include "Resources/GpuMemoryAllocator.h"
 
 using Microsoft::WRL::ComPtr;
 
@@ -57,6 +58,8 @@ void VxpgClusterPass::Initialize(
 
 void VxpgClusterPass::CreateBuffers()
 {
+    GpuMemoryAllocator::ScopedTag memoryTag("VxpgClusterPass");
+
     m_clusterSeedCompactIds = std::make_unique<RWStructuredBuffer<int32_t>>(
         m_device, kClusterCount, L"Cluster SeedCompactIds");
     m_clusterCenters = std::make_unique<RWStructuredBuffer<ClusterCenter>>(
@@ -2,6 +2,7 @@
 #include "VxpgClusterVisibilityPass.h"
 
 #include "Constants.h"
+#include "DescriptorHeapAllocator.h"
 #include "Renderer.h" // GetStaticSamplers
 #include "VoxelizationPass.h"
 #include "VoxelGuidingBuildPass.h"
@@ -12,6 +13,7 @@
 #include "Shader.h"
 #include "Utils/CVars.h"
 #include "Utils/Utils.h"
+#include "Resources/GpuMemoryAllocator.h"
 
 using Microsoft::WRL::ComPtr;
 
@@ -59,6 +61,8 @@ void VxpgClusterVisibilityPass::Initialize(
 
 void VxpgClusterVisibilityPass::CreateFixedBuffers()
 {
+    GpuMemoryAllocator::ScopedTag memoryTag("VxpgClusterVisibilityPass");
+
     m_clusterGatheredLightPoints = std::make_unique<RWStructuredBuffer<DirectX::XMFLOAT4>>(
         m_device, kClusterCount * kGatherCap, L"ClusterVisibility GatheredLightPoints");
     m_clusterLightPointCounts = std::make_unique<RWStructuredBuffer<uint32_t>>(
@@ -67,15 +71,16 @@ void VxpgClusterVisibilityPass::CreateFixedBuffers()
 
 void VxpgClusterVisibilityPass::CreateResolutionBuffers()
 {
+    GpuMemoryAllocator::ScopedTag memoryTag("VxpgClusterVisibilityPass");
+
     m_avgVisibility = std::make_unique<RWStructuredBuffer<float>>(
         m_device, std::max(1u, m_mapX * m_mapY * kClusterCount), L"ClusterVisibility AvgVisibility");
 
-    auto heapProps = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
     D3D12_RESOURCE_DESC desc = CD3DX12_RESOURCE_DESC::Tex2D(
         DXGI_FORMAT_R32_UINT, std::max(1u, m_mapX), std::max(1u, m_mapY),
         1, 1, 1, 0, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS);
-    ThrowIfFailed(m_device->CreateCommittedResource(
-        &heapProps, D3D12_HEAP_FLAG_NONE, &desc,
+    ThrowIfFailed(GpuMemoryAllocator::Get().CreateResource(
+        desc,
         D3D12_RESOURCE_STATE_UNORDERED_ACCESS, nullptr, IID_PPV_ARGS(&m_mask)));
     m_mask->SetName(L"ClusterVisibility Mask");
 }
@@ -90,12 +95,13 @@ void VxpgClusterVisibilityPass::CreateRootSignature()
     r[1].Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 1, 0, 0, 3);   // TLAS t0 @ 3
     r[2].Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 1, 1, 0, 4);   // vertices t1 @ 4
     r[3].Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 1, 2, 0, 5);   // indices t2 @ 5
-    r[4].Init(D3D12_DESCRIPTOR_RANGE_TYPE_UAV, 1, 3, 0, Constants::Graphics::SUPERPIXEL_INDEX_DESCRIPTOR_INDEX);        // gSuperpixelIndex u3 @ 523
-    r[5].Init(D3D12_DESCRIPTOR_RANGE_TYPE_UAV, 1, 1, 0, Constants::Graphics::VPL_POSITION_DESCRIPTOR_INDEX);           // gVplPosition u1 @ 526
-    r[6].Init(D3D12_DESCRIPTOR_RANGE_TYPE_UAV, 1, 2, 0, Constants::Graphics::VBUFFER_DESCRIPTOR_INDEX);                // gVBuffer u2 @ 527
-    r[7].Init(D3D12_DESCRIPTOR_RANGE_TYPE_UAV, 1, 4, 0, Constants::Graphics::SPIXEL_GATHERED_DESCRIPTOR_INDEX);        // gSpixelGathered u4 @ 528
-    r[8].Init(D3D12_DESCRIPTOR_RANGE_TYPE_UAV, 1, 5, 0, Constants::Graphics::SPIXEL_COUNTER_DESCRIPTOR_INDEX);         // gSpixelCounter u5 @ 529
-    r[9].Init(D3D12_DESCRIPTOR_RANGE_TYPE_UAV, 1, 6, 0, Constants::Graphics::CLUSTER_VISIBILITY_MASK_DESCRIPTOR_INDEX); // gClusterVisibilityMask u6 @ 530
+    auto& descriptors = DescriptorHeapAllocator::Get();
+    r[4].Init(D3D12_DESCRIPTOR_RANGE_TYPE_UAV, 1, 3, 0, descriptors.GetNamedIndex(DescriptorSlots::SUPERPIXELS, DescriptorSlots::SUPERPIXELS_INDEX)); // gSuperpixelIndex u3
+    r[5].Init(D3D12_DESCRIPTOR_RANGE_TYPE_UAV, 1, 1, 0, descriptors.GetNamedIndex(DescriptorSlots::VPL_POSITION));                                    // gVplPosition u1
+    r[6].Init(D3D12_DESCRIPTOR_RANGE_TYPE_UAV, 1, 2, 0, descriptors.GetNamedIndex(DescriptorSlots::VBUFFER));                                         // gVBuffer u2
+    r[7].Init(D3D12_DESCRIPTOR_RANGE_TYPE_UAV, 1, 4, 0, descriptors.GetNamedIndex(DescriptorSlots::SUPERPIXEL_GATHERED));                             // gSpixelGathered u4
+    r[8].Init(D3D12_DESCRIPTOR_RANGE_TYPE_UAV, 1, 5, 0, descriptors.GetNamedIndex(DescriptorSlots::SUPERPIXEL_COUNTER));                              // gSpixelCounter u5
+    r[9].Init(D3D12_DESCRIPTOR_RANGE_TYPE_UAV, 1, 6, 0, descriptors.GetNamedIndex(DescriptorSlots::CLUSTER_VISIBILITY_MASK));                         // gClusterVisibilityMask u6
 
     CD3DX12_ROOT_PARAMETER params[10];
     params[0].InitAsDescriptorTable(_countof(r), r);
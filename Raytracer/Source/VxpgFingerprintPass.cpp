@@ -7,6 +7,7 @@
 #include "ResourceManager/ResourceManager.h"
 #include "Shader.h"
 #include "Utils/Utils.h"
+#include "Resources/GpuMemoryAllocator.h"
 
 using Microsoft::WRL::ComPtr;
 
@@ -50,6 +51,8 @@ void VxpgFingerprintPass::Initialize(
 
 void VxpgFingerprintPass::CreateBuffers()
 {
+    GpuMemoryAllocator::ScopedTag memoryTag("VxpgFingerprintPass");
+
     constexpr uint32_t capacity = Constants::Graphics::VOXEL_GUIDING_CAPACITY;
 
     m_screenRepresentativePoints = std::make_unique<RWStructuredBuffer<DirectX::XMFLOAT4>>(
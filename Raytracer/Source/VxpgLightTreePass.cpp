@@ -2,6 +2,7 @@
 #include "VxpgLightTreePass.h"
 
 #include "Constants.h"
+#include "DescriptorHeapAllocator.h"
 #include "VoxelizationPass.h"
 #include "VoxelGuidingBuildPass.h"
 #include "VxpgClusterPass.h"
@@ -10,6 +11,7 @@
 #include "Shader.h"
 #include "Utils/CVars.h"
 #include "Utils/Utils.h"
+#include "Resources/GpuMemoryAllocator.h"
 
 using Microsoft::WRL::ComPtr;
 
@@ -69,6 +71,8 @@ void VxpgLightTreePass::Initialize(
 
 void VxpgLightTreePass::CreateBuffers()
 {
+    GpuMemoryAllocator::ScopedTag memoryTag("VxpgLightTreePass");
+
     m_sortKeys = std::make_unique<RWStructuredBuffer<uint64_t>>(
         m_device, BitonicSortPass::kCapacity, L"LightTree SortKeys");
     m_nodes = std::make_unique<RWStructuredBuffer<LightTreeNodeGpu>>(
@@ -91,10 +95,10 @@ void VxpgLightTreePass::CreateRootSignature()
     // cluster roots, args, compact ids, cluster assignments, premul irradiance,
     // lit-voxel counter, merge visited-gate). Top-level tree adds b1 root
     // constants (map dims + mode), u11 avg-visibility, u12 heap, and the mask
-    // texture as a shared-heap descriptor table (u13, at slot 530).
+    // texture as a shared-heap descriptor table (u13, "Cluster Visibility Mask" slot).
     CD3DX12_DESCRIPTOR_RANGE maskRange;
     maskRange.Init(D3D12_DESCRIPTOR_RANGE_TYPE_UAV, 1, 13, 0,
-        Constants::Graphics::CLUSTER_VISIBILITY_MASK_DESCRIPTOR_INDEX); // u13 @ 530
+        DescriptorHeapAllocator::Get().GetNamedIndex(DescriptorSlots::CLUSTER_VISIBILITY_MASK)); // u13
 
     CD3DX12_ROOT_PARAMETER params[16];
     params[0].InitAsConstantBufferView(0);
@@ -141,6 +145,8 @@ void VxpgLightTreePass::CreatePSOs()
 
 void VxpgLightTreePass::OnResize(uint32_t width, uint32_t height)
 {
+    GpuMemoryAllocator::ScopedTag memoryTag("VxpgLightTreePass");
+
     m_mapX = (width  + kSuperpixelSize - 1) / kSuperpixelSize;
     m_mapY = (height + kSuperpixelSize - 1) / kSuperpixelSize;
     // Implicit 64-slot binary heap per superpixel (SIByL tltree).
@@ -0,0 +1,349 @@
+#include "pch.h"
+#include "VxpgSnapshotManager.h"
+
+#include "Constants.h"
+#include "LightInjectionPass.h"
+#include "SceneResources/VxpgSnapshotFormat.h"
+#include "SuperpixelBuildPass.h"
+#include "Utils/CVars.h"
+#include "Utils/Utils.h"
+#include "VoxelGuidingBuildPass.h"
+#include "VoxelizationPass.h"
+#include "VxpgClusterPass.h"
+#include "VxpgClusterVisibilityPass.h"
+#include "VxpgFingerprintPass.h"
+#include "VxpgLightTreePass.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+static_assert(sizeof(VxpgClusterPass::ClusterCenter) == sizeof(VoxelClusterCenter), "ClusterCenter layouts differ");
+
+namespace
+{
+    // Leaf stride the tree shaders write at; LightTreeNodeGpu is padded past it.
+    constexpr uint64_t kTreeNodeStride = sizeof(LightTreeNode);
+
+    uint64_t AlignUp(uint64_t value, uint64_t alignment)
+    {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+
+    std::string FormatFloat(float value)
+    {
+        char buf[32];
+        std::snprintf(buf, sizeof(buf), "%.9g", value);
+        return buf;
+    }
+
+    std::vector<VxpgSnapshotFormat::CVarValue> CollectCVars()
+    {
+        CVarSystem* system = CVarSystem::Get();
+        std::vector<VxpgSnapshotFormat::CVarValue> cvars;
+        for (const auto& [type, name] : system->GetCVarParametersData())
+        {
+            const StringId id = StringId::Existing(name);
+            VxpgSnapshotFormat::CVarValue cvar;
+            cvar.type = static_cast<uint32_t>(type);
+            cvar.name = name;
+            switch (type)
+            {
+            case CVarType::Int:
+                if (const int32_t* v = system->GetIntCVar(id)) cvar.value = std::to_string(*v);
+                break;
+            case CVarType::Float:
+                if (const float* v = system->GetFloatCVar(id)) cvar.value = FormatFloat(*v);
+                break;
+            case CVarType::String:
+                if (const std::string* v = system->GetStringCVar(id)) cvar.value = *v;
+                break;
+            case CVarType::Enum:
+                if (const CVarEnum* v = system->GetEnumCVar(id); v && v->index < v->names.size()) cvar.value = v->names[v->index];
+                break;
+            case CVarType::Float3:
+                if (const DirectX::XMFLOAT3* v = system->GetFloat3CVar(id))
+                    cvar.value = FormatFloat(v->x) + " " + FormatFloat(v->y) + " " + FormatFloat(v->z);
+                break;
+            }
+            cvars.push_back(std::move(cvar));
+        }
+        std::sort(cvars.begin(), cvars.end(), [](const auto& a, const auto& b) { return a.name < b.name; });
+        return cvars;
+    }
+}
+
+void VxpgSnapshotManager::Initialize(
+    Microsoft::WRL::ComPtr<ID3D12Device5>              device,
+    Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList4> commandList)
+{
+    m_device      = device;
+    m_commandList = commandList;
+}
+
+void VxpgSnapshotManager::Arm(const std::string& path)
+{
+    if (m_captureDue)
+        return;
+
+    m_path         = path;
+    m_captureDue   = true;
+    m_copyRecorded = false;
+    spdlog::info("VXPG snapshot armed: {}", path);
+}
+
+void VxpgSnapshotManager::RecordCopies(const Sources& sources, VxpgStage stage, uint32_t frameIndex)
+{
+    if (!m_captureDue || m_copyRecorded || stage == VxpgStage::None || !sources.voxelization)
+        return;
+
+    m_regions    = {};
+    m_stage      = stage;
+    m_frameIndex = frameIndex;
+    m_grid       = sources.voxelization->GetGridConstants();
+    m_mapX = m_mapY = m_clusterCount = 0;
+
+    uint64_t total = 0;
+    auto addBuffer = [&](Item item, ID3D12Resource* resource)
+    {
+        if (!resource)
+            return;
+        Region& region = m_regions[static_cast<size_t>(item)];
+        region.resource = resource;
+        region.offset   = total = AlignUp(total, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
+        region.size     = resource->GetDesc().Width;
+        total += region.size;
+    };
+    auto addTexture = [&](Item item, ID3D12Resource* resource)
+    {
+        if (!resource)
+            return;
+        Region& region = m_regions[static_cast<size_t>(item)];
+        const D3D12_RESOURCE_DESC desc = resource->GetDesc();
+        region.resource = resource;
+        region.texture  = true;
+        region.offset   = total = AlignUp(total, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
+        m_device->GetCopyableFootprints(&desc, 0, 1, region.offset, &region.footprint, &region.rows, &region.rowBytes, &region.size);
+        total += region.size;
+    };
+
+    // Stage by stage, as RunVxpgPipelineUpTo runs them.
+    if (stage >= VxpgStage::Inject)
+    {
+        addTexture(Item::IrradianceGrid, sources.voxelization->GetIrradianceTexture().Get());
+        addTexture(Item::VplCountGrid, sources.voxelization->GetVplCountTexture().Get());
+        if (sources.lightInjection)
+            addTexture(Item::ShadingPoints, sources.lightInjection->GetShadingPointsTexture().Get());
+    }
+    if (stage >= VxpgStage::GuidingBuild && sources.guidingBuild)
+    {
+        addBuffer(Item::Counters, sources.guidingBuild->GetCountersBuffer()->GetUnderlyingResource().Get());
+        addBuffer(Item::CompactIds, sources.guidingBuild->GetCompactIdsBuffer()->GetUnderlyingResource().Get());
+        addBuffer(Item::PremulIrradiance, sources.guidingBuild->GetPremulIrradianceBuffer()->GetUnderlyingResource().Get());
+        addBuffer(Item::LightPoints, sources.guidingBuild->GetCompactVoxelLightPointsBuffer()->GetUnderlyingResource().Get());
+    }
+    if (stage >= VxpgStage::Fingerprint && sources.fingerprint)
+        addBuffer(Item::Fingerprints, sources.fingerprint->GetVoxelFingerprintsBuffer()->GetUnderlyingResource().Get());
+    if (stage >= VxpgStage::Cluster && sources.cluster)
+    {
+        m_clusterCount = static_cast<uint32_t>(sources.cluster->GetClusterCentersBuffer()->GetElementsCount());
+        addBuffer(Item::ClusterSeeds, sources.cluster->GetClusterSeedCompactIdsBuffer()->GetUnderlyingResource().Get());
+        addBuffer(Item::ClusterCenters, sources.cluster->GetClusterCentersBuffer()->GetUnderlyingResource().Get());
+        addBuffer(Item::ClusterAssignments, sources.cluster->GetVoxelClusterAssignmentsBuffer()->GetUnderlyingResource().Get());
+    }
+    if (stage >= VxpgStage::Superpixel && sources.superpixel)
+    {
+        m_mapX = sources.superpixel->GetMapX();
+        m_mapY = sources.superpixel->GetMapY();
+        addTexture(Item::SuperpixelIndex, sources.superpixel->GetIndexResource());
+    }
+    if (stage >= VxpgStage::ClusterVisibility && sources.clusterVisibility && m_clusterCount > 0)
+    {
+        addTexture(Item::VisibilityMask, sources.clusterVisibility->GetMaskResource());
+        addBuffer(Item::Visibility, sources.clusterVisibility->GetAvgVisibilityBuffer()->GetUnderlyingResource().Get());
+    }
+    if (stage >= VxpgStage::LightTree && sources.lightTree && sources.lightTree->GetNodesBuffer())
+    {
+        addBuffer(Item::TreeNodes, sources.lightTree->GetNodesBuffer()->GetUnderlyingResource().Get());
+        addBuffer(Item::CompactToLeaf, sources.lightTree->GetCompactToLeafBuffer()->GetUnderlyingResource().Get());
+        addBuffer(Item::ClusterRoots, sources.lightTree->GetClusterRootsBuffer()->GetUnderlyingResource().Get());
+        addBuffer(Item::TreeArgs, sources.lightTree->GetDispatchArgsBuffer()->GetUnderlyingResource().Get());
+    }
+    if (total == 0)
+        return;
+
+    if (total > m_readbackBufferSize)
+    {
+        m_readbackBuffer.Reset();
+        auto heapProps  = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_READBACK);
+        auto bufferDesc = CD3DX12_RESOURCE_DESC::Buffer(total);
+        ThrowIfFailed(m_device->CreateCommittedResource(
+            &heapProps, D3D12_HEAP_FLAG_NONE, &bufferDesc,
+            D3D12_RESOURCE_STATE_COPY_DEST, nullptr,
+            IID_PPV_ARGS(&m_readbackBuffer)));
+        m_readbackBuffer->SetName(L"VXPG Snapshot Readback Buffer");
+        m_readbackBufferSize = total;
+    }
+
+    // Every VXPG output lives in UNORDERED_ACCESS between passes.
+    std::vector<CD3DX12_RESOURCE_BARRIER> toCopy;
+    std::vector<CD3DX12_RESOURCE_BARRIER> toUav;
+    for (const Region& region : m_regions)
+    {
+        if (!region.resource)
+            continue;
+        toCopy.push_back(CD3DX12_RESOURCE_BARRIER::Transition(region.resource,
+            D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_COPY_SOURCE));
+        toUav.push_back(CD3DX12_RESOURCE_BARRIER::Transition(region.resource,
+            D3D12_RESOURCE_STATE_COPY_SOURCE, D3D12_RESOURCE_STATE_UNORDERED_ACCESS));
+    }
+
+    m_commandList->ResourceBarrier(static_cast<UINT>(toCopy.size()), toCopy.data());
+    for (const Region& region : m_regions)
+    {
+        if (!region.resource)
+            continue;
+        if (region.texture)
+        {
+            CD3DX12_TEXTURE_COPY_LOCATION srcLoc(region.resource, 0);
+            CD3DX12_TEXTURE_COPY_LOCATION dstLoc(m_readbackBuffer.Get(), region.footprint);
+            m_commandList->CopyTextureRegion(&dstLoc, 0, 0, 0, &srcLoc, nullptr);
+        }
+        else
+        {
+            m_commandList->CopyBufferRegion(m_readbackBuffer.Get(), region.offset, region.resource, 0, region.size);
+        }
+    }
+    m_commandList->ResourceBarrier(static_cast<UINT>(toUav.size()), toUav.data());
+    m_copyRecorded = true;
+}
+
+void VxpgSnapshotManager::FinishCapture()
+{
+    if (!m_captureDue)
+        return;
+    m_captureDue = false;
+    if (!m_copyRecorded)
+    {
+        spdlog::warn("VXPG snapshot skipped: the frame did not run the VXPG pipeline");
+        return;
+    }
+    m_copyRecorded = false;
+
+    void* mappedData = nullptr;
+    D3D12_RANGE readRange = { 0, static_cast<SIZE_T>(m_readbackBufferSize) };
+    ThrowIfFailed(m_readbackBuffer->Map(0, &readRange, &mappedData));
+    const auto* base = static_cast<const uint8_t*>(mappedData);
+
+    auto regionOf = [&](Item item) -> const Region& { return m_regions[static_cast<size_t>(item)]; };
+    // The first `count` elements of a buffer; empty when it was not captured.
+    auto readBuffer = [&](Item item, size_t count, auto& out)
+    {
+        using T = typename std::decay_t<decltype(out)>::value_type;
+        const Region& region = regionOf(item);
+        if (!region.resource || count * sizeof(T) > region.size)
+            return;
+        out.resize(count);
+        std::memcpy(out.data(), base + region.offset, count * sizeof(T));
+    };
+    // All texels, rows packed tightly.
+    auto readTexture = [&](Item item, auto& out)
+    {
+        using T = typename std::decay_t<decltype(out)>::value_type;
+        const Region& region = regionOf(item);
+        if (!region.resource)
+            return;
+        const uint32_t depth = region.footprint.Footprint.Depth;
+        out.resize(static_cast<size_t>(region.rowBytes) * region.rows * depth / sizeof(T));
+        auto* dst = reinterpret_cast<uint8_t*>(out.data());
+        for (uint32_t z = 0; z < depth; ++z)
+        {
+            for (UINT y = 0; y < region.rows; ++y)
+            {
+                const uint64_t row = static_cast<uint64_t>(z) * region.rows + y;
+                std::memcpy(dst + row * region.rowBytes, base + region.offset + row * region.footprint.Footprint.RowPitch, region.rowBytes);
+            }
+        }
+    };
+
+    VxpgSnapshotFormat::SnapshotInput input;
+    input.stage      = static_cast<uint32_t>(m_stage);
+    input.frameIndex = m_frameIndex;
+    input.grid       = m_grid;
+    input.cvars      = CollectCVars();
+
+    {
+        std::vector<uint32_t> irradiance;
+        std::vector<uint32_t> vplCount;
+        readTexture(Item::IrradianceGrid, irradiance);
+        readTexture(Item::VplCountGrid, vplCount);
+        for (size_t voxel = 0; voxel < irradiance.size(); ++voxel)
+        {
+            const uint32_t count = voxel < vplCount.size() ? vplCount[voxel] : 0;
+            if (irradiance[voxel] != 0 || count != 0)
+                input.voxelIrradiance.push_back({ static_cast<uint32_t>(voxel), irradiance[voxel], count });
+        }
+    }
+    if (regionOf(Item::ShadingPoints).resource)
+    {
+        input.width  = regionOf(Item::ShadingPoints).footprint.Footprint.Width;
+        input.height = regionOf(Item::ShadingPoints).footprint.Footprint.Height;
+        readTexture(Item::ShadingPoints, input.shadingPoints);
+    }
+
+    std::vector<uint32_t> counters;
+    readBuffer(Item::Counters, 1, counters);
+    const uint32_t lit = counters.empty() ? 0 : std::min<uint32_t>(counters[0], Constants::Graphics::VOXEL_GUIDING_CAPACITY);
+    input.litVoxelCount = lit;
+    readBuffer(Item::CompactIds, lit, input.compactIds);
+    readBuffer(Item::PremulIrradiance, lit, input.premulIrradiance);
+    readBuffer(Item::LightPoints, lit, input.representativeVpls);
+    readBuffer(Item::Fingerprints, lit, input.fingerprints);
+
+    input.clusterCount = m_clusterCount;
+    readBuffer(Item::ClusterSeeds, m_clusterCount, input.clusterSeeds);
+    readBuffer(Item::ClusterCenters, m_clusterCount, input.clusterCenters);
+    readBuffer(Item::ClusterAssignments, lit, input.clusterAssignments);
+
+    input.superpixelMapX = m_mapX;
+    input.superpixelMapY = m_mapY;
+    if (input.width > 0)
+        readTexture(Item::SuperpixelIndex, input.superpixelIndex);
+    readTexture(Item::VisibilityMask, input.clusterVisibilityMask);
+    readBuffer(Item::Visibility, static_cast<size_t>(m_mapX) * m_mapY * m_clusterCount, input.clusterVisibility);
+
+    std::vector<VxpgLightTreePass::TreeBuildDispatchArgsGpu> treeArgs;
+    readBuffer(Item::TreeArgs, 1, treeArgs);
+    if (!treeArgs.empty())
+    {
+        const uint32_t leaves = std::min<uint32_t>(treeArgs[0].numValidVoxels, Constants::Graphics::LIGHT_TREE_MAX_LEAVES);
+        input.leafCount    = leaves;
+        input.treeOverflow = treeArgs[0].overflowFlag;
+        const Region& nodes = regionOf(Item::TreeNodes);
+        const size_t nodeCount = leaves > 0 ? 2 * static_cast<size_t>(leaves) - 1 : 0;
+        if (nodeCount * kTreeNodeStride <= nodes.size)
+        {
+            input.lightTreeNodes.resize(nodeCount);
+            std::memcpy(input.lightTreeNodes.data(), base + nodes.offset, nodeCount * kTreeNodeStride);
+        }
+        readBuffer(Item::CompactToLeaf, lit, input.compactToLeaf);
+        readBuffer(Item::ClusterRoots, m_clusterCount, input.lightTreeClusterRoots);
+    }
+
+    D3D12_RANGE writeRange = { 0, 0 };
+    m_readbackBuffer->Unmap(0, &writeRange);
+
+    // Textures from before the superpixel map was sized (1x1 placeholders)
+    // disagree with the header, and the reader would reject the whole file.
+    const size_t superpixels = static_cast<size_t>(m_mapX) * m_mapY;
+    if (input.clusterVisibilityMask.size() != superpixels)
+        input.clusterVisibilityMask.clear();
+    if (input.superpixelIndex.size() != input.shadingPoints.size() / 4)
+        input.superpixelIndex.clear();
+
+    if (VxpgSnapshotFormat::Write(m_path, input))
+        spdlog::info("VXPG snapshot saved: {} ({} lit voxels, {} leaves)", m_path, lit, input.leafCount);
+    else
+        spdlog::error("Failed to write VXPG snapshot: {}", m_path);
+}
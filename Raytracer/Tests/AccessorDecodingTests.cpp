@@ -0,0 +1,214 @@
+#include "SceneResources/AccessorDecoding.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+#include "SceneResources/VertexPacking.h"
+#include "TestCheck.h"
+
+namespace
+{
+    using namespace AccessorDecoding;
+    using VertexPacking::FloatVertex;
+
+    constexpr float SENTINEL = -7.0f;
+
+    template <typename T>
+    void Store(std::vector<uint8_t>& bytes, size_t offset, T value)
+    {
+        std::memcpy(bytes.data() + offset, &value, sizeof(T));
+    }
+
+    std::vector<FloatVertex> MakeVertices(size_t count)
+    {
+        FloatVertex vertex;
+        float* fields = &vertex.position[0];
+        for (size_t i = 0; i < sizeof(FloatVertex) / sizeof(float); ++i)
+            fields[i] = SENTINEL;
+        return std::vector<FloatVertex>(count, vertex);
+    }
+
+    // Interleaved buffer: float3 position, then 8 bytes of something else.
+    void TestStridedFloats()
+    {
+        constexpr size_t COUNT = 5;
+        constexpr size_t STRIDE = 20;
+        std::vector<uint8_t> bytes(COUNT * STRIDE, 0xcd);
+        for (size_t i = 0; i < COUNT; ++i)
+            for (size_t c = 0; c < 3; ++c)
+                Store(bytes, i * STRIDE + c * sizeof(float), static_cast<float>(i * 10 + c));
+
+        AccessorView view;
+        view.data = bytes.data();
+        view.count = COUNT;
+        view.stride = STRIDE;
+        view.componentCount = 3;
+        CHECK(RequiredBytes(view) == (COUNT - 1) * STRIDE + 12);
+
+        std::vector<FloatVertex> vertices = MakeVertices(COUNT);
+        CHECK(DecodeFloats(view, vertices[0].normal, sizeof(FloatVertex), 3));
+        bool same = true;
+        for (size_t i = 0; i < COUNT; ++i)
+        {
+            for (size_t c = 0; c < 3; ++c)
+                same &= vertices[i].normal[c] == static_cast<float>(i * 10 + c);
+            same &= vertices[i].position[2] == SENTINEL && vertices[i].tangent[0] == SENTINEL;
+        }
+        CHECK(same);
+
+        // Tightly packed VEC2 with stride 0.
+        const float uvs[6] = { 0.0f, 0.5f, 1.0f, 1.5f, 2.0f, 2.5f };
+        view.data = reinterpret_cast<const uint8_t*>(uvs);
+        view.count = 3;
+        view.stride = 0;
+        view.componentCount = 2;
+        CHECK(EffectiveStride(view) == 8 && RequiredBytes(view) == sizeof(uvs));
+        CHECK(DecodeFloats(view, vertices[0].uv, sizeof(FloatVertex), 2));
+        CHECK(vertices[2].uv[0] == 2.0f && vertices[2].uv[1] == 2.5f && vertices[3].uv[0] == SENTINEL);
+
+        // A VEC4 stream into a 3-component field leaves the fourth alone.
+        const float tangents[4] = { 1.0f, 2.0f, 3.0f, -1.0f };
+        view.data = reinterpret_cast<const uint8_t*>(tangents);
+        view.count = 1;
+        view.componentCount = 4;
+        CHECK(DecodeFloats(view, vertices[4].tangent, sizeof(FloatVertex), 3));
+        CHECK(vertices[4].tangent[2] == 3.0f && vertices[4].tangent[3] == SENTINEL);
+
+        view.count = 0;
+        CHECK(RequiredBytes(view) == 0);
+    }
+
+    // Every value of T as VEC4 (the SSE path where there is one) and VEC3
+    // (scalar) in a padded stride, normalized and not, against the glTF rules.
+    template <typename T>
+    void CheckIntegerType(ComponentType type)
+    {
+        constexpr size_t VALUES = size_t(1) << (8 * sizeof(T));
+        const float unit = static_cast<float>(std::numeric_limits<T>::max());
+        for (int components : { 3, 4 })
+        {
+            const size_t count = (VALUES + components - 1) / static_cast<size_t>(components);
+            const size_t stride = (components * sizeof(T) + 3) / 4 * 4 + 4;
+            std::vector<uint8_t> bytes(count * stride, 0);
+            for (size_t v = 0; v < VALUES; ++v)
+            {
+                const T value = static_cast<T>(static_cast<long long>(std::numeric_limits<T>::min()) + static_cast<long long>(v));
+                Store(bytes, v / components * stride + v % components * sizeof(T), value);
+            }
+
+            for (bool normalized : { false, true })
+            {
+                AccessorView view;
+                view.data = bytes.data();
+                view.count = count;
+                view.stride = stride;
+                view.componentType = type;
+                view.componentCount = components;
+                view.normalized = normalized;
+                std::vector<float> decoded(count * 4, SENTINEL);
+                CHECK(DecodeFloats(view, decoded.data(), 4 * sizeof(float), 4));
+
+                bool same = true;
+                for (size_t v = 0; v < VALUES; ++v)
+                {
+                    const T value = static_cast<T>(static_cast<long long>(std::numeric_limits<T>::min()) + static_cast<long long>(v));
+                    float expected = static_cast<float>(value);
+                    if (normalized)
+                        expected = std::fmax(expected / unit, -1.0f);
+                    same &= std::fabs(decoded[v / components * 4 + v % components] - expected) <= 1e-6f;
+                }
+                if (components == 3)
+                    for (size_t i = 0; i < count; ++i)
+                        same &= decoded[i * 4 + 3] == SENTINEL;
+                CHECK(same);
+            }
+        }
+    }
+
+    void TestIntegerComponents()
+    {
+        CheckIntegerType<uint8_t>(ComponentType::UnsignedByte);
+        CheckIntegerType<int8_t>(ComponentType::Byte);
+        CheckIntegerType<uint16_t>(ComponentType::UnsignedShort);
+        CheckIntegerType<int16_t>(ComponentType::Short);
+
+        // Normalized signed minimum clamps to -1 rather than past it.
+        const int8_t minimum[4] = { -128, -127, 127, 0 };
+        AccessorView view;
+        view.data = reinterpret_cast<const uint8_t*>(minimum);
+        view.count = 1;
+        view.componentType = ComponentType::Byte;
+        view.componentCount = 4;
+        view.normalized = true;
+        float decoded[4];
+        CHECK(DecodeFloats(view, decoded, sizeof(decoded), 4));
+        CHECK(decoded[0] == -1.0f && decoded[1] == -1.0f && decoded[2] == 1.0f && decoded[3] == 0.0f);
+
+        const uint32_t large[2] = { 4000000000u, 7u };
+        view.data = reinterpret_cast<const uint8_t*>(large);
+        view.componentType = ComponentType::UnsignedInt;
+        view.componentCount = 2;
+        view.normalized = false;
+        CHECK(DecodeFloats(view, decoded, sizeof(decoded), 2));
+        CHECK(decoded[0] == 4e9f && decoded[1] == 7.0f);
+
+        view.componentType = static_cast<ComponentType>(5124); // INT is not a glTF attribute type
+        CHECK(!DecodeFloats(view, decoded, sizeof(decoded), 2));
+    }
+
+    void TestIndices()
+    {
+        // Tight u8: SSE blocks of 16 where available, then the tail.
+        std::vector<uint8_t> bytes8(37);
+        for (size_t i = 0; i < bytes8.size(); ++i)
+            bytes8[i] = static_cast<uint8_t>(255 - i * 7);
+        AccessorView view;
+        view.data = bytes8.data();
+        view.count = bytes8.size();
+        view.componentType = ComponentType::UnsignedByte;
+        std::vector<uint32_t> indices(37);
+        CHECK(DecodeIndices(view, indices.data()));
+        CHECK(std::equal(indices.begin(), indices.end(), bytes8.begin()));
+
+        // u16 tight (SSE blocks of 8) and in a 4-byte stride (scalar).
+        for (size_t stride : { size_t(2), size_t(4) })
+        {
+            std::vector<uint8_t> bytes16(37 * stride, 0xee);
+            for (size_t i = 0; i < 37; ++i)
+                Store(bytes16, i * stride, static_cast<uint16_t>(65535 - i * 3));
+            view.data = bytes16.data();
+            view.count = 37;
+            view.stride = stride == 2 ? 0 : stride;
+            view.componentType = ComponentType::UnsignedShort;
+            indices.assign(37, 0);
+            CHECK(DecodeIndices(view, indices.data()));
+            bool same = true;
+            for (size_t i = 0; i < 37; ++i)
+                same &= indices[i] == 65535 - i * 3;
+            CHECK(same);
+        }
+
+        const uint32_t wide[3] = { 70000, 1, 4000000000u };
+        view.data = reinterpret_cast<const uint8_t*>(wide);
+        view.count = 3;
+        view.stride = 0;
+        view.componentType = ComponentType::UnsignedInt;
+        CHECK(DecodeIndices(view, indices.data()));
+        CHECK(indices[0] == 70000 && indices[2] == 4000000000u);
+
+        view.componentType = ComponentType::Float;
+        CHECK(!DecodeIndices(view, indices.data()));
+    }
+}
+
+int main()
+{
+    TestStridedFloats();
+    TestIntegerComponents();
+    TestIndices();
+    return TestCheck::Result("AccessorDecodingTests");
+}
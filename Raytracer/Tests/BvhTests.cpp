@@ -0,0 +1,404 @@
+#include "SceneResources/SceneBvh.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "TestCheck.h"
+
+namespace
+{
+    using Transform = float[3][4]; // BvhInstance::objectToWorld layout
+
+    // Barycentric margin (in units of the triangle) within which float and
+    // double tests may disagree about a ray grazing an edge.
+    constexpr double EDGE_MARGIN = 1e-4;
+    constexpr double T_TOLERANCE = 1e-4;
+
+    // Scale, then rotate by `angle` about the unit `axis`, then translate.
+    void MakeTransform(const float axis[3], float angle, const float scale[3], const float position[3], Transform& out)
+    {
+        const float c = std::cos(angle), s = std::sin(angle), k = 1.0f - c;
+        const float x = axis[0], y = axis[1], z = axis[2];
+        const float r[3][3] = {
+            { c + x * x * k, x * y * k - z * s, x * z * k + y * s },
+            { y * x * k + z * s, c + y * y * k, y * z * k - x * s },
+            { z * x * k - y * s, z * y * k + x * s, c + z * z * k },
+        };
+        for (int row = 0; row < 3; ++row)
+        {
+            for (int column = 0; column < 3; ++column)
+                out[row][column] = r[row][column] * scale[column];
+            out[row][3] = position[row];
+        }
+    }
+
+    void Apply(const Transform& m, const double p[3], double w, double out[3])
+    {
+        for (int r = 0; r < 3; ++r)
+            out[r] = m[r][0] * p[0] + m[r][1] * p[1] + m[r][2] * p[2] + m[r][3] * w;
+    }
+
+    struct Scene
+    {
+        std::vector<float> positions;
+        std::vector<uint32_t> indices;
+        std::vector<BvhGeometry> geometries;
+        std::vector<BvhInstance> instances;
+
+        [[nodiscard]] SceneBvhInput MakeInput() const
+        {
+            SceneBvhInput input;
+            input.positions = positions.data();
+            input.indices = indices.data();
+            input.geometries = geometries.data();
+            input.geometryCount = geometries.size();
+            input.instances = instances.data();
+            input.instanceCount = instances.size();
+            return input;
+        }
+    };
+
+    // Double-precision, two-sided Moller-Trumbore in world space. `margin` is
+    // the smallest barycentric weight: negative outside the triangle.
+    struct BruteHit
+    {
+        double t;
+        double u;
+        double v;
+        double margin;
+        uint32_t instance;
+        uint32_t primitive;
+    };
+
+    bool IntersectDouble(const double o[3], const double d[3], const double p0[3], const double p1[3], const double p2[3], double& t, double& u, double& v)
+    {
+        const double e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+        const double e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+        const double q[3] = { d[1] * e2[2] - d[2] * e2[1], d[2] * e2[0] - d[0] * e2[2], d[0] * e2[1] - d[1] * e2[0] };
+        const double det = e1[0] * q[0] + e1[1] * q[1] + e1[2] * q[2];
+        if (std::fabs(det) < 1e-300)
+            return false;
+        const double s[3] = { o[0] - p0[0], o[1] - p0[1], o[2] - p0[2] };
+        u = (s[0] * q[0] + s[1] * q[1] + s[2] * q[2]) / det;
+        const double r[3] = { s[1] * e1[2] - s[2] * e1[1], s[2] * e1[0] - s[0] * e1[2], s[0] * e1[1] - s[1] * e1[0] };
+        v = (d[0] * r[0] + d[1] * r[1] + d[2] * r[2]) / det;
+        t = (e2[0] * r[0] + e2[1] * r[1] + e2[2] * r[2]) / det;
+        return true;
+    }
+
+    // Every triangle of every invertible instance in world space; hits with a
+    // margin down to -EDGE_MARGIN, in any order.
+    std::vector<BruteHit> BruteForce(const Scene& scene, const BvhRay& ray)
+    {
+        std::vector<BruteHit> hits;
+        const double o[3] = { ray.origin[0], ray.origin[1], ray.origin[2] };
+        const double d[3] = { ray.direction[0], ray.direction[1], ray.direction[2] };
+        for (uint32_t i = 0; i < scene.instances.size(); ++i)
+        {
+            const BvhInstance& instance = scene.instances[i];
+            const Transform& m = instance.objectToWorld;
+            const double det =
+                double(m[0][0]) * (double(m[1][1]) * m[2][2] - double(m[1][2]) * m[2][1]) -
+                double(m[0][1]) * (double(m[1][0]) * m[2][2] - double(m[1][2]) * m[2][0]) +
+                double(m[0][2]) * (double(m[1][0]) * m[2][1] - double(m[1][1]) * m[2][0]);
+            if (det == 0.0)
+                continue;
+            const BvhGeometry& geometry = scene.geometries[instance.geometry];
+            for (uint32_t f = 0; f < geometry.indexCount / 3; ++f)
+            {
+                double corners[3][3];
+                for (int c = 0; c < 3; ++c)
+                {
+                    const float* p = &scene.positions[(static_cast<size_t>(geometry.vertexOffset) + scene.indices[geometry.indexOffset + f * 3 + c]) * 3];
+                    const double local[3] = { p[0], p[1], p[2] };
+                    Apply(m, local, 1.0, corners[c]);
+                }
+                double t, u, v;
+                if (!IntersectDouble(o, d, corners[0], corners[1], corners[2], t, u, v))
+                    continue;
+                const double margin = std::min({ u, v, 1.0 - u - v });
+                if (margin >= -EDGE_MARGIN && t > ray.tMin && t < ray.tMax)
+                    hits.push_back({ t, u, v, margin, i, f });
+            }
+        }
+        return hits;
+    }
+
+    // Random soups: each geometry a cloud of mid-sized triangles.
+    Scene MakeScene(std::mt19937& rng)
+    {
+        std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+        Scene scene;
+        for (uint32_t g = 0; g < 4; ++g)
+        {
+            BvhGeometry geometry;
+            geometry.vertexOffset = static_cast<uint32_t>(scene.positions.size() / 3);
+            geometry.indexOffset = static_cast<uint32_t>(scene.indices.size());
+            const uint32_t triangles = 150 + g * 50;
+            for (uint32_t f = 0; f < triangles; ++f)
+            {
+                const float center[3] = { unit(rng), unit(rng), unit(rng) };
+                for (int c = 0; c < 3; ++c)
+                {
+                    for (int a = 0; a < 3; ++a)
+                        scene.positions.push_back(center[a] + 0.25f * unit(rng));
+                    scene.indices.push_back(f * 3 + static_cast<uint32_t>(c));
+                }
+            }
+            geometry.indexCount = triangles * 3;
+            scene.geometries.push_back(geometry);
+        }
+
+        const struct
+        {
+            uint32_t geometry;
+            float axis[3];
+            float angle;
+            float scale[3];
+            float position[3];
+        } placements[] = {
+            { 0, { 0, 0, 1 }, 0.0f, { 1, 1, 1 }, { 0, 0, 0 } },
+            { 1, { 0, 1, 0 }, 0.7f, { 1.5f, 1.5f, 1.5f }, { 3, 0, 0 } },
+            { 2, { 0.6f, 0.8f, 0 }, -1.1f, { 0.5f, 2.0f, 1.0f }, { 0, 3, 1 } },
+            { 3, { 0, 0, 1 }, 0.3f, { -1, 1, 1 }, { -3, 0, 0 } },       // mirrored
+            { 0, { 1, 0, 0 }, 2.0f, { 1, -0.5f, -2.0f }, { 0, -3, -1 } }, // mirrored twice
+            { 1, { 0, 0, 1 }, 0.0f, { 1, 0, 1 }, { 0, 0, 3 } },         // singular: dropped
+            { 2, { 0, 1, 0 }, 0.0f, { 0, 0, 0 }, { 1, 1, 1 } },         // singular: dropped
+            { 3, { 0.0f, 0.6f, 0.8f }, 2.5f, { 0.8f, 0.8f, 0.8f }, { 1.5f, 1.5f, -2 } },
+        };
+        for (const auto& placement : placements)
+        {
+            BvhInstance instance;
+            instance.geometry = placement.geometry;
+            MakeTransform(placement.axis, placement.angle, placement.scale, placement.position, instance.objectToWorld);
+            scene.instances.push_back(instance);
+        }
+        return scene;
+    }
+
+    // Rays from around the scene, half aimed at a random point of a random
+    // triangle so most of them hit something.
+    std::vector<BvhRay> MakeRays(const Scene& scene, std::mt19937& rng, size_t count)
+    {
+        std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+        std::uniform_real_distribution<float> weight(0.0f, 1.0f);
+        std::vector<BvhRay> rays(count);
+        for (size_t r = 0; r < count; ++r)
+        {
+            BvhRay& ray = rays[r];
+            for (int a = 0; a < 3; ++a)
+                ray.origin[a] = 6.0f * unit(rng);
+            float target[3] = { unit(rng), unit(rng), unit(rng) };
+            if (r % 2 == 0)
+            {
+                const BvhInstance& instance = scene.instances[rng() % scene.instances.size()];
+                const BvhGeometry& geometry = scene.geometries[instance.geometry];
+                const uint32_t f = static_cast<uint32_t>(rng() % (geometry.indexCount / 3));
+                float w1 = weight(rng), w2 = weight(rng);
+                if (w1 + w2 > 1.0f)
+                {
+                    w1 = 1.0f - w1;
+                    w2 = 1.0f - w2;
+                }
+                double local[3] = { 0.0, 0.0, 0.0 };
+                for (int c = 0; c < 3; ++c)
+                {
+                    const float* p = &scene.positions[(static_cast<size_t>(geometry.vertexOffset) + scene.indices[geometry.indexOffset + f * 3 + c]) * 3];
+                    const double w = c == 0 ? 1.0 - w1 - w2 : (c == 1 ? w1 : w2);
+                    for (int a = 0; a < 3; ++a)
+                        local[a] += w * p[a];
+                }
+                double world[3];
+                Apply(instance.objectToWorld, local, 1.0, world);
+                for (int a = 0; a < 3; ++a)
+                    target[a] = static_cast<float>(world[a]);
+            }
+            for (int a = 0; a < 3; ++a)
+                ray.direction[a] = target[a] - ray.origin[a];
+            if (r % 3 == 0)
+                ray.tMax = 0.5f + weight(rng); // stops around the target
+        }
+        return rays;
+    }
+
+    // The BVH answer must lie between the closest hit the brute force finds
+    // with edge-grazing candidates and the closest without them.
+    void TestBruteForce()
+    {
+        std::mt19937 rng(17);
+        const Scene scene = MakeScene(rng);
+        SceneBvh bvh;
+        bvh.Build(scene.MakeInput());
+        CHECK(bvh.GetStats().instanceCount == scene.instances.size() - 2);
+
+        const std::vector<BvhRay> rays = MakeRays(scene, rng, 4000);
+        size_t hits = 0;
+        bool closestOk = true;
+        bool occludedOk = true;
+        bool singularMissed = true;
+        for (const BvhRay& ray : rays)
+        {
+            const std::vector<BruteHit> candidates = BruteForce(scene, ray);
+            double possible = INFINITY; // closest hit including edge grazers
+            double certain = INFINITY;  // closest hit well inside a triangle
+            for (const BruteHit& candidate : candidates)
+            {
+                possible = std::min(possible, candidate.t);
+                if (candidate.margin >= EDGE_MARGIN)
+                    certain = std::min(certain, candidate.t);
+            }
+
+            BvhHit hit;
+            const bool found = bvh.Intersect(ray, hit);
+            hits += found;
+            if (found)
+            {
+                singularMissed &= hit.instance != 5 && hit.instance != 6;
+                const double tolerance = T_TOLERANCE * std::max(1.0, static_cast<double>(hit.t));
+                closestOk &= hit.t >= possible - tolerance && hit.t <= certain + tolerance;
+                // The reported triangle is one the brute force hits at that t, with the same barycentrics.
+                bool matched = false;
+                for (const BruteHit& candidate : candidates)
+                {
+                    matched |= candidate.instance == hit.instance && candidate.primitive == hit.primitive &&
+                        std::fabs(candidate.t - hit.t) <= tolerance &&
+                        std::fabs(candidate.u - hit.u) <= 1e-3 && std::fabs(candidate.v - hit.v) <= 1e-3;
+                }
+                closestOk &= matched;
+            }
+            else
+            {
+                closestOk &= certain == INFINITY;
+            }
+
+            // Occlusion over the whole ray, then up to half the first possible hit.
+            const bool occluded = bvh.Occluded(ray);
+            occludedOk &= certain == INFINITY || occluded;
+            occludedOk &= possible != INFINITY || !occluded;
+            occludedOk &= occluded == found;
+            if (possible != INFINITY)
+            {
+                BvhRay shortened = ray;
+                shortened.tMax = static_cast<float>(possible * 0.5);
+                occludedOk &= !bvh.Occluded(shortened);
+            }
+        }
+        std::printf("BvhTests: %zu of %zu rays hit\n", hits, rays.size());
+        CHECK(hits > rays.size() / 3);
+        CHECK(closestOk);
+        CHECK(occludedOk);
+        CHECK(singularMissed);
+
+        // The batch path answers like the single-ray one.
+        std::vector<BvhHit> batch(rays.size());
+        bvh.IntersectBatch(rays.data(), batch.data(), rays.size());
+        bool same = true;
+        for (size_t r = 0; r < rays.size(); ++r)
+        {
+            BvhHit hit;
+            bvh.Intersect(rays[r], hit);
+            same &= batch[r].IsHit() == hit.IsHit() && batch[r].t == hit.t && batch[r].primitive == hit.primitive && batch[r].instance == hit.instance;
+        }
+        CHECK(same);
+    }
+
+    // A 64x64 height field: rays through every interior vertex and the middle
+    // of every interior edge, where watertight intersection must leave no gap.
+    // The bumps stay shallower than every ray, so each ray crosses the surface
+    // at its target instead of grazing it.
+    void TestWatertight()
+    {
+        constexpr uint32_t N = 64;
+        std::mt19937 rng(23);
+        std::uniform_real_distribution<float> bump(-0.002f, 0.002f);
+        Scene scene;
+        for (uint32_t y = 0; y <= N; ++y)
+            for (uint32_t x = 0; x <= N; ++x)
+                scene.positions.insert(scene.positions.end(), { static_cast<float>(x) / N, static_cast<float>(y) / N, bump(rng) });
+        for (uint32_t y = 0; y < N; ++y)
+        {
+            for (uint32_t x = 0; x < N; ++x)
+            {
+                const uint32_t i = y * (N + 1) + x;
+                // Alternate the diagonal so vertices see four and eight triangles.
+                if ((x + y) % 2 == 0)
+                    scene.indices.insert(scene.indices.end(), { i, i + 1, i + N + 2, i, i + N + 2, i + N + 1 });
+                else
+                    scene.indices.insert(scene.indices.end(), { i, i + 1, i + N + 1, i + 1, i + N + 2, i + N + 1 });
+            }
+        }
+        BvhGeometry geometry;
+        geometry.indexCount = static_cast<uint32_t>(scene.indices.size());
+        scene.geometries.push_back(geometry);
+
+        // Object space, and through a rotated, mirrored, non-uniformly scaled instance.
+        const float axis[3] = { 0.48f, 0.6f, 0.64f };
+        const float scale[3] = { -3.0f, 0.7f, 1.3f };
+        const float position[3] = { 5.0f, -1.0f, 2.0f };
+        for (int placed = 0; placed < 2; ++placed)
+        {
+            BvhInstance instance;
+            if (placed == 1)
+                MakeTransform(axis, 1.2f, scale, position, instance.objectToWorld);
+            scene.instances = { instance };
+            SceneBvh bvh;
+            bvh.Build(scene.MakeInput());
+
+            // Targets on shared vertices and edges, in object space.
+            std::vector<double> targets;
+            auto vertex = [&](uint32_t index) { return &scene.positions[static_cast<size_t>(index) * 3]; };
+            for (size_t f = 0; f < scene.indices.size(); f += 3)
+            {
+                for (int e = 0; e < 3; ++e)
+                {
+                    const float* a = vertex(scene.indices[f + e]);
+                    const float* b = vertex(scene.indices[f + (e + 1) % 3]);
+                    const bool interior = std::min({ a[0], a[1], b[0], b[1] }) > 0.0f && std::max({ a[0], a[1], b[0], b[1] }) < 1.0f;
+                    if (!interior)
+                        continue;
+                    targets.insert(targets.end(), { a[0], a[1], a[2] });
+                    targets.insert(targets.end(), { 0.5 * (a[0] + b[0]), 0.5 * (a[1] + b[1]), 0.5 * (double(a[2]) + b[2]) });
+                }
+            }
+
+            const double directions[3][3] = { { 0.0, 0.0, -1.0 }, { 0.3, -0.2, -1.0 }, { -0.6, 0.45, -0.8 } };
+            size_t rays = 0;
+            size_t misses = 0;
+            for (size_t t = 0; t < targets.size(); t += 3)
+            {
+                for (const double* direction : directions)
+                {
+                    const double origin[3] = { targets[t] - 2.0 * direction[0], targets[t + 1] - 2.0 * direction[1], targets[t + 2] - 2.0 * direction[2] };
+                    double worldOrigin[3], worldDirection[3];
+                    Apply(instance.objectToWorld, origin, 1.0, worldOrigin);
+                    Apply(instance.objectToWorld, direction, 0.0, worldDirection);
+                    BvhRay ray;
+                    for (int a = 0; a < 3; ++a)
+                    {
+                        ray.origin[a] = static_cast<float>(worldOrigin[a]);
+                        ray.direction[a] = static_cast<float>(worldDirection[a]);
+                    }
+                    ++rays;
+                    misses += !bvh.Occluded(ray);
+                    BvhHit hit;
+                    misses += !bvh.Intersect(ray, hit);
+                }
+            }
+            if (misses != 0)
+                std::fprintf(stderr, "BvhTests: %zu of %zu rays slipped through the grid (instance %d)\n", misses, rays * 2, placed);
+            CHECK(rays > 3 * 4 * (N - 1) * (N - 1));
+            CHECK(misses == 0);
+        }
+    }
+}
+
+int main()
+{
+    TestBruteForce();
+    TestWatertight();
+    return TestCheck::Result("BvhTests");
+}
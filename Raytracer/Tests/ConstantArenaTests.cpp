@@ -0,0 +1,201 @@
+#include "Resources/ConstantArena.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "TestCheck.h"
+
+namespace
+{
+    // Heap pages with made-up GPU addresses, so a GPU address can be read back.
+    class HeapBacking : public ConstantArenaBacking
+    {
+    public:
+        struct Pages
+        {
+            std::vector<Page> pages;
+            std::vector<size_t> sizes;
+        };
+
+        explicit HeapBacking(std::shared_ptr<Pages> pages) : m_pages(std::move(pages)) {}
+
+        ~HeapBacking() override
+        {
+            for (const Page& page : m_pages->pages)
+                std::free(page.cpu);
+        }
+
+        Page AllocatePage(size_t bytes) override
+        {
+            Page page{ static_cast<uint8_t*>(std::aligned_alloc(ConstantArena::SLOT_ALIGNMENT, bytes)), m_nextGpu };
+            m_nextGpu += bytes + ConstantArena::SLOT_ALIGNMENT;
+            m_pages->pages.push_back(page);
+            m_pages->sizes.push_back(bytes);
+            return page;
+        }
+
+    private:
+        std::shared_ptr<Pages> m_pages;
+        uint64_t m_nextGpu = 0x10000;
+    };
+
+    struct Fixture
+    {
+        std::shared_ptr<HeapBacking::Pages> pages = std::make_shared<HeapBacking::Pages>();
+        std::shared_ptr<ConstantArena> arena;
+
+        explicit Fixture(uint32_t frameCount, size_t pageSize = 4096)
+            : arena(std::make_shared<ConstantArena>(std::make_unique<HeapBacking>(pages), frameCount, pageSize))
+        {
+        }
+
+        // What the GPU would read at `gpu`.
+        const uint8_t* Cpu(uint64_t gpu) const
+        {
+            for (size_t i = 0; i < pages->pages.size(); ++i)
+                if (gpu >= pages->pages[i].gpu && gpu < pages->pages[i].gpu + pages->sizes[i])
+                    return pages->pages[i].cpu + (gpu - pages->pages[i].gpu);
+            return nullptr;
+        }
+    };
+
+    struct Constants
+    {
+        float values[24];
+    };
+
+    Constants Fill(float value)
+    {
+        Constants constants;
+        for (float& v : constants.values)
+            v = value;
+        return constants;
+    }
+
+    void TestVersions()
+    {
+        constexpr uint32_t FRAMES = 3;
+        Fixture fixture(FRAMES);
+        ConstantAllocation allocation = fixture.arena->Allocate(sizeof(Constants));
+        ConstantAllocation large = fixture.arena->Allocate(300);
+        CHECK(allocation.GetSize() == sizeof(Constants) && large.GetSize() == 300);
+        CHECK(allocation.GetGpuAddress() % ConstantArena::SLOT_ALIGNMENT == 0);
+        CHECK(large.GetGpuAddress() % ConstantArena::SLOT_ALIGNMENT == 0);
+
+        // Zeroed before the first write.
+        const Constants zero = Fill(0.0f);
+        CHECK(std::memcmp(fixture.Cpu(allocation.GetGpuAddress()), &zero, sizeof(zero)) == 0);
+
+        // Writes within a frame share a copy; every frame moves to the next one
+        // and leaves the copies earlier frames read alone.
+        std::vector<uint64_t> addresses;
+        for (uint32_t frame = 0; frame < FRAMES; ++frame)
+        {
+            const Constants first = Fill(static_cast<float>(frame));
+            allocation.Write(&first, sizeof(first));
+            const uint64_t address = allocation.GetGpuAddress();
+            const Constants second = Fill(static_cast<float>(frame) + 0.5f);
+            allocation.Write(&second, sizeof(second));
+            CHECK(allocation.GetGpuAddress() == address);
+            addresses.push_back(address);
+            fixture.arena->AdvanceFrame();
+        }
+        CHECK(std::set<uint64_t>(addresses.begin(), addresses.end()).size() == FRAMES);
+        for (uint32_t frame = 0; frame < FRAMES; ++frame)
+        {
+            const Constants expected = Fill(static_cast<float>(frame) + 0.5f);
+            CHECK(std::memcmp(fixture.Cpu(addresses[frame]), &expected, sizeof(expected)) == 0);
+        }
+
+        // The copy reused after FRAMES frames gets the whole new contents.
+        const Constants next = Fill(9.0f);
+        allocation.Write(&next, sizeof(next));
+        CHECK(allocation.GetGpuAddress() == addresses[0]);
+        CHECK(std::memcmp(fixture.Cpu(allocation.GetGpuAddress()), &next, sizeof(next)) == 0);
+    }
+
+    void TestDeferredFree()
+    {
+        constexpr uint32_t FRAMES = 2;
+        Fixture fixture(FRAMES);
+        uint64_t freedAddress = 0;
+        {
+            ConstantAllocation allocation = fixture.arena->Allocate(128);
+            freedAddress = allocation.GetGpuAddress();
+            ConstantAllocation moved = std::move(allocation);
+            CHECK(!allocation.IsValid() && moved.IsValid());
+        }
+        ConstantArena::Stats stats = fixture.arena->GetStats();
+        CHECK(stats.liveAllocations == 0 && stats.liveBytes == 0 && stats.pendingFrees == 1);
+
+        // Not reused while a frame in flight could still read it.
+        {
+            ConstantAllocation early = fixture.arena->Allocate(128);
+            CHECK(early.GetGpuAddress() != freedAddress);
+        }
+        fixture.arena->AdvanceFrame();
+        CHECK(fixture.arena->GetStats().pendingFrees == 2);
+        fixture.arena->AdvanceFrame();
+        CHECK(fixture.arena->GetStats().pendingFrees == 0);
+
+        const size_t pageCount = fixture.arena->GetStats().pageCount;
+        ConstantAllocation reused = fixture.arena->Allocate(100);
+        ConstantAllocation reusedToo = fixture.arena->Allocate(100);
+        CHECK(reused.GetGpuAddress() == freedAddress || reusedToo.GetGpuAddress() == freedAddress);
+        CHECK(fixture.arena->GetStats().pageCount == pageCount);
+    }
+
+    void TestLargeAndThreaded()
+    {
+        Fixture fixture(3, 4096);
+
+        // Larger than a page: a page of its own.
+        ConstantAllocation huge = fixture.arena->Allocate(8000);
+        CHECK(huge.IsValid() && fixture.pages->sizes.back() >= 8192 * 3);
+
+        constexpr int THREADS = 4;
+        constexpr int PER_THREAD = 2000;
+        std::vector<std::vector<ConstantAllocation>> allocations(THREADS);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < THREADS; ++t)
+        {
+            threads.emplace_back([&, t]
+            {
+                const Constants constants = Fill(static_cast<float>(t));
+                for (int i = 0; i < PER_THREAD; ++i)
+                {
+                    allocations[t].push_back(fixture.arena->Allocate(sizeof(Constants)));
+                    allocations[t].back().Write(&constants, sizeof(constants));
+                }
+            });
+        }
+        for (std::thread& thread : threads)
+            thread.join();
+
+        std::set<uint64_t> addresses;
+        for (int t = 0; t < THREADS; ++t)
+        {
+            const Constants expected = Fill(static_cast<float>(t));
+            for (const ConstantAllocation& allocation : allocations[t])
+            {
+                addresses.insert(allocation.GetGpuAddress());
+                CHECK(std::memcmp(fixture.Cpu(allocation.GetGpuAddress()), &expected, sizeof(expected)) == 0);
+            }
+        }
+        CHECK(addresses.size() == THREADS * PER_THREAD);
+        CHECK(fixture.arena->GetStats().liveAllocations == THREADS * PER_THREAD + 1);
+    }
+}
+
+int main()
+{
+    TestVersions();
+    TestDeferredFree();
+    TestLargeAndThreaded();
+    return TestCheck::Result("ConstantArenaTests");
+}
@@ -0,0 +1,227 @@
+#include "Resources/DescriptorAllocator.h"
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include "TestCheck.h"
+
+namespace
+{
+    constexpr uint32_t INVALID = DescriptorRangeAllocator::INVALID;
+
+    // Random allocate/free traffic checked against per-descriptor ownership;
+    // Validate runs every few dozen ops and everything coalesces back at the end.
+    void FuzzRanges(uint32_t seed)
+    {
+        std::mt19937 rng(seed);
+        constexpr uint32_t BASE = 10;
+        constexpr uint32_t CAPACITY = 1000;
+        DescriptorRangeAllocator allocator(BASE, CAPACITY);
+        std::vector<std::pair<uint32_t, uint32_t>> live;
+        std::vector<uint8_t> owned(BASE + CAPACITY, 0);
+
+        for (int op = 0; op < 20000; ++op)
+        {
+            if (live.empty() || rng() % 2 == 0)
+            {
+                const uint32_t count = 1 + rng() % 20;
+                const uint32_t offset = allocator.Allocate(count);
+                if (offset == INVALID)
+                    continue;
+                CHECK(offset >= BASE && offset + count <= BASE + CAPACITY);
+                for (uint32_t i = offset; i < offset + count && i < owned.size(); ++i)
+                {
+                    CHECK(!owned[i]);
+                    owned[i] = 1;
+                }
+                live.emplace_back(offset, count);
+            }
+            else
+            {
+                const size_t index = rng() % live.size();
+                const auto [offset, count] = live[index];
+                live[index] = live.back();
+                live.pop_back();
+                for (uint32_t i = offset; i < offset + count; ++i)
+                    owned[i] = 0;
+                allocator.Free(offset, count);
+            }
+            if (op % 97 == 0)
+                CHECK(allocator.Validate());
+        }
+
+        for (const auto& [offset, count] : live)
+            allocator.Free(offset, count);
+        CHECK(allocator.Validate());
+        const DescriptorRangeAllocator::Stats stats = allocator.GetStats();
+        CHECK(stats.used == 0 && stats.allocationCount == 0);
+        CHECK(stats.freeRangeCount == 1 && stats.largestFree == CAPACITY);
+        CHECK(stats.Fragmentation() == 0.0);
+    }
+
+    void TestRanges()
+    {
+        DescriptorRangeAllocator allocator(0, 10);
+        CHECK(allocator.Allocate(11) == INVALID);
+        const uint32_t a = allocator.Allocate(4);
+        const uint32_t b = allocator.Allocate(2);
+        const uint32_t c = allocator.Allocate(4);
+        CHECK(a == 0 && b == 4 && c == 6);
+        CHECK(allocator.Allocate(1) == INVALID);
+
+        // A freed hole only fits what is no larger than it.
+        allocator.Free(b, 2);
+        CHECK(allocator.Allocate(3) == INVALID);
+        CHECK(allocator.Allocate(2) == 4);
+
+        // Neighbours coalesce on free.
+        allocator.Free(4, 2);
+        allocator.Free(0, 4);
+        CHECK(allocator.GetStats().freeRangeCount == 1);
+        CHECK(allocator.Allocate(6) == 0);
+        CHECK(allocator.Validate());
+
+        // Best fit: the 3-descriptor hole, not the first one that fits.
+        DescriptorRangeAllocator bestFit(0, 100);
+        const uint32_t large = bestFit.Allocate(10);
+        bestFit.Allocate(1);
+        const uint32_t small = bestFit.Allocate(3);
+        bestFit.Allocate(1);
+        bestFit.Free(large, 10);
+        bestFit.Free(small, 3);
+        CHECK(bestFit.Allocate(3) == small);
+        CHECK(bestFit.GetStats().Fragmentation() > 0.0);
+    }
+
+    void TestRing()
+    {
+        DescriptorRing ring(100, 10, 2);
+        CHECK(ring.Allocate(4) == 100);
+        CHECK(ring.Allocate(4) == 104);
+        CHECK(ring.Allocate(4) == DescriptorRing::INVALID);
+
+        // Frame 0 is still in flight after one advance.
+        ring.AdvanceFrame();
+        CHECK(ring.Allocate(2) == 108);
+        CHECK(ring.Allocate(1) == DescriptorRing::INVALID);
+
+        // Frame 0 retires; its 8 descriptors are reused from the start.
+        ring.AdvanceFrame();
+        CHECK(ring.GetInFlight() == 2);
+        CHECK(ring.Allocate(3) == 100);
+        CHECK(ring.Allocate(11) == DescriptorRing::INVALID);
+        ring.AdvanceFrame();
+        ring.AdvanceFrame();
+        CHECK(ring.GetInFlight() == 0);
+        CHECK(ring.Allocate(10) == 100);
+        CHECK(ring.GetPeakInFlight() == 10);
+
+        // A table never wraps: the tail is skipped instead.
+        DescriptorRing single(0, 10, 1);
+        CHECK(single.Allocate(7) == 0);
+        single.AdvanceFrame();
+        CHECK(single.Allocate(5) == 0);
+        CHECK(single.GetInFlight() == 5);
+        for (int frame = 0; frame < 1000; ++frame)
+        {
+            single.AdvanceFrame();
+            CHECK(single.Allocate(3) != DescriptorRing::INVALID);
+            CHECK(single.Allocate(3) != DescriptorRing::INVALID);
+        }
+    }
+
+    void TestNamedAndBindless()
+    {
+        DescriptorAllocator allocator(64, 16, 3);
+        const DescriptorAllocator::Range scene = allocator.GetNamed("Scene Table", 6);
+        CHECK(scene.offset == 0 && scene.count == 6);
+        const DescriptorAllocator::Range textures = allocator.GetBindlessTable("Textures", 8);
+        CHECK(textures.offset == 6 && textures.count == 8);
+        CHECK(allocator.GetBindlessTable("Textures", 8).offset == textures.offset);
+        const DescriptorAllocator::Range vbuffer = allocator.GetNamed("VBuffer");
+        CHECK(allocator.GetNamed("VBuffer").offset == vbuffer.offset);
+
+        // Bindless indices are table-relative and handed out densely.
+        for (uint32_t i = 0; i < 8; ++i)
+            CHECK(allocator.AllocateBindless("Textures") == i);
+        CHECK(allocator.AllocateBindless("Textures") == DescriptorAllocator::INVALID);
+
+        // A released index comes back only once `frameCount` frames have passed.
+        allocator.FreeBindless("Textures", 3);
+        allocator.AdvanceFrame();
+        allocator.AdvanceFrame();
+        CHECK(allocator.AllocateBindless("Textures") == DescriptorAllocator::INVALID);
+        allocator.AdvanceFrame();
+        CHECK(allocator.AllocateBindless("Textures") == 3);
+
+        // Persistent ranges are deferred the same way.
+        const uint32_t remaining = 64 - 6 - 8 - 1;
+        const DescriptorAllocator::Range range = allocator.Allocate(10);
+        CHECK(range.IsValid());
+        allocator.Free(range);
+        CHECK(!allocator.Allocate(remaining - 10 + 1).IsValid());
+        CHECK(allocator.GetStats().pendingFrees == 1);
+        for (int frame = 0; frame < 3; ++frame)
+            allocator.AdvanceFrame();
+        CHECK(allocator.Allocate(remaining).IsValid());
+
+        // The transient ring sits after the persistent part.
+        CHECK(allocator.AllocateTransient(16).offset == 64);
+        CHECK(!allocator.AllocateTransient(1).IsValid());
+
+        const DescriptorAllocator::Stats stats = allocator.GetStats();
+        CHECK(stats.named.size() == 3 && stats.bindlessTables.size() == 1);
+        CHECK(std::get<1>(stats.bindlessTables[0]) == 8 && std::get<2>(stats.bindlessTables[0]) == 8);
+        CHECK(stats.persistent.used == 64 && stats.transientInFlight == 16);
+        CHECK(allocator.GetCapacity() == 80);
+    }
+
+    // Passes register and allocate from worker threads while the render
+    // thread advances frames; run under RAYTRACER_SANITIZE to catch races.
+    void TestThreads()
+    {
+        DescriptorAllocator allocator(4096, 1024, 3);
+        allocator.GetBindlessTable("Textures", 512);
+        std::vector<std::thread> workers;
+        for (int worker = 0; worker < 4; ++worker)
+        {
+            workers.emplace_back([&allocator]
+            {
+                for (uint32_t i = 0; i < 20000; ++i)
+                {
+                    const DescriptorAllocator::Range range = allocator.Allocate(1 + i % 4);
+                    allocator.Free(range);
+                    allocator.FreeBindless("Textures", allocator.AllocateBindless("Textures"));
+                    allocator.GetNamed("Pass " + std::to_string(i % 8));
+                    allocator.AllocateTransient(1);
+                }
+            });
+        }
+        for (int frame = 0; frame < 2000; ++frame)
+            allocator.AdvanceFrame();
+        for (std::thread& worker : workers)
+            worker.join();
+        for (int frame = 0; frame < 3; ++frame)
+            allocator.AdvanceFrame();
+
+        const DescriptorAllocator::Stats stats = allocator.GetStats();
+        CHECK(stats.pendingFrees == 0);
+        CHECK(stats.named.size() == 9 && std::get<1>(stats.bindlessTables[0]) == 0);
+        CHECK(stats.persistent.used == 512 + 8);
+    }
+}
+
+int main()
+{
+    for (uint32_t seed = 1; seed <= 8; ++seed)
+        FuzzRanges(seed);
+    TestRanges();
+    TestRing();
+    TestNamedAndBindless();
+    TestThreads();
+    return TestCheck::Result("DescriptorAllocatorTests");
+}
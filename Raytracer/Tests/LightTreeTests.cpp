@@ -0,0 +1,238 @@
+#include "SceneResources/LightTree.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "Constants.h"
+#include "TestCheck.h"
+
+namespace
+{
+    constexpr uint16_t NONE = LightTreeNode::NONE;
+    constexpr uint32_t NO_CLUSTER = 0xffffffffu;
+
+    // PackFloat3 of whole numbers: x/y halves in the first word, z in the
+    // high half of the second.
+    constexpr uint16_t Half(int value)
+    {
+        return value == 0 ? 0x0000 : value == 1 ? 0x3c00 : value == 2 ? 0x4000 : value == 3 ? 0x4200 : 0x4400;
+    }
+
+    bool BoundsAre(const LightTreeNode& node, const int lo[3], const int hi[3])
+    {
+        return node.aabbMin[0] == (Half(lo[0]) | static_cast<uint32_t>(Half(lo[1])) << 16) &&
+            node.aabbMin[1] == static_cast<uint32_t>(Half(lo[2])) << 16 &&
+            node.aabbMax[0] == (Half(hi[0]) | static_cast<uint32_t>(Half(hi[1])) << 16) &&
+            node.aabbMax[1] == static_cast<uint32_t>(Half(hi[2])) << 16;
+    }
+
+    bool LinksAre(const LightTreeNode& node, uint16_t parent, uint16_t left, uint16_t right, uint16_t voxel)
+    {
+        return node.parentIndex == parent && node.leftIndex == left && node.rightIndex == right && node.voxelIndex == voxel;
+    }
+
+    VoxelGridConstants MakeGrid(uint32_t gridDim)
+    {
+        VoxelGridConstants grid{};
+        grid.voxelSize = 1.0f;
+        grid.gridDim = gridDim;
+        for (int a = 0; a < 3; ++a)
+            grid.gridMax[a] = static_cast<float>(gridDim);
+        return grid;
+    }
+
+    // Four voxels of a 4^3 unit grid, worked through by hand:
+    //   compact 0: (0,0,0) cluster 1, compact 1: (3,3,3) cluster 0,
+    //   compact 2: (1,0,0) cluster 0, compact 3: (2,0,0) unclustered.
+    // Keys sort by cluster, then Morton code, so the leaves are compact
+    // 2, 1, 0, 3 (nodes 3 to 6). The Karras split puts the unclustered leaf
+    // under the root (0 -> 2, 6), cluster 0 below it (2 -> 1, 5) and the two
+    // cluster-0 leaves together (1 -> 3, 4).
+    void TestSmallTree()
+    {
+        const uint32_t compactIds[4] = { 0, 3 + 3 * 4 + 3 * 16, 1, 2 };
+        const int32_t clusters[4] = { 1, 0, 0, -1 };
+        const float irradiance[4] = { 1.0f, 2.0f, 4.0f, 8.0f };
+        LightTreeInput input;
+        input.compactIds = compactIds;
+        input.clusterAssignments = clusters;
+        input.premulIrradiance = irradiance;
+        input.count = 4;
+
+        const LightTree tree = BuildLightTree(input, MakeGrid(4));
+        CHECK(tree.leafCount == 4 && !tree.overflow);
+        CHECK(tree.nodes.size() == 7 && tree.sortKeys.size() == 4);
+        if (tree.nodes.size() != 7 || tree.sortKeys.size() != 4)
+            return;
+
+        // Cluster in the top 16 bits, leaf id in the low 16. The voxel at the
+        // origin has centre 128 / 1024 on each axis: Morton code 7 << 21.
+        const uint64_t clusterField[4] = { 0, 0, 1, 0xffff };
+        const uint64_t leafIds[4] = { 2, 1, 0, 3 };
+        bool keysOk = true;
+        for (int i = 0; i < 4; ++i)
+            keysOk &= tree.sortKeys[i] >> 48 == clusterField[i] && (tree.sortKeys[i] & 0xffff) == leafIds[i];
+        CHECK(keysOk);
+        CHECK(tree.sortKeys[2] == (uint64_t(1) << 48 | uint64_t(7) << 37));
+
+        const std::vector<LightTreeNode>& n = tree.nodes;
+        CHECK(LinksAre(n[0], NONE, 2, 6, NONE));
+        CHECK(LinksAre(n[1], 2, 3, 4, NONE));
+        CHECK(LinksAre(n[2], 0, 1, 5, NONE));
+        CHECK(LinksAre(n[3], 1, NONE, NONE, 2));
+        CHECK(LinksAre(n[4], 1, NONE, NONE, 1));
+        CHECK(LinksAre(n[5], 2, NONE, NONE, 0));
+        CHECK(LinksAre(n[6], 0, NONE, NONE, 3));
+
+        const int origin[3] = { 0, 0, 0 }, one[3] = { 1, 1, 1 }, four[3] = { 4, 4, 4 };
+        const int x1[3] = { 1, 0, 0 }, x2[3] = { 2, 1, 1 }, x2lo[3] = { 2, 0, 0 }, x3[3] = { 3, 1, 1 }, three[3] = { 3, 3, 3 };
+        CHECK(BoundsAre(n[3], x1, x2) && BoundsAre(n[4], three, four) && BoundsAre(n[5], origin, one) && BoundsAre(n[6], x2lo, x3));
+        CHECK(BoundsAre(n[1], x1, four) && BoundsAre(n[2], origin, four) && BoundsAre(n[0], origin, four));
+
+        CHECK(n[3].intensity == 4.0f && n[4].intensity == 2.0f && n[5].intensity == 1.0f && n[6].intensity == 8.0f);
+        CHECK(n[1].intensity == 6.0f && n[2].intensity == 7.0f && n[0].intensity == 15.0f);
+        CHECK(n[3].flag == 0 && n[4].flag == 0 && n[5].flag == 1 && n[6].flag == NO_CLUSTER);
+        CHECK(n[1].flag == 0 && n[2].flag == NO_CLUSTER && n[0].flag == NO_CLUSTER);
+
+        // A cluster's root is its largest subtree holding only that cluster.
+        CHECK(tree.clusterRoots[0] == 1 && tree.clusterRoots[1] == 5);
+        CHECK(std::all_of(tree.clusterRoots + 2, tree.clusterRoots + LightTree::CLUSTER_COUNT, [](int32_t root) { return root == -1; }));
+        CHECK((tree.compactToLeaf == std::vector<int32_t>{ 5, 4, 3, 6 }));
+
+        // One leaf is its own root and its cluster's.
+        input.count = 1;
+        const LightTree single = BuildLightTree(input, MakeGrid(4));
+        CHECK(single.nodes.size() == 1 && LinksAre(single.nodes[0], NONE, NONE, NONE, 0));
+        CHECK(single.clusterRoots[1] == 0 && single.clusterRoots[0] == -1);
+    }
+
+    std::vector<LightTreeNode> Narrow(const LightTreeWide& tree)
+    {
+        const auto index = [](uint32_t value) { return value == LightTreeNodeWide::NONE ? NONE : static_cast<uint16_t>(value); };
+        std::vector<LightTreeNode> nodes(tree.nodes.size());
+        for (size_t i = 0; i < nodes.size(); ++i)
+        {
+            const LightTreeNodeWide& wide = tree.nodes[i];
+            LightTreeNode& node = nodes[i];
+            std::copy(wide.aabbMin, wide.aabbMin + 2, node.aabbMin);
+            std::copy(wide.aabbMax, wide.aabbMax + 2, node.aabbMax);
+            node.intensity = wide.intensity;
+            node.flag = wide.flag;
+            node.parentIndex = index(wide.parentIndex);
+            node.leftIndex = index(wide.leftIndex);
+            node.rightIndex = index(wide.rightIndex);
+            node.voxelIndex = index(wide.voxelIndex);
+        }
+        return nodes;
+    }
+
+    struct RandomInput
+    {
+        std::vector<uint32_t> compactIds;
+        std::vector<int32_t> clusters;
+        std::vector<float> irradiance;
+
+        RandomInput(uint32_t count, uint32_t gridDim, unsigned seed)
+        {
+            std::mt19937 rng(seed);
+            std::vector<uint32_t> cells(static_cast<size_t>(gridDim) * gridDim * gridDim);
+            std::iota(cells.begin(), cells.end(), 0u);
+            std::shuffle(cells.begin(), cells.end(), rng);
+            compactIds.assign(cells.begin(), cells.begin() + count);
+            std::sort(compactIds.begin(), compactIds.end());
+            std::uniform_int_distribution<int32_t> cluster(-1, static_cast<int32_t>(LightTree::CLUSTER_COUNT) - 1);
+            std::uniform_real_distribution<float> value(0.0f, 4.0f);
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                clusters.push_back(cluster(rng));
+                irradiance.push_back(value(rng));
+            }
+        }
+
+        [[nodiscard]] LightTreeInput Get() const
+        {
+            LightTreeInput input;
+            input.compactIds = compactIds.data();
+            input.clusterAssignments = clusters.data();
+            input.premulIrradiance = irradiance.data();
+            input.count = static_cast<uint32_t>(compactIds.size());
+            return input;
+        }
+    };
+
+    // Under the cap the wide variant builds the same tree, node for node.
+    void TestWideMatches()
+    {
+        VoxelGridConstants grid = MakeGrid(64);
+        grid.gridMin[0] = -3.5f;
+        grid.voxelSize = 0.125f;
+        for (uint32_t count : { 2u, 3u, 100u, 4097u, 20000u, 32767u })
+        {
+            const RandomInput random(count, 64, count);
+            const LightTree tree = BuildLightTree(random.Get(), grid);
+            const LightTreeWide wide = BuildWideLightTree(random.Get(), grid);
+            CHECK(tree.leafCount == count && wide.leafCount == count && !tree.overflow && !wide.overflow);
+
+            const std::vector<LightTreeNode> narrowed = Narrow(wide);
+            const LightTreeDiff diff = CompareLightTrees(tree.nodes.data(), tree.nodes.size(), narrowed.data(), narrowed.size());
+            CHECK(diff.IsEmpty());
+            CHECK(tree.compactToLeaf == wide.compactToLeaf);
+            CHECK(std::equal(tree.clusterRoots, tree.clusterRoots + LightTree::CLUSTER_COUNT, wide.clusterRoots));
+
+            // The root sums every leaf's intensity.
+            double sum = 0.0;
+            for (float value : random.irradiance)
+                sum += value;
+            CHECK(std::abs(tree.nodes[0].intensity - sum) <= 1e-3 * sum);
+        }
+
+        // CompareLightTrees sees a changed link, flag and bound.
+        const RandomInput random(500, 64, 9);
+        const LightTree tree = BuildLightTree(random.Get(), grid);
+        std::vector<LightTreeNode> changed = tree.nodes;
+        changed[7].flag ^= 1u;
+        changed[11].leftIndex ^= 1u;
+        changed[600].aabbMax[1] += 1u << 16;
+        changed[3].intensity *= 1.0001f;
+        LightTreeDiff diff = CompareLightTrees(tree.nodes.data(), tree.nodes.size(), changed.data(), changed.size());
+        CHECK(diff.flagMismatches == 1 && diff.linkMismatches == 1 && diff.boundsMismatches == 1 && diff.intensityMismatches == 1);
+        CHECK(diff.firstMismatch == 3);
+        diff = CompareLightTrees(tree.nodes.data(), tree.nodes.size(), changed.data(), changed.size() - 2, 1e-3f);
+        CHECK(diff.nodeCountDelta == 2 && diff.intensityMismatches == 0 && diff.maxIntensityError > 0.0f);
+    }
+
+    // The 16-bit variant keeps the first LIGHT_TREE_MAX_LEAVES entries and
+    // flags the rest; the wide one takes them all.
+    void TestLeafCap()
+    {
+        constexpr uint32_t CAP = Constants::Graphics::LIGHT_TREE_MAX_LEAVES;
+        const VoxelGridConstants grid = MakeGrid(64);
+
+        const RandomInput exact(CAP, 64, 1);
+        const LightTree full = BuildLightTree(exact.Get(), grid);
+        CHECK(full.leafCount == CAP && !full.overflow && full.nodes.size() == 2 * size_t(CAP) - 1);
+
+        const RandomInput over(CAP + 100, 64, 2);
+        const LightTree clamped = BuildLightTree(over.Get(), grid);
+        CHECK(clamped.overflow && clamped.leafCount == CAP && clamped.stats.leafCount == CAP);
+        CHECK(clamped.nodes.size() == 2 * size_t(CAP) - 1 && clamped.compactToLeaf.size() == CAP + 100);
+        CHECK(std::all_of(clamped.compactToLeaf.begin(), clamped.compactToLeaf.begin() + CAP, [](int32_t leaf) { return leaf >= 0; }));
+        CHECK(std::all_of(clamped.compactToLeaf.begin() + CAP, clamped.compactToLeaf.end(), [](int32_t leaf) { return leaf == -1; }));
+
+        const LightTreeWide wide = BuildWideLightTree(over.Get(), grid);
+        CHECK(!wide.overflow && wide.leafCount == CAP + 100 && wide.nodes.size() == 2 * size_t(CAP + 100) - 1);
+        CHECK(std::all_of(wide.compactToLeaf.begin(), wide.compactToLeaf.end(), [](int32_t leaf) { return leaf >= 0; }));
+    }
+}
+
+int main()
+{
+    TestSmallTree();
+    TestWideMatches();
+    TestLeafCap();
+    return TestCheck::Result("LightTreeTests");
+}
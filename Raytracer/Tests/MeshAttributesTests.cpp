@@ -0,0 +1,279 @@
+#include "SceneResources/MeshAttributes.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <limits>
+#include <vector>
+
+#include "SceneResources/Wo3Mesh.h"
+#include "TestCheck.h"
+
+// mikktspace as published, next to the vendored copy the library runs.
+#define MIKKTSPACE_UPSTREAM_EDGE_SORT
+#define genTangSpace UpstreamGenTangSpace
+#define genTangSpaceDefault UpstreamGenTangSpaceDefault
+#include <mikktspace/mikktspace.h>
+#include <mikktspace/mikktspace.c>
+#undef genTangSpaceDefault
+#undef genTangSpace
+
+namespace
+{
+    namespace fs = std::filesystem;
+    using VertexPacking::FloatVertex;
+
+    struct Mesh
+    {
+        std::vector<FloatVertex> vertices;
+        std::vector<uint32_t> indices;
+    };
+
+    // What TungstenLoading hands to attribute generation: the .wo3 arrays
+    // without zero-area triangles (MeshUtils::DropDegenerateTriangles).
+    bool LoadMesh(const fs::path& path, Mesh& mesh)
+    {
+        Wo3Mesh::File file;
+        if (file.Open(path) != Wo3Mesh::Status::Ok)
+            return false;
+        mesh.vertices.resize(static_cast<size_t>(file.VertexCount()));
+        for (size_t i = 0; i < mesh.vertices.size(); ++i)
+        {
+            const Wo3Mesh::Vertex& s = file.Vertices()[i];
+            mesh.vertices[i] = { { s.px, s.py, s.pz }, { s.nx, s.ny, s.nz }, { 0.0f, 0.0f, 0.0f, 1.0f }, { s.u, s.v } };
+        }
+        std::vector<uint32_t> indices(static_cast<size_t>(file.TriangleCount()) * 3);
+        size_t badTriangle = 0;
+        if (!Wo3Mesh::CopyIndices(file, indices.data(), badTriangle))
+            return false;
+
+        mesh.indices.clear();
+        for (size_t i = 0; i + 2 < indices.size(); i += 3)
+        {
+            const float* p0 = mesh.vertices[indices[i]].position;
+            const float* p1 = mesh.vertices[indices[i + 1]].position;
+            const float* p2 = mesh.vertices[indices[i + 2]].position;
+            const float e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+            const float e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+            const float c[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+            if (c[0] * c[0] + c[1] * c[1] + c[2] * c[2] > 1e-20f)
+                mesh.indices.insert(mesh.indices.end(), { indices[i], indices[i + 1], indices[i + 2] });
+        }
+        return true;
+    }
+
+    size_t CountMismatches(const std::vector<FloatVertex>& a, const std::vector<FloatVertex>& b)
+    {
+        size_t mismatches = 0;
+        for (size_t i = 0; i < a.size(); ++i)
+            mismatches += std::memcmp(&a[i], &b[i], sizeof(FloatVertex)) != 0;
+        return mismatches;
+    }
+
+    // Batched tangents must equal one serial mikktspace pass whatever the batch size.
+    bool TangentsMatch(const Mesh& mesh, size_t batchTriangles, const char* name)
+    {
+        std::vector<FloatVertex> batched = mesh.vertices;
+        std::vector<FloatVertex> reference = mesh.vertices;
+        MeshAttributes::ComputeTangentsInBatches(batched.data(), batched.size(), mesh.indices.data(), mesh.indices.size(), batchTriangles);
+        MeshAttributes::ComputeTangentsReference(reference.data(), reference.size(), mesh.indices.data(), mesh.indices.size());
+        const size_t mismatches = CountMismatches(batched, reference);
+        if (mismatches != 0)
+            std::fprintf(stderr, "%s: %zu tangent mismatch(es) with %zu-triangle batches\n", name, mismatches, batchTriangles);
+        return mismatches == 0;
+    }
+
+    bool NormalsMatch(const Mesh& mesh, const char* name)
+    {
+        std::vector<FloatVertex> parallel = mesh.vertices;
+        std::vector<FloatVertex> reference = mesh.vertices;
+        MeshAttributes::ComputeNormals(parallel.data(), parallel.size(), mesh.indices.data(), mesh.indices.size());
+        MeshAttributes::ComputeNormalsReference(reference.data(), reference.size(), mesh.indices.data(), mesh.indices.size());
+        const size_t mismatches = CountMismatches(parallel, reference);
+        if (mismatches != 0)
+            std::fprintf(stderr, "%s: %zu normal mismatch(es)\n", name, mismatches);
+        return mismatches == 0;
+    }
+
+    FloatVertex& UpstreamCorner(const SMikkTSpaceContext* context, int face, int corner)
+    {
+        Mesh* mesh = static_cast<Mesh*>(context->m_pUserData);
+        return mesh->vertices[mesh->indices[static_cast<size_t>(face) * 3 + corner]];
+    }
+
+    void ComputeTangentsUpstream(Mesh& mesh)
+    {
+        SMikkTSpaceInterface iface = {};
+        iface.m_getNumFaces = [](const SMikkTSpaceContext* context) -> int
+        {
+            return static_cast<int>(static_cast<const Mesh*>(context->m_pUserData)->indices.size() / 3);
+        };
+        iface.m_getNumVerticesOfFace = [](const SMikkTSpaceContext*, const int) -> int
+        {
+            return 3;
+        };
+        iface.m_getPosition = [](const SMikkTSpaceContext* context, float out[], const int face, const int corner)
+        {
+            std::memcpy(out, UpstreamCorner(context, face, corner).position, 3 * sizeof(float));
+        };
+        iface.m_getNormal = [](const SMikkTSpaceContext* context, float out[], const int face, const int corner)
+        {
+            std::memcpy(out, UpstreamCorner(context, face, corner).normal, 3 * sizeof(float));
+        };
+        iface.m_getTexCoord = [](const SMikkTSpaceContext* context, float out[], const int face, const int corner)
+        {
+            std::memcpy(out, UpstreamCorner(context, face, corner).uv, 2 * sizeof(float));
+        };
+        iface.m_setTSpaceBasic = [](const SMikkTSpaceContext* context, const float tangent[], const float sign, const int face, const int corner)
+        {
+            FloatVertex& v = UpstreamCorner(context, face, corner);
+            std::memcpy(v.tangent, tangent, 3 * sizeof(float));
+            v.tangent[3] = sign;
+        };
+        SMikkTSpaceContext context = { &iface, &mesh };
+        UpstreamGenTangSpaceDefault(&context);
+    }
+
+    // The vendored change only sorts the last edge run, which upstream leaves
+    // unsorted. Appending a triangle that welds with nothing gives upstream a
+    // harmless last run of its own, so on the real vertices upstream must then
+    // agree bit for bit with the vendored copy on the unchanged mesh.
+    // `changed` counts the vertices where plain upstream differs.
+    bool MatchesUpstream(const Mesh& mesh, const char* name, size_t& changed)
+    {
+        std::vector<FloatVertex> reference = mesh.vertices;
+        MeshAttributes::ComputeTangentsReference(reference.data(), reference.size(), mesh.indices.data(), mesh.indices.size());
+
+        Mesh upstream = mesh;
+        ComputeTangentsUpstream(upstream);
+        changed = CountMismatches(reference, upstream.vertices);
+
+        Mesh padded = mesh;
+        const uint32_t base = static_cast<uint32_t>(padded.vertices.size());
+        for (uint32_t c = 0; c < 3; ++c)
+        {
+            // The first triangle's positions keep the weld's bounding box; the uvs are unique.
+            FloatVertex corner = mesh.vertices[mesh.indices[c]];
+            corner.uv[0] = -1000.0f - static_cast<float>(c == 1);
+            corner.uv[1] = -1000.0f - static_cast<float>(c == 2);
+            padded.vertices.push_back(corner);
+        }
+        padded.indices.insert(padded.indices.end(), { base, base + 1, base + 2 });
+        ComputeTangentsUpstream(padded);
+        padded.vertices.resize(mesh.vertices.size());
+
+        const size_t mismatches = CountMismatches(reference, padded.vertices);
+        if (mismatches != 0)
+            std::fprintf(stderr, "%s: %zu tangent mismatch(es) against upstream with its last run sorted\n", name, mismatches);
+        return mismatches == 0;
+    }
+
+    // A strip of quads, each quad its own island (unshared corners), then a
+    // butterfly (three triangles on one edge) as the last island.
+    Mesh MakeStripWithButterfly(size_t quads)
+    {
+        Mesh mesh;
+        for (size_t q = 0; q < quads; ++q)
+        {
+            const float x = static_cast<float>(q);
+            const uint32_t base = static_cast<uint32_t>(mesh.vertices.size());
+            for (int c = 0; c < 4; ++c)
+            {
+                const float u = (c & 1) ? 1.0f : 0.0f;
+                const float v = (c & 2) ? 1.0f : 0.0f;
+                mesh.vertices.push_back({ { x + u, v, 0.1f * u * v }, { 0.0f, 0.0f, 1.0f }, { 0.0f, 0.0f, 0.0f, 1.0f }, { u * 0.5f + x * 0.01f, v } });
+            }
+            mesh.indices.insert(mesh.indices.end(), { base, base + 1, base + 2, base + 2, base + 1, base + 3 });
+        }
+
+        const uint32_t base = static_cast<uint32_t>(mesh.vertices.size());
+        const float wings[3][3] = { { 0.5f, 1.0f, 0.0f }, { 0.5f, -1.0f, 0.2f }, { 0.5f, 0.0f, 1.0f } };
+        mesh.vertices.push_back({ { 0.0f, 0.0f, -5.0f }, { 0.0f, 0.0f, 1.0f }, { 0.0f, 0.0f, 0.0f, 1.0f }, { 0.0f, 0.0f } });
+        mesh.vertices.push_back({ { 1.0f, 0.0f, -5.0f }, { 0.0f, 0.0f, 1.0f }, { 0.0f, 0.0f, 0.0f, 1.0f }, { 1.0f, 0.0f } });
+        for (int w = 0; w < 3; ++w)
+        {
+            mesh.vertices.push_back({ { wings[w][0], wings[w][1], wings[w][2] - 5.0f }, { 0.0f, 0.0f, 1.0f }, { 0.0f, 0.0f, 0.0f, 1.0f }, { 0.5f, 1.0f } });
+            if (w == 1)
+                mesh.indices.insert(mesh.indices.end(), { base + 1, base, base + 2 + w });
+            else
+                mesh.indices.insert(mesh.indices.end(), { base, base + 1, base + 2 + w });
+        }
+        return mesh;
+    }
+
+    void TestSynthetic()
+    {
+        const Mesh strip = MakeStripWithButterfly(200);
+        for (size_t batch : { size_t(1), size_t(2), size_t(7), size_t(64), size_t(1000) })
+            CHECK(TangentsMatch(strip, batch, "strip"));
+        CHECK(NormalsMatch(strip, "strip"));
+        size_t changed = 0;
+        CHECK(MatchesUpstream(strip, "strip", changed));
+
+        // Non-finite positions take the serial path.
+        Mesh broken = strip;
+        broken.vertices[10].position[0] = std::numeric_limits<float>::infinity();
+        broken.vertices[20].position[1] = std::numeric_limits<float>::quiet_NaN();
+        std::vector<FloatVertex> batched = broken.vertices;
+        std::vector<FloatVertex> reference = broken.vertices;
+        MeshAttributes::ComputeTangentsInBatches(batched.data(), batched.size(), broken.indices.data(), broken.indices.size(), 4);
+        MeshAttributes::ComputeTangentsReference(reference.data(), reference.size(), broken.indices.data(), broken.indices.size());
+        CHECK(CountMismatches(batched, reference) == 0);
+    }
+
+    // Every Tungsten mesh, at a batch size that splits even small meshes.
+    void TestTungstenMeshes()
+    {
+        const fs::path root = fs::path(RAYTRACER_RESOURCE_DIR) / "Models" / "Tungsten";
+        std::error_code error;
+        if (!fs::is_directory(root, error))
+        {
+            std::printf("MeshAttributesTests: no meshes under '%s', skipped\n", root.string().c_str());
+            return;
+        }
+
+        std::vector<fs::path> files;
+        for (const fs::directory_entry& scene : fs::directory_iterator(root))
+        {
+            const fs::path models = scene.path() / "models";
+            if (!fs::is_directory(models, error))
+                continue;
+            for (const fs::directory_entry& entry : fs::directory_iterator(models))
+                if (entry.path().extension() == ".wo3")
+                    files.push_back(entry.path());
+        }
+        std::sort(files.begin(), files.end());
+
+        size_t checked = 0;
+        size_t changedMeshes = 0;
+        size_t changedVertices = 0;
+        Mesh mesh;
+        for (const fs::path& path : files)
+        {
+            if (!LoadMesh(path, mesh) || mesh.indices.empty())
+                continue;
+            const std::string name = path.parent_path().parent_path().filename().string() + "/" + path.filename().string();
+            const size_t triangles = mesh.indices.size() / 3;
+            CHECK(TangentsMatch(mesh, std::max<size_t>(1, triangles / 8), name.c_str()));
+            CHECK(NormalsMatch(mesh, name.c_str()));
+            size_t changed = 0;
+            CHECK(MatchesUpstream(mesh, name.c_str(), changed));
+            changedMeshes += changed != 0;
+            changedVertices += changed;
+            ++checked;
+        }
+        std::printf("MeshAttributesTests: %zu Tungsten mesh(es) checked; the vendored mikktspace changes %zu vertex tangent(s) in %zu of them\n",
+            checked, changedVertices, changedMeshes);
+        CHECK(checked > 0);
+    }
+}
+
+int main()
+{
+    TestSynthetic();
+    TestTungstenMeshes();
+    return TestCheck::Result("MeshAttributesTests");
+}
@@ -0,0 +1,132 @@
+#include "Utils/RadixSort.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "TestCheck.h"
+
+namespace
+{
+    // Distributions that exercise the pass skipping and the per-thread
+    // histograms differently.
+    enum class Keys
+    {
+        Random,
+        LightTree,  // 6 cluster bits, 30 Morton bits, 28-bit index
+        LowBits,    // everything above bit 16 constant
+        FewValues,  // long runs of equal keys
+        WithNull,   // NULL_KEY mixed in
+        Count,
+    };
+
+    uint64_t MakeKey(Keys kind, std::mt19937_64& rng, size_t index)
+    {
+        switch (kind)
+        {
+        case Keys::LightTree: return (rng() % 33) << 58 | (rng() & 0x3fffffffull) << 28 | (index & 0xfffffffull);
+        case Keys::LowBits:   return 0xabcd000000000000ull | (rng() & 0xffff);
+        case Keys::FewValues: return rng() % 5 * 0x0101010101010101ull;
+        case Keys::WithNull:  return rng() % 8 == 0 ? RadixSort::NULL_KEY : rng();
+        default:              return rng();
+        }
+    }
+
+    // Random sizes, mostly small, some past the per-thread chunking; both
+    // digit widths, keys alone and with values, against std::stable_sort.
+    void FuzzSort(uint64_t seed)
+    {
+        std::mt19937_64 rng(seed);
+        for (int round = 0; round < 12; ++round)
+        {
+            const size_t count = rng() % 4 == 0 ? rng() % 300000 : rng() % 2000;
+            const Keys kind = static_cast<Keys>(rng() % static_cast<uint64_t>(Keys::Count));
+            std::vector<uint64_t> keys(count);
+            for (size_t i = 0; i < count; ++i)
+                keys[i] = MakeKey(kind, rng, i);
+
+            std::vector<std::pair<uint64_t, uint32_t>> expected(count);
+            for (size_t i = 0; i < count; ++i)
+                expected[i] = { keys[i], static_cast<uint32_t>(i) };
+            std::stable_sort(expected.begin(), expected.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+
+            RadixSort::Settings settings;
+            settings.digitBits = rng() % 2 == 0 ? 8 : 11;
+
+            std::vector<uint64_t> sortedKeys = keys;
+            RadixSort::Sort(sortedKeys.data(), count, settings);
+            bool same = true;
+            for (size_t i = 0; i < count; ++i)
+                same &= sortedKeys[i] == expected[i].first;
+            CHECK(same);
+
+            std::vector<uint32_t> values(count);
+            for (size_t i = 0; i < count; ++i)
+                values[i] = static_cast<uint32_t>(i);
+            RadixSort::Sort(keys.data(), values.data(), count, settings);
+            same = true;
+            for (size_t i = 0; i < count; ++i)
+                same &= keys[i] == expected[i].first && values[i] == expected[i].second;
+            CHECK(same);
+        }
+    }
+
+    // The bitonic reference and the padded form BitonicSortPass works on.
+    void FuzzBitonic(uint64_t seed)
+    {
+        std::mt19937_64 rng(seed);
+        for (int round = 0; round < 6; ++round)
+        {
+            const size_t count = rng() % 5000;
+            const size_t capacity = count + rng() % 100;
+            std::vector<uint64_t> keys(capacity, 123);
+            for (size_t i = 0; i < count; ++i)
+                keys[i] = rng() >> (rng() % 40);
+            std::vector<uint64_t> expected(keys.begin(), keys.begin() + static_cast<std::ptrdiff_t>(count));
+            std::sort(expected.begin(), expected.end());
+
+            std::vector<uint64_t> bitonic(keys.begin(), keys.begin() + static_cast<std::ptrdiff_t>(count));
+            RadixSort::BitonicSort(bitonic.data(), count);
+            CHECK(bitonic == expected);
+
+            RadixSort::SortPadded(keys.data(), count, capacity);
+            CHECK(std::equal(expected.begin(), expected.end(), keys.begin()));
+            CHECK(std::all_of(keys.begin() + static_cast<std::ptrdiff_t>(count), keys.end(), [](uint64_t key) { return key == RadixSort::NULL_KEY; }));
+        }
+    }
+
+    // Unique light-tree keys, as the light tree sorts them: both digit
+    // widths and the bitonic network give std::sort's order.
+    void TestLightTreeKeys()
+    {
+        std::mt19937_64 rng(3);
+        std::vector<uint64_t> keys(20000);
+        for (size_t i = 0; i < keys.size(); ++i)
+            keys[i] = MakeKey(Keys::LightTree, rng, i);
+        std::vector<uint64_t> expected = keys;
+        std::sort(expected.begin(), expected.end());
+
+        for (uint32_t digitBits : { 8u, 11u })
+        {
+            std::vector<uint64_t> sorted = keys;
+            RadixSort::Sort(sorted.data(), sorted.size(), RadixSort::Settings{ digitBits });
+            CHECK(sorted == expected);
+        }
+        std::vector<uint64_t> bitonic = keys;
+        RadixSort::BitonicSort(bitonic.data(), bitonic.size());
+        CHECK(bitonic == expected);
+    }
+}
+
+int main()
+{
+    for (uint64_t seed = 0; seed < 16; ++seed)
+    {
+        FuzzSort(seed);
+        FuzzBitonic(seed);
+    }
+    TestLightTreeKeys();
+    return TestCheck::Result("RadixSortTests");
+}
@@ -0,0 +1,206 @@
+#include "Techniques/ReferencePathTracer.h"
+
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "SceneResources/VertexPacking.h"
+#include "TestCheck.h"
+
+namespace
+{
+    namespace fs = std::filesystem;
+    using Vertex = VertexPacking::FloatVertex;
+
+    fs::path TempPath(const std::string& name)
+    {
+        return fs::temp_directory_path() / ("reference_test_" + name);
+    }
+
+    // A 10x10 floor under a point light, seen from above by the default camera
+    // pulled back and pitched down.
+    bool WriteFloorScene(const fs::path& path, bool withLight)
+    {
+        std::vector<Vertex> vertices(4);
+        const float corners[4][2] = { { -5.0f, -5.0f }, { 5.0f, -5.0f }, { 5.0f, 5.0f }, { -5.0f, 5.0f } };
+        for (size_t i = 0; i < 4; ++i)
+        {
+            Vertex vertex{};
+            vertex.position[0] = corners[i][0];
+            vertex.position[2] = corners[i][1];
+            vertex.normal[1] = 1.0f;
+            vertex.tangent[0] = 1.0f;
+            vertex.tangent[3] = 1.0f;
+            vertices[i] = vertex;
+        }
+        const std::vector<uint32_t> indices = { 0, 2, 1, 0, 3, 2 };
+
+        SceneCacheFormat::BakeInput input;
+        input.name = "resources/models/Floor/floor.gltf";
+        input.vertexStride = sizeof(Vertex);
+        input.vertices = vertices.data();
+        input.vertexCount = vertices.size();
+        input.indices = indices.data();
+        input.indexCount = indices.size();
+
+        SceneCacheFormat::PrimitiveRecord primitive{};
+        primitive.vertexCount = 4;
+        primitive.indexCount = 6;
+        primitive.aabbMin[0] = primitive.aabbMin[2] = -5.0f;
+        primitive.aabbMax[0] = primitive.aabbMax[2] = 5.0f;
+        input.primitives.push_back(primitive);
+        input.models.push_back({ 0, 1 });
+        input.materials.push_back({ { 0.8f, 0.8f, 0.8f, 1.0f }, 0.0f, 0.5f, -1, -1, -1, 1 });
+        input.nodes.push_back({ -1, -1, { 0.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 0.0f, 1.0f }, { 1.0f, 1.0f, 1.0f } });
+        input.nodes.push_back({ 0, 0, { 0.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 0.0f, 1.0f }, { 1.0f, 1.0f, 1.0f } });
+        if (withLight)
+            input.lights.push_back({ 1, { 0.0f, 3.0f, 0.0f }, { 0.0f, -1.0f, 0.0f }, { 1.0f, 1.0f, 1.0f }, 20.0f, 0.0f });
+        return SceneCacheFormat::Write(path, input);
+    }
+
+    ReferenceCamera FloorCamera()
+    {
+        ReferenceCamera camera;
+        camera.position[1] = 4.0f;
+        camera.position[2] = -6.0f;
+        camera.rotation[0] = std::sin(0.3f);
+        camera.rotation[3] = std::cos(0.3f);
+        return camera;
+    }
+
+    void TestRender()
+    {
+        const fs::path path = TempPath("floor.bsc");
+        CHECK(WriteFloorScene(path, true));
+        {
+            SceneCacheFormat::Reader cache;
+            CHECK(cache.Open(path, sizeof(Vertex)));
+            ReferencePathTracer tracer;
+            CHECK(tracer.Load(cache));
+            CHECK(tracer.GetLights().size() == 1);
+
+            ReferencePathTracer::Settings settings;
+            settings.width = 48;
+            settings.height = 27;
+            settings.samplesPerPixel = 2;
+            settings.bounces = 2;
+            settings.frames = 2;
+            std::vector<float> first;
+            std::vector<float> second;
+            const ReferencePathTracer::Stats stats = tracer.Render(FloorCamera(), settings, first);
+            tracer.Render(FloorCamera(), settings, second);
+            CHECK(first.size() == 48 * 27 * 3);
+            CHECK(first == second);
+            CHECK(stats.pathSamples == 48 * 27 * 2 * 2);
+            CHECK(stats.closestHitRays >= stats.pathSamples && stats.shadowRays > 0);
+
+            double sum = 0.0;
+            bool finite = true;
+            for (float value : first)
+            {
+                finite &= std::isfinite(value) && value >= 0.0f;
+                sum += value;
+            }
+            CHECK(finite && sum > 0.0);
+
+            // Without lights or sky nothing is lit.
+            tracer.SetLights({});
+            tracer.Render(FloorCamera(), settings, first);
+            sum = 0.0;
+            for (float value : first)
+                sum += value;
+            CHECK(sum == 0.0);
+
+            // A constant sky lights the floor through the bounce.
+            ReferenceSky sky;
+            sky.width = 4;
+            sky.height = 2;
+            sky.rgba.assign(32, 0.5f);
+            tracer.SetSky(sky);
+            tracer.Render(FloorCamera(), settings, first);
+            sum = 0.0;
+            for (float value : first)
+                sum += value;
+            CHECK(sum > 0.0);
+        }
+        fs::remove(path);
+    }
+
+    void TestStates()
+    {
+        const fs::path path = TempPath("states.json");
+        {
+            std::ofstream out(path, std::ios::binary | std::ios::trunc);
+            out << R"({"floor":[{"name":"top","position":[1,2,3],"rotation":[0,0,0,1],"fov":0.9},)"
+                << R"({"name":"lit up","position":[0,1,0],"lights":[{"type":"spot","position":[0,5,0],"intensity":7}]}],)"
+                << R"("other":[{"name":"elsewhere"}]})";
+        }
+        const std::vector<std::string> names = ListReferenceStates(path, "floor");
+        CHECK(names == std::vector<std::string>({ "top", "lit up" }));
+        CHECK(ListReferenceStates(path, "missing").empty());
+        CHECK(ListReferenceStates(TempPath("absent.json"), "floor").empty());
+
+        ReferenceState state;
+        CHECK(LoadReferenceState(path, "floor", "top", state));
+        CHECK(state.camera.position[2] == 3.0f && std::abs(state.camera.fovYRadians - 0.9f) < 1e-6f && !state.hasLights);
+        CHECK(LoadReferenceState(path, "floor", "lit up", state));
+        CHECK(state.hasLights && state.lights.size() == 1 && state.lights[0].type == 2 && state.lights[0].intensity == 7.0f);
+        CHECK(!LoadReferenceState(path, "floor", "elsewhere", state));
+        fs::remove(path);
+    }
+
+    void TestSkyRoundTrip()
+    {
+        const fs::path path = TempPath("sky.pfm");
+        constexpr uint32_t WIDTH = 3;
+        constexpr uint32_t HEIGHT = 2;
+        std::vector<float> rgb(WIDTH * HEIGHT * 3);
+        for (size_t i = 0; i < rgb.size(); ++i)
+            rgb[i] = static_cast<float>(i) * 0.25f;
+        CHECK(ReferenceOutput::WritePfm(path, rgb.data(), WIDTH, HEIGHT));
+
+        ReferenceSky sky;
+        CHECK(LoadReferenceSky(path, sky));
+        CHECK(sky.width == WIDTH && sky.height == HEIGHT && sky.rgba.size() == WIDTH * HEIGHT * 4);
+        bool same = true;
+        for (size_t pixel = 0; pixel < WIDTH * HEIGHT; ++pixel)
+        {
+            for (size_t c = 0; c < 3; ++c)
+                same &= sky.rgba[pixel * 4 + c] == rgb[pixel * 3 + c];
+            same &= sky.rgba[pixel * 4 + 3] == 1.0f;
+        }
+        CHECK(same);
+
+        // Greyscale, truncated and non-PFM files.
+        {
+            std::ofstream out(path, std::ios::binary | std::ios::trunc);
+            const float value = 2.0f;
+            out << "Pf\n1 1\n-1.0\n";
+            out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+        }
+        CHECK(LoadReferenceSky(path, sky));
+        CHECK(sky.width == 1 && sky.rgba == std::vector<float>({ 2.0f, 2.0f, 2.0f, 1.0f }));
+        {
+            std::ofstream out(path, std::ios::binary | std::ios::trunc);
+            out << "PF\n4 4\n-1.0\n";
+        }
+        CHECK(!LoadReferenceSky(path, sky));
+        {
+            std::ofstream out(path, std::ios::binary | std::ios::trunc);
+            out << "P6\n1 1\n255\n";
+        }
+        CHECK(!LoadReferenceSky(path, sky));
+        fs::remove(path);
+    }
+}
+
+int main()
+{
+    TestRender();
+    TestStates();
+    TestSkyRoundTrip();
+    return TestCheck::Result("ReferencePathTracerTests");
+}
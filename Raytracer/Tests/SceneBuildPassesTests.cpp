@@ -0,0 +1,123 @@
+#include "SceneResources/SceneBuildPasses.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "TestCheck.h"
+
+namespace
+{
+    using namespace SceneBuildPasses;
+
+    // Rotation about an arbitrary axis, non-uniform scale, translation; row vectors.
+    Matrix RandomWorld(std::mt19937& rng)
+    {
+        std::uniform_real_distribution<float> u(-1.0f, 1.0f);
+        float axis[3] = { u(rng), u(rng), u(rng) };
+        const float length = std::sqrt(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]) + 1e-6f;
+        for (float& a : axis)
+            a /= length;
+        const float angle = u(rng) * 3.0f;
+        const float c = std::cos(angle), s = std::sin(angle), t = 1.0f - c;
+        const float x = axis[0], y = axis[1], z = axis[2];
+        const float rotation[3][3] = {
+            { t * x * x + c, t * x * y + s * z, t * x * z - s * y },
+            { t * x * y - s * z, t * y * y + c, t * y * z + s * x },
+            { t * x * z + s * y, t * y * z - s * x, t * z * z + c } };
+
+        Matrix world{};
+        for (int r = 0; r < 3; ++r)
+        {
+            const float scale = 0.5f + u(rng) * 0.25f;
+            for (int col = 0; col < 3; ++col)
+                world.m[r][col] = rotation[r][col] * scale;
+        }
+        world.m[3][0] = u(rng) * 10.0f;
+        world.m[3][1] = u(rng) * 10.0f;
+        world.m[3][2] = u(rng) * 10.0f;
+        world.m[3][3] = 1.0f;
+        return world;
+    }
+
+    // Bounds of the eight transformed corners, as the engine used to compute them.
+    void MergeCorners(Bounds& into, const Bounds& local, const Matrix& world)
+    {
+        for (int corner = 0; corner < 8; ++corner)
+        {
+            const float p[3] = {
+                corner & 1 ? local.max[0] : local.min[0],
+                corner & 2 ? local.max[1] : local.min[1],
+                corner & 4 ? local.max[2] : local.min[2] };
+            for (int c = 0; c < 3; ++c)
+            {
+                const float v = p[0] * world.m[0][c] + p[1] * world.m[1][c] + p[2] * world.m[2][c] + world.m[3][c];
+                into.min[c] = std::min(into.min[c], v);
+                into.max[c] = std::max(into.max[c], v);
+            }
+        }
+    }
+
+    void TestOffsets()
+    {
+        CHECK((InstanceOffsets({}) == std::vector<size_t>{ 0 }));
+        CHECK((InstanceOffsets({ 2, 0, 3, 1 }) == std::vector<size_t>{ 0, 2, 2, 5, 6 }));
+    }
+
+    void TestWorldBounds()
+    {
+        // Enough objects for several ThreadPool tasks; some own nothing, some
+        // own empty boxes.
+        std::mt19937 rng(5);
+        std::uniform_real_distribution<float> u(-1.0f, 1.0f);
+        constexpr size_t OBJECTS = 1000;
+        std::vector<uint32_t> counts(OBJECTS);
+        for (uint32_t& count : counts)
+            count = static_cast<uint32_t>(rng() % 4);
+        const std::vector<size_t> offsets = InstanceOffsets(counts);
+
+        std::vector<Matrix> worlds(OBJECTS);
+        for (Matrix& world : worlds)
+            world = RandomWorld(rng);
+        std::vector<Bounds> local(offsets.back());
+        for (size_t i = 0; i < local.size(); ++i)
+        {
+            if (i % 17 == 0)
+                continue; // empty
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                const float a = u(rng), b = u(rng);
+                local[i].min[axis] = std::min(a, b);
+                local[i].max[axis] = std::max(a, b);
+            }
+        }
+
+        Bounds expected;
+        for (size_t object = 0; object < OBJECTS; ++object)
+            for (size_t box = offsets[object]; box < offsets[object + 1]; ++box)
+                if (!local[box].IsEmpty())
+                    MergeCorners(expected, local[box], worlds[object]);
+
+        const Bounds actual = ComputeWorldBounds(worlds, offsets, local);
+        CHECK(!actual.IsEmpty());
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            CHECK(std::fabs(actual.min[axis] - expected.min[axis]) < 1e-4f);
+            CHECK(std::fabs(actual.max[axis] - expected.max[axis]) < 1e-4f);
+        }
+
+        // Nothing but empty boxes.
+        const std::vector<Bounds> empty(offsets.back());
+        CHECK(ComputeWorldBounds(worlds, offsets, empty).IsEmpty());
+        CHECK(ComputeWorldBounds({}, InstanceOffsets({}), {}).IsEmpty());
+    }
+}
+
+int main()
+{
+    TestOffsets();
+    TestWorldBounds();
+    return TestCheck::Result("SceneBuildPassesTests");
+}
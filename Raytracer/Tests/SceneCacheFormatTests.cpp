@@ -0,0 +1,183 @@
+#include "SceneResources/SceneCacheFormat.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "TestCheck.h"
+
+namespace
+{
+    namespace fs = std::filesystem;
+    using namespace SceneCacheFormat;
+
+    constexpr uint32_t STRIDE = 48;
+
+    struct Scene
+    {
+        std::vector<float> vertices;
+        std::vector<uint32_t> indices;
+        BakeInput input;
+    };
+
+    // One quad: a model with one primitive under a root node, one textured material.
+    Scene MakeScene()
+    {
+        Scene scene;
+        scene.vertices.resize(4 * STRIDE / sizeof(float));
+        for (size_t i = 0; i < scene.vertices.size(); ++i)
+            scene.vertices[i] = static_cast<float>(i) * 0.5f;
+        scene.indices = { 0, 1, 2, 2, 1, 3 };
+
+        BakeInput& input = scene.input;
+        input.sourceHash = 0x0123456789abcdefull;
+        input.pipelineVersion = 7;
+        input.importFlags = 0x5;
+        input.name = "quad.gltf";
+        input.vertexStride = STRIDE;
+        input.vertices = scene.vertices.data();
+        input.vertexCount = 4;
+        input.indices = scene.indices.data();
+        input.indexCount = scene.indices.size();
+
+        PrimitiveRecord primitive{};
+        primitive.vertexCount = 4;
+        primitive.indexCount = 6;
+        primitive.aabbMax[0] = primitive.aabbMax[1] = 1.0f;
+        primitive.materialIndex = 0;
+        input.primitives.push_back(primitive);
+        input.models.push_back({ 0, 1 });
+
+        MaterialRecord material{};
+        material.baseColorFactor[0] = 0.25f;
+        material.albedoTexture = 0;
+        material.normalTexture = -1;
+        material.metallicRoughnessTexture = -1;
+        material.isOpaque = 1;
+        input.materials.push_back(material);
+
+        NodeRecord root{};
+        root.parent = -1;
+        root.modelIndex = -1;
+        NodeRecord child{};
+        child.parent = 0;
+        child.modelIndex = 0;
+        child.position[1] = 2.0f;
+        input.nodes = { root, child };
+
+        LightRecord light{};
+        light.intensity = 3.0f;
+        input.lights.push_back(light);
+
+        BakeInput::Texture texture;
+        texture.width = 2;
+        texture.height = 2;
+        for (uint8_t i = 0; i < 16; ++i)
+            texture.rgba.push_back(i);
+        input.textures.push_back(texture);
+        input.dependencies.push_back({ "buffers/quad.bin", 42 });
+        return scene;
+    }
+
+    fs::path TempPath(const char* name)
+    {
+        return fs::temp_directory_path() / (std::string("scenecache_test_") + name + ".bsc");
+    }
+
+    std::vector<char> ReadBytes(const fs::path& path)
+    {
+        std::ifstream in(path, std::ios::binary);
+        return std::vector<char>(std::istreambuf_iterator<char>(in), {});
+    }
+
+    void WriteBytes(const fs::path& path, const std::vector<char>& bytes)
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    }
+
+    void TestRoundTrip()
+    {
+        const Scene scene = MakeScene();
+        const fs::path path = TempPath("roundtrip");
+        CHECK(Write(path, scene.input));
+        CHECK(!fs::exists(fs::path(path).concat(".tmp")));
+
+        Reader reader;
+        CHECK(reader.Open(path, STRIDE));
+        CHECK(reader.GetSourceHash() == scene.input.sourceHash);
+        CHECK(reader.GetPipelineVersion() == 7);
+        CHECK(reader.GetImportFlags() == 0x5);
+        CHECK(reader.GetName() == "quad.gltf");
+        CHECK(reader.GetVertexCount() == 4);
+        CHECK(std::memcmp(reader.GetVertexData(), scene.vertices.data(), 4 * STRIDE) == 0);
+        CHECK(reader.GetIndices().size() == 6 && reader.GetIndices()[5] == 3);
+        CHECK(reader.GetPrimitives().size() == 1 && reader.GetPrimitives()[0].aabbMax[1] == 1.0f);
+        CHECK(reader.GetModels().size() == 1 && reader.GetModels()[0].primitiveCount == 1);
+        CHECK(reader.GetMaterials().size() == 1 && reader.GetMaterials()[0].baseColorFactor[0] == 0.25f);
+        CHECK(reader.GetNodes().size() == 2 && reader.GetNodes()[1].position[1] == 2.0f);
+        CHECK(reader.GetLights().size() == 1 && reader.GetLights()[0].intensity == 3.0f);
+        CHECK(reader.GetTextures().size() == 1 && reader.GetTexels(reader.GetTextures()[0])[15] == 15);
+        CHECK(reader.GetDependencies().size() == 1 && reader.GetDependencies()[0].contentHash == 42);
+        CHECK(reader.GetDependencyPath(reader.GetDependencies()[0]) == "buffers/quad.bin");
+        reader.Close();
+        fs::remove(path);
+    }
+
+    void TestRejects()
+    {
+        const Scene scene = MakeScene();
+        const fs::path path = TempPath("rejects");
+        CHECK(Write(path, scene.input));
+        const std::vector<char> good = ReadBytes(path);
+
+        Reader reader;
+        CHECK(!reader.Open(path, STRIDE + 4));
+
+        // Another format version.
+        {
+            std::vector<char> bytes = good;
+            const uint32_t version = VERSION + 1;
+            std::memcpy(bytes.data() + offsetof(FileHeader, version), &version, sizeof(version));
+            WriteBytes(path, bytes);
+            CHECK(!reader.Open(path, STRIDE));
+        }
+
+        // Truncated anywhere past the header.
+        for (size_t cut : { size_t(0), sizeof(FileHeader) - 1, sizeof(FileHeader) + 8, good.size() - 1 })
+        {
+            WriteBytes(path, std::vector<char>(good.begin(), good.begin() + static_cast<std::ptrdiff_t>(cut)));
+            CHECK(!reader.Open(path, STRIDE));
+        }
+        fs::remove(path);
+
+        // Broken cross references are caught at open, not at use.
+        Scene badIndex = MakeScene();
+        badIndex.indices[4] = 4;
+        CHECK(Write(path, badIndex.input));
+        CHECK(!reader.Open(path, STRIDE));
+
+        Scene badTexture = MakeScene();
+        badTexture.input.materials[0].normalTexture = 1;
+        CHECK(Write(path, badTexture.input));
+        CHECK(!reader.Open(path, STRIDE));
+
+        Scene badParent = MakeScene();
+        badParent.input.nodes[1].parent = 1;
+        CHECK(Write(path, badParent.input));
+        CHECK(!reader.Open(path, STRIDE));
+        fs::remove(path);
+    }
+}
+
+int main()
+{
+    TestRoundTrip();
+    TestRejects();
+    return TestCheck::Result("SceneCacheFormatTests");
+}
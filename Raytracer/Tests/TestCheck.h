@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdio>
+
+// Minimal check for the ctest suites: unlike assert it survives NDEBUG,
+// reports every failure and lets main() return the failure count.
+namespace TestCheck
+{
+    inline int& Failures()
+    {
+        static int failures = 0;
+        return failures;
+    }
+
+    inline void Fail(const char* expression, const char* file, int line)
+    {
+        std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", file, line, expression);
+        ++Failures();
+    }
+
+    // Return value for main().
+    inline int Result(const char* suite)
+    {
+        if (Failures() != 0)
+            std::fprintf(stderr, "%s: %d check(s) failed\n", suite, Failures());
+        else
+            std::printf("%s: ok\n", suite);
+        return Failures() == 0 ? 0 : 1;
+    }
+}
+
+#define CHECK(expression) \
+    do { if (!(expression)) TestCheck::Fail(#expression, __FILE__, __LINE__); } while (false)
@@ -0,0 +1,149 @@
+#include "SceneResources/TextureDecoding.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+#include <tinygltf/stb_image_write.h> // implementation in tiny_gltf.cc
+
+#include "TestCheck.h"
+
+namespace
+{
+    using TextureDecoding::Image;
+
+    constexpr int WIDTH = 13;
+    constexpr int HEIGHT = 7;
+
+    std::vector<uint8_t> MakePixels(int components)
+    {
+        std::vector<uint8_t> pixels(static_cast<size_t>(WIDTH) * HEIGHT * components);
+        for (size_t i = 0; i < pixels.size(); ++i)
+            pixels[i] = static_cast<uint8_t>(i * 37 + 11);
+        return pixels;
+    }
+
+    // What any loader should hand the renderer for `components` 8-bit channels.
+    std::vector<uint8_t> ExpectedRgba(const std::vector<uint8_t>& pixels, int components)
+    {
+        std::vector<uint8_t> rgba;
+        for (size_t i = 0; i < pixels.size(); i += static_cast<size_t>(components))
+        {
+            const uint8_t* p = &pixels[i];
+            switch (components)
+            {
+            case 1: rgba.insert(rgba.end(), { p[0], p[0], p[0], 255 }); break;
+            case 2: rgba.insert(rgba.end(), { p[0], p[0], p[0], p[1] }); break;
+            case 3: rgba.insert(rgba.end(), { p[0], p[1], p[2], 255 }); break;
+            default: rgba.insert(rgba.end(), { p[0], p[1], p[2], p[3] }); break;
+            }
+        }
+        return rgba;
+    }
+
+    void Append(void* context, void* data, int size)
+    {
+        const auto* bytes = static_cast<const uint8_t*>(data);
+        static_cast<std::vector<uint8_t>*>(context)->insert(static_cast<std::vector<uint8_t>*>(context)->end(), bytes, bytes + size);
+    }
+
+    // PNG is lossless, so each component count must decode to exactly what
+    // ExpandToRgba8 makes of the raw pixels.
+    void TestPng()
+    {
+        for (int components = 1; components <= 4; ++components)
+        {
+            const std::vector<uint8_t> pixels = MakePixels(components);
+            const std::vector<uint8_t> expected = ExpectedRgba(pixels, components);
+
+            std::vector<uint8_t> expanded;
+            CHECK(TextureDecoding::ExpandToRgba8(pixels.data(), WIDTH, HEIGHT, components, expanded));
+            CHECK(expanded == expected);
+
+            std::vector<uint8_t> png;
+            CHECK(stbi_write_png_to_func(Append, &png, WIDTH, HEIGHT, components, pixels.data(), WIDTH * components) != 0);
+            Image image;
+            const char* error = nullptr;
+            CHECK(TextureDecoding::DecodeMemory(png.data(), png.size(), image, &error));
+            CHECK(image.IsValid() && image.width == WIDTH && image.height == HEIGHT);
+            CHECK(image.rgba == expected);
+        }
+
+        std::vector<uint8_t> out;
+        const std::vector<uint8_t> pixels = MakePixels(4);
+        CHECK(!TextureDecoding::ExpandToRgba8(pixels.data(), WIDTH, HEIGHT, 0, out));
+        CHECK(!TextureDecoding::ExpandToRgba8(pixels.data(), WIDTH, HEIGHT, 5, out));
+        CHECK(!TextureDecoding::ExpandToRgba8(pixels.data(), 0, HEIGHT, 4, out));
+    }
+
+    // JPEG is lossy: a smooth gradient at high quality stays within a few
+    // levels, and the missing alpha comes back opaque.
+    void TestJpeg()
+    {
+        constexpr int SIZE = 32;
+        std::vector<uint8_t> pixels(SIZE * SIZE * 3);
+        for (int y = 0; y < SIZE; ++y)
+        {
+            for (int x = 0; x < SIZE; ++x)
+            {
+                uint8_t* p = &pixels[(static_cast<size_t>(y) * SIZE + x) * 3];
+                p[0] = static_cast<uint8_t>(x * 8);
+                p[1] = static_cast<uint8_t>(y * 8);
+                p[2] = 128;
+            }
+        }
+        std::vector<uint8_t> jpeg;
+        CHECK(stbi_write_jpg_to_func(Append, &jpeg, SIZE, SIZE, 3, pixels.data(), 95) != 0);
+
+        Image image;
+        CHECK(TextureDecoding::DecodeMemory(jpeg.data(), jpeg.size(), image));
+        CHECK(image.width == SIZE && image.height == SIZE && image.rgba.size() == pixels.size() / 3 * 4);
+        int worst = 0;
+        bool opaque = true;
+        for (size_t i = 0; i < image.rgba.size() / 4; ++i)
+        {
+            for (size_t c = 0; c < 3; ++c)
+                worst = std::max(worst, std::abs(image.rgba[i * 4 + c] - pixels[i * 3 + c]));
+            opaque &= image.rgba[i * 4 + 3] == 255;
+        }
+        CHECK(worst <= 8);
+        CHECK(opaque);
+    }
+
+    void TestCorrupt()
+    {
+        std::vector<uint8_t> png;
+        const std::vector<uint8_t> pixels = MakePixels(3);
+        CHECK(stbi_write_png_to_func(Append, &png, WIDTH, HEIGHT, 3, pixels.data(), WIDTH * 3) != 0);
+
+        // Truncated: the header parses but the image data runs out.
+        Image image;
+        image.width = 1;
+        const char* error = nullptr;
+        CHECK(!TextureDecoding::DecodeMemory(png.data(), png.size() / 2, image, &error));
+        CHECK(error != nullptr && !image.IsValid() && image.width == 0 && image.rgba.empty());
+
+        // A damaged signature is not an image at all.
+        png[1] ^= 0xff;
+        error = nullptr;
+        CHECK(!TextureDecoding::DecodeMemory(png.data(), png.size(), image, &error));
+        CHECK(error != nullptr && !image.IsValid());
+
+        const uint8_t noise[64] = { 0x12, 0x34, 0x56 };
+        CHECK(!TextureDecoding::DecodeMemory(noise, sizeof(noise), image));
+        CHECK(!TextureDecoding::DecodeMemory(noise, 0, image));
+
+        error = nullptr;
+        CHECK(!TextureDecoding::DecodeFile("missing-texture.png", image, &error));
+        CHECK(error != nullptr && !image.IsValid());
+    }
+}
+
+int main()
+{
+    TestPng();
+    TestJpeg();
+    TestCorrupt();
+    return TestCheck::Result("TextureDecodingTests");
+}
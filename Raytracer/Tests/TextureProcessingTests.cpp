@@ -0,0 +1,218 @@
+#include "SceneResources/TextureProcessing.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "SceneResources/BlockCompression.h"
+#include "TestCheck.h"
+
+namespace
+{
+    using namespace TextureProcessing;
+
+    // Smooth gradients with a little noise; normal maps are a unit-length
+    // height-field derivative so BC5 sees realistic X/Y.
+    std::vector<uint8_t> MakeImage(int width, int height, TextureUsage usage, unsigned seed)
+    {
+        std::mt19937 rng(seed);
+        std::uniform_int_distribution<int> noise(-6, 6);
+        std::vector<uint8_t> image(static_cast<size_t>(width) * height * 4);
+        for (int y = 0; y < height; ++y)
+        {
+            for (int x = 0; x < width; ++x)
+            {
+                uint8_t* p = &image[(static_cast<size_t>(y) * width + x) * 4];
+                const float fx = static_cast<float>(x) / static_cast<float>(width);
+                const float fy = static_cast<float>(y) / static_cast<float>(height);
+                if (usage == TextureUsage::Normal)
+                {
+                    const float nx = -std::cos(fx * 20.0f) * 0.4f;
+                    const float ny = -std::sin(fy * 13.0f) * 0.4f;
+                    const float length = std::sqrt(nx * nx + ny * ny + 1.0f);
+                    p[0] = static_cast<uint8_t>(std::lround((nx / length * 0.5f + 0.5f) * 255.0f));
+                    p[1] = static_cast<uint8_t>(std::lround((ny / length * 0.5f + 0.5f) * 255.0f));
+                    p[2] = static_cast<uint8_t>(std::lround((1.0f / length * 0.5f + 0.5f) * 255.0f));
+                    p[3] = 255;
+                    continue;
+                }
+                for (int c = 0; c < 4; ++c)
+                {
+                    const float v = 0.5f + 0.4f * std::sin(fx * static_cast<float>(6 + c * 3) + fy * static_cast<float>(4 + c));
+                    p[c] = static_cast<uint8_t>(std::clamp(static_cast<int>(v * 255.0f) + noise(rng), 0, 255));
+                }
+            }
+        }
+        return image;
+    }
+
+    // The top levels of a 256x256 chain decode within the usage's PSNR floor.
+    void TestQuality()
+    {
+        struct Case
+        {
+            TextureUsage usage;
+            TextureFormat format;
+            double minPsnr;
+        };
+        const Case cases[] = {
+            { TextureUsage::Albedo, TextureFormat::BC7, 38.0 },
+            { TextureUsage::Normal, TextureFormat::BC5, 38.0 },
+            { TextureUsage::MetallicRoughness, TextureFormat::BC5, 44.0 },
+            { TextureUsage::Mask, TextureFormat::BC4, 36.0 },
+        };
+        constexpr int SIZE = 256;
+        for (const Case& c : cases)
+        {
+            const std::vector<uint8_t> image = MakeImage(SIZE, SIZE, c.usage, 1);
+            for (MipFilter filter : { MipFilter::Box, MipFilter::Kaiser })
+            {
+                const std::vector<Surface> mips = GenerateMips(image.data(), SIZE, SIZE, c.usage, filter);
+                const EncodedTexture encoded = Encode(image.data(), SIZE, SIZE, c.usage, filter);
+                CHECK(encoded.format == c.format);
+                CHECK(encoded.mips.size() == static_cast<size_t>(MipCount(SIZE, SIZE)));
+                CHECK(mips.size() == encoded.mips.size());
+
+                // From 64x64 down the noise has been filtered into texel-scale
+                // detail that no 4x4 endpoint pair holds at these floors;
+                // those levels are checked for size only.
+                std::vector<uint8_t> decoded;
+                for (size_t level = 0; level < encoded.mips.size(); ++level)
+                {
+                    DecodeLevel(encoded, level, decoded);
+                    const size_t texels = static_cast<size_t>(mips[level].width) * mips[level].height;
+                    CHECK(decoded.size() == texels * 4);
+                    if (mips[level].width < SIZE / 2)
+                        continue;
+                    const double psnr = ComputePsnr(mips[level].data.data(), decoded.data(), texels, SignificantChannels(c.usage));
+                    if (!(psnr > c.minPsnr))
+                        std::fprintf(stderr, "usage %u level %zu: %.2f dB\n", static_cast<unsigned>(c.usage), level, psnr);
+                    CHECK(psnr > c.minPsnr);
+                }
+            }
+        }
+    }
+
+    // Roughness and metallic vary independently, which BC1's one colour line
+    // per block cannot follow; BC5 gives each its own endpoints. Decoding
+    // applies the SRV swizzle, so both land back in G and B.
+    void TestMetallicRoughness()
+    {
+        constexpr int SIZE = 64;
+        std::vector<uint8_t> image(SIZE * SIZE * 4);
+        for (int y = 0; y < SIZE; ++y)
+        {
+            for (int x = 0; x < SIZE; ++x)
+            {
+                uint8_t* p = &image[(static_cast<size_t>(y) * SIZE + x) * 4];
+                p[0] = 255; // occlusion, unused
+                p[1] = static_cast<uint8_t>(x * 4);
+                p[2] = static_cast<uint8_t>((x / 4 + y / 4) % 2 == 0 ? 20 + y : 230 - y);
+                p[3] = 255;
+            }
+        }
+        const Surface level{ SIZE, SIZE, image };
+        const uint32_t channels = SignificantChannels(TextureUsage::MetallicRoughness);
+        CHECK(channels == 0x6);
+        CHECK(StoresMetallicRoughnessInRG(TextureUsage::MetallicRoughness, TextureFormat::BC5));
+        CHECK(!StoresMetallicRoughnessInRG(TextureUsage::Normal, TextureFormat::BC5));
+        CHECK(!StoresMetallicRoughnessInRG(TextureUsage::MetallicRoughness, TextureFormat::RGBA8));
+
+        double psnr[2] = {};
+        const TextureFormat formats[2] = { TextureFormat::BC5, TextureFormat::BC1 };
+        for (int f = 0; f < 2; ++f)
+        {
+            EncodedTexture encoded;
+            encoded.format = formats[f];
+            encoded.usage = TextureUsage::MetallicRoughness;
+            encoded.mips.push_back(EncodeLevel(level, formats[f], TextureUsage::MetallicRoughness));
+            std::vector<uint8_t> decoded;
+            DecodeLevel(encoded, 0, decoded);
+            psnr[f] = ComputePsnr(image.data(), decoded.data(), static_cast<size_t>(SIZE) * SIZE, channels);
+            if (f == 0)
+                CHECK(decoded[0] == 0 && decoded[3] == 255);
+        }
+        CHECK(psnr[0] > 48.0);
+        CHECK(psnr[0] > psnr[1] + 6.0);
+    }
+
+    void TestDds()
+    {
+        const std::vector<uint8_t> image = MakeImage(64, 32, TextureUsage::Albedo, 2);
+        const EncodedTexture encoded = Encode(image.data(), 64, 32, TextureUsage::Albedo, MipFilter::Kaiser);
+        const std::vector<uint8_t> dds = WriteDds(encoded);
+
+        EncodedTexture back;
+        CHECK(ReadDds(dds.data(), dds.size(), back));
+        CHECK(back.format == encoded.format && back.mips.size() == encoded.mips.size());
+        for (size_t level = 0; level < back.mips.size() && level < encoded.mips.size(); ++level)
+            CHECK(back.mips[level].data == encoded.mips[level].data);
+
+        for (size_t cut : { size_t(0), size_t(4), size_t(127), dds.size() - 1 })
+            CHECK(!ReadDds(dds.data(), cut, back));
+    }
+
+    void TestOddSizes()
+    {
+        // Not a multiple of 4: RGBA8, still a full chain.
+        std::vector<uint8_t> image = MakeImage(37, 19, TextureUsage::Albedo, 3);
+        EncodedTexture encoded = Encode(image.data(), 37, 19, TextureUsage::Albedo, MipFilter::Kaiser);
+        CHECK(encoded.format == TextureFormat::RGBA8);
+        CHECK(encoded.mips.size() == 6);
+        CHECK(encoded.mips.back().width == 1 && encoded.mips.back().height == 1);
+
+        // Block compressed top level whose lower levels are not multiples of 4.
+        image = MakeImage(12, 4, TextureUsage::Normal, 4);
+        encoded = Encode(image.data(), 12, 4, TextureUsage::Normal, MipFilter::Box);
+        CHECK(encoded.format == TextureFormat::BC5 && encoded.mips.size() == 4);
+        const std::vector<uint8_t> dds = WriteDds(encoded);
+        EncodedTexture back;
+        CHECK(ReadDds(dds.data(), dds.size(), back));
+    }
+
+    // A solid block round-trips within endpoint quantization.
+    void TestSolidBlocks()
+    {
+        using BlockCompression::BlockFormat;
+        const uint8_t color[4] = { 200, 16, 88, 255 };
+        uint8_t texels[64];
+        for (int i = 0; i < 64; ++i)
+            texels[i] = color[i % 4];
+
+        struct Case
+        {
+            BlockFormat format;
+            int channels;
+            int tolerance;
+        };
+        const Case cases[] = {
+            { BlockFormat::BC1, 3, 4 },
+            { BlockFormat::BC4, 1, 0 },
+            { BlockFormat::BC5, 2, 0 },
+            { BlockFormat::BC7, 4, 1 },
+        };
+        std::vector<uint8_t> decoded;
+        for (const Case& c : cases)
+        {
+            const std::vector<uint8_t> blocks = BlockCompression::Compress(texels, 4, 4, c.format);
+            CHECK(blocks.size() == BlockCompression::BlockBytes(c.format));
+            BlockCompression::Decompress(blocks.data(), 4, 4, c.format, decoded);
+            for (int i = 0; i < 64; ++i)
+                if (i % 4 < c.channels)
+                    CHECK(std::abs(decoded[i] - texels[i]) <= c.tolerance);
+        }
+    }
+}
+
+int main()
+{
+    TestQuality();
+    TestMetallicRoughness();
+    TestDds();
+    TestOddSizes();
+    TestSolidBlocks();
+    return TestCheck::Result("TextureProcessingTests");
+}
@@ -0,0 +1,212 @@
+#include "Resources/TlsfAllocator.h"
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "Resources/HeapSuballocator.h"
+#include "TestCheck.h"
+
+namespace
+{
+    // Random allocate/free/untouched traffic checked against a shadow map of
+    // live ranges; the allocator's own Validate runs every few hundred ops.
+    void FuzzTlsf(uint64_t seed)
+    {
+        std::mt19937_64 rng(seed);
+        TlsfAllocator allocator(64ull << 20);
+        std::vector<TlsfAllocator::Allocation> live;
+        std::map<uint64_t, uint64_t> ranges;
+
+        auto track = [&](const TlsfAllocator::Allocation& allocation, uint64_t size, uint64_t alignment)
+        {
+            CHECK(allocation.offset % alignment == 0);
+            CHECK(allocation.size >= size && allocation.size % TlsfAllocator::GRANULARITY == 0);
+            CHECK(allocation.offset + allocation.size <= allocator.GetCapacity());
+            auto next = ranges.lower_bound(allocation.offset);
+            if (next != ranges.end())
+                CHECK(next->first >= allocation.offset + allocation.size);
+            if (next != ranges.begin())
+            {
+                auto previous = std::prev(next);
+                CHECK(previous->first + previous->second <= allocation.offset);
+            }
+            ranges[allocation.offset] = allocation.size;
+            live.push_back(allocation);
+        };
+
+        for (int op = 0; op < 20000; ++op)
+        {
+            if (live.empty() || rng() % 3 != 0)
+            {
+                const uint64_t size = rng() % 4 == 0 ? rng() % (4 << 20) : rng() % 65536 + 1;
+                const uint64_t alignment = 1ull << (8 + rng() % 15);
+                const TlsfAllocator::Allocation allocation = allocator.Allocate(size, alignment);
+                if (allocation.IsValid())
+                    track(allocation, size, alignment);
+            }
+            else
+            {
+                const size_t index = rng() % live.size();
+                allocator.Free(live[index].block);
+                ranges.erase(live[index].offset);
+                live[index] = live.back();
+                live.pop_back();
+            }
+
+            if (op % 5 == 0)
+            {
+                const uint64_t highWater = allocator.GetHighWater();
+                const uint64_t size = rng() % 65536 + 1;
+                const uint64_t alignment = 1ull << (8 + rng() % 9);
+                const TlsfAllocator::Allocation untouched = allocator.AllocateUntouched(size, alignment);
+                if (untouched.IsValid())
+                {
+                    CHECK(untouched.offset >= highWater);
+                    track(untouched, size, alignment);
+                }
+            }
+            if (op % 331 == 0)
+                CHECK(allocator.Validate());
+        }
+
+        for (const TlsfAllocator::Allocation& allocation : live)
+            allocator.Free(allocation.block);
+        CHECK(allocator.Validate());
+        const TlsfAllocator::Stats stats = allocator.GetStats();
+        CHECK(allocator.IsEmpty() && stats.usedBytes == 0);
+        CHECK(stats.freeBlockCount == 1 && stats.largestFreeBlock == allocator.GetCapacity());
+    }
+
+    void TestEdges()
+    {
+        // An exact fit, including the whole range at its own alignment.
+        {
+            TlsfAllocator allocator(1 << 20);
+            const TlsfAllocator::Allocation all = allocator.Allocate(1 << 20);
+            CHECK(all.IsValid() && all.offset == 0);
+            CHECK(!allocator.Allocate(TlsfAllocator::GRANULARITY).IsValid());
+            allocator.Free(all.block);
+            CHECK(allocator.Allocate(1 << 20, 1 << 20).IsValid());
+            CHECK(!allocator.Allocate((1 << 20) + 1).IsValid());
+        }
+
+        // Untouched memory stays above the high water mark even after frees.
+        {
+            TlsfAllocator allocator(1 << 20);
+            const TlsfAllocator::Allocation a = allocator.AllocateUntouched(1000, 4096);
+            const TlsfAllocator::Allocation b = allocator.AllocateUntouched(5000, 65536);
+            CHECK(a.offset == 0 && b.offset == 65536);
+            allocator.Free(a.block);
+            const TlsfAllocator::Allocation c = allocator.AllocateUntouched(256);
+            CHECK(c.offset >= b.offset + b.size);
+            const TlsfAllocator::Allocation d = allocator.Allocate(256);
+            CHECK(d.offset == 0);
+            CHECK(allocator.Validate());
+            allocator.Free(b.block);
+            allocator.Free(c.block);
+            allocator.Free(d.block);
+            CHECK(allocator.Validate());
+            CHECK(!allocator.AllocateUntouched(1 << 20).IsValid());
+        }
+    }
+
+    class CountingBacking : public HeapBacking
+    {
+    public:
+        explicit CountingBacking(std::shared_ptr<std::map<uint32_t, uint64_t>> live) : m_live(std::move(live)) {}
+
+        bool CreateHeap(uint32_t heap, uint64_t bytes) override
+        {
+            CHECK(m_live->count(heap) == 0);
+            (*m_live)[heap] = bytes;
+            return true;
+        }
+
+        void DestroyHeap(uint32_t heap) override
+        {
+            CHECK(m_live->erase(heap) == 1);
+        }
+
+    private:
+        std::shared_ptr<std::map<uint32_t, uint64_t>> m_live;
+    };
+
+    void TestSuballocator()
+    {
+        auto heaps = std::make_shared<std::map<uint32_t, uint64_t>>();
+        constexpr uint64_t HEAP_SIZE = 64ull << 20;
+        HeapSuballocator suballocator(std::make_unique<CountingBacking>(heaps), HEAP_SIZE);
+        const char* tags[] = { "VoxelizationPass", "Textures", "Scene" };
+
+        // Four threads of mixed traffic.
+        std::vector<std::vector<HeapSuballocator::Allocation>> live(4);
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < live.size(); ++t)
+        {
+            threads.emplace_back([&, t]
+            {
+                std::mt19937_64 rng(t + 1);
+                for (int op = 0; op < 3000; ++op)
+                {
+                    if (live[t].empty() || rng() % 4 != 0)
+                    {
+                        const HeapSuballocator::Allocation allocation = suballocator.Allocate(rng() % (1 << 20) + 1, 65536, tags[op % 3]);
+                        CHECK(allocation.IsValid() && allocation.offset % 65536 == 0);
+                        live[t].push_back(allocation);
+                    }
+                    else
+                    {
+                        const size_t index = rng() % live[t].size();
+                        suballocator.Free(live[t][index]);
+                        live[t][index] = live[t].back();
+                        live[t].pop_back();
+                    }
+                }
+            });
+        }
+        for (std::thread& thread : threads)
+            thread.join();
+
+        // No two live allocations share bytes of a heap.
+        std::map<std::pair<uint32_t, uint64_t>, uint64_t> ranges;
+        for (const auto& allocations : live)
+            for (const HeapSuballocator::Allocation& allocation : allocations)
+                ranges[{ allocation.heap, allocation.offset }] = allocation.size;
+        for (auto it = ranges.begin(); it != ranges.end(); ++it)
+        {
+            auto next = std::next(it);
+            if (next != ranges.end() && next->first.first == it->first.first)
+                CHECK(it->first.second + it->second <= next->first.second);
+            CHECK(it->first.second + it->second <= (*heaps)[it->first.first]);
+        }
+        for (const HeapSuballocator::HeapStats& stats : suballocator.GetHeapStats())
+            CHECK(stats.usage.capacity == (*heaps)[stats.heap]);
+
+        // Above half a heap: a dedicated heap, destroyed on free.
+        const size_t heapCount = heaps->size();
+        const HeapSuballocator::Allocation big = suballocator.Allocate(100ull << 20, 65536, "Scene");
+        CHECK(big.IsValid() && heaps->size() == heapCount + 1 && (*heaps)[big.heap] >= 100ull << 20);
+        suballocator.Free(big);
+        CHECK(heaps->size() == heapCount);
+
+        for (const auto& allocations : live)
+            for (const HeapSuballocator::Allocation& allocation : allocations)
+                suballocator.Free(allocation);
+        CHECK(heaps->size() == 1); // the spare
+        for (const HeapSuballocator::TagStats& tag : suballocator.GetTagStats())
+            CHECK(tag.bytes == 0 && tag.allocationCount == 0 && tag.peakBytes > 0);
+    }
+}
+
+int main()
+{
+    for (uint64_t seed = 1; seed <= 8; ++seed)
+        FuzzTlsf(seed);
+    TestEdges();
+    TestSuballocator();
+    return TestCheck::Result("TlsfAllocatorTests");
+}
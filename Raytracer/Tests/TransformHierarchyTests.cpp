@@ -0,0 +1,160 @@
+#include "SceneResources/TransformHierarchy.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "TestCheck.h"
+
+namespace
+{
+    using Matrix = TransformHierarchy::Matrix;
+    constexpr uint32_t NO_PARENT = TransformHierarchy::NO_PARENT;
+
+    struct Trs
+    {
+        float position[3];
+        float rotation[4];
+        float scale[3];
+    };
+
+    // S * R * T with row vectors, written out independently of the SoA path.
+    Matrix Local(const Trs& t)
+    {
+        const float x = t.rotation[0], y = t.rotation[1], z = t.rotation[2], w = t.rotation[3];
+        const float* s = t.scale;
+        return Matrix{ {
+            { s[0] * (1 - 2 * (y * y + z * z)), s[0] * 2 * (x * y + w * z), s[0] * 2 * (x * z - w * y), 0 },
+            { s[1] * 2 * (x * y - w * z), s[1] * (1 - 2 * (x * x + z * z)), s[1] * 2 * (y * z + w * x), 0 },
+            { s[2] * 2 * (x * z + w * y), s[2] * 2 * (y * z - w * x), s[2] * (1 - 2 * (x * x + y * y)), 0 },
+            { t.position[0], t.position[1], t.position[2], 1 } } };
+    }
+
+    Matrix Multiply(const Matrix& a, const Matrix& b)
+    {
+        Matrix out{};
+        for (int r = 0; r < 4; ++r)
+            for (int c = 0; c < 4; ++c)
+                for (int k = 0; k < 4; ++k)
+                    out.m[r][c] += a.m[r][k] * b.m[k][c];
+        return out;
+    }
+
+    // The per-node walk to the root that SceneNode used to do.
+    Matrix ReferenceWorld(const std::vector<uint32_t>& parents, const std::vector<Trs>& trs, uint32_t node)
+    {
+        const Matrix local = Local(trs[node]);
+        return parents[node] == NO_PARENT ? local : Multiply(local, ReferenceWorld(parents, trs, parents[node]));
+    }
+
+    Trs RandomTrs(std::mt19937& rng)
+    {
+        std::uniform_real_distribution<float> u(-1.0f, 1.0f);
+        Trs t;
+        float length = 0.0f;
+        for (int i = 0; i < 4; ++i)
+        {
+            t.rotation[i] = u(rng);
+            length += t.rotation[i] * t.rotation[i];
+        }
+        length = std::sqrt(length);
+        for (int i = 0; i < 4; ++i)
+            t.rotation[i] /= length;
+        for (int i = 0; i < 3; ++i)
+        {
+            t.position[i] = u(rng);
+            t.scale[i] = 0.9f + 0.1f * u(rng);
+        }
+        return t;
+    }
+
+    void CheckWorlds(const TransformHierarchy& hierarchy, const std::vector<uint32_t>& parents, const std::vector<Trs>& trs)
+    {
+        float maxError = 0.0f;
+        for (uint32_t node = 0; node < parents.size(); ++node)
+        {
+            const Matrix expected = ReferenceWorld(parents, trs, node);
+            const Matrix& actual = hierarchy.GetWorld(node);
+            for (int r = 0; r < 4; ++r)
+                for (int c = 0; c < 4; ++c)
+                    maxError = std::max(maxError, std::fabs(expected.m[r][c] - actual.m[r][c]) / std::max(1.0f, std::fabs(expected.m[r][c])));
+        }
+        CHECK(maxError < 1e-4f);
+    }
+
+    bool IsDescendant(const std::vector<uint32_t>& parents, uint32_t node, uint32_t ancestor)
+    {
+        for (; node != NO_PARENT; node = parents[node])
+            if (node == ancestor)
+                return true;
+        return false;
+    }
+
+    void TestShape(const std::vector<uint32_t>& parents)
+    {
+        std::mt19937 rng(7);
+        std::vector<Trs> trs(parents.size());
+        for (Trs& t : trs)
+            t = RandomTrs(rng);
+
+        TransformHierarchy hierarchy;
+        hierarchy.Reserve(parents.size());
+        for (uint32_t node = 0; node < parents.size(); ++node)
+            CHECK(hierarchy.Add(parents[node], trs[node].position, trs[node].rotation, trs[node].scale) == node);
+        CHECK(hierarchy.Update() == parents.size());
+        CheckWorlds(hierarchy, parents, trs);
+        CHECK(hierarchy.Update() == 0);
+
+        // One edit recomputes exactly that node's subtree, in ascending order.
+        const uint32_t edited = static_cast<uint32_t>(parents.size() / 3);
+        const Trs change = RandomTrs(rng);
+        trs[edited].position[0] = change.position[0];
+        std::copy(change.rotation, change.rotation + 4, trs[edited].rotation);
+        std::copy(change.scale, change.scale + 3, trs[edited].scale);
+        hierarchy.SetPosition(edited, trs[edited].position);
+        hierarchy.SetRotation(edited, trs[edited].rotation);
+        hierarchy.SetScale(edited, trs[edited].scale);
+        CHECK(hierarchy.IsDirty(edited));
+
+        std::vector<uint32_t> changed;
+        const size_t recomputed = hierarchy.Update(&changed);
+        std::vector<uint32_t> expected;
+        for (uint32_t node = 0; node < parents.size(); ++node)
+            if (IsDescendant(parents, node, edited))
+                expected.push_back(node);
+        CHECK(recomputed == expected.size());
+        CHECK(changed == expected);
+        CHECK(!hierarchy.IsDirty(edited));
+        CheckWorlds(hierarchy, parents, trs);
+    }
+}
+
+int main()
+{
+    std::vector<uint32_t> deep(300);
+    deep[0] = NO_PARENT;
+    for (uint32_t i = 1; i < deep.size(); ++i)
+        deep[i] = i - 1;
+
+    std::vector<uint32_t> wide(2000);
+    wide[0] = NO_PARENT;
+    for (uint32_t i = 1; i < wide.size(); ++i)
+        wide[i] = 0;
+
+    std::mt19937 rng(3);
+    std::vector<uint32_t> random(2000);
+    random[0] = NO_PARENT;
+    for (uint32_t i = 1; i < random.size(); ++i)
+        random[i] = rng() % 4 == 0 ? NO_PARENT : static_cast<uint32_t>(rng() % i);
+
+    TestShape(deep);
+    TestShape(wide);
+    TestShape(random);
+
+    // Small counts exercise the scalar tail.
+    for (uint32_t count : { 1u, 2u, 3u, 5u, 7u })
+        TestShape(std::vector<uint32_t>(deep.begin(), deep.begin() + count));
+    return TestCheck::Result("TransformHierarchyTests");
+}
@@ -0,0 +1,187 @@
+#include "Resources/UploadScheduler.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "TestCheck.h"
+
+namespace
+{
+    using Buffer = std::vector<uint8_t>;
+
+    // Stands in for the GPU: a batch's copies read the staging ring only when
+    // the batch completes, so the scheduler overwriting staging memory that is
+    // still in flight shows up as wrong destination contents. Batches complete
+    // at random on fence polls and in order on waits.
+    class RecordingBackend : public UploadBackend
+    {
+    public:
+        explicit RecordingBackend(uint32_t seed) : m_rng(seed) {}
+
+        uint8_t* AllocateStagingRing(uint64_t bytes) override
+        {
+            m_ring.resize(static_cast<size_t>(bytes));
+            return m_ring.data();
+        }
+
+        uint64_t Submit(const std::vector<UploadCopy>& copies) override
+        {
+            m_queue.push_back({ ++m_submitted, copies });
+            batches.push_back(copies);
+            return m_submitted;
+        }
+
+        uint64_t GetCompletedFence() override
+        {
+            while (!m_queue.empty() && m_rng() % 3 == 0)
+                CompleteOldest();
+            return m_completed;
+        }
+
+        void WaitForFence(uint64_t value) override
+        {
+            while (m_completed < value && !m_queue.empty())
+                CompleteOldest();
+        }
+
+        std::vector<std::vector<UploadCopy>> batches;
+        bool outOfBounds = false;
+
+    private:
+        struct Batch
+        {
+            uint64_t fence;
+            std::vector<UploadCopy> copies;
+        };
+
+        void CompleteOldest()
+        {
+            for (const UploadCopy& copy : m_queue.front().copies)
+            {
+                Buffer& destination = *static_cast<Buffer*>(copy.destination);
+                if (copy.stagingOffset + copy.size > m_ring.size() || copy.destinationOffset + copy.size > destination.size())
+                {
+                    outOfBounds = true;
+                    continue;
+                }
+                std::memcpy(destination.data() + copy.destinationOffset, m_ring.data() + copy.stagingOffset, static_cast<size_t>(copy.size));
+            }
+            m_completed = m_queue.front().fence;
+            m_queue.pop_front();
+        }
+
+        std::mt19937 m_rng;
+        Buffer m_ring;
+        std::deque<Batch> m_queue;
+        uint64_t m_submitted = 0;
+        uint64_t m_completed = 0;
+    };
+
+    // Random uploads (some larger than the ring, some zero fills) into a few
+    // destinations, checked against a CPU mirror once everything has landed.
+    void FuzzUploads(uint32_t seed)
+    {
+        std::mt19937 rng(seed + 100);
+        auto backend = std::make_unique<RecordingBackend>(seed);
+        RecordingBackend& recorder = *backend;
+        // Not a multiple of the chunk granularity on purpose.
+        UploadScheduler scheduler(std::move(backend), 64 * 1024 + 77);
+        std::vector<Buffer> destinations(8);
+        std::vector<Buffer> expected(8);
+        for (size_t i = 0; i < destinations.size(); ++i)
+        {
+            destinations[i].assign(1 + rng() % 300000, 0xcd);
+            expected[i] = destinations[i];
+        }
+
+        Buffer data;
+        for (int op = 0; op < 1500; ++op)
+        {
+            const size_t target = rng() % destinations.size();
+            const size_t size = destinations[target].size();
+            const size_t offset = rng() % size;
+            const size_t limit = rng() % 4 == 0 ? 200000 : 3000;
+            const size_t length = 1 + rng() % std::min(size - offset, limit);
+            data.resize(length);
+            for (uint8_t& byte : data)
+                byte = static_cast<uint8_t>(rng());
+
+            const bool zeros = rng() % 20 == 0;
+            scheduler.Enqueue(&destinations[target], offset, zeros ? nullptr : data.data(), length);
+            if (zeros)
+                std::memset(expected[target].data() + offset, 0, length);
+            else
+                std::memcpy(expected[target].data() + offset, data.data(), length);
+
+            if (rng() % 10 == 0)
+                scheduler.Submit();
+            const UploadScheduler::Stats stats = scheduler.GetStats();
+            CHECK(stats.ringInUse <= stats.ringCapacity);
+        }
+
+        scheduler.WaitIdle();
+        for (size_t i = 0; i < destinations.size(); ++i)
+            CHECK(destinations[i] == expected[i]);
+        const UploadScheduler::Stats stats = scheduler.GetStats();
+        CHECK(stats.ringInUse == 0 && stats.pendingCopies == 0);
+        CHECK(stats.ringPeak <= stats.ringCapacity);
+        CHECK(stats.uploads == 1500);
+        CHECK(!recorder.outOfBounds);
+    }
+
+    void TestCoalescing()
+    {
+        auto backend = std::make_unique<RecordingBackend>(1);
+        RecordingBackend& recorder = *backend;
+        UploadScheduler scheduler(std::move(backend), 1 << 20);
+        CHECK(scheduler.Submit() == 0);
+
+        // A quarter of the ring or less is one copy.
+        Buffer source(200000, 7);
+        Buffer large(source.size());
+        scheduler.Enqueue(&large, 0, source.data(), source.size());
+        CHECK(scheduler.GetStats().pendingCopies == 1);
+
+        // Uploads continuing the previous one in both ring and destination merge.
+        Buffer row(1024);
+        for (uint64_t i = 0; i < 4; ++i)
+            scheduler.Enqueue(&row, i * 256, source.data(), 256);
+        CHECK(scheduler.GetStats().pendingCopies == 2);
+
+        // Small uploads to separate buffers stay separate, but share one submission.
+        std::vector<Buffer> small(100, Buffer(64));
+        for (Buffer& buffer : small)
+            scheduler.Enqueue(&buffer, 0, source.data(), buffer.size());
+        CHECK(scheduler.Submit() != 0);
+        UploadScheduler::Stats stats = scheduler.GetStats();
+        CHECK(stats.submissions == 1 && stats.copies == 102 && recorder.batches.size() == 1);
+        for (const UploadCopy& copy : recorder.batches[0])
+            CHECK(copy.stagingOffset % UploadScheduler::STAGING_ALIGNMENT == 0);
+
+        // Five times the ring streams through in chunks, stalling on the oldest batch.
+        Buffer hugeSource(5 << 20);
+        for (size_t i = 0; i < hugeSource.size(); ++i)
+            hugeSource[i] = static_cast<uint8_t>(i * 31);
+        Buffer huge(hugeSource.size());
+        scheduler.Enqueue(&huge, 0, hugeSource.data(), hugeSource.size());
+        scheduler.WaitIdle();
+        CHECK(huge == hugeSource);
+        CHECK(large == source && row == Buffer(1024, 7));
+        stats = scheduler.GetStats();
+        CHECK(stats.stalls > 0 && stats.ringPeak <= stats.ringCapacity);
+        CHECK(stats.bytes == source.size() + 4 * 256 + 100 * 64 + hugeSource.size());
+    }
+}
+
+int main()
+{
+    for (uint32_t seed = 0; seed < 24; ++seed)
+        FuzzUploads(seed);
+    TestCoalescing();
+    return TestCheck::Result("UploadSchedulerTests");
+}
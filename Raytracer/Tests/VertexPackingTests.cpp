@@ -0,0 +1,182 @@
+#include "SceneResources/VertexPacking.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "TestCheck.h"
+
+namespace
+{
+    using namespace VertexPacking;
+
+    // Truncating UNORM16 octahedral lanes keep unit vectors within these
+    // (radians); the 15-bit tangent x lane costs a little more.
+    constexpr double MAX_NORMAL_ANGLE = 1.5e-4;
+    constexpr double MAX_TANGENT_ANGLE = 2.5e-4;
+
+    // In double through atan2: float acos cannot resolve angles this small.
+    double Angle(const float a[3], const float b[3])
+    {
+        const double cross[3] = {
+            double(a[1]) * b[2] - double(a[2]) * b[1],
+            double(a[2]) * b[0] - double(a[0]) * b[2],
+            double(a[0]) * b[1] - double(a[1]) * b[0],
+        };
+        const double dot = double(a[0]) * b[0] + double(a[1]) * b[1] + double(a[2]) * b[2];
+        return std::atan2(std::sqrt(cross[0] * cross[0] + cross[1] * cross[1] + cross[2] * cross[2]), dot);
+    }
+
+    void RandomUnit(std::mt19937& rng, float out[3])
+    {
+        std::normal_distribution<float> gaussian;
+        float length = 0.0f;
+        while (!(length > 1e-3f))
+        {
+            for (int a = 0; a < 3; ++a)
+                out[a] = gaussian(rng);
+            length = std::sqrt(out[0] * out[0] + out[1] * out[1] + out[2] * out[2]);
+        }
+        for (int a = 0; a < 3; ++a)
+            out[a] /= length;
+    }
+
+    // Random directions plus the axes and the octahedron's fold lines, where
+    // the lower hemisphere wraps.
+    std::vector<std::vector<float>> TestDirections()
+    {
+        std::vector<std::vector<float>> directions = {
+            { 1, 0, 0 }, { -1, 0, 0 }, { 0, 1, 0 }, { 0, -1, 0 }, { 0, 0, 1 }, { 0, 0, -1 },
+            { 0.7071068f, 0.7071068f, 0 }, { -0.7071068f, 0, -0.7071068f }, { 0, 0.7071068f, -0.7071068f },
+            { 0.5773503f, -0.5773503f, -0.5773503f },
+        };
+        std::mt19937 rng(11);
+        for (int i = 0; i < 200000; ++i)
+        {
+            std::vector<float> direction(3);
+            RandomUnit(rng, direction.data());
+            directions.push_back(direction);
+        }
+        return directions;
+    }
+
+    void TestOctahedralError()
+    {
+        double normalError = 0.0;
+        double tangentError = 0.0;
+        size_t signFlips = 0;
+        size_t index = 0;
+        for (const std::vector<float>& direction : TestDirections())
+        {
+            float normal[3];
+            DecodeOctahedron(EncodeOctahedron(direction.data()), normal);
+            normalError = std::max(normalError, Angle(direction.data(), normal));
+
+            const float sign = index++ % 2 == 0 ? 1.0f : -1.0f;
+            float tangent[4];
+            DecodeTangent(EncodeTangent(direction.data(), sign), tangent);
+            tangentError = std::max(tangentError, Angle(direction.data(), tangent));
+            signFlips += tangent[3] != sign;
+        }
+        CHECK(normalError < MAX_NORMAL_ANGLE);
+        CHECK(tangentError < MAX_TANGENT_ANGLE);
+        CHECK(signFlips == 0);
+
+        // The sign bit stays out of the x lane: flipping it moves nothing else.
+        const float t[3] = { -0.3f, 0.9f, 0.3162278f };
+        const uint32_t positive = EncodeTangent(t, 1.0f);
+        const uint32_t negative = EncodeTangent(t, -1.0f);
+        CHECK((positive ^ negative) == 1u << 15);
+    }
+
+    void TestHalf()
+    {
+        // Every half converts to float and back unchanged (NaNs stay NaN).
+        bool exact = true;
+        for (uint32_t bits = 0; bits < 0x10000; ++bits)
+        {
+            const uint16_t half = static_cast<uint16_t>(bits);
+            const float value = HalfToFloat(half);
+            exact &= std::isnan(value) ? std::isnan(HalfToFloat(FloatToHalf(value))) : FloatToHalf(value) == half;
+        }
+        CHECK(exact);
+
+        // Normal range: relative error at most half an ulp, 2^-11; below it
+        // half the denormal step, 2^-25, absolute.
+        std::mt19937 rng(5);
+        std::uniform_real_distribution<float> exponent(-20.0f, 15.0f);
+        float worst = 0.0f;
+        for (int i = 0; i < 200000; ++i)
+        {
+            const float uv = std::exp2(exponent(rng)) * (rng() % 2 == 0 ? 1.0f : -1.0f);
+            const float error = std::fabs(HalfToFloat(FloatToHalf(uv)) - uv);
+            worst = std::max(worst, error / std::max(std::fabs(uv), std::ldexp(1.0f, -14)));
+        }
+        CHECK(worst <= std::ldexp(1.0f, -11));
+
+        CHECK(FloatToHalf(65519.0f) == 0x7bff); // rounds down to 65504
+        CHECK(FloatToHalf(65520.0f) == 0x7c00); // rounds up to infinity
+        CHECK(FloatToHalf(-1e9f) == 0xfc00);
+        CHECK(FloatToHalf(0.5f + std::ldexp(1.0f, -12)) == 0x3800); // tie to even
+    }
+
+    // Each axis lands within half a UNORM16 step of its AABB extent; a flat
+    // axis decodes to its minimum exactly.
+    void TestQuantizedPositions()
+    {
+        const float aabbMin[3] = { -3.0f, 10.0f, 0.25f };
+        const float aabbMax[3] = { 5.0f, 10.0f, 0.5f };
+        std::mt19937 rng(9);
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+        std::vector<FloatVertex> vertices(50000);
+        for (FloatVertex& vertex : vertices)
+        {
+            for (int a = 0; a < 3; ++a)
+                vertex.position[a] = aabbMin[a] + (aabbMax[a] - aabbMin[a]) * unit(rng);
+            RandomUnit(rng, vertex.normal);
+            RandomUnit(rng, vertex.tangent);
+            vertex.tangent[3] = rng() % 2 == 0 ? 1.0f : -1.0f;
+            vertex.uv[0] = unit(rng);
+            vertex.uv[1] = unit(rng) * 4.0f;
+        }
+        // The corners themselves.
+        std::copy(aabbMin, aabbMin + 3, vertices[0].position);
+        std::copy(aabbMax, aabbMax + 3, vertices[1].position);
+
+        std::vector<QuantizedVertex> packed(vertices.size());
+        std::vector<FloatVertex> decoded(vertices.size());
+        PackQuantized(vertices.data(), vertices.size(), aabbMin, aabbMax, packed.data());
+        UnpackQuantized(packed.data(), packed.size(), aabbMin, aabbMax, decoded.data());
+
+        bool withinStep = true;
+        bool flatExact = true;
+        for (size_t i = 0; i < vertices.size(); ++i)
+        {
+            for (int a = 0; a < 3; ++a)
+            {
+                const float extent = aabbMax[a] - aabbMin[a];
+                const float bound = extent * (0.5f / 65535.0f) + 4.0f * std::ldexp(std::max(std::fabs(aabbMin[a]), std::fabs(aabbMax[a])), -24);
+                withinStep &= std::fabs(decoded[i].position[a] - vertices[i].position[a]) <= bound;
+            }
+            flatExact &= decoded[i].position[1] == aabbMin[1];
+        }
+        CHECK(withinStep);
+        CHECK(flatExact);
+        CHECK(decoded[0].position[0] == aabbMin[0] && decoded[1].position[0] == aabbMax[0]);
+
+        // The attributes take the same path as PackedVertex.
+        const PackingError error = MeasureError(vertices.data(), decoded.data(), vertices.size());
+        CHECK(error.tangentSignFlips == 0);
+        CHECK(error.uv <= 4.0f * std::ldexp(1.0f, -11));
+    }
+}
+
+int main()
+{
+    TestOctahedralError();
+    TestHalf();
+    TestQuantizedPositions();
+    return TestCheck::Result("VertexPackingTests");
+}
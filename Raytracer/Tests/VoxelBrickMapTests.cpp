@@ -0,0 +1,127 @@
+#include "SceneResources/VoxelBrickMap.h"
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "TestCheck.h"
+
+namespace
+{
+    // A sparse bake of `dim`^3 with random occupancy and bounds, plus the
+    // grid's far faces and far corner occupied so the edge bricks are used.
+    VoxelBake MakeBake(uint32_t dim, unsigned seed)
+    {
+        std::mt19937 rng(seed);
+        std::uniform_int_distribution<uint32_t> value;
+        std::bernoulli_distribution occupied(0.03);
+
+        VoxelBake bake;
+        bake.grid.gridDim = dim;
+        bake.settings.gridDim = dim;
+        bake.settings.useCompact = true;
+        bake.occupancy.assign((bake.GetCellCount() + 63) / 64, 0);
+        for (uint32_t z = 0; z < dim; ++z)
+        {
+            for (uint32_t y = 0; y < dim; ++y)
+            {
+                for (uint32_t x = 0; x < dim; ++x)
+                {
+                    const bool face = (x == dim - 1 && y % 3 == 0) || (y == dim - 1 && z % 2 == 0) || (z == dim - 1 && x % 5 == 1);
+                    if (!face && !occupied(rng))
+                        continue;
+                    const uint32_t flatId = x + y * dim + z * dim * dim;
+                    bake.occupancy[flatId >> 6] |= uint64_t(1) << (flatId & 63);
+                }
+            }
+        }
+        for (size_t w = 0; w < bake.occupancy.size(); ++w)
+            for (uint32_t bit = 0; bit < 64; ++bit)
+                if ((bake.occupancy[w] >> bit) & 1u)
+                    bake.cells.push_back(static_cast<uint32_t>(w * 64 + bit));
+        for (size_t i = 0; i < bake.cells.size() * 6; ++i)
+            bake.bounds.push_back(value(rng));
+        return bake;
+    }
+
+    // Every voxel and channel of the map against the bake's dense resources.
+    void TestMatchesDense()
+    {
+        for (uint32_t dim : { 32u, 37u, 44u, 63u })
+        {
+            const VoxelBake bake = MakeBake(dim, dim);
+            VoxelBrickMap map;
+            CHECK(map.Build(bake));
+            const uint32_t bricks = (dim + 7) / 8;
+            CHECK(map.GetGridDim() == dim && map.GetBricksPerAxis() == bricks);
+            CHECK(map.GetMemoryStats().brickCount == static_cast<size_t>(bricks) * bricks * bricks);
+            CHECK(map.GetMemoryStats().occupiedVoxels == bake.cells.size());
+
+            std::vector<uint32_t> texels, boundMin, boundMax;
+            bake.ExpandOccupancy(texels);
+            bake.ExpandBounds(boundMin, boundMax);
+            bool same = true;
+            for (uint32_t z = 0; z < dim; ++z)
+            {
+                for (uint32_t y = 0; y < dim; ++y)
+                {
+                    for (uint32_t x = 0; x < dim; ++x)
+                    {
+                        const size_t flatId = x + (y + static_cast<size_t>(z) * dim) * dim;
+                        same &= map.IsOccupied(x, y, z) == (texels[flatId] != 0);
+                        for (uint32_t c = 0; c < 3; ++c)
+                        {
+                            same &= map.Load(x, y, z, static_cast<VoxelBrickMap::Channel>(VoxelBrickMap::BoundMinX + c)) == boundMin[flatId * 4 + c];
+                            same &= map.Load(x, y, z, static_cast<VoxelBrickMap::Channel>(VoxelBrickMap::BoundMaxX + c)) == boundMax[flatId * 4 + c];
+                        }
+                    }
+                }
+            }
+            CHECK(same);
+
+            std::vector<uint32_t> channel;
+            map.ExpandChannel(VoxelBrickMap::BoundMinY, channel);
+            same = channel.size() == texels.size();
+            for (size_t i = 0; i < channel.size() && same; ++i)
+                same &= channel[i] == boundMin[i * 4 + 1];
+            CHECK(same);
+
+            // The far corner sits in a padded brick when dim is not a multiple of 8.
+            CHECK(map.GetBrick(bricks - 1, bricks - 1, bricks - 1) != VoxelBrickMap::EMPTY_BRICK);
+            CHECK(map.IsNodeOccupied(0, bricks - 1, bricks - 1, bricks - 1));
+            CHECK(map.GetLevelDim(map.GetLevelCount() - 1) == 1 && map.IsNodeOccupied(map.GetLevelCount() - 1, 0, 0, 0));
+
+            const VoxelLookupBenchmark lookups = MeasureVoxelLookups(bake, map, 20000);
+            CHECK(lookups.queries == 20000 && lookups.mismatches == 0);
+        }
+    }
+
+    // Accumulators live only in allocated bricks and clear back to zero.
+    void TestAccumulators()
+    {
+        const VoxelBake bake = MakeBake(37, 5);
+        VoxelBrickMap map;
+        CHECK(map.Build(bake));
+        const uint32_t id = bake.cells.back();
+        const uint32_t x = id % 37, y = id / 37 % 37, z = id / (37 * 37);
+        uint32_t* irradiance = map.Find(x, y, z, VoxelBrickMap::Irradiance);
+        CHECK(irradiance != nullptr && *irradiance == 0u);
+        if (irradiance)
+            *irradiance = 7u;
+        CHECK(map.Load(x, y, z, VoxelBrickMap::Irradiance) == 7u);
+        map.ClearAccumulators();
+        CHECK(map.Load(x, y, z, VoxelBrickMap::Irradiance) == 0u);
+        CHECK(map.Load(x, y, z, VoxelBrickMap::BoundMinX) == bake.bounds[(bake.cells.size() - 1) * 6]);
+
+        VoxelBake empty;
+        CHECK(!map.Build(empty));
+        CHECK(map.GetGridDim() == 0);
+    }
+}
+
+int main()
+{
+    TestMatchesDense();
+    TestAccumulators();
+    return TestCheck::Result("VoxelBrickMapTests");
+}
@@ -0,0 +1,208 @@
+#include "SceneResources/VoxelClustering.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <set>
+#include <vector>
+
+#include "TestCheck.h"
+
+namespace
+{
+    VoxelFingerprint RandomFingerprint(std::mt19937& rng)
+    {
+        VoxelFingerprint fingerprint;
+        for (uint32_t& word : fingerprint.words)
+            word = rng();
+        return fingerprint;
+    }
+
+    // Odd counts leave a scalar tail after the two-at-a-time AVX2 loop, and
+    // the offset start misaligns the loads.
+    void TestHammingDistances()
+    {
+        std::printf("VoxelClusteringTests: HammingDistances uses %s\n", VoxelClustering::HammingDistancesUseAvx2() ? "AVX2" : "popcount");
+        std::mt19937 rng(1);
+        std::vector<VoxelFingerprint> others(1002);
+        for (VoxelFingerprint& fingerprint : others)
+            fingerprint = RandomFingerprint(rng);
+        others[5] = {};
+        others[6] = { { ~0u, ~0u, ~0u, ~0u } };
+        const VoxelFingerprint zero = {};
+
+        bool same = true;
+        for (uint32_t count : { 1u, 3u, 33u, 1001u })
+        {
+            for (const VoxelFingerprint& fingerprint : { others[0], others[6], zero })
+            {
+                std::vector<uint32_t> distances(count + 1, 12345u);
+                VoxelClustering::HammingDistances(fingerprint, others.data() + 1, count, distances.data());
+                for (uint32_t i = 0; i < count; ++i)
+                    same &= distances[i] == VoxelClustering::Hamming(fingerprint, others[i + 1]);
+                same &= distances[count] == 12345u;
+            }
+        }
+        CHECK(same);
+        CHECK(VoxelClustering::Hamming(zero, others[6]) == 128);
+        CHECK(VoxelClustering::Hamming(others[3], others[3]) == 0);
+    }
+
+    // CLUSTERS groups around random prototype fingerprints, far apart in
+    // Hamming distance, whose members flip a few bits and carry the
+    // group's intensity plus a little noise.
+    constexpr uint32_t CLUSTERS = 8;
+    constexpr uint32_t MEMBERS = 500;
+    constexpr uint32_t GRID_DIM = 32;
+
+    struct Planted
+    {
+        std::vector<VoxelFingerprint> prototypes;
+        std::vector<VoxelFingerprint> fingerprints;
+        std::vector<float> irradiance;
+        std::vector<uint32_t> compactIds;
+        std::vector<uint32_t> labels; // planted group per compact id
+
+        Planted()
+        {
+            std::mt19937 rng(7);
+            for (uint32_t c = 0; c < CLUSTERS; ++c)
+                prototypes.push_back(RandomFingerprint(rng));
+            std::uniform_real_distribution<float> noise(0.0f, 0.5f);
+            std::uniform_int_distribution<uint32_t> bit(0, 127);
+            std::uniform_int_distribution<uint32_t> cell(0, GRID_DIM * GRID_DIM * GRID_DIM - 1);
+            for (uint32_t i = 0; i < CLUSTERS * MEMBERS; ++i)
+            {
+                const uint32_t label = (i * 7 + i / 3) % CLUSTERS; // interleaved
+                VoxelFingerprint fingerprint = prototypes[label];
+                for (uint32_t flip = rng() % 4; flip > 0; --flip)
+                {
+                    const uint32_t b = bit(rng);
+                    fingerprint.words[b / 32] ^= 1u << (b % 32);
+                }
+                fingerprints.push_back(fingerprint);
+                irradiance.push_back(2.0f * static_cast<float>(label) + noise(rng));
+                compactIds.push_back(cell(rng));
+                labels.push_back(label);
+            }
+        }
+
+        [[nodiscard]] VoxelClusterInput Get() const
+        {
+            VoxelClusterInput input;
+            input.fingerprints = fingerprints.data();
+            input.premulIrradiance = irradiance.data();
+            input.compactIds = compactIds.data();
+            input.count = static_cast<uint32_t>(fingerprints.size());
+            input.gridDim = GRID_DIM;
+            return input;
+        }
+    };
+
+    // k-means++ draws each new seed proportionally to the squared distance to
+    // the nearest one, so with groups this far apart every group gets a seed.
+    void TestSeeding()
+    {
+        const Planted planted;
+        for (VoxelSeeding seeding : { VoxelSeeding::Exact, VoxelSeeding::Streaming })
+        {
+            for (uint32_t seed = 0; seed < 4; ++seed)
+            {
+                VoxelClusterSettings settings;
+                settings.clusterCount = CLUSTERS;
+                settings.seeding = seeding;
+                settings.candidateCount = 256; // Streaming: a reservoir smaller than the input
+                settings.seed = seed;
+                const VoxelClusters clusters = VoxelClustering::Cluster(planted.Get(), settings);
+                CHECK(clusters.centers.size() == CLUSTERS && clusters.seedCompactIds.size() == CLUSTERS);
+                CHECK(clusters.stats.iterations == 0 && clusters.stats.cost.size() == 1);
+
+                std::set<uint32_t> groups;
+                bool centersOk = true;
+                for (uint32_t c = 0; c < clusters.seedCompactIds.size(); ++c)
+                {
+                    const int32_t id = clusters.seedCompactIds[c];
+                    if (id < 0 || id >= static_cast<int32_t>(planted.labels.size()))
+                    {
+                        centersOk = false;
+                        continue;
+                    }
+                    groups.insert(planted.labels[id]);
+                    centersOk &= VoxelClustering::Hamming(clusters.centers[c].fingerprint, planted.fingerprints[id]) == 0;
+                    centersOk &= clusters.centers[c].intensity == planted.irradiance[id];
+                    centersOk &= clusters.centers[c].position[0] == static_cast<float>(planted.compactIds[id] % GRID_DIM);
+                }
+                CHECK(centersOk);
+                CHECK(groups.size() == CLUSTERS);
+            }
+        }
+
+        // Same settings, same clustering.
+        VoxelClusterSettings settings;
+        settings.clusterCount = CLUSTERS;
+        settings.seeding = VoxelSeeding::Streaming;
+        settings.lloydIterations = 3;
+        const VoxelClusters first = VoxelClustering::Cluster(planted.Get(), settings);
+        const VoxelClusters second = VoxelClustering::Cluster(planted.Get(), settings);
+        CHECK(first.seedCompactIds == second.seedCompactIds && first.assignments == second.assignments);
+    }
+
+    // Lloyd refinement moves the centres from seed voxels onto the
+    // prototypes: the cost never rises, falls overall, and the iterations
+    // stop early once the assignment is stable and equal to the planted one.
+    void TestLloyd()
+    {
+        const Planted planted;
+        for (VoxelSeeding seeding : { VoxelSeeding::Exact, VoxelSeeding::Streaming })
+        {
+            VoxelClusterSettings settings;
+            settings.clusterCount = CLUSTERS;
+            settings.seeding = seeding;
+            settings.lloydIterations = 20;
+            const VoxelClusters clusters = VoxelClustering::Cluster(planted.Get(), settings);
+            const std::vector<double>& cost = clusters.stats.cost;
+            CHECK(clusters.stats.iterations >= 1 && clusters.stats.iterations < settings.lloydIterations);
+            CHECK(cost.size() == clusters.stats.iterations + 1u);
+            bool monotone = true;
+            for (size_t i = 1; i < cost.size(); ++i)
+                monotone &= cost[i] <= cost[i - 1] * (1.0 + 1e-6);
+            CHECK(monotone);
+            CHECK(cost.back() < cost.front());
+            CHECK(clusters.stats.emptyClusters == 0);
+
+            // One cluster per planted group, and back onto its prototype.
+            std::vector<int32_t> clusterOf(CLUSTERS, -1);
+            bool partition = clusters.assignments.size() == planted.labels.size();
+            for (size_t i = 0; i < planted.labels.size() && partition; ++i)
+            {
+                int32_t& mapped = clusterOf[planted.labels[i]];
+                if (mapped < 0)
+                    mapped = clusters.assignments[i];
+                partition &= clusters.assignments[i] == mapped;
+            }
+            CHECK(partition);
+            CHECK(std::set<int32_t>(clusterOf.begin(), clusterOf.end()).size() == CLUSTERS);
+            bool prototypes = true;
+            for (uint32_t g = 0; g < CLUSTERS && partition; ++g)
+            {
+                const VoxelClusterCenter& center = clusters.centers[clusterOf[g]];
+                prototypes &= VoxelClustering::Hamming(center.fingerprint, planted.prototypes[g]) == 0;
+                prototypes &= center.intensity >= 2.0f * static_cast<float>(g) && center.intensity <= 2.0f * static_cast<float>(g) + 0.5f;
+            }
+            CHECK(prototypes);
+
+            // Assign against the final centres reproduces the result.
+            std::vector<int32_t> assignments;
+            const double finalCost = VoxelClustering::Assign(planted.Get(), settings, clusters.centers, assignments);
+            CHECK(assignments == clusters.assignments && finalCost == cost.back());
+        }
+    }
+}
+
+int main()
+{
+    TestHammingDistances();
+    TestSeeding();
+    TestLloyd();
+    return TestCheck::Result("VoxelClusteringTests");
+}
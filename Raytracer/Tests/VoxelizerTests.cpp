@@ -0,0 +1,275 @@
+#include "SceneResources/Voxelizer.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "TestCheck.h"
+
+namespace
+{
+    namespace fs = std::filesystem;
+
+    // Quantized bound offsets within a voxel: uint(saturate(x) * 4294967295.0f),
+    // where the float constant is 2^32.
+    constexpr uint32_t Q0 = 0u;
+    constexpr uint32_t Q25 = 1u << 30;
+    constexpr uint32_t Q50 = 1u << 31;
+    constexpr uint32_t Q75 = 3u << 30;
+    constexpr uint32_t Q100 = 0xffffffffu;
+
+    // One axis-aligned quad in the unit cube, parallel to the z = 0 plane at
+    // the middle of voxel layer `z` and spanning voxels [lo, hi] in x and y,
+    // a quarter voxel in from their outer faces.
+    struct Quad
+    {
+        uint32_t dim;
+        uint32_t lo;
+        uint32_t hi;
+        uint32_t z;
+
+        std::vector<float> positions;
+        std::vector<uint32_t> indices = { 0, 1, 2, 0, 2, 3 };
+        BvhGeometry geometry;
+        BvhInstance instance;
+
+        Quad(uint32_t dim_, uint32_t lo_, uint32_t hi_, uint32_t z_) : dim(dim_), lo(lo_), hi(hi_), z(z_)
+        {
+            const float size = static_cast<float>(dim);
+            const float a = (static_cast<float>(lo) + 0.25f) / size;
+            const float b = (static_cast<float>(hi) + 0.75f) / size;
+            const float c = (static_cast<float>(z) + 0.5f) / size;
+            positions = { a, a, c, b, a, c, b, b, c, a, b, c };
+            geometry.indexCount = 6;
+        }
+
+        [[nodiscard]] SceneBvhInput MakeInput() const
+        {
+            SceneBvhInput input;
+            input.positions = positions.data();
+            input.indices = indices.data();
+            input.geometries = &geometry;
+            input.geometryCount = 1;
+            input.instances = &instance;
+            input.instanceCount = 1;
+            return input;
+        }
+
+        [[nodiscard]] static BvhAabb Bounds()
+        {
+            BvhAabb bounds;
+            for (int a = 0; a < 3; ++a)
+            {
+                bounds.min[a] = 0.0f;
+                bounds.max[a] = 1.0f;
+            }
+            return bounds;
+        }
+    };
+
+    VoxelBake BakeQuad(const Quad& quad, bool useCompact, bool clipping)
+    {
+        VoxelBakeSettings settings;
+        settings.gridDim = quad.dim;
+        settings.useCompact = useCompact;
+        settings.clipping = clipping;
+        return Voxelizer::Bake(quad.MakeInput(), Quad::Bounds(), settings);
+    }
+
+    // The quad covers exactly its voxels on layer z. The edge-on projections
+    // along x and y have no area and add nothing; the one along z covers the
+    // pixels the quad overlaps, whose centres land on the quad's plane.
+    void TestKnownAnswer()
+    {
+        for (uint32_t dim : { 32u, 37u })
+        {
+            const Quad quad(dim, 3, dim - 6, dim / 2);
+            for (int mode = 0; mode < 3; ++mode)
+            {
+                const bool useCompact = mode != 0;
+                const bool clipping = mode == 2;
+                const VoxelBake bake = BakeQuad(quad, useCompact, clipping);
+                CHECK(bake.grid.gridDim == dim);
+                CHECK(bake.grid.gridMin[0] == 0.0f && bake.grid.gridMax[2] == 1.0f);
+                CHECK(bake.occupancy.size() == (bake.GetCellCount() + 63) / 64);
+
+                const uint32_t side = quad.hi - quad.lo + 1;
+                CHECK(bake.cells.size() == side * side);
+                CHECK(bake.bounds.size() == bake.cells.size() * 6);
+
+                bool cellsOk = true;
+                bool boundsOk = true;
+                size_t i = 0;
+                for (uint32_t y = quad.lo; y <= quad.hi; ++y)
+                {
+                    for (uint32_t x = quad.lo; x <= quad.hi; ++x, ++i)
+                    {
+                        const uint32_t flatId = x + y * dim + quad.z * dim * dim;
+                        cellsOk &= i < bake.cells.size() && bake.cells[i] == flatId && bake.IsOccupied(flatId);
+                        if (i >= bake.cells.size())
+                            continue;
+
+                        // Without useCompact every cell holds the whole voxel;
+                        // with it, the quad's extent inside the voxel.
+                        const uint32_t* bound = &bake.bounds[i * 6];
+                        const uint32_t expected[6] = {
+                            !useCompact || x != quad.lo ? Q0 : Q25,
+                            !useCompact || y != quad.lo ? Q0 : Q25,
+                            useCompact ? Q50 : Q0,
+                            !useCompact || x != quad.hi ? Q100 : Q75,
+                            !useCompact || y != quad.hi ? Q100 : Q75,
+                            useCompact ? Q50 : Q100,
+                        };
+                        for (int c = 0; c < 6; ++c)
+                            boundsOk &= bound[c] == expected[c];
+                    }
+                }
+                if (!boundsOk)
+                    std::fprintf(stderr, "dim %u compact %d clip %d: unexpected bounds\n", dim, useCompact, clipping);
+                CHECK(cellsOk);
+                CHECK(boundsOk);
+
+                // The dense resources: bakeClear's values everywhere else.
+                std::vector<uint32_t> texels, boundMin, boundMax;
+                bake.ExpandOccupancy(texels);
+                bake.ExpandBounds(boundMin, boundMax);
+                const uint32_t first = quad.lo + quad.lo * dim + quad.z * dim * dim;
+                const uint32_t empty = first - 1;
+                CHECK(texels.size() == bake.GetCellCount() && texels[first] == 1u && texels[empty] == 0u);
+                CHECK(boundMin[empty * 4] == 0xffffffffu && boundMax[empty * 4] == 0u);
+                CHECK(boundMin[first * 4] == bake.bounds[0] && boundMax[first * 4 + 2] == bake.bounds[5]);
+            }
+
+            // Compare counts cells and bound differences.
+            const VoxelBake cube = BakeQuad(quad, false, false);
+            const VoxelBake compact = BakeQuad(quad, true, false);
+            const VoxelBakeDiff same = Voxelizer::Compare(compact, BakeQuad(quad, true, true));
+            CHECK(same.IsEmpty());
+            const VoxelBakeDiff bounds = Voxelizer::Compare(cube, compact);
+            CHECK(bounds.onlyInFirst == 0 && bounds.onlyInSecond == 0);
+            CHECK(bounds.boundMismatches == cube.cells.size() && bounds.maxBoundDelta == Q50 - Q0);
+            const VoxelBakeDiff moved = Voxelizer::Compare(cube, BakeQuad(Quad(dim, 4, dim - 6, dim / 2), false, false));
+            CHECK(moved.onlyInFirst == 2 * (dim - 8) - 1 && moved.onlyInSecond == 0 && moved.boundMismatches == 0);
+        }
+
+        CHECK(BakeQuad(Quad(Voxelizer::MIN_GRID_DIM - 1, 3, 20, 5), false, false).occupancy.empty());
+        CHECK(BakeQuad(Quad(Voxelizer::MAX_GRID_DIM + 1, 3, 20, 5), false, false).occupancy.empty());
+    }
+
+    // FitGrid: a cube of the largest extent around the bounds' centre.
+    void TestFitGrid()
+    {
+        BvhAabb bounds;
+        const float lo[3] = { -1.0f, 2.0f, 0.0f };
+        const float hi[3] = { 3.0f, 4.0f, 1.0f };
+        for (int a = 0; a < 3; ++a)
+        {
+            bounds.min[a] = lo[a];
+            bounds.max[a] = hi[a];
+        }
+        VoxelGridConstants grid{};
+        Voxelizer::FitGrid(bounds, 64, grid);
+        CHECK(grid.gridDim == 64 && grid.voxelSize == 4.0f / 64.0f);
+        CHECK(grid.gridMin[0] == -1.0f && grid.gridMax[0] == 3.0f);
+        CHECK(grid.gridMin[1] == 1.0f && grid.gridMax[1] == 5.0f);
+        CHECK(grid.gridMin[2] == -1.5f && grid.gridMax[2] == 2.5f);
+        CHECK(grid.supervoxelFactor >= 1);
+    }
+
+    fs::path TempPath(const std::string& name)
+    {
+        return fs::temp_directory_path() / ("voxelizer_test_" + name);
+    }
+
+    std::vector<char> ReadAll(const fs::path& path)
+    {
+        std::ifstream in(path, std::ios::binary);
+        return std::vector<char>(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+
+    void WriteAll(const fs::path& path, const std::vector<char>& bytes)
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    }
+
+    void TestPersistence()
+    {
+        VoxelBakeSettings settings;
+        settings.gridDim = 37;
+        settings.useCompact = true;
+        CHECK(Voxelizer::GetBakePath("cache/scene.bsc", settings) == fs::path("cache/scene.g37.compact.bvx"));
+        settings.clipping = true;
+        CHECK(Voxelizer::GetBakePath("cache/scene.bsc", settings) == fs::path("cache/scene.g37.compact.clip.bvx"));
+        settings.useCompact = false;
+        settings.clipping = false;
+        CHECK(Voxelizer::GetBakePath("scene.bsc", settings) == fs::path("scene.g37.bvx"));
+
+        constexpr uint64_t HASH = 0x1234567890abcdefull;
+        const Quad quad(37, 2, 30, 11);
+        for (bool useCompact : { false, true })
+        {
+            settings.useCompact = useCompact;
+            const VoxelBake bake = BakeQuad(quad, useCompact, false);
+            const fs::path path = TempPath(useCompact ? "compact.bvx" : "cube.bvx");
+            CHECK(Voxelizer::Write(path, bake, HASH));
+            CHECK(!fs::exists(fs::path(path).concat(".tmp")));
+
+            VoxelBake loaded;
+            CHECK(Voxelizer::Read(path, HASH, settings, loaded));
+            CHECK(loaded.cells == bake.cells && loaded.occupancy == bake.occupancy && loaded.bounds == bake.bounds);
+            CHECK(loaded.grid.gridDim == bake.grid.gridDim && loaded.grid.voxelSize == bake.grid.voxelSize);
+            CHECK(Voxelizer::Compare(loaded, bake).IsEmpty());
+
+            // Another scene, grid or flag set: a miss that leaves the output alone.
+            VoxelBake untouched;
+            CHECK(!Voxelizer::Read(path, HASH + 1, settings, untouched));
+            VoxelBakeSettings other = settings;
+            other.gridDim = 36;
+            CHECK(!Voxelizer::Read(path, HASH, other, untouched));
+            other = settings;
+            other.useCompact = !useCompact;
+            CHECK(!Voxelizer::Read(path, HASH, other, untouched));
+            other = settings;
+            other.clipping = true;
+            CHECK(!Voxelizer::Read(path, HASH, other, untouched));
+            CHECK(untouched.occupancy.empty() && untouched.cells.empty());
+
+            // Truncated anywhere, or grown by a byte.
+            const std::vector<char> bytes = ReadAll(path);
+            const fs::path damaged = TempPath("damaged.bvx");
+            for (size_t size : { size_t(0), size_t(16), size_t(64), bytes.size() / 2, bytes.size() - 1, bytes.size() + 1 })
+            {
+                std::vector<char> cut = bytes;
+                cut.resize(size, 0);
+                WriteAll(damaged, cut);
+                CHECK(!Voxelizer::Read(damaged, HASH, settings, untouched));
+            }
+
+            // Cell 0 marked occupied: the header's cell count no longer matches.
+            std::vector<char> flipped = bytes;
+            flipped[bytes.size() - (useCompact ? bake.bounds.size() * 4 : 0) - bake.occupancy.size() * 8] ^= 0x01;
+            WriteAll(damaged, flipped);
+            CHECK(!Voxelizer::Read(damaged, HASH, settings, untouched));
+
+            fs::remove(damaged);
+            fs::remove(path);
+        }
+
+        VoxelBake missing;
+        CHECK(!Voxelizer::Read(TempPath("missing.bvx"), HASH, settings, missing));
+        CHECK(!Voxelizer::Write(TempPath("empty.bvx"), VoxelBake{}, HASH));
+    }
+}
+
+int main()
+{
+    TestKnownAnswer();
+    TestFitGrid();
+    TestPersistence();
+    return TestCheck::Result("VoxelizerTests");
+}
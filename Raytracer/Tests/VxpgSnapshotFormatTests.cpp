@@ -0,0 +1,379 @@
+#include "SceneResources/VxpgSnapshotFormat.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "TestCheck.h"
+
+// With a path argument, only checks that snapshot against what
+// tools/vxpg_snapshot.py --make-synthetic writes (the VxpgSnapshotPythonRead test).
+//
+//   VxpgSnapshotFormatTests [synthetic.vxps]
+namespace
+{
+    namespace fs = std::filesystem;
+    using namespace VxpgSnapshotFormat;
+
+    constexpr uint32_t GRID_DIM = 16;
+    constexpr uint32_t LIT = 300;
+    constexpr uint32_t CLUSTERS = 8;
+    constexpr uint32_t WIDTH = 8;
+    constexpr uint32_t HEIGHT = 4;
+
+    template <typename T>
+    bool Same(const ArrayView<T>& view, const std::vector<T>& values)
+    {
+        return view.size() == values.size() && (values.empty() || std::memcmp(view.data, values.data(), values.size() * sizeof(T)) == 0);
+    }
+
+    // A LightTree-stage frame, its cluster and tree sections produced by the
+    // CPU twins from the lit-voxel arrays.
+    SnapshotInput MakeInput()
+    {
+        std::mt19937 rng(3);
+        SnapshotInput input;
+        input.stage = 8;
+        input.frameIndex = 12;
+        input.width = WIDTH;
+        input.height = HEIGHT;
+        input.superpixelMapX = 2;
+        input.superpixelMapY = 1;
+        input.clusterCount = CLUSTERS;
+        input.litVoxelCount = LIT;
+        input.grid.gridMin[0] = input.grid.gridMin[1] = input.grid.gridMin[2] = -2.0f;
+        input.grid.voxelSize = 0.25f;
+        input.grid.gridMax[0] = input.grid.gridMax[1] = input.grid.gridMax[2] = 2.0f;
+        input.grid.gridDim = GRID_DIM;
+        input.grid.supervoxelFactor = 4;
+        input.grid.heatScale = 1.0f;
+        input.cvars = { { 1, "vxpg.cluster.weight", "0.5" }, { 3, "vxpg.stage", "LightTree" }, { 2, "empty", "" } };
+
+        std::vector<uint32_t> cells(GRID_DIM * GRID_DIM * GRID_DIM);
+        for (uint32_t i = 0; i < cells.size(); ++i)
+            cells[i] = i;
+        std::shuffle(cells.begin(), cells.end(), rng);
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+        for (uint32_t i = 0; i < LIT; ++i)
+        {
+            input.compactIds.push_back(cells[i]);
+            input.premulIrradiance.push_back(unit(rng) * 4.0f);
+            input.representativeVpls.push_back({ { unit(rng), unit(rng), unit(rng) }, unit(rng) });
+            input.fingerprints.push_back({ { static_cast<uint32_t>(rng()), static_cast<uint32_t>(rng()), static_cast<uint32_t>(rng()), static_cast<uint32_t>(rng()) } });
+        }
+        for (uint32_t i = 0; i < LIT + 20; ++i)
+            input.voxelIrradiance.push_back({ cells[i], static_cast<uint32_t>(rng() % 10000), 1 + static_cast<uint32_t>(rng() % 8) });
+
+        VoxelClusterInput clusterInput;
+        clusterInput.fingerprints = input.fingerprints.data();
+        clusterInput.premulIrradiance = input.premulIrradiance.data();
+        clusterInput.compactIds = input.compactIds.data();
+        clusterInput.count = LIT;
+        clusterInput.gridDim = GRID_DIM;
+        VoxelClusterSettings settings;
+        settings.clusterCount = CLUSTERS;
+        settings.seeding = VoxelSeeding::Exact;
+        settings.lloydIterations = 4;
+        const VoxelClusters clusters = VoxelClustering::Cluster(clusterInput, settings);
+        input.clusterSeeds = clusters.seedCompactIds;
+        input.clusterCenters = clusters.centers;
+        input.clusterAssignments = clusters.assignments;
+
+        LightTreeInput treeInput;
+        treeInput.compactIds = input.compactIds.data();
+        treeInput.clusterAssignments = input.clusterAssignments.data();
+        treeInput.premulIrradiance = input.premulIrradiance.data();
+        treeInput.count = LIT;
+        const LightTree tree = BuildLightTree(treeInput, input.grid);
+        input.leafCount = tree.leafCount;
+        input.lightTreeNodes = tree.nodes;
+        input.lightTreeClusterRoots.assign(tree.clusterRoots, tree.clusterRoots + CLUSTERS);
+        input.compactToLeaf = tree.compactToLeaf;
+
+        const uint32_t pixels = WIDTH * HEIGHT;
+        for (uint32_t i = 0; i < pixels * 4; ++i)
+            input.shadingPoints.push_back(unit(rng));
+        for (uint32_t i = 0; i < pixels; ++i)
+            input.superpixelIndex.push_back(static_cast<int32_t>(i % WIDTH >= WIDTH / 2));
+        input.clusterVisibilityMask = { 0x0fu, 0xf0u };
+        for (uint32_t i = 0; i < 2 * CLUSTERS; ++i)
+            input.clusterVisibility.push_back(i % 3 == 0 ? 0.0f : unit(rng));
+        return input;
+    }
+
+    fs::path TempPath(const char* name)
+    {
+        return fs::temp_directory_path() / (std::string("vxpgsnapshot_test_") + name + ".vxps");
+    }
+
+    std::vector<char> ReadBytes(const fs::path& path)
+    {
+        std::ifstream in(path, std::ios::binary);
+        return std::vector<char>(std::istreambuf_iterator<char>(in), {});
+    }
+
+    void WriteBytes(const fs::path& path, const std::vector<char>& bytes)
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    }
+
+    // Every section comes back as written, and the CPU twins rebuild the
+    // snapshot's clusters and tree from the accessors alone.
+    void TestRoundTrip()
+    {
+        const SnapshotInput input = MakeInput();
+        const fs::path path = TempPath("roundtrip");
+        CHECK(Write(path, input));
+        CHECK(!fs::exists(fs::path(path).concat(".tmp")));
+
+        Reader reader;
+        CHECK(reader.Open(path));
+        const FileHeader& header = reader.GetHeader();
+        CHECK(header.stage == 8 && header.frameIndex == 12 && header.width == WIDTH && header.height == HEIGHT);
+        CHECK(header.clusterCount == CLUSTERS && header.litVoxelCount == LIT && header.leafCount == LIT && header.treeOverflow == 0);
+        CHECK(header.sectionCount == 18);
+        CHECK(std::memcmp(&reader.GetGridConstants(), &input.grid, sizeof(VoxelGridConstants)) == 0);
+
+        const std::vector<CVarValue> cvars = reader.GetCVars();
+        bool same = cvars.size() == input.cvars.size();
+        for (size_t i = 0; i < cvars.size() && same; ++i)
+            same &= cvars[i].type == input.cvars[i].type && cvars[i].name == input.cvars[i].name && cvars[i].value == input.cvars[i].value;
+        CHECK(same);
+
+        CHECK(Same(reader.GetVoxelIrradiance(), input.voxelIrradiance));
+        CHECK(Same(reader.GetCompactIds(), input.compactIds));
+        CHECK(Same(reader.GetPremulIrradiance(), input.premulIrradiance));
+        CHECK(Same(reader.GetRepresentativeVpls(), input.representativeVpls));
+        CHECK(Same(reader.GetFingerprints(), input.fingerprints));
+        CHECK(Same(reader.GetClusterSeeds(), input.clusterSeeds));
+        CHECK(Same(reader.GetClusterCenters(), input.clusterCenters));
+        CHECK(Same(reader.GetClusterAssignments(), input.clusterAssignments));
+        CHECK(Same(reader.GetLightTreeNodes(), input.lightTreeNodes));
+        CHECK(Same(reader.GetLightTreeClusterRoots(), input.lightTreeClusterRoots));
+        CHECK(Same(reader.GetCompactToLeaf(), input.compactToLeaf));
+        CHECK(Same(reader.GetShadingPoints(), input.shadingPoints));
+        CHECK(Same(reader.GetSuperpixelIndex(), input.superpixelIndex));
+        CHECK(Same(reader.GetClusterVisibilityMask(), input.clusterVisibilityMask));
+        CHECK(Same(reader.GetClusterVisibility(), input.clusterVisibility));
+
+        const VoxelClusterInput clusterInput = reader.GetClusterInput();
+        CHECK(clusterInput.count == LIT && clusterInput.gridDim == GRID_DIM);
+        CHECK(clusterInput.fingerprints == reader.GetFingerprints().data && clusterInput.compactIds == reader.GetCompactIds().data);
+        VoxelClusterSettings settings;
+        settings.clusterCount = CLUSTERS;
+        settings.seeding = VoxelSeeding::Exact;
+        settings.lloydIterations = 4;
+        const VoxelClusters clusters = VoxelClustering::Cluster(clusterInput, settings);
+        CHECK(clusters.assignments == input.clusterAssignments && clusters.seedCompactIds == input.clusterSeeds);
+
+        const LightTreeInput treeInput = reader.GetLightTreeInput();
+        CHECK(treeInput.count == LIT && treeInput.clusterAssignments == reader.GetClusterAssignments().data);
+        const LightTree tree = BuildLightTree(treeInput, reader.GetGridConstants());
+        const ArrayView<LightTreeNode> nodes = reader.GetLightTreeNodes();
+        CHECK(CompareLightTrees(tree.nodes.data(), tree.nodes.size(), nodes.data, nodes.size()).IsEmpty());
+        reader.Close();
+        CHECK(reader.GetLightTreeNodes().empty() && reader.GetHeader().magic == 0);
+
+        // An early-stage frame: sections it did not reach are absent, and the
+        // twins' inputs come back empty instead of pointing at nothing.
+        SnapshotInput partial;
+        partial.stage = 2;
+        partial.litVoxelCount = LIT;
+        partial.grid = input.grid;
+        partial.voxelIrradiance = input.voxelIrradiance;
+        partial.compactIds = input.compactIds;
+        CHECK(Write(path, partial));
+        CHECK(reader.Open(path));
+        CHECK(reader.GetHeader().sectionCount == 3);
+        CHECK(reader.GetCompactIds().size() == LIT && reader.GetFingerprints().empty() && reader.GetCVars().empty());
+        CHECK(reader.GetClusterInput().count == 0 && reader.GetClusterInput().fingerprints == nullptr);
+        CHECK(reader.GetLightTreeInput().count == 0);
+        reader.Close();
+        fs::remove(path);
+    }
+
+    template <typename T>
+    void Patch(std::vector<char>& bytes, size_t offset, T value)
+    {
+        std::memcpy(bytes.data() + offset, &value, sizeof(T));
+    }
+
+    // The byte offset of section `id`'s table entry.
+    size_t EntryOffset(const std::vector<char>& bytes, SectionId id)
+    {
+        FileHeader header;
+        std::memcpy(&header, bytes.data(), sizeof(header));
+        for (uint32_t i = 0; i < header.sectionCount; ++i)
+        {
+            SectionEntry entry;
+            const size_t offset = sizeof(FileHeader) + i * sizeof(SectionEntry);
+            std::memcpy(&entry, bytes.data() + offset, sizeof(entry));
+            if (entry.id == static_cast<uint32_t>(id))
+                return offset;
+        }
+        return 0;
+    }
+
+    void TestRejects()
+    {
+        const SnapshotInput input = MakeInput();
+        const fs::path path = TempPath("rejects");
+        CHECK(Write(path, input));
+        const std::vector<char> good = ReadBytes(path);
+        Reader reader;
+        CHECK(reader.Open(path));
+        reader.Close();
+
+        // Truncated in the header, the section table and the last payload.
+        for (size_t cut : { size_t(0), sizeof(FileHeader) - 1, sizeof(FileHeader) + sizeof(SectionEntry) + 4, good.size() / 2, good.size() - 1 })
+        {
+            WriteBytes(path, std::vector<char>(good.begin(), good.begin() + static_cast<std::ptrdiff_t>(cut)));
+            CHECK(!reader.Open(path));
+        }
+
+        // Header edits: magic, version, and every count the sections are sized by.
+        const struct { size_t offset; uint32_t value; } edits[] = {
+            { offsetof(FileHeader, magic), MAGIC + 1 },
+            { offsetof(FileHeader, version), VERSION + 1 },
+            { offsetof(FileHeader, litVoxelCount), LIT - 1 },
+            { offsetof(FileHeader, litVoxelCount), LIT + 1 },
+            { offsetof(FileHeader, clusterCount), CLUSTERS + 1 },
+            { offsetof(FileHeader, leafCount), LIT - 1 },
+            { offsetof(FileHeader, width), WIDTH + 1 },
+            { offsetof(FileHeader, superpixelMapY), 2 },
+            { offsetof(FileHeader, sectionCount), 1000000 },
+        };
+        for (const auto& edit : edits)
+        {
+            std::vector<char> bytes = good;
+            Patch(bytes, edit.offset, edit.value);
+            WriteBytes(path, bytes);
+            CHECK(!reader.Open(path));
+        }
+
+        // Section table edits: a wrong element size, a payload running past the end.
+        {
+            std::vector<char> bytes = good;
+            const size_t entry = EntryOffset(bytes, SectionId::Fingerprints);
+            CHECK(entry != 0);
+            Patch(bytes, entry + offsetof(SectionEntry, elementSize), uint32_t(12));
+            WriteBytes(path, bytes);
+            CHECK(!reader.Open(path));
+
+            bytes = good;
+            Patch(bytes, entry + offsetof(SectionEntry, size), uint64_t(good.size()));
+            WriteBytes(path, bytes);
+            CHECK(!reader.Open(path));
+        }
+
+        // Writer input whose arrays disagree with its own counts.
+        SnapshotInput extraVoxel = input;
+        extraVoxel.premulIrradiance.push_back(1.0f);
+        CHECK(Write(path, extraVoxel));
+        CHECK(!reader.Open(path));
+
+        SnapshotInput missingSeed = input;
+        missingSeed.clusterSeeds.pop_back();
+        CHECK(Write(path, missingSeed));
+        CHECK(!reader.Open(path));
+
+        SnapshotInput outsideGrid = input;
+        outsideGrid.compactIds[7] = GRID_DIM * GRID_DIM * GRID_DIM;
+        CHECK(Write(path, outsideGrid));
+        CHECK(!reader.Open(path));
+
+        SnapshotInput noGrid;
+        CHECK(Write(path, noGrid));
+        CHECK(reader.Open(path)); // the grid section is always written
+        reader.Close();
+        {
+            std::vector<char> bytes = ReadBytes(path);
+            Patch(bytes, EntryOffset(bytes, SectionId::GridConstants), uint32_t(1000));
+            WriteBytes(path, bytes);
+            CHECK(!reader.Open(path));
+        }
+        fs::remove(path);
+        CHECK(!reader.Open(path));
+    }
+
+    // make_synthetic in tools/vxpg_snapshot.py: 600 lit voxels in 32^3, 32
+    // clusters (two empty, five voxels unassigned), a 64 x 48 frame in 16
+    // pixel superpixels and a median-split tree over every voxel.
+    void TestPythonSnapshot(const fs::path& path)
+    {
+        Reader reader;
+        CHECK(reader.Open(path));
+        const FileHeader& header = reader.GetHeader();
+        CHECK(header.stage == 8 && header.frameIndex == 1 && header.width == 64 && header.height == 48);
+        CHECK(header.superpixelMapX == 4 && header.superpixelMapY == 3 && header.clusterCount == 32);
+        CHECK(header.litVoxelCount == 600 && header.leafCount == 600 && header.treeOverflow == 0);
+        const VoxelGridConstants& grid = reader.GetGridConstants();
+        CHECK(grid.gridDim == 32 && grid.voxelSize == 0.25f && grid.gridMin[0] == -4.0f && grid.gridMax[2] == 4.0f);
+        CHECK(grid.injectUseAvg == 1 && grid.supervoxelFactor == 4 && grid.heatScale == 1.0f && grid.reuseGiVpl == 0);
+
+        const std::vector<CVarValue> cvars = reader.GetCVars();
+        CHECK(cvars.size() == 3 && cvars[0].name == "vxpg.cluster.weight" && cvars[0].value == "0.5" && cvars[0].type == 1);
+        CHECK(cvars.size() == 3 && cvars[2].name == "vxpg.stage" && cvars[2].value == "LightTree" && cvars[2].type == 3);
+
+        CHECK(reader.GetVoxelIrradiance().size() == 640 && reader.GetRepresentativeVpls().size() == 600);
+        CHECK(reader.GetShadingPoints().size() == 64 * 48 * 4 && reader.GetSuperpixelIndex().size() == 64 * 48);
+        CHECK(reader.GetClusterVisibility().size() == 12 * 32 && reader.GetClusterVisibilityMask().size() == 12);
+        CHECK(reader.GetLightTreeNodes().size() == 1199 && reader.GetLightTreeClusterRoots().size() == 32);
+
+        const VoxelClusterInput clusterInput = reader.GetClusterInput();
+        CHECK(clusterInput.count == 600 && clusterInput.gridDim == 32 && clusterInput.fingerprints && clusterInput.premulIrradiance);
+        const LightTreeInput treeInput = reader.GetLightTreeInput();
+        CHECK(treeInput.count == 600 && treeInput.clusterAssignments && treeInput.compactIds);
+
+        // Centres are the seed voxels, leaves point back at their voxels, and
+        // the root holds the total irradiance.
+        const ArrayView<int32_t> seeds = reader.GetClusterSeeds();
+        const ArrayView<VoxelClusterCenter> centers = reader.GetClusterCenters();
+        bool same = true;
+        for (size_t c = 0; c < seeds.size(); ++c)
+            same &= seeds[c] >= 0 && seeds[c] < 600 && VoxelClustering::Hamming(centers[c].fingerprint, clusterInput.fingerprints[seeds[c]]) == 0;
+        CHECK(same);
+        const ArrayView<LightTreeNode> nodes = reader.GetLightTreeNodes();
+        const ArrayView<int32_t> compactToLeaf = reader.GetCompactToLeaf();
+        double total = 0.0;
+        same = true;
+        for (uint32_t i = 0; i < 600; ++i)
+        {
+            const int32_t leaf = compactToLeaf[i];
+            same &= leaf >= 599 && leaf < 1199 && nodes[leaf].voxelIndex == i && nodes[leaf].intensity == clusterInput.premulIrradiance[i];
+            total += clusterInput.premulIrradiance[i];
+        }
+        CHECK(same);
+        CHECK(nodes[0].parentIndex == LightTreeNode::NONE && std::abs(nodes[0].intensity - total) <= 1e-4 * total);
+
+        // And the CPU twins run on it.
+        VoxelClusterSettings settings;
+        settings.seeding = VoxelSeeding::Exact;
+        settings.lloydIterations = 2;
+        CHECK(VoxelClustering::Cluster(clusterInput, settings).assignments.size() == 600);
+        const LightTree tree = BuildLightTree(treeInput, grid);
+        CHECK(tree.leafCount == 600 && !tree.overflow && tree.nodes.size() == 1199); // unassigned voxels sort last
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc > 1)
+    {
+        TestPythonSnapshot(argv[1]);
+        return TestCheck::Result("VxpgSnapshotFormatTests (python)");
+    }
+    TestRoundTrip();
+    TestRejects();
+    return TestCheck::Result("VxpgSnapshotFormatTests");
+}
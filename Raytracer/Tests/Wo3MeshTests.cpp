@@ -0,0 +1,120 @@
+#include "SceneResources/Wo3Mesh.h"
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "TestCheck.h"
+
+namespace
+{
+    namespace fs = std::filesystem;
+
+    std::vector<uint8_t> MakeMesh(uint64_t vertexCount, uint64_t triangleCount, const std::vector<Wo3Mesh::Triangle>& triangles)
+    {
+        std::vector<uint8_t> bytes;
+        auto append = [&](const void* data, size_t size)
+        {
+            const auto* p = static_cast<const uint8_t*>(data);
+            bytes.insert(bytes.end(), p, p + size);
+        };
+        append(&vertexCount, sizeof(vertexCount));
+        for (uint64_t i = 0; i < vertexCount; ++i)
+        {
+            const float f = static_cast<float>(i);
+            const Wo3Mesh::Vertex v{ f, f + 1, f + 2, 0, 1, 0, 0.5f, 0.25f };
+            append(&v, sizeof(v));
+        }
+        append(&triangleCount, sizeof(triangleCount));
+        for (const Wo3Mesh::Triangle& t : triangles)
+            append(&t, sizeof(t));
+        return bytes;
+    }
+
+    fs::path WriteTemp(const std::string& name, const std::vector<uint8_t>& bytes)
+    {
+        const fs::path path = fs::temp_directory_path() / ("wo3mesh_test_" + name + ".wo3");
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        return path;
+    }
+
+    void TestValid()
+    {
+        const std::vector<Wo3Mesh::Triangle> triangles = { { 0, 1, 2, 0 }, { 2, 1, 3, 7 } };
+        const fs::path path = WriteTemp("valid", MakeMesh(4, 2, triangles));
+
+        Wo3Mesh::File file;
+        CHECK(file.Open(path) == Wo3Mesh::Status::Ok);
+        CHECK(file.VertexCount() == 4 && file.TriangleCount() == 2);
+        CHECK(file.TrailingBytes() == 0);
+        CHECK(file.Vertices()[3].px == 3.0f && file.Vertices()[3].v == 0.25f);
+
+        std::vector<uint32_t> indices(6);
+        size_t bad = 0;
+        CHECK(Wo3Mesh::CopyIndices(file, indices.data(), bad));
+        CHECK((indices == std::vector<uint32_t>{ 0, 1, 2, 2, 1, 3 }));
+        fs::remove(path);
+    }
+
+    void TestRejects()
+    {
+        Wo3Mesh::File file;
+        CHECK(file.Open(fs::temp_directory_path() / "wo3mesh_test_missing.wo3") == Wo3Mesh::Status::OpenFailed);
+
+        const std::vector<uint8_t> full = MakeMesh(3, 1, { { 0, 1, 2, 0 } });
+
+        // Cut inside the vertex array, inside the triangle count, inside the triangles.
+        const size_t cuts[] = { 4, 8 + 32 * 2, 8 + 32 * 3 + 4, full.size() - 1 };
+        const Wo3Mesh::Status expected[] = {
+            Wo3Mesh::Status::TruncatedVertices, Wo3Mesh::Status::TruncatedVertices,
+            Wo3Mesh::Status::TruncatedTriangles, Wo3Mesh::Status::TruncatedTriangles };
+        for (size_t i = 0; i < 4; ++i)
+        {
+            const fs::path path = WriteTemp("cut", std::vector<uint8_t>(full.begin(), full.begin() + cuts[i]));
+            CHECK(file.Open(path) == expected[i]);
+            fs::remove(path);
+        }
+
+        // A huge declared count must not overflow the size check.
+        {
+            std::vector<uint8_t> huge = full;
+            const uint64_t declared = UINT64_MAX / 2;
+            std::memcpy(huge.data(), &declared, sizeof(declared));
+            const fs::path path = WriteTemp("huge", huge);
+            CHECK(file.Open(path) == Wo3Mesh::Status::TruncatedVertices);
+            fs::remove(path);
+        }
+
+        // Trailing bytes are reported, not rejected.
+        {
+            std::vector<uint8_t> padded = full;
+            padded.resize(padded.size() + 5);
+            const fs::path path = WriteTemp("trailing", padded);
+            CHECK(file.Open(path) == Wo3Mesh::Status::Ok);
+            CHECK(file.TrailingBytes() == 5);
+            fs::remove(path);
+        }
+
+        // Out-of-range and negative indices stop at the offending triangle.
+        {
+            const fs::path path = WriteTemp("index", MakeMesh(3, 3, { { 0, 1, 2, 0 }, { 0, 1, 3, 0 }, { -1, 0, 1, 0 } }));
+            CHECK(file.Open(path) == Wo3Mesh::Status::Ok);
+            std::vector<uint32_t> indices(9);
+            size_t bad = 0;
+            CHECK(!Wo3Mesh::CopyIndices(file, indices.data(), bad));
+            CHECK(bad == 1);
+            fs::remove(path);
+        }
+    }
+}
+
+int main()
+{
+    TestValid();
+    TestRejects();
+    return TestCheck::Result("Wo3MeshTests");
+}
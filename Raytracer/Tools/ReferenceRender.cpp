@@ -0,0 +1,187 @@
+// Converged references without a GPU: renders saved states of a baked scene
+// cache (SavedUserData/SceneCache/*.bsc) with ReferencePathTracer under the
+// headless config, writing <out>/<model>/<place>-Reference.pfm/.png/.json per
+// state the way a headless run names its captures, so
+// tools/compare_captures.py can diff them against GPU captures. <out>
+// defaults to the config's outputDir/references. One throughput line per state on stdout;
+// tools/reference_render.py keeps the history.
+//
+//   ReferenceRender <scene.bsc> [--states a,b] [--frames N] [--out dir]
+//                   [--config headless.json] [--state-file states.json]
+//                   [--model name] [--sky equirect.pfm]
+//
+// Without --states every saved state of the model is rendered. The model key
+// defaults to the one Renderer files the cache's source scene under.
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <sstream>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include "Headless.h"
+#include "SceneResources/VertexPacking.h"
+#include "Techniques/ReferencePathTracer.h"
+#include "Utils/ThreadPool.h"
+
+namespace
+{
+    struct Options
+    {
+        std::string cache;
+        std::vector<std::string> states;
+        uint32_t frames = 64;
+        std::string outDir;
+        std::string config = "SavedUserData/headless.json";
+        std::string stateFile = "SavedUserData/states.json";
+        std::string model;
+        std::string sky;
+    };
+
+    // Headless.cpp's --states parsing: underscores stand in for spaces.
+    std::vector<std::string> SplitCsv(const std::string& value)
+    {
+        std::vector<std::string> out;
+        std::stringstream ss(value);
+        std::string item;
+        while (std::getline(ss, item, ','))
+        {
+            std::replace(item.begin(), item.end(), '_', ' ');
+            if (!item.empty())
+                out.push_back(item);
+        }
+        return out;
+    }
+
+    bool ParseOptions(int argc, char** argv, Options& options)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string flag = argv[i];
+            if (flag.rfind("--", 0) != 0)
+            {
+                if (!options.cache.empty())
+                    return false;
+                options.cache = flag;
+                continue;
+            }
+            if (i + 1 >= argc)
+                return false;
+            const std::string value = argv[++i];
+            if (flag == "--states")          options.states = SplitCsv(value);
+            else if (flag == "--frames")     options.frames = static_cast<uint32_t>(std::max(1, std::atoi(value.c_str())));
+            else if (flag == "--out")        options.outDir = value;
+            else if (flag == "--config")     options.config = value;
+            else if (flag == "--state-file") options.stateFile = value;
+            else if (flag == "--model")      options.model = value;
+            else if (flag == "--sky")        options.sky = value;
+            else return false;
+        }
+        return !options.cache.empty();
+    }
+
+    std::string ToLowerAscii(std::string s)
+    {
+        std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        return s;
+    }
+
+    // Renderer.cpp's ExtractModelName: Tungsten scenes are all scene.json,
+    // so they are keyed by their folder.
+    std::string ExtractModelName(const std::filesystem::path& p)
+    {
+        if (ToLowerAscii(p.extension().string()) == ".json")
+            return ToLowerAscii(p.parent_path().filename().string());
+        return ToLowerAscii(p.stem().string());
+    }
+}
+
+int main(int argc, char** argv)
+{
+    namespace fs = std::filesystem;
+    Options options;
+    if (!ParseOptions(argc, argv, options))
+    {
+        std::fprintf(stderr, "usage: ReferenceRender <scene.bsc> [--states a,b] [--frames N] [--out dir] [--config headless.json]\n"
+                             "                       [--state-file states.json] [--model name] [--sky equirect.pfm]\n");
+        return 2;
+    }
+
+    SceneCacheFormat::Reader cache;
+    if (!cache.Open(options.cache, sizeof(VertexPacking::FloatVertex)))
+    {
+        std::fprintf(stderr, "%s: not a scene cache this build can read\n", options.cache.c_str());
+        return 2;
+    }
+    const std::string model = options.model.empty() ? ExtractModelName(fs::u8path(cache.GetName())) : options.model;
+
+    const std::vector<std::string> states = options.states.empty() ? ListReferenceStates(options.stateFile, model) : options.states;
+    if (states.empty())
+    {
+        std::fprintf(stderr, "%s: no saved states for \"%s\"\n", options.stateFile.c_str(), model.c_str());
+        return 2;
+    }
+
+    const HeadlessConfig config = LoadHeadlessConfig(options.config);
+    const ReferencePathTracer::Settings settings = ReferencePathTracer::Settings::FromConfig(config, options.frames);
+
+    ReferencePathTracer tracer;
+    if (!tracer.Load(cache))
+    {
+        std::fprintf(stderr, "%s: scene cache has no float vertices to trace\n", options.cache.c_str());
+        return 2;
+    }
+    ReferenceSky sky;
+    if (!options.sky.empty())
+    {
+        if (!LoadReferenceSky(options.sky, sky))
+        {
+            std::fprintf(stderr, "%s: not a PFM image\n", options.sky.c_str());
+            return 2;
+        }
+        tracer.SetSky(std::move(sky));
+    }
+    // State lights win over the config's, which win over the scene's, as GoToState and HeadlessRunner apply them.
+    const std::vector<SceneCacheFormat::LightRecord> sceneLights = config.lights.empty() ? tracer.GetLights() : ConvertHeadlessLights(config.lights);
+
+    const fs::path outDir = (options.outDir.empty() ? fs::path(config.outputDir) / "references" : fs::u8path(options.outDir)) / fs::u8path(model);
+    std::error_code ec;
+    fs::create_directories(outDir, ec);
+
+    std::printf("%s: %zu state(s), %ux%u, %u spp x %u frame(s), %u bounce(s), %u thread(s)\n", model.c_str(), states.size(),
+        settings.width, settings.height, settings.samplesPerPixel, settings.frames, settings.bounces, ThreadPool::Get().GetThreadCount());
+
+    int result = 0;
+    std::vector<float> rgb;
+    for (const std::string& place : states)
+    {
+        ReferenceState state;
+        if (!LoadReferenceState(options.stateFile, model, place, state))
+        {
+            std::fprintf(stderr, "%s: no state \"%s\" for \"%s\"\n", options.stateFile.c_str(), place.c_str(), model.c_str());
+            result = 2;
+            continue;
+        }
+        tracer.SetLights(state.hasLights ? state.lights : sceneLights);
+
+        const ReferencePathTracer::Stats stats = tracer.Render(state.camera, settings, rgb);
+        const fs::path stem = outDir / fs::u8path(place + "-Reference");
+        const bool written = ReferenceOutput::WritePfm(fs::path(stem).concat(".pfm"), rgb.data(), settings.width, settings.height)
+            && ReferenceOutput::WritePng(fs::path(stem).concat(".png"), rgb.data(), settings.width, settings.height, config)
+            && ReferenceOutput::WriteSidecarJson(fs::path(stem).concat(".json"), state.camera, settings, config, stats, model, place);
+        if (!written)
+        {
+            std::fprintf(stderr, "%s: could not write the reference\n", stem.string().c_str());
+            result = 1;
+            continue;
+        }
+        std::printf("  %-24s %10.1f ms  %8.2f Mrays/s  %8.2f Msamples/s\n", place.c_str(), stats.milliseconds,
+            stats.MegaRaysPerSecond(), stats.MegaSamplesPerSecond());
+    }
+    return result;
+}
@@ -21,6 +21,15 @@
  *  3. This notice may not be removed or altered from any source distribution.
  */
 
+/*
+ *  Altered from upstream (search for MIKKTSPACE_UPSTREAM_EDGE_SORT):
+ *  BuildNeighborsFast also sorts the last run of equal i0 and of equal i0/i1
+ *  edges. Upstream sorts each run only when the next one starts, so matching
+ *  edges of the faces referencing the highest welded indices can stay apart
+ *  and never become neighbours. Define MIKKTSPACE_UPSTREAM_EDGE_SORT to build
+ *  the published behaviour.
+ */
+
 #include <assert.h>
 #include <stdio.h>
 #include <math.h>
@@ -1532,6 +1541,9 @@ static void BuildNeighborsFast(STriInfo pTriInfos[], SEdge * pEdges, const int p
 			QuickSortEdges(pEdges, iL, iR, 1, uSeed);	// sort channel 1 which is i1
 		}
 	}
+#ifndef MIKKTSPACE_UPSTREAM_EDGE_SORT
+	QuickSortEdges(pEdges, iCurStartIndex, iEntries-1, 1, uSeed);	// the last run
+#endif
 
 	// sub sort over f, which should be fast.
 	// this step is to remain compliant with BuildNeighborsSlow() when
@@ -1548,6 +1560,9 @@ static void BuildNeighborsFast(STriInfo pTriInfos[], SEdge * pEdges, const int p
 			QuickSortEdges(pEdges, iL, iR, 2, uSeed);	// sort channel 2 which is f
 		}
 	}
+#ifndef MIKKTSPACE_UPSTREAM_EDGE_SORT
+	QuickSortEdges(pEdges, iCurStartIndex, iEntries-1, 2, uSeed);	// the last run
+#endif
 
 	// pair up, adjacent triangles
 	for (i=0; i<iEntries; i++)
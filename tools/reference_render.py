@@ -0,0 +1,139 @@
+#!/usr/bin/env python3
+"""Render converged CPU references for baked scene caches and track throughput.
+
+Runs the ReferenceRender tool (Raytracer/Tools/ReferenceRender.cpp, the Linux
+CMake build) on each scene cache, leaving <place>-Reference.pfm/.png/.json
+under OUT/<model>/, and appends one record per rendered state to a JSON-lines
+history: Mrays/s, Msamples/s and time, keyed by model, state, resolution,
+spp, bounces, frames and thread count. Each record is compared with the last
+one under the same key; --max-regression turns a slowdown into a failure.
+
+Usage:
+  cmake -S Raytracer -B build && cmake --build build --target ReferenceRender
+  python tools/reference_render.py SavedUserData/SceneCache/sponza-*.bsc --frames 256
+
+  # two states, a skybox exported as PFM, fail on a >5% Mrays/s drop
+  python tools/reference_render.py sponza.bsc --states Hall,Atrium --sky sky.pfm --max-regression 5
+"""
+
+import argparse
+import json
+import os
+import shutil
+import socket
+import subprocess
+import sys
+import time
+from pathlib import Path
+
+KEY_FIELDS = ["model", "place", "width", "height", "spp", "bounces", "frames", "threads"]
+
+
+def find_binary(path):
+    if path:
+        return path
+    default = Path("build") / "ReferenceRender"
+    if default.exists():
+        return str(default)
+    found = shutil.which("ReferenceRender")
+    if not found:
+        sys.exit("ReferenceRender not found. Build it (see --help) or pass --binary.")
+    return found
+
+
+def git_revision():
+    try:
+        return subprocess.run(["git", "rev-parse", "--short", "HEAD"], capture_output=True, text=True,
+                              check=True).stdout.strip()
+    except (OSError, subprocess.CalledProcessError):
+        return None
+
+
+def load_history(path):
+    last = {}
+    if path.exists():
+        with open(path) as f:
+            for line in f:
+                if line.strip():
+                    record = json.loads(line)
+                    last[tuple(record.get(k) for k in KEY_FIELDS)] = record
+    return last
+
+
+def record_from_sidecar(path, cache):
+    with open(path) as f:
+        sidecar = json.load(f)
+    perf = sidecar["throughput"]
+    return {
+        "time": time.strftime("%Y-%m-%dT%H:%M:%S"),
+        "revision": git_revision(),
+        "host": socket.gethostname(),
+        "cache": os.path.basename(cache),
+        "model": sidecar["scene"]["model"],
+        "place": sidecar["scene"]["place"],
+        "width": sidecar["render"]["width"],
+        "height": sidecar["render"]["height"],
+        "spp": sidecar["raytracing"]["spp"],
+        "bounces": sidecar["raytracing"]["bounces"],
+        "frames": sidecar["raytracing"]["frames"],
+        "threads": perf["threads"],
+        "milliseconds": perf["milliseconds"],
+        "megaRaysPerSecond": perf["megaRaysPerSecond"],
+        "megaSamplesPerSecond": perf["megaSamplesPerSecond"],
+    }
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Render CPU references and append their throughput to a history.")
+    parser.add_argument("caches", nargs="+", help="scene caches (.bsc)")
+    parser.add_argument("--binary", help="ReferenceRender executable (default: build/ReferenceRender, then PATH)")
+    parser.add_argument("--out", default="SavedUserData/References", help="output root (default SavedUserData/References)")
+    parser.add_argument("--history", default="SavedUserData/References/throughput.jsonl",
+                        help="JSON-lines throughput history to append to")
+    parser.add_argument("--states", help="comma-separated state names (default: every saved state)")
+    parser.add_argument("--frames", type=int, default=64, help="accumulated frames per reference (default 64)")
+    parser.add_argument("--config", default="SavedUserData/headless.json", help="headless config")
+    parser.add_argument("--state-file", default="SavedUserData/states.json", help="saved states")
+    parser.add_argument("--model", help="states.json key, when it is not the cache's scene name")
+    parser.add_argument("--sky", help="equirectangular sky as PFM")
+    parser.add_argument("--max-regression", type=float,
+                        help="fail when Mrays/s drops more than this many percent against the last matching record")
+    args = parser.parse_args()
+
+    binary = find_binary(args.binary)
+    history_path = Path(args.history)
+    last = load_history(history_path)
+    history_path.parent.mkdir(parents=True, exist_ok=True)
+
+    failed = False
+    for cache in args.caches:
+        command = [binary, cache, "--out", args.out, "--frames", str(args.frames),
+                   "--config", args.config, "--state-file", args.state_file]
+        for flag, value in (("--states", args.states), ("--model", args.model), ("--sky", args.sky)):
+            if value:
+                command += [flag, value]
+
+        started = time.time()
+        if subprocess.run(command).returncode != 0:
+            failed = True
+
+        # The tool picks the model folder; this run's sidecars are the fresh ones.
+        sidecars = sorted(p for p in Path(args.out).glob("*/*-Reference.json") if p.stat().st_mtime >= started - 1.0)
+        with open(history_path, "a") as history:
+            for sidecar in sidecars:
+                record = record_from_sidecar(sidecar, cache)
+                history.write(json.dumps(record) + "\n")
+
+                previous = last.get(tuple(record[k] for k in KEY_FIELDS))
+                if previous is None or previous["megaRaysPerSecond"] <= 0:
+                    continue
+                change = 100.0 * (record["megaRaysPerSecond"] / previous["megaRaysPerSecond"] - 1.0)
+                since = previous["time"] + (f" ({previous['revision']})" if previous.get("revision") else "")
+                print(f"  {record['place']:<24} {change:+6.1f}% Mrays/s vs {since}")
+                if args.max_regression is not None and change < -args.max_regression:
+                    failed = True
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,603 @@
+#!/usr/bin/env python3
+"""Read and summarize a VXPG stage snapshot (.vxps) written by the renderer
+(--vxpg-snapshot, or VxpgSnapshotManager::Arm). The layout is the one in
+Raytracer/Include/SceneResources/VxpgSnapshotFormat.h; VERSION must match.
+
+Reports, for whichever stages the snapshot holds:
+  irradiance   log2 histogram of the injected voxel irradiance (total and per VPL)
+  coverage     compact ids vs. injected voxels and the guiding capacity
+  clusters     cluster sizes, empty clusters, unassigned voxels
+  lightTree    leaf depth against log2(leaves), split balance, link/intensity checks
+  visibility   superpixel x cluster sparsity of the soft visibility and the hard mask
+
+Examples:
+  # everything, human-readable
+  python tools/vxpg_snapshot.py captures/kitchen.vxps
+
+  # one section as JSON, 24 histogram bins
+  python tools/vxpg_snapshot.py captures/kitchen.vxps --only lightTree --json --bins 24
+
+  # write a small self-consistent snapshot to exercise readers without a GPU
+  python tools/vxpg_snapshot.py --make-synthetic /tmp/synthetic.vxps --seed 7
+"""
+
+import argparse
+import json
+import os
+import sys
+
+try:
+    import numpy as np
+except ImportError as exc:
+    sys.exit(f"Missing dependency ({exc.name}). Run: pip install -r tools/requirements.txt")
+
+MAGIC = 0x53505856  # "VXPS"
+VERSION = 1
+SECTION_ALIGNMENT = 16
+GUIDING_CAPACITY = 131072  # VOXEL_GUIDING_CAPACITY
+NODE_NONE = 0xFFFF
+STAGES = ["None", "Voxelize", "Inject", "GuidingBuild", "Fingerprint", "Cluster",
+          "Superpixel", "ClusterVisibility", "LightTree"]
+CVAR_TYPES = ["Int", "Float", "String", "Enum", "Float3"]
+
+HEADER_FIELDS = ["magic", "version", "stage", "frameIndex", "width", "height",
+                 "superpixelMapX", "superpixelMapY", "clusterCount", "litVoxelCount",
+                 "leafCount", "treeOverflow", "sectionCount", "reserved"]
+HEADER = np.dtype([(name, "<u4") for name in HEADER_FIELDS])
+SECTION = np.dtype([("id", "<u4"), ("elementSize", "<u4"), ("offset", "<u8"), ("size", "<u8")])
+
+GRID = np.dtype([("gridMin", "<f4", 3), ("voxelSize", "<f4"), ("gridMax", "<f4", 3), ("gridDim", "<u4"),
+                 ("injectUseAvg", "<u4"), ("supervoxelFactor", "<u4"), ("heatScale", "<f4"), ("reuseGiVpl", "<u4")])
+CVAR = np.dtype([("type", "<u4"), ("nameOffset", "<u4"), ("nameLength", "<u4"),
+                 ("valueOffset", "<u4"), ("valueLength", "<u4")])
+VOXEL_IRRADIANCE = np.dtype([("voxel", "<u4"), ("irradiance", "<u4"), ("vplCount", "<u4")])
+VPL = np.dtype([("position", "<f4", 3), ("normal", "<u4")])
+FINGERPRINT = np.dtype([("words", "<u4", 4)])
+CENTER = np.dtype([("fingerprint", "<u4", 4), ("position", "<f4", 3), ("intensity", "<f4")])
+NODE = np.dtype([("aabbMin", "<u4", 2), ("aabbMax", "<u4", 2), ("intensity", "<f4"), ("flag", "<u4"),
+                 ("parentIndex", "<u2"), ("leftIndex", "<u2"), ("rightIndex", "<u2"), ("voxelIndex", "<u2")])
+
+# SectionId order in VxpgSnapshotFormat.h, starting at 1.
+SECTIONS = [
+    ("grid", GRID),
+    ("cvars", CVAR),
+    ("strings", np.dtype("u1")),
+    ("voxelIrradiance", VOXEL_IRRADIANCE),
+    ("compactIds", np.dtype("<u4")),
+    ("premulIrradiance", np.dtype("<f4")),
+    ("representativeVpls", VPL),
+    ("fingerprints", FINGERPRINT),
+    ("clusterSeeds", np.dtype("<i4")),
+    ("clusterCenters", CENTER),
+    ("clusterAssignments", np.dtype("<i4")),
+    ("lightTreeNodes", NODE),
+    ("lightTreeClusterRoots", np.dtype("<i4")),
+    ("compactToLeaf", np.dtype("<i4")),
+    ("shadingPoints", np.dtype("<f4")),
+    ("superpixelIndex", np.dtype("<i4")),
+    ("clusterVisibilityMask", np.dtype("<u4")),
+    ("clusterVisibility", np.dtype("<f4")),
+]
+SECTION_IDS = {name: i + 1 for i, (name, _) in enumerate(SECTIONS)}
+
+REPORTS = ["irradiance", "coverage", "clusters", "lightTree", "visibility"]
+
+
+class SnapshotError(Exception):
+    pass
+
+
+def read_snapshot(path):
+    """Returns {"header": dict, "grid": dict, "cvars": [...], <section>: ndarray}."""
+    data = np.fromfile(path, dtype=np.uint8)
+    if data.size < HEADER.itemsize:
+        raise SnapshotError("file is smaller than the header")
+    header = {name: int(data[:HEADER.itemsize].view(HEADER)[0][name]) for name in HEADER_FIELDS}
+    if header["magic"] != MAGIC:
+        raise SnapshotError("not a VXPG snapshot (bad magic)")
+    if header["version"] != VERSION:
+        raise SnapshotError(f"snapshot version {header['version']}, this tool reads {VERSION}")
+    table_end = HEADER.itemsize + header["sectionCount"] * SECTION.itemsize
+    if table_end > data.size:
+        raise SnapshotError("section table runs past the end of the file")
+
+    snapshot = {"header": header}
+    for entry in data[HEADER.itemsize:table_end].view(SECTION):
+        sid, element_size, offset, size = (int(entry[k]) for k in ("id", "elementSize", "offset", "size"))
+        if not 1 <= sid <= len(SECTIONS):
+            continue  # newer section; skipped like the C++ reader does
+        name, dtype = SECTIONS[sid - 1]
+        if element_size != dtype.itemsize or size % dtype.itemsize or offset + size > data.size:
+            raise SnapshotError(f"section {name} is malformed")
+        snapshot[name] = data[offset:offset + size].view(dtype)
+
+    if "grid" not in snapshot or len(snapshot["grid"]) != 1:
+        raise SnapshotError("missing grid constants")
+    grid = snapshot["grid"][0]
+    snapshot["grid"] = {name: grid[name].tolist() for name in GRID.names}
+
+    strings = snapshot.pop("strings", np.zeros(0, np.uint8)).tobytes()
+    cvars = []
+    for record in snapshot.pop("cvars", np.zeros(0, CVAR)):
+        name = strings[record["nameOffset"]:record["nameOffset"] + record["nameLength"]].decode("utf-8")
+        value = strings[record["valueOffset"]:record["valueOffset"] + record["valueLength"]].decode("utf-8")
+        kind = int(record["type"])
+        cvars.append({"name": name, "type": CVAR_TYPES[kind] if kind < len(CVAR_TYPES) else kind, "value": value})
+    snapshot["cvars"] = cvars
+    return snapshot
+
+
+def write_snapshot(path, header, grid, cvars, sections):
+    """header: HEADER_FIELDS subset; grid: GRID fields; cvars: [(type, name, value)];
+    sections: {name: ndarray of the section's dtype}. Empty arrays are left out."""
+    strings = bytearray()
+    records = np.zeros(len(cvars), CVAR)
+    for record, (kind, name, value) in zip(records, cvars):
+        name, value = name.encode("utf-8"), value.encode("utf-8")
+        record["type"] = kind
+        record["nameOffset"], record["nameLength"] = len(strings), len(name)
+        strings += name
+        record["valueOffset"], record["valueLength"] = len(strings), len(value)
+        strings += value
+
+    grid_record = np.zeros(1, GRID)
+    for key, value in grid.items():
+        grid_record[0][key] = value
+    payloads = {"grid": grid_record, "cvars": records, "strings": np.frombuffer(bytes(strings), np.uint8)}
+    payloads.update(sections)
+
+    present = []
+    for name, dtype in SECTIONS:
+        array = payloads.get(name)
+        if array is not None and array.size:
+            present.append((SECTION_IDS[name], np.ascontiguousarray(array, dtype=dtype)))
+
+    def align(value):
+        return (value + SECTION_ALIGNMENT - 1) & ~(SECTION_ALIGNMENT - 1)
+
+    head = np.zeros(1, HEADER)
+    for key in HEADER_FIELDS:
+        head[0][key] = header.get(key, 0)
+    head[0]["magic"], head[0]["version"], head[0]["sectionCount"] = MAGIC, VERSION, len(present)
+
+    table = np.zeros(len(present), SECTION)
+    cursor = align(HEADER.itemsize + table.nbytes)
+    for entry, (sid, array) in zip(table, present):
+        entry["id"], entry["elementSize"] = sid, array.dtype.itemsize
+        entry["offset"], entry["size"] = cursor, array.nbytes
+        cursor = align(cursor + array.nbytes)
+
+    temporary = str(path) + ".tmp"
+    with open(temporary, "wb") as out:
+        out.write(head.tobytes())
+        out.write(table.tobytes())
+        for entry, (_, array) in zip(table, present):
+            out.write(b"\0" * (int(entry["offset"]) - out.tell()))
+            out.write(array.tobytes())
+    os.replace(temporary, path)
+
+
+# --- reports ----------------------------------------------------------------
+
+def summary(values):
+    values = np.asarray(values, dtype=np.float64)
+    if values.size == 0:
+        return {"count": 0}
+    return {"count": int(values.size), "min": round(float(values.min()), 4), "mean": round(float(values.mean()), 4),
+            "max": round(float(values.max()), 4)}
+
+
+def log2_histogram(values, bins):
+    values = np.asarray(values, dtype=np.float64)
+    values = values[values > 0]
+    if values.size == 0:
+        return {"edges": [], "counts": []}
+    logs = np.log2(values)
+    lo, hi = np.floor(logs.min()), np.ceil(logs.max())
+    if hi == lo:
+        hi = lo + 1
+    counts, edges = np.histogram(logs, bins=bins, range=(lo, hi))
+    return {"edges": [round(float(e), 3) for e in edges], "counts": counts.tolist()}
+
+
+def irradiance_report(snap, bins):
+    report = {}
+    records = snap.get("voxelIrradiance")
+    if records is not None:
+        irradiance = records["irradiance"].astype(np.float64) / 100.0  # packed x100 in the grid
+        vpls = records["vplCount"].astype(np.float64)
+        per_vpl = irradiance[vpls > 0] / vpls[vpls > 0]
+        cells = snap["grid"]["gridDim"] ** 3
+        report["injectedVoxels"] = int(records.size)
+        report["occupancy"] = round(records.size / cells, 6) if cells else 0.0
+        report["irradiance"] = summary(irradiance[irradiance > 0])
+        report["vplCount"] = summary(vpls)
+        report["histogram"] = log2_histogram(irradiance, bins)
+        report["perVplHistogram"] = log2_histogram(per_vpl, bins)
+    premul = snap.get("premulIrradiance")
+    if premul is not None:
+        report["premulIrradiance"] = summary(premul)
+        report["premulZeros"] = int((premul == 0).sum())
+        report["premulHistogram"] = log2_histogram(premul, bins)
+    return report or None
+
+
+def coverage_report(snap):
+    compact = snap.get("compactIds")
+    if compact is None:
+        return None
+    header = snap["header"]
+    cells = snap["grid"]["gridDim"] ** 3
+    unique = np.unique(compact)
+    report = {
+        "litVoxels": header["litVoxelCount"],
+        "capacity": GUIDING_CAPACITY,
+        "capacityUse": round(header["litVoxelCount"] / GUIDING_CAPACITY, 6),
+        "duplicates": int(compact.size - unique.size),
+        "outOfGrid": int((compact >= cells).sum()),
+    }
+    records = snap.get("voxelIrradiance")
+    if records is not None:
+        injected = records["voxel"][records["irradiance"] > 0]
+        covered = np.isin(injected, unique)
+        report["injectedCovered"] = round(float(covered.mean()), 6) if injected.size else 1.0
+        report["injectedMissing"] = int((~covered).sum())
+        report["compactNotInjected"] = int((~np.isin(unique, injected)).sum())
+    to_leaf = snap.get("compactToLeaf")
+    if to_leaf is not None:
+        report["withoutLeaf"] = int((to_leaf < 0).sum())
+    return report
+
+
+def cluster_report(snap):
+    assignments = snap.get("clusterAssignments")
+    if assignments is None:
+        return None
+    count = snap["header"]["clusterCount"] or (int(assignments.max()) + 1 if assignments.size else 0)
+    assigned = assignments[(assignments >= 0) & (assignments < count)]
+    sizes = np.bincount(assigned, minlength=count)
+    mean = sizes.mean() if sizes.size else 0.0
+    report = {
+        "clusters": int(count),
+        "unassigned": int((assignments < 0).sum()),
+        "outOfRange": int((assignments >= count).sum()),
+        "empty": int((sizes == 0).sum()),
+        "sizes": sizes.tolist(),
+        "size": summary(sizes),
+        "sizeCv": round(float(sizes.std() / mean), 4) if mean else 0.0,
+        "largestShare": round(float(sizes.max() / max(assigned.size, 1)), 4) if sizes.size else 0.0,
+    }
+    premul = snap.get("premulIrradiance")
+    if premul is not None and premul.size == assignments.size:
+        energy = np.bincount(assigned, weights=premul[(assignments >= 0) & (assignments < count)], minlength=count)
+        total = energy.sum()
+        report["energyShare"] = [round(float(e / total), 4) for e in energy] if total > 0 else []
+    seeds = snap.get("clusterSeeds")
+    if seeds is not None:
+        report["invalidSeeds"] = int(((seeds < 0) | (seeds >= snap["header"]["litVoxelCount"])).sum())
+    return report
+
+
+def light_tree_report(snap):
+    nodes = snap.get("lightTreeNodes")
+    if nodes is None:
+        return None
+    header = snap["header"]
+    leaves = header["leafCount"]
+    n = nodes.size
+    left = nodes["leftIndex"].astype(np.int64)
+    right = nodes["rightIndex"].astype(np.int64)
+    parent = nodes["parentIndex"].astype(np.int64)
+
+    depth = np.full(n, -1, np.int64)
+    leaf_count = np.zeros(n, np.int64)
+    link_errors = 0
+    order = []
+    stack = [0] if n else []
+    if n:
+        depth[0] = 0
+    while stack:  # pre-order from the root (node 0)
+        i = stack.pop()
+        order.append(i)
+        for child in (left[i], right[i]):
+            if child == NODE_NONE:
+                continue
+            if child >= n or depth[child] >= 0 or parent[child] != i:
+                link_errors += 1
+                continue
+            depth[child] = depth[i] + 1
+            stack.append(child)
+
+    is_leaf = (left == NODE_NONE) & (right == NODE_NONE)
+    intensity_error = 0.0
+    imbalance = []
+    for i in reversed(order):  # children before parents
+        if is_leaf[i]:
+            leaf_count[i] = 1
+            continue
+        kids = [c for c in (left[i], right[i]) if c != NODE_NONE and c < n]
+        leaf_count[i] = sum(leaf_count[c] for c in kids)
+        if len(kids) == 2 and leaf_count[i]:
+            imbalance.append(abs(leaf_count[kids[0]] - leaf_count[kids[1]]) / leaf_count[i])
+        children_sum = float(sum(nodes["intensity"][c] for c in kids))
+        scale = max(abs(children_sum), 1e-30)
+        intensity_error = max(intensity_error, abs(float(nodes["intensity"][i]) - children_sum) / scale)
+
+    reachable_leaves = is_leaf & (depth >= 0)
+    leaf_depths = depth[reachable_leaves]
+    optimal = int(np.ceil(np.log2(leaves))) if leaves > 1 else 0
+    report = {
+        "leaves": int(leaves),
+        "nodes": int(n),
+        "overflow": bool(header["treeOverflow"]),
+        "unreachable": int((depth < 0).sum()),
+        "linkErrors": int(link_errors),
+        "leafDepth": summary(leaf_depths),
+        "optimalDepth": optimal,
+        "depthRatio": round(float(leaf_depths.max()) / optimal, 3) if optimal and leaf_depths.size else 1.0,
+        "depthHistogram": np.bincount(leaf_depths).tolist() if leaf_depths.size else [],
+        "splitImbalance": summary(imbalance),
+        "maxIntensityError": float(intensity_error),
+    }
+    roots = snap.get("lightTreeClusterRoots")
+    if roots is not None:
+        valid = roots[(roots >= 0) & (roots < n)]
+        report["clusterRoots"] = int(valid.size)
+        report["clusterRootFlagMismatches"] = int(sum(int(nodes["flag"][r]) != c for c, r in enumerate(roots) if 0 <= r < n))
+        report["clusterSubtreeLeaves"] = summary(leaf_count[valid])
+    return report
+
+
+def visibility_report(snap):
+    visibility = snap.get("clusterVisibility")
+    mask = snap.get("clusterVisibilityMask")
+    if visibility is None and mask is None:
+        return None
+    header = snap["header"]
+    superpixels = header["superpixelMapX"] * header["superpixelMapY"]
+    report = {"superpixels": int(superpixels), "clusters": header["clusterCount"]}
+    if visibility is not None:
+        matrix = visibility.reshape(superpixels, header["clusterCount"])
+        visible = matrix > 0
+        per_superpixel = visible.sum(1)
+        report["zeroFraction"] = round(float(1.0 - visible.mean()), 4)
+        report["visibleClustersPerSuperpixel"] = summary(per_superpixel)
+        report["emptySuperpixels"] = int((per_superpixel == 0).sum())
+        report["neverVisibleClusters"] = int((visible.sum(0) == 0).sum())
+        report["visibility"] = summary(matrix[visible])
+    if mask is not None:
+        bits = np.unpackbits(mask.astype("<u4").view(np.uint8).reshape(-1, 4), axis=1, bitorder="little")
+        report["maskBitsPerSuperpixel"] = summary(bits.sum(1))
+        if visibility is not None and header["clusterCount"] <= 32:
+            hard = bits[:, :header["clusterCount"]].astype(bool)
+            report["maskWithoutVisibility"] = int((hard & ~visible).sum())
+            report["visibilityWithoutMask"] = int((~hard & visible).sum())
+    index = snap.get("superpixelIndex")
+    if index is not None:
+        report["pixelsWithoutSuperpixel"] = int((index < 0).sum())
+        report["membersPerSuperpixel"] = summary(np.bincount(index[index >= 0], minlength=superpixels))
+    return report
+
+
+def analyze(snap, bins, only=None):
+    builders = {
+        "irradiance": lambda: irradiance_report(snap, bins),
+        "coverage": lambda: coverage_report(snap),
+        "clusters": lambda: cluster_report(snap),
+        "lightTree": lambda: light_tree_report(snap),
+        "visibility": lambda: visibility_report(snap),
+    }
+    reports = {}
+    for name in only or REPORTS:
+        result = builders[name]()
+        if result is not None:
+            reports[name] = result
+    return reports
+
+
+# --- synthetic snapshots ----------------------------------------------------
+
+def build_tree(compact_ids, assignments, premul):
+    """A median-split tree in the shader's numbering: internal nodes 0..n-2,
+    leaves n-1.., sorted by (cluster, voxel). Not the Karras tree, but the same
+    shape rules, which is all the report checks."""
+    n = compact_ids.size
+    order = np.lexsort((compact_ids, assignments))
+    nodes = np.zeros(2 * n - 1, NODE)
+    nodes["parentIndex"] = nodes["leftIndex"] = nodes["rightIndex"] = nodes["voxelIndex"] = NODE_NONE
+    to_leaf = np.full(n, -1, np.int32)
+    for rank, compact in enumerate(order):
+        leaf = n - 1 + rank
+        nodes[leaf]["voxelIndex"] = compact
+        nodes[leaf]["intensity"] = premul[compact]
+        nodes[leaf]["flag"] = assignments[compact]
+        to_leaf[compact] = leaf
+
+    next_internal = [0]
+
+    def split(lo, hi):  # leaf ranks [lo, hi)
+        if hi - lo == 1:
+            return n - 1 + lo
+        node = next_internal[0]
+        next_internal[0] += 1
+        mid = (lo + hi) // 2
+        children = (split(lo, mid), split(mid, hi))
+        nodes[node]["leftIndex"], nodes[node]["rightIndex"] = children
+        for child in children:
+            nodes[child]["parentIndex"] = node
+        nodes[node]["intensity"] = nodes[children[0]]["intensity"] + nodes[children[1]]["intensity"]
+        flags = {int(nodes[c]["flag"]) for c in children}
+        nodes[node]["flag"] = flags.pop() if len(flags) == 1 else 0xFFFFFFFF
+        return node
+
+    split(0, n)
+    roots = np.full(32, -1, np.int32)
+    for i in range(nodes.size):  # highest node whose subtree is one cluster
+        flag = int(nodes[i]["flag"])
+        p = int(nodes[i]["parentIndex"])
+        if flag < 32 and (p == NODE_NONE or int(nodes[p]["flag"]) != flag):
+            roots[flag] = i
+    return nodes, roots, to_leaf
+
+
+def make_synthetic(path, seed):
+    rng = np.random.default_rng(seed)
+    grid_dim, lit, clusters = 32, 600, 32
+    width, height, spixel = 64, 48, 16
+    map_x, map_y = width // spixel, height // spixel
+
+    injected = np.sort(rng.choice(grid_dim ** 3, size=lit + 40, replace=False)).astype(np.uint32)
+    irradiance = np.zeros(injected.size, VOXEL_IRRADIANCE)
+    irradiance["voxel"] = injected
+    irradiance["vplCount"] = rng.integers(1, 9, injected.size)
+    irradiance["irradiance"] = (np.exp2(rng.uniform(-4, 6, injected.size)) * 100).astype(np.uint32) + 1
+
+    compact = rng.permutation(injected)[:lit]
+    premul = rng.exponential(1.0, lit).astype(np.float32)
+    assignments = rng.integers(0, clusters - 2, lit).astype(np.int32)  # two empty clusters
+    assignments[:5] = -1
+    coords = np.stack([compact % grid_dim, compact // grid_dim % grid_dim, compact // grid_dim ** 2], 1)
+
+    vpls = np.zeros(lit, VPL)
+    vpls["position"] = coords.astype(np.float32) * 0.25 - 4.0
+    fingerprints = np.zeros(lit, FINGERPRINT)
+    fingerprints["words"] = rng.integers(0, 2 ** 32, (lit, 4), dtype=np.uint64).astype(np.uint32)
+    seeds = rng.choice(lit, clusters, replace=False).astype(np.int32)
+    centers = np.zeros(clusters, CENTER)
+    centers["fingerprint"] = fingerprints["words"][seeds]
+    centers["position"] = coords[seeds]
+    centers["intensity"] = premul[seeds]
+
+    tree_assignments = np.where(assignments < 0, clusters - 1, assignments)
+    nodes, roots, to_leaf = build_tree(compact, tree_assignments, premul)
+
+    shading = rng.uniform(-4, 4, (height, width, 4)).astype(np.float32)
+    ys, xs = np.mgrid[0:height, 0:width]
+    index = ((ys // spixel) * map_x + xs // spixel).astype(np.int32)
+    index[:2, :] = -1
+    shading[:2, :, 0] = 1e30
+    visibility = np.where(rng.random((map_x * map_y, clusters)) < 0.3,
+                          rng.uniform(0.05, 1.0, (map_x * map_y, clusters)), 0.0).astype(np.float32)
+    mask_bits = (visibility > 0.5).astype(np.uint64)
+    mask = (mask_bits << np.arange(clusters, dtype=np.uint64)).sum(1).astype(np.uint32)
+
+    header = {"stage": STAGES.index("LightTree"), "frameIndex": 1, "width": width, "height": height,
+              "superpixelMapX": map_x, "superpixelMapY": map_y, "clusterCount": clusters,
+              "litVoxelCount": lit, "leafCount": lit, "treeOverflow": 0}
+    grid = {"gridMin": [-4.0, -4.0, -4.0], "voxelSize": 0.25, "gridMax": [4.0, 4.0, 4.0], "gridDim": grid_dim,
+            "injectUseAvg": 1, "supervoxelFactor": 4, "heatScale": 1.0, "reuseGiVpl": 0}
+    cvars = [(1, "vxpg.cluster.weight", "0.5"), (0, "vxpg.fingerprint.rays", "128"), (3, "vxpg.stage", "LightTree")]
+    sections = {
+        "voxelIrradiance": irradiance, "compactIds": compact, "premulIrradiance": premul,
+        "representativeVpls": vpls, "fingerprints": fingerprints, "clusterSeeds": seeds,
+        "clusterCenters": centers, "clusterAssignments": assignments, "lightTreeNodes": nodes,
+        "lightTreeClusterRoots": roots, "compactToLeaf": to_leaf, "shadingPoints": shading.reshape(-1),
+        "superpixelIndex": index.reshape(-1), "clusterVisibilityMask": mask,
+        "clusterVisibility": visibility.reshape(-1),
+    }
+    write_snapshot(path, header, grid, cvars, sections)
+
+
+# --- output -----------------------------------------------------------------
+
+def print_histogram(title, histogram):
+    if not histogram["counts"]:
+        return
+    peak = max(histogram["counts"]) or 1
+    print(f"  {title} (log2):")
+    for lo, count in zip(histogram["edges"], histogram["counts"]):
+        print(f"    {lo:7.2f}  {count:8d}  {'#' * round(40 * count / peak)}")
+
+
+def print_report(path, snap, reports):
+    header, grid = snap["header"], snap["grid"]
+    stage = STAGES[header["stage"]] if header["stage"] < len(STAGES) else header["stage"]
+    print(f"Snapshot: {path}  (stage {stage}, frame {header['frameIndex']}, {header['width']}x{header['height']})")
+    print(f"  grid {grid['gridDim']}^3, voxel {grid['voxelSize']:.4g}, min {grid['gridMin']}  cvars {len(snap['cvars'])}")
+    if "irradiance" in reports:
+        r = reports["irradiance"]
+        print("Irradiance:")
+        if "injectedVoxels" in r:
+            print(f"  injected voxels {r['injectedVoxels']} (occupancy {r['occupancy']:.4%})  irradiance {r['irradiance']}")
+            print(f"  VPLs per voxel {r['vplCount']}")
+            print_histogram("irradiance", r["histogram"])
+            print_histogram("irradiance per VPL", r["perVplHistogram"])
+        if "premulIrradiance" in r:
+            print(f"  premultiplied {r['premulIrradiance']}  zeros {r['premulZeros']}")
+    if "coverage" in reports:
+        r = reports["coverage"]
+        print(f"Coverage: {r['litVoxels']} lit of {r['capacity']} ({r['capacityUse']:.2%})  "
+              f"duplicates {r['duplicates']}  outside grid {r['outOfGrid']}")
+        if "injectedCovered" in r:
+            print(f"  injected voxels covered {r['injectedCovered']:.2%} (missing {r['injectedMissing']}), "
+                  f"compact ids never injected {r['compactNotInjected']}")
+        if "withoutLeaf" in r:
+            print(f"  compact ids without a leaf {r['withoutLeaf']}")
+    if "clusters" in reports:
+        r = reports["clusters"]
+        print(f"Clusters: {r['clusters']}  empty {r['empty']}  unassigned {r['unassigned']}  "
+              f"size {r['size']}  cv {r['sizeCv']}  largest {r['largestShare']:.2%}")
+        print(f"  sizes {r['sizes']}")
+    if "lightTree" in reports:
+        r = reports["lightTree"]
+        print(f"Light tree: {r['leaves']} leaves, {r['nodes']} nodes{'  OVERFLOW' if r['overflow'] else ''}  "
+              f"unreachable {r['unreachable']}  link errors {r['linkErrors']}")
+        print(f"  leaf depth {r['leafDepth']}  optimal {r['optimalDepth']}  ratio {r['depthRatio']}")
+        print(f"  split imbalance {r['splitImbalance']}  max intensity error {r['maxIntensityError']:.3g}")
+        if "clusterRoots" in r:
+            print(f"  cluster roots {r['clusterRoots']} (flag mismatches {r['clusterRootFlagMismatches']})  "
+                  f"subtree leaves {r['clusterSubtreeLeaves']}")
+    if "visibility" in reports:
+        r = reports["visibility"]
+        print(f"Visibility: {r['superpixels']} superpixels x {r['clusters']} clusters")
+        if "zeroFraction" in r:
+            print(f"  zero {r['zeroFraction']:.2%}  visible clusters per superpixel {r['visibleClustersPerSuperpixel']}  "
+                  f"empty superpixels {r['emptySuperpixels']}  never-visible clusters {r['neverVisibleClusters']}")
+        if "maskBitsPerSuperpixel" in r:
+            print(f"  mask bits per superpixel {r['maskBitsPerSuperpixel']}")
+        if "maskWithoutVisibility" in r:
+            print(f"  mask bits without visibility {r['maskWithoutVisibility']}, "
+                  f"visibility without mask bit {r['visibilityWithoutMask']}")
+        if "pixelsWithoutSuperpixel" in r:
+            print(f"  pixels without superpixel {r['pixelsWithoutSuperpixel']}  members {r['membersPerSuperpixel']}")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Summarize a VXPG stage snapshot (.vxps).")
+    parser.add_argument("snapshot", nargs="?", help="input snapshot")
+    parser.add_argument("--only", choices=REPORTS, action="append", help="limit to this report (repeatable)")
+    parser.add_argument("--bins", type=int, default=16, help="histogram bins (default 16)")
+    parser.add_argument("--cvars", action="store_true", help="also list the captured cvars")
+    parser.add_argument("--make-synthetic", metavar="OUT", help="write a synthetic snapshot to OUT and exit")
+    parser.add_argument("--seed", type=int, default=1, help="seed for --make-synthetic (default 1)")
+    parser.add_argument("--json", action="store_true", help="emit machine-readable JSON")
+    args = parser.parse_args()
+
+    if args.make_synthetic:
+        make_synthetic(args.make_synthetic, args.seed)
+        print(f"Wrote {args.make_synthetic}")
+        return
+    if not args.snapshot:
+        parser.error("a snapshot path is required")
+
+    try:
+        snap = read_snapshot(args.snapshot)
+    except (OSError, SnapshotError) as exc:
+        sys.exit(f"{args.snapshot}: {exc}")
+    reports = analyze(snap, args.bins, args.only)
+
+    if args.json:
+        out = {"snapshot": args.snapshot, "header": snap["header"], "grid": snap["grid"], **reports}
+        if args.cvars:
+            out["cvars"] = snap["cvars"]
+        print(json.dumps(out, indent=2))
+        return
+
+    print_report(args.snapshot, snap, reports)
+    if args.cvars:
+        for cvar in snap["cvars"]:
+            print(f"  {cvar['name']} = {cvar['value']}  ({cvar['type']})")
+
+
+if __name__ == "__main__":
+    main()